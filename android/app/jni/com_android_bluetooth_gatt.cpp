@@ -91,6 +91,13 @@ static jstring bdaddr2newjstr(JNIEnv* env, const RawAddress* bda) {
   return env->NewStringUTF(c_address);
 }
 
+// Original address of the scan results, the address before resolution.
+// TODO(optedoblivion): Figure out original address for here, use empty
+// for now
+static jstring originalAddress2newjstr(JNIEnv* env) {
+  return env->NewStringUTF("00:00:00:00:00:00");
+}
+
 static std::vector<uint8_t> toVector(JNIEnv* env, jbyteArray ba) {
   jbyte* data_data = env->GetByteArrayElements(ba, NULL);
   uint16_t data_len = (uint16_t)env->GetArrayLength(ba);
@@ -1038,19 +1045,40 @@ public:
     ScopedLocalRef<jbyteArray> jb(sCallbackEnv.get(), sCallbackEnv->NewByteArray(adv_data.size()));
     sCallbackEnv->SetByteArrayRegion(jb.get(), 0, adv_data.size(), (jbyte*)adv_data.data());
 
-    // TODO(optedoblivion): Figure out original address for here, use empty
-    // for now
-
-    // length of data + '\0'
-    char empty_address[18] = "00:00:00:00:00:00";
     ScopedLocalRef<jstring> fake_address(sCallbackEnv.get(),
-                                         sCallbackEnv->NewStringUTF(empty_address));
+                                         originalAddress2newjstr(sCallbackEnv.get()));
 
     sCallbackEnv->CallVoidMethod(mScanCallbacksObj, method_onScanResult, event_type, addr_type,
                                  address.get(), primary_phy, secondary_phy, advertising_sid,
                                  tx_power, rssi, periodic_adv_int, jb.get(), fake_address.get());
   }
 
+  void OnScanResults(const ScanResultBatch& batch) {
+    std::shared_lock<std::shared_mutex> lock(callbacks_mutex);
+    CallbackEnv sCallbackEnv(__func__);
+    if (!sCallbackEnv.valid() || !mScanCallbacksObj) {
+      return;
+    }
+
+    ScopedLocalRef<jstring> fake_address(sCallbackEnv.get(),
+                                         originalAddress2newjstr(sCallbackEnv.get()));
+
+    for (const auto& result : batch.results()) {
+      ScopedLocalRef<jstring> address(sCallbackEnv.get(),
+                                      bdaddr2newjstr(sCallbackEnv.get(), &result.bda));
+      ScopedLocalRef<jbyteArray> jb(sCallbackEnv.get(),
+                                    sCallbackEnv->NewByteArray(result.adv_data_len));
+      sCallbackEnv->SetByteArrayRegion(jb.get(), 0, result.adv_data_len,
+                                       (const jbyte*)batch.AdvData(result));
+
+      sCallbackEnv->CallVoidMethod(mScanCallbacksObj, method_onScanResult, result.event_type,
+                                   result.addr_type, address.get(), result.primary_phy,
+                                   result.secondary_phy, result.advertising_sid, result.tx_power,
+                                   result.rssi, result.periodic_adv_int, jb.get(),
+                                   fake_address.get());
+    }
+  }
+
   void OnTrackAdvFoundLost(AdvertisingTrackInfo track_info) {
     std::shared_lock<std::shared_mutex> lock(callbacks_mutex);
     CallbackEnv sCallbackEnv(__func__);
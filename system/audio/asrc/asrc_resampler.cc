@@ -24,6 +24,10 @@
 #include <cmath>
 #include <utility>
 
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
 #include "asrc_tables.h"
 #include "common/repeating_timer.h"
 #include "hal/link_clocker.h"
@@ -246,6 +250,11 @@ class SourceAudioHalAsrc::Resampler {
 
   inline int32_t Filter(const int32_t* in, const int32_t* h, int16_t mu, const int16_t* d);
 
+  // Portable implementation of `Filter()`, which the vectorized
+  // implementations must match bit for bit.
+
+  inline int32_t FilterGeneric(const int32_t* in, const int32_t* h, int16_t mu, const int16_t* d);
+
   // Upsampling loop, the ratio is less than 1.0 in Q26 format,
   // more output samples are produced compared to input.
 
@@ -342,8 +351,25 @@ public:
 
     *in_sub_q26 = in_pos_ & ((1u << 26) - 1);
   }
+
+  friend class SourceAudioHalAsrcTest;
 };
 
+//
+// Portable Resampler Filtering
+//
+
+inline int32_t SourceAudioHalAsrc::Resampler::FilterGeneric(const int32_t* in, const int32_t* h,
+                                                            int16_t mu, const int16_t* d) {
+  int64_t s = 0;
+  for (int i = 0; i < 2 * KERNEL_A - 1; i++) {
+    s += int64_t(in[i]) * (h[i] + ((mu * d[i] + (1 << 6)) >> 7));
+  }
+
+  s = (s + (1 << 30)) >> 31;
+  return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
+}
+
 //
 // ARM AArch 64 Neon Resampler Filtering
 //
@@ -400,6 +426,74 @@ inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* x, const int
   return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
 }
 
+//
+// x86 AVX2 Resampler Filtering
+//
+
+#elif defined(__AVX2__)
+
+inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* x, const int32_t* h,
+                                                     int16_t _mu, const int16_t* d) {
+  const __m256i mu = _mm256_set1_epi32(_mu);
+  const __m256i rnd = _mm256_set1_epi32(1 << 6);
+
+  // The products are accumulated on 64 bits, separately for the even
+  // and the odd taps, which `_mm256_mul_epi32()` takes one at a time.
+
+  __m256i sx = _mm256_setzero_si256();
+
+  for (int i = 0; i < 32; i += 8) {
+    __m256i d8 = _mm256_cvtepi16_epi32(_mm_load_si128((const __m128i*)(d + i)));
+    __m256i h8 = _mm256_load_si256((const __m256i*)(h + i));
+    __m256i x8 = _mm256_loadu_si256((const __m256i*)(x + i));
+
+    h8 = _mm256_add_epi32(h8,
+                          _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(d8, mu), rnd), 7));
+
+    sx = _mm256_add_epi64(sx, _mm256_mul_epi32(x8, h8));
+    sx = _mm256_add_epi64(sx,
+                          _mm256_mul_epi32(_mm256_srli_epi64(x8, 32), _mm256_srli_epi64(h8, 32)));
+  }
+
+  alignas(16) int64_t sv[2];
+  _mm_store_si128((__m128i*)sv,
+                  _mm_add_epi64(_mm256_castsi256_si128(sx), _mm256_extracti128_si256(sx, 1)));
+
+  int64_t s = (sv[0] + sv[1] + (1 << 30)) >> 31;
+  return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
+}
+
+//
+// x86 SSE4.1 Resampler Filtering
+//
+
+#elif defined(__SSE4_1__)
+
+inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* x, const int32_t* h,
+                                                     int16_t _mu, const int16_t* d) {
+  const __m128i mu = _mm_set1_epi32(_mu);
+  const __m128i rnd = _mm_set1_epi32(1 << 6);
+
+  __m128i sx = _mm_setzero_si128();
+
+  for (int i = 0; i < 32; i += 4) {
+    __m128i d4 = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(d + i)));
+    __m128i h4 = _mm_load_si128((const __m128i*)(h + i));
+    __m128i x4 = _mm_loadu_si128((const __m128i*)(x + i));
+
+    h4 = _mm_add_epi32(h4, _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(d4, mu), rnd), 7));
+
+    sx = _mm_add_epi64(sx, _mm_mul_epi32(x4, h4));
+    sx = _mm_add_epi64(sx, _mm_mul_epi32(_mm_srli_epi64(x4, 32), _mm_srli_epi64(h4, 32)));
+  }
+
+  alignas(16) int64_t sv[2];
+  _mm_store_si128((__m128i*)sv, sx);
+
+  int64_t s = (sv[0] + sv[1] + (1 << 30)) >> 31;
+  return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
+}
+
 //
 // Generic Resampler Filtering
 //
@@ -408,13 +502,7 @@ inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* x, const int
 
 inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* in, const int32_t* h,
                                                      int16_t mu, const int16_t* d) {
-  int64_t s = 0;
-  for (int i = 0; i < 2 * KERNEL_A - 1; i++) {
-    s += int64_t(in[i]) * (h[i] + ((mu * d[i] + (1 << 6)) >> 7));
-  }
-
-  s = (s + (1 << 30)) >> 31;
-  return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
+  return FilterGeneric(in, h, mu, d);
 }
 
 #endif
@@ -556,13 +644,20 @@ __attribute__((no_sanitize("integer"))) void SourceAudioHalAsrc::Resample(
                uint32_t((output_samples_q26 * 1000 * 1000) / (int64_t(sample_rate_) << 26));
 }
 
-__attribute__((no_sanitize("integer"))) std::vector<const std::vector<uint8_t>*>
-SourceAudioHalAsrc::Run(const std::vector<uint8_t>& in) {
+std::vector<const std::vector<uint8_t>*> SourceAudioHalAsrc::Run(const std::vector<uint8_t>& in) {
   std::vector<const std::vector<uint8_t>*> out;
+  Run(in, &out);
+  return out;
+}
+
+__attribute__((no_sanitize("integer"))) void SourceAudioHalAsrc::Run(
+        const std::vector<uint8_t>& in, std::vector<const std::vector<uint8_t>*>* out_list) {
+  auto& out = *out_list;
+  out.clear();
 
   if (in.size() != buffers_size_) {
     log::error("Inconsistent input buffer size: {} ({} expected)", in.size(), buffers_size_);
-    return out;
+    return;
   }
 
   // The burst delay has expired, let's generate the burst.
@@ -615,8 +710,66 @@ SourceAudioHalAsrc::Run(const std::vector<uint8_t>& in) {
     log::info("[{:6}.{:06}]  Fs: {:.2f} Hz  drift: {} us", output_us / (1000 * 1000),
               output_us % (1000 * 1000), ratio * sample_rate_, int(output_us - local_us));
   }
+}
 
-  return out;
+SinkAudioAsrc::SinkAudioAsrc(int channels, int bit_depth) : bit_depth_(bit_depth) {
+  if (channels < 1 || channels > 8 || (bit_depth != 16 && bit_depth != 32)) {
+    log::error("Bad parameters: channels: {} bit_depth: {}", channels, bit_depth);
+    return;
+  }
+
+  resamplers_ = std::make_unique<std::vector<SourceAudioHalAsrc::Resampler>>(channels, bit_depth_);
+}
+
+SinkAudioAsrc::~SinkAudioAsrc() {}
+
+template <typename T>
+__attribute__((no_sanitize("integer"))) void SinkAudioAsrc::Resample(unsigned ratio_q26,
+                                                                      const uint8_t* in,
+                                                                      size_t size,
+                                                                      std::vector<uint8_t>* out) {
+  auto& resamplers = *resamplers_;
+  auto channels = resamplers.size();
+
+  auto in_length = size / sizeof(T) / channels;
+  auto in_data = reinterpret_cast<const T*>(in);
+
+  while (in_length > 0) {
+    // Size the output from the ratio, with a margin for the phase of the
+    // resamplers. The loop catches up the few samples that could remain.
+
+    size_t out_length = ((uint64_t(in_length) << 26) / ratio_q26) + 2;
+    size_t out_offset = out->size();
+    out->resize(out_offset + out_length * channels * sizeof(T));
+    auto out_data = reinterpret_cast<T*>(out->data() + out_offset);
+
+    size_t in_count, out_count;
+    unsigned sub_q26;
+
+    for (size_t i = 0; i < channels; i++) {
+      resamplers[i].Resample<T>(ratio_q26, in_data + i, channels, in_length, &in_count,
+                                out_data + i, channels, out_length, &out_count, &sub_q26);
+    }
+
+    out->resize(out_offset + out_count * channels * sizeof(T));
+    in_data += in_count * channels;
+    in_length -= in_count;
+  }
+}
+
+void SinkAudioAsrc::Run(double ratio, const uint8_t* in, size_t size, std::vector<uint8_t>* out) {
+  if (resamplers_ == nullptr) {
+    out->insert(out->end(), in, in + size);
+    return;
+  }
+
+  unsigned ratio_q26 = round(ldexp(ratio, 26));
+
+  if (bit_depth_ <= 16) {
+    Resample<int16_t>(ratio_q26, in, size, out);
+  } else {
+    Resample<int32_t>(ratio_q26, in, size, out);
+  }
 }
 
 }  // namespace bluetooth::audio::asrc
@@ -54,6 +54,11 @@ public:
 
   std::vector<const std::vector<uint8_t>*> Run(const std::vector<uint8_t>& in);
 
+  // Same as above, filling the list `out` given by the caller. Reusing the
+  // same list from a call to the other avoids its allocation on each buffer.
+
+  void Run(const std::vector<uint8_t>& in, std::vector<const std::vector<uint8_t>*>* out);
+
 private:
   const int sample_rate_;
   const int bit_depth_;
@@ -89,6 +94,32 @@ private:
                 uint32_t*);
 
   friend class SourceAudioHalAsrcTest;
+  friend class SinkAudioAsrc;
+};
+
+class SinkAudioAsrc {
+public:
+  // The sink ASRC has no clock recovery of its own: the caller deducts the
+  // drift between the remote source and the local audio output, and gives
+  // the ratio compensating it with each input buffer.
+
+  SinkAudioAsrc(int channels, int bit_depth);
+
+  ~SinkAudioAsrc();
+
+  // Resamples the interleaved PCM samples of `in`, and appends the result to
+  // `out`. A `ratio` greater than 1.0 produces less output samples than
+  // input samples. The bit depth must be 16 or 32.
+
+  void Run(double ratio, const uint8_t* in, size_t size, std::vector<uint8_t>* out);
+
+private:
+  const int bit_depth_;
+
+  std::unique_ptr<std::vector<SourceAudioHalAsrc::Resampler>> resamplers_;
+
+  template <typename T>
+  void Resample(unsigned ratio_q26, const uint8_t*, size_t, std::vector<uint8_t>*);
 };
 
 }  // namespace bluetooth::audio::asrc
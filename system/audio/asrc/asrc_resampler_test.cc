@@ -16,8 +16,10 @@
 
 #include "asrc_resampler.cc"
 
+#include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <random>
 
 bluetooth::common::MessageLoopThread message_loop_thread("main message loop");
 bluetooth::common::MessageLoopThread* get_main_thread() { return &message_loop_thread; }
@@ -46,6 +48,72 @@ public:
                  channels, out_length / channels, out_count, &sub_q26);
     }
   }
+
+  // Runs the filter of the resampler, and its portable implementation, on
+  // random windows of samples at random positions. Returns the number of
+  // results that differ.
+
+  static size_t FilterMismatches(int bitdepth, size_t count) {
+    Resampler r(bitdepth);
+    std::mt19937 gen(bitdepth);
+    std::uniform_int_distribution<int32_t> sample(r.pcm_min_, r.pcm_max_);
+    std::uniform_int_distribution<int> phase(0, Resampler::KERNEL_Q - 1);
+    std::uniform_int_distribution<int16_t> mu(0, 0x7fff);
+
+    int32_t x[2 * Resampler::KERNEL_A];
+    size_t mismatches = 0;
+
+    for (size_t n = 0; n < count; n++) {
+      // Cover the full scale samples, which stress the accumulation.
+
+      for (auto& v : x) {
+        v = n % 4 == 0 ? (gen() & 1 ? r.pcm_min_ : r.pcm_max_) : sample(gen);
+      }
+
+      int phy = phase(gen);
+      int16_t m = mu(gen);
+
+      if (r.Filter(x, r.h_[phy], m, r.d_[phy]) != r.FilterGeneric(x, r.h_[phy], m, r.d_[phy])) {
+        mismatches++;
+      }
+    }
+
+    return mismatches;
+  }
+
+  // Returns the number of filter outputs per second, computed by the
+  // resampler filter, or its portable implementation.
+
+  static double FilterThroughput(bool generic, size_t count) {
+    Resampler r(16);
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int32_t> sample(r.pcm_min_, r.pcm_max_);
+
+    int32_t x[Resampler::WSIZE];
+    for (auto& v : x) {
+      v = sample(gen);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int64_t acc = 0;
+
+    for (size_t n = 0; n < count; n++) {
+      unsigned phy = n % Resampler::KERNEL_Q;
+      int16_t mu = (n * 7919) & 0x7fff;
+      auto w = x + n % (Resampler::WSIZE - 2 * Resampler::KERNEL_A);
+
+      acc += generic ? r.FilterGeneric(w, r.h_[phy], mu, r.d_[phy])
+                     : r.Filter(w, r.h_[phy], mu, r.d_[phy]);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Keep the results alive, so the loop is not optimized out.
+    volatile int64_t sink = acc;
+    (void)sink;
+
+    return count / elapsed.count();
+  }
 };
 
 extern "C" void resample_i16(int channels, int bitdepth, double ratio, const int16_t* in,
@@ -78,4 +146,12 @@ extern "C" void resample_i32(int channels, int bitdepth, double ratio, const int
   return;
 }
 
+extern "C" size_t filter_mismatches(int bitdepth, size_t count) {
+  return SourceAudioHalAsrcTest::FilterMismatches(bitdepth, count);
+}
+
+extern "C" double filter_throughput(int generic, size_t count) {
+  return SourceAudioHalAsrcTest::FilterThroughput(generic, count);
+}
+
 }  // namespace bluetooth::audio::asrc
@@ -16,10 +16,12 @@
 #
 
 import ctypes
+import logging
+import time
 import numpy as np
 from scipy import signal
 from mobly import test_runner, base_test
-from mobly.asserts import assert_greater
+from mobly.asserts import assert_equal, assert_greater
 import sys
 import os
 
@@ -95,10 +97,21 @@ def mean_snr(resampler, ratio):
 root = os.path.dirname(os.path.dirname(os.path.dirname(__file__)))
 lib = ctypes.cdll.LoadLibrary(os.path.join(root, "libasrc_resampler_test.so"))
 
+lib.filter_mismatches.restype = ctypes.c_size_t
+lib.filter_throughput.restype = ctypes.c_double
+
 cresampler_16 = CResampler(lib, 1, 16)
 cresampler_24 = CResampler(lib, 1, 24)
 
 
+def resample_throughput(resampler, ratio):
+    xs = np.sin(2 * np.pi * np.arange(48000 * 10) / FS * 1000)
+
+    start = time.perf_counter()
+    resampler.resample(xs, ratio)
+    return len(xs) / (time.perf_counter() - start)
+
+
 class SnrTest(base_test.BaseTestClass):
 
     def test_16bit_48000_to_44100(self):
@@ -114,6 +127,35 @@ class SnrTest(base_test.BaseTestClass):
         assert_greater(mean_snr(cresampler_24, 48.0 / 44.1), 114)
 
 
+class FilterTest(base_test.BaseTestClass):
+
+    def test_16bit_filter_bit_exact(self):
+        assert_equal(lib.filter_mismatches(ctypes.c_int(16), ctypes.c_size_t(100000)), 0)
+
+    def test_24bit_filter_bit_exact(self):
+        assert_equal(lib.filter_mismatches(ctypes.c_int(24), ctypes.c_size_t(100000)), 0)
+
+    def test_32bit_filter_bit_exact(self):
+        assert_equal(lib.filter_mismatches(ctypes.c_int(32), ctypes.c_size_t(100000)), 0)
+
+
+class ThroughputTest(base_test.BaseTestClass):
+
+    def test_filter_throughput(self):
+        count = ctypes.c_size_t(10000000)
+        generic = lib.filter_throughput(ctypes.c_int(1), count)
+        kernel = lib.filter_throughput(ctypes.c_int(0), count)
+        logging.info('Filter: %.1f M/s (portable: %.1f M/s, x%.2f)', kernel / 1e6, generic / 1e6,
+                     kernel / generic)
+        assert_greater(kernel, 0)
+
+    def test_resample_throughput(self):
+        for (name, resampler) in [('16 bits', cresampler_16), ('24 bits', cresampler_24)]:
+            rate = resample_throughput(resampler, 44.1 / 48.0)
+            logging.info('Resampling %s: %.1f x realtime at 48 KHz', name, rate / FS)
+            assert_greater(rate, FS)
+
+
 if __name__ == '__main__':
     index = sys.argv.index('--')
     sys.argv = sys.argv[:1] + sys.argv[index + 1:]
@@ -47,6 +47,7 @@
 #include "internal_include/bt_target.h"
 #include "osi/include/allocator.h"
 #include "osi/include/properties.h"
+#include "stack/include/a2dp_codec_api.h"
 #include "stack/include/a2dp_ext.h"
 #include "stack/include/a2dp_sbc.h"
 #include "stack/include/acl_api.h"
@@ -1912,7 +1913,6 @@ void bta_av_do_start(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
 void bta_av_str_stopped(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
   uint8_t start = p_scb->started;
   bool sus_evt = true;
-  BT_HDR* p_buf;
 
   log::info("peer {} bta_handle:0x{:x} audio_open_cnt:{}, p_data {} start:{}", p_scb->PeerAddress(),
             p_scb->hndl, bta_av_cb.audio_open_cnt, fmt::ptr(p_data), start);
@@ -1938,11 +1938,7 @@ void bta_av_str_stopped(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
 
   /* if q_info.a2dp_list is not empty, drop it now */
   if (BTA_AV_CHNL_AUDIO == p_scb->chnl) {
-    while (!list_is_empty(p_scb->a2dp_list)) {
-      p_buf = reinterpret_cast<BT_HDR*>(list_front(p_scb->a2dp_list));
-      list_remove(p_scb->a2dp_list, p_buf);
-      osi_free(p_buf);
-    }
+    list_clear(p_scb->a2dp_list);
 
     /* drop the audio buffers queued in L2CAP */
     if (p_data && p_data->api_stop.flush) {
@@ -2085,6 +2081,31 @@ void bta_av_reconfig(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_av_reads_encoder
+ *
+ * Description      Check whether the channel can read the packets of the
+ *                  encoder, which runs the codec configuration of the active
+ *                  peer. A channel streaming another configuration only sends
+ *                  what is shared with it.
+ *
+ * Returns          true if the channel can read the encoder
+ *
+ ******************************************************************************/
+static bool bta_av_reads_encoder(const tBTA_AV_SCB* p_scb) {
+  if (bta_av_cb.audio_open_cnt < 2) {
+    return true;
+  }
+  const RawAddress active_peer = btif_av_source_active_peer();
+  if (active_peer.IsEmpty()) {
+    return true;
+  }
+  const tBTA_AV_SCB* p_active_scb = bta_av_addr_to_scb(active_peer);
+  return p_active_scb == nullptr || p_active_scb == p_scb ||
+         A2DP_CodecEquals(p_scb->cfg.codec_info, p_active_scb->cfg.codec_info);
+}
+
 /*******************************************************************************
  *
  * Function         bta_av_data_path
@@ -2095,8 +2116,7 @@ void bta_av_reconfig(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
  *
  ******************************************************************************/
 void bta_av_data_path(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* /* p_data */) {
-  BT_HDR* p_buf = NULL;
-  uint32_t timestamp;
+  BtaAvMediaPacket* p_packet = NULL;
   bool new_buf = false;
   uint8_t m_pt = 0x60;
   tAVDT_DATA_OPT_MASK opt;
@@ -2118,30 +2138,32 @@ void bta_av_data_path(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* /* p_data */) {
                                                                              L2CAP_FLUSH_CHANS_GET);
 
   if (!list_is_empty(p_scb->a2dp_list)) {
-    p_buf = reinterpret_cast<BT_HDR*>(list_front(p_scb->a2dp_list));
-    list_remove(p_scb->a2dp_list, p_buf);
-    /* use q_info.a2dp data, read the timestamp */
-    timestamp = *reinterpret_cast<uint32_t*>(p_buf + 1);
-  } else {
+    /* use q_info.a2dp data */
+    p_packet = static_cast<BtaAvMediaPacket*>(list_front(p_scb->a2dp_list));
+  } else if (bta_av_reads_encoder(p_scb)) {
     new_buf = true;
-    /* A2DP_list empty, call co_data, dup data to other channels */
-    p_buf = p_scb->p_cos->data(p_scb->cfg.codec_info, &timestamp);
+    /* A2DP_list empty, call co_data, share the data with other channels */
+    uint32_t timestamp;
+    BT_HDR* p_buf = p_scb->p_cos->data(p_scb->cfg.codec_info, &timestamp);
 
     if (p_buf) {
-      /* use the offset area for the time stamp */
-      *reinterpret_cast<uint32_t*>(p_buf + 1) = timestamp;
+      p_packet = BtaAvMediaPacket::Create(p_buf, timestamp);
+      list_append(p_scb->a2dp_list, p_packet);
 
-      /* dup the data to other channels */
-      bta_av_dup_audio_buf(p_scb, p_buf);
+      /* share the data with other channels */
+      bta_av_dup_audio_buf(p_scb, p_packet);
     }
   }
 
-  if (p_buf) {
+  if (p_packet) {
     if (p_scb->l2c_bufs < (BTA_AV_QUEUE_DATA_CHK_NUM)) {
       /* There's a buffer, just queue it to L2CAP.
        * There's no need to increment it here, it is always read from
        * L2CAP (see above).
        */
+      uint32_t timestamp = p_packet->timestamp();
+      BT_HDR* p_buf = p_packet->Take();
+      list_remove(p_scb->a2dp_list, p_packet);
 
       /* opt is a bit mask, it could have several options set */
       opt = AVDT_DATA_OPT_NONE;
@@ -2195,23 +2217,11 @@ void bta_av_data_path(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* /* p_data */) {
         AVDT_WriteReqOpt(p_scb->avdt_handle, p_buf2, timestamp, m_pt, opt);
       }
       p_scb->cong = true;
-    } else {
-      /* there's a buffer, but L2CAP does not seem to be moving data */
-      if (new_buf) {
-        /* just got this buffer from co_data,
-         * put it in queue */
-        list_append(p_scb->a2dp_list, p_buf);
-      } else {
-        /* just dequeue it from the a2dp_list */
-        if (list_length(p_scb->a2dp_list) < 3) {
-          /* put it back to the queue */
-          list_prepend(p_scb->a2dp_list, p_buf);
-        } else {
-          /* too many buffers in a2dp_list, drop it. */
-          bta_av_co_audio_drop(p_scb->hndl, p_scb->PeerAddress());
-          osi_free(p_buf);
-        }
-      }
+    } else if (!new_buf && list_length(p_scb->a2dp_list) > 3) {
+      /* there's a buffer, but L2CAP does not seem to be moving data,
+       * and there are too many buffers in a2dp_list, drop it. */
+      bta_av_co_audio_drop(p_scb->hndl, p_scb->PeerAddress());
+      list_remove(p_scb->a2dp_list, p_packet);
     }
   }
 }
@@ -29,6 +29,7 @@
 #include <cstdint>
 #include <string>
 
+#include "bta/av/bta_av_media_packet.h"
 #include "bta/include/bta_av_api.h"
 #include "bta/include/bta_sec_api.h"
 #include "bta/sys/bta_sys.h"
@@ -492,7 +493,7 @@ public:
   bool sdp_discovery_started;     /* variable to determine whether SDP is started */
   tBTA_AV_SEP seps[BTAV_A2DP_CODEC_INDEX_MAX];
   AvdtpSepConfig peer_cap; /* buffer used for get capabilities */
-  list_t* a2dp_list;       /* used for audio channels only */
+  list_t* a2dp_list;       /* BtaAvMediaPacket queue, used for audio channels only */
   tBTA_AV_Q_INFO q_info;
   tAVDT_SEP_INFO sep_info[BTA_AV_NUM_SEPS]; /* stream discovery results */
   AvdtpSepConfig cfg;                       /* local SEP configuration */
@@ -719,7 +720,7 @@ void bta_av_free_scb(tBTA_AV_SCB* p_scb);
 
 /* main functions */
 void bta_av_api_deregister(tBTA_AV_DATA* p_data);
-void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb, BT_HDR* p_buf);
+void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb, BtaAvMediaPacket* p_packet);
 void bta_av_sm_execute(tBTA_AV_CB* p_cb, uint16_t event, tBTA_AV_DATA* p_data);
 void bta_av_ssm_execute(tBTA_AV_SCB* p_scb, uint16_t event, tBTA_AV_DATA* p_data);
 bool bta_av_hdl_event(const BT_HDR_RIGID* p_msg);
@@ -40,6 +40,7 @@
 #include "btif/include/btif_config.h"
 #include "internal_include/bt_target.h"
 #include "osi/include/allocator.h"
+#include "stack/include/a2dp_codec_api.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/bt_uuid16.h"
@@ -286,7 +287,7 @@ static tBTA_AV_SCB* bta_av_alloc_scb(tBTA_AV_CHNL chnl) {
     p_ret->chnl = chnl;
     p_ret->hndl = (tBTA_AV_HNDL)((xx + 1) | chnl);
     p_ret->hdi = xx;
-    p_ret->a2dp_list = list_new(nullptr);
+    p_ret->a2dp_list = list_new(BtaAvMediaPacket::Release);
     p_ret->avrc_ct_timer = alarm_new("bta_av.avrc_ct_timer");
     bta_av_cb.p_scb[xx] = p_ret;
     return p_ret;
@@ -1119,19 +1120,18 @@ bool bta_av_link_role_ok(tBTA_AV_SCB* p_scb, uint8_t bits) {
  *
  * Function         bta_av_dup_audio_buf
  *
- * Description      dup the audio data to the q_info.a2dp of other audio
- *                  channels
+ * Description      share the audio packet with the q_info.a2dp of the other
+ *                  audio channels streaming the same codec configuration
  *
  * Returns          void
  *
  ******************************************************************************/
-void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb, BT_HDR* p_buf) {
+void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb, BtaAvMediaPacket* p_packet) {
   /* Test whether there is more than one audio channel connected */
-  if ((p_buf == NULL) || (bta_av_cb.audio_open_cnt < 2)) {
+  if ((p_packet == NULL) || (bta_av_cb.audio_open_cnt < 2)) {
     return;
   }
 
-  uint16_t copy_size = BT_HDR_SIZE + p_buf->len + p_buf->offset;
   for (int i = 0; i < BTA_AV_NUM_STRS; i++) {
     tBTA_AV_SCB* p_scbi = bta_av_cb.p_scb[i];
 
@@ -1144,18 +1144,21 @@ void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb, BT_HDR* p_buf) {
     if (!(bta_av_cb.conn_audio & BTA_AV_HNDL_TO_MSK(i))) {
       continue; /* Audio is not connected */
     }
+    if (!A2DP_CodecEquals(p_scb->cfg.codec_info, p_scbi->cfg.codec_info)) {
+      /* The packet was encoded for another configuration */
+      log::verbose("peer {} codec {} differs from {}, not sharing", p_scbi->PeerAddress(),
+                   A2DP_CodecName(p_scbi->cfg.codec_info), A2DP_CodecName(p_scb->cfg.codec_info));
+      continue;
+    }
 
     /* Enqueue the data */
-    BT_HDR* p_new = (BT_HDR*)osi_malloc(copy_size);
-    memcpy(p_new, p_buf, copy_size);
-    list_append(p_scbi->a2dp_list, p_new);
+    p_packet->AddRef();
+    list_append(p_scbi->a2dp_list, p_packet);
 
     if (list_length(p_scbi->a2dp_list) > p_bta_av_cfg->audio_mqs) {
       // Drop the oldest packet
       bta_av_co_audio_drop(p_scbi->hndl, p_scbi->PeerAddress());
-      BT_HDR* p_buf_drop = static_cast<BT_HDR*>(list_front(p_scbi->a2dp_list));
-      list_remove(p_scbi->a2dp_list, p_buf_drop);
-      osi_free(p_buf_drop);
+      list_remove(p_scbi->a2dp_list, list_front(p_scbi->a2dp_list));
     }
   }
 }
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "osi/include/allocator.h"
+#include "stack/include/bt_hdr.h"
+
+/**
+ * An encoded media packet queued on the a2dp_list of the audio channels
+ * streaming it.
+ *
+ * When several sinks stream the same codec configuration, the packet read
+ * from the encoder is shared by their queues instead of being copied into
+ * each of them. A channel only gets a buffer of its own when it hands the
+ * packet to AVDTP, which consumes and modifies it: the last channel gets
+ * the encoded buffer itself and the others a copy. Packets dropped from a
+ * congested channel are never copied.
+ *
+ * Only used from the BTA thread, so the reference count is not atomic.
+ */
+class BtaAvMediaPacket {
+public:
+  // Wraps |p_buf|, read from the encoder, with a single reference.
+  static BtaAvMediaPacket* Create(BT_HDR* p_buf, uint32_t timestamp) {
+    return new BtaAvMediaPacket(p_buf, timestamp);
+  }
+
+  void AddRef() { refs_++; }
+
+  // Drops a reference. Takes a void* to be usable as the free callback of
+  // the list_t queues holding the packets.
+  static void Release(void* data) {
+    BtaAvMediaPacket* packet = static_cast<BtaAvMediaPacket*>(data);
+    if (--packet->refs_ == 0) {
+      delete packet;
+    }
+  }
+
+  // Returns a buffer owned by the caller, holding the packet. The reference
+  // of the caller must still be released.
+  BT_HDR* Take() {
+    if (refs_ == 1) {
+      BT_HDR* p_buf = p_buf_;
+      p_buf_ = nullptr;
+      return p_buf;
+    }
+    size_t copy_size = BT_HDR_SIZE + p_buf_->offset + p_buf_->len;
+    BT_HDR* p_copy = static_cast<BT_HDR*>(osi_malloc(copy_size));
+    memcpy(p_copy, p_buf_, copy_size);
+    return p_copy;
+  }
+
+  uint32_t timestamp() const { return timestamp_; }
+  int refs() const { return refs_; }
+
+private:
+  BtaAvMediaPacket(BT_HDR* p_buf, uint32_t timestamp) : p_buf_(p_buf), timestamp_(timestamp) {}
+  ~BtaAvMediaPacket() { osi_free(p_buf_); }
+
+  BtaAvMediaPacket(const BtaAvMediaPacket&) = delete;
+  BtaAvMediaPacket& operator=(const BtaAvMediaPacket&) = delete;
+
+  BT_HDR* p_buf_;
+  uint32_t timestamp_;
+  int refs_ = 1;
+};
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "bta/av/bta_av_media_packet.h"
+#include "osi/include/allocator.h"
+#include "stack/include/bt_hdr.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+namespace {
+
+// Room for the AVDTP, L2CAP and HCI headers, and the payload of a 2-DH5
+// packet, as the SBC encoder produces at its highest bitrate.
+constexpr uint16_t kPacketOffset = 23;
+constexpr uint16_t kPacketLength = 656;
+
+BT_HDR* EncodePacket() {
+  BT_HDR* p_buf = static_cast<BT_HDR*>(osi_malloc(BT_HDR_SIZE + kPacketOffset + kPacketLength));
+  p_buf->offset = kPacketOffset;
+  p_buf->len = kPacketLength;
+  p_buf->layer_specific = 0;
+  memset(reinterpret_cast<uint8_t*>(p_buf + 1) + kPacketOffset, 0x5a, kPacketLength);
+  return p_buf;
+}
+
+// Hands a packet to AVDTP, which writes its header in the offset area and
+// frees the buffer once sent.
+void SendPacket(BT_HDR* p_buf) {
+  p_buf->offset -= 12;
+  p_buf->len += 12;
+  memset(reinterpret_cast<uint8_t*>(p_buf + 1) + p_buf->offset, 0x80, 12);
+  benchmark::DoNotOptimize(p_buf);
+  osi_free(p_buf);
+}
+
+void SetSinkCounters(State& state) {
+  int64_t sinks = state.range(0);
+  state.SetItemsProcessed(state.iterations() * sinks);
+  state.counters["time_per_sink"] = Counter(static_cast<double>(state.iterations() * sinks),
+                                            Counter::kIsRate | Counter::kInvert);
+}
+
+// What the fan out used to do: copy every packet read from the encoder into
+// the queue of each other sink, including the congested ones dropping it.
+void BM_CopyFanOut(State& state) {
+  int64_t sinks = state.range(0);
+  int64_t congested_sinks = state.range(1);
+  for (auto _ : state) {
+    BT_HDR* p_buf = EncodePacket();
+    size_t copy_size = BT_HDR_SIZE + p_buf->offset + p_buf->len;
+    for (int64_t i = 1; i < sinks; i++) {
+      BT_HDR* p_copy = static_cast<BT_HDR*>(osi_malloc(copy_size));
+      memcpy(p_copy, p_buf, copy_size);
+      if (i <= congested_sinks) {
+        osi_free(p_copy);
+      } else {
+        SendPacket(p_copy);
+      }
+    }
+    SendPacket(p_buf);
+  }
+  SetSinkCounters(state);
+}
+BENCHMARK(BM_CopyFanOut)->ArgsProduct({{1, 2, 3, 4}, {0}})->Args({4, 2});
+
+void BM_SharedFanOut(State& state) {
+  int64_t sinks = state.range(0);
+  int64_t congested_sinks = state.range(1);
+  for (auto _ : state) {
+    BtaAvMediaPacket* p_packet = BtaAvMediaPacket::Create(EncodePacket(), 0);
+    for (int64_t i = 1; i < sinks; i++) {
+      p_packet->AddRef();
+    }
+    for (int64_t i = 1; i < sinks; i++) {
+      if (i > congested_sinks) {
+        SendPacket(p_packet->Take());
+      }
+      BtaAvMediaPacket::Release(p_packet);
+    }
+    SendPacket(p_packet->Take());
+    BtaAvMediaPacket::Release(p_packet);
+  }
+  SetSinkCounters(state);
+}
+BENCHMARK(BM_SharedFanOut)->ArgsProduct({{1, 2, 3, 4}, {0}})->Args({4, 2});
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -275,6 +275,7 @@ private:
   // from either the left or right connection, whichever is first
   // connected.
   std::unique_ptr<bluetooth::audio::asrc::SourceAudioHalAsrc> asrc;
+  std::vector<const std::vector<uint8_t>*> asrc_buffers;
 
 public:
   ~HearingAidImpl() override = default;
@@ -1347,7 +1348,8 @@ public:
       return OnAudioDataReady(data);
     }
 
-    for (auto const resampled_data : asrc->Run(data)) {
+    asrc->Run(data, &asrc_buffers);
+    for (auto const resampled_data : asrc_buffers) {
       OnAudioDataReady(*resampled_data);
     }
   }
@@ -50,6 +50,7 @@ typedef enum : uint8_t {
 
 typedef struct {
   tBTA_HH_UHID_INBOUND_EVT_TYPE type;
+  uint64_t timestamp_us;  // boottime at which the event was handed to UHID I/O
   union {
     uhid_event uhid;
   };
@@ -109,6 +109,7 @@ public:
   LeAudioSourceAudioHalClient::Callbacks* audioSourceCallbacks_ = nullptr;
   std::mutex audioSourceCallbacksMutex_;
   std::unique_ptr<bluetooth::audio::asrc::SourceAudioHalAsrc> asrc_;
+  std::vector<const std::vector<uint8_t>*> asrc_buffers_;
 
   base::WeakPtrFactory<SourceImpl> weak_factory_{this};
 };
@@ -214,10 +215,10 @@ void SourceImpl::SendAudioData() {
   }
 
   if (com::android::bluetooth::flags::leaudio_hal_client_asrc()) {
-    auto asrc_buffers = asrc_->Run(data);
+    asrc_->Run(data, &asrc_buffers_);
 
     std::lock_guard<std::mutex> guard(audioSourceCallbacksMutex_);
-    for (auto buffer : asrc_buffers) {
+    for (auto buffer : asrc_buffers_) {
       if (audioSourceCallbacks_ != nullptr) {
         audioSourceCallbacks_->OnAudioDataReady(*buffer);
       }
@@ -18,6 +18,8 @@
 #include <base/location.h>
 #include <gtest/gtest.h>
 
+#include <cstring>
+
 #include "bta/av/bta_av_int.h"
 #include "bta/hf_client/bta_hf_client_int.h"
 #include "test/common/mock_functions.h"
@@ -67,3 +69,62 @@ TEST_F(BtaAvTest, bta_av_rc_opened) {
   };
   bta_av_rc_opened(&cb, &data);
 }
+
+namespace {
+BT_HDR* MakeMediaBuffer(uint8_t value) {
+  BT_HDR* p_buf = static_cast<BT_HDR*>(osi_malloc(BT_DEFAULT_BUFFER_SIZE));
+  p_buf->offset = 16;
+  p_buf->len = 8;
+  p_buf->layer_specific = 0;
+  memset(reinterpret_cast<uint8_t*>(p_buf + 1) + p_buf->offset, value, p_buf->len);
+  return p_buf;
+}
+}  // namespace
+
+TEST_F(BtaAvTest, media_packet_last_reference_takes_buffer) {
+  BT_HDR* p_buf = MakeMediaBuffer(0x5a);
+  BtaAvMediaPacket* p_packet = BtaAvMediaPacket::Create(p_buf, 1234);
+  ASSERT_EQ(1234u, p_packet->timestamp());
+
+  ASSERT_EQ(p_buf, p_packet->Take());
+  BtaAvMediaPacket::Release(p_packet);
+  osi_free(p_buf);
+}
+
+TEST_F(BtaAvTest, media_packet_shared_references_take_copies) {
+  BT_HDR* p_buf = MakeMediaBuffer(0x5a);
+  BtaAvMediaPacket* p_packet = BtaAvMediaPacket::Create(p_buf, 1234);
+  p_packet->AddRef();
+  p_packet->AddRef();
+  ASSERT_EQ(3, p_packet->refs());
+
+  BT_HDR* p_first = p_packet->Take();
+  ASSERT_NE(p_buf, p_first);
+  ASSERT_EQ(p_buf->offset, p_first->offset);
+  ASSERT_EQ(p_buf->len, p_first->len);
+  ASSERT_EQ(0, memcmp(reinterpret_cast<uint8_t*>(p_buf + 1) + p_buf->offset,
+                      reinterpret_cast<uint8_t*>(p_first + 1) + p_first->offset, p_buf->len));
+  BtaAvMediaPacket::Release(p_packet);
+
+  // A congested channel drops its reference without copying the packet.
+  BtaAvMediaPacket::Release(p_packet);
+
+  ASSERT_EQ(p_buf, p_packet->Take());
+  BtaAvMediaPacket::Release(p_packet);
+  osi_free(p_first);
+  osi_free(p_buf);
+}
+
+TEST_F(BtaAvTest, media_packet_queue_releases_references) {
+  list_t* first_list = list_new(BtaAvMediaPacket::Release);
+  list_t* second_list = list_new(BtaAvMediaPacket::Release);
+  BtaAvMediaPacket* p_packet = BtaAvMediaPacket::Create(MakeMediaBuffer(0x5a), 1234);
+  list_append(first_list, p_packet);
+  p_packet->AddRef();
+  list_append(second_list, p_packet);
+
+  list_clear(first_list);
+  ASSERT_EQ(1, p_packet->refs());
+  list_free(first_list);
+  list_free(second_list);
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "btif/include/btif_sock_thread.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// Size of an RFCOMM frame at the default MTU.
+constexpr size_t kPacketSize = 990;
+
+int poll_thread = -1;
+std::atomic<int64_t> packets_read = 0;
+
+// Stands in for btsock_rfc/l2cap_signaled(): reads one packet, as the stack
+// does before handing it to BTA, and watches the socket again.
+void OnSignaled(int fd, int /* type */, int flags, uint32_t user_id) {
+  if (!(flags & SOCK_THREAD_FD_RD)) {
+    return;
+  }
+  std::array<uint8_t, kPacketSize> packet;
+  if (recv(fd, packet.data(), packet.size(), MSG_DONTWAIT) > 0) {
+    packets_read.fetch_add(1, std::memory_order_relaxed);
+  }
+  btsock_thread_add_fd(poll_thread, fd, 0, SOCK_THREAD_FD_RD | SOCK_THREAD_ADD_FD_SYNC, user_id);
+}
+
+// Every app socket sends one packet, and the poll thread reads them all.
+void BM_SocketPollThread(State& state) {
+  btsock_thread_init();
+  poll_thread = btsock_thread_create(OnSignaled, nullptr);
+
+  std::vector<std::pair<int, int>> sockets(state.range(0));
+  for (size_t i = 0; i < sockets.size(); i++) {
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds);
+    sockets[i] = {fds[0], fds[1]};
+    btsock_thread_add_fd(poll_thread, fds[0], 0, SOCK_THREAD_FD_RD, i);
+  }
+
+  std::array<uint8_t, kPacketSize> packet = {};
+  int64_t sent = 0;
+  packets_read = 0;
+  for (auto _ : state) {
+    for (auto [our_fd, app_fd] : sockets) {
+      send(app_fd, packet.data(), packet.size(), 0);
+    }
+    sent += sockets.size();
+    while (packets_read.load(std::memory_order_relaxed) < sent) {
+      std::this_thread::yield();
+    }
+  }
+  state.SetItemsProcessed(sent);
+  state.SetBytesProcessed(sent * kPacketSize);
+
+  btsock_thread_exit(poll_thread);
+  for (auto [our_fd, app_fd] : sockets) {
+    close(our_fd);
+    close(app_fd);
+  }
+}
+
+BENCHMARK(BM_SocketPollThread)->ArgName("sockets")->Arg(1)->Arg(63)->Arg(256)->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
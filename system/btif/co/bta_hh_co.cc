@@ -25,13 +25,22 @@
 #include <pthread.h>
 #include <stdint.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cerrno>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "bta_hh_api.h"
 #include "btif_hh.h"
+#include "common/time_util.h"
 #include "hci/controller_interface.h"
 #include "main/shim/entry.h"
 #include "osi/include/allocator.h"
@@ -55,6 +64,12 @@ static tBTA_HH_RPT_CACHE_ENTRY sReportCache[BTA_HH_NV_LOAD_MAX];
 #define BTA_HH_UHID_POLL_PERIOD2_MS -1
 /* Max number of polling interrupt allowed */
 #define BTA_HH_UHID_INTERRUPT_COUNT_MAX 100
+/* Name of the UHID I/O thread shared by all devices */
+#define BT_HH_UHID_IO_THREAD_NAME "bt_hh_uhid_io"
+/* Max number of epoll events handled per wakeup of the UHID I/O thread */
+#define BTA_HH_UHID_IO_MAX_EVENTS 16
+/* Time to wait for the UHID I/O thread to release a closing device */
+#define BTA_HH_UHID_CLOSE_TIMEOUT_MS 1000
 
 using namespace bluetooth;
 
@@ -316,9 +331,50 @@ static int uhid_read_outbound_event(btif_hh_uhid_t* p_uhid) {
   return 0;
 }
 
+/* Input report latency from bta_hh_co_write() to the uhid write, updated by
+ * the UHID I/O thread and read by dumpsys. */
+class UhidInputLatency {
+public:
+  static constexpr std::array<uint64_t, 5> kBucketUpperBoundsUs = {1000, 2000, 4000, 8000, 16000};
+
+  void Record(uint64_t latency_us) {
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_us_.fetch_add(latency_us, std::memory_order_relaxed);
+    if (latency_us > max_us_.load(std::memory_order_relaxed)) {
+      max_us_.store(latency_us, std::memory_order_relaxed);
+    }
+    size_t bucket = 0;
+    while (bucket < kBucketUpperBoundsUs.size() && latency_us >= kBucketUpperBoundsUs[bucket]) {
+      bucket++;
+    }
+    histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Dump(int fd) const {
+    uint64_t count = count_.load(std::memory_order_relaxed);
+    uint64_t total_us = total_us_.load(std::memory_order_relaxed);
+    dprintf(fd, "    input reports:%llu avg_latency_us:%llu max_latency_us:%llu\n",
+            (unsigned long long)count, (unsigned long long)(count ? total_us / count : 0),
+            (unsigned long long)max_us_.load(std::memory_order_relaxed));
+    dprintf(fd, "    latency histogram (ms) <1:%llu <2:%llu <4:%llu <8:%llu <16:%llu >=16:%llu\n",
+            (unsigned long long)histogram_[0].load(std::memory_order_relaxed),
+            (unsigned long long)histogram_[1].load(std::memory_order_relaxed),
+            (unsigned long long)histogram_[2].load(std::memory_order_relaxed),
+            (unsigned long long)histogram_[3].load(std::memory_order_relaxed),
+            (unsigned long long)histogram_[4].load(std::memory_order_relaxed),
+            (unsigned long long)histogram_[5].load(std::memory_order_relaxed));
+  }
+
+private:
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> total_us_{0};
+  std::atomic<uint64_t> max_us_{0};
+  std::array<std::atomic<uint64_t>, kBucketUpperBoundsUs.size() + 1> histogram_{};
+};
+
 // Parse the internal events received from BTIF and translate to UHID
 // returns -errno when error, 0 when successful, 1 when receiving close event.
-static int uhid_read_inbound_event(btif_hh_uhid_t* p_uhid) {
+static int uhid_read_inbound_event(btif_hh_uhid_t* p_uhid, UhidInputLatency* latency) {
   log::assert_that(p_uhid != nullptr, "assert failed: p_uhid != nullptr");
 
   tBTA_HH_TO_UHID_EVT ev = {};
@@ -339,6 +395,9 @@ static int uhid_read_inbound_event(btif_hh_uhid_t* p_uhid) {
     case BTA_HH_UHID_INBOUND_INPUT_EVT:
       if (p_uhid->ready_for_data) {
         res = uhid_write(p_uhid->fd, &ev.uhid);
+        if (res == 0 && ev.timestamp_us != 0) {
+          latency->Record(bluetooth::common::time_get_os_boottime_us() - ev.timestamp_us);
+        }
       } else {
         uhid_queue_input(p_uhid, &ev.uhid);
       }
@@ -439,6 +498,194 @@ static void uhid_fd_close(btif_hh_uhid_t* p_uhid) {
   }
 }
 
+/*******************************************************************************
+ *
+ * UHID I/O thread
+ *
+ * With the aflags hid_report_queuing, a single thread multiplexes the uhid fd
+ * and the internal event socket of every connected device with epoll. The
+ * thread is started with the first device and exits with the last one.
+ *
+ ******************************************************************************/
+namespace {
+
+class UhidIoThread {
+public:
+  /* Takes ownership of |p_uhid|; it is released on the I/O thread once the
+   * device is closed or its internal socket hangs up. */
+  bool AddDevice(btif_hh_uhid_t* p_uhid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (epoll_fd_ < 0 && !Start()) {
+      return false;
+    }
+
+    auto device = std::make_unique<Device>(p_uhid);
+    if (!Watch(device->outbound)) {
+      return false;
+    }
+    if (!Watch(device->inbound)) {
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, p_uhid->fd, nullptr);
+      return false;
+    }
+    devices_[p_uhid] = std::move(device);
+    return true;
+  }
+
+  void Dump(int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dprintf(fd, "  uhid I/O thread: %s devices:%zu\n", epoll_fd_ < 0 ? "stopped" : "running",
+            devices_.size());
+    for (const auto& [p_uhid, device] : devices_) {
+      dprintf(fd, "  addr:%s handle:%d\n", p_uhid->link_spec.ToRedactedStringForLogging().c_str(),
+              p_uhid->dev_handle);
+      device->latency.Dump(fd);
+    }
+  }
+
+private:
+  struct Device;
+  struct Source {
+    Device* device;
+    bool inbound;
+  };
+  struct Device {
+    explicit Device(btif_hh_uhid_t* p_uhid) : p_uhid(p_uhid) {}
+    btif_hh_uhid_t* p_uhid;
+    Source outbound{this, false};
+    Source inbound{this, true};
+    UhidInputLatency latency;
+  };
+
+  // Called with |mutex_| held. The thread exits, closing the epoll fd, once
+  // the last device is gone.
+  bool Start() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+      log::error("Failed to create epoll fd: {}", strerror(errno));
+      return false;
+    }
+    pthread_t thread_id;
+    if (pthread_create(&thread_id, nullptr, &UhidIoThread::Run, this) != 0) {
+      log::error("pthread_create : {}", strerror(errno));
+      close(epoll_fd_);
+      epoll_fd_ = -1;
+      return false;
+    }
+    pthread_detach(thread_id);
+    return true;
+  }
+
+  // Called with |mutex_| held.
+  bool Watch(Source& source) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = &source;
+    int fd = source.inbound ? source.device->p_uhid->internal_recv_fd : source.device->p_uhid->fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+      log::error("Failed to watch fd {}: {}", fd, strerror(errno));
+      return false;
+    }
+    return true;
+  }
+
+  static void* Run(void* arg) {
+    UhidIoThread* self = static_cast<UhidIoThread*>(arg);
+
+    // This thread is created by bt_main_thread with RT priority. Lower the
+    // thread priority here since the tasks in this thread is not timing
+    // critical.
+    struct sched_param sched_params = {};
+    sched_params.sched_priority = THREAD_NORMAL_PRIORITY;
+    if (sched_setscheduler(gettid(), SCHED_OTHER, &sched_params)) {
+      log::warn("Failed to set thread priority to normal: {}", strerror(errno));
+    }
+    pthread_setname_np(pthread_self(), BT_HH_UHID_IO_THREAD_NAME);
+
+    int epoll_fd;
+    {
+      std::lock_guard<std::mutex> lock(self->mutex_);
+      epoll_fd = self->epoll_fd_;
+    }
+    while (self->RunOnce(epoll_fd)) {
+    }
+    log::info("UHID I/O thread stopped");
+    return nullptr;
+  }
+
+  // Returns false once the last device is gone and the thread should exit.
+  bool RunOnce(int epoll_fd) {
+    std::array<struct epoll_event, BTA_HH_UHID_IO_MAX_EVENTS> events;
+    int ret;
+    OSI_NO_INTR(ret = epoll_wait(epoll_fd, events.data(), events.size(), -1));
+    if (ret < 0) {
+      log::error("Cannot poll for fds: {}", strerror(errno));
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (!devices_.empty()) {
+        Close(epoll_fd, devices_.begin()->second.get());
+      }
+      close(epoll_fd);
+      epoll_fd_ = -1;
+      return false;
+    }
+
+    std::vector<Device*> closed;
+    for (int i = 0; i < ret; i++) {
+      Source* source = static_cast<Source*>(events[i].data.ptr);
+      Device* device = source->device;
+      if (std::find(closed.begin(), closed.end(), device) != closed.end()) {
+        continue;
+      }
+
+      int result = 0;
+      if (events[i].events & EPOLLIN) {
+        result = source->inbound ? uhid_read_inbound_event(device->p_uhid, &device->latency)
+                                 : uhid_read_outbound_event(device->p_uhid);
+        if (result < 0) {
+          log::error("Unhandled UHID {} event, error: {}", source->inbound ? "inbound" : "outbound",
+                     result);
+        }
+      } else if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+        log::error("{} fd hangup, disconnect UHID", source->inbound ? "inbound" : "outbound");
+        result = -EPIPE;
+      }
+
+      if (result != 0) {
+        closed.push_back(device);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Device* device : closed) {
+      Close(epoll_fd, device);
+    }
+    if (devices_.empty()) {
+      close(epoll_fd);
+      epoll_fd_ = -1;
+      return false;
+    }
+    return true;
+  }
+
+  // Called with |mutex_| held.
+  void Close(int epoll_fd, Device* device) {
+    btif_hh_uhid_t* p_uhid = device->p_uhid;
+    log::info("Polling stopped for device {}", p_uhid->link_spec);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, p_uhid->fd, nullptr);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, p_uhid->internal_recv_fd, nullptr);
+    devices_.erase(p_uhid);
+    /* Closing internal_recv_fd signals the hangup to bta_hh_co_close. */
+    uhid_fd_close(p_uhid);
+  }
+
+  std::mutex mutex_;
+  int epoll_fd_ = -1;
+  std::unordered_map<btif_hh_uhid_t*, std::unique_ptr<Device>> devices_;
+};
+
+UhidIoThread uhid_io_thread;
+
+}  // namespace
+
 /* Internal function to open the UHID driver*/
 static bool uhid_fd_open(btif_hh_device_t* p_dev) {
   if (!com::android::bluetooth::flags::hid_report_queuing()) {
@@ -468,10 +715,36 @@ static bool uhid_fd_open(btif_hh_device_t* p_dev) {
     uhid->dev_handle = p_dev->dev_handle;
     uhid->internal_recv_fd = sockets[0];
     uhid->internal_send_fd = sockets[1];
-    p_dev->internal_send_fd = sockets[1];
 
-    // UHID thread owns the uhid struct and is responsible to free it.
-    p_dev->hh_poll_thread_id = create_thread(btif_hh_poll_event_thread, uhid);
+    uhid->fd = open(dev_path, O_RDWR | O_CLOEXEC);
+    if (uhid->fd < 0) {
+      log::error("Failed to open uhid, err:{}", strerror(errno));
+      close(sockets[0]);
+      close(sockets[1]);
+      osi_free(uhid);
+      return false;
+    }
+    // Set the uhid fd as non-blocking to ensure we never block the I/O thread
+    uhid_set_non_blocking(uhid->fd);
+    uhid->ready_for_data = false;
+    uhid->ready_timer = alarm_new("uhid_ready_timer");
+
+    uhid->get_rpt_id_queue = fixed_queue_new(SIZE_MAX);
+    log::assert_that(uhid->get_rpt_id_queue, "assert failed: uhid->get_rpt_id_queue");
+#if ENABLE_UHID_SET_REPORT
+    uhid->set_rpt_id_queue = fixed_queue_new(SIZE_MAX);
+    log::assert_that(uhid->set_rpt_id_queue, "assert failed: uhid->set_rpt_id_queue");
+#endif  // ENABLE_UHID_SET_REPORT
+    uhid->input_queue = fixed_queue_new(SIZE_MAX);
+    log::assert_that(uhid->input_queue, "assert failed: uhid->input_queue");
+
+    // UHID I/O thread owns the uhid struct and is responsible to free it.
+    if (!uhid_io_thread.AddDevice(uhid)) {
+      uhid_fd_close(uhid);
+      close(sockets[1]);
+      return false;
+    }
+    p_dev->internal_send_fd = sockets[1];
   }
   return true;
 }
@@ -509,72 +782,30 @@ static int uhid_fd_poll(btif_hh_uhid_t* p_uhid, struct pollfd* pfds, int nfds) {
 }
 
 static void uhid_start_polling(btif_hh_uhid_t* p_uhid) {
-  if (!com::android::bluetooth::flags::hid_report_queuing()) {
-    std::array<struct pollfd, 1> pfds = {};
-    pfds[0].fd = p_uhid->fd;
-    pfds[0].events = POLLIN;
-
-    while (p_uhid->hh_keep_polling) {
-      int ret = uhid_fd_poll(p_uhid, pfds.data(), 1);
-
-      if (ret < 0) {
-        log::error("Cannot poll for fds: {}\n", strerror(errno));
-        break;
-      } else if (ret == 0) {
-        /* Poll timeout, poll again */
-        continue;
-      }
-
-      /* At least one of the fd is ready */
-      if (pfds[0].revents & POLLIN) {
-        log::verbose("POLLIN");
-        int result = uhid_read_outbound_event(p_uhid);
-        if (result != 0) {
-          log::error("Unhandled UHID event, error: {}", result);
-          break;
-        }
-      }
-    }
-
-    return;
-  }
-
-  std::array<struct pollfd, 2> pfds = {};
+  std::array<struct pollfd, 1> pfds = {};
   pfds[0].fd = p_uhid->fd;
   pfds[0].events = POLLIN;
-  pfds[1].fd = p_uhid->internal_recv_fd;
-  pfds[1].events = POLLIN;
 
-  while (true) {
-    int ret = uhid_fd_poll(p_uhid, pfds.data(), 2);
+  while (p_uhid->hh_keep_polling) {
+    int ret = uhid_fd_poll(p_uhid, pfds.data(), 1);
+
     if (ret < 0) {
       log::error("Cannot poll for fds: {}\n", strerror(errno));
       break;
+    } else if (ret == 0) {
+      /* Poll timeout, poll again */
+      continue;
     }
 
+    /* At least one of the fd is ready */
     if (pfds[0].revents & POLLIN) {
       log::verbose("POLLIN");
       int result = uhid_read_outbound_event(p_uhid);
       if (result != 0) {
-        log::error("Unhandled UHID outbound event, error: {}", result);
+        log::error("Unhandled UHID event, error: {}", result);
         break;
       }
     }
-
-    if (pfds[1].revents & POLLIN) {
-      int result = uhid_read_inbound_event(p_uhid);
-      if (result != 0) {
-        if (result < 0) {
-          log::error("Unhandled UHID inbound event, error: {}", result);
-        }
-        break;
-      }
-    }
-
-    if (pfds[1].revents & POLLHUP) {
-      log::error("inbound fd hangup, disconnect UHID");
-      break;
-    }
   }
 }
 
@@ -614,36 +845,13 @@ static bool uhid_configure_thread(btif_hh_uhid_t* p_uhid) {
 static void* btif_hh_poll_event_thread(void* arg) {
   btif_hh_uhid_t* p_uhid = (btif_hh_uhid_t*)arg;
 
-  if (com::android::bluetooth::flags::hid_report_queuing()) {
-    p_uhid->fd = open(dev_path, O_RDWR | O_CLOEXEC);
-    if (p_uhid->fd < 0) {
-      log::error("Failed to open uhid, err:{}", strerror(errno));
-      close(p_uhid->internal_recv_fd);
-      p_uhid->internal_recv_fd = -1;
-      return 0;
-    }
-    p_uhid->ready_for_data = false;
-    p_uhid->ready_timer = alarm_new("uhid_ready_timer");
-
-    p_uhid->get_rpt_id_queue = fixed_queue_new(SIZE_MAX);
-    log::assert_that(p_uhid->get_rpt_id_queue, "assert failed: p_uhid->get_rpt_id_queue");
-#if ENABLE_UHID_SET_REPORT
-    p_uhid->set_rpt_id_queue = fixed_queue_new(SIZE_MAX);
-    log::assert_that(p_uhid->set_rpt_id_queue, "assert failed: p_uhid->set_rpt_id_queue");
-#endif  // ENABLE_UHID_SET_REPORT
-    p_uhid->input_queue = fixed_queue_new(SIZE_MAX);
-    log::assert_that(p_uhid->input_queue, "assert failed: p_uhid->input_queue");
-  }
-
   if (uhid_configure_thread(p_uhid)) {
     uhid_start_polling(p_uhid);
   }
 
   /* Todo: Disconnect if loop exited due to a failure */
   log::info("Polling thread stopped for device {}", p_uhid->link_spec);
-  if (!com::android::bluetooth::flags::hid_report_queuing()) {
-    p_uhid->hh_keep_polling = 0;
-  }
+  p_uhid->hh_keep_polling = 0;
   uhid_fd_close(p_uhid);
   return 0;
 }
@@ -687,6 +895,7 @@ int bta_hh_co_write(int fd, uint8_t* rpt, uint16_t len) {
   }
 
   to_uhid.type = BTA_HH_UHID_INBOUND_INPUT_EVT;
+  to_uhid.timestamp_us = bluetooth::common::time_get_os_boottime_us();
   return to_uhid_thread(fd, &to_uhid) ? 0 : -1;
 }
 
@@ -811,15 +1020,41 @@ void bta_hh_co_close(btif_hh_device_t* p_dev) {
   if (p_dev->internal_send_fd >= 0) {
     tBTA_HH_TO_UHID_EVT to_uhid = {};
     to_uhid.type = BTA_HH_UHID_INBOUND_CLOSE_EVT;
-    to_uhid_thread(p_dev->internal_send_fd, &to_uhid);
-    pthread_join(p_dev->hh_poll_thread_id, NULL);
-    p_dev->hh_poll_thread_id = -1;
+    if (to_uhid_thread(p_dev->internal_send_fd, &to_uhid)) {
+      /* Wait for the UHID I/O thread to destroy the uhid device, which it
+       * signals by closing the other end of the internal socket. */
+      struct pollfd pfd = {};
+      pfd.fd = p_dev->internal_send_fd;
+      int ret;
+      OSI_NO_INTR(ret = poll(&pfd, 1, BTA_HH_UHID_CLOSE_TIMEOUT_MS));
+      if (ret <= 0) {
+        log::warn("Timed out waiting for UHID device {} to close", p_dev->link_spec);
+      }
+    }
 
     close(p_dev->internal_send_fd);
     p_dev->internal_send_fd = -1;
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_hh_co_dump
+ *
+ * Description      Dumps the UHID I/O thread state and the per-device input
+ *                  report latency.
+ *
+ * Parameters       fd  - file descriptor to write the dump to
+ *
+ * Returns          void
+ ******************************************************************************/
+void bta_hh_co_dump(int fd) {
+  if (!com::android::bluetooth::flags::hid_report_queuing()) {
+    return;
+  }
+  uhid_io_thread.Dump(fd);
+}
+
 /*******************************************************************************
  *
  * Function         bta_hh_co_data
@@ -948,9 +1183,7 @@ void bta_hh_co_send_hid_info(btif_hh_device_t* p_dev, const char* dev_name, uint
   if (!to_uhid_thread(p_dev->internal_send_fd, &to_uhid)) {
     log::warn("Error: failed to send DSCP");
     if (p_dev->internal_send_fd >= 0) {
-      // Detach the uhid thread. It will exit by itself upon receiving hangup.
-      pthread_detach(p_dev->hh_poll_thread_id);
-      p_dev->hh_poll_thread_id = -1;
+      // The UHID I/O thread releases the device upon receiving hangup.
       close(p_dev->internal_send_fd);
       p_dev->internal_send_fd = -1;
     }
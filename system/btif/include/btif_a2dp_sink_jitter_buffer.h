@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Playout control of the audio decoded by the A2DP sink.
+//
+// Packets are decoded as they arrive, and the decoded audio is written to the
+// audio track. The jitter buffer is the audio written ahead of the track: its
+// depth is what was written, minus what the track played since the start of
+// the playout. Audio is held until the depth reaches a target, which follows
+// the jitter of the packet arrivals. The drift between the clock of the remote
+// source and the clock of the track is compensated by resampling the decoded
+// audio, by the ratio the jitter buffer derives from its depth.
+class A2dpSinkJitterBuffer {
+public:
+  static constexpr uint64_t kMinTargetDepthUs = 40 * 1000;
+  static constexpr uint64_t kMaxTargetDepthUs = 300 * 1000;
+
+  // What to do with the decoded audio held by the caller.
+  enum class Action {
+    kHold,   // Keep it until the target depth is reached
+    kWrite,  // Write it, with the audio held before, to the track
+    kDrop,   // Drop it, with the audio held before
+  };
+
+  struct Stats {
+    size_t packets;
+    size_t prebuffers;  // Times the playout (re)started
+    size_t underruns;
+    uint64_t underrun_us;  // Total time the track ran dry
+    size_t dropped_packets;
+    uint64_t dropped_us;
+    uint64_t total_depth_us;  // Sum of the depth after each write
+    size_t depth_samples;
+    uint64_t max_depth_us;
+  };
+
+  A2dpSinkJitterBuffer() { Reset(); }
+
+  // Stops the playout, and forgets the timing of the previous packets. The
+  // statistics are kept.
+  void Reset();
+
+  // Accounts a packet received at `arrival_us`, and decoded into
+  // `duration_us` of audio.
+  void OnPacket(uint64_t arrival_us, uint64_t duration_us);
+
+  // Accounts `duration_us` of audio produced at `now_us` for the track, once
+  // resampled, and tells what to do with it.
+  Action OnAudio(uint64_t now_us, uint64_t duration_us);
+
+  // Ratio of input samples per output sample the decoded audio is resampled
+  // with. It is greater than 1.0 when the remote clock is faster.
+  double ratio() const { return ratio_; }
+
+  bool playing() const { return playing_; }
+  uint64_t jitter_us() const { return jitter_us_; }
+  uint64_t target_depth_us() const { return target_depth_us_; }
+  int64_t DepthUs(uint64_t now_us) const;
+  const Stats& stats() const { return stats_; }
+
+  void Dump(int fd) const;
+
+private:
+  void UpdateTargetDepth();
+  void UpdateRatio(int64_t depth_us);
+
+  // Inter-arrival jitter estimate, as in RFC 3550 section 6.4.1.
+  bool has_last_packet_;
+  uint64_t last_arrival_us_;
+  uint64_t last_duration_us_;
+  uint64_t jitter_us_;
+  uint64_t max_duration_us_;
+  uint64_t target_depth_us_;
+
+  bool playing_;
+  uint64_t held_us_;
+  uint64_t playout_start_us_;
+  uint64_t written_us_;
+
+  double depth_error_us_;  // Low-pass filtered deviation from the target
+  double ratio_;
+
+  Stats stats_ = {};
+};
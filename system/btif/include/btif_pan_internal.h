@@ -28,6 +28,7 @@
 #define BTIF_PAN_INTERNAL_H
 
 #include "internal_include/bt_target.h"
+#include "osi/include/fixed_queue.h"
 #include "types/raw_address.h"
 
 /*******************************************************************************
@@ -73,8 +74,9 @@ typedef struct {
   int open_count;
   int flow;  // 1: outbound data flow on; 0: outbound data flow off
   btpan_conn_t conns[MAX_PAN_CONNS];
-  int congest_packet_size;
-  unsigned char congest_packet[1600];  // max ethernet packet size
+  // Frames read from the TAP driver that are waiting to be handed to BNEP.
+  // Filled in batches by the PAN read thread, drained on the main thread.
+  fixed_queue_t* pending_q;
 } btpan_cb_t;
 
 /*******************************************************************************
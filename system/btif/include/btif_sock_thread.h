@@ -44,6 +44,10 @@ typedef void (*btsock_cmd_cb)(int cmd_fd, int type, int size, uint32_t user_id);
 void btsock_thread_init();
 int btsock_thread_add_fd(int handle, int fd, int type, int flags, uint32_t user_id);
 int btsock_thread_wakeup(int handle);
+/* Stops monitoring fd and closes it in the socket poll thread, so that the fd
+ * number can't be reused while it is still in the poll set. The fd is closed
+ * right away when the thread is gone. */
+int btsock_thread_remove_fd_and_close(int handle, int fd);
 int btsock_thread_create(btsock_signaled_cb callback, btsock_cmd_cb cmd_callback);
 int btsock_thread_exit(int handle);
 
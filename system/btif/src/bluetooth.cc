@@ -29,6 +29,7 @@
 
 #include <bluetooth/log.h>
 #include <com_android_bluetooth_flags.h>
+#include <fcntl.h>
 #include <hardware/bluetooth.h>
 #include <hardware/bluetooth_headset_interface.h>
 #include <hardware/bt_av.h>
@@ -84,6 +85,7 @@
 #include "common/address_obfuscator.h"
 #include "common/metrics.h"
 #include "common/os_utils.h"
+#include "common/task_profiler.h"
 #include "device/include/device_iot_config.h"
 #include "device/include/esco_parameters.h"
 #include "device/include/interop.h"
@@ -869,6 +871,35 @@ static int set_event_filter_connection_setup_all_devices() {
   return BT_STATUS_SUCCESS;
 }
 
+// Dumpsys argument exporting the recent tasks of the stack threads for Perfetto.
+static constexpr char kArgumentTaskTrace[] = "--task-trace";
+static constexpr char kTaskTraceFileName[] = "bt_task_trace.json";
+
+static void dump_task_profiler(int fd, const char** arguments) {
+  bluetooth::common::TaskProfiler::Dump(fd);
+
+  bool export_trace = false;
+  for (const char** argument = arguments; argument != nullptr && *argument != nullptr;
+       argument++) {
+    export_trace |= strcmp(*argument, kArgumentTaskTrace) == 0;
+  }
+  if (!export_trace) {
+    return;
+  }
+
+  // Written next to the snoop log, where bug reports pick up the stack logs.
+  std::string path = bluetooth::os::ParameterProvider::SnoopLogFilePath();
+  path = path.substr(0, path.rfind('/') + 1) + kTaskTraceFileName;
+  int trace_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+  if (trace_fd < 0) {
+    dprintf(fd, "  Unable to open %s: %s\n", path.c_str(), strerror(errno));
+    return;
+  }
+  bluetooth::common::TaskProfiler::ExportTrace(trace_fd);
+  close(trace_fd);
+  dprintf(fd, "  Task trace written to %s\n", path.c_str());
+}
+
 static void dump(int fd, const char** arguments) {
   log::debug("Started bluetooth dumpsys");
   btif_debug_conn_dump(fd);
@@ -904,6 +935,7 @@ static void dump(int fd, const char** arguments) {
   DumpsysBtm(fd);
   bluetooth::shim::Dump(fd, arguments);
   power_telemetry::GetInstance().Dumpsys(fd);
+  dump_task_profiler(fd, arguments);
   log::debug("Finished bluetooth dumpsys");
 }
 
@@ -24,23 +24,29 @@
 #include <base/functional/bind.h>
 #include <bluetooth/log.h>
 #include <com_android_bluetooth_flags.h>
+#include <stdio.h>
 
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
+#include "audio/asrc/asrc_resampler.h"
+#include "btif/include/btif_a2dp_sink_jitter_buffer.h"
 #include "btif/include/btif_av.h"
 #include "btif/include/btif_av_co.h"
 #include "btif/include/btif_avrcp_audio_track.h"
 #include "btif/include/btif_util.h"  // CASE_RETURN_STR
 #include "common/message_loop_thread.h"
+#include "common/time_util.h"
 #include "hardware/bt_av.h"
-#include "osi/include/alarm.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
 #include "stack/include/bt_hdr.h"
 #include "types/raw_address.h"
 
+using bluetooth::audio::asrc::SinkAudioAsrc;
 using bluetooth::common::MessageLoopThread;
 using LockGuard = std::lock_guard<std::mutex>;
 using namespace bluetooth;
@@ -50,11 +56,6 @@ using namespace bluetooth;
  */
 #define MAX_INPUT_A2DP_FRAME_QUEUE_SZ (MAX_PCM_FRAME_NUM_PER_TICK * 2)
 
-#define BTIF_SINK_MEDIA_TIME_TICK_MS 20
-
-/* In case of A2DP Sink, we will delay start by 5 AVDTP Packets */
-#define MAX_A2DP_DELAYED_START_FRAME_COUNT 5
-
 enum {
   BTIF_A2DP_SINK_STATE_OFF,
   BTIF_A2DP_SINK_STATE_STARTING_UP,
@@ -90,7 +91,9 @@ public:
       : worker_thread(thread_name),
         rx_audio_queue(nullptr),
         rx_flush(false),
-        decode_alarm(nullptr),
+        decoding(false),
+        decode_scheduled(false),
+        decoded_bytes(0),
         sample_rate(0),
         channel_count(0),
         rx_focus_state(BTIF_A2DP_SINK_FOCUS_NOT_GRANTED),
@@ -105,8 +108,12 @@ public:
     audio_track = nullptr;
     fixed_queue_free(rx_audio_queue, nullptr);
     rx_audio_queue = nullptr;
-    alarm_free(decode_alarm);
-    decode_alarm = nullptr;
+    decoding = false;
+    decode_scheduled = false;
+    jitter_buffer.Reset();
+    asrc.reset();
+    pcm_buffer.clear();
+    decoded_bytes = 0;
     rx_flush = false;
     rx_focus_state = BTIF_A2DP_SINK_FOCUS_NOT_GRANTED;
     sample_rate = 0;
@@ -117,7 +124,12 @@ public:
   MessageLoopThread worker_thread;
   fixed_queue_t* rx_audio_queue;
   bool rx_flush; /* discards any incoming data when true */
-  alarm_t* decode_alarm;
+  bool decoding;
+  bool decode_scheduled; /* a decoding task is posted to the worker thread */
+  A2dpSinkJitterBuffer jitter_buffer;
+  std::unique_ptr<SinkAudioAsrc> asrc; /* compensates the clock drift of the peer */
+  std::vector<uint8_t> pcm_buffer;     /* decoded audio not written to the track yet */
+  size_t decoded_bytes;                /* decoded from the packet being decoded */
   int sample_rate;                             // 32000, 44100, 48000, 96000
   int bits_per_sample;                         // 16, 24, 32
   int channel_count;                           // 1, 2
@@ -142,12 +154,12 @@ static void btif_a2dp_sink_shutdown_delayed();
 static void btif_a2dp_sink_cleanup_delayed();
 static void btif_a2dp_sink_command_ready(BT_HDR_RIGID* p_msg);
 static void btif_a2dp_sink_audio_handle_stop_decoding();
-static void btif_decode_alarm_cb(void* context);
 static void btif_a2dp_sink_audio_handle_start_decoding();
-static void btif_a2dp_sink_avk_handle_timer();
+static void btif_a2dp_sink_decode_queued_packets();
+static void btif_a2dp_sink_reset_playout();
 static void btif_a2dp_sink_audio_rx_flush_req();
 /* Handle incoming media packets A2DP SINK streaming */
-static void btif_a2dp_sink_handle_inc_media(BT_HDR* p_msg);
+static void btif_a2dp_sink_handle_inc_media(BT_HDR* p_msg, uint64_t arrival_us);
 static void btif_a2dp_sink_decoder_update_event(tBTIF_MEDIA_SINK_DECODER_UPDATE* p_buf);
 static void btif_a2dp_sink_decoder_update_event_old(tBTIF_MEDIA_SINK_DECODER_UPDATE* p_buf);
 static void btif_a2dp_sink_clear_track_event();
@@ -222,10 +234,36 @@ static void btif_a2dp_sink_startup_delayed() {
   // Nothing to do
 }
 
+// Called while locked, from the decoding of a packet.
 static void btif_a2dp_sink_on_decode_complete(uint8_t* data, uint32_t len) {
-#ifdef __ANDROID__
-  BtifAvrcpAudioTrackWriteData(btif_a2dp_sink_cb.audio_track, reinterpret_cast<void*>(data), len);
-#endif
+  btif_a2dp_sink_cb.decoded_bytes += len;
+  if (btif_a2dp_sink_cb.asrc != nullptr) {
+    btif_a2dp_sink_cb.asrc->Run(btif_a2dp_sink_cb.jitter_buffer.ratio(), data, len,
+                                &btif_a2dp_sink_cb.pcm_buffer);
+  } else {
+    btif_a2dp_sink_cb.pcm_buffer.insert(btif_a2dp_sink_cb.pcm_buffer.end(), data, data + len);
+  }
+}
+
+// Must be called while locked.
+static uint64_t btif_a2dp_sink_pcm_duration_us(size_t len) {
+  uint64_t bytes_per_second = static_cast<uint64_t>(btif_a2dp_sink_cb.sample_rate) *
+                              btif_a2dp_sink_cb.channel_count *
+                              (btif_a2dp_sink_cb.bits_per_sample / 8);
+  if (bytes_per_second == 0) {
+    return 0;
+  }
+  return len * 1000 * 1000 / bytes_per_second;
+}
+
+// Must be called while locked.
+static void btif_a2dp_sink_setup_asrc() {
+  // The resampler only handles samples aligned to 16 or 32 bits.
+  btif_a2dp_sink_cb.asrc.reset();
+  if (btif_a2dp_sink_cb.bits_per_sample == 16 || btif_a2dp_sink_cb.bits_per_sample == 32) {
+    btif_a2dp_sink_cb.asrc = std::make_unique<SinkAudioAsrc>(btif_a2dp_sink_cb.channel_count,
+                                                             btif_a2dp_sink_cb.bits_per_sample);
+  }
 }
 
 static bool btif_a2dp_sink_initialize_a2dp_control_block(const RawAddress& peer_address) {
@@ -278,6 +316,7 @@ static bool btif_a2dp_sink_initialize_a2dp_control_block(const RawAddress& peer_
   btif_a2dp_sink_cb.sample_rate = sample_rate;
   btif_a2dp_sink_cb.bits_per_sample = bits_per_sample;
   btif_a2dp_sink_cb.channel_count = channel_count;
+  btif_a2dp_sink_setup_asrc();
 
   btif_a2dp_sink_cb.audio_track =
 #ifdef __ANDROID__
@@ -370,8 +409,6 @@ static void btif_a2dp_sink_shutdown_delayed() {
 void btif_a2dp_sink_cleanup() {
   log::info("");
 
-  alarm_t* decode_alarm;
-
   // Make sure the sink is shutdown
   btif_a2dp_sink_shutdown();
 
@@ -384,13 +421,10 @@ void btif_a2dp_sink_cleanup() {
     // Make sure no channels are restarted while shutting down
     btif_a2dp_sink_state = BTIF_A2DP_SINK_STATE_SHUTTING_DOWN;
 
-    decode_alarm = btif_a2dp_sink_cb.decode_alarm;
-    btif_a2dp_sink_cb.decode_alarm = nullptr;
+    // Stop the decoding
+    btif_a2dp_sink_cb.decoding = false;
   }
 
-  // Stop the timer
-  alarm_free(decode_alarm);
-
   // Exit the thread
   btif_a2dp_sink_cb.worker_thread.DoInThread(FROM_HERE,
                                              base::BindOnce(btif_a2dp_sink_cleanup_delayed));
@@ -507,33 +541,14 @@ bool btif_a2dp_sink_on_start() {
 
 static void btif_a2dp_sink_audio_handle_stop_decoding() {
   log::info("");
-  alarm_t* old_alarm;
-  {
-    LockGuard lock(g_mutex);
-    btif_a2dp_sink_cb.rx_flush = true;
-    btif_a2dp_sink_audio_rx_flush_req();
-    old_alarm = btif_a2dp_sink_cb.decode_alarm;
-    btif_a2dp_sink_cb.decode_alarm = nullptr;
-  }
-
-  // Drop the lock here, btif_decode_alarm_cb may in the process of being called
-  // while we alarm free leading to deadlock.
-  //
-  // alarm_free waits for btif_decode_alarm_cb which is waiting for g_mutex.
-  alarm_free(old_alarm);
-
-  {
-    LockGuard lock(g_mutex);
+  LockGuard lock(g_mutex);
+  btif_a2dp_sink_cb.rx_flush = true;
+  btif_a2dp_sink_audio_rx_flush_req();
+  btif_a2dp_sink_cb.decoding = false;
+  btif_a2dp_sink_reset_playout();
 #ifdef __ANDROID__
-    BtifAvrcpAudioTrackPause(btif_a2dp_sink_cb.audio_track);
+  BtifAvrcpAudioTrackPause(btif_a2dp_sink_cb.audio_track);
 #endif
-  }
-}
-
-static void btif_decode_alarm_cb(void* /* context */) {
-  LockGuard lock(g_mutex);
-  btif_a2dp_sink_cb.worker_thread.DoInThread(FROM_HERE,
-                                             base::BindOnce(btif_a2dp_sink_avk_handle_timer));
 }
 
 static void btif_a2dp_sink_clear_track_event() {
@@ -550,7 +565,7 @@ static void btif_a2dp_sink_clear_track_event() {
 // Must be called while locked.
 static void btif_a2dp_sink_audio_handle_start_decoding() {
   log::info("");
-  if (btif_a2dp_sink_cb.decode_alarm != nullptr) {
+  if (btif_a2dp_sink_cb.decoding) {
     return;  // Already started decoding
   }
 
@@ -558,17 +573,18 @@ static void btif_a2dp_sink_audio_handle_start_decoding() {
   BtifAvrcpAudioTrackStart(btif_a2dp_sink_cb.audio_track);
 #endif
 
-  btif_a2dp_sink_cb.decode_alarm = alarm_new_periodic("btif.a2dp_sink_decode");
-  if (btif_a2dp_sink_cb.decode_alarm == nullptr) {
-    log::error("unable to allocate decode alarm");
-    return;
-  }
-  alarm_set(btif_a2dp_sink_cb.decode_alarm, BTIF_SINK_MEDIA_TIME_TICK_MS, btif_decode_alarm_cb,
-            nullptr);
+  btif_a2dp_sink_reset_playout();
+  btif_a2dp_sink_cb.decoding = true;
 }
 
 // Must be called while locked.
-static void btif_a2dp_sink_handle_inc_media(BT_HDR* p_msg) {
+static void btif_a2dp_sink_reset_playout() {
+  btif_a2dp_sink_cb.jitter_buffer.Reset();
+  btif_a2dp_sink_cb.pcm_buffer.clear();
+}
+
+// Must be called while locked.
+static void btif_a2dp_sink_handle_inc_media(BT_HDR* p_msg, uint64_t arrival_us) {
   if ((btif_av_get_peer_sep(A2dpType::kSink) == AVDT_TSEP_SNK) || (btif_a2dp_sink_cb.rx_flush)) {
     log::verbose("state changed happened in this tick");
     return;
@@ -576,13 +592,48 @@ static void btif_a2dp_sink_handle_inc_media(BT_HDR* p_msg) {
 
   log::assert_that(btif_a2dp_sink_cb.decoder_interface != nullptr,
                    "assert failed: btif_a2dp_sink_cb.decoder_interface != nullptr");
+  size_t held_bytes = btif_a2dp_sink_cb.pcm_buffer.size();
+  btif_a2dp_sink_cb.decoded_bytes = 0;
   if (!btif_a2dp_sink_cb.decoder_interface->decode_packet(p_msg)) {
     log::error("decoding failed");
   }
+  if (btif_a2dp_sink_cb.decoded_bytes == 0) {
+    return;
+  }
+
+  A2dpSinkJitterBuffer& jitter_buffer = btif_a2dp_sink_cb.jitter_buffer;
+  jitter_buffer.OnPacket(arrival_us,
+                         btif_a2dp_sink_pcm_duration_us(btif_a2dp_sink_cb.decoded_bytes));
+  uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+  uint64_t duration_us =
+          btif_a2dp_sink_pcm_duration_us(btif_a2dp_sink_cb.pcm_buffer.size() - held_bytes);
+  switch (jitter_buffer.OnAudio(now_us, duration_us)) {
+    case A2dpSinkJitterBuffer::Action::kHold:
+      break;
+    case A2dpSinkJitterBuffer::Action::kWrite:
+#ifdef __ANDROID__
+      BtifAvrcpAudioTrackWriteData(btif_a2dp_sink_cb.audio_track,
+                                   btif_a2dp_sink_cb.pcm_buffer.data(),
+                                   btif_a2dp_sink_cb.pcm_buffer.size());
+#endif
+      btif_a2dp_sink_cb.pcm_buffer.clear();
+      break;
+    case A2dpSinkJitterBuffer::Action::kDrop:
+      log::verbose("dropping {} us of audio, the track is too far ahead", duration_us);
+      btif_a2dp_sink_cb.pcm_buffer.clear();
+      break;
+  }
 }
 
-static void btif_a2dp_sink_avk_handle_timer() {
+// Decodes the packets received since the last call, as soon as they arrive.
+static void btif_a2dp_sink_decode_queued_packets() {
   LockGuard lock(g_mutex);
+  btif_a2dp_sink_cb.decode_scheduled = false;
+
+  if (!btif_a2dp_sink_cb.decoding) {
+    log::verbose("decoding stopped");
+    return;
+  }
 
   BT_HDR* p_msg;
   if (fixed_queue_is_empty(btif_a2dp_sink_cb.rx_audio_queue)) {
@@ -598,6 +649,7 @@ static void btif_a2dp_sink_avk_handle_timer() {
   /* Play only in BTIF_A2DP_SINK_FOCUS_GRANTED case */
   if (btif_a2dp_sink_cb.rx_flush) {
     fixed_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+    btif_a2dp_sink_reset_playout();
     return;
   }
 
@@ -610,8 +662,9 @@ static void btif_a2dp_sink_avk_handle_timer() {
     log::verbose("number of packets in queue {}",
                  fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue));
 
-    /* Queue packet has less frames */
-    btif_a2dp_sink_handle_inc_media(p_msg);
+    uint64_t arrival_us;
+    memcpy(&arrival_us, p_msg->data, sizeof(arrival_us));
+    btif_a2dp_sink_handle_inc_media(p_msg, arrival_us);
     osi_free(p_msg);
   }
   log::verbose("process frames end");
@@ -630,6 +683,7 @@ static void btif_a2dp_sink_audio_rx_flush_event() {
   LockGuard lock(g_mutex);
   // Flush all received encoded audio buffers
   fixed_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+  btif_a2dp_sink_reset_playout();
 }
 
 static void btif_a2dp_sink_decoder_update_event(tBTIF_MEDIA_SINK_DECODER_UPDATE* p_buf) {
@@ -680,6 +734,7 @@ static void btif_a2dp_sink_decoder_update_event_old(tBTIF_MEDIA_SINK_DECODER_UPD
   btif_a2dp_sink_cb.sample_rate = sample_rate;
   btif_a2dp_sink_cb.bits_per_sample = bits_per_sample;
   btif_a2dp_sink_cb.channel_count = channel_count;
+  btif_a2dp_sink_setup_asrc();
 
   btif_a2dp_sink_cb.rx_flush = false;
   log::verbose("reset to Sink role");
@@ -723,11 +778,14 @@ uint8_t btif_a2dp_sink_enqueue_buf(BT_HDR* p_pkt) {
   }
 
   log::verbose("+");
-  /* Allocate and queue this buffer */
-  BT_HDR* p_msg = reinterpret_cast<BT_HDR*>(osi_malloc(sizeof(*p_msg) + p_pkt->len));
+  /* Allocate and queue this buffer, the arrival time in front of the media */
+  uint64_t arrival_us = bluetooth::common::time_get_os_boottime_us();
+  BT_HDR* p_msg =
+          reinterpret_cast<BT_HDR*>(osi_malloc(sizeof(*p_msg) + sizeof(arrival_us) + p_pkt->len));
   memcpy(p_msg, p_pkt, sizeof(*p_msg));
-  p_msg->offset = 0;
-  memcpy(p_msg->data, p_pkt->data + p_pkt->offset, p_pkt->len);
+  p_msg->offset = sizeof(arrival_us);
+  memcpy(p_msg->data, &arrival_us, sizeof(arrival_us));
+  memcpy(p_msg->data + p_msg->offset, p_pkt->data + p_pkt->offset, p_pkt->len);
   fixed_queue_enqueue(btif_a2dp_sink_cb.rx_audio_queue, p_msg);
 
   if (fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue) == MAX_INPUT_A2DP_FRAME_QUEUE_SZ) {
@@ -736,15 +794,21 @@ uint8_t btif_a2dp_sink_enqueue_buf(BT_HDR* p_pkt) {
     return ret;
   }
 
-  // Avoid other checks if alarm has already been initialized.
-  if (btif_a2dp_sink_cb.decode_alarm == nullptr &&
-      fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue) >= MAX_A2DP_DELAYED_START_FRAME_COUNT) {
+  // The jitter buffer holds the start of the playout, until it buffered
+  // enough audio to cover the jitter of the arrivals.
+  if (!btif_a2dp_sink_cb.decoding) {
     log::verbose("Initiate decoding. Current focus state:{}", btif_a2dp_sink_cb.rx_focus_state);
     if (btif_a2dp_sink_cb.rx_focus_state == BTIF_A2DP_SINK_FOCUS_GRANTED) {
       btif_a2dp_sink_audio_handle_start_decoding();
     }
   }
 
+  if (btif_a2dp_sink_cb.decoding && !btif_a2dp_sink_cb.decode_scheduled) {
+    btif_a2dp_sink_cb.decode_scheduled = true;
+    btif_a2dp_sink_cb.worker_thread.DoInThread(
+            FROM_HERE, base::BindOnce(btif_a2dp_sink_decode_queued_packets));
+  }
+
   return fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue);
 }
 
@@ -761,8 +825,12 @@ void btif_a2dp_sink_audio_rx_flush_req() {
                                              base::BindOnce(btif_a2dp_sink_command_ready, p_buf));
 }
 
-void btif_a2dp_sink_debug_dump(int /* fd */) {
-  // Nothing to do
+void btif_a2dp_sink_debug_dump(int fd) {
+  LockGuard lock(g_mutex);
+  dprintf(fd, "\nA2DP Sink State:\n");
+  dprintf(fd, "  Decoding                                                : %s\n",
+          btif_a2dp_sink_cb.decoding ? "true" : "false");
+  btif_a2dp_sink_cb.jitter_buffer.Dump(fd);
 }
 
 void btif_a2dp_sink_set_focus_state_req(btif_a2dp_sink_focus_state_t state) {
@@ -783,6 +851,7 @@ static void btif_a2dp_sink_set_focus_state_event(btif_a2dp_sink_focus_state_t st
   btif_a2dp_sink_cb.rx_focus_state = state;
   if (btif_a2dp_sink_cb.rx_focus_state == BTIF_A2DP_SINK_FOCUS_NOT_GRANTED) {
     fixed_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+    btif_a2dp_sink_reset_playout();
     btif_a2dp_sink_cb.rx_flush = true;
   } else if (btif_a2dp_sink_cb.rx_focus_state == BTIF_A2DP_SINK_FOCUS_GRANTED) {
     btif_a2dp_sink_cb.rx_flush = false;
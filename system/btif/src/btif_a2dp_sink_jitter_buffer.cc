@@ -0,0 +1,156 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "bluetooth-a2dp"
+
+#include "btif/include/btif_a2dp_sink_jitter_buffer.h"
+
+#include <bluetooth/log.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace bluetooth;
+
+namespace {
+
+// The target depth covers this many times the jitter, on top of the longest
+// packet: the buffer must hold while the next packet is awaited.
+constexpr uint64_t kJitterMargin = 3;
+
+// Audio written further ahead than this over the target is dropped, rather
+// than blocking the decoding on a full track.
+constexpr uint64_t kMaxExcessDepthUs = 200 * 1000;
+
+// The deviation of the depth from the target is filtered over about 64
+// packets, so the jitter does not reach the resampling ratio. A deviation
+// of 20 ms changes the ratio by 500 ppm, within +/- 1000 ppm.
+constexpr double kDepthErrorFilter = 1. / 64;
+constexpr double kRatioGainPerUs = 500e-6 / 20000;
+constexpr double kMaxRatioDeviation = 1000e-6;
+
+}  // namespace
+
+void A2dpSinkJitterBuffer::Reset() {
+  has_last_packet_ = false;
+  last_arrival_us_ = 0;
+  last_duration_us_ = 0;
+  jitter_us_ = 0;
+  max_duration_us_ = 0;
+  target_depth_us_ = kMinTargetDepthUs;
+  playing_ = false;
+  held_us_ = 0;
+  playout_start_us_ = 0;
+  written_us_ = 0;
+  depth_error_us_ = 0;
+  ratio_ = 1.0;
+}
+
+void A2dpSinkJitterBuffer::OnPacket(uint64_t arrival_us, uint64_t duration_us) {
+  stats_.packets++;
+  if (has_last_packet_) {
+    // The difference of the transit times of two consecutive packets is the
+    // time between their arrivals, less the audio the first one carried.
+    int64_t d = int64_t(arrival_us - last_arrival_us_) - int64_t(last_duration_us_);
+    int64_t abs_d = std::abs(d);
+    jitter_us_ = uint64_t(int64_t(jitter_us_) + (abs_d - int64_t(jitter_us_)) / 16);
+  }
+  has_last_packet_ = true;
+  last_arrival_us_ = arrival_us;
+  last_duration_us_ = duration_us;
+  max_duration_us_ = std::max(max_duration_us_, duration_us);
+  UpdateTargetDepth();
+}
+
+void A2dpSinkJitterBuffer::UpdateTargetDepth() {
+  uint64_t target_us = max_duration_us_ + kJitterMargin * jitter_us_;
+  target_depth_us_ = std::clamp(target_us, kMinTargetDepthUs, kMaxTargetDepthUs);
+}
+
+A2dpSinkJitterBuffer::Action A2dpSinkJitterBuffer::OnAudio(uint64_t now_us,
+                                                           uint64_t duration_us) {
+  if (playing_) {
+    int64_t depth_us = DepthUs(now_us);
+    if (depth_us < 0) {
+      // The track played everything written before this audio arrived:
+      // build the buffer up again.
+      stats_.underruns++;
+      stats_.underrun_us += -depth_us;
+      log::verbose("underrun of {} us, target depth {} us", -depth_us, target_depth_us_);
+      playing_ = false;
+      held_us_ = 0;
+    } else if (uint64_t(depth_us) > target_depth_us_ + kMaxExcessDepthUs) {
+      stats_.dropped_packets++;
+      stats_.dropped_us += duration_us;
+      return Action::kDrop;
+    } else {
+      written_us_ += duration_us;
+      depth_us += duration_us;
+      stats_.total_depth_us += depth_us;
+      stats_.depth_samples++;
+      stats_.max_depth_us = std::max(stats_.max_depth_us, uint64_t(depth_us));
+      UpdateRatio(depth_us);
+      return Action::kWrite;
+    }
+  }
+
+  held_us_ += duration_us;
+  if (held_us_ < target_depth_us_) {
+    return Action::kHold;
+  }
+
+  stats_.prebuffers++;
+  playing_ = true;
+  playout_start_us_ = now_us;
+  written_us_ = held_us_;
+  held_us_ = 0;
+  return Action::kWrite;
+}
+
+void A2dpSinkJitterBuffer::UpdateRatio(int64_t depth_us) {
+  double error_us = double(depth_us) - double(target_depth_us_);
+  depth_error_us_ += (error_us - depth_error_us_) * kDepthErrorFilter;
+  ratio_ = 1.0 + std::clamp(depth_error_us_ * kRatioGainPerUs, -kMaxRatioDeviation,
+                            kMaxRatioDeviation);
+}
+
+int64_t A2dpSinkJitterBuffer::DepthUs(uint64_t now_us) const {
+  if (!playing_) {
+    return held_us_;
+  }
+  return int64_t(written_us_) - int64_t(now_us - playout_start_us_);
+}
+
+void A2dpSinkJitterBuffer::Dump(int fd) const {
+  dprintf(fd, "  Jitter buffer depth in ms (target/ave/max)              : %llu / %llu / %llu\n",
+          (unsigned long long)target_depth_us_ / 1000,
+          (unsigned long long)(stats_.depth_samples > 0
+                                       ? stats_.total_depth_us / stats_.depth_samples / 1000
+                                       : 0),
+          (unsigned long long)stats_.max_depth_us / 1000);
+  dprintf(fd, "  Packet arrival jitter in ms                             : %.1f\n",
+          jitter_us_ / 1000.);
+  dprintf(fd, "  Drift compensation in ppm                               : %.0f\n",
+          (ratio_ - 1.0) * 1e6);
+  dprintf(fd, "  Counts (packets/prebuffers)                             : %zu / %zu\n",
+          stats_.packets, stats_.prebuffers);
+  dprintf(fd, "  Underruns (count/total time in ms)                      : %zu / %llu\n",
+          stats_.underruns, (unsigned long long)stats_.underrun_us / 1000);
+  dprintf(fd, "  Dropped audio (packets/total time in ms)                : %zu / %llu\n",
+          stats_.dropped_packets, (unsigned long long)stats_.dropped_us / 1000);
+}
@@ -31,6 +31,7 @@
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <future>
 
 #include "audio_hal_interface/a2dp_encoding.h"
@@ -45,7 +46,9 @@
 #include "common/time_util.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
+#include "osi/include/properties.h"
 #include "osi/include/wakelock.h"
+#include "stack/include/a2dp_rate_controller.h"
 #include "stack/include/a2dp_sbc_constants.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/acl_api_types.h"
@@ -180,6 +183,10 @@ public:
         sw_audio_is_encoding(false),
         encoder_interface(nullptr),
         encoder_interval_ms(0),
+        rate_control_enabled(false),
+        link_wait_start_us(0),
+        last_dequeue_us(0),
+        last_rssi(A2dpRateController::kRssiUnknown),
         state_(kStateOff) {}
 
   void Reset() {
@@ -190,6 +197,7 @@ public:
     wakelock_release();
     encoder_interface = nullptr;
     encoder_interval_ms = 0;
+    rate_control_enabled = false;
     stats.Reset();
     accumulated_stats.Reset();
     state_ = kStateOff;
@@ -217,6 +225,11 @@ public:
   RepeatingTimer media_alarm;
   const tA2DP_ENCODER_INTERFACE* encoder_interface;
   uint64_t encoder_interval_ms; /* Local copy of the encoder interval */
+  A2dpRateController rate_controller;
+  bool rate_control_enabled;
+  uint64_t link_wait_start_us; /* Since when the link has packets to take */
+  std::atomic<uint64_t> last_dequeue_us; /* Written from the BTA thread */
+  std::atomic<int8_t> last_rssi;         /* Written from the main thread */
   BtifMediaStats stats;
   BtifMediaStats accumulated_stats;
 
@@ -254,6 +267,8 @@ static void btif_a2dp_source_audio_feeding_update_event(
         const btav_a2dp_codec_config_t& codec_audio_config);
 static bool btif_a2dp_source_audio_tx_flush_req(void);
 static void btif_a2dp_source_audio_handle_timer(void);
+static void btif_a2dp_source_update_target_rate(size_t transmit_queue_length, uint64_t now_us);
+static void btif_a2dp_source_request_rssi(void);
 static uint32_t btif_a2dp_source_read_callback(uint8_t* p_buf, uint32_t len);
 static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n, uint32_t bytes_read);
 static void log_tstamps_us(const char* comment, uint64_t timestamp_us);
@@ -793,6 +808,17 @@ static void btif_a2dp_source_audio_tx_start_event(void) {
                   btif_a2dp_source_cb.encoder_interface->get_encoder_interval_ms()));
   btif_a2dp_source_cb.sw_audio_is_encoding = true;
 
+  btif_a2dp_source_cb.rate_controller.Reset(btif_a2dp_source_cb.encoder_interval_ms,
+                                            btif_a2dp_source_cb.encoder_interface->set_target_rate);
+  btif_a2dp_source_cb.rate_control_enabled =
+          btif_a2dp_source_cb.rate_controller.active() &&
+          osi_property_get_bool("persist.bluetooth.a2dp_source.rate_control.enabled", true);
+  btif_a2dp_source_cb.link_wait_start_us = bluetooth::common::time_get_os_boottime_us();
+  btif_a2dp_source_cb.last_rssi = A2dpRateController::kRssiUnknown;
+  if (btif_a2dp_source_cb.rate_control_enabled) {
+    btif_a2dp_source_request_rssi();
+  }
+
   btif_a2dp_source_cb.stats.Reset();
   // Assign session_start_us to 1 when
   // bluetooth::common::time_get_os_boottime_us() is 0 to indicate
@@ -867,12 +893,52 @@ static void btif_a2dp_source_audio_handle_timer(void) {
   if (btif_a2dp_source_cb.encoder_interface->set_transmit_queue_length != nullptr) {
     btif_a2dp_source_cb.encoder_interface->set_transmit_queue_length(transmit_queue_length);
   }
+  if (btif_a2dp_source_cb.rate_control_enabled) {
+    btif_a2dp_source_update_target_rate(transmit_queue_length, stats_timestamp_us);
+  }
   btif_a2dp_source_cb.encoder_interface->send_frames(timestamp_us);
   bta_av_ci_src_data_ready(BTA_AV_CHNL_AUDIO);
   update_scheduling_stats(&btif_a2dp_source_cb.stats.tx_queue_enqueue_stats, stats_timestamp_us,
                           btif_a2dp_source_cb.encoder_interval_ms * 1000);
 }
 
+// Adapts the bitrate of the encoder to how fast the link drains the queue.
+// L2CAP only asks for the next packet once it has room for it, so the time
+// a non-empty queue waits for the link follows the ACL credits the
+// controller returns.
+static void btif_a2dp_source_update_target_rate(size_t transmit_queue_length, uint64_t now_us) {
+  if (transmit_queue_length == 0) {
+    btif_a2dp_source_cb.link_wait_start_us = now_us;
+  }
+  uint64_t last_dequeue_us = btif_a2dp_source_cb.last_dequeue_us;
+  uint64_t wait_start_us = std::max(btif_a2dp_source_cb.link_wait_start_us, last_dequeue_us);
+  A2dpRateController::LinkSample sample = {
+          .timestamp_us = now_us,
+          .queue_length = transmit_queue_length,
+          .queue_limit = btif_a2dp_source_dynamic_audio_buffer_size,
+          .stall_us = (transmit_queue_length > 0 && now_us > wait_start_us) ? now_us - wait_start_us
+                                                                            : 0,
+          .rssi = btif_a2dp_source_cb.last_rssi.load(),
+  };
+
+  uint16_t previous_rate = btif_a2dp_source_cb.rate_controller.rate();
+  uint16_t rate = btif_a2dp_source_cb.rate_controller.OnTick(sample);
+  if (rate < previous_rate) {
+    btif_a2dp_source_request_rssi();
+  }
+}
+
+// The RSSI read at the start of the stream is the reference a lower one is
+// compared to, to tell fading links apart from busy ones.
+static void btif_a2dp_source_request_rssi(void) {
+  RawAddress peer_bda = btif_av_source_active_peer();
+  tBTM_STATUS status =
+          get_btm_client_interface().link_controller.BTM_ReadRSSI(peer_bda, btm_read_rssi_cb);
+  if (status != tBTM_STATUS::BTM_CMD_STARTED) {
+    log::warn("Cannot read RSSI: status {}", status);
+  }
+}
+
 static uint32_t btif_a2dp_source_read_callback(uint8_t* p_buf, uint32_t len) {
   uint32_t bytes_read = bluetooth::audio::a2dp::read(p_buf, len);
 
@@ -1017,6 +1083,7 @@ BT_HDR* btif_a2dp_source_audio_readbuf(void) {
     // Update the statistics
     update_scheduling_stats(&btif_a2dp_source_cb.stats.tx_queue_dequeue_stats, now_us,
                             btif_a2dp_source_cb.encoder_interval_ms * 1000);
+    btif_a2dp_source_cb.last_dequeue_us = now_us;
   }
 
   return p_buf;
@@ -1205,6 +1272,10 @@ void btif_a2dp_source_debug_dump(int fd) {
           (unsigned long long)dequeue_stats->total_premature_scheduling_delta_us / 1000,
           (unsigned long long)dequeue_stats->max_premature_scheduling_delta_us / 1000,
           (unsigned long long)ave_time_us / 1000);
+
+  if (btif_a2dp_source_cb.rate_control_enabled) {
+    btif_a2dp_source_cb.rate_controller.Dump(fd);
+  }
 }
 
 static void btif_a2dp_source_update_metrics(void) {
@@ -1279,6 +1350,7 @@ static void btm_read_rssi_cb(void* data) {
                        result->hci_status, result->rssi);
 
   log::warn("device: {}, rssi: {}", result->rem_bda, result->rssi);
+  btif_a2dp_source_cb.last_rssi = result->rssi;
 }
 
 static void btm_read_failed_contact_counter_cb(void* data) {
@@ -36,6 +36,7 @@
 #include "common/address_obfuscator.h"
 #include "common/metric_id_allocator.h"
 #include "main/shim/config.h"
+#include "main/shim/le_scanning_manager.h"
 #include "main/shim/shim.h"
 #include "raw_address.h"
 #include "storage/config_keys.h"
@@ -312,6 +313,11 @@ void btif_config_remove_device(const std::string& section) {
   log::assert_that(bluetooth::shim::is_gd_stack_started_up(),
                    "assert failed: bluetooth::shim::is_gd_stack_started_up()");
   bluetooth::shim::BtifConfigInterface::RemoveSection(section);
+
+  RawAddress bd_addr;
+  if (RawAddress::FromString(section, bd_addr)) {
+    bluetooth::shim::forget_remote_properties(bd_addr);
+  }
 }
 
 bool btif_config_clear(void) {
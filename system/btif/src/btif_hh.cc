@@ -145,6 +145,7 @@ bool check_cod(const RawAddress* remote_bdaddr, uint32_t cod);
 bool check_cod_hid(const RawAddress* remote_bdaddr);
 bool check_cod_hid_major(const RawAddress& bd_addr, uint32_t cod);
 void bta_hh_co_close(btif_hh_device_t* p_dev);
+void bta_hh_co_dump(int fd);
 void bta_hh_co_send_hid_info(btif_hh_device_t* p_dev, const char* dev_name, uint16_t vendor_id,
                              uint16_t product_id, uint16_t version, uint8_t ctry_code,
                              uint16_t dscp_len, uint8_t* p_dscp);
@@ -2172,10 +2173,10 @@ void DumpsysHid(int fd) {
   for (unsigned i = 0; i < BTIF_HH_MAX_HID; i++) {
     const btif_hh_device_t* p_dev = &btif_hh_cb.devices[i];
     if (p_dev->link_spec.addrt.bda != RawAddress::kEmpty) {
-      int fd = (com::android::bluetooth::flags::hid_report_queuing() ? p_dev->internal_send_fd
-                                                                     : p_dev->uhid.fd);
+      int uhid_fd = (com::android::bluetooth::flags::hid_report_queuing() ? p_dev->internal_send_fd
+                                                                          : p_dev->uhid.fd);
       LOG_DUMPSYS(fd, "  %u: addr:%s fd:%d state:%s thread_id:%d handle:%d", i,
-                  p_dev->link_spec.ToRedactedStringForLogging().c_str(), fd,
+                  p_dev->link_spec.ToRedactedStringForLogging().c_str(), uhid_fd,
                   bthh_connection_state_text(p_dev->dev_status).c_str(),
                   static_cast<int>(p_dev->hh_poll_thread_id), p_dev->dev_handle);
     }
@@ -2188,6 +2189,7 @@ void DumpsysHid(int fd) {
                   p_dev->reconnect_allowed ? "T" : "F");
     }
   }
+  bta_hh_co_dump(fd);
   BTA_HhDump(fd);
 }
 
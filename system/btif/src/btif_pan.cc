@@ -36,10 +36,12 @@
 #include <linux/if_ether.h>
 #include <linux/if_tun.h>
 #include <net/if.h>
-#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <vector>
+
 #include "bta/include/bta_pan_api.h"
 #include "btif/include/btif_common.h"
 #include "btif/include/btif_pan_internal.h"
@@ -71,8 +73,6 @@
       log::error("btif_pan: ## assert {} failed ##", #s); \
   } while (0)
 
-#define MIN(x, y) (((x) < (y)) ? (x) : (y))
-
 using namespace bluetooth;
 
 btpan_cb_t btpan_cb;
@@ -90,7 +90,9 @@ static int btpan_get_local_role(void);
 static void btpan_tap_fd_signaled(int fd, int type, int flags, uint32_t user_id);
 static void btpan_cleanup_conn(btpan_conn_t* conn);
 static void bta_pan_callback(tBTA_PAN_EVT event, tBTA_PAN* p_data);
-static void btu_exec_tap_fd_read(const int fd);
+static void btpan_tap_read_batch(int fd);
+static void btu_exec_tap_fd_batch(int fd, std::vector<BT_HDR*> batch);
+static void btpan_forward_pending(int fd);
 
 static btpan_interface_t pan_if = {sizeof(pan_if),       btpan_jni_init, nullptr,
                                    btpan_get_local_role, btpan_connect,  btpan_disconnect,
@@ -116,6 +118,7 @@ void btif_pan_init() {
     memset(&btpan_cb, 0, sizeof(btpan_cb));
     btpan_cb.tap_fd = INVALID_FD;
     btpan_cb.flow = 1;
+    btpan_cb.pending_q = fixed_queue_new(SIZE_MAX);
     for (int i = 0; i < MAX_PAN_CONNS; i++) {
       btpan_cleanup_conn(&btpan_cb.conns[i]);
     }
@@ -141,6 +144,8 @@ static void pan_disable() {
       btpan_tap_close(btpan_cb.tap_fd);
       btpan_cb.tap_fd = INVALID_FD;
     }
+    fixed_queue_free(btpan_cb.pending_q, osi_free);
+    btpan_cb.pending_q = NULL;
   }
 }
 
@@ -361,8 +366,9 @@ void btpan_set_flow_control(bool enable) {
 
   btpan_cb.flow = enable;
   if (enable) {
-    btsock_thread_add_fd(pan_pth, btpan_cb.tap_fd, 0, SOCK_THREAD_FD_RD, 0);
-    do_in_main_thread(base::BindOnce(btu_exec_tap_fd_read, btpan_cb.tap_fd));
+    // BNEP turns the flow back on before it sends the frames it queued while
+    // congested: resume once they are out, whether or not the TAP has more.
+    do_in_main_thread(base::BindOnce(btpan_forward_pending, btpan_cb.tap_fd));
   }
 }
 
@@ -409,17 +415,19 @@ int btpan_tap_send(int tap_fd, const RawAddress& src, const RawAddress& dst, uin
     eth_hdr.h_dest = dst;
     eth_hdr.h_src = src;
     eth_hdr.h_proto = htons(proto);
-    char packet[TAP_MAX_PKT_WRITE_LEN + sizeof(tETH_HDR)];
-    memcpy(packet, &eth_hdr, sizeof(tETH_HDR));
     if (len > TAP_MAX_PKT_WRITE_LEN) {
       log::error("btpan_tap_send eth packet size:{} is exceeded limit!", len);
       return -1;
     }
-    memcpy(packet + sizeof(tETH_HDR), buf, len);
 
-    /* Send data to network interface */
+    /* Send data to network interface, gathering the ethernet header and the
+     * payload straight from the BNEP buffer */
+    struct iovec iov[2] = {
+            {&eth_hdr, sizeof(tETH_HDR)},
+            {const_cast<char*>(buf), len},
+    };
     ssize_t ret;
-    OSI_NO_INTR(ret = write(tap_fd, packet, len + sizeof(tETH_HDR)));
+    OSI_NO_INTR(ret = writev(tap_fd, iov, 2));
     log::verbose("ret:{}", ret);
     return (int)ret;
   }
@@ -428,10 +436,11 @@ int btpan_tap_send(int tap_fd, const RawAddress& src, const RawAddress& dst, uin
 
 int btpan_tap_close(int fd) {
   if (tap_if_down(TAP_IF_NAME) == 0) {
-    close(fd);
+    btsock_thread_remove_fd_and_close(pan_pth, fd);
   }
-  if (pan_pth >= 0) {
-    btsock_thread_wakeup(pan_pth);
+  // Frames read from the closed interface must not leak onto a new one.
+  if (btpan_cb.pending_q != NULL) {
+    fixed_queue_flush(btpan_cb.pending_q, osi_free);
   }
   return 0;
 }
@@ -657,54 +666,104 @@ static void bta_pan_callback(tBTA_PAN_EVT event, tBTA_PAN* p_data) {
   btif_transfer_context(bta_pan_callback_transfer, event, (char*)p_data, sizeof(tBTA_PAN), NULL);
 }
 
-#define IS_EXCEPTION(e) ((e) & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL))
-static void btu_exec_tap_fd_read(int fd) {
-  struct pollfd ufd;
-
-  if (fd == INVALID_FD || fd != btpan_cb.tap_fd) {
-    return;
-  }
+/*******************************************************************************
+ *
+ * Function         btpan_tap_read_batch
+ *
+ * Description      Runs on the PAN read thread. Drains up to PAN_BUF_MAX frames
+ *                  from the TAP driver directly into BT_HDRs that already
+ *                  reserve the BNEP/L2CAP headroom, and hands the whole batch
+ *                  to the main thread with a single post.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void btpan_tap_read_batch(int fd) {
+  std::vector<BT_HDR*> batch;
+  batch.reserve(PAN_BUF_MAX);
 
-  // Don't occupy BTU context too long, avoid buffer overruns and
-  // give other profiles a chance to run by limiting the amount of memory
-  // PAN can use.
-  for (int i = 0; i < PAN_BUF_MAX && btif_is_enabled() && btpan_cb.flow; i++) {
+  while (batch.size() < PAN_BUF_MAX) {
     BT_HDR* buffer = (BT_HDR*)osi_malloc(PAN_BUF_SIZE);
     buffer->offset = PAN_MINIMUM_OFFSET;
-    buffer->len = PAN_BUF_SIZE - sizeof(BT_HDR) - buffer->offset;
-
-    uint8_t* packet = (uint8_t*)buffer + sizeof(BT_HDR) + buffer->offset;
-
-    // If we don't have an undelivered packet left over, pull one from the TAP
-    // driver.
-    // We save it in the congest_packet right away in case we can't deliver it
-    // in this
-    // attempt.
-    if (!btpan_cb.congest_packet_size) {
-      ssize_t ret;
-      OSI_NO_INTR(ret = read(fd, btpan_cb.congest_packet, sizeof(btpan_cb.congest_packet)));
-      switch (ret) {
-        case -1:
-          log::error("unable to read from driver: {}", strerror(errno));
-          osi_free(buffer);
-          // add fd back to monitor thread to try it again later
-          btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
-          return;
-        case 0:
-          log::warn("end of file reached.");
-          osi_free(buffer);
-          // add fd back to monitor thread to process the exception
-          btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
-          return;
-        default:
-          btpan_cb.congest_packet_size = ret;
-          break;
+    uint8_t* packet = (uint8_t*)(buffer + 1) + buffer->offset;
+
+    ssize_t ret;
+    OSI_NO_INTR(ret = read(fd, packet, PAN_BUF_SIZE - sizeof(BT_HDR) - buffer->offset));
+    if (ret <= 0) {
+      if (ret == 0) {
+        log::warn("end of file reached.");
+      } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        log::error("unable to read from driver: {}", strerror(errno));
       }
+      osi_free(buffer);
+      break;
     }
+    buffer->len = (uint16_t)ret;
+    batch.push_back(buffer);
+  }
 
-    memcpy(packet, btpan_cb.congest_packet, MIN(btpan_cb.congest_packet_size, buffer->len));
-    buffer->len = MIN(btpan_cb.congest_packet_size, buffer->len);
+  if (batch.empty()) {
+    // add fd back to monitor thread to try it again later or to process the
+    // exception
+    btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD | SOCK_THREAD_ADD_FD_SYNC, 0);
+    return;
+  }
+
+  do_in_main_thread(base::BindOnce(btu_exec_tap_fd_batch, fd, std::move(batch)));
+}
 
+static void btu_exec_tap_fd_batch(int fd, std::vector<BT_HDR*> batch) {
+  if (fd == INVALID_FD || fd != btpan_cb.tap_fd || btpan_cb.pending_q == NULL) {
+    for (BT_HDR* buffer : batch) {
+      osi_free(buffer);
+    }
+    return;
+  }
+
+  // Bound the memory PAN can hold while BNEP is congested: once the pending
+  // queue is full, drop the newest frames as a NIC ring would.
+  size_t dropped = 0;
+  for (BT_HDR* buffer : batch) {
+    if (fixed_queue_length(btpan_cb.pending_q) >= PAN_BUF_MAX) {
+      osi_free(buffer);
+      dropped++;
+      continue;
+    }
+    fixed_queue_enqueue(btpan_cb.pending_q, buffer);
+  }
+  if (dropped) {
+    log::warn("dropped {} frames from tap, pending queue full", dropped);
+  }
+
+  btpan_forward_pending(fd);
+}
+
+/*******************************************************************************
+ *
+ * Function         btpan_forward_pending
+ *
+ * Description      Hands the pending TAP frames to BNEP until the queue is
+ *                  drained, the outbound flow is turned off or BNEP reports
+ *                  congestion, then re-arms the PAN read thread if the flow
+ *                  is on. A frame BNEP could not take is left at the head of
+ *                  the queue, and the flow is turned off until BNEP turns it
+ *                  back on.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void btpan_forward_pending(int fd) {
+  if (fd == INVALID_FD || fd != btpan_cb.tap_fd || btpan_cb.pending_q == NULL) {
+    return;
+  }
+
+  while (btif_is_enabled() && btpan_cb.flow) {
+    BT_HDR* buffer = (BT_HDR*)fixed_queue_try_peek_first(btpan_cb.pending_q);
+    if (buffer == NULL) {
+      break;
+    }
+
+    uint8_t* packet = (uint8_t*)(buffer + 1) + buffer->offset;
     if (buffer->len > sizeof(tETH_HDR) && should_forward((tETH_HDR*)packet)) {
       // Extract the ethernet header from the buffer since the PAN_WriteBuf
       // inside
@@ -716,25 +775,20 @@ static void btu_exec_tap_fd_read(int fd) {
       // Skip the ethernet header.
       buffer->len -= sizeof(tETH_HDR);
       buffer->offset += sizeof(tETH_HDR);
-      if (forward_bnep(&hdr, buffer) != FORWARD_CONGEST) {
-        btpan_cb.congest_packet_size = 0;
+      if (forward_bnep(&hdr, buffer) == FORWARD_CONGEST) {
+        // BNEP left the frame untouched; send it first once the flow is back
+        // on.
+        buffer->len += sizeof(tETH_HDR);
+        buffer->offset -= sizeof(tETH_HDR);
+        log::warn("bnep congested, holding {} frames", fixed_queue_length(btpan_cb.pending_q));
+        btpan_cb.flow = 0;
+        break;
       }
     } else {
       log::warn("dropping packet of length {}", buffer->len);
-      btpan_cb.congest_packet_size = 0;
       osi_free(buffer);
     }
-
-    // Bail out of the loop if reading from the TAP fd would block.
-    ufd.fd = fd;
-    ufd.events = POLLIN;
-    ufd.revents = 0;
-
-    int ret;
-    OSI_NO_INTR(ret = poll(&ufd, 1, 0));
-    if (ret <= 0 || IS_EXCEPTION(ufd.revents)) {
-      break;
-    }
+    fixed_queue_try_dequeue(btpan_cb.pending_q);
   }
 
   if (btpan_cb.flow) {
@@ -769,6 +823,6 @@ static void btpan_tap_fd_signaled(int fd, int type, int flags, uint32_t user_id)
     btpan_tap_close(fd);
     btif_pan_close_all_conns();
   } else if (flags & SOCK_THREAD_FD_RD) {
-    do_in_main_thread(base::BindOnce(btu_exec_tap_fd_read, fd));
+    btpan_tap_read_batch(fd);
   }
 }
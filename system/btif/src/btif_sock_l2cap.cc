@@ -22,6 +22,7 @@
 #include <unistd.h>
 #include <com_android_bluetooth_flags.h>
 
+#include <array>
 #include <cstdint>
 #include <cstring>
 #include <mutex>
@@ -44,6 +45,9 @@
 
 using namespace bluetooth;
 
+/* Max number of packets handed to the app with a single sendmmsg() */
+#define L2CAP_SEND_BATCH 16
+
 struct packet {
   struct packet *next, *prev;
   uint32_t len;
@@ -261,7 +265,7 @@ static void btsock_l2cap_free_l(l2cap_socket* sock) {
   }
 
   shutdown(sock->our_fd, SHUT_RDWR);
-  close(sock->our_fd);
+  btsock_thread_remove_fd_and_close(pth, sock->our_fd);
   if (sock->app_fd != -1) {
     close(sock->app_fd);
   } else {
@@ -918,29 +922,49 @@ bt_status_t btsock_l2cap_connect(const RawAddress* bd_addr, int channel, int* so
 /* return true if we have more to send and should wait for user readiness, false
  * else
  * (for example: unrecoverable error or no data)
+ *
+ * The queued packets are handed to the app up to L2CAP_SEND_BATCH at a time
+ * with one sendmmsg(); each one is still a message of its own on the
+ * SOCK_SEQPACKET socket.
  */
 static bool flush_incoming_que_on_wr_signal_l(l2cap_socket* sock) {
-  uint8_t* buf;
-  uint32_t len;
+  std::array<struct mmsghdr, L2CAP_SEND_BATCH> msgs;
+  std::array<struct iovec, L2CAP_SEND_BATCH> iovs;
+
+  while (sock->first_packet) {
+    unsigned int count = 0;
+    for (struct packet* p = sock->first_packet; p && count < L2CAP_SEND_BATCH; p = p->next) {
+      iovs[count] = {p->data, p->len};
+      msgs[count] = {};
+      msgs[count].msg_hdr.msg_iov = &iovs[count];
+      msgs[count].msg_hdr.msg_iovlen = 1;
+      count++;
+    }
 
-  while (packet_get_head_l(sock, &buf, &len)) {
-    ssize_t sent;
-    OSI_NO_INTR(sent = send(sock->our_fd, buf, len, MSG_DONTWAIT));
+    int sent;
+    OSI_NO_INTR(sent = sendmmsg(sock->our_fd, msgs.data(), count, MSG_DONTWAIT));
     int saved_errno = errno;
+    if (sent < 0) {
+      return saved_errno == EWOULDBLOCK || saved_errno == EAGAIN;
+    }
 
-    if (sent == (signed)len) {
-      osi_free(buf);
-    } else if (sent >= 0) {
-      packet_put_head_l(sock, buf + sent, len - sent);
-      osi_free(buf);
-      if (!sent) { /* special case if other end not keeping up */
-        return true;
+    for (int i = 0; i < sent; i++) {
+      uint8_t* buf;
+      uint32_t len;
+      packet_get_head_l(sock, &buf, &len);
+      uint32_t written = msgs[i].msg_len;
+      if (written < len) {
+        packet_put_head_l(sock, buf + written, len - written);
+        osi_free(buf);
+        if (!written) { /* special case if other end not keeping up */
+          return true;
+        }
+        break;
       }
-    } else {
-      packet_put_head_l(sock, buf, len);
       osi_free(buf);
-      return saved_errno == EWOULDBLOCK || saved_errno == EAGAIN;
     }
+    // Packets left out of the batch are tried again: the next sendmmsg()
+    // reports why the app did not take them.
   }
 
   return false;
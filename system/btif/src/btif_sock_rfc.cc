@@ -22,6 +22,7 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include <cstdint>
 #include <mutex>
@@ -38,7 +39,6 @@
 #include "include/hardware/bt_sock.h"
 #include "osi/include/allocator.h"
 #include "osi/include/compat.h"
-#include "osi/include/list.h"
 #include "osi/include/osi.h"  // INVALID_FD
 #include "stack/include/bt_hdr.h"
 #include "stack/include/port_api.h"
@@ -61,6 +61,7 @@ typedef struct {
   int server : 1;
   int connected : 1;
   int closing : 1;
+  int incoming_queued : 1;  // Data the app could not take waits in the RFCOMM port
 } flags_t;
 
 typedef struct {
@@ -83,7 +84,6 @@ typedef struct {
   int rfc_handle;
   int rfc_port_handle;
   int role;
-  list_t* incoming_queue;
   // Cumulative number of bytes transmitted on this socket
   int64_t tx_bytes;
   // Cumulative number of bytes received on this socket
@@ -115,9 +115,6 @@ bt_status_t btsock_rfc_init(int poll_thread_handle, uid_set_t* set) {
     rfc_slots[i].sdp_handle = 0;
     rfc_slots[i].fd = INVALID_FD;
     rfc_slots[i].app_fd = INVALID_FD;
-    rfc_slots[i].incoming_queue = list_new(osi_free);
-    log::assert_that(rfc_slots[i].incoming_queue != NULL,
-                     "assert failed: rfc_slots[i].incoming_queue != NULL");
   }
 
   BTA_JvEnable(jv_dm_cback);
@@ -135,8 +132,6 @@ void btsock_rfc_cleanup(void) {
     if (rfc_slots[i].id) {
       cleanup_rfc_slot(&rfc_slots[i]);
     }
-    list_free(rfc_slots[i].incoming_queue);
-    rfc_slots[i].incoming_queue = NULL;
   }
 
   uid_set = NULL;
@@ -444,7 +439,7 @@ static void free_rfc_slot_scn(rfc_slot_t* slot) {
 static void cleanup_rfc_slot(rfc_slot_t* slot) {
   if (slot->fd != INVALID_FD) {
     shutdown(slot->fd, SHUT_RDWR);
-    close(slot->fd);
+    btsock_thread_remove_fd_and_close(pth, slot->fd);
     log::info(
             "disconnected from RFCOMM socket connections for device: {}, scn: {}, "
             "app_uid: {}, id: {}",
@@ -474,7 +469,6 @@ static void cleanup_rfc_slot(rfc_slot_t* slot) {
   }
 
   free_rfc_slot_scn(slot);
-  list_clear(slot->incoming_queue);
 
   slot->rfc_port_handle = 0;
   memset(&slot->f, 0, sizeof(slot->f));
@@ -891,23 +885,68 @@ static sent_status_t send_data_to_app(int fd, BT_HDR* p_buf) {
   return SENT_PARTIAL;
 }
 
-static bool flush_incoming_que_on_wr_signal(rfc_slot_t* slot) {
-  while (!list_is_empty(slot->incoming_queue)) {
-    BT_HDR* p_buf = (BT_HDR*)list_front(slot->incoming_queue);
-    switch (send_data_to_app(slot->fd, p_buf)) {
-      case SENT_NONE:
-      case SENT_PARTIAL:
-        // monitor the fd to get callback when app is ready to receive data
-        btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR, slot->id);
-        return true;
+typedef struct {
+  int fd;
+  size_t offered;  // Bytes the RFCOMM port offered to send
+} app_send_ctx_t;
 
-      case SENT_ALL:
-        list_remove(slot->incoming_queue, p_buf);
-        break;
+static ssize_t send_iov_to_app(const struct iovec* p_iov, int iov_cnt, void* context) {
+  app_send_ctx_t* ctx = (app_send_ctx_t*)context;
 
-      case SENT_FAILED:
-        list_remove(slot->incoming_queue, p_buf);
-        return false;
+  ctx->offered = 0;
+  for (int i = 0; i < iov_cnt; i++) {
+    ctx->offered += p_iov[i].iov_len;
+  }
+  if (ctx->offered == 0) {
+    return 0;
+  }
+
+  struct msghdr msg = {};
+  msg.msg_iov = const_cast<struct iovec*>(p_iov);
+  msg.msg_iovlen = iov_cnt;
+
+  ssize_t sent;
+  OSI_NO_INTR(sent = sendmsg(ctx->fd, &msg, MSG_DONTWAIT));
+
+  if (sent == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return 0;
+    }
+    log::error("error writing RFCOMM data back to app: {}", strerror(errno));
+    return -1;
+  }
+
+  if (sent == 0) {
+    return -1;
+  }
+
+  return sent;
+}
+
+// Leaves data the app could not take in the RFCOMM port receive queue, to be
+// sent straight from there by flush_incoming_que_on_wr_signal.
+static void queue_incoming(rfc_slot_t* slot, BT_HDR* p_buf) {
+  if (PORT_EnqueueRxBuf(slot->rfc_port_handle, p_buf) != PORT_SUCCESS) {
+    log::warn("Unable to queue RFCOMM data peer:{} slot:{}", slot->addr, slot->id);
+    return;
+  }
+  slot->f.incoming_queued = true;
+}
+
+static bool flush_incoming_que_on_wr_signal(rfc_slot_t* slot) {
+  while (slot->f.incoming_queued) {
+    app_send_ctx_t ctx = {.fd = slot->fd, .offered = 0};
+    uint32_t sent = 0;
+    if (PORT_ReadDataV(slot->rfc_port_handle, send_iov_to_app, &ctx, &sent) != PORT_SUCCESS) {
+      return false;
+    }
+
+    if (ctx.offered == 0) {
+      slot->f.incoming_queued = false;
+    } else if (sent < ctx.offered) {
+      // monitor the fd to get callback when app is ready to receive data
+      btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR, slot->id);
+      return true;
     }
   }
 
@@ -979,11 +1018,11 @@ int bta_co_rfc_data_incoming(uint32_t id, BT_HDR* p_buf) {
   app_uid = slot->app_uid;
   bytes_rx = p_buf->len;
 
-  if (list_is_empty(slot->incoming_queue)) {
+  if (!slot->f.incoming_queued) {
     switch (send_data_to_app(slot->fd, p_buf)) {
       case SENT_NONE:
       case SENT_PARTIAL:
-        list_append(slot->incoming_queue, p_buf);
+        queue_incoming(slot, p_buf);
         btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR, slot->id);
         break;
 
@@ -998,7 +1037,7 @@ int bta_co_rfc_data_incoming(uint32_t id, BT_HDR* p_buf) {
         break;
     }
   } else {
-    list_append(slot->incoming_queue, p_buf);
+    queue_incoming(slot, p_buf);
   }
 
   slot->rx_bytes += bytes_rx;
@@ -28,24 +28,21 @@
 
 #include "btif_sock_thread.h"
 
-#include <alloca.h>
 #include <bluetooth/log.h>
+#include <errno.h>
 #include <fcntl.h>
-#include <features.h>
-#include <poll.h>
 #include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
-#include <sys/un.h>
-#include <time.h>
 #include <unistd.h>
 
 #include <array>
 #include <mutex>
 #include <optional>
+#include <unordered_map>
 
 #include "osi/include/osi.h"  // OSI_NO_INTR
 
@@ -56,11 +53,12 @@
   } while (0)
 
 #define MAX_THREAD 8
-#define MAX_POLL 64
-#define POLL_EXCEPTION_EVENTS (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL)
-#define IS_EXCEPTION(e) ((e) & POLL_EXCEPTION_EVENTS)
-#define IS_READ(e) ((e) & POLLIN)
-#define IS_WRITE(e) ((e) & POLLOUT)
+/* Max number of epoll events handled per wakeup of a socket poll thread */
+#define MAX_EPOLL_EVENTS 64
+#define EPOLL_EXCEPTION_EVENTS (EPOLLHUP | EPOLLRDHUP | EPOLLERR)
+#define IS_EXCEPTION(e) ((e) & EPOLL_EXCEPTION_EVENTS)
+#define IS_READ(e) ((e) & EPOLLIN)
+#define IS_WRITE(e) ((e) & EPOLLOUT)
 /*cmd executes in socket poll thread */
 #define CMD_WAKEUP 1
 #define CMD_EXIT 2
@@ -71,16 +69,16 @@
 using namespace bluetooth;
 
 struct poll_slot_t {
-  struct pollfd pfd;
   uint32_t user_id;
   int type;
   int flags;
 };
 struct thread_slot_t {
   int cmd_fdr, cmd_fdw;
-  int poll_count;
-  poll_slot_t ps[MAX_POLL];
-  int psi[MAX_POLL];  // index of poll slot
+  int epoll_fd;
+  // Monitored fds, only accessed from the socket poll thread once it runs.
+  // Unlike a pollfd array, the epoll set is not bounded in size.
+  std::unordered_map<int, poll_slot_t> ps;
   std::optional<pthread_t> thread_id;
   btsock_signaled_cb callback;
   btsock_cmd_cb cmd_callback;
@@ -92,6 +90,7 @@ static void* sock_poll_thread(void* arg);
 static inline void close_cmd_fd(int h);
 
 static inline void add_poll(int h, int fd, int type, int flags, uint32_t user_id);
+static void remove_fd_and_close(int h, int fd);
 
 static std::recursive_mutex thread_slot_lock;
 
@@ -119,7 +118,7 @@ static inline int create_thread(void* (*start_routine)(void*), void* arg, pthrea
   pthread_setschedparam(*thread_id, policy, &param);
   return ret;
 }
-static void init_poll(int cmd_fd);
+static bool init_poll(int h);
 static int alloc_thread_slot() {
   std::unique_lock<std::recursive_mutex> lock(thread_slot_lock);
   int i;
@@ -136,6 +135,11 @@ static int alloc_thread_slot() {
 static void free_thread_slot(int h) {
   if (0 <= h && h < MAX_THREAD) {
     close_cmd_fd(h);
+    if (ts[h].epoll_fd != -1) {
+      close(ts[h].epoll_fd);
+      ts[h].epoll_fd = -1;
+    }
+    ts[h].ps.clear();
     ts[h].used = 0;
   } else {
     log::error("invalid thread handle:{}", h);
@@ -148,9 +152,10 @@ void btsock_thread_init() {
     int h;
     for (h = 0; h < MAX_THREAD; h++) {
       ts[h].cmd_fdr = ts[h].cmd_fdw = -1;
+      ts[h].epoll_fd = -1;
       ts[h].used = 0;
       ts[h].thread_id = std::nullopt;
-      ts[h].poll_count = 0;
+      ts[h].ps.clear();
       ts[h].callback = NULL;
       ts[h].cmd_callback = NULL;
     }
@@ -160,7 +165,10 @@ int btsock_thread_create(btsock_signaled_cb callback, btsock_cmd_cb cmd_callback
   asrt(callback || cmd_callback);
   int h = alloc_thread_slot();
   if (h >= 0) {
-    init_poll(h);
+    if (!init_poll(h)) {
+      free_thread_slot(h);
+      return -1;
+    }
     pthread_t thread;
     int status = create_thread(sock_poll_thread, (void*)(uintptr_t)h, &thread);
     if (status) {
@@ -245,6 +253,27 @@ int btsock_thread_wakeup(int h) {
 
   return ret == sizeof(cmd);
 }
+int btsock_thread_remove_fd_and_close(int h, int fd) {
+  if (h < 0 || h >= MAX_THREAD || ts[h].cmd_fdw == -1) {
+    // No poll thread left to watch the fd.
+    close(fd);
+    return true;
+  }
+  if (ts[h].thread_id.has_value() && ts[h].thread_id.value() == pthread_self()) {
+    remove_fd_and_close(h, fd);
+    return true;
+  }
+  sock_cmd_t cmd = {CMD_REMOVE_FD, fd, 0, 0, 0};
+
+  ssize_t ret;
+  OSI_NO_INTR(ret = send(ts[h].cmd_fdw, &cmd, sizeof(cmd), 0));
+  if (ret != sizeof(cmd)) {
+    log::error("unable to hand fd:{} to thread handle:{}, closing it", fd, h);
+    close(fd);
+    return false;
+  }
+  return true;
+}
 int btsock_thread_exit(int h) {
   if (h < 0 || h >= MAX_THREAD) {
     log::error("invalid bt thread slot:{}", h);
@@ -269,77 +298,92 @@ int btsock_thread_exit(int h) {
   }
   return false;
 }
-static void init_poll(int h) {
-  int i;
-  ts[h].poll_count = 0;
+static bool init_poll(int h) {
+  ts[h].ps.clear();
   ts[h].thread_id = std::nullopt;
   ts[h].callback = NULL;
   ts[h].cmd_callback = NULL;
-  for (i = 0; i < MAX_POLL; i++) {
-    ts[h].ps[i].pfd.fd = -1;
-    ts[h].psi[i] = -1;
+  ts[h].epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (ts[h].epoll_fd == -1) {
+    log::error("epoll_create1 failed: {}", strerror(errno));
+    return false;
   }
   init_cmd_fd(h);
+  return true;
 }
-static inline unsigned int flags2pevents(int flags) {
-  unsigned int pevents = 0;
+static inline uint32_t flags2events(int flags) {
+  uint32_t events = 0;
   if (flags & SOCK_THREAD_FD_WR) {
-    pevents |= POLLOUT;
+    events |= EPOLLOUT;
   }
   if (flags & SOCK_THREAD_FD_RD) {
-    pevents |= POLLIN;
+    events |= EPOLLIN;
   }
-  pevents |= POLL_EXCEPTION_EVENTS;
-  return pevents;
+  events |= EPOLL_EXCEPTION_EVENTS;
+  return events;
 }
 
-static inline void set_poll(poll_slot_t* ps, int fd, int type, int flags, uint32_t user_id) {
-  ps->pfd.fd = fd;
-  ps->user_id = user_id;
-  if (ps->type != 0 && ps->type != type) {
-    log::error("poll socket type should not changed! type was:{}, type now:{}", ps->type, type);
-  }
-  ps->type = type;
-  ps->flags = flags;
-  ps->pfd.events = flags2pevents(flags);
-  ps->pfd.revents = 0;
+static inline bool set_poll(int h, int fd, poll_slot_t* ps, int op) {
+  struct epoll_event event = {};
+  event.events = flags2events(ps->flags);
+  if (fd != ts[h].cmd_fdr) {
+    // The kernel disarms the fd once signaled, its owner adds it back.
+    event.events |= EPOLLONESHOT;
+  }
+  event.data.fd = fd;
+  if (epoll_ctl(ts[h].epoll_fd, op, fd, &event) == 0) {
+    return true;
+  }
+  // The fd was closed and reopened without being removed from the set, the
+  // kernel has already dropped the stale registration.
+  if (op == EPOLL_CTL_MOD && errno == ENOENT &&
+      epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0) {
+    return true;
+  }
+  log::error("epoll_ctl op:{} fd:{} failed: {}", op, fd, strerror(errno));
+  return false;
 }
 static inline void add_poll(int h, int fd, int type, int flags, uint32_t user_id) {
   asrt(fd != -1);
-  int i;
-  int empty = -1;
-  poll_slot_t* ps = ts[h].ps;
-
-  for (i = 0; i < MAX_POLL; i++) {
-    if (ps[i].pfd.fd == fd) {
-      asrt(ts[h].poll_count < MAX_POLL);
-
-      set_poll(&ps[i], fd, type, flags | ps[i].flags, user_id);
-      return;
-    } else if (empty < 0 && ps[i].pfd.fd == -1) {
-      empty = i;
+  auto it = ts[h].ps.find(fd);
+  if (it != ts[h].ps.end()) {
+    poll_slot_t* ps = &it->second;
+    if (ps->type != 0 && ps->type != type) {
+      log::error("poll socket type should not changed! type was:{}, type now:{}", ps->type, type);
     }
+    ps->type = type;
+    ps->flags |= flags;
+    ps->user_id = user_id;
+    set_poll(h, fd, ps, EPOLL_CTL_MOD);
+    return;
   }
-  if (empty >= 0) {
-    asrt(ts[h].poll_count < MAX_POLL);
-    set_poll(&ps[empty], fd, type, flags, user_id);
-    ++ts[h].poll_count;
+  poll_slot_t slot = {user_id, type, flags};
+  if (set_poll(h, fd, &slot, EPOLL_CTL_ADD)) {
+    ts[h].ps[fd] = slot;
+  }
+}
+static inline void remove_poll(int h, int fd) {
+  auto it = ts[h].ps.find(fd);
+  if (it == ts[h].ps.end()) {
     return;
   }
-  log::error("exceeded max poll slot:{}!", MAX_POLL);
+  epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+  ts[h].ps.erase(it);
 }
-static inline void remove_poll(int h, poll_slot_t* ps, int flags) {
-  if (flags == ps->flags) {
-    // all monitored events signaled. To remove it, just clear the slot
-    --ts[h].poll_count;
-    memset(ps, 0, sizeof(*ps));
-    ps->pfd.fd = -1;
-  } else {
-    // one read or one write monitor event signaled, removed the accordding bit
-    ps->flags &= ~flags;
-    // update the poll events mask
-    ps->pfd.events = flags2pevents(ps->flags);
+static inline void disarm_poll(int h, int fd, poll_slot_t* ps, int flags) {
+  ps->flags &= ~flags;
+  if (ps->flags) {
+    // one read or one write monitor event signaled, watch the other one again
+    set_poll(h, fd, ps, EPOLL_CTL_MOD);
   }
+  // else the fd stays in the epoll set, disarmed, until it is added back
+}
+static void remove_fd_and_close(int h, int fd) {
+  auto it = ts[h].ps.find(fd);
+  if (fd != ts[h].cmd_fdr && it != ts[h].ps.end()) {
+    remove_poll(h, fd);
+  }
+  close(fd);
 }
 static int process_cmd_sock(int h) {
   sock_cmd_t cmd = {-1, 0, 0, 0, 0};
@@ -357,14 +401,7 @@ static int process_cmd_sock(int h) {
       add_poll(h, cmd.fd, cmd.type, cmd.flags, cmd.user_id);
       break;
     case CMD_REMOVE_FD:
-      for (int i = 1; i < MAX_POLL; ++i) {
-        poll_slot_t* poll_slot = &ts[h].ps[i];
-        if (poll_slot->pfd.fd == cmd.fd) {
-          remove_poll(h, poll_slot, poll_slot->flags);
-          break;
-        }
-      }
-      close(cmd.fd);
+      remove_fd_and_close(h, cmd.fd);
       break;
     case CMD_WAKEUP:
       break;
@@ -383,98 +420,64 @@ static int process_cmd_sock(int h) {
   return true;
 }
 
-static void process_data_sock(int h, struct pollfd* pfds, int pfds_count, int event_count) {
-  asrt(event_count <= pfds_count);
-  int i;
-  for (i = 1; i < pfds_count; i++) {
-    if (pfds[i].revents) {
-      int ps_i = ts[h].psi[i];
-      if (ts[h].ps[ps_i].pfd.fd == -1) {
-        log::info("Socket has been removed from poll set");
-        continue;
-      }
-      asrt(pfds[i].fd == ts[h].ps[ps_i].pfd.fd);
-      uint32_t user_id = ts[h].ps[ps_i].user_id;
-      int type = ts[h].ps[ps_i].type;
-      int flags = 0;
-      if (IS_READ(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_RD;
-      }
-      if (IS_WRITE(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_WR;
-      }
-      if (IS_EXCEPTION(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_EXCEPTION;
-        // remove the whole slot not flags
-        remove_poll(h, &ts[h].ps[ps_i], ts[h].ps[ps_i].flags);
-      } else if (flags) {
-        remove_poll(h, &ts[h].ps[ps_i],
-                    flags);  // remove the monitor flags that already processed
-      }
-      if (flags) {
-        ts[h].callback(pfds[i].fd, type, flags, user_id);
-      }
-    }
+static void process_data_sock(int h, const struct epoll_event& event) {
+  int fd = event.data.fd;
+  auto it = ts[h].ps.find(fd);
+  if (it == ts[h].ps.end()) {
+    log::info("Socket has been removed from poll set");
+    return;
   }
-}
-
-static void prepare_poll_fds(int h, struct pollfd* pfds) {
-  int count = 0;
-  int ps_i = 0;
-  int pfd_i = 0;
-  asrt(ts[h].poll_count <= MAX_POLL);
-  while (count < ts[h].poll_count) {
-    if (ps_i >= MAX_POLL) {
-      log::error(
-              "exceed max poll range, ps_i:{}, MAX_POLL:{}, count:{}, "
-              "ts[h].poll_count:{}",
-              ps_i, MAX_POLL, count, ts[h].poll_count);
-      return;
-    }
-    if (ts[h].ps[ps_i].pfd.fd >= 0) {
-      pfds[pfd_i] = ts[h].ps[ps_i].pfd;
-      ts[h].psi[pfd_i] = ps_i;
-      count++;
-      pfd_i++;
-    }
-    ps_i++;
+  uint32_t user_id = it->second.user_id;
+  int type = it->second.type;
+  int flags = 0;
+  if (IS_READ(event.events)) {
+    flags |= SOCK_THREAD_FD_RD;
+  }
+  if (IS_WRITE(event.events)) {
+    flags |= SOCK_THREAD_FD_WR;
+  }
+  if (IS_EXCEPTION(event.events)) {
+    flags |= SOCK_THREAD_FD_EXCEPTION;
+    // remove the whole slot not flags
+    remove_poll(h, fd);
+  } else if (flags) {
+    disarm_poll(h, fd, &it->second, flags);  // remove the monitor flags that already processed
+  }
+  if (flags) {
+    ts[h].callback(fd, type, flags, user_id);
   }
 }
+
 static void* sock_poll_thread(void* arg) {
-  std::array<struct pollfd, MAX_POLL> pfds;
+  std::array<struct epoll_event, MAX_EPOLL_EVENTS> events;
 
   int h = (intptr_t)arg;
   for (;;) {
-    pfds = {};
-    prepare_poll_fds(h, pfds.data());
     int ret;
-    OSI_NO_INTR(ret = poll(pfds.data(), ts[h].poll_count, -1));
+    OSI_NO_INTR(ret = epoll_wait(ts[h].epoll_fd, events.data(), events.size(), -1));
     if (ret == -1) {
-      log::error("poll ret -1, exit the thread, errno:{}, err:{}", errno, strerror(errno));
+      log::error("epoll_wait ret -1, exit the thread, errno:{}, err:{}", errno, strerror(errno));
       break;
     }
-    if (ret != 0) {
-      int need_process_data_fd = true;
-      int pfds_count = ts[h].poll_count;
-      if (pfds[0].revents)  // cmd fd always is the first one
-      {
-        asrt(pfds[0].fd == ts[h].cmd_fdr);
+    bool exit = false;
+    for (int i = 0; i < ret; i++) {
+      if (events[i].data.fd == ts[h].cmd_fdr) {
+        // Handle the cmd before the data fds, it may remove some of them.
         if (!process_cmd_sock(h)) {
           log::info("h:{}, process_cmd_sock return false, exit...", h);
-          break;
-        }
-        if (ret == 1) {
-          need_process_data_fd = false;
-        } else {
-          ret--;  // exclude the cmd fd
+          exit = true;
         }
+        break;
       }
-      if (need_process_data_fd) {
-        process_data_sock(h, pfds.data(), pfds_count, ret);
+    }
+    if (exit) {
+      break;
+    }
+    for (int i = 0; i < ret; i++) {
+      if (events[i].data.fd != ts[h].cmd_fdr) {
+        process_data_sock(h, events[i]);
       }
-    } else {
-      log::info("no data, select ret: {}", ret);
-    };
+    }
   }
   log::info("socket poll thread exiting, h:{}", h);
   return 0;
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btif/include/btif_a2dp_sink_jitter_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+constexpr uint64_t kPacketUs = 20 * 1000;
+
+using Action = A2dpSinkJitterBuffer::Action;
+
+class A2dpSinkJitterBufferTest : public ::testing::Test {
+protected:
+  // Receives a packet of `duration_us` at `now_us`, decoded and played
+  // without resampling.
+  Action Receive(uint64_t now_us, uint64_t duration_us = kPacketUs) {
+    jitter_buffer_.OnPacket(now_us, duration_us);
+    return jitter_buffer_.OnAudio(now_us, duration_us);
+  }
+
+  A2dpSinkJitterBuffer jitter_buffer_;
+};
+
+}  // namespace
+
+TEST_F(A2dpSinkJitterBufferTest, holds_until_target_depth) {
+  EXPECT_EQ(A2dpSinkJitterBuffer::kMinTargetDepthUs, jitter_buffer_.target_depth_us());
+  EXPECT_EQ(Action::kHold, Receive(0));
+  EXPECT_FALSE(jitter_buffer_.playing());
+  EXPECT_EQ(Action::kWrite, Receive(kPacketUs));
+  EXPECT_TRUE(jitter_buffer_.playing());
+  EXPECT_EQ(2 * int64_t(kPacketUs), jitter_buffer_.DepthUs(kPacketUs));
+  EXPECT_EQ(Action::kWrite, Receive(2 * kPacketUs));
+  EXPECT_EQ(1u, jitter_buffer_.stats().prebuffers);
+  EXPECT_EQ(3u, jitter_buffer_.stats().packets);
+}
+
+TEST_F(A2dpSinkJitterBufferTest, target_depth_follows_jitter) {
+  // Packets alternately 10 ms early and 10 ms late.
+  uint64_t now_us = 0;
+  for (int i = 0; i < 200; i++) {
+    Receive(now_us);
+    now_us += (i % 2) ? kPacketUs + 10000 : kPacketUs - 10000;
+  }
+  EXPECT_NEAR(10000, double(jitter_buffer_.jitter_us()), 500);
+  EXPECT_NEAR(kPacketUs + 3 * 10000, double(jitter_buffer_.target_depth_us()), 1500);
+  EXPECT_EQ(0u, jitter_buffer_.stats().underruns);
+}
+
+TEST_F(A2dpSinkJitterBufferTest, underrun_builds_the_buffer_up_again) {
+  Receive(0);
+  ASSERT_EQ(Action::kWrite, Receive(kPacketUs));
+
+  // The track played the 40 ms written, and 60 ms of silence.
+  EXPECT_EQ(Action::kHold, Receive(kPacketUs + 100 * 1000));
+  EXPECT_FALSE(jitter_buffer_.playing());
+  EXPECT_EQ(1u, jitter_buffer_.stats().underruns);
+  EXPECT_EQ(60u * 1000, jitter_buffer_.stats().underrun_us);
+  EXPECT_EQ(1u, jitter_buffer_.stats().prebuffers);
+}
+
+TEST_F(A2dpSinkJitterBufferTest, drops_audio_too_far_ahead) {
+  // A burst of packets, after the peer held them for a while.
+  uint64_t written_us = 0;
+  while (written_us <= jitter_buffer_.target_depth_us() + 200 * 1000) {
+    ASSERT_NE(Action::kDrop, Receive(0));
+    written_us += kPacketUs;
+  }
+  EXPECT_EQ(Action::kDrop, Receive(0));
+  EXPECT_EQ(1u, jitter_buffer_.stats().dropped_packets);
+  EXPECT_EQ(kPacketUs, jitter_buffer_.stats().dropped_us);
+}
+
+TEST_F(A2dpSinkJitterBufferTest, compensates_clock_drift) {
+  // The clock of the remote source runs 500 ppm faster than the track: it
+  // sends 20 ms of audio every 19.99 ms. Without compensation, the buffer
+  // would grow by 30 ms a minute.
+  const double arrival_period_us = kPacketUs * (1 - 500e-6);
+  for (int i = 0; i < 3 * 60 * 50; i++) {
+    uint64_t now_us = llround(i * arrival_period_us);
+    jitter_buffer_.OnPacket(now_us, kPacketUs);
+    double output_us = kPacketUs / jitter_buffer_.ratio();
+    jitter_buffer_.OnAudio(now_us, llround(output_us));
+  }
+
+  EXPECT_NEAR(500e-6, jitter_buffer_.ratio() - 1.0, 50e-6);
+  uint64_t now_us = llround(3 * 60 * 50 * arrival_period_us);
+  EXPECT_NEAR(double(jitter_buffer_.target_depth_us()), double(jitter_buffer_.DepthUs(now_us)),
+              kPacketUs + 25 * 1000);
+  EXPECT_EQ(0u, jitter_buffer_.stats().underruns);
+  EXPECT_EQ(0u, jitter_buffer_.stats().dropped_packets);
+}
+
+TEST_F(A2dpSinkJitterBufferTest, reset_keeps_statistics) {
+  Receive(0);
+  Receive(kPacketUs);
+  jitter_buffer_.Reset();
+  EXPECT_FALSE(jitter_buffer_.playing());
+  EXPECT_EQ(1.0, jitter_buffer_.ratio());
+  EXPECT_EQ(2u, jitter_buffer_.stats().packets);
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btif/include/btif_sock_thread.h"
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr auto kTimeout = 2s;
+// Twice the number of fds a poll thread could watch before it used epoll.
+constexpr int kManySockets = 128;
+
+struct Signal {
+  int fd;
+  int flags;
+  uint32_t user_id;
+};
+
+std::mutex signals_mutex;
+std::condition_variable signals_cv;
+std::vector<Signal> signals;
+
+void OnSignaled(int fd, int /* type */, int flags, uint32_t user_id) {
+  std::unique_lock<std::mutex> lock(signals_mutex);
+  signals.push_back({fd, flags, user_id});
+  signals_cv.notify_all();
+}
+
+class BtifSockThreadTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    signals.clear();
+    btsock_thread_init();
+    handle_ = btsock_thread_create(OnSignaled, nullptr);
+    ASSERT_GE(handle_, 0);
+    sync_fd_ = NewSocket();
+  }
+
+  void TearDown() override {
+    btsock_thread_exit(handle_);
+    for (auto [our_fd, app_fd] : pairs_) {
+      close(our_fd);
+      close(app_fd);
+    }
+  }
+
+  // Returns the fd of the stack side, the fd of the app side is written to by
+  // Send().
+  int NewSocket() {
+    int fds[2];
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds), 0);
+    pairs_.push_back({fds[0], fds[1]});
+    return fds[0];
+  }
+
+  void Send(int our_fd) {
+    for (auto [fd, app_fd] : pairs_) {
+      if (fd == our_fd) {
+        uint8_t byte = 0;
+        ASSERT_EQ(send(app_fd, &byte, sizeof(byte), 0), 1);
+      }
+    }
+  }
+
+  // The fd is closed by the poll thread.
+  void Forget(int our_fd) {
+    for (auto& [fd, app_fd] : pairs_) {
+      if (fd == our_fd) {
+        fd = -1;
+      }
+    }
+  }
+
+  std::vector<Signal> WaitForSignals(size_t count) {
+    std::unique_lock<std::mutex> lock(signals_mutex);
+    signals_cv.wait_for(lock, kTimeout, [count] { return signals.size() >= count; });
+    return signals;
+  }
+
+  // Makes sure the poll thread handled all the commands sent so far.
+  void Sync() {
+    size_t count = WaitForSignals(0).size();
+    btsock_thread_add_fd(handle_, sync_fd_, 0, SOCK_THREAD_FD_WR, UINT32_MAX);
+    WaitForSignals(count + 1);
+    std::unique_lock<std::mutex> lock(signals_mutex);
+    ASSERT_EQ(signals.back().user_id, UINT32_MAX);
+    signals.pop_back();
+  }
+
+  int handle_;
+  // Always writable, signaled to know when the commands before it were handled.
+  int sync_fd_;
+  std::vector<std::pair<int, int>> pairs_;
+};
+
+TEST_F(BtifSockThreadTest, more_sockets_than_a_pollfd_array_on_one_thread) {
+  std::vector<int> fds;
+  for (int i = 0; i < kManySockets; i++) {
+    fds.push_back(NewSocket());
+    btsock_thread_add_fd(handle_, fds.back(), 0, SOCK_THREAD_FD_RD, i);
+  }
+  for (int fd : fds) {
+    Send(fd);
+  }
+
+  auto received = WaitForSignals(kManySockets);
+  ASSERT_EQ(received.size(), static_cast<size_t>(kManySockets));
+  std::vector<bool> seen(kManySockets);
+  for (const Signal& signal : received) {
+    ASSERT_LT(signal.user_id, static_cast<uint32_t>(kManySockets));
+    EXPECT_EQ(signal.fd, fds[signal.user_id]);
+    EXPECT_EQ(signal.flags, SOCK_THREAD_FD_RD);
+    seen[signal.user_id] = true;
+  }
+  EXPECT_EQ(std::count(seen.begin(), seen.end(), true), kManySockets);
+}
+
+TEST_F(BtifSockThreadTest, signaled_fd_is_not_watched_until_added_back) {
+  int fd = NewSocket();
+  btsock_thread_add_fd(handle_, fd, 0, SOCK_THREAD_FD_RD, 1);
+  Send(fd);
+  ASSERT_EQ(WaitForSignals(1).size(), 1u);
+
+  // The data is still unread, but the owner has not asked for more.
+  Send(fd);
+  Sync();
+  EXPECT_EQ(WaitForSignals(0).size(), 1u);
+
+  btsock_thread_add_fd(handle_, fd, 0, SOCK_THREAD_FD_RD, 1);
+  EXPECT_EQ(WaitForSignals(2).size(), 2u);
+}
+
+TEST_F(BtifSockThreadTest, peer_close_is_reported_as_exception) {
+  int fd = NewSocket();
+  btsock_thread_add_fd(handle_, fd, 0, SOCK_THREAD_FD_EXCEPTION, 1);
+  close(pairs_.back().second);
+  pairs_.back().second = -1;
+
+  auto received = WaitForSignals(1);
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_TRUE(received[0].flags & SOCK_THREAD_FD_EXCEPTION);
+  EXPECT_EQ(received[0].user_id, 1u);
+}
+
+TEST_F(BtifSockThreadTest, reused_fd_number_is_not_reported_to_the_old_owner) {
+  int old_fd = NewSocket();
+  btsock_thread_add_fd(handle_, old_fd, 0, SOCK_THREAD_FD_RD, 1);
+  btsock_thread_remove_fd_and_close(handle_, old_fd);
+  Forget(old_fd);
+  Sync();
+
+  // The lowest fd number available is the one just closed.
+  int new_fd = NewSocket();
+  ASSERT_EQ(new_fd, old_fd);
+  btsock_thread_add_fd(handle_, new_fd, 0, SOCK_THREAD_FD_RD, 2);
+  Send(new_fd);
+
+  auto received = WaitForSignals(1);
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0].user_id, 2u);
+  EXPECT_EQ(received[0].flags, SOCK_THREAD_FD_RD);
+}
+
+TEST_F(BtifSockThreadTest, removed_fd_is_not_reported) {
+  int fd = NewSocket();
+  btsock_thread_add_fd(handle_, fd, 0, SOCK_THREAD_FD_RD, 1);
+  btsock_thread_remove_fd_and_close(handle_, fd);
+  Forget(fd);
+  Sync();
+
+  EXPECT_TRUE(WaitForSignals(0).empty());
+}
+
+TEST_F(BtifSockThreadTest, remove_without_thread_closes_fd) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds), 0);
+  btsock_thread_remove_fd_and_close(-1, fds[0]);
+
+  uint8_t byte = 0;
+  EXPECT_EQ(send(fds[1], &byte, sizeof(byte), MSG_NOSIGNAL), -1);
+  close(fds[1]);
+}
+
+}  // namespace
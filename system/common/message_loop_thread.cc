@@ -30,6 +30,7 @@
 #include <thread>
 
 #include "common/postable_context.h"
+#include "common/task_profiler.h"
 
 namespace bluetooth {
 namespace common {
@@ -77,6 +78,14 @@ bool MessageLoopThread::DoInThread(const base::Location& from_here, base::OnceCl
 
 bool MessageLoopThread::DoInThreadDelayed(const base::Location& from_here, base::OnceClosure task,
                                           std::chrono::microseconds delay) {
+  if (TaskProfiler::IsEnabled()) {
+    task = TaskProfiler::Wrap(TaskProfiler::OnPosted(from_here, delay), std::move(task));
+  }
+  return PostDelayedTask(from_here, std::move(task), delay);
+}
+
+bool MessageLoopThread::PostDelayedTask(const base::Location& from_here, base::OnceClosure task,
+                                        std::chrono::microseconds delay) {
   std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
 
   if (message_loop_ == nullptr) {
@@ -200,8 +209,12 @@ void MessageLoopThread::Run(std::promise<void> start_up_promise) {
   }
 }
 
-void MessageLoopThread::Post(base::OnceClosure closure) {
-  DoInThread(FROM_HERE, std::move(closure));
+void MessageLoopThread::PostTask(base::OnceClosure closure,
+                                 const std::source_location& from_here) {
+  if (TaskProfiler::IsEnabled()) {
+    closure = TaskProfiler::Wrap(TaskProfiler::OnPosted(from_here), std::move(closure));
+  }
+  PostDelayedTask(FROM_HERE, std::move(closure), std::chrono::microseconds(0));
 }
 
 PostableContext* MessageLoopThread::Postable() { return this; }
@@ -168,14 +168,15 @@ public:
   bool DoInThreadDelayed(const base::Location& from_here, base::OnceClosure task,
                          std::chrono::microseconds delay);
   /**
-   * Wrapper around DoInThread without a location.
+   * Returns a postable object
    */
-  void Post(base::OnceClosure closure) override;
+  PostableContext* Postable();
 
+protected:
   /**
-   * Returns a postable object
+   * Wrapper around DoInThread with a std::source_location.
    */
-  PostableContext* Postable();
+  void PostTask(base::OnceClosure closure, const std::source_location& from_here) override;
 
 private:
   /**
@@ -197,6 +198,12 @@ private:
    */
   void Run(std::promise<void> start_up_promise);
 
+  /**
+   * Post a task to the message loop, without profiling it
+   */
+  bool PostDelayedTask(const base::Location& from_here, base::OnceClosure task,
+                       std::chrono::microseconds delay);
+
   mutable std::recursive_mutex api_mutex_;
   const std::string thread_name_;
   btbase::AbstractMessageLoop* message_loop_;
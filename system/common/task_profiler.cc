@@ -0,0 +1,425 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "BtTaskProfiler"
+
+#include "common/task_profiler.h"
+
+#include <base/functional/bind.h>
+#include <base/strings/stringprintf.h>
+#include <bluetooth/log.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace bluetooth {
+namespace common {
+
+std::atomic<bool> TaskProfiler::enabled_{false};
+
+namespace {
+
+constexpr size_t kMaxSites = 1024;
+// Site accounting the tasks posted once the site table is full.
+constexpr uint16_t kOverflowSite = 0;
+// Bucket i counts the durations of i significant bits in us, the last bucket everything longer.
+constexpr size_t kNumBuckets = 24;
+// Number of recent tasks each thread keeps for trace export.
+constexpr size_t kTraceEvents = 2048;
+constexpr size_t kMaxDumpedSites = 20;
+
+int64_t NowNs() {
+  timespec now;
+  clock_gettime(CLOCK_BOOTTIME, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+struct SiteKey {
+  const char* function;
+  const char* file;
+  int line;
+
+  bool operator==(const SiteKey& other) const {
+    return function == other.function && file == other.file && line == other.line;
+  }
+};
+
+struct Site {
+  std::atomic<bool> used{false};
+  // Written once, before |used| is set.
+  SiteKey key{};
+};
+
+// Open addressed table of the posting sites, read without locking.
+struct SiteTable {
+  // Guards insertions.
+  std::mutex mutex;
+  Site sites[kMaxSites];
+};
+
+// Never destroyed, tasks may still be posted after static destructors ran.
+SiteTable& GetSiteTable() {
+  static SiteTable* table = new SiteTable();
+  return *table;
+}
+
+size_t Hash(const SiteKey& key) {
+  uint64_t hash = reinterpret_cast<uintptr_t>(key.function) * 0x9e3779b97f4a7c15ull;
+  hash ^= reinterpret_cast<uintptr_t>(key.file) +
+          static_cast<uint64_t>(key.line) * 0xff51afd7ed558ccdull;
+  return hash ^ (hash >> 29);
+}
+
+std::optional<uint16_t> find_site(SiteTable& table, const SiteKey& key, bool insert) {
+  constexpr size_t kNumProbed = kMaxSites - 1;
+  size_t start = Hash(key) % kNumProbed;
+  for (size_t probe = 0; probe < kNumProbed; probe++) {
+    uint16_t index = 1 + (start + probe) % kNumProbed;
+    Site& site = table.sites[index];
+    if (!site.used.load(std::memory_order_acquire)) {
+      if (!insert) {
+        return std::nullopt;
+      }
+      site.key = key;
+      site.used.store(true, std::memory_order_release);
+      return index;
+    }
+    if (site.key == key) {
+      return index;
+    }
+  }
+  return kOverflowSite;
+}
+
+uint16_t GetSite(const SiteKey& key) {
+  SiteTable& table = GetSiteTable();
+  auto index = find_site(table, key, /* insert= */ false);
+  if (index.has_value()) {
+    return *index;
+  }
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return find_site(table, key, /* insert= */ true).value_or(kOverflowSite);
+}
+
+std::string GetSiteName(uint16_t index) {
+  if (index == kOverflowSite) {
+    return "(other sites)";
+  }
+  const SiteKey& key = GetSiteTable().sites[index].key;
+  return base::StringPrintf("%s@%s:%d", key.function, key.file, key.line);
+}
+
+// All the counters below are only written by the thread owning them, so they are updated with
+// plain loads and stores; the atomics only make concurrent reads from dumpsys well defined.
+void Bump(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+struct Histogram {
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> total_ns{0};
+  std::atomic<uint64_t> max_ns{0};
+  std::atomic<uint64_t> buckets[kNumBuckets]{};
+
+  void Record(uint64_t ns) {
+    Bump(count, 1);
+    Bump(total_ns, ns);
+    if (ns > max_ns.load(std::memory_order_relaxed)) {
+      max_ns.store(ns, std::memory_order_relaxed);
+    }
+    uint64_t us = ns / 1000;
+    size_t bucket = us == 0 ? 0 : 64 - __builtin_clzll(us);
+    Bump(buckets[std::min(bucket, kNumBuckets - 1)], 1);
+  }
+
+  TaskProfiler::Latency Summarize() const {
+    uint64_t total_count = count.load(std::memory_order_relaxed);
+    uint64_t max = max_ns.load(std::memory_order_relaxed);
+    uint64_t target = (total_count * 99 + 99) / 100;
+    uint64_t p99 = max;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket + 1 < kNumBuckets; bucket++) {
+      seen += buckets[bucket].load(std::memory_order_relaxed);
+      if (seen >= target) {
+        p99 = std::min<uint64_t>((uint64_t{1} << bucket) * 1000, max);
+        break;
+      }
+    }
+    return {total_ns.load(std::memory_order_relaxed), max, p99};
+  }
+};
+
+struct SiteStats {
+  Histogram queue_delay;
+  Histogram run_time;
+};
+
+// One recently run task, guarded by a sequence lock: |sequence| is odd while it is written.
+struct TraceEvent {
+  std::atomic<uint32_t> sequence{0};
+  std::atomic<uint16_t> site{0};
+  std::atomic<int64_t> ready_ns{0};
+  std::atomic<int64_t> start_ns{0};
+  std::atomic<int64_t> end_ns{0};
+};
+
+struct alignas(64) ThreadProfile {
+  // Guarded by the registry mutex.
+  std::string name;
+  pid_t tid = -1;
+  bool exited = false;
+
+  // Allocated on the first task of each site.
+  std::atomic<SiteStats*> sites[kMaxSites]{};
+  TraceEvent trace[kTraceEvents];
+  std::atomic<uint64_t> trace_count{0};
+};
+
+struct ThreadRegistry {
+  std::mutex mutex;
+  // Profiles are never freed: a thread restarted under the same name picks up its old profile.
+  std::vector<ThreadProfile*> threads;
+};
+
+ThreadRegistry& GetThreadRegistry() {
+  static ThreadRegistry* registry = new ThreadRegistry();
+  return *registry;
+}
+
+thread_local ThreadProfile* current_profile = nullptr;
+
+// Hands the profile of the calling thread back when it exits.
+struct ThreadProfileOwner {
+  ~ThreadProfileOwner() {
+    if (current_profile == nullptr) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(GetThreadRegistry().mutex);
+    current_profile->exited = true;
+    current_profile = nullptr;
+  }
+};
+
+thread_local ThreadProfileOwner thread_profile_owner;
+
+ThreadProfile* AttachThread() {
+  char name[16] = {};
+  pthread_getname_np(pthread_self(), name, sizeof(name));
+  pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+
+  ThreadRegistry& registry = GetThreadRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  ThreadProfile* profile = nullptr;
+  for (ThreadProfile* thread : registry.threads) {
+    if (thread->exited && thread->name == name) {
+      profile = thread;
+      break;
+    }
+  }
+  if (profile == nullptr) {
+    profile = new ThreadProfile();
+    profile->name = name;
+    registry.threads.push_back(profile);
+  }
+  profile->tid = tid;
+  profile->exited = false;
+  // Touch the owner so its destructor runs when the thread exits.
+  (void)&thread_profile_owner;
+  current_profile = profile;
+  return profile;
+}
+
+void RecordRun(TaskProfiler::PostedTask posted, int64_t start_ns, int64_t end_ns) {
+  ThreadProfile* profile = current_profile;
+  if (profile == nullptr) {
+    profile = AttachThread();
+  }
+
+  SiteStats* stats = profile->sites[posted.site].load(std::memory_order_relaxed);
+  if (stats == nullptr) {
+    stats = new SiteStats();
+    profile->sites[posted.site].store(stats, std::memory_order_release);
+  }
+  stats->queue_delay.Record(std::max<int64_t>(start_ns - posted.ready_ns, 0));
+  stats->run_time.Record(end_ns - start_ns);
+
+  uint64_t count = profile->trace_count.load(std::memory_order_relaxed);
+  TraceEvent& event = profile->trace[count % kTraceEvents];
+  uint32_t sequence = event.sequence.load(std::memory_order_relaxed);
+  event.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.site.store(posted.site, std::memory_order_relaxed);
+  event.ready_ns.store(posted.ready_ns, std::memory_order_relaxed);
+  event.start_ns.store(start_ns, std::memory_order_relaxed);
+  event.end_ns.store(end_ns, std::memory_order_relaxed);
+  event.sequence.store(sequence + 2, std::memory_order_release);
+  profile->trace_count.store(count + 1, std::memory_order_release);
+}
+
+void RunTask(TaskProfiler::PostedTask posted, base::OnceClosure task) {
+  int64_t start_ns = NowNs();
+  std::move(task).Run();
+  RecordRun(posted, start_ns, NowNs());
+}
+
+struct ThreadSnapshot {
+  std::string name;
+  pid_t tid;
+  const ThreadProfile* profile;
+};
+
+std::vector<ThreadSnapshot> GetThreads() {
+  ThreadRegistry& registry = GetThreadRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<ThreadSnapshot> threads;
+  for (const ThreadProfile* profile : registry.threads) {
+    threads.push_back({profile->name, profile->tid, profile});
+  }
+  return threads;
+}
+
+std::string EscapeJson(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+double ToUs(uint64_t ns) { return ns / 1000.0; }
+
+}  // namespace
+
+void TaskProfiler::SetEnabled(bool enabled) {
+  log::info("Task profiler {}", enabled ? "enabled" : "disabled");
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+TaskProfiler::PostedTask TaskProfiler::OnPosted(const base::Location& from_here,
+                                                std::chrono::microseconds delay) {
+  uint16_t site =
+          GetSite({from_here.function_name(), from_here.file_name(), from_here.line_number()});
+  return {site, NowNs() + delay.count() * 1000};
+}
+
+TaskProfiler::PostedTask TaskProfiler::OnPosted(const std::source_location& from_here) {
+  uint16_t site = GetSite({from_here.function_name(), from_here.file_name(),
+                           static_cast<int>(from_here.line())});
+  return {site, NowNs()};
+}
+
+base::OnceClosure TaskProfiler::Wrap(PostedTask posted, base::OnceClosure task) {
+  return base::BindOnce(&RunTask, posted, std::move(task));
+}
+
+std::vector<TaskProfiler::SiteSummary> TaskProfiler::GetSummaries() {
+  std::vector<SiteSummary> summaries;
+  for (const ThreadSnapshot& thread : GetThreads()) {
+    for (size_t site = 0; site < kMaxSites; site++) {
+      const SiteStats* stats = thread.profile->sites[site].load(std::memory_order_acquire);
+      if (stats == nullptr) {
+        continue;
+      }
+      summaries.push_back({thread.name, GetSiteName(site),
+                           stats->run_time.count.load(std::memory_order_relaxed),
+                           stats->queue_delay.Summarize(), stats->run_time.Summarize()});
+    }
+  }
+  std::sort(summaries.begin(), summaries.end(), [](const SiteSummary& a, const SiteSummary& b) {
+    return a.run_time.max_ns > b.run_time.max_ns;
+  });
+  return summaries;
+}
+
+void TaskProfiler::Dump(int fd) {
+  dprintf(fd, "\nBluetooth Task Profiler: %s\n", IsEnabled() ? "enabled" : "disabled");
+  auto summaries = GetSummaries();
+  if (summaries.empty()) {
+    dprintf(fd, "  No task recorded\n");
+    return;
+  }
+  if (summaries.size() > kMaxDumpedSites) {
+    summaries.resize(kMaxDumpedSites);
+  }
+  dprintf(fd, "  Longest tasks, times in us (avg / p99 / max):\n");
+  dprintf(fd, "  %-16s %10s %26s %26s  %s\n", "Thread", "Count", "Execution", "Queueing delay",
+          "Posted from");
+  for (const auto& summary : summaries) {
+    uint64_t count = std::max<uint64_t>(summary.count, 1);
+    std::string run_time = base::StringPrintf(
+            "%.0f / %.0f / %.0f", ToUs(summary.run_time.total_ns / count),
+            ToUs(summary.run_time.p99_ns), ToUs(summary.run_time.max_ns));
+    std::string queue_delay = base::StringPrintf(
+            "%.0f / %.0f / %.0f", ToUs(summary.queue_delay.total_ns / count),
+            ToUs(summary.queue_delay.p99_ns), ToUs(summary.queue_delay.max_ns));
+    dprintf(fd, "  %-16s %10llu %26s %26s  %s\n", summary.thread_name.c_str(),
+            static_cast<unsigned long long>(summary.count), run_time.c_str(), queue_delay.c_str(),
+            summary.site_name.c_str());
+  }
+}
+
+void TaskProfiler::ExportTrace(int fd) {
+  pid_t pid = getpid();
+  std::unordered_map<uint16_t, std::string> site_names;
+  const char* separator = "";
+
+  dprintf(fd, "{\"traceEvents\":[");
+  for (const ThreadSnapshot& thread : GetThreads()) {
+    dprintf(fd, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                "\"args\":{\"name\":\"%s\"}}",
+            separator, pid, thread.tid, EscapeJson(thread.name).c_str());
+    separator = ",";
+
+    const ThreadProfile* profile = thread.profile;
+    uint64_t count = profile->trace_count.load(std::memory_order_acquire);
+    uint64_t first = count > kTraceEvents ? count - kTraceEvents : 0;
+    for (uint64_t i = first; i < count; i++) {
+      const TraceEvent& event = profile->trace[i % kTraceEvents];
+      uint32_t sequence = event.sequence.load(std::memory_order_acquire);
+      uint16_t site = event.site.load(std::memory_order_relaxed);
+      int64_t ready_ns = event.ready_ns.load(std::memory_order_relaxed);
+      int64_t start_ns = event.start_ns.load(std::memory_order_relaxed);
+      int64_t end_ns = event.end_ns.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if ((sequence & 1) != 0 || event.sequence.load(std::memory_order_relaxed) != sequence) {
+        // Overwritten by its thread while it was read.
+        continue;
+      }
+      auto name = site_names.find(site);
+      if (name == site_names.end()) {
+        name = site_names.emplace(site, EscapeJson(GetSiteName(site))).first;
+      }
+      dprintf(fd, ",\n{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                  "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"queue_delay_us\":%.3f}}",
+              name->second.c_str(), pid, thread.tid, ToUs(start_ns), ToUs(end_ns - start_ns),
+              ToUs(std::max<int64_t>(start_ns - ready_ns, 0)));
+    }
+  }
+  dprintf(fd, "\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+}  // namespace common
+}  // namespace bluetooth
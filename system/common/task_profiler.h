@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <base/functional/callback.h>
+#include <base/location.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <source_location>
+#include <string>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+
+/**
+ * Opt-in profiler of the tasks posted to the stack threads.
+ *
+ * When enabled, every posted task records when it became runnable, so the
+ * thread running it can account its queueing delay and its execution time to
+ * the location that posted it. The accounting is done in per-thread tables
+ * that are only written by their own thread, so recording takes no lock.
+ * Each thread also keeps a ring of its most recent tasks for trace export.
+ *
+ * When disabled, posting costs a single relaxed load.
+ */
+class TaskProfiler {
+public:
+  // What a posted task carries until it runs.
+  struct PostedTask {
+    uint16_t site;
+    // CLOCK_BOOTTIME time at which the task became runnable, in ns.
+    int64_t ready_ns;
+  };
+
+  struct Latency {
+    uint64_t total_ns;
+    uint64_t max_ns;
+    // Upper bound of the histogram bucket holding the 99th percentile.
+    uint64_t p99_ns;
+  };
+
+  // Accounting of the tasks posted from one site and run on one thread.
+  struct SiteSummary {
+    std::string thread_name;
+    std::string site_name;
+    uint64_t count;
+    Latency queue_delay;
+    Latency run_time;
+  };
+
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+  static void SetEnabled(bool enabled);
+
+  // Records a task posted from |from_here|, runnable after |delay|.
+  static PostedTask OnPosted(const base::Location& from_here,
+                             std::chrono::microseconds delay = std::chrono::microseconds(0));
+
+  // Records a task posted from |from_here|, for the posting APIs that take a
+  // std::source_location instead of a base::Location.
+  static PostedTask OnPosted(const std::source_location& from_here);
+
+  // Returns |task| wrapped to account its queueing delay and execution time.
+  static base::OnceClosure Wrap(PostedTask posted, base::OnceClosure task);
+
+  // Returns the accounting of every site on every thread, the longest task
+  // first.
+  static std::vector<SiteSummary> GetSummaries();
+
+  // Writes the top offenders to |fd|.
+  static void Dump(int fd);
+
+  // Writes the recent tasks of every thread to |fd| in the JSON trace event
+  // format, which Perfetto and chrome://tracing can open.
+  static void ExportTrace(int fd);
+
+private:
+  static std::atomic<bool> enabled_;
+};
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/task_profiler.h"
+
+#include <base/functional/bind.h>
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <optional>
+#include <source_location>
+#include <string>
+#include <thread>
+
+using bluetooth::common::TaskProfiler;
+
+namespace {
+
+std::optional<TaskProfiler::SiteSummary> FindSummary(const std::string& site_name) {
+  for (const auto& summary : TaskProfiler::GetSummaries()) {
+    if (summary.site_name == site_name) {
+      return summary;
+    }
+  }
+  return std::nullopt;
+}
+
+void Sleep(std::chrono::milliseconds duration) { std::this_thread::sleep_for(duration); }
+
+}  // namespace
+
+TEST(TaskProfilerTest, records_queue_delay_and_run_time) {
+  base::Location from_here("records_queue_delay_and_run_time", "task_profiler_unittest.cc", 1,
+                           nullptr);
+  auto task = TaskProfiler::Wrap(TaskProfiler::OnPosted(from_here),
+                                 base::BindOnce(&Sleep, std::chrono::milliseconds(3)));
+  Sleep(std::chrono::milliseconds(2));
+  std::move(task).Run();
+
+  auto summary = FindSummary("records_queue_delay_and_run_time@task_profiler_unittest.cc:1");
+  ASSERT_TRUE(summary.has_value());
+  EXPECT_EQ(1u, summary->count);
+  EXPECT_GE(summary->queue_delay.max_ns, 2000000u);
+  EXPECT_GE(summary->run_time.max_ns, 3000000u);
+  EXPECT_GE(summary->run_time.total_ns, 3000000u);
+  EXPECT_LE(summary->run_time.p99_ns, summary->run_time.max_ns);
+}
+
+TEST(TaskProfilerTest, delayed_task_queues_from_its_deadline) {
+  base::Location from_here("delayed_task_queues_from_its_deadline", "task_profiler_unittest.cc",
+                           2, nullptr);
+  auto task = TaskProfiler::Wrap(TaskProfiler::OnPosted(from_here, std::chrono::milliseconds(100)),
+                                 base::BindOnce([] {}));
+  // Run before its deadline, as if the delay had been cut short.
+  std::move(task).Run();
+
+  auto summary = FindSummary("delayed_task_queues_from_its_deadline@task_profiler_unittest.cc:2");
+  ASSERT_TRUE(summary.has_value());
+  EXPECT_EQ(0u, summary->queue_delay.max_ns);
+}
+
+TEST(TaskProfilerTest, same_site_is_accounted_once_per_thread) {
+  base::Location from_here("same_site_is_accounted_once_per_thread", "task_profiler_unittest.cc",
+                           3, nullptr);
+  for (int i = 0; i < 10; i++) {
+    TaskProfiler::Wrap(TaskProfiler::OnPosted(from_here), base::BindOnce([] {})).Run();
+  }
+  std::thread thread([&from_here] {
+    pthread_setname_np(pthread_self(), "profiled_thread");
+    TaskProfiler::Wrap(TaskProfiler::OnPosted(from_here), base::BindOnce([] {})).Run();
+  });
+  thread.join();
+
+  int num_summaries = 0;
+  for (const auto& summary : TaskProfiler::GetSummaries()) {
+    if (summary.site_name !=
+        "same_site_is_accounted_once_per_thread@task_profiler_unittest.cc:3") {
+      continue;
+    }
+    num_summaries++;
+    EXPECT_EQ(summary.thread_name == "profiled_thread" ? 1u : 10u, summary.count);
+  }
+  EXPECT_EQ(2, num_summaries);
+}
+
+std::source_location PostingSite() { return std::source_location::current(); }
+
+TEST(TaskProfilerTest, source_location_sites) {
+  std::source_location first = std::source_location::current();
+  TaskProfiler::Wrap(TaskProfiler::OnPosted(first), base::BindOnce([] {})).Run();
+  for (int i = 0; i < 2; i++) {
+    TaskProfiler::Wrap(TaskProfiler::OnPosted(PostingSite()), base::BindOnce([] {})).Run();
+  }
+
+  auto site_name = [](const std::source_location& location) {
+    return std::string(location.function_name()) + "@" + location.file_name() + ":" +
+           std::to_string(location.line());
+  };
+  auto first_summary = FindSummary(site_name(first));
+  auto second_summary = FindSummary(site_name(PostingSite()));
+  ASSERT_TRUE(first_summary.has_value());
+  ASSERT_TRUE(second_summary.has_value());
+  EXPECT_EQ(1u, first_summary->count);
+  EXPECT_EQ(2u, second_summary->count);
+}
+
+TEST(TaskProfilerTest, export_trace) {
+  base::Location from_here("export_trace", "task_profiler_unittest.cc", 4, nullptr);
+  TaskProfiler::Wrap(TaskProfiler::OnPosted(from_here), base::BindOnce([] {})).Run();
+
+  FILE* file = tmpfile();
+  ASSERT_NE(nullptr, file);
+  TaskProfiler::ExportTrace(fileno(file));
+  std::string trace;
+  char buffer[4096];
+  rewind(file);
+  while (size_t size = fread(buffer, 1, sizeof(buffer), file)) {
+    trace.append(buffer, size);
+  }
+  fclose(file);
+
+  EXPECT_EQ(0u, trace.find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"thread_name\""));
+  EXPECT_NE(std::string::npos,
+            trace.find("{\"name\":\"export_trace@task_profiler_unittest.cc:4\",\"cat\":\"task\","
+                       "\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, trace.find("\"displayTimeUnit\":\"ms\"}"));
+}
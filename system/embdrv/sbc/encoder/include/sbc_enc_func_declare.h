@@ -35,12 +35,35 @@ extern const int32_t gas32CoeffFor4SBs[];
 extern const int32_t gas32CoeffFor8SBs[];
 #endif
 
+#if (SBC_ENC_SIMD == TRUE) && (SBC_IS_64_MULT_IN_WINDOW_ACCU == FALSE) && \
+        (SBC_ARM_ASM_OPT == FALSE)
+#define SBC_ENC_SIMD_WINDOW TRUE
+#else
+#define SBC_ENC_SIMD_WINDOW FALSE
+#endif
+
+#if (SBC_ENC_SIMD_WINDOW == TRUE)
+/* Window coefficients laid out as 5 rows of 2 * subbands columns, so that
+ * s32DCTY[k] = sum(row[j][k] * s16X[ChOffset + j * 2 * subbands + k]). */
+extern const int16_t gas16WindowCoeff4[5 * SUB_BANDS_4 * 2];
+extern const int16_t gas16WindowCoeff8[5 * SUB_BANDS_8 * 2];
+
+/* Computes the 2 * subbands windowed partial sums of the analysis filter from
+ * the channel history |ps16X| into |ps32Y|. */
+typedef void (*tSBC_WINDOW_KERNEL)(const int16_t* ps16X, int32_t* ps32Y);
+
+/* NULL when the C windowing is used. */
+extern tSBC_WINDOW_KERNEL SbcWindowKernel4;
+extern tSBC_WINDOW_KERNEL SbcWindowKernel8;
+#endif
+
 /* Global functions*/
 
 void sbc_enc_bit_alloc_mono(SBC_ENC_PARAMS* CodecParams);
 void sbc_enc_bit_alloc_ste(SBC_ENC_PARAMS* CodecParams);
 
 void SbcAnalysisInit(void);
+void SbcAnalysisSelectKernel(void);
 
 void SbcAnalysisFilter4(SBC_ENC_PARAMS* strEncParams, int16_t* input);
 void SbcAnalysisFilter8(SBC_ENC_PARAMS* strEncParams, int16_t* input);
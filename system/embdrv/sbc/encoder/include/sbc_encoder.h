@@ -142,6 +142,15 @@
 #define SBC_FAST_DCT TRUE
 #endif /*SBC_FAST_DCT */
 
+/* Set SBC_ENC_SIMD to FALSE to always use the portable C windowing in the
+ * analysis filter. When TRUE, a SIMD kernel (SSE2, AVX2 or NEON) is selected at
+ * runtime if the CPU supports one. The SIMD kernels are bit-exact with the C
+ * implementation and only apply to the 16 bit window coefficients.
+ */
+#ifndef SBC_ENC_SIMD
+#define SBC_ENC_SIMD TRUE
+#endif /* SBC_ENC_SIMD */
+
 /* In case we do not use joint stereo mode the flag save some RAM and ROM in
  * case it is set to FALSE */
 #ifndef SBC_JOINT_STE_INCLUDED
@@ -198,6 +207,19 @@ extern "C" {
 uint32_t SBC_Encode(SBC_ENC_PARAMS* strEncParams, int16_t* input, uint8_t* output);
 void SBC_Encoder_Init(SBC_ENC_PARAMS* strEncParams);
 
+/* Windowing kernels of the analysis filter. */
+#define SBC_ENC_KERNEL_C 0
+#define SBC_ENC_KERNEL_SSE2 1
+#define SBC_ENC_KERNEL_AVX2 2
+#define SBC_ENC_KERNEL_NEON 3
+
+/* Select the windowing kernel used by the analysis filter. By default the
+ * fastest kernel supported by the CPU is used. Return false if |kernel| is not
+ * available on this CPU, in which case the current kernel is kept. */
+bool SBC_Encoder_SetKernel(int kernel);
+/* Return the windowing kernel currently used by the analysis filter. */
+int SBC_Encoder_GetKernel(void);
+
 #ifdef __cplusplus
 }
 #endif
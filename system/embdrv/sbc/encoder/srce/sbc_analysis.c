@@ -162,6 +162,54 @@
 #define WIND_8_SUBBANDS_8_2 (int16_t)0x12CF /* 40 = 0x12CF6C75 */
 #endif
 
+#if (SBC_ENC_SIMD_WINDOW == TRUE)
+const int16_t gas16WindowCoeff4[5 * SUB_BANDS_4 * 2] = {
+        /* s16X[ChOffset + k] */
+        0, WIND_4_SUBBANDS_1_0, WIND_4_SUBBANDS_2_0, WIND_4_SUBBANDS_3_0, WIND_4_SUBBANDS_4_0,
+        WIND_4_SUBBANDS_3_4, WIND_4_SUBBANDS_2_4, WIND_4_SUBBANDS_1_4,
+        /* s16X[ChOffset + 8 + k] */
+        WIND_4_SUBBANDS_0_1, WIND_4_SUBBANDS_1_1, WIND_4_SUBBANDS_2_1, WIND_4_SUBBANDS_3_1,
+        WIND_4_SUBBANDS_4_1, WIND_4_SUBBANDS_3_3, WIND_4_SUBBANDS_2_3, WIND_4_SUBBANDS_1_3,
+        /* s16X[ChOffset + 16 + k] */
+        WIND_4_SUBBANDS_0_2, WIND_4_SUBBANDS_1_2, WIND_4_SUBBANDS_2_2, WIND_4_SUBBANDS_3_2,
+        WIND_4_SUBBANDS_4_2, WIND_4_SUBBANDS_3_2, WIND_4_SUBBANDS_2_2, WIND_4_SUBBANDS_1_2,
+        /* s16X[ChOffset + 24 + k] */
+        -WIND_4_SUBBANDS_0_2, WIND_4_SUBBANDS_1_3, WIND_4_SUBBANDS_2_3, WIND_4_SUBBANDS_3_3,
+        WIND_4_SUBBANDS_4_1, WIND_4_SUBBANDS_3_1, WIND_4_SUBBANDS_2_1, WIND_4_SUBBANDS_1_1,
+        /* s16X[ChOffset + 32 + k] */
+        -WIND_4_SUBBANDS_0_1, WIND_4_SUBBANDS_1_4, WIND_4_SUBBANDS_2_4, WIND_4_SUBBANDS_3_4,
+        WIND_4_SUBBANDS_4_0, WIND_4_SUBBANDS_3_0, WIND_4_SUBBANDS_2_0, WIND_4_SUBBANDS_1_0,
+};
+
+const int16_t gas16WindowCoeff8[5 * SUB_BANDS_8 * 2] = {
+        /* s16X[ChOffset + k] */
+        0, WIND_8_SUBBANDS_1_0, WIND_8_SUBBANDS_2_0, WIND_8_SUBBANDS_3_0, WIND_8_SUBBANDS_4_0,
+        WIND_8_SUBBANDS_5_0, WIND_8_SUBBANDS_6_0, WIND_8_SUBBANDS_7_0, WIND_8_SUBBANDS_8_0,
+        WIND_8_SUBBANDS_7_4, WIND_8_SUBBANDS_6_4, WIND_8_SUBBANDS_5_4, WIND_8_SUBBANDS_4_4,
+        WIND_8_SUBBANDS_3_4, WIND_8_SUBBANDS_2_4, WIND_8_SUBBANDS_1_4,
+        /* s16X[ChOffset + 16 + k] */
+        WIND_8_SUBBANDS_0_1, WIND_8_SUBBANDS_1_1, WIND_8_SUBBANDS_2_1, WIND_8_SUBBANDS_3_1,
+        WIND_8_SUBBANDS_4_1, WIND_8_SUBBANDS_5_1, WIND_8_SUBBANDS_6_1, WIND_8_SUBBANDS_7_1,
+        WIND_8_SUBBANDS_8_1, WIND_8_SUBBANDS_7_3, WIND_8_SUBBANDS_6_3, WIND_8_SUBBANDS_5_3,
+        WIND_8_SUBBANDS_4_3, WIND_8_SUBBANDS_3_3, WIND_8_SUBBANDS_2_3, WIND_8_SUBBANDS_1_3,
+        /* s16X[ChOffset + 32 + k] */
+        WIND_8_SUBBANDS_0_2, WIND_8_SUBBANDS_1_2, WIND_8_SUBBANDS_2_2, WIND_8_SUBBANDS_3_2,
+        WIND_8_SUBBANDS_4_2, WIND_8_SUBBANDS_5_2, WIND_8_SUBBANDS_6_2, WIND_8_SUBBANDS_7_2,
+        WIND_8_SUBBANDS_8_2, WIND_8_SUBBANDS_7_2, WIND_8_SUBBANDS_6_2, WIND_8_SUBBANDS_5_2,
+        WIND_8_SUBBANDS_4_2, WIND_8_SUBBANDS_3_2, WIND_8_SUBBANDS_2_2, WIND_8_SUBBANDS_1_2,
+        /* s16X[ChOffset + 48 + k] */
+        -WIND_8_SUBBANDS_0_2, WIND_8_SUBBANDS_1_3, WIND_8_SUBBANDS_2_3, WIND_8_SUBBANDS_3_3,
+        WIND_8_SUBBANDS_4_3, WIND_8_SUBBANDS_5_3, WIND_8_SUBBANDS_6_3, WIND_8_SUBBANDS_7_3,
+        WIND_8_SUBBANDS_8_1, WIND_8_SUBBANDS_7_1, WIND_8_SUBBANDS_6_1, WIND_8_SUBBANDS_5_1,
+        WIND_8_SUBBANDS_4_1, WIND_8_SUBBANDS_3_1, WIND_8_SUBBANDS_2_1, WIND_8_SUBBANDS_1_1,
+        /* s16X[ChOffset + 64 + k] */
+        -WIND_8_SUBBANDS_0_1, WIND_8_SUBBANDS_1_4, WIND_8_SUBBANDS_2_4, WIND_8_SUBBANDS_3_4,
+        WIND_8_SUBBANDS_4_4, WIND_8_SUBBANDS_5_4, WIND_8_SUBBANDS_6_4, WIND_8_SUBBANDS_7_4,
+        WIND_8_SUBBANDS_8_0, WIND_8_SUBBANDS_7_0, WIND_8_SUBBANDS_6_0, WIND_8_SUBBANDS_5_0,
+        WIND_8_SUBBANDS_4_0, WIND_8_SUBBANDS_3_0, WIND_8_SUBBANDS_2_0, WIND_8_SUBBANDS_1_0,
+};
+#endif
+
 #if (SBC_USE_ARM_PRAGMA == TRUE)
 #pragma arm section zidata = "sbc_s32_analysis_section"
 #endif
@@ -1040,7 +1088,12 @@ void SbcAnalysisFilter4(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
     for (s32Ch = 0; s32Ch < s32NumOfChannels; s32Ch++) {
       ChOffset = s32Ch * Offset2 + Offset;
 
-      WINDOW_PARTIAL_4
+#if (SBC_ENC_SIMD_WINDOW == TRUE)
+      if (SbcWindowKernel4 != NULL) {
+        SbcWindowKernel4(s16X + ChOffset, s32DCTY);
+      } else
+#endif
+        WINDOW_PARTIAL_4
 
       SBC_FastIDCT4(s32DCTY, ps32SbBuf);
 
@@ -1153,7 +1206,12 @@ void SbcAnalysisFilter8(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
     for (s32Ch = 0; s32Ch < s32NumOfChannels; s32Ch++) {
       ChOffset = s32Ch * Offset2 + Offset;
 
-      WINDOW_PARTIAL_8
+#if (SBC_ENC_SIMD_WINDOW == TRUE)
+      if (SbcWindowKernel8 != NULL) {
+        SbcWindowKernel8(s16X + ChOffset, s32DCTY);
+      } else
+#endif
+        WINDOW_PARTIAL_8
 
       SBC_FastIDCT8(s32DCTY, ps32SbBuf);
 
@@ -1178,6 +1236,7 @@ void SbcAnalysisFilter8(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
 }
 
 void SbcAnalysisInit(void) {
+  SbcAnalysisSelectKernel();
   memset(s16X, 0, ENC_VX_BUFFER_SIZE * sizeof(int16_t));
   ShiftCounter = 0;
 }
@@ -0,0 +1,298 @@
+/******************************************************************************
+ *
+ *  Copyright 2026 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  SIMD implementations of the windowing stage of the analysis filter, and
+ *  the runtime selection between them.
+ *
+ *  The C windowing accumulates 16x16 bit products in 32 bit registers, so the
+ *  kernels below compute the same sums with wrapping 32 bit vector adds and
+ *  are bit-exact with it.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+
+#include "sbc_enc_func_declare.h"
+#include "sbc_encoder.h"
+
+#if (SBC_ENC_SIMD_WINDOW == TRUE)
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SBC_ENC_HAS_AVX2
+#endif
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+tSBC_WINDOW_KERNEL SbcWindowKernel4 = NULL;
+tSBC_WINDOW_KERNEL SbcWindowKernel8 = NULL;
+
+static int s32Kernel = SBC_ENC_KERNEL_C;
+static bool bKernelSelected = false;
+
+#if defined(__SSE2__)
+/* Coefficient rows interleaved pairwise, {row[0][k], row[1][k]}, ...,
+ * {row[4][k], 0}, to feed _mm_madd_epi16 with interleaved sample rows. */
+static int16_t as16Coeff4Pairs[3 * SUB_BANDS_4 * 2 * 2] __attribute__((aligned(32)));
+static int16_t as16Coeff8Pairs[3 * SUB_BANDS_8 * 2 * 2] __attribute__((aligned(32)));
+
+static void SbcInterleaveCoeffs(const int16_t* ps16Coeff, int32_t s32Columns, int16_t* ps16Pairs) {
+  int32_t s32Pair, k;
+
+  for (s32Pair = 0; s32Pair < 3; s32Pair++) {
+    const int16_t* ps16Row = ps16Coeff + 2 * s32Pair * s32Columns;
+    for (k = 0; k < s32Columns; k++) {
+      *ps16Pairs++ = ps16Row[k];
+      *ps16Pairs++ = (s32Pair < 2) ? ps16Row[s32Columns + k] : 0;
+    }
+  }
+}
+
+static void SbcWindow4_SSE2(const int16_t* ps16X, int32_t* ps32Y) {
+  const __m128i* pCoeff = (const __m128i*)as16Coeff4Pairs;
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  int32_t s32Pair;
+
+  for (s32Pair = 0; s32Pair < 3; s32Pair++) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(ps16X + 16 * s32Pair));
+    __m128i b = (s32Pair < 2) ? _mm_loadu_si128((const __m128i*)(ps16X + 16 * s32Pair + 8))
+                              : _mm_setzero_si128();
+    acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), pCoeff[0]));
+    acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), pCoeff[1]));
+    pCoeff += 2;
+  }
+
+  _mm_storeu_si128((__m128i*)ps32Y, acc0);
+  _mm_storeu_si128((__m128i*)(ps32Y + 4), acc1);
+}
+
+static void SbcWindow8_SSE2(const int16_t* ps16X, int32_t* ps32Y) {
+  const __m128i* pCoeff = (const __m128i*)as16Coeff8Pairs;
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  __m128i acc2 = _mm_setzero_si128();
+  __m128i acc3 = _mm_setzero_si128();
+  int32_t s32Pair;
+
+  for (s32Pair = 0; s32Pair < 3; s32Pair++) {
+    const int16_t* ps16Row = ps16X + 32 * s32Pair;
+    __m128i a0 = _mm_loadu_si128((const __m128i*)ps16Row);
+    __m128i a1 = _mm_loadu_si128((const __m128i*)(ps16Row + 8));
+    __m128i b0 = _mm_setzero_si128();
+    __m128i b1 = _mm_setzero_si128();
+    if (s32Pair < 2) {
+      b0 = _mm_loadu_si128((const __m128i*)(ps16Row + 16));
+      b1 = _mm_loadu_si128((const __m128i*)(ps16Row + 24));
+    }
+    acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(a0, b0), pCoeff[0]));
+    acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(a0, b0), pCoeff[1]));
+    acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(a1, b1), pCoeff[2]));
+    acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(a1, b1), pCoeff[3]));
+    pCoeff += 4;
+  }
+
+  _mm_storeu_si128((__m128i*)ps32Y, acc0);
+  _mm_storeu_si128((__m128i*)(ps32Y + 4), acc1);
+  _mm_storeu_si128((__m128i*)(ps32Y + 8), acc2);
+  _mm_storeu_si128((__m128i*)(ps32Y + 12), acc3);
+}
+
+#if defined(SBC_ENC_HAS_AVX2)
+__attribute__((target("avx2"))) static void SbcWindow8_AVX2(const int16_t* ps16X,
+                                                             int32_t* ps32Y) {
+  const __m256i* pCoeff = (const __m256i*)as16Coeff8Pairs;
+  __m256i acc0 = _mm256_setzero_si256();
+  __m256i acc1 = _mm256_setzero_si256();
+  int32_t s32Pair;
+
+  for (s32Pair = 0; s32Pair < 3; s32Pair++) {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(ps16X + 32 * s32Pair));
+    __m256i b = (s32Pair < 2) ? _mm256_loadu_si256((const __m256i*)(ps16X + 32 * s32Pair + 16))
+                              : _mm256_setzero_si256();
+    /* unpack works within 128 bit lanes: lo holds columns 0-3 and 8-11, hi
+     * holds columns 4-7 and 12-15. */
+    __m256i lo = _mm256_unpacklo_epi16(a, b);
+    __m256i hi = _mm256_unpackhi_epi16(a, b);
+    acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_permute2x128_si256(lo, hi, 0x20),
+                                                     _mm256_load_si256(pCoeff)));
+    acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_permute2x128_si256(lo, hi, 0x31),
+                                                     _mm256_load_si256(pCoeff + 1)));
+    pCoeff += 2;
+  }
+
+  _mm256_storeu_si256((__m256i*)ps32Y, acc0);
+  _mm256_storeu_si256((__m256i*)(ps32Y + 8), acc1);
+}
+#endif /* SBC_ENC_HAS_AVX2 */
+#endif /* __SSE2__ */
+
+#if defined(__ARM_NEON)
+static void SbcWindow4_NEON(const int16_t* ps16X, int32_t* ps32Y) {
+  const int16_t* ps16Coeff = gas16WindowCoeff4;
+  int32x4_t acc0 = vdupq_n_s32(0);
+  int32x4_t acc1 = vdupq_n_s32(0);
+  int32_t s32Row;
+
+  for (s32Row = 0; s32Row < 5; s32Row++) {
+    acc0 = vmlal_s16(acc0, vld1_s16(ps16X), vld1_s16(ps16Coeff));
+    acc1 = vmlal_s16(acc1, vld1_s16(ps16X + 4), vld1_s16(ps16Coeff + 4));
+    ps16X += SUB_BANDS_4 * 2;
+    ps16Coeff += SUB_BANDS_4 * 2;
+  }
+
+  vst1q_s32(ps32Y, acc0);
+  vst1q_s32(ps32Y + 4, acc1);
+}
+
+static void SbcWindow8_NEON(const int16_t* ps16X, int32_t* ps32Y) {
+  const int16_t* ps16Coeff = gas16WindowCoeff8;
+  int32x4_t acc0 = vdupq_n_s32(0);
+  int32x4_t acc1 = vdupq_n_s32(0);
+  int32x4_t acc2 = vdupq_n_s32(0);
+  int32x4_t acc3 = vdupq_n_s32(0);
+  int32_t s32Row;
+
+  for (s32Row = 0; s32Row < 5; s32Row++) {
+    int16x8_t x0 = vld1q_s16(ps16X);
+    int16x8_t x1 = vld1q_s16(ps16X + 8);
+    int16x8_t c0 = vld1q_s16(ps16Coeff);
+    int16x8_t c1 = vld1q_s16(ps16Coeff + 8);
+    acc0 = vmlal_s16(acc0, vget_low_s16(x0), vget_low_s16(c0));
+    acc1 = vmlal_s16(acc1, vget_high_s16(x0), vget_high_s16(c0));
+    acc2 = vmlal_s16(acc2, vget_low_s16(x1), vget_low_s16(c1));
+    acc3 = vmlal_s16(acc3, vget_high_s16(x1), vget_high_s16(c1));
+    ps16X += SUB_BANDS_8 * 2;
+    ps16Coeff += SUB_BANDS_8 * 2;
+  }
+
+  vst1q_s32(ps32Y, acc0);
+  vst1q_s32(ps32Y + 4, acc1);
+  vst1q_s32(ps32Y + 8, acc2);
+  vst1q_s32(ps32Y + 12, acc3);
+}
+#endif /* __ARM_NEON */
+
+static bool SbcKernelSupported(int kernel) {
+  switch (kernel) {
+    case SBC_ENC_KERNEL_C:
+      return true;
+#if defined(__SSE2__)
+    case SBC_ENC_KERNEL_SSE2:
+      return true;
+#if defined(SBC_ENC_HAS_AVX2)
+    case SBC_ENC_KERNEL_AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+#endif
+#if defined(__ARM_NEON)
+    case SBC_ENC_KERNEL_NEON:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+bool SBC_Encoder_SetKernel(int kernel) {
+  if (!SbcKernelSupported(kernel)) {
+    return false;
+  }
+
+#if defined(__SSE2__)
+  if (kernel == SBC_ENC_KERNEL_SSE2 || kernel == SBC_ENC_KERNEL_AVX2) {
+    SbcInterleaveCoeffs(gas16WindowCoeff4, SUB_BANDS_4 * 2, as16Coeff4Pairs);
+    SbcInterleaveCoeffs(gas16WindowCoeff8, SUB_BANDS_8 * 2, as16Coeff8Pairs);
+  }
+#endif
+
+  switch (kernel) {
+#if defined(__SSE2__)
+    case SBC_ENC_KERNEL_SSE2:
+      SbcWindowKernel4 = SbcWindow4_SSE2;
+      SbcWindowKernel8 = SbcWindow8_SSE2;
+      break;
+#if defined(SBC_ENC_HAS_AVX2)
+    case SBC_ENC_KERNEL_AVX2:
+      /* The 4 subbands window is only 128 bits wide per pair of rows. */
+      SbcWindowKernel4 = SbcWindow4_SSE2;
+      SbcWindowKernel8 = SbcWindow8_AVX2;
+      break;
+#endif
+#endif
+#if defined(__ARM_NEON)
+    case SBC_ENC_KERNEL_NEON:
+      SbcWindowKernel4 = SbcWindow4_NEON;
+      SbcWindowKernel8 = SbcWindow8_NEON;
+      break;
+#endif
+    default:
+      SbcWindowKernel4 = NULL;
+      SbcWindowKernel8 = NULL;
+      break;
+  }
+
+  s32Kernel = kernel;
+  bKernelSelected = true;
+  return true;
+}
+
+int SBC_Encoder_GetKernel(void) { return s32Kernel; }
+
+/****************************************************************************
+ * SbcAnalysisSelectKernel - selects the fastest windowing kernel supported by
+ * the CPU, unless one was already chosen with SBC_Encoder_SetKernel().
+ *
+ * RETURNS : N/A
+ */
+void SbcAnalysisSelectKernel(void) {
+  static const int as32Preferred[] = {
+          SBC_ENC_KERNEL_AVX2,
+          SBC_ENC_KERNEL_NEON,
+          SBC_ENC_KERNEL_SSE2,
+          SBC_ENC_KERNEL_C,
+  };
+  size_t i;
+
+  if (bKernelSelected) {
+    return;
+  }
+
+  for (i = 0; i < sizeof(as32Preferred) / sizeof(as32Preferred[0]); i++) {
+    if (SBC_Encoder_SetKernel(as32Preferred[i])) {
+      return;
+    }
+  }
+}
+
+#else /* SBC_ENC_SIMD_WINDOW == FALSE */
+
+bool SBC_Encoder_SetKernel(int kernel) { return kernel == SBC_ENC_KERNEL_C; }
+
+int SBC_Encoder_GetKernel(void) { return SBC_ENC_KERNEL_C; }
+
+void SbcAnalysisSelectKernel(void) {}
+
+#endif /* SBC_ENC_SIMD_WINDOW */
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "embdrv/sbc/encoder/include/sbc_encoder.h"
+
+namespace {
+
+constexpr int kNumFrames = 200;
+
+struct SbcConfig {
+  int16_t subbands;
+  int16_t blocks;
+  int16_t channel_mode;
+};
+
+std::vector<SbcConfig> AllConfigs() {
+  std::vector<SbcConfig> configs;
+  for (int16_t subbands : {4, 8}) {
+    for (int16_t blocks : {4, 8, 12, 16}) {
+      for (int16_t mode : {SBC_MONO, SBC_DUAL, SBC_STEREO, SBC_JOINT_STEREO}) {
+        configs.push_back({subbands, blocks, mode});
+      }
+    }
+  }
+  return configs;
+}
+
+// Encodes kNumFrames of noise, tones and full scale square wave with |kernel|
+// and returns the concatenated bitstream.
+std::vector<uint8_t> Encode(int kernel, const SbcConfig& config) {
+  SBC_ENC_PARAMS params;
+  memset(&params, 0, sizeof(params));
+  params.s16SamplingFreq = SBC_sf44100;
+  params.s16ChannelMode = config.channel_mode;
+  params.s16NumOfSubBands = config.subbands;
+  params.s16NumOfChannels = (config.channel_mode == SBC_MONO) ? 1 : 2;
+  params.s16NumOfBlocks = config.blocks;
+  params.s16AllocationMethod = SBC_LOUDNESS;
+  params.s16BitPool = (config.channel_mode >= SBC_STEREO) ? 53 : 35;
+  params.Format = SBC_FORMAT_GENERAL;
+
+  EXPECT_TRUE(SBC_Encoder_SetKernel(kernel));
+  SBC_Encoder_Init(&params);
+
+  std::mt19937 rng(42);
+  std::vector<uint8_t> stream;
+  int16_t pcm[SBC_MAX_PCM_BUFFER_SIZE];
+  uint8_t frame[512];
+  int samples = params.s16NumOfChannels * params.s16NumOfSubBands * params.s16NumOfBlocks;
+  for (int f = 0; f < kNumFrames; f++) {
+    for (int i = 0; i < samples; i++) {
+      switch (f % 3) {
+        case 0:
+          pcm[i] = static_cast<int16_t>(rng());
+          break;
+        case 1:
+          pcm[i] = static_cast<int16_t>((i * 977 + f * 31) % 20000 - 10000);
+          break;
+        default:
+          pcm[i] = ((i + f) & 1) ? INT16_MAX : INT16_MIN;
+          break;
+      }
+    }
+    uint32_t len = SBC_Encode(&params, pcm, frame);
+    stream.insert(stream.end(), frame, frame + len);
+  }
+  return stream;
+}
+
+class SbcEncoderKernelTest : public ::testing::TestWithParam<int> {
+protected:
+  void SetUp() override {
+    if (!SBC_Encoder_SetKernel(GetParam())) {
+      GTEST_SKIP() << "Kernel " << GetParam() << " not supported on this CPU";
+    }
+  }
+
+  void TearDown() override { SBC_Encoder_SetKernel(SBC_ENC_KERNEL_C); }
+};
+
+TEST_P(SbcEncoderKernelTest, bit_exact_with_c_kernel) {
+  for (const SbcConfig& config : AllConfigs()) {
+    SCOPED_TRACE(testing::Message() << "subbands=" << config.subbands
+                                    << " blocks=" << config.blocks
+                                    << " mode=" << config.channel_mode);
+    std::vector<uint8_t> reference = Encode(SBC_ENC_KERNEL_C, config);
+    std::vector<uint8_t> output = Encode(GetParam(), config);
+    ASSERT_EQ(reference, output);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, SbcEncoderKernelTest,
+                         ::testing::Values(SBC_ENC_KERNEL_SSE2, SBC_ENC_KERNEL_AVX2,
+                                           SBC_ENC_KERNEL_NEON));
+
+TEST(SbcEncoderTest, unsupported_kernel_is_rejected) {
+  int kernel = SBC_Encoder_GetKernel();
+  ASSERT_FALSE(SBC_Encoder_SetKernel(-1));
+  ASSERT_EQ(kernel, SBC_Encoder_GetKernel());
+}
+
+}  // namespace
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <string.h>
+
+#include <cstdint>
+#include <random>
+
+#include "embdrv/sbc/encoder/include/sbc_encoder.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// Arguments: kernel, subbands, blocks, channel mode.
+void BM_SbcEncode(State& state) {
+  int kernel = static_cast<int>(state.range(0));
+  if (!SBC_Encoder_SetKernel(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+
+  SBC_ENC_PARAMS params;
+  memset(&params, 0, sizeof(params));
+  params.s16SamplingFreq = SBC_sf44100;
+  params.s16NumOfSubBands = static_cast<int16_t>(state.range(1));
+  params.s16NumOfBlocks = static_cast<int16_t>(state.range(2));
+  params.s16ChannelMode = static_cast<int16_t>(state.range(3));
+  params.s16NumOfChannels = (params.s16ChannelMode == SBC_MONO) ? 1 : 2;
+  params.s16AllocationMethod = SBC_LOUDNESS;
+  params.s16BitPool = (params.s16ChannelMode >= SBC_STEREO) ? 53 : 35;
+  params.Format = SBC_FORMAT_GENERAL;
+  SBC_Encoder_Init(&params);
+
+  int16_t pcm[SBC_MAX_PCM_BUFFER_SIZE];
+  std::mt19937 rng(0);
+  for (auto& sample : pcm) {
+    sample = static_cast<int16_t>(rng());
+  }
+
+  uint8_t frame[512];
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(SBC_Encode(&params, pcm, frame));
+  }
+
+  state.counters["frames/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+  SBC_Encoder_SetKernel(SBC_ENC_KERNEL_C);
+}
+
+void SbcConfigs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"kernel", "subbands", "blocks", "mode"});
+  for (int kernel : {SBC_ENC_KERNEL_C, SBC_ENC_KERNEL_SSE2, SBC_ENC_KERNEL_AVX2,
+                     SBC_ENC_KERNEL_NEON}) {
+    for (int subbands : {4, 8}) {
+      for (int blocks : {4, 8, 12, 16}) {
+        for (int mode : {SBC_MONO, SBC_STEREO, SBC_JOINT_STEREO}) {
+          b->Args({kernel, subbands, blocks, mode});
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_SbcEncode)->Apply(SbcConfigs);
+
+BENCHMARK_MAIN();
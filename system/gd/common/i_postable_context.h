@@ -18,13 +18,24 @@
 
 #include <base/functional/bind.h>
 
+#include <source_location>
+#include <utility>
+
 namespace bluetooth {
 namespace common {
 
 class IPostableContext {
 public:
   virtual ~IPostableContext() {}
-  virtual void Post(base::OnceClosure closure) = 0;
+
+  // |from_here| is where the task is posted from, for the task profiler.
+  void Post(base::OnceClosure closure,
+            const std::source_location& from_here = std::source_location::current()) {
+    PostTask(std::move(closure), from_here);
+  }
+
+protected:
+  virtual void PostTask(base::OnceClosure closure, const std::source_location& from_here) = 0;
 };
 
 }  // namespace common
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "crypto_toolbox/aes_cipher.h"
+
+#include <bluetooth/log.h>
+
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRYPTO_TOOLBOX_AES_NI
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define CRYPTO_TOOLBOX_ARMV8
+#endif
+#endif
+
+namespace crypto_toolbox {
+
+namespace {
+
+constexpr int kRounds = 10;
+
+// Blocks encrypted together by the hardware implementations, to hide the
+// latency of the round instructions.
+constexpr size_t kInterleave = 4;
+
+#if defined(CRYPTO_TOOLBOX_AES_NI)
+
+__attribute__((target("aes"))) void EncryptAesNi(const uint8_t* ksch, const uint8_t* in,
+                                                 uint8_t* out, size_t count) {
+  __m128i k[kRounds + 1];
+  for (int r = 0; r <= kRounds; r++) {
+    k[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ksch + r * Aes128::kBlockSize));
+  }
+
+  auto load = [](const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+  auto store = [](uint8_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); };
+
+  for (; count >= kInterleave; count -= kInterleave) {
+    __m128i b[kInterleave];
+    for (size_t i = 0; i < kInterleave; i++) {
+      b[i] = _mm_xor_si128(load(in + i * Aes128::kBlockSize), k[0]);
+    }
+    for (int r = 1; r < kRounds; r++) {
+      for (size_t i = 0; i < kInterleave; i++) {
+        b[i] = _mm_aesenc_si128(b[i], k[r]);
+      }
+    }
+    for (size_t i = 0; i < kInterleave; i++) {
+      store(out + i * Aes128::kBlockSize, _mm_aesenclast_si128(b[i], k[kRounds]));
+    }
+    in += kInterleave * Aes128::kBlockSize;
+    out += kInterleave * Aes128::kBlockSize;
+  }
+
+  for (; count > 0; count--) {
+    __m128i b = _mm_xor_si128(load(in), k[0]);
+    for (int r = 1; r < kRounds; r++) {
+      b = _mm_aesenc_si128(b, k[r]);
+    }
+    store(out, _mm_aesenclast_si128(b, k[kRounds]));
+    in += Aes128::kBlockSize;
+    out += Aes128::kBlockSize;
+  }
+}
+
+#endif
+
+#if defined(CRYPTO_TOOLBOX_ARMV8)
+
+// AESE combines the key addition, byte substitution and row shifting of a
+// round, and AESMC the column mixing: the last key is added alone.
+
+__attribute__((target("aes"))) void EncryptArmv8(const uint8_t* ksch, const uint8_t* in,
+                                                 uint8_t* out, size_t count) {
+  uint8x16_t k[kRounds + 1];
+  for (int r = 0; r <= kRounds; r++) {
+    k[r] = vld1q_u8(ksch + r * Aes128::kBlockSize);
+  }
+
+  for (; count >= kInterleave; count -= kInterleave) {
+    uint8x16_t b[kInterleave];
+    for (size_t i = 0; i < kInterleave; i++) {
+      b[i] = vld1q_u8(in + i * Aes128::kBlockSize);
+    }
+    for (int r = 0; r < kRounds - 1; r++) {
+      for (size_t i = 0; i < kInterleave; i++) {
+        b[i] = vaesmcq_u8(vaeseq_u8(b[i], k[r]));
+      }
+    }
+    for (size_t i = 0; i < kInterleave; i++) {
+      vst1q_u8(out + i * Aes128::kBlockSize,
+               veorq_u8(vaeseq_u8(b[i], k[kRounds - 1]), k[kRounds]));
+    }
+    in += kInterleave * Aes128::kBlockSize;
+    out += kInterleave * Aes128::kBlockSize;
+  }
+
+  for (; count > 0; count--) {
+    uint8x16_t b = vld1q_u8(in);
+    for (int r = 0; r < kRounds - 1; r++) {
+      b = vaesmcq_u8(vaeseq_u8(b, k[r]));
+    }
+    vst1q_u8(out, veorq_u8(vaeseq_u8(b, k[kRounds - 1]), k[kRounds]));
+    in += Aes128::kBlockSize;
+    out += Aes128::kBlockSize;
+  }
+}
+
+#endif
+
+}  // namespace
+
+bool Aes128::IsSupported(Implementation implementation) {
+  switch (implementation) {
+    case Implementation::kSoftware:
+      return true;
+    case Implementation::kAesNi:
+#if defined(CRYPTO_TOOLBOX_AES_NI)
+      return __builtin_cpu_supports("aes");
+#else
+      return false;
+#endif
+    case Implementation::kArmv8:
+#if defined(CRYPTO_TOOLBOX_ARMV8)
+      return (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+Aes128::Implementation Aes128::BestImplementation() {
+  static const Implementation best = [] {
+    for (auto implementation : {Implementation::kAesNi, Implementation::kArmv8}) {
+      if (IsSupported(implementation)) {
+        return implementation;
+      }
+    }
+    return Implementation::kSoftware;
+  }();
+  return best;
+}
+
+Aes128::Aes128(const uint8_t key[kBlockSize]) : Aes128(key, BestImplementation()) {}
+
+Aes128::Aes128(const uint8_t key[kBlockSize], Implementation implementation)
+    : implementation_(implementation) {
+  bluetooth::log::assert_that(IsSupported(implementation), "Unsupported AES implementation {}",
+                              static_cast<int>(implementation));
+
+  // The round keys are laid out in the byte order of the blocks, which the
+  // hardware implementations load as is.
+  aes_set_key(key, kBlockSize, &ctx_);
+}
+
+void Aes128::EncryptBlocks(const uint8_t* in, uint8_t* out, size_t count) const {
+  switch (implementation_) {
+#if defined(CRYPTO_TOOLBOX_AES_NI)
+    case Implementation::kAesNi:
+      EncryptAesNi(ctx_.ksch, in, out, count);
+      return;
+#endif
+#if defined(CRYPTO_TOOLBOX_ARMV8)
+    case Implementation::kArmv8:
+      EncryptArmv8(ctx_.ksch, in, out, count);
+      return;
+#endif
+    default:
+      for (size_t i = 0; i < count; i++) {
+        aes_encrypt(in + i * kBlockSize, out + i * kBlockSize, &ctx_);
+      }
+      return;
+  }
+}
+
+}  // namespace crypto_toolbox
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "crypto_toolbox/aes.h"
+
+namespace crypto_toolbox {
+
+// AES-128 encryption with a key schedule computed once, for the blocks
+// encrypted with the same key. Uses the AES instructions of the CPU when it
+// has them, and the byte oriented implementation of aes.cc otherwise.
+//
+// Keys and blocks are in the byte order of FIPS-197, as in aes.h.
+class Aes128 {
+public:
+  static constexpr size_t kBlockSize = 16;
+
+  enum class Implementation {
+    kSoftware,
+    kAesNi,  // x86 AES New Instructions
+    kArmv8,  // ARMv8 Cryptography Extension
+  };
+
+  // Uses the fastest implementation the CPU supports.
+  explicit Aes128(const uint8_t key[kBlockSize]);
+
+  // Uses the given implementation, which must be supported.
+  Aes128(const uint8_t key[kBlockSize], Implementation implementation);
+
+  void Encrypt(const uint8_t in[kBlockSize], uint8_t out[kBlockSize]) const {
+    EncryptBlocks(in, out, 1);
+  }
+
+  // Encrypts `count` independent blocks, which the hardware implementations
+  // pipeline. `in` and `out` can be the same buffer.
+  void EncryptBlocks(const uint8_t* in, uint8_t* out, size_t count) const;
+
+  Implementation implementation() const { return implementation_; }
+
+  static bool IsSupported(Implementation implementation);
+  static Implementation BestImplementation();
+
+private:
+  Implementation implementation_;
+  aes_context ctx_;
+};
+
+}  // namespace crypto_toolbox
@@ -22,13 +22,14 @@
  *
  ******************************************************************************/
 
-#include <bluetooth/log.h>
+#include "crypto_toolbox/aes_cmac.h"
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 
-#include "aes.h"
-#include "crypto_toolbox.h"
+#include "crypto_toolbox/aes_cipher.h"
+#include "crypto_toolbox/crypto_toolbox.h"
 #include "hci/octets.h"
 
 using bluetooth::hci::kOctet16Length;
@@ -38,138 +39,146 @@ namespace crypto_toolbox {
 
 namespace {
 
-typedef struct {
-  uint8_t* text;
-  uint16_t len;
-  uint16_t round;
-} tCMAC_CB;
+/* Rb for AES-128 as block cipher, in the byte order of the cipher */
+constexpr uint8_t kRb = 0x87;
 
-thread_local tCMAC_CB cmac_cb;
+/* Messages of a batch signed together */
+constexpr size_t kBatchSize = 4;
 
-/* Rb for AES-128 as block cipher, LSB as [0] */
-Octet16 const_Rb{0x87, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-
-/** utility function to do an biteise exclusive-OR of two bit strings of the
- * length of kOctet16Length. Result is stored in first argument.
- */
-static void xor_128(Octet16* a, const Octet16& b) {
-  uint8_t i, *aa = a->data();
-  const uint8_t* bb = b.data();
+Octet16 reversed(const Octet16& x) {
+  Octet16 y;
+  std::reverse_copy(x.begin(), x.end(), y.begin());
+  return y;
+}
 
-  for (i = 0; i < kOctet16Length; i++) {
-    aa[i] = aa[i] ^ bb[i];
+/** utility function to left shift one bit a 128 bits value, in the byte
+ * order of the cipher, and reduce it by Rb on overflow. */
+void double_128(const uint8_t* input, uint8_t* output) {
+  uint8_t overflow = input[0] >> 7;
+  for (size_t i = 0; i < kOctet16Length - 1; i++) {
+    output[i] = (input[i] << 1) | (input[i + 1] >> 7);
   }
+  output[kOctet16Length - 1] = (input[kOctet16Length - 1] << 1) ^ (overflow ? kRb : 0);
+}
+
+size_t num_blocks(uint16_t length) {
+  return std::max<size_t>(1, (length + kOctet16Length - 1) / kOctet16Length);
 }
+
 }  // namespace
 
 /* This function computes AES_128(key, message) */
 Octet16 aes_128(const Octet16& key, const Octet16& message) {
-  Octet16 key_reversed;
-  Octet16 message_reversed;
-  Octet16 output;
-
-  std::reverse_copy(key.begin(), key.end(), key_reversed.begin());
-  std::reverse_copy(message.begin(), message.end(), message_reversed.begin());
+  Octet16 key_reversed = reversed(key);
+  Octet16 output = reversed(message);
 
-  aes_context ctx;
-  aes_set_key(key_reversed.data(), key_reversed.size(), &ctx);
-  aes_encrypt(message_reversed.data(), output.data(), &ctx);
+  Aes128(key_reversed.data()).Encrypt(output.data(), output.data());
 
   std::reverse(output.begin(), output.end());
   return output;
 }
 
-/** utility function to padding the given text to be a 128 bits data. The
- * parameter dest is input and output parameter, it must point to a
- * kOctet16Length memory space; where include length bytes valid data. */
-static void padding(Octet16* dest, uint8_t length) {
-  uint8_t i, *p = dest->data();
-  /* original last block */
-  for (i = length; i < kOctet16Length; i++) {
-    p[kOctet16Length - i - 1] = (i == length) ? 0x80 : 0;
-  }
-}
+AesCmac::AesCmac(const Octet16& key) : aes_(reversed(key).data()) { GenerateSubkeys(); }
 
-/** utility function to left shift one bit for a 128 bits value. */
-static void leftshift_onebit(uint8_t* input, uint8_t* output) {
-  uint8_t i, overflow = 0, next_overflow = 0;
-  /* input[0] is LSB */
-  for (i = 0; i < kOctet16Length; i++) {
-    next_overflow = (input[i] & 0x80) ? 1 : 0;
-    output[i] = (input[i] << 1) | overflow;
-    overflow = next_overflow;
-  }
-  return;
+AesCmac::AesCmac(const Octet16& key, Aes128::Implementation implementation)
+    : aes_(reversed(key).data(), implementation) {
+  GenerateSubkeys();
 }
 
-/** This function is the calculation of block cipher using AES-128. */
-static Octet16 cmac_aes_k_calculate(const Octet16& key) {
-  Octet16 output;
-  Octet16 x{0};  // zero initialized
-
-  uint16_t i = 1;
-  while (i <= cmac_cb.round) {
-    /* Mi' := Mi (+) X  */
-    xor_128((Octet16*)&cmac_cb.text[(cmac_cb.round - i) * kOctet16Length], x);
-
-    output = aes_128(key, *(Octet16*)&cmac_cb.text[(cmac_cb.round - i) * kOctet16Length]);
-    x = output;
-    i++;
-  }
+/** This is the function to generate the two subkeys.
+ * K1 = L << 1, reduced by Rb, with L = AES_128(key, 0), and K2 = K1 << 1
+ * reduced by Rb.
+ */
+void AesCmac::GenerateSubkeys() {
+  uint8_t l[Aes128::kBlockSize] = {0};
+  aes_.Encrypt(l, l);
 
-  return output;
+  double_128(l, k1_);
+  double_128(k1_, k2_);
 }
 
-/** This function proceeed to prepare the last block of message Mn depending on
- * the size of the message.
+/** The message is given in little endian order: the block `index` of the
+ * message in the order of the cipher starts from its last byte.
  */
-static void cmac_prepare_last_block(const Octet16& k1, const Octet16& k2) {
-  //    uint8_t     x[16] = {0};
-  bool flag;
+void AesCmac::LoadBlock(const Message& message, size_t index, uint8_t* block) const {
+  size_t offset = index * kOctet16Length;
+  size_t remaining = offset < message.length ? message.length - offset : 0;
+  size_t length = std::min<size_t>(kOctet16Length, remaining);
 
-  /* last block is a complete block set flag to 1 */
-  flag = ((cmac_cb.len % kOctet16Length) == 0 && cmac_cb.len != 0) ? true : false;
-
-  if (flag) { /* last block is complete block */
-    xor_128((Octet16*)&cmac_cb.text[0], k1);
-  } else /* padding then xor with k2 */
-  {
-    padding((Octet16*)&cmac_cb.text[0], (uint8_t)(cmac_cb.len % 16));
+  for (size_t i = 0; i < length; i++) {
+    block[i] = message.data[message.length - 1 - offset - i];
+  }
 
-    xor_128((Octet16*)&cmac_cb.text[0], k2);
+  if (index + 1 < num_blocks(message.length)) {
+    return;
   }
-}
 
-/** This is the function to generate the two subkeys.
- * |key| is CMAC key, expect SRK when used by SMP.
- */
-static void cmac_generate_subkey(const Octet16& key) {
-  Octet16 zero{};
-  Octet16 p = aes_128(key, zero);
-
-  Octet16 k1, k2;
-  uint8_t* pp = p.data();
-
-  /* If MSB(L) = 0, then K1 = L << 1 */
-  if ((pp[kOctet16Length - 1] & 0x80) != 0) {
-    /* Else K1 = ( L << 1 ) (+) Rb */
-    leftshift_onebit(pp, k1.data());
-    xor_128(&k1, const_Rb);
-  } else {
-    leftshift_onebit(pp, k1.data());
+  /* last block is a complete block: xor with k1, else padding then xor with
+   * k2 */
+  const uint8_t* subkey = k1_;
+  if (length < kOctet16Length) {
+    block[length] = 0x80;
+    std::fill(block + length + 1, block + kOctet16Length, 0);
+    subkey = k2_;
   }
 
-  if ((k1[kOctet16Length - 1] & 0x80) != 0) {
-    /* K2 =  (K1 << 1) (+) Rb */
-    leftshift_onebit(k1.data(), k2.data());
-    xor_128(&k2, const_Rb);
-  } else {
-    /* If MSB(K1) = 0, then K2 = K1 << 1 */
-    leftshift_onebit(k1.data(), k2.data());
+  for (size_t i = 0; i < kOctet16Length; i++) {
+    block[i] ^= subkey[i];
   }
+}
 
-  cmac_prepare_last_block(k1, k2);
+Octet16 AesCmac::Sign(const uint8_t* message, uint16_t length) const {
+  Message m = {message, length};
+  Octet16 signature;
+  SignBatch(&m, 1, &signature);
+  return signature;
+}
+
+void AesCmac::SignBatch(const Message* messages, size_t count, Octet16* signatures) const {
+  for (; count > 0;) {
+    size_t batch = std::min(count, kBatchSize);
+
+    /* The chaining values of the messages, and the blocks to encrypt of the
+     * messages not finished yet */
+    uint8_t x[kBatchSize][kOctet16Length] = {};
+    uint8_t blocks[kBatchSize][kOctet16Length];
+    size_t active[kBatchSize];
+
+    size_t rounds = 0;
+    for (size_t i = 0; i < batch; i++) {
+      rounds = std::max(rounds, num_blocks(messages[i].length));
+    }
+
+    for (size_t round = 0; round < rounds; round++) {
+      /* Mi' := Mi (+) X  */
+      size_t num_active = 0;
+      for (size_t i = 0; i < batch; i++) {
+        if (round >= num_blocks(messages[i].length)) {
+          continue;
+        }
+        uint8_t* block = blocks[num_active];
+        LoadBlock(messages[i], round, block);
+        for (size_t j = 0; j < kOctet16Length; j++) {
+          block[j] ^= x[i][j];
+        }
+        active[num_active++] = i;
+      }
+
+      aes_.EncryptBlocks(blocks[0], blocks[0], num_active);
+
+      for (size_t k = 0; k < num_active; k++) {
+        memcpy(x[active[k]], blocks[k], kOctet16Length);
+      }
+    }
+
+    for (size_t i = 0; i < batch; i++) {
+      std::reverse_copy(x[i], x[i] + kOctet16Length, signatures[i].begin());
+    }
+
+    messages += batch;
+    signatures += batch;
+    count -= batch;
+  }
 }
 
 /** key - CMAC key in little endian order
@@ -177,40 +186,7 @@ static void cmac_generate_subkey(const Octet16& key) {
  *  length - length of the input in byte.
  */
 Octet16 aes_cmac(const Octet16& key, const uint8_t* input, uint16_t length) {
-  uint32_t len;
-  uint16_t diff;
-  /* n is number of rounds */
-  uint16_t n = (length + kOctet16Length - 1) / kOctet16Length;
-
-  if (n == 0) {
-    n = 1;
-  }
-  len = n * kOctet16Length;
-
-  // log::verbose("AES128_CMAC started, allocate buffer size={}", len);
-
-  /* allocate a memory space of multiple of 16 bytes to hold text  */
-  cmac_cb.text = (uint8_t*)alloca(len);
-  cmac_cb.round = n;
-  diff = len - length;
-
-  if (input != NULL && length > 0) {
-    memcpy(&cmac_cb.text[diff], input, (int)length);
-    cmac_cb.len = length;
-  } else {
-    cmac_cb.len = 0;
-  }
-
-  /* prepare calculation for subkey s and last block of data */
-  cmac_generate_subkey(key);
-  /* start calculation */
-  Octet16 signature = cmac_aes_k_calculate(key);
-
-  /* clean up */
-  memset(&cmac_cb, 0, sizeof(tCMAC_CB));
-  // cmac_cb.text is auto-freed by alloca
-
-  return signature;
+  return AesCmac(key).Sign(input, length);
 }
 
 }  // namespace crypto_toolbox
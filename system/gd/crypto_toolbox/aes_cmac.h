@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "crypto_toolbox/aes_cipher.h"
+#include "hci/octets.h"
+
+namespace crypto_toolbox {
+
+// AES-CMAC with a key whose schedule and subkeys are computed once, for the
+// messages signed or verified with the same key, as the signed writes of a
+// peer are with its CSRK.
+//
+// Keys, messages and signatures are in little endian byte order, as with
+// aes_cmac() of crypto_toolbox.h.
+class AesCmac {
+public:
+  struct Message {
+    const uint8_t* data;
+    uint16_t length;
+  };
+
+  explicit AesCmac(const bluetooth::hci::Octet16& key);
+  AesCmac(const bluetooth::hci::Octet16& key, Aes128::Implementation implementation);
+
+  bluetooth::hci::Octet16 Sign(const uint8_t* message, uint16_t length) const;
+
+  // Signs `count` messages into `signatures`. The messages are processed
+  // together, which lets the hardware implementations of AES pipeline them.
+  void SignBatch(const Message* messages, size_t count,
+                 bluetooth::hci::Octet16* signatures) const;
+
+private:
+  void GenerateSubkeys();
+
+  // Loads in `block` the `index`-th block of `message`, in the byte order
+  // of the cipher, padded and masked with a subkey when it is the last one.
+  void LoadBlock(const Message& message, size_t index, uint8_t* block) const;
+
+  Aes128 aes_;
+  uint8_t k1_[Aes128::kBlockSize];
+  uint8_t k2_[Aes128::kBlockSize];
+};
+
+}  // namespace crypto_toolbox
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "crypto_toolbox/aes_cipher.h"
+#include "crypto_toolbox/aes_cmac.h"
+#include "crypto_toolbox/crypto_toolbox.h"
+#include "hci/octets.h"
+
+using ::benchmark::State;
+using bluetooth::hci::Octet16;
+
+namespace crypto_toolbox {
+namespace {
+
+const Octet16 kKey{0x3c, 0x4f, 0xcf, 0x09, 0x88, 0x15, 0xf7, 0xab,
+                   0xa6, 0xd2, 0xae, 0x28, 0x16, 0x15, 0x7e, 0x2b};
+
+// Size of a signed write of the default ATT MTU: 12 bytes of data, with the
+// opcode, the handle and the sign counter.
+constexpr uint16_t kSignedWriteLength = 19;
+
+// The benchmarks taking an implementation as argument skip it when the CPU
+// does not support it.
+bool SkipUnsupported(State& state, Aes128::Implementation* implementation) {
+  *implementation = static_cast<Aes128::Implementation>(state.range(0));
+  if (!Aes128::IsSupported(*implementation)) {
+    state.SkipWithError("AES implementation not supported by the CPU");
+    return true;
+  }
+  return false;
+}
+
+void ImplementationArguments(::benchmark::internal::Benchmark* b) {
+  b->ArgName("implementation");
+  for (auto implementation : {Aes128::Implementation::kSoftware, Aes128::Implementation::kAesNi,
+                              Aes128::Implementation::kArmv8}) {
+    b->Arg(static_cast<int64_t>(implementation));
+  }
+}
+
+void BM_Aes128Encrypt(State& state) {
+  Aes128::Implementation implementation;
+  if (SkipUnsupported(state, &implementation)) {
+    return;
+  }
+
+  Aes128 aes(kKey.data(), implementation);
+  std::array<uint8_t, Aes128::kBlockSize> block{};
+  for (auto _ : state) {
+    aes.Encrypt(block.data(), block.data());
+    benchmark::DoNotOptimize(block);
+  }
+  state.SetBytesProcessed(state.iterations() * block.size());
+}
+BENCHMARK(BM_Aes128Encrypt)->Apply(ImplementationArguments);
+
+// Key schedule and encryption of a single block, as aes_128() does for the
+// resolution of a private address.
+void BM_Aes128KeyAndEncrypt(State& state) {
+  Aes128::Implementation implementation;
+  if (SkipUnsupported(state, &implementation)) {
+    return;
+  }
+
+  std::array<uint8_t, Aes128::kBlockSize> block{};
+  for (auto _ : state) {
+    Aes128(kKey.data(), implementation).Encrypt(block.data(), block.data());
+    benchmark::DoNotOptimize(block);
+  }
+}
+BENCHMARK(BM_Aes128KeyAndEncrypt)->Apply(ImplementationArguments);
+
+// aes_cmac(), which computes the key schedule and the subkeys on each call.
+void BM_AesCmac(State& state) {
+  std::vector<uint8_t> message(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(aes_cmac(kKey, message.data(), message.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * message.size());
+}
+BENCHMARK(BM_AesCmac)->Arg(kSignedWriteLength)->Arg(65)->Arg(512);
+
+// An AesCmac context reused across the messages.
+void BM_AesCmacContext(State& state) {
+  Aes128::Implementation implementation;
+  if (SkipUnsupported(state, &implementation)) {
+    return;
+  }
+
+  AesCmac cmac(kKey, implementation);
+  std::vector<uint8_t> message(state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cmac.Sign(message.data(), message.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * message.size());
+}
+BENCHMARK(BM_AesCmacContext)
+        ->ArgNames({"implementation", "length"})
+        ->ArgsProduct({{static_cast<int64_t>(Aes128::Implementation::kSoftware),
+                        static_cast<int64_t>(Aes128::Implementation::kAesNi),
+                        static_cast<int64_t>(Aes128::Implementation::kArmv8)},
+                       {kSignedWriteLength, 65, 512}});
+
+// Verification of a batch of signed writes of a peer.
+void BM_AesCmacSignBatch(State& state) {
+  Aes128::Implementation implementation;
+  if (SkipUnsupported(state, &implementation)) {
+    return;
+  }
+
+  AesCmac cmac(kKey, implementation);
+  std::vector<std::array<uint8_t, kSignedWriteLength>> writes(state.range(1));
+  std::vector<AesCmac::Message> messages;
+  for (auto& write : writes) {
+    messages.push_back({write.data(), kSignedWriteLength});
+  }
+  std::vector<Octet16> signatures(messages.size());
+
+  for (auto _ : state) {
+    cmac.SignBatch(messages.data(), messages.size(), signatures.data());
+    benchmark::DoNotOptimize(signatures.data());
+  }
+  state.SetItemsProcessed(state.iterations() * messages.size());
+}
+BENCHMARK(BM_AesCmacSignBatch)
+        ->ArgNames({"implementation", "messages"})
+        ->ArgsProduct({{static_cast<int64_t>(Aes128::Implementation::kSoftware),
+                        static_cast<int64_t>(Aes128::Implementation::kAesNi),
+                        static_cast<int64_t>(Aes128::Implementation::kArmv8)},
+                       {1, 16}});
+
+}  // namespace
+}  // namespace crypto_toolbox
+
+BENCHMARK_MAIN();
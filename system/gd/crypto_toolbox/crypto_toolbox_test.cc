@@ -21,9 +21,12 @@
 #include <bluetooth/log.h>
 #include <gtest/gtest.h>
 
+#include <random>
 #include <vector>
 
 #include "crypto_toolbox/aes.h"
+#include "crypto_toolbox/aes_cipher.h"
+#include "crypto_toolbox/aes_cmac.h"
 #include "hci/octets.h"
 
 namespace crypto_toolbox {
@@ -387,4 +390,130 @@ TEST(CryptoToolboxTest, bt_spec_example_d_12_test) {
   EXPECT_EQ(expected_ltk, ltk);
 }
 
+class CryptoToolboxImplementationTest : public ::testing::TestWithParam<Aes128::Implementation> {
+protected:
+  void SetUp() override {
+    if (!Aes128::IsSupported(GetParam())) {
+      GTEST_SKIP() << "AES implementation not supported by the CPU";
+    }
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(CryptoToolboxTest, CryptoToolboxImplementationTest,
+                         ::testing::Values(Aes128::Implementation::kSoftware,
+                                           Aes128::Implementation::kAesNi,
+                                           Aes128::Implementation::kArmv8));
+
+TEST_P(CryptoToolboxImplementationTest, aes_128_matches_software) {
+  std::mt19937 gen(0);
+  std::vector<uint8_t> key(Aes128::kBlockSize);
+
+  // Odd counts, to cover the blocks encrypted one at a time after the
+  // interleaved ones.
+  for (size_t count : {1, 2, 3, 4, 5, 8, 9, 31}) {
+    std::vector<uint8_t> in(count * Aes128::kBlockSize);
+    for (auto& b : key) {
+      b = gen();
+    }
+    for (auto& b : in) {
+      b = gen();
+    }
+
+    std::vector<uint8_t> expected(in.size());
+    Aes128(key.data(), Aes128::Implementation::kSoftware)
+            .EncryptBlocks(in.data(), expected.data(), count);
+
+    std::vector<uint8_t> output(in.size());
+    Aes128 aes(key.data(), GetParam());
+    aes.EncryptBlocks(in.data(), output.data(), count);
+    EXPECT_EQ(expected, output);
+
+    aes.EncryptBlocks(in.data(), in.data(), count);
+    EXPECT_EQ(expected, in);
+  }
+}
+
+// BT Spec 5.0 | Vol 3, Part H D.1.1 - D.1.4
+TEST_P(CryptoToolboxImplementationTest, aes_cmac_bt_spec_examples_d_1) {
+  Octet16 k{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+            0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+
+  uint8_t m[] = {0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73,
+                 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7,
+                 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4,
+                 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef, 0xf6, 0x9f, 0x24, 0x45,
+                 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10};
+
+  std::vector<std::pair<uint16_t, Octet16>> examples = {
+          {0,
+           {0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75,
+            0x67, 0x46}},
+          {16,
+           {0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a,
+            0x28, 0x7c}},
+          {40,
+           {0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97,
+            0xc8, 0x27}},
+          {64,
+           {0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36,
+            0x3c, 0xfe}},
+  };
+
+  // algorithm expect all input to be in little endian format, so reverse
+  std::reverse(std::begin(k), std::end(k));
+  AesCmac cmac(k, GetParam());
+
+  std::vector<std::vector<uint8_t>> messages;
+  std::vector<AesCmac::Message> batch;
+  std::vector<Octet16> expected;
+  for (auto& [length, aes_cmac_k_m] : examples) {
+    messages.emplace_back(m, m + length);
+    std::reverse(messages.back().begin(), messages.back().end());
+    std::reverse(std::begin(aes_cmac_k_m), std::end(aes_cmac_k_m));
+    expected.push_back(aes_cmac_k_m);
+
+    EXPECT_EQ(aes_cmac_k_m, cmac.Sign(messages.back().data(), length));
+  }
+
+  for (auto& message : messages) {
+    batch.push_back({message.data(), static_cast<uint16_t>(message.size())});
+  }
+  std::vector<Octet16> signatures(batch.size());
+  cmac.SignBatch(batch.data(), batch.size(), signatures.data());
+  EXPECT_EQ(expected, signatures);
+}
+
+TEST_P(CryptoToolboxImplementationTest, aes_cmac_batch_matches_single_messages) {
+  std::mt19937 gen(0);
+  Octet16 key;
+  for (auto& b : key) {
+    b = gen();
+  }
+
+  // Messages of all the lengths around the block boundaries, signed in
+  // batches of various sizes.
+  std::vector<std::vector<uint8_t>> messages;
+  for (size_t length = 0; length <= 70; length++) {
+    std::vector<uint8_t> message(length);
+    for (auto& b : message) {
+      b = gen();
+    }
+    messages.push_back(message);
+  }
+
+  std::vector<AesCmac::Message> batch;
+  std::vector<Octet16> expected;
+  for (auto& message : messages) {
+    batch.push_back({message.data(), static_cast<uint16_t>(message.size())});
+    expected.push_back(aes_cmac(key, message.data(), message.size()));
+  }
+
+  AesCmac cmac(key, GetParam());
+  for (size_t count : {1, 3, 4, 7, 71}) {
+    std::vector<Octet16> signatures(count);
+    cmac.SignBatch(batch.data() + batch.size() - count, count, signatures.data());
+    EXPECT_TRUE(std::equal(signatures.begin(), signatures.end(), expected.end() - count));
+  }
+}
+
 }  // namespace crypto_toolbox
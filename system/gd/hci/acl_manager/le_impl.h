@@ -661,6 +661,12 @@ public:
   void direct_connect_add(AddressWithType address_with_type) {
     log::debug("{}", address_with_type);
     direct_connections_.insert(address_with_type);
+    // A device of a background connection already is in the accept list with a lower priority
+    if (is_device_in_accept_list(address_with_type)) {
+      le_address_manager_->SetFilterAcceptListPriority(
+              address_with_type.ToFilterAcceptListAddressType(), address_with_type.GetAddress(),
+              FilterListPriority::DIRECT);
+    }
     if (create_connection_timeout_alarms_.find(address_with_type) !=
         create_connection_timeout_alarms_.end()) {
       log::verbose("Timer already added for {}", address_with_type);
@@ -687,10 +693,16 @@ public:
       it->second.Cancel();
       create_connection_timeout_alarms_.erase(it);
     }
-    direct_connections_.erase(address_with_type);
+    if (direct_connections_.erase(address_with_type) > 0 &&
+        is_device_in_accept_list(address_with_type)) {
+      le_address_manager_->SetFilterAcceptListPriority(
+              address_with_type.ToFilterAcceptListAddressType(), address_with_type.GetAddress(),
+              FilterListPriority::BACKGROUND);
+    }
   }
 
-  void add_device_to_accept_list(AddressWithType address_with_type) {
+  void add_device_to_accept_list(AddressWithType address_with_type,
+                                 FilterListPriority priority = FilterListPriority::BACKGROUND) {
     if (connections.alreadyConnected(address_with_type)) {
       log::info("Device already connected, return");
       return;
@@ -705,7 +717,8 @@ public:
     accept_list.insert(address_with_type);
     register_with_address_manager();
     le_address_manager_->AddDeviceToFilterAcceptList(
-            address_with_type.ToFilterAcceptListAddressType(), address_with_type.GetAddress());
+            address_with_type.ToFilterAcceptListAddressType(), address_with_type.GetAddress(),
+            priority);
   }
 
   bool is_device_in_accept_list(AddressWithType address_with_type) {
@@ -951,7 +964,8 @@ public:
     // TODO: Configure default LE connection parameters?
     if (add_to_accept_list) {
       if (!already_in_accept_list) {
-        add_device_to_accept_list(address_with_type);
+        add_device_to_accept_list(address_with_type, is_direct ? FilterListPriority::DIRECT
+                                                               : FilterListPriority::BACKGROUND);
       }
 
       if (com::android::bluetooth::flags::
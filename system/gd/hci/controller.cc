@@ -20,10 +20,12 @@
 #include <bluetooth/log.h>
 #include <com_android_bluetooth_flags.h>
 
+#include <chrono>
 #include <future>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "dumpsys_data_generated.h"
 #include "hci/controller_interface.h"
@@ -63,86 +65,164 @@ struct Controller::impl {
     hci_->RegisterEventHandler(EventCode::NUMBER_OF_COMPLETED_PACKETS,
                                handler->BindOn(this, &Controller::impl::NumberOfCompletedPackets));
 
-    set_event_mask(kDefaultEventMask);
-    if (com::android::bluetooth::flags::encryption_change_v2()) {
-      set_event_mask_page_2(kDefaultEventMaskPage2);
+    // The startup commands are sent from the handler, phase after phase. Only
+    // wait for the last phase, so that every property is known once started.
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    handler->CallOn(this, &Controller::impl::start_startup, std::move(promise));
+    future.wait();
+  }
+
+  void start_startup(std::promise<void> promise) {
+    startup_promise_ = std::move(promise);
+    start_next_startup_phase();
+  }
+
+  void start_next_startup_phase() {
+    switch (startup_phases_.size()) {
+      case 0:
+        run_startup_phase("local_features", &Controller::impl::send_local_features_commands);
+        break;
+      case 1:
+        run_startup_phase("capabilities", &Controller::impl::send_capabilities_commands);
+        break;
+      default:
+        startup_promise_.set_value();
+        break;
     }
+  }
 
-    write_le_host_support(Enable::ENABLED, Enable::DISABLED);
-    hci_->EnqueueCommand(
-            ReadLocalNameBuilder::Create(),
-            handler->BindOnceOn(this, &Controller::impl::read_local_name_complete_handler));
-    hci_->EnqueueCommand(
-            ReadLocalVersionInformationBuilder::Create(),
-            handler->BindOnceOn(
-                    this, &Controller::impl::read_local_version_information_complete_handler));
-    hci_->EnqueueCommand(
-            ReadLocalSupportedCommandsBuilder::Create(),
-            handler->BindOnceOn(this,
-                                &Controller::impl::read_local_supported_commands_complete_handler));
+  void run_startup_phase(std::string name, void (Controller::impl::*send_commands)()) {
+    startup_phases_.push_back(StartupPhase{std::move(name)});
+    startup_phase_start_time_ = std::chrono::steady_clock::now();
+    // Hold the phase open until all of its commands have been enqueued.
+    startup_commands_pending_++;
+    (this->*send_commands)();
+    on_startup_command_done();
+  }
 
-    hci_->EnqueueCommand(
-            LeReadLocalSupportedFeaturesBuilder::Create(),
-            handler->BindOnceOn(this, &Controller::impl::le_read_local_supported_features_handler));
+  // Startup commands of a phase are all enqueued at once; the next phase only
+  // starts when every one of them has completed.
+  void enqueue_startup_command(std::unique_ptr<CommandBuilder> command,
+                               void (Controller::impl::*on_complete)(CommandCompleteView)) {
+    startup_commands_pending_++;
+    startup_phases_.back().num_commands++;
+    hci_->EnqueueCommand(std::move(command),
+                         module_.GetHandler()->BindOnceOn(
+                                 this, &Controller::impl::on_startup_command_complete,
+                                 on_complete));
+  }
 
-    hci_->EnqueueCommand(
-            LeReadSupportedStatesBuilder::Create(),
-            handler->BindOnceOn(this, &Controller::impl::le_read_supported_states_handler));
+  // For the startup commands that only write a setting: the phase still waits
+  // for them, so that nothing is outstanding when Start() returns.
+  template <class T>
+  void startup_check_complete(CommandCompleteView view) {
+    check_complete<T>(std::move(view));
+  }
 
-    // Wait for all extended features read
-    std::promise<void> features_promise;
-    auto features_future = features_promise.get_future();
+  void on_startup_command_complete(void (Controller::impl::*on_complete)(CommandCompleteView),
+                                   CommandCompleteView view) {
+    (this->*on_complete)(std::move(view));
+    on_startup_command_done();
+  }
 
-    hci_->EnqueueCommand(
-            ReadLocalExtendedFeaturesBuilder::Create(0x00),
-            handler->BindOnceOn(this,
-                                &Controller::impl::read_local_extended_features_complete_handler,
-                                std::move(features_promise)));
-    features_future.wait();
+  void on_startup_command_done() {
+    ASSERT(startup_commands_pending_ > 0);
+    if (--startup_commands_pending_ > 0) {
+      return;
+    }
+    auto& phase = startup_phases_.back();
+    phase.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startup_phase_start_time_);
+    log::info("Startup phase {}: {} commands in {}us", phase.name, phase.num_commands,
+              phase.duration.count());
+    start_next_startup_phase();
+  }
 
-    if (com::android::bluetooth::flags::channel_sounding_in_stack() &&
-        module_.SupportsBleChannelSounding()) {
-      le_set_event_mask(MaskLeEventMask(local_version_information_.hci_version_,
-                                        kDefaultLeEventMask | kLeCSEventMask));
+  // Commands that only depend on the controller. What they read decides which
+  // commands the capabilities phase sends.
+  void send_local_features_commands() {
+    enqueue_startup_command(SetEventMaskBuilder::Create(kDefaultEventMask),
+                            &Controller::impl::startup_check_complete<SetEventMaskCompleteView>);
+    if (com::android::bluetooth::flags::encryption_change_v2()) {
+      enqueue_startup_command(
+              SetEventMaskPage2Builder::Create(kDefaultEventMaskPage2),
+              &Controller::impl::startup_check_complete<SetEventMaskPage2CompleteView>);
+    }
+
+    enqueue_startup_command(
+            WriteLeHostSupportBuilder::Create(Enable::ENABLED, Enable::DISABLED),
+            &Controller::impl::startup_check_complete<WriteLeHostSupportCompleteView>);
+    enqueue_startup_command(ReadLocalNameBuilder::Create(),
+                            &Controller::impl::read_local_name_complete_handler);
+    enqueue_startup_command(ReadLocalVersionInformationBuilder::Create(),
+                            &Controller::impl::read_local_version_information_complete_handler);
+    enqueue_startup_command(ReadLocalSupportedCommandsBuilder::Create(),
+                            &Controller::impl::read_local_supported_commands_complete_handler);
+    enqueue_startup_command(LeReadLocalSupportedFeaturesBuilder::Create(),
+                            &Controller::impl::le_read_local_supported_features_handler);
+    enqueue_startup_command(LeReadSupportedStatesBuilder::Create(),
+                            &Controller::impl::le_read_supported_states_handler);
+
+    // The remaining pages are read from the completion of the first one.
+    enqueue_startup_command(ReadLocalExtendedFeaturesBuilder::Create(0x00),
+                            &Controller::impl::read_local_extended_features_complete_handler);
+
+    // LE buffer sizes fall back to these, so they are read before them.
+    enqueue_startup_command(ReadBufferSizeBuilder::Create(),
+                            &Controller::impl::read_buffer_size_complete_handler);
+
+    enqueue_startup_command(LeReadFilterAcceptListSizeBuilder::Create(),
+                            &Controller::impl::le_read_accept_list_size_handler);
+
+    // Skip vendor capabilities check if configured.
+    if (os::GetSystemPropertyBool(kPropertyVendorCapabilitiesEnabled,
+                                  kDefaultVendorCapabilitiesEnabled)) {
+      // More commands can be enqueued from le_get_vendor_capabilities_handler
+      enqueue_startup_command(LeGetVendorCapabilitiesBuilder::Create(),
+                              &Controller::impl::le_get_vendor_capabilities_handler);
     } else {
-      le_set_event_mask(
-              MaskLeEventMask(local_version_information_.hci_version_, kDefaultLeEventMask));
+      vendor_capabilities_.is_supported_ = 0x00;
     }
 
-    hci_->EnqueueCommand(
-            ReadBufferSizeBuilder::Create(),
-            handler->BindOnceOn(this, &Controller::impl::read_buffer_size_complete_handler));
+    enqueue_startup_command(ReadBdAddrBuilder::Create(),
+                            &Controller::impl::read_controller_mac_address_handler);
+  }
+
+  // Commands that depend on the supported commands, features and version read
+  // in the local features phase.
+  void send_capabilities_commands() {
+    uint64_t le_event_mask = kDefaultLeEventMask;
+    if (com::android::bluetooth::flags::channel_sounding_in_stack() &&
+        module_.SupportsBleChannelSounding()) {
+      le_event_mask |= kLeCSEventMask;
+    }
+    enqueue_startup_command(
+            LeSetEventMaskBuilder::Create(
+                    MaskLeEventMask(local_version_information_.hci_version_, le_event_mask)),
+            &Controller::impl::startup_check_complete<LeSetEventMaskCompleteView>);
 
     if (is_supported(OpCode::SET_MIN_ENCRYPTION_KEY_SIZE)) {
-      hci_->EnqueueCommand(
-              SetMinEncryptionKeySizeBuilder::Create(kMinEncryptionKeySize),
-              handler->BindOnceOn(this, &Controller::impl::set_min_encryption_key_size_handler));
+      enqueue_startup_command(SetMinEncryptionKeySizeBuilder::Create(kMinEncryptionKeySize),
+                              &Controller::impl::set_min_encryption_key_size_handler);
     }
 
     if (is_supported(OpCode::LE_READ_BUFFER_SIZE_V2)) {
-      hci_->EnqueueCommand(
-              LeReadBufferSizeV2Builder::Create(),
-              handler->BindOnceOn(this, &Controller::impl::le_read_buffer_size_v2_handler));
+      enqueue_startup_command(LeReadBufferSizeV2Builder::Create(),
+                              &Controller::impl::le_read_buffer_size_v2_handler);
     } else {
-      hci_->EnqueueCommand(
-              LeReadBufferSizeV1Builder::Create(),
-              handler->BindOnceOn(this, &Controller::impl::le_read_buffer_size_handler));
+      enqueue_startup_command(LeReadBufferSizeV1Builder::Create(),
+                              &Controller::impl::le_read_buffer_size_handler);
     }
 
     if (is_supported(OpCode::READ_LOCAL_SUPPORTED_CODECS_V1)) {
-      hci_->EnqueueCommand(
-              ReadLocalSupportedCodecsV1Builder::Create(),
-              handler->BindOnceOn(this, &Controller::impl::read_local_supported_codecs_v1_handler));
+      enqueue_startup_command(ReadLocalSupportedCodecsV1Builder::Create(),
+                              &Controller::impl::read_local_supported_codecs_v1_handler);
     }
 
-    hci_->EnqueueCommand(
-            LeReadFilterAcceptListSizeBuilder::Create(),
-            handler->BindOnceOn(this, &Controller::impl::le_read_accept_list_size_handler));
-
     if (is_supported(OpCode::LE_READ_RESOLVING_LIST_SIZE) && module_.SupportsBlePrivacy()) {
-      hci_->EnqueueCommand(
-              LeReadResolvingListSizeBuilder::Create(),
-              handler->BindOnceOn(this, &Controller::impl::le_read_resolving_list_size_handler));
+      enqueue_startup_command(LeReadResolvingListSizeBuilder::Create(),
+                              &Controller::impl::le_read_resolving_list_size_handler);
     } else {
       log::info("LE_READ_RESOLVING_LIST_SIZE not supported, defaulting to 0");
       le_resolving_list_size_ = 0;
@@ -150,9 +230,8 @@ struct Controller::impl {
 
     if (is_supported(OpCode::LE_READ_MAXIMUM_DATA_LENGTH) &&
         module_.SupportsBleDataPacketLengthExtension()) {
-      hci_->EnqueueCommand(
-              LeReadMaximumDataLengthBuilder::Create(),
-              handler->BindOnceOn(this, &Controller::impl::le_read_maximum_data_length_handler));
+      enqueue_startup_command(LeReadMaximumDataLengthBuilder::Create(),
+                              &Controller::impl::le_read_maximum_data_length_handler);
     } else {
       log::info("LE_READ_MAXIMUM_DATA_LENGTH not supported, defaulting to 0");
       le_maximum_data_length_.supported_max_rx_octets_ = 0;
@@ -162,20 +241,18 @@ struct Controller::impl {
     }
 
     // SSP is managed by security layer once enabled
-    write_simple_pairing_mode(Enable::ENABLED);
+    enqueue_startup_command(
+            WriteSimplePairingModeBuilder::Create(Enable::ENABLED),
+            &Controller::impl::startup_check_complete<WriteSimplePairingModeCompleteView>);
     if (module_.SupportsSecureConnections()) {
-      hci_->EnqueueCommand(
+      enqueue_startup_command(
               WriteSecureConnectionsHostSupportBuilder::Create(Enable::ENABLED),
-              handler->BindOnceOn(
-                      this,
-                      &Controller::impl::write_secure_connections_host_support_complete_handler));
+              &Controller::impl::write_secure_connections_host_support_complete_handler);
     }
     if (is_supported(OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH) &&
         module_.SupportsBleDataPacketLengthExtension()) {
-      hci_->EnqueueCommand(
-              LeReadSuggestedDefaultDataLengthBuilder::Create(),
-              handler->BindOnceOn(
-                      this, &Controller::impl::le_read_suggested_default_data_length_handler));
+      enqueue_startup_command(LeReadSuggestedDefaultDataLengthBuilder::Create(),
+                              &Controller::impl::le_read_suggested_default_data_length_handler);
     } else {
       log::info("LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH not supported, defaulting to 27 (0x1B)");
       le_suggested_default_data_length_ = 27;
@@ -183,10 +260,8 @@ struct Controller::impl {
 
     if (is_supported(OpCode::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH) &&
         module_.SupportsBleExtendedAdvertising()) {
-      hci_->EnqueueCommand(
-              LeReadMaximumAdvertisingDataLengthBuilder::Create(),
-              handler->BindOnceOn(
-                      this, &Controller::impl::le_read_maximum_advertising_data_length_handler));
+      enqueue_startup_command(LeReadMaximumAdvertisingDataLengthBuilder::Create(),
+                              &Controller::impl::le_read_maximum_advertising_data_length_handler);
     } else {
       log::info("LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH not supported, defaulting to 31 (0x1F)");
       le_maximum_advertising_data_length_ = 31;
@@ -194,11 +269,9 @@ struct Controller::impl {
 
     if (is_supported(OpCode::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS) &&
         module_.SupportsBleExtendedAdvertising()) {
-      hci_->EnqueueCommand(
+      enqueue_startup_command(
               LeReadNumberOfSupportedAdvertisingSetsBuilder::Create(),
-              handler->BindOnceOn(
-                      this,
-                      &Controller::impl::le_read_number_of_supported_advertising_sets_handler));
+              &Controller::impl::le_read_number_of_supported_advertising_sets_handler);
     } else {
       log::info("LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS not supported, defaulting to 1");
       le_number_supported_advertising_sets_ = 1;
@@ -206,70 +279,43 @@ struct Controller::impl {
 
     if (is_supported(OpCode::LE_READ_PERIODIC_ADVERTISER_LIST_SIZE) &&
         module_.SupportsBlePeriodicAdvertising()) {
-      hci_->EnqueueCommand(
-              LeReadPeriodicAdvertiserListSizeBuilder::Create(),
-              handler->BindOnceOn(
-                      this, &Controller::impl::le_read_periodic_advertiser_list_size_handler));
+      enqueue_startup_command(LeReadPeriodicAdvertiserListSizeBuilder::Create(),
+                              &Controller::impl::le_read_periodic_advertiser_list_size_handler);
     } else {
       log::info("LE_READ_PERIODIC_ADVERTISER_LIST_SIZE not supported, defaulting to 0");
       le_periodic_advertiser_list_size_ = 0;
     }
     if (is_supported(OpCode::LE_SET_HOST_FEATURE) &&
         module_.SupportsBleConnectedIsochronousStreamCentral()) {
-      hci_->EnqueueCommand(
+      enqueue_startup_command(
               LeSetHostFeatureBuilder::Create(LeHostFeatureBits::CONNECTED_ISO_STREAM_HOST_SUPPORT,
                                               Enable::ENABLED),
-              handler->BindOnceOn(this, &Controller::impl::le_set_host_feature_handler));
+              &Controller::impl::le_set_host_feature_handler);
     }
 
     if (is_supported(OpCode::LE_SET_HOST_FEATURE) && module_.SupportsBleConnectionSubrating()) {
-      hci_->EnqueueCommand(
+      enqueue_startup_command(
               LeSetHostFeatureBuilder::Create(LeHostFeatureBits::CONNECTION_SUBRATING_HOST_SUPPORT,
                                               Enable::ENABLED),
-              handler->BindOnceOn(this, &Controller::impl::le_set_host_feature_handler));
+              &Controller::impl::le_set_host_feature_handler);
     }
 
     if (com::android::bluetooth::flags::channel_sounding_in_stack() &&
         module_.SupportsBleChannelSounding()) {
-      hci_->EnqueueCommand(
+      enqueue_startup_command(
               LeSetHostFeatureBuilder::Create(LeHostFeatureBits::CHANNEL_SOUNDING_HOST_SUPPORT,
                                               Enable::ENABLED),
-              handler->BindOnceOn(this, &Controller::impl::le_set_host_feature_handler));
+              &Controller::impl::le_set_host_feature_handler);
     }
 
     if (os::GetSystemPropertyBool(
             kPropertyErroneousDataReportingEnabled, kDefaultErroneousDataReportingEnabled)) {
         if (is_supported(OpCode::READ_DEFAULT_ERRONEOUS_DATA_REPORTING)) {
-          hci_->EnqueueCommand(
+          enqueue_startup_command(
                   ReadDefaultErroneousDataReportingBuilder::Create(),
-                  handler->BindOnceOn(
-                          this, &Controller::impl::read_default_erroneous_data_reporting_handler));
+                  &Controller::impl::read_default_erroneous_data_reporting_handler);
         }
     }
-
-    // Skip vendor capabilities check if configured.
-    if (os::GetSystemPropertyBool(kPropertyVendorCapabilitiesEnabled,
-                                  kDefaultVendorCapabilitiesEnabled)) {
-      // More commands can be enqueued from le_get_vendor_capabilities_handler
-      std::promise<void> vendor_promise;
-      auto vendor_future = vendor_promise.get_future();
-      hci_->EnqueueCommand(
-              LeGetVendorCapabilitiesBuilder::Create(),
-              handler->BindOnceOn(this, &Controller::impl::le_get_vendor_capabilities_handler,
-                                  std::move(vendor_promise)));
-      vendor_future.wait();
-    } else {
-      vendor_capabilities_.is_supported_ = 0x00;
-    }
-
-    // We only need to synchronize the last read. Make BD_ADDR to be the last one.
-    std::promise<void> promise;
-    auto future = promise.get_future();
-    hci_->EnqueueCommand(
-            ReadBdAddrBuilder::Create(),
-            handler->BindOnceOn(this, &Controller::impl::read_controller_mac_address_handler,
-                                std::move(promise)));
-    future.wait();
   }
 
   void Stop() { hci_ = nullptr; }
@@ -372,8 +418,7 @@ struct Controller::impl {
     }
   }
 
-  void read_local_extended_features_complete_handler(std::promise<void> promise,
-                                                     CommandCompleteView view) {
+  void read_local_extended_features_complete_handler(CommandCompleteView view) {
     auto complete_view = ReadLocalExtendedFeaturesCompleteView::Create(view);
     ASSERT(complete_view.IsValid());
     ErrorCode status = complete_view.GetStatus();
@@ -392,13 +437,8 @@ struct Controller::impl {
     // Query all extended features
     if (page_number < complete_view.GetMaximumPageNumber()) {
       page_number++;
-      hci_->EnqueueCommand(
-              ReadLocalExtendedFeaturesBuilder::Create(page_number),
-              module_.GetHandler()->BindOnceOn(
-                      this, &Controller::impl::read_local_extended_features_complete_handler,
-                      std::move(promise)));
-    } else {
-      promise.set_value();
+      enqueue_startup_command(ReadLocalExtendedFeaturesBuilder::Create(page_number),
+                              &Controller::impl::read_local_extended_features_complete_handler);
     }
   }
 
@@ -414,13 +454,12 @@ struct Controller::impl {
     sco_buffers_ = complete_view.GetTotalNumSynchronousDataPackets();
   }
 
-  void read_controller_mac_address_handler(std::promise<void> promise, CommandCompleteView view) {
+  void read_controller_mac_address_handler(CommandCompleteView view) {
     auto complete_view = ReadBdAddrCompleteView::Create(view);
     ASSERT(complete_view.IsValid());
     ErrorCode status = complete_view.GetStatus();
     log::assert_that(status == ErrorCode::SUCCESS, "Status {}", ErrorCodeText(status));
     mac_address_ = complete_view.GetBdAddr();
-    promise.set_value();
   }
 
   void le_read_buffer_size_handler(CommandCompleteView view) {
@@ -609,8 +648,7 @@ struct Controller::impl {
     le_periodic_advertiser_list_size_ = complete_view.GetPeriodicAdvertiserListSize();
   }
 
-  void le_get_vendor_capabilities_handler(std::promise<void> vendor_promise,
-                                          CommandCompleteView view) {
+  void le_get_vendor_capabilities_handler(CommandCompleteView view) {
     auto complete_view = LeGetVendorCapabilitiesCompleteView::Create(view);
 
     vendor_capabilities_.is_supported_ = 0x00;
@@ -632,7 +670,6 @@ struct Controller::impl {
     vendor_capabilities_.a2dp_offload_v2_support_ = 0x00;
 
     if (!complete_view.IsValid()) {
-      vendor_promise.set_value();
       return;
     }
     vendor_capabilities_.is_supported_ = 0x01;
@@ -652,7 +689,6 @@ struct Controller::impl {
 
     if (complete_view.GetPayload().size() == 0) {
       vendor_capabilities_.version_supported_ = 55;
-      vendor_promise.set_value();
       return;
     }
 
@@ -660,7 +696,6 @@ struct Controller::impl {
     auto v95 = LeGetVendorCapabilitiesComplete095View::Create(complete_view);
     if (!v95.IsValid()) {
       log::info("invalid data for hci requirements v0.95");
-      vendor_promise.set_value();
       return;
     }
     vendor_capabilities_.version_supported_ = v95.GetVersionSupported();
@@ -668,7 +703,6 @@ struct Controller::impl {
     vendor_capabilities_.extended_scan_support_ = v95.GetExtendedScanSupport();
     vendor_capabilities_.debug_logging_supported_ = v95.GetDebugLoggingSupported();
     if (vendor_capabilities_.version_supported_ <= 95 || complete_view.GetPayload().size() == 0) {
-      vendor_promise.set_value();
       return;
     }
 
@@ -676,13 +710,11 @@ struct Controller::impl {
     auto v96 = LeGetVendorCapabilitiesComplete096View::Create(v95);
     if (!v96.IsValid()) {
       log::info("invalid data for hci requirements v0.96");
-      vendor_promise.set_value();
       return;
     }
     vendor_capabilities_.le_address_generation_offloading_support_ =
             v96.GetLeAddressGenerationOffloadingSupport();
     if (vendor_capabilities_.version_supported_ <= 96 || complete_view.GetPayload().size() == 0) {
-      vendor_promise.set_value();
       return;
     }
 
@@ -690,7 +722,6 @@ struct Controller::impl {
     auto v98 = LeGetVendorCapabilitiesComplete098View::Create(v96);
     if (!v98.IsValid()) {
       log::info("invalid data for hci requirements v0.98");
-      vendor_promise.set_value();
       return;
     }
     vendor_capabilities_.a2dp_source_offload_capability_mask_ =
@@ -701,7 +732,6 @@ struct Controller::impl {
     auto v103 = LeGetVendorCapabilitiesComplete103View::Create(v98);
     if (!v103.IsValid()) {
       log::info("invalid data for hci requirements v1.03");
-      vendor_promise.set_value();
       return;
     }
     vendor_capabilities_.dynamic_audio_buffer_support_ = v103.GetDynamicAudioBufferSupport();
@@ -715,20 +745,12 @@ struct Controller::impl {
     }
 
     if (vendor_capabilities_.dynamic_audio_buffer_support_) {
-      hci_->EnqueueCommand(
-              DabGetAudioBufferTimeCapabilityBuilder::Create(),
-              module_.GetHandler()->BindOnceOn(
-                      this, &Controller::impl::le_get_dynamic_audio_buffer_support_handler,
-                      std::move(vendor_promise)));
-      return;
+      enqueue_startup_command(DabGetAudioBufferTimeCapabilityBuilder::Create(),
+                              &Controller::impl::le_get_dynamic_audio_buffer_support_handler);
     }
-
-    vendor_promise.set_value();
   }
 
-  void le_get_dynamic_audio_buffer_support_handler(std::promise<void> vendor_promise,
-                                                   CommandCompleteView view) {
-    vendor_promise.set_value();
+  void le_get_dynamic_audio_buffer_support_handler(CommandCompleteView view) {
     auto dab_complete_view = DynamicAudioBufferCompleteView::Create(view);
     if (!dab_complete_view.IsValid()) {
       log::warn("Invalid command complete");
@@ -785,33 +807,6 @@ struct Controller::impl {
                          module_.GetHandler()->BindOnce(check_complete<SetEventMaskCompleteView>));
   }
 
-  void set_event_mask_page_2(uint64_t event_mask_page_2) {
-    std::unique_ptr<SetEventMaskPage2Builder> packet =
-            SetEventMaskPage2Builder::Create(event_mask_page_2);
-    hci_->EnqueueCommand(std::move(packet), module_.GetHandler()->BindOnce(
-                                                    check_complete<SetEventMaskPage2CompleteView>));
-  }
-
-  void write_le_host_support(Enable enable, Enable deprecated_host_bit) {
-    if (deprecated_host_bit == Enable::ENABLED) {
-      // Since Bluetooth Core Spec 4.1, this bit should be 0
-      log::warn("Setting deprecated Simultaneous LE BR/EDR Host bit");
-    }
-    std::unique_ptr<WriteLeHostSupportBuilder> packet =
-            WriteLeHostSupportBuilder::Create(enable, deprecated_host_bit);
-    hci_->EnqueueCommand(
-            std::move(packet),
-            module_.GetHandler()->BindOnce(check_complete<WriteLeHostSupportCompleteView>));
-  }
-
-  void write_simple_pairing_mode(Enable enable) {
-    std::unique_ptr<WriteSimplePairingModeBuilder> packet =
-            WriteSimplePairingModeBuilder::Create(enable);
-    hci_->EnqueueCommand(
-            std::move(packet),
-            module_.GetHandler()->BindOnce(check_complete<WriteSimplePairingModeCompleteView>));
-  }
-
   void reset() {
     std::unique_ptr<ResetBuilder> packet = ResetBuilder::Create();
     hci_->EnqueueCommand(std::move(packet),
@@ -1278,6 +1273,16 @@ struct Controller::impl {
   VendorCapabilities vendor_capabilities_{};
   uint32_t dab_supported_codecs_{};
   std::array<DynamicAudioBufferCodecCapability, 32> dab_codec_capabilities_{};
+
+  struct StartupPhase {
+    std::string name;
+    uint16_t num_commands{0};
+    std::chrono::microseconds duration{0};
+  };
+  std::vector<StartupPhase> startup_phases_{};
+  std::chrono::steady_clock::time_point startup_phase_start_time_{};
+  size_t startup_commands_pending_{0};
+  std::promise<void> startup_promise_{};
 };  // namespace hci
 
 Controller::Controller() : impl_(std::make_unique<impl>(*this)) {}
@@ -1622,6 +1627,14 @@ void Controller::impl::Dump(std::promise<flatbuffers::Offset<ControllerData>> pr
 
   auto extended_lmp_features_vector = fb_builder->CreateVector(extended_lmp_features_array_);
 
+  std::vector<flatbuffers::Offset<StartupPhaseData>> startup_phases_vector;
+  for (const auto& phase : startup_phases_) {
+    startup_phases_vector.push_back(CreateStartupPhaseData(
+            *fb_builder, fb_builder->CreateString(phase.name), phase.num_commands,
+            phase.duration.count()));
+  }
+  auto startup_phases_data = fb_builder->CreateVector(startup_phases_vector);
+
   // Create the root table
   ControllerDataBuilder builder(*fb_builder);
 
@@ -1647,6 +1660,7 @@ void Controller::impl::Dump(std::promise<flatbuffers::Offset<ControllerData>> pr
   builder.add_le_local_supported_features(le_local_supported_features_);
   builder.add_le_supported_states(le_supported_states_);
   builder.add_vendor_capabilities(&vendor_capabilities_data);
+  builder.add_startup_phases(startup_phases_data);
 
   flatbuffers::Offset<ControllerData> dumpsys_data = builder.Finish();
   promise.set_value(dumpsys_data);
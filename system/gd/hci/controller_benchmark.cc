@@ -0,0 +1,261 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bluetooth/log.h>
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <queue>
+
+#include "benchmark/benchmark.h"
+#include "common/bind.h"
+#include "hci/controller.h"
+#include "hci/hci_layer_fake.h"
+#include "module.h"
+#include "os/alarm.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+using ::bluetooth::TestModuleRegistry;
+using ::bluetooth::common::ContextualOnceCallback;
+using ::bluetooth::os::Alarm;
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+std::array<uint8_t, 64> SimulatedSupportedCommands() {
+  std::array<uint8_t, 64> supported_commands{};
+  for (auto index : {OpCodeIndex::LE_READ_RESOLVING_LIST_SIZE,
+                     OpCodeIndex::LE_READ_MAXIMUM_DATA_LENGTH,
+                     OpCodeIndex::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH,
+                     OpCodeIndex::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH,
+                     OpCodeIndex::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS,
+                     OpCodeIndex::LE_READ_PERIODIC_ADVERTISER_LIST_SIZE}) {
+    uint16_t bit = static_cast<uint16_t>(index);
+    supported_commands[bit / 10] |= 1 << (bit % 10);
+  }
+  return supported_commands;
+}
+
+std::unique_ptr<EventBuilder> SimulatedResponse(CommandView command) {
+  constexpr uint8_t num_packets = 1;
+  switch (command.GetOpCode()) {
+    case OpCode::READ_LOCAL_NAME:
+      return ReadLocalNameCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS,
+                                                  {'s', 'i', 'm', '\0'});
+    case OpCode::READ_LOCAL_VERSION_INFORMATION: {
+      LocalVersionInformation local_version_information;
+      local_version_information.hci_version_ = HciVersion::V_5_3;
+      local_version_information.lmp_version_ = LmpVersion::V_5_3;
+      return ReadLocalVersionInformationCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS,
+                                                                local_version_information);
+    }
+    case OpCode::READ_LOCAL_SUPPORTED_COMMANDS:
+      return ReadLocalSupportedCommandsCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS,
+                                                               SimulatedSupportedCommands());
+    case OpCode::READ_LOCAL_EXTENDED_FEATURES: {
+      auto read_command = ReadLocalExtendedFeaturesView::Create(command);
+      log::assert_that(read_command.IsValid(), "assert failed: read_command.IsValid()");
+      return ReadLocalExtendedFeaturesCompleteBuilder::Create(
+              num_packets, ErrorCode::SUCCESS, read_command.GetPageNumber(), 0x02, ~0ull);
+    }
+    case OpCode::LE_READ_LOCAL_SUPPORTED_FEATURES:
+      return LeReadLocalSupportedFeaturesCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS,
+                                                                 ~0ull);
+    case OpCode::LE_READ_SUPPORTED_STATES:
+      return LeReadSupportedStatesCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS, ~0ull);
+    case OpCode::READ_BUFFER_SIZE:
+      return ReadBufferSizeCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS, 1021, 60, 8, 8);
+    case OpCode::LE_READ_BUFFER_SIZE_V1: {
+      LeBufferSize le_buffer_size;
+      le_buffer_size.le_data_packet_length_ = 251;
+      le_buffer_size.total_num_le_packets_ = 8;
+      return LeReadBufferSizeV1CompleteBuilder::Create(num_packets, ErrorCode::SUCCESS,
+                                                       le_buffer_size);
+    }
+    case OpCode::LE_READ_FILTER_ACCEPT_LIST_SIZE:
+      return LeReadFilterAcceptListSizeCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS, 16);
+    case OpCode::LE_READ_RESOLVING_LIST_SIZE:
+      return LeReadResolvingListSizeCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS, 16);
+    case OpCode::LE_READ_MAXIMUM_DATA_LENGTH: {
+      LeMaximumDataLength le_maximum_data_length;
+      le_maximum_data_length.supported_max_tx_octets_ = 251;
+      le_maximum_data_length.supported_max_tx_time_ = 2120;
+      le_maximum_data_length.supported_max_rx_octets_ = 251;
+      le_maximum_data_length.supported_max_rx_time_ = 2120;
+      return LeReadMaximumDataLengthCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS,
+                                                            le_maximum_data_length);
+    }
+    case OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH:
+      return LeReadSuggestedDefaultDataLengthCompleteBuilder::Create(num_packets,
+                                                                     ErrorCode::SUCCESS, 251, 2120);
+    case OpCode::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH:
+      return LeReadMaximumAdvertisingDataLengthCompleteBuilder::Create(num_packets,
+                                                                       ErrorCode::SUCCESS, 1650);
+    case OpCode::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS:
+      return LeReadNumberOfSupportedAdvertisingSetsCompleteBuilder::Create(num_packets,
+                                                                           ErrorCode::SUCCESS, 16);
+    case OpCode::LE_READ_PERIODIC_ADVERTISER_LIST_SIZE:
+      return LeReadPeriodicAdvertiserListSizeCompleteBuilder::Create(num_packets,
+                                                                     ErrorCode::SUCCESS, 8);
+    case OpCode::READ_BD_ADDR:
+      return ReadBdAddrCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS, Address::kAny);
+    case OpCode::LE_GET_VENDOR_CAPABILITIES:
+      return LeGetVendorCapabilitiesCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS,
+                                                            BaseVendorCapabilities{},
+                                                            std::make_unique<packet::RawBuilder>());
+    default:
+      // Writes only return a status.
+      return CommandCompleteBuilder::Create(
+              num_packets, command.GetOpCode(),
+              std::make_unique<packet::RawBuilder>(
+                      std::vector<uint8_t>{static_cast<uint8_t>(ErrorCode::SUCCESS)}));
+  }
+}
+
+// Answers every command |latency| after it was sent, with at most
+// |max_outstanding| commands in flight, like HciLayer with that many credits.
+class SimulatedController : public HciLayerFake {
+public:
+  SimulatedController(std::chrono::milliseconds latency, size_t max_outstanding)
+      : latency_(latency), max_outstanding_(max_outstanding) {}
+
+  void EnqueueCommand(std::unique_ptr<CommandBuilder> command,
+                      ContextualOnceCallback<void(CommandCompleteView)> on_complete) override {
+    GetHandler()->Post(common::BindOnce(&SimulatedController::handle_command,
+                                        common::Unretained(this), std::move(command),
+                                        std::move(on_complete)));
+  }
+
+  void EnqueueCommand(std::unique_ptr<CommandBuilder> /* command */,
+                      ContextualOnceCallback<void(CommandStatusView)> /* on_status */) override {
+    log::fatal("Controller startup should not generate Command Status");
+  }
+
+  size_t GetNumCommands() const { return num_commands_; }
+
+protected:
+  void Start() override {
+    HciLayerFake::Start();
+    alarm_ = std::make_unique<Alarm>(GetHandler(), false);
+  }
+
+  void Stop() override {
+    alarm_.reset();
+    HciLayerFake::Stop();
+  }
+
+private:
+  struct Command {
+    std::unique_ptr<CommandBuilder> builder;
+    ContextualOnceCallback<void(CommandCompleteView)> on_complete;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  void handle_command(std::unique_ptr<CommandBuilder> builder,
+                      ContextualOnceCallback<void(CommandCompleteView)> on_complete) {
+    num_commands_++;
+    queued_.push({std::move(builder), std::move(on_complete), {}});
+    send_queued();
+  }
+
+  void send_queued() {
+    while (!queued_.empty() && in_flight_.size() < max_outstanding_) {
+      queued_.front().deadline = std::chrono::steady_clock::now() + latency_;
+      in_flight_.push_back(std::move(queued_.front()));
+      queued_.pop();
+    }
+    if (in_flight_.empty() || alarm_scheduled_) {
+      return;
+    }
+    alarm_scheduled_ = true;
+    auto delay = std::chrono::ceil<std::chrono::milliseconds>(in_flight_.front().deadline -
+                                                              std::chrono::steady_clock::now());
+    if (delay.count() <= 0) {
+      // A zero delay would disarm the alarm.
+      GetHandler()->Post(
+              common::BindOnce(&SimulatedController::on_alarm, common::Unretained(this)));
+    } else {
+      alarm_->Schedule(common::BindOnce(&SimulatedController::on_alarm, common::Unretained(this)),
+                       delay);
+    }
+  }
+
+  void on_alarm() {
+    alarm_scheduled_ = false;
+    auto now = std::chrono::steady_clock::now();
+    while (!in_flight_.empty() && in_flight_.front().deadline <= now) {
+      respond(std::move(in_flight_.front()));
+      in_flight_.pop_front();
+    }
+    send_queued();
+  }
+
+  void respond(Command command) {
+    auto bytes = std::make_shared<std::vector<uint8_t>>();
+    BitInserter i(*bytes);
+    command.builder->Serialize(i);
+    auto command_view = CommandView::Create(packet::PacketView<packet::kLittleEndian>(bytes));
+    log::assert_that(command_view.IsValid(), "assert failed: command_view.IsValid()");
+
+    auto event = EventView::Create(GetPacketView(SimulatedResponse(command_view)));
+    auto complete = CommandCompleteView::Create(event);
+    log::assert_that(complete.IsValid(), "assert failed: complete.IsValid()");
+    command.on_complete(std::move(complete));
+  }
+
+  const std::chrono::milliseconds latency_;
+  const size_t max_outstanding_;
+  std::unique_ptr<Alarm> alarm_;
+  bool alarm_scheduled_{false};
+  std::queue<Command> queued_;
+  std::deque<Command> in_flight_;
+  size_t num_commands_{0};
+};
+
+// Args: controller latency in ms, commands in flight.
+void BM_ControllerStartup(State& state) {
+  auto latency = std::chrono::milliseconds(state.range(0));
+  size_t max_outstanding = state.range(1);
+  size_t num_commands = 0;
+
+  for (auto _ : state) {
+    TestModuleRegistry registry;
+    auto simulated_controller = new SimulatedController(latency, max_outstanding);
+    registry.InjectTestModule(&HciLayer::Factory, simulated_controller);
+
+    auto start_time = std::chrono::steady_clock::now();
+    registry.Start<Controller>(&registry.GetTestThread());
+    state.SetIterationTime(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count());
+
+    num_commands = simulated_controller->GetNumCommands();
+    registry.StopAll();
+  }
+  state.counters["commands"] = num_commands;
+}
+
+BENCHMARK(BM_ControllerStartup)
+        ->ArgsProduct({{1, 5}, {1, 4, 8}})
+        ->UseManualTime()
+        ->Unit(::benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
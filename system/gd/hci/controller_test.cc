@@ -27,6 +27,7 @@
 #include <sstream>
 
 #include "common/bind.h"
+#include "dumpsys_data_generated.h"
 #include "hci/address.h"
 #include "hci/hci_layer_fake.h"
 #include "module_dumper.h"
@@ -154,6 +155,36 @@ public:
         event_builder = LeReadSupportedStatesCompleteBuilder::Create(
                 num_packets, ErrorCode::SUCCESS, 0x001f123456789abe);
       } break;
+      case (OpCode::LE_READ_BUFFER_SIZE_V2): {
+        LeBufferSize le_buffer_size;
+        le_buffer_size.le_data_packet_length_ = 0x16;
+        le_buffer_size.total_num_le_packets_ = 0x08;
+        LeBufferSize iso_buffer_size;
+        iso_buffer_size.le_data_packet_length_ = 0x24;
+        iso_buffer_size.total_num_le_packets_ = 0x04;
+        event_builder = LeReadBufferSizeV2CompleteBuilder::Create(num_packets, ErrorCode::SUCCESS,
+                                                                  le_buffer_size, iso_buffer_size);
+      } break;
+      case (OpCode::LE_READ_FILTER_ACCEPT_LIST_SIZE): {
+        event_builder = LeReadFilterAcceptListSizeCompleteBuilder::Create(num_packets,
+                                                                          ErrorCode::SUCCESS, 0x10);
+      } break;
+      case (OpCode::LE_READ_RESOLVING_LIST_SIZE): {
+        event_builder = LeReadResolvingListSizeCompleteBuilder::Create(num_packets,
+                                                                       ErrorCode::SUCCESS, 0x20);
+      } break;
+      case (OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH): {
+        event_builder = LeReadSuggestedDefaultDataLengthCompleteBuilder::Create(
+                num_packets, ErrorCode::SUCCESS, 0xfb, 0x0848);
+      } break;
+      case (OpCode::LE_READ_PERIODIC_ADVERTISER_LIST_SIZE): {
+        event_builder = LeReadPeriodicAdvertiserListSizeCompleteBuilder::Create(
+                num_packets, ErrorCode::SUCCESS, 0x08);
+      } break;
+      case (OpCode::READ_DEFAULT_ERRONEOUS_DATA_REPORTING): {
+        event_builder = ReadDefaultErroneousDataReportingCompleteBuilder::Create(
+                num_packets, ErrorCode::SUCCESS, Enable::ENABLED);
+      } break;
       case (OpCode::LE_READ_MAXIMUM_DATA_LENGTH): {
         LeMaximumDataLength le_maximum_data_length;
         le_maximum_data_length.supported_max_tx_octets_ = 0x12;
@@ -228,6 +259,27 @@ public:
         le_event_mask = view.GetLeEventMask();
         event_builder = LeSetEventMaskCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS);
       } break;
+      case (OpCode::SET_EVENT_MASK_PAGE_2):
+        event_builder = SetEventMaskPage2CompleteBuilder::Create(num_packets, ErrorCode::SUCCESS);
+        break;
+      case (OpCode::WRITE_LE_HOST_SUPPORT):
+        event_builder = WriteLeHostSupportCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS);
+        break;
+      case (OpCode::WRITE_SIMPLE_PAIRING_MODE):
+        event_builder =
+                WriteSimplePairingModeCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS);
+        break;
+      case (OpCode::WRITE_SECURE_CONNECTIONS_HOST_SUPPORT):
+        event_builder = WriteSecureConnectionsHostSupportCompleteBuilder::Create(
+                num_packets, ErrorCode::SUCCESS);
+        break;
+      case (OpCode::SET_MIN_ENCRYPTION_KEY_SIZE):
+        event_builder =
+                SetMinEncryptionKeySizeCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS);
+        break;
+      case (OpCode::LE_SET_HOST_FEATURE):
+        event_builder = LeSetHostFeatureCompleteBuilder::Create(num_packets, ErrorCode::SUCCESS);
+        break;
 
       case (OpCode::LE_RAND): {
         auto view = LeRandView::Create(LeSecurityCommandView::Create(command));
@@ -638,5 +690,34 @@ TEST_F(ControllerTest, Dumpsys) {
   ASSERT_TRUE(output.find("Hci Controller Dumpsys") != std::string::npos);
 }
 
+TEST_F(ControllerTest, startup_phases_are_timed) {
+  ModuleDumper dumper(STDOUT_FILENO, fake_registry_, title);
+
+  std::string output;
+  std::ostringstream oss;
+  dumper.DumpState(&output, oss);
+
+  auto data = flatbuffers::GetRoot<DumpsysData>(output.data());
+  auto startup_phases = data->hci_controller_dumpsys_data()->startup_phases();
+  ASSERT_NE(nullptr, startup_phases);
+  ASSERT_EQ(2u, startup_phases->size());
+  EXPECT_STREQ("local_features", startup_phases->Get(0)->name()->c_str());
+  EXPECT_STREQ("capabilities", startup_phases->Get(1)->name()->c_str());
+  for (auto phase : *startup_phases) {
+    EXPECT_LT(0, phase->num_commands());
+  }
+}
+
+TEST_F(ControllerTest, startup_reads_complete_before_start_returns) {
+  // Extended feature pages are chained from one another, up to page 2.
+  ASSERT_EQ(0x012345678abcdf1u, controller_->GetLocalFeatures(2));
+  ASSERT_EQ(0x10, controller_->GetLeFilterAcceptListSize());
+}
+
+TEST_F(ControllerTest, startup_writes_complete_before_start_returns) {
+  ASSERT_NE(0u, test_hci_layer_->event_mask);
+  ASSERT_NE(0u, test_hci_layer_->le_event_mask);
+}
+
 }  // namespace hci
 }  // namespace bluetooth
@@ -21,6 +21,7 @@
 #endif
 #include <bluetooth/log.h>
 
+#include <algorithm>
 #include <map>
 #include <utility>
 #include <vector>
@@ -72,6 +73,29 @@ static std::chrono::milliseconds getHciTimeoutRestartMs() {
   return sRestartHciTimeoutMs;
 }
 
+// Maximum number of commands sent to the controller before their Command Complete
+// or Command Status is received, still bounded by Num_HCI_Command_Packets.
+static uint8_t getMaxOutstandingCommands() {
+  uint32_t max = bluetooth::os::GetSystemPropertyUint32Base(
+          "bluetooth.hci.max_outstanding_commands", HciLayer::kMaxOutstandingCommands);
+  return static_cast<uint8_t>(std::clamp<uint32_t>(max, 1, UINT8_MAX));
+}
+
+// Commands that are only sent once every command before them has completed,
+// and that hold back every command after them until they complete.
+static bool is_barrier_command(OpCode op_code) {
+  switch (op_code) {
+    case OpCode::RESET:
+    case OpCode::CONTROLLER_DEBUG_INFO:
+    case OpCode::LE_SET_RANDOM_ADDRESS:
+    case OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE:
+      return true;
+    default:
+      // Vendor specific commands may answer with an unexpected event type.
+      return (static_cast<uint16_t>(op_code) >> 10) == 0x3f;
+  }
+}
+
 static void fail_if_reset_complete_not_success(CommandCompleteView complete) {
   auto reset_complete = ResetCompleteView::Create(complete);
   log::assert_that(reset_complete.IsValid(), "assert failed: reset_complete.IsValid()");
@@ -100,7 +124,10 @@ public:
         on_status(std::move(on_status_function)) {}
 
   unique_ptr<CommandBuilder> command;
+  std::shared_ptr<std::vector<uint8_t>> bytes;
   unique_ptr<CommandView> command_view;
+  OpCode op_code{OpCode::NONE};
+  unique_ptr<Alarm> timeout_alarm;
 
   bool waiting_for_status_;
   ContextualOnceCallback<void(CommandStatusView)> on_status;
@@ -123,21 +150,20 @@ public:
 };
 
 struct HciLayer::impl {
-  impl(hal::HciHal* hal, HciLayer& module) : hal_(hal), module_(module) {
-    hci_timeout_alarm_ = new Alarm(module.GetHandler());
+  impl(hal::HciHal* hal, HciLayer& module)
+      : hal_(hal), module_(module), max_outstanding_commands_(getMaxOutstandingCommands()) {
+    log::info("Up to {} outstanding HCI commands", max_outstanding_commands_);
   }
 
   ~impl() {
     incoming_acl_buffer_.Clear();
     incoming_sco_buffer_.Clear();
     incoming_iso_buffer_.Clear();
-    if (hci_timeout_alarm_ != nullptr) {
-      delete hci_timeout_alarm_;
-    }
     if (hci_abort_alarm_ != nullptr) {
       delete hci_abort_alarm_;
     }
     command_queue_.clear();
+    waiting_commands_.clear();
   }
 
   void drop(EventView event) {
@@ -203,20 +229,23 @@ struct HciLayer::impl {
     }
     bool is_status = logging_id == "status";
 
-    log::assert_that(!command_queue_.empty(), "Unexpected {} event with OpCode {}", logging_id,
+    log::assert_that(!waiting_commands_.empty(), "Unexpected {} event with OpCode {}", logging_id,
                      OpCodeText(op_code));
-    if (waiting_command_ == OpCode::CONTROLLER_DEBUG_INFO &&
+    if (waiting_commands_.front().op_code == OpCode::CONTROLLER_DEBUG_INFO &&
         op_code != OpCode::CONTROLLER_DEBUG_INFO) {
       log::error("Discarding event that came after timeout {}", OpCodeText(op_code));
       common::StopWatch::DumpStopWatchLog();
       return;
     }
-    log::assert_that(waiting_command_ == op_code, "Waiting for {}, got {}",
-                     OpCodeText(waiting_command_), OpCodeText(op_code));
+    // Responses to different opcodes may be reordered by the controller, those
+    // to the same opcode are not.
+    auto waiting_command = find_waiting_command(op_code);
+    log::assert_that(waiting_command != waiting_commands_.end(), "Waiting for {}, got {}",
+                     OpCodeText(waiting_commands_.front().op_code), OpCodeText(op_code));
 
     bool is_vendor_specific = static_cast<int>(op_code) & (0x3f << 10);
     CommandStatusView status_view = CommandStatusView::Create(event);
-    if (is_vendor_specific && (is_status && !command_queue_.front().waiting_for_status_) &&
+    if (is_vendor_specific && (is_status && !waiting_command->waiting_for_status_) &&
         (status_view.IsValid() && status_view.GetStatus() == ErrorCode::UNKNOWN_HCI_COMMAND)) {
       // If this is a command status of a vendor specific command, and command complete is expected,
       // we can't treat this as hard failure since we have no way of probing this lack of support at
@@ -234,16 +263,15 @@ struct HciLayer::impl {
               CommandCompleteView::Create(EventView::Create(PacketView<kLittleEndian>(complete)));
       log::assert_that(command_complete_view.IsValid(),
                        "assert failed: command_complete_view.IsValid()");
-      (*command_queue_.front().GetCallback<CommandCompleteView>())(command_complete_view);
+      (*waiting_command->GetCallback<CommandCompleteView>())(command_complete_view);
     } else {
-      if (command_queue_.front().waiting_for_status_ == is_status) {
-        (*command_queue_.front().GetCallback<TResponse>())(std::move(response_view));
+      if (waiting_command->waiting_for_status_ == is_status) {
+        (*waiting_command->GetCallback<TResponse>())(std::move(response_view));
       } else {
         CommandCompleteView command_complete_view = CommandCompleteView::Create(
             EventView::Create(PacketView<kLittleEndian>(
                 std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>()))));
-        (*command_queue_.front().GetCallback<CommandCompleteView>())(
-            std::move(command_complete_view));
+        (*waiting_command->GetCallback<CommandCompleteView>())(std::move(command_complete_view));
       }
     }
 
@@ -255,7 +283,7 @@ struct HciLayer::impl {
     // would return UNKNOWN_CONNECTION in some cases.
     if (op_code == OpCode::LE_READ_REMOTE_FEATURES && is_status && status_view.IsValid() &&
         status_view.GetStatus() == ErrorCode::UNKNOWN_CONNECTION) {
-      auto& command_view = *command_queue_.front().command_view;
+      auto& command_view = *waiting_command->command_view;
       auto le_read_features_view = bluetooth::hci::LeReadRemoteFeaturesView::Create(
               LeConnectionManagementCommandView::Create(AclCommandView::Create(command_view)));
       if (le_read_features_view.IsValid()) {
@@ -265,34 +293,54 @@ struct HciLayer::impl {
     }
 #endif
 
-    command_queue_.pop_front();
-    waiting_command_ = OpCode::NONE;
-    if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Cancel();
+    release_timeout_alarm(*waiting_command);
+    waiting_commands_.erase(waiting_command);
+    if (command_timeouts_enabled_) {
       send_next_command();
     }
   }
 
+  std::list<CommandQueueEntry>::iterator find_waiting_command(OpCode op_code) {
+    return std::find_if(
+            waiting_commands_.begin(), waiting_commands_.end(),
+            [op_code](const CommandQueueEntry& entry) { return entry.op_code == op_code; });
+  }
+
+  void release_timeout_alarm(CommandQueueEntry& entry) {
+    if (entry.timeout_alarm == nullptr) {
+      return;
+    }
+    entry.timeout_alarm->Cancel();
+    idle_timeout_alarms_.push_back(std::move(entry.timeout_alarm));
+  }
+
+  void disable_command_timeouts() {
+    command_timeouts_enabled_ = false;
+    for (auto& entry : waiting_commands_) {
+      if (entry.timeout_alarm != nullptr) {
+        entry.timeout_alarm->Cancel();
+        entry.timeout_alarm.reset();
+      }
+    }
+    idle_timeout_alarms_.clear();
+  }
+
   void on_hci_timeout(OpCode op_code) {
     common::StopWatch::DumpStopWatchLog();
     log::error("Timed out waiting for {} for {}ms", OpCodeText(op_code), getHciTimeoutMs().count());
 
     bluetooth::os::LogMetricHciTimeoutEvent(static_cast<uint32_t>(op_code));
 
-    log::error("Flushing {} waiting commands", command_queue_.size());
+    log::error("Flushing {} waiting commands", command_queue_.size() + waiting_commands_.size());
+    // Don't time out for the debug info command.
+    disable_command_timeouts();
     // Clear any waiting commands (there is an abort coming anyway)
     command_queue_.clear();
+    waiting_commands_.clear();
     command_credits_ = 1;
-    waiting_command_ = OpCode::NONE;
     // Ignore the response, since we don't know what might come back.
     enqueue_command(ControllerDebugInfoBuilder::Create(),
                     module_.GetHandler()->BindOnce([](CommandCompleteView) {}));
-    // Don't time out for this one;
-    if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Cancel();
-      delete hci_timeout_alarm_;
-      hci_timeout_alarm_ = nullptr;
-    }
     if (hci_abort_alarm_ == nullptr) {
       hci_abort_alarm_ = new Alarm(module_.GetHandler());
       hci_abort_alarm_->Schedule(BindOnce(&abort_after_time_out, op_code),
@@ -302,37 +350,53 @@ struct HciLayer::impl {
     }
   }
 
-  void send_next_command() {
-    if (command_credits_ == 0) {
-      return;
+  // Serializes the command at the front of the queue, if not already done, so
+  // that its opcode is known before deciding whether it can be sent.
+  CommandQueueEntry& prepare_next_command() {
+    CommandQueueEntry& entry = command_queue_.front();
+    if (entry.bytes == nullptr) {
+      entry.bytes = std::make_shared<std::vector<uint8_t>>();
+      BitInserter bi(*entry.bytes);
+      entry.command->Serialize(bi);
+      auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(entry.bytes));
+      log::assert_that(cmd_view.IsValid(), "assert failed: cmd_view.IsValid()");
+      entry.op_code = cmd_view.GetOpCode();
+      entry.command_view = std::make_unique<CommandView>(std::move(cmd_view));
     }
-    if (waiting_command_ != OpCode::NONE) {
-      return;
-    }
-    if (command_queue_.size() == 0) {
-      return;
-    }
-    std::shared_ptr<std::vector<uint8_t>> bytes = std::make_shared<std::vector<uint8_t>>();
-    BitInserter bi(*bytes);
-    command_queue_.front().command->Serialize(bi);
-    hal_->sendHciCommand(*bytes);
-
-    auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(bytes));
-    log::assert_that(cmd_view.IsValid(), "assert failed: cmd_view.IsValid()");
-    OpCode op_code = cmd_view.GetOpCode();
-    power_telemetry::GetInstance().LogHciCmdDetail();
-    command_queue_.front().command_view = std::make_unique<CommandView>(std::move(cmd_view));
-    log_link_layer_connection_command(command_queue_.front().command_view);
-    log_classic_pairing_command_status(command_queue_.front().command_view,
-                                       ErrorCode::STATUS_UNKNOWN);
-    waiting_command_ = op_code;
-    command_credits_ = 0;  // Only allow one outstanding command
-    if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Schedule(
-              BindOnce(&impl::on_hci_timeout, common::Unretained(this), op_code),
-              getHciTimeoutMs());
-    } else {
-      log::warn("{} sent without an hci-timeout timer", OpCodeText(op_code));
+    return entry;
+  }
+
+  void send_next_command() {
+    while (command_credits_ > 0 && !command_queue_.empty() &&
+           waiting_commands_.size() < max_outstanding_commands_) {
+      CommandQueueEntry& entry = prepare_next_command();
+      if (!waiting_commands_.empty() &&
+          (is_barrier_command(entry.op_code) ||
+           is_barrier_command(waiting_commands_.back().op_code))) {
+        return;
+      }
+
+      hal_->sendHciCommand(*entry.bytes);
+      OpCode op_code = entry.op_code;
+      power_telemetry::GetInstance().LogHciCmdDetail();
+      log_link_layer_connection_command(entry.command_view);
+      log_classic_pairing_command_status(entry.command_view, ErrorCode::STATUS_UNKNOWN);
+      command_credits_--;
+
+      if (command_timeouts_enabled_) {
+        if (idle_timeout_alarms_.empty()) {
+          entry.timeout_alarm = std::make_unique<Alarm>(module_.GetHandler());
+        } else {
+          entry.timeout_alarm = std::move(idle_timeout_alarms_.back());
+          idle_timeout_alarms_.pop_back();
+        }
+        entry.timeout_alarm->Schedule(
+                BindOnce(&impl::on_hci_timeout, common::Unretained(this), op_code),
+                getHciTimeoutMs());
+      } else {
+        log::warn("{} sent without an hci-timeout timer", OpCodeText(op_code));
+      }
+      waiting_commands_.splice(waiting_commands_.end(), command_queue_, command_queue_.begin());
     }
   }
 
@@ -381,11 +445,7 @@ struct HciLayer::impl {
                vse_error_reason);
     bluetooth::os::LogMetricBluetoothHalCrashReason(Address::kEmpty, 0, vse_error_reason);
     // Add Logging for crash reason
-    if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Cancel();
-      delete hci_timeout_alarm_;
-      hci_timeout_alarm_ = nullptr;
-    }
+    disable_command_timeouts();
     if (hci_abort_alarm_ == nullptr) {
       hci_abort_alarm_ = new Alarm(module_.GetHandler());
       hci_abort_alarm_->Schedule(BindOnce(&abort_after_root_inflammation, vse_error_reason),
@@ -397,7 +457,7 @@ struct HciLayer::impl {
 
   void on_hci_event(EventView event) {
     log::assert_that(event.IsValid(), "assert failed: event.IsValid()");
-    if (command_queue_.empty()) {
+    if (waiting_commands_.empty()) {
       auto event_code = event.GetEventCode();
       // BT Core spec 5.2 (Volume 4, Part E section 4.4) allows anytime
       // COMMAND_COMPLETE and COMMAND_STATUS with opcode 0x0 for flow control
@@ -422,7 +482,7 @@ struct HciLayer::impl {
       std::unique_ptr<CommandView> no_waiting_command{nullptr};
       log_hci_event(no_waiting_command, event, module_.GetDependency<storage::StorageModule>());
     } else {
-      log_hci_event(command_queue_.front().command_view, event,
+      log_hci_event(get_waiting_command_view(event), event,
                     module_.GetDependency<storage::StorageModule>());
     }
     power_telemetry::GetInstance().LogHciEvtDetail();
@@ -465,6 +525,24 @@ struct HciLayer::impl {
     }
   }
 
+  // Returns the command a Command Complete or Command Status event answers, or
+  // the oldest waiting command for any other event.
+  std::unique_ptr<CommandView>& get_waiting_command_view(EventView event) {
+    OpCode op_code = OpCode::NONE;
+    if (event.GetEventCode() == EventCode::COMMAND_COMPLETE) {
+      auto view = CommandCompleteView::Create(event);
+      op_code = view.IsValid() ? view.GetCommandOpCode() : OpCode::NONE;
+    } else if (event.GetEventCode() == EventCode::COMMAND_STATUS) {
+      auto view = CommandStatusView::Create(event);
+      op_code = view.IsValid() ? view.GetCommandOpCode() : OpCode::NONE;
+    }
+    auto waiting_command = find_waiting_command(op_code);
+    if (op_code == OpCode::NONE || waiting_command == waiting_commands_.end()) {
+      return waiting_commands_.front().command_view;
+    }
+    return waiting_command->command_view;
+  }
+
   void on_hardware_error(EventView event) {
     HardwareErrorView event_view = HardwareErrorView::Create(event);
     log::assert_that(event_view.IsValid(), "assert failed: event_view.IsValid()");
@@ -508,14 +586,18 @@ struct HciLayer::impl {
 
   // Command Handling
   std::list<CommandQueueEntry> command_queue_;
+  // Commands sent to the controller, oldest first.
+  std::list<CommandQueueEntry> waiting_commands_;
 
   std::map<EventCode, ContextualCallback<void(EventView)>> event_handlers_;
   std::map<SubeventCode, ContextualCallback<void(LeMetaEventView)>> le_event_handlers_;
   std::map<VseSubeventCode, ContextualCallback<void(VendorSpecificEventView)>> vs_event_handlers_;
 
-  OpCode waiting_command_{OpCode::NONE};
   uint8_t command_credits_{1};  // Send reset first
-  Alarm* hci_timeout_alarm_{nullptr};
+  uint8_t max_outstanding_commands_;
+  bool command_timeouts_enabled_{true};
+  // Timeout alarms of answered commands, reused for the next ones.
+  std::vector<unique_ptr<Alarm>> idle_timeout_alarms_;
   Alarm* hci_abort_alarm_{nullptr};
 
   // Acl packets
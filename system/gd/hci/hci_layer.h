@@ -127,6 +127,9 @@ public:
 
   static constexpr std::chrono::milliseconds kHciTimeoutMs = std::chrono::milliseconds(2000);
   static constexpr std::chrono::milliseconds kHciTimeoutRestartMs = std::chrono::milliseconds(5000);
+  // Commands in flight by default; bluetooth.hci.max_outstanding_commands raises
+  // it to pipeline commands when the controller grants several credits.
+  static constexpr uint8_t kMaxOutstandingCommands = 1;
 
   static const ModuleFactory Factory;
 
@@ -22,6 +22,8 @@
 #include <chrono>
 #include <future>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "common/bind.h"
 #include "hal/hci_hal_fake.h"
@@ -124,6 +126,49 @@ protected:
     ASSERT_TRUE(reset_view.IsValid());
   }
 
+  OpCode GetSentOpCode(std::chrono::milliseconds timeout = 1s) {
+    auto sent_command = hal_->GetSentCommand(timeout);
+    return sent_command.has_value() ? sent_command->GetOpCode() : OpCode::NONE;
+  }
+
+  void InjectCommandComplete(OpCode op_code, uint8_t num_hci_command_packets) {
+    hal_->InjectEvent(CommandCompleteBuilder::Create(
+            num_hci_command_packets, op_code,
+            std::make_unique<RawBuilder>(
+                    std::vector<uint8_t>{static_cast<uint8_t>(ErrorCode::SUCCESS)})));
+    sync_handler();
+  }
+
+  // Sends |num_commands| commands to a controller that answers everything it
+  // has received in one go, and returns how many such round trips it took.
+  size_t CountRoundTrips(size_t num_commands, uint8_t num_hci_command_packets) {
+    for (size_t i = 0; i < num_commands; i++) {
+      hci_->EnqueueCommand(ReadLocalNameBuilder::Create(),
+                           hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+    }
+    sync_handler();
+
+    size_t completed = 0;
+    size_t round_trips = 0;
+    while (completed < num_commands) {
+      std::vector<OpCode> in_flight;
+      for (OpCode op_code = GetSentOpCode(); op_code != OpCode::NONE;
+           op_code = GetSentOpCode(20ms)) {
+        in_flight.push_back(op_code);
+      }
+      if (in_flight.empty()) {
+        break;
+      }
+      for (auto op_code : in_flight) {
+        InjectCommandComplete(op_code, num_hci_command_packets);
+      }
+      completed += in_flight.size();
+      round_trips++;
+    }
+    EXPECT_EQ(completed, num_commands);
+    return round_trips;
+  }
+
   void sync_handler() {
     log::assert_that(fake_registry_.GetTestThread().GetReactor()->WaitForIdle(2s),
                      "assert failed: fake_registry_.GetTestThread().GetReactor()->WaitForIdle(2s)");
@@ -137,6 +182,25 @@ protected:
 
 class HciLayerDeathTest : public HciLayerTest {};
 
+class HciLayerPipelineTest : public HciLayerTest {
+protected:
+  static constexpr uint8_t kMaxOutstandingCommands = 4;
+
+  void SetUp() override {
+    ASSERT_TRUE(os::SetSystemProperty("bluetooth.hci.max_outstanding_commands",
+                                      std::to_string(kMaxOutstandingCommands)));
+    HciLayerTest::SetUp();
+    FailIfResetNotSent();
+    hal_->InjectEvent(ResetCompleteBuilder::Create(kMaxOutstandingCommands, ErrorCode::SUCCESS));
+    sync_handler();
+  }
+
+  void TearDown() override {
+    HciLayerTest::TearDown();
+    os::ClearSystemPropertiesForHost();
+  }
+};
+
 TEST_F(HciLayerTest, setup_teardown) {}
 
 TEST_F(HciLayerTest, reset_command_sent_on_start) { FailIfResetNotSent(); }
@@ -504,5 +568,111 @@ TEST_F(HciLayerTest, command_status_callback_is_invoked_with_failure_status) {
   sync_handler();
 }
 
+TEST_F(HciLayerPipelineTest, commands_are_pipelined_up_to_the_command_credits) {
+  for (int i = 0; i < kMaxOutstandingCommands + 2; i++) {
+    hci_->EnqueueCommand(ReadLocalNameBuilder::Create(),
+                         hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  }
+  sync_handler();
+
+  for (int i = 0; i < kMaxOutstandingCommands; i++) {
+    ASSERT_EQ(OpCode::READ_LOCAL_NAME, GetSentOpCode());
+  }
+  ASSERT_EQ(OpCode::NONE, GetSentOpCode(20ms));
+
+  // The controller only has room for one more command.
+  InjectCommandComplete(OpCode::READ_LOCAL_NAME, 1);
+  ASSERT_EQ(OpCode::READ_LOCAL_NAME, GetSentOpCode());
+  ASSERT_EQ(OpCode::NONE, GetSentOpCode(20ms));
+
+  InjectCommandComplete(OpCode::READ_LOCAL_NAME, kMaxOutstandingCommands);
+  ASSERT_EQ(OpCode::READ_LOCAL_NAME, GetSentOpCode());
+  ASSERT_EQ(OpCode::NONE, GetSentOpCode(20ms));
+}
+
+TEST_F(HciLayerPipelineTest, responses_are_matched_by_op_code) {
+  std::vector<OpCode> completed;
+  auto on_complete = [](std::vector<OpCode>* completed, CommandCompleteView view) {
+    ASSERT_TRUE(view.IsValid());
+    completed->push_back(view.GetCommandOpCode());
+  };
+  hci_->EnqueueCommand(ReadLocalNameBuilder::Create(),
+                       hci_handler_->BindOnce(on_complete, &completed));
+  hci_->EnqueueCommand(ReadBdAddrBuilder::Create(),
+                       hci_handler_->BindOnce(on_complete, &completed));
+  sync_handler();
+  ASSERT_EQ(OpCode::READ_LOCAL_NAME, GetSentOpCode());
+  ASSERT_EQ(OpCode::READ_BD_ADDR, GetSentOpCode());
+
+  InjectCommandComplete(OpCode::READ_BD_ADDR, kMaxOutstandingCommands);
+  InjectCommandComplete(OpCode::READ_LOCAL_NAME, kMaxOutstandingCommands);
+
+  ASSERT_EQ(std::vector<OpCode>({OpCode::READ_BD_ADDR, OpCode::READ_LOCAL_NAME}), completed);
+}
+
+TEST_F(HciLayerPipelineTest, barrier_command_is_not_pipelined) {
+  hci_->EnqueueCommand(ReadLocalNameBuilder::Create(),
+                       hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  hci_->EnqueueCommand(ReadBdAddrBuilder::Create(),
+                       hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  hci_->EnqueueCommand(LeSetRandomAddressBuilder::Create(Address({1, 2, 3, 4, 5, 0xc6})),
+                       hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  hci_->EnqueueCommand(ReadLocalVersionInformationBuilder::Create(),
+                       hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  sync_handler();
+
+  ASSERT_EQ(OpCode::READ_LOCAL_NAME, GetSentOpCode());
+  ASSERT_EQ(OpCode::READ_BD_ADDR, GetSentOpCode());
+  ASSERT_EQ(OpCode::NONE, GetSentOpCode(20ms));
+
+  InjectCommandComplete(OpCode::READ_LOCAL_NAME, kMaxOutstandingCommands);
+  ASSERT_EQ(OpCode::NONE, GetSentOpCode(20ms));
+  InjectCommandComplete(OpCode::READ_BD_ADDR, kMaxOutstandingCommands);
+  ASSERT_EQ(OpCode::LE_SET_RANDOM_ADDRESS, GetSentOpCode());
+  ASSERT_EQ(OpCode::NONE, GetSentOpCode(20ms));
+
+  InjectCommandComplete(OpCode::LE_SET_RANDOM_ADDRESS, kMaxOutstandingCommands);
+  ASSERT_EQ(OpCode::READ_LOCAL_VERSION_INFORMATION, GetSentOpCode());
+}
+
+TEST_F(HciLayerPipelineTest, each_command_has_its_own_timeout) {
+  auto half_timeout = getHciTimeoutMs().count() / 2;
+  hci_->EnqueueCommand(ReadLocalNameBuilder::Create(),
+                       hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  sync_handler();
+  ASSERT_EQ(OpCode::READ_LOCAL_NAME, GetSentOpCode());
+
+  FakeTimerAdvance(half_timeout);
+  sync_handler();
+  hci_->EnqueueCommand(ReadBdAddrBuilder::Create(),
+                       hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  sync_handler();
+  ASSERT_EQ(OpCode::READ_BD_ADDR, GetSentOpCode());
+  InjectCommandComplete(OpCode::READ_LOCAL_NAME, kMaxOutstandingCommands);
+
+  // Past the first command's deadline, but not the second's.
+  FakeTimerAdvance(half_timeout + 1);
+  sync_handler();
+  ASSERT_EQ(OpCode::NONE, GetSentOpCode(20ms));
+
+  FakeTimerAdvance(half_timeout);
+  sync_handler();
+  ASSERT_EQ(OpCode::CONTROLLER_DEBUG_INFO, GetSentOpCode());
+}
+
+TEST_F(HciLayerTest, command_round_trips_without_pipelining) {
+  FailIfResetNotSent();
+  hal_->InjectEvent(ResetCompleteBuilder::Create(4, ErrorCode::SUCCESS));
+  sync_handler();
+
+  ASSERT_EQ(32u, CountRoundTrips(32, 4));
+}
+
+TEST_F(HciLayerPipelineTest, command_round_trips_with_pipelining) {
+  auto round_trips = CountRoundTrips(32, kMaxOutstandingCommands);
+  log::info("32 commands completed in {} round trips", round_trips);
+  ASSERT_EQ(32u / kMaxOutstandingCommands, round_trips);
+}
+
 }  // namespace hci
 }  // namespace bluetooth
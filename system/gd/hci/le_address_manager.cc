@@ -19,15 +19,22 @@
 #include <bluetooth/log.h>
 #include <com_android_bluetooth_flags.h>
 
+#include <algorithm>
+
 #include "hci/octets.h"
 #include "include/macros.h"
 #include "os/rand.h"
+#include "os/system_properties.h"
 
 namespace bluetooth {
 namespace hci {
 
 static constexpr uint8_t BLE_ADDR_MASK = 0xc0u;
 
+// Writes the changes of the filter accept list and the resolving list in bulk, once per pause of
+// the clients, rather than one device at a time.
+static const std::string kPropertyBulkFilterListSync = "bluetooth.le.bulk_filter_list_sync";
+
 enum class LeAddressManager::ClientState {
   WAITING_FOR_PAUSE,
   PAUSED,
@@ -64,7 +71,9 @@ LeAddressManager::LeAddressManager(
       handler_(handler),
       public_address_(public_address),
       accept_list_size_(accept_list_size),
-      resolving_list_size_(resolving_list_size) {}
+      resolving_list_size_(resolving_list_size),
+      bulk_filter_list_sync_(os::GetSystemPropertyBool(kPropertyBulkFilterListSync, false)),
+      filter_lists_(accept_list_size, resolving_list_size) {}
 
 LeAddressManager::~LeAddressManager() {
   if (address_rotation_wake_alarm_ != nullptr) {
@@ -563,6 +572,8 @@ void LeAddressManager::handle_next_command() {
               rotate_random_address();
             } else if constexpr (std::is_same_v<T, HCICommand>) {
               enqueue_command_.Run(std::move(command.command));
+            } else if constexpr (std::is_same_v<T, SyncFilterListsCommand>) {
+              sync_filter_lists();
             } else {
               static_assert(!sizeof(T*), "non-exhaustive visitor!");
             }
@@ -571,7 +582,13 @@ void LeAddressManager::handle_next_command() {
 }
 
 void LeAddressManager::AddDeviceToFilterAcceptList(
-        FilterAcceptListAddressType accept_list_address_type, bluetooth::hci::Address address) {
+        FilterAcceptListAddressType accept_list_address_type, bluetooth::hci::Address address,
+        FilterListPriority priority) {
+  if (bulk_filter_list_sync_) {
+    handler_->CallOn(this, &LeAddressManager::add_to_filter_accept_list, accept_list_address_type,
+                     address, priority);
+    return;
+  }
   auto packet_builder =
           hci::LeAddDeviceToFilterAcceptListBuilder::Create(accept_list_address_type, address);
   Command command = {CommandType::ADD_DEVICE_TO_ACCEPT_LIST, HCICommand{std::move(packet_builder)}};
@@ -585,6 +602,11 @@ void LeAddressManager::AddDeviceToResolvingList(PeerAddressType peer_identity_ad
   if (!supports_ble_privacy_) {
     return;
   }
+  if (bulk_filter_list_sync_) {
+    handler_->CallOn(this, &LeAddressManager::add_to_resolving_list, peer_identity_address_type,
+                     peer_identity_address, peer_irk, local_irk);
+    return;
+  }
 
   // Disable Address resolution
   auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
@@ -620,6 +642,11 @@ void LeAddressManager::AddDeviceToResolvingList(PeerAddressType peer_identity_ad
 
 void LeAddressManager::RemoveDeviceFromFilterAcceptList(
         FilterAcceptListAddressType accept_list_address_type, bluetooth::hci::Address address) {
+  if (bulk_filter_list_sync_) {
+    handler_->CallOn(this, &LeAddressManager::remove_from_filter_accept_list,
+                     accept_list_address_type, address);
+    return;
+  }
   auto packet_builder =
           hci::LeRemoveDeviceFromFilterAcceptListBuilder::Create(accept_list_address_type, address);
   Command command = {CommandType::REMOVE_DEVICE_FROM_ACCEPT_LIST,
@@ -627,11 +654,25 @@ void LeAddressManager::RemoveDeviceFromFilterAcceptList(
   handler_->BindOnceOn(this, &LeAddressManager::push_command, std::move(command))();
 }
 
+void LeAddressManager::SetFilterAcceptListPriority(
+        FilterAcceptListAddressType accept_list_address_type, bluetooth::hci::Address address,
+        FilterListPriority priority) {
+  if (bulk_filter_list_sync_) {
+    handler_->CallOn(this, &LeAddressManager::set_filter_accept_list_priority,
+                     accept_list_address_type, address, priority);
+  }
+}
+
 void LeAddressManager::RemoveDeviceFromResolvingList(PeerAddressType peer_identity_address_type,
                                                      Address peer_identity_address) {
   if (!supports_ble_privacy_) {
     return;
   }
+  if (bulk_filter_list_sync_) {
+    handler_->CallOn(this, &LeAddressManager::remove_from_resolving_list,
+                     peer_identity_address_type, peer_identity_address);
+    return;
+  }
 
   // Disable Address resolution
   auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
@@ -659,6 +700,10 @@ void LeAddressManager::RemoveDeviceFromResolvingList(PeerAddressType peer_identi
 }
 
 void LeAddressManager::ClearFilterAcceptList() {
+  if (bulk_filter_list_sync_) {
+    handler_->CallOn(this, &LeAddressManager::clear_filter_accept_list);
+    return;
+  }
   auto packet_builder = hci::LeClearFilterAcceptListBuilder::Create();
   Command command = {CommandType::CLEAR_ACCEPT_LIST, HCICommand{std::move(packet_builder)}};
   handler_->BindOnceOn(this, &LeAddressManager::push_command, std::move(command))();
@@ -668,6 +713,10 @@ void LeAddressManager::ClearResolvingList() {
   if (!supports_ble_privacy_) {
     return;
   }
+  if (bulk_filter_list_sync_) {
+    handler_->CallOn(this, &LeAddressManager::clear_resolving_list);
+    return;
+  }
 
   // Disable Address resolution
   auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
@@ -688,20 +737,217 @@ void LeAddressManager::ClearResolvingList() {
   handler_->BindOnceOn(this, &LeAddressManager::pause_registered_clients)();
 }
 
+std::optional<AddressWithType> LeAddressManager::ResolveOnHost(const Address& address) {
+  std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+  return filter_lists_.ResolveOnHost(address);
+}
+
+void LeAddressManager::add_to_filter_accept_list(
+        FilterAcceptListAddressType accept_list_address_type, Address address,
+        FilterListPriority priority) {
+  {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    filter_lists_.AddToAcceptList(accept_list_address_type, address, priority);
+  }
+  schedule_filter_list_sync();
+}
+
+void LeAddressManager::remove_from_filter_accept_list(
+        FilterAcceptListAddressType accept_list_address_type, Address address) {
+  {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    filter_lists_.RemoveFromAcceptList(accept_list_address_type, address);
+  }
+  schedule_filter_list_sync();
+}
+
+void LeAddressManager::set_filter_accept_list_priority(
+        FilterAcceptListAddressType accept_list_address_type, Address address,
+        FilterListPriority priority) {
+  {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    filter_lists_.SetAcceptListPriority(accept_list_address_type, address, priority);
+    // The clients are not paused for a priority that changes nothing in the controller.
+    if (!filter_lists_.HasChanges()) {
+      return;
+    }
+  }
+  schedule_filter_list_sync();
+}
+
+void LeAddressManager::clear_filter_accept_list() {
+  {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    filter_lists_.ClearAcceptList();
+  }
+  schedule_filter_list_sync();
+}
+
+void LeAddressManager::add_to_resolving_list(PeerAddressType peer_identity_address_type,
+                                             Address peer_identity_address,
+                                             const Octet16& peer_irk, const Octet16& local_irk) {
+  {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    filter_lists_.AddToResolvingList(peer_identity_address_type, peer_identity_address, peer_irk,
+                                     local_irk, FilterListPriority::BACKGROUND);
+  }
+  schedule_filter_list_sync();
+}
+
+void LeAddressManager::remove_from_resolving_list(PeerAddressType peer_identity_address_type,
+                                                  Address peer_identity_address) {
+  {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    filter_lists_.RemoveFromResolvingList(peer_identity_address_type, peer_identity_address);
+  }
+  schedule_filter_list_sync();
+}
+
+void LeAddressManager::clear_resolving_list() {
+  {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    filter_lists_.ClearResolvingList();
+  }
+  schedule_filter_list_sync();
+}
+
+void LeAddressManager::schedule_filter_list_sync() {
+  // Changes made before the sync runs, or while it runs, are written by it.
+  if (filter_list_sync_scheduled_) {
+    return;
+  }
+  filter_list_sync_scheduled_ = true;
+  Command command = {CommandType::SYNC_FILTER_LISTS, SyncFilterListsCommand{}};
+  cached_commands_.push(std::move(command));
+  if (registered_clients_.empty()) {
+    handle_next_command();
+  } else {
+    pause_registered_clients();
+  }
+}
+
+void LeAddressManager::sync_filter_lists() {
+  LeFilterListReconciler::Changes changes;
+  size_t accept_list_overflows;
+  size_t host_resolved_devices;
+  {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    changes = filter_lists_.Reconcile();
+    accept_list_overflows = filter_lists_.GetNumberOfAcceptListOverflows();
+    host_resolved_devices = filter_lists_.GetNumberOfHostResolvedDevices();
+  }
+  if (changes.IsEmpty()) {
+    filter_list_sync_scheduled_ = false;
+    check_cached_commands();
+    return;
+  }
+
+  // All the commands are sent at once, and the clients stay paused until the last one completes.
+  if (changes.ResolvingListChanged()) {
+    send_filter_list_command(
+            hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED),
+            {OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE, {}});
+  }
+  if (changes.clear_accept_list) {
+    send_filter_list_command(hci::LeClearFilterAcceptListBuilder::Create(),
+                             {OpCode::LE_CLEAR_FILTER_ACCEPT_LIST, {}});
+  }
+  for (const auto& entry : changes.accept_list_removals) {
+    send_filter_list_command(
+            hci::LeRemoveDeviceFromFilterAcceptListBuilder::Create(entry.address_type,
+                                                                   entry.address),
+            {OpCode::LE_REMOVE_DEVICE_FROM_FILTER_ACCEPT_LIST, {}});
+  }
+  for (const auto& entry : changes.accept_list_additions) {
+    send_filter_list_command(
+            hci::LeAddDeviceToFilterAcceptListBuilder::Create(entry.address_type, entry.address),
+            {OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST, entry});
+  }
+  if (changes.clear_resolving_list) {
+    send_filter_list_command(hci::LeClearResolvingListBuilder::Create(),
+                             {OpCode::LE_CLEAR_RESOLVING_LIST, {}});
+  }
+  for (const auto& entry : changes.resolving_list_removals) {
+    send_filter_list_command(
+            hci::LeRemoveDeviceFromResolvingListBuilder::Create(entry.address_type, entry.address),
+            {OpCode::LE_REMOVE_DEVICE_FROM_RESOLVING_LIST, {}});
+  }
+  for (const auto& entry : changes.resolving_list_additions) {
+    send_filter_list_command(
+            hci::LeAddDeviceToResolvingListBuilder::Create(entry.address_type, entry.address,
+                                                           entry.peer_irk, entry.local_irk),
+            {OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST, entry});
+    send_filter_list_command(hci::LeSetPrivacyModeBuilder::Create(
+                                     entry.address_type, entry.address, PrivacyMode::DEVICE),
+                             {OpCode::LE_SET_PRIVACY_MODE, {}});
+  }
+  if (changes.ResolvingListChanged()) {
+    send_filter_list_command(hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED),
+                             {OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE, {}});
+  }
+  log::info("Sent {} filter list commands, {} devices left out of the accept list, {} resolved by "
+            "the host",
+            filter_list_commands_.size(), accept_list_overflows, host_resolved_devices);
+}
+
+void LeAddressManager::send_filter_list_command(std::unique_ptr<CommandBuilder> command,
+                                                FilterListCommand entry) {
+  filter_list_commands_.push_back(std::move(entry));
+  enqueue_command_.Run(std::move(command));
+}
+
+void LeAddressManager::on_filter_list_command_complete(OpCode op_code, ErrorCode status) {
+  auto command = std::find_if(
+          filter_list_commands_.begin(), filter_list_commands_.end(),
+          [op_code](const FilterListCommand& command) { return command.op_code == op_code; });
+  if (command == filter_list_commands_.end()) {
+    log::warn("Received {} complete while syncing the filter lists", OpCodeText(op_code));
+    return;
+  }
+  if (status != ErrorCode::SUCCESS) {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    using AcceptListEntry = LeFilterListReconciler::AcceptListEntry;
+    using ResolvingListEntry = LeFilterListReconciler::ResolvingListEntry;
+    if (auto entry = std::get_if<AcceptListEntry>(&command->addition)) {
+      filter_lists_.OnAcceptListAdditionFailed(*entry, status);
+    } else if (auto entry = std::get_if<ResolvingListEntry>(&command->addition)) {
+      filter_lists_.OnResolvingListAdditionFailed(*entry, status);
+    }
+  }
+  filter_list_commands_.erase(command);
+  if (!filter_list_commands_.empty()) {
+    return;
+  }
+
+  // The changes made while the commands were sent are written before the clients resume.
+  bool has_changes;
+  {
+    std::lock_guard<std::mutex> lock(filter_lists_mutex_);
+    has_changes = filter_lists_.HasChanges();
+  }
+  if (has_changes) {
+    sync_filter_lists();
+    return;
+  }
+  filter_list_sync_scheduled_ = false;
+  check_cached_commands();
+}
+
 template <class View>
-void LeAddressManager::on_command_complete(CommandCompleteView view) {
+ErrorCode LeAddressManager::on_command_complete(CommandCompleteView view) {
   auto op_code = view.GetCommandOpCode();
 
   auto complete_view = View::Create(view);
   if (!complete_view.IsValid()) {
     log::error("Received {} complete with invalid packet", hci::OpCodeText(op_code));
-    return;
+    return ErrorCode::UNSPECIFIED_ERROR;
   }
   auto status = complete_view.GetStatus();
   if (status != ErrorCode::SUCCESS) {
     log::error("Received {} complete with status {}", hci::OpCodeText(op_code),
                ErrorCodeText(complete_view.GetStatus()));
   }
+  return status;
 }
 
 void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView view) {
@@ -712,6 +958,7 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
   auto op_code = view.GetCommandOpCode();
   log::info("Received command complete with op_code {}", OpCodeText(op_code));
 
+  ErrorCode status = ErrorCode::SUCCESS;
   switch (op_code) {
     case OpCode::LE_SET_RANDOM_ADDRESS: {
       // The command was sent before any client registered, we can make sure all the clients paused
@@ -737,35 +984,35 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
     } break;
 
     case OpCode::LE_SET_PRIVACY_MODE:
-      on_command_complete<LeSetPrivacyModeCompleteView>(view);
+      status = on_command_complete<LeSetPrivacyModeCompleteView>(view);
       break;
 
     case OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST:
-      on_command_complete<LeAddDeviceToResolvingListCompleteView>(view);
+      status = on_command_complete<LeAddDeviceToResolvingListCompleteView>(view);
       break;
 
     case OpCode::LE_REMOVE_DEVICE_FROM_RESOLVING_LIST:
-      on_command_complete<LeRemoveDeviceFromResolvingListCompleteView>(view);
+      status = on_command_complete<LeRemoveDeviceFromResolvingListCompleteView>(view);
       break;
 
     case OpCode::LE_CLEAR_RESOLVING_LIST:
-      on_command_complete<LeClearResolvingListCompleteView>(view);
+      status = on_command_complete<LeClearResolvingListCompleteView>(view);
       break;
 
     case OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST:
-      on_command_complete<LeAddDeviceToFilterAcceptListCompleteView>(view);
+      status = on_command_complete<LeAddDeviceToFilterAcceptListCompleteView>(view);
       break;
 
     case OpCode::LE_REMOVE_DEVICE_FROM_FILTER_ACCEPT_LIST:
-      on_command_complete<LeRemoveDeviceFromFilterAcceptListCompleteView>(view);
+      status = on_command_complete<LeRemoveDeviceFromFilterAcceptListCompleteView>(view);
       break;
 
     case OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE:
-      on_command_complete<LeSetAddressResolutionEnableCompleteView>(view);
+      status = on_command_complete<LeSetAddressResolutionEnableCompleteView>(view);
       break;
 
     case OpCode::LE_CLEAR_FILTER_ACCEPT_LIST:
-      on_command_complete<LeClearFilterAcceptListCompleteView>(view);
+      status = on_command_complete<LeClearFilterAcceptListCompleteView>(view);
       break;
 
     default:
@@ -773,6 +1020,10 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
       break;
   }
 
+  if (!filter_list_commands_.empty()) {
+    on_filter_list_command_complete(op_code, status);
+    return;
+  }
   handler_->BindOnceOn(this, &LeAddressManager::check_cached_commands)();
 }
 
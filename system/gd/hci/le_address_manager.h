@@ -17,11 +17,15 @@
 
 #include <bluetooth/log.h>
 
+#include <deque>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <variant>
 
 #include "common/callback.h"
 #include "hci/address_with_type.h"
+#include "hci/le_filter_list_reconciler.h"
 #include "hci/octets.h"
 #include "os/alarm.h"
 
@@ -85,17 +89,24 @@ public:
   uint8_t GetFilterAcceptListSize();
   uint8_t GetResolvingListSize();
   void AddDeviceToFilterAcceptList(FilterAcceptListAddressType accept_list_address_type,
-                                   Address address);
+                                   Address address,
+                                   FilterListPriority priority = FilterListPriority::BACKGROUND);
   void AddDeviceToResolvingList(PeerAddressType peer_identity_address_type,
                                 Address peer_identity_address,
                                 const std::array<uint8_t, 16>& peer_irk,
                                 const std::array<uint8_t, 16>& local_irk);
   void RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType accept_list_address_type,
                                         Address address);
+  // Only used with bulk sync, the filter accept list of the controller has no priorities.
+  void SetFilterAcceptListPriority(FilterAcceptListAddressType accept_list_address_type,
+                                   Address address, FilterListPriority priority);
   void RemoveDeviceFromResolvingList(PeerAddressType peer_identity_address_type,
                                      Address peer_identity_address);
   void ClearFilterAcceptList();
   void ClearResolvingList();
+  // Returns the identity address of a device left out of the resolving list of the controller,
+  // when the address is one of its resolvable private addresses. Can be called from any thread.
+  std::optional<AddressWithType> ResolveOnHost(const Address& address);
   void OnCommandComplete(CommandCompleteView view);
   std::chrono::milliseconds GetNextPrivateAddressIntervalMs();
   PrivateAddressIntervalRange GetNextPrivateAddressIntervalRange();
@@ -123,10 +134,14 @@ private:
     SET_ADDRESS_RESOLUTION_ENABLE,
     LE_SET_PRIVACY_MODE,
     UPDATE_IRK,
+    SYNC_FILTER_LISTS,
   };
 
   struct RotateRandomAddressCommand {};
 
+  // Brings the filter accept list and the resolving list of the controller up to date.
+  struct SyncFilterListsCommand {};
+
   struct UpdateIRKCommand {
     Octet16 rotation_irk;
     std::chrono::milliseconds minimum_rotation_time;
@@ -140,7 +155,16 @@ private:
   struct Command {
     CommandType
             command_type;  // Note that this field is only intended for logging, not control flow
-    std::variant<RotateRandomAddressCommand, UpdateIRKCommand, HCICommand> contents;
+    std::variant<RotateRandomAddressCommand, UpdateIRKCommand, HCICommand, SyncFilterListsCommand>
+            contents;
+  };
+
+  // A filter list command sent to the controller, and the entry it adds, if any.
+  struct FilterListCommand {
+    OpCode op_code;
+    std::variant<std::monostate, LeFilterListReconciler::AcceptListEntry,
+                 LeFilterListReconciler::ResolvingListEntry>
+            addition;
   };
 
   void pause_registered_clients();
@@ -160,8 +184,25 @@ private:
   hci::Address generate_nrpa();
   void handle_next_command();
   void check_cached_commands();
+  void add_to_filter_accept_list(FilterAcceptListAddressType accept_list_address_type,
+                                 Address address, FilterListPriority priority);
+  void remove_from_filter_accept_list(FilterAcceptListAddressType accept_list_address_type,
+                                      Address address);
+  void set_filter_accept_list_priority(FilterAcceptListAddressType accept_list_address_type,
+                                       Address address, FilterListPriority priority);
+  void clear_filter_accept_list();
+  void add_to_resolving_list(PeerAddressType peer_identity_address_type,
+                             Address peer_identity_address, const Octet16& peer_irk,
+                             const Octet16& local_irk);
+  void remove_from_resolving_list(PeerAddressType peer_identity_address_type,
+                                  Address peer_identity_address);
+  void clear_resolving_list();
+  void schedule_filter_list_sync();
+  void sync_filter_lists();
+  void send_filter_list_command(std::unique_ptr<CommandBuilder> command, FilterListCommand entry);
+  void on_filter_list_command_complete(OpCode op_code, ErrorCode status);
   template <class View>
-  void on_command_complete(CommandCompleteView view);
+  ErrorCode on_command_complete(CommandCompleteView view);
 
   common::Callback<void(std::unique_ptr<CommandBuilder>)> enqueue_command_;
   os::Handler* handler_;
@@ -177,6 +218,15 @@ private:
   uint8_t resolving_list_size_;
   std::queue<Command> cached_commands_;
   bool supports_ble_privacy_{false};
+
+  // With bulk sync, the filter lists are kept by the reconciler, and all the changes made while
+  // the clients pause are written at once.
+  bool bulk_filter_list_sync_;
+  bool filter_list_sync_scheduled_{false};
+  std::deque<FilterListCommand> filter_list_commands_;
+  // Guards filter_lists_, which resolves addresses for other modules.
+  std::mutex filter_lists_mutex_;
+  LeFilterListReconciler filter_lists_;
 };
 
 }  // namespace hci
@@ -18,8 +18,10 @@
 
 #include <gtest/gtest.h>
 
+#include "crypto_toolbox/crypto_toolbox.h"
 #include "hci/hci_layer_fake.h"
 #include "hci/octets.h"
+#include "os/system_properties.h"
 #include "packet/raw_builder.h"
 
 using ::bluetooth::hci::Octet16;
@@ -452,6 +454,185 @@ TEST_F(LeAddressManagerWithSingleClientTest, register_during_command_complete) {
   clients[1].get()->WaitForResume();
 }
 
+// Acknowledges the pause only when asked, so that several changes are made while it pauses.
+class DeferredPauseClient : public RotatorClient {
+public:
+  using RotatorClient::RotatorClient;
+
+  void OnPause() override { paused = true; }
+};
+
+class LeAddressManagerBulkSyncTest : public LeAddressManagerTest {
+public:
+  void SetUp() override {
+    os::SetSystemProperty("bluetooth.le.bulk_filter_list_sync", "true");
+    thread_ = new Thread("thread", Thread::Priority::NORMAL);
+    handler_ = new Handler(thread_);
+    hci_layer_ = new HciLayerFake();
+    Address address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06});
+    le_address_manager_ = new LeAddressManager(
+            common::Bind(&LeAddressManagerBulkSyncTest::enqueue_command, common::Unretained(this)),
+            handler_, address, 0x3F, 0x01);
+    client_ = std::make_unique<DeferredPauseClient>(le_address_manager_, 0);
+
+    Octet16 irk = {0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05,
+                   0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b};
+    AddressWithType remote_address(Address::kEmpty, AddressType::RANDOM_DEVICE_ADDRESS);
+    // The address doesn't rotate during the tests.
+    le_address_manager_->SetPrivacyPolicyForInitiatorAddress(
+            LeAddressManager::AddressPolicy::USE_RESOLVABLE_ADDRESS, remote_address, irk, true,
+            std::chrono::minutes(10), std::chrono::minutes(20));
+
+    le_address_manager_->Register(client_.get());
+    sync_handler(handler_);
+    hci_layer_->GetCommand(OpCode::LE_SET_RANDOM_ADDRESS);
+    hci_layer_->IncomingEvent(LeSetRandomAddressCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+    sync_handler(handler_);
+  }
+
+  void enqueue_command(std::unique_ptr<CommandBuilder> command_packet) {
+    hci_layer_->EnqueueCommand(std::move(command_packet),
+                               handler_->BindOnce(&LeAddressManager::OnCommandComplete,
+                                                  common::Unretained(le_address_manager_)));
+  }
+
+  void TearDown() override {
+    le_address_manager_->Unregister(client_.get());
+    sync_handler(handler_);
+    delete le_address_manager_;
+    delete hci_layer_;
+    handler_->Clear();
+    delete handler_;
+    delete thread_;
+    os::ClearSystemPropertiesForHost();
+  }
+
+  void AckPause() {
+    sync_handler(handler_);
+    ASSERT_TRUE(client_->paused);
+    le_address_manager_->AckPause(client_.get());
+  }
+
+  Address GetAddedDevice() {
+    auto packet = hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+    auto packet_view = LeAddDeviceToFilterAcceptListView::Create(
+            LeConnectionManagementCommandView::Create(AclCommandView::Create(packet)));
+    EXPECT_TRUE(packet_view.IsValid());
+    return packet_view.GetAddress();
+  }
+
+  std::unique_ptr<DeferredPauseClient> client_;
+};
+
+TEST_F(LeAddressManagerBulkSyncTest, accept_list_changes_are_sent_in_one_pause) {
+  Address first({0x01, 0x00, 0x00, 0x00, 0x00, 0x00});
+  Address second({0x02, 0x00, 0x00, 0x00, 0x00, 0x00});
+  Address third({0x03, 0x00, 0x00, 0x00, 0x00, 0x00});
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, first);
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, second);
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::PUBLIC, third);
+  AckPause();
+
+  ASSERT_EQ(GetAddedDevice(), first);
+  ASSERT_EQ(GetAddedDevice(), second);
+  ASSERT_EQ(GetAddedDevice(), third);
+  hci_layer_->AssertNoQueuedCommand();
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(client_->paused);
+    hci_layer_->IncomingEvent(
+            LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+    sync_handler(handler_);
+  }
+  client_->WaitForResume();
+  ASSERT_FALSE(client_->paused);
+}
+
+TEST_F(LeAddressManagerBulkSyncTest, changes_cancel_out) {
+  Address address({0x01, 0x00, 0x00, 0x00, 0x00, 0x00});
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+  le_address_manager_->RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType::RANDOM,
+                                                        address);
+  AckPause();
+  client_->WaitForResume();
+  hci_layer_->AssertNoQueuedCommand();
+}
+
+TEST_F(LeAddressManagerBulkSyncTest, changes_during_sync_are_sent_before_resume) {
+  Address first({0x01, 0x00, 0x00, 0x00, 0x00, 0x00});
+  Address second({0x02, 0x00, 0x00, 0x00, 0x00, 0x00});
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, first);
+  AckPause();
+  ASSERT_EQ(GetAddedDevice(), first);
+
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, second);
+  sync_handler(handler_);
+  hci_layer_->IncomingEvent(
+          LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  ASSERT_EQ(GetAddedDevice(), second);
+  ASSERT_TRUE(client_->paused);
+  hci_layer_->IncomingEvent(
+          LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  client_->WaitForResume();
+}
+
+TEST_F(LeAddressManagerBulkSyncTest, resolving_list_overflow_is_resolved_on_host) {
+  Address first({0x01, 0x00, 0x00, 0x00, 0x00, 0x00});
+  Address second({0x02, 0x00, 0x00, 0x00, 0x00, 0x00});
+  Octet16 first_irk;
+  first_irk.fill(0x01);
+  Octet16 second_irk;
+  second_irk.fill(0x02);
+  Octet16 local_irk = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+                       0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10};
+  le_address_manager_->AddDeviceToResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS,
+                                                first, first_irk, local_irk);
+  le_address_manager_->AddDeviceToResolvingList(PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS,
+                                                second, second_irk, local_irk);
+  AckPause();
+
+  // Address resolution is disabled once around all the changes.
+  {
+    auto packet = hci_layer_->GetCommand(OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE);
+    auto packet_view =
+            LeSetAddressResolutionEnableView::Create(LeSecurityCommandView::Create(packet));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(Enable::DISABLED, packet_view.GetAddressResolutionEnable());
+  }
+  {
+    auto packet = hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST);
+    auto packet_view =
+            LeAddDeviceToResolvingListView::Create(LeSecurityCommandView::Create(packet));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(first, packet_view.GetPeerIdentityAddress());
+  }
+  hci_layer_->GetCommand(OpCode::LE_SET_PRIVACY_MODE);
+  {
+    auto packet = hci_layer_->GetCommand(OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE);
+    auto packet_view =
+            LeSetAddressResolutionEnableView::Create(LeSecurityCommandView::Create(packet));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(Enable::ENABLED, packet_view.GetAddressResolutionEnable());
+  }
+  hci_layer_->AssertNoQueuedCommand();
+  hci_layer_->IncomingEvent(
+          LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  hci_layer_->IncomingEvent(
+          LeAddDeviceToResolvingListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  hci_layer_->IncomingEvent(LeSetPrivacyModeCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  hci_layer_->IncomingEvent(
+          LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  client_->WaitForResume();
+
+  // The second device doesn't fit in the resolving list of the controller.
+  Octet16 prand = {0x12, 0x34, 0x56};
+  Octet16 hash = crypto_toolbox::aes_128(second_irk, prand);
+  Address rpa({hash[0], hash[1], hash[2], prand[0], prand[1], prand[2]});
+  auto identity_address = le_address_manager_->ResolveOnHost(rpa);
+  ASSERT_TRUE(identity_address.has_value());
+  ASSERT_EQ(AddressWithType(second, AddressType::PUBLIC_IDENTITY_ADDRESS), *identity_address);
+}
+
 }  // namespace
 }  // namespace hci
 }  // namespace bluetooth
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_advertising_data_cache.h"
+
+#include <algorithm>
+
+#include "packet/bit_inserter.h"
+
+namespace bluetooth::hci {
+
+bool LeAdvertisingDataCache::Update(uint8_t advertising_handle, AdvertisingDataType type,
+                                    const std::vector<uint8_t>& payload) {
+  auto [it, inserted] = payloads_.try_emplace({advertising_handle, type}, payload);
+  if (inserted) {
+    return true;
+  }
+  if (it->second == payload) {
+    return false;
+  }
+  it->second = payload;
+  return true;
+}
+
+bool LeAdvertisingDataCache::HasData(uint8_t advertising_handle, AdvertisingDataType type) const {
+  auto it = payloads_.find({advertising_handle, type});
+  return it != payloads_.end() && !it->second.empty();
+}
+
+void LeAdvertisingDataCache::Invalidate(uint8_t advertising_handle, AdvertisingDataType type) {
+  payloads_.erase({advertising_handle, type});
+}
+
+void LeAdvertisingDataCache::Remove(uint8_t advertising_handle) {
+  payloads_.erase(payloads_.lower_bound({advertising_handle, AdvertisingDataType::ADVERTISING}),
+                  payloads_.upper_bound({advertising_handle, AdvertisingDataType::PERIODIC}));
+}
+
+std::vector<uint8_t> LeAdvertisingDataCache::Serialize(const std::vector<GapData>& data) {
+  std::vector<uint8_t> payload;
+  packet::BitInserter it(payload);
+  for (const auto& gap_data : data) {
+    gap_data.Serialize(it);
+  }
+  return payload;
+}
+
+std::vector<std::vector<uint8_t>> LeAdvertisingDataCache::Fragment(
+        const std::vector<uint8_t>& payload, size_t fragment_length) {
+  std::vector<std::vector<uint8_t>> fragments;
+  auto begin = payload.begin();
+  do {
+    auto end = begin + std::min<size_t>(fragment_length, payload.end() - begin);
+    fragments.emplace_back(begin, end);
+    begin = end;
+  } while (begin != payload.end());
+  return fragments;
+}
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "hci/hci_packets.h"
+
+namespace bluetooth::hci {
+
+enum class AdvertisingDataType : uint8_t {
+  ADVERTISING,
+  SCAN_RESPONSE,
+  PERIODIC,
+};
+
+/// Serialized payloads last written to the controller for each data type
+/// of each advertising set, so that updates with the same payload do not
+/// rewrite it.
+class LeAdvertisingDataCache {
+public:
+  /// Returns true if |payload| differs from the payload cached for the
+  /// data, and caches it. Returns false if the payload is unchanged.
+  bool Update(uint8_t advertising_handle, AdvertisingDataType type,
+              const std::vector<uint8_t>& payload);
+
+  /// Returns true if a non empty payload is cached for the data.
+  bool HasData(uint8_t advertising_handle, AdvertisingDataType type) const;
+
+  /// Forgets the payload of the data, when the controller may not hold it.
+  void Invalidate(uint8_t advertising_handle, AdvertisingDataType type);
+
+  /// Forgets all the payloads of the advertising set.
+  void Remove(uint8_t advertising_handle);
+
+  static std::vector<uint8_t> Serialize(const std::vector<GapData>& data);
+
+  /// Splits |payload| into fragments of at most |fragment_length| bytes.
+  /// An empty payload is one empty fragment.
+  static std::vector<std::vector<uint8_t>> Fragment(const std::vector<uint8_t>& payload,
+                                                    size_t fragment_length);
+
+private:
+  std::map<std::pair<uint8_t, AdvertisingDataType>, std::vector<uint8_t>> payloads_;
+};
+
+}  // namespace bluetooth::hci
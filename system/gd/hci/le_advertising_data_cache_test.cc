@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_advertising_data_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace bluetooth::hci {
+namespace {
+
+GapData MakeGapData(GapDataType type, std::vector<uint8_t> data) {
+  GapData gap_data;
+  gap_data.data_type_ = type;
+  gap_data.data_ = std::move(data);
+  return gap_data;
+}
+
+TEST(LeAdvertisingDataCacheTest, serialize) {
+  std::vector<GapData> data = {
+          MakeGapData(GapDataType::FLAGS, {0x06}),
+          MakeGapData(GapDataType::COMPLETE_LOCAL_NAME, {'a', 'b', 'c'}),
+  };
+  EXPECT_EQ(LeAdvertisingDataCache::Serialize(data),
+            std::vector<uint8_t>({0x02, 0x01, 0x06, 0x04, 0x09, 'a', 'b', 'c'}));
+  EXPECT_TRUE(LeAdvertisingDataCache::Serialize({}).empty());
+}
+
+TEST(LeAdvertisingDataCacheTest, fragment) {
+  std::vector<uint8_t> payload(503);
+  for (size_t i = 0; i < payload.size(); i++) {
+    payload[i] = static_cast<uint8_t>(i);
+  }
+  auto fragments = LeAdvertisingDataCache::Fragment(payload, 251);
+  ASSERT_EQ(fragments.size(), 3ul);
+  EXPECT_EQ(fragments[0].size(), 251ul);
+  EXPECT_EQ(fragments[1].size(), 251ul);
+  EXPECT_EQ(fragments[2].size(), 1ul);
+  EXPECT_EQ(fragments[2][0], static_cast<uint8_t>(502));
+
+  ASSERT_EQ(LeAdvertisingDataCache::Fragment(std::vector<uint8_t>(251), 251).size(), 1ul);
+
+  fragments = LeAdvertisingDataCache::Fragment({}, 251);
+  ASSERT_EQ(fragments.size(), 1ul);
+  EXPECT_TRUE(fragments[0].empty());
+}
+
+TEST(LeAdvertisingDataCacheTest, update) {
+  LeAdvertisingDataCache cache;
+  std::vector<uint8_t> payload = {0x02, 0x01, 0x06};
+  EXPECT_FALSE(cache.HasData(1, AdvertisingDataType::ADVERTISING));
+  EXPECT_TRUE(cache.Update(1, AdvertisingDataType::ADVERTISING, payload));
+  EXPECT_TRUE(cache.HasData(1, AdvertisingDataType::ADVERTISING));
+  EXPECT_FALSE(cache.Update(1, AdvertisingDataType::ADVERTISING, payload));
+
+  // The data types and the advertising sets are cached separately
+  EXPECT_TRUE(cache.Update(1, AdvertisingDataType::SCAN_RESPONSE, payload));
+  EXPECT_TRUE(cache.Update(2, AdvertisingDataType::ADVERTISING, payload));
+
+  payload[2] = 0x04;
+  EXPECT_TRUE(cache.Update(1, AdvertisingDataType::ADVERTISING, payload));
+  EXPECT_FALSE(cache.Update(1, AdvertisingDataType::ADVERTISING, payload));
+
+  EXPECT_TRUE(cache.Update(1, AdvertisingDataType::PERIODIC, {}));
+  EXPECT_FALSE(cache.Update(1, AdvertisingDataType::PERIODIC, {}));
+  EXPECT_FALSE(cache.HasData(1, AdvertisingDataType::PERIODIC));
+}
+
+TEST(LeAdvertisingDataCacheTest, invalidate) {
+  LeAdvertisingDataCache cache;
+  std::vector<uint8_t> payload = {0x02, 0x01, 0x06};
+  cache.Update(1, AdvertisingDataType::ADVERTISING, payload);
+  cache.Update(1, AdvertisingDataType::SCAN_RESPONSE, payload);
+  cache.Invalidate(1, AdvertisingDataType::ADVERTISING);
+  EXPECT_TRUE(cache.Update(1, AdvertisingDataType::ADVERTISING, payload));
+  EXPECT_FALSE(cache.Update(1, AdvertisingDataType::SCAN_RESPONSE, payload));
+}
+
+TEST(LeAdvertisingDataCacheTest, remove) {
+  LeAdvertisingDataCache cache;
+  std::vector<uint8_t> payload = {0x02, 0x01, 0x06};
+  for (uint8_t handle = 0; handle < 3; handle++) {
+    cache.Update(handle, AdvertisingDataType::ADVERTISING, payload);
+    cache.Update(handle, AdvertisingDataType::SCAN_RESPONSE, payload);
+    cache.Update(handle, AdvertisingDataType::PERIODIC, payload);
+  }
+  cache.Remove(1);
+  EXPECT_TRUE(cache.Update(1, AdvertisingDataType::ADVERTISING, payload));
+  EXPECT_TRUE(cache.Update(1, AdvertisingDataType::SCAN_RESPONSE, payload));
+  EXPECT_TRUE(cache.Update(1, AdvertisingDataType::PERIODIC, payload));
+  EXPECT_FALSE(cache.Update(0, AdvertisingDataType::PERIODIC, payload));
+  EXPECT_FALSE(cache.Update(2, AdvertisingDataType::ADVERTISING, payload));
+}
+
+}  // namespace
+}  // namespace bluetooth::hci
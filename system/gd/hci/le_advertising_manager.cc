@@ -18,9 +18,14 @@
 #include <bluetooth/log.h>
 #include <com_android_bluetooth_flags.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <tuple>
 
 #include "common/strings.h"
 #include "hardware/ble_advertiser.h"
@@ -29,9 +34,12 @@
 #include "hci/event_checkers.h"
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
+#include "hci/le_advertising_data_cache.h"
 #include "hci/le_advertising_interface.h"
+#include "hci/le_advertising_multiplexer.h"
 #include "module.h"
 #include "os/handler.h"
+#include "os/repeating_alarm.h"
 #include "os/system_properties.h"
 #include "packet/fragmenting_inserter.h"
 
@@ -49,6 +57,11 @@ constexpr int64_t kLeTxPathLossCompMax = 127;
 
 // system properties
 const std::string kLeTxPathLossCompProperty = "bluetooth.hardware.radio.le_tx_path_loss_comp_db";
+const std::string kPropertyDataCache = "bluetooth.le.adv_data_cache";
+const std::string kPropertyMultiplexedSets = "bluetooth.le.adv_multiplexed_sets";
+const std::string kPropertyMultiplexingSlice = "bluetooth.le.adv_multiplexing_slice_ms";
+
+constexpr uint32_t kDefaultMultiplexingSliceMs = 1000;
 
 enum class AdvertisingApiType {
   LEGACY = 1,
@@ -87,6 +100,23 @@ struct Advertiser {
   std::unique_ptr<os::Alarm> address_rotation_non_wake_alarm_;
 };
 
+// An advertiser created once the other advertising sets are in use, put on
+// one of the multiplexed sets for its time slices.
+struct LogicalAdvertiser {
+  AdvertisingConfig config;
+  AdvertiserAddressType address_type;
+  AddressWithType address;
+  bool rotate_address = false;
+  // The address is renewed the next time the advertiser is put on a set
+  // after this time
+  std::optional<std::chrono::steady_clock::time_point> address_expiry;
+  uint32_t parameter_group = 0;
+  bool enabled = false;
+  std::optional<std::chrono::steady_clock::time_point> enabled_until;
+  // Advertising set the advertiser is on
+  std::optional<AdvertiserId> handle;
+};
+
 /**
  * Determines the address type to use, based on the requested type and the address manager policy,
  * by selecting the "strictest" of the two. Strictness is defined in ascending order as
@@ -187,6 +217,16 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       enabled_sets_[i].advertising_handle_ = kInvalidHandle;
     }
     le_tx_path_loss_comp_ = get_tx_path_loss_compensation();
+    data_cache_enabled_ = advertising_api_type_ == AdvertisingApiType::EXTENDED &&
+                          os::GetSystemPropertyBool(kPropertyDataCache, false);
+    if (advertising_api_type_ == AdvertisingApiType::EXTENDED && num_instances_ > 1) {
+      // At least one set is left to the advertisers that are not multiplexed
+      multiplexed_sets_ = std::min<size_t>(
+              os::GetSystemPropertyUint32(kPropertyMultiplexedSets, 0), num_instances_ - 1);
+      multiplexing_slice_ = std::chrono::milliseconds(std::max<uint32_t>(
+              os::GetSystemPropertyUint32(kPropertyMultiplexingSlice, kDefaultMultiplexingSliceMs),
+              1));
+    }
   }
 
   int8_t get_tx_path_loss_compensation() {
@@ -226,7 +266,8 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   size_t GetNumberOfAdvertisingInstancesInUse() const {
     return std::count_if(advertising_sets_.begin(), advertising_sets_.end(),
-                         [](const auto& set) { return set.second.in_use; });
+                         [](const auto& set) { return set.second.in_use; }) +
+           logical_advertisers_.size();
   }
 
   int get_advertiser_reg_id(AdvertiserId advertiser_id) { return id_map_[advertiser_id]; }
@@ -322,8 +363,16 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
             advertising_sets_[event_view.GetAdvertisingHandle()].current_address;
     bool is_discoverable = advertising_sets_[event_view.GetAdvertisingHandle()].discoverable;
 
+    // Connections to a multiplexed advertiser are reported with its id
+    AdvertiserId terminated_advertiser_id = advertiser_id;
+    for (const auto& [id, advertiser] : logical_advertisers_) {
+      if (advertiser.handle == advertiser_id) {
+        terminated_advertiser_id = id;
+      }
+    }
     acl_manager_->OnAdvertisingSetTerminated(status, event_view.GetConnectionHandle(),
-                                             advertiser_id, advertiser_address, is_discoverable);
+                                             terminated_advertiser_id, advertiser_address,
+                                             is_discoverable);
 
     if (status == ErrorCode::LIMIT_REACHED || status == ErrorCode::ADVERTISING_TIMEOUT) {
       if (id_map_[advertiser_id] == kIdLocal) {
@@ -384,10 +433,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   AdvertiserId allocate_advertiser() {
     // number of LE_MULTI_ADVT start from 1
     AdvertiserId id = advertising_api_type_ == AdvertisingApiType::ANDROID_HCI ? 1 : 0;
-    while (id < num_instances_ && advertising_sets_.count(id) != 0) {
+    // The last sets are kept for the multiplexed advertisers
+    while (id < num_instances_ - multiplexed_sets_ && advertising_sets_.count(id) != 0) {
       id++;
     }
-    if (id == num_instances_) {
+    if (id == num_instances_ - multiplexed_sets_) {
       log::warn("Number of max instances {} reached", (uint16_t)num_instances_);
       return kInvalidId;
     }
@@ -396,6 +446,10 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   }
 
   void remove_advertiser(AdvertiserId advertiser_id) {
+    if (is_logical_advertiser(advertiser_id)) {
+      remove_logical_advertiser(advertiser_id);
+      return;
+    }
     stop_advertising(advertiser_id);
     std::unique_lock lock(id_mutex_);
     if (advertising_sets_.count(advertiser_id) == 0) {
@@ -416,6 +470,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       }
     }
     advertising_sets_.erase(advertiser_id);
+    data_cache_.Remove(advertiser_id);
     if (advertising_sets_.empty() && address_manager_registered) {
       le_address_manager_->Unregister(this);
       address_manager_registered = false;
@@ -425,7 +480,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   /// Generates an address for the advertiser
   AddressWithType new_advertiser_address(AdvertiserId id) {
-    switch (advertising_sets_[id].address_type) {
+    return new_advertiser_address(advertising_sets_[id].address_type);
+  }
+
+  AddressWithType new_advertiser_address(AdvertiserAddressType address_type) {
+    switch (address_type) {
       case AdvertiserAddressType::PUBLIC:
         if (le_address_manager_->GetAddressPolicy() ==
             LeAddressManager::AddressPolicy::USE_STATIC_ADDRESS) {
@@ -554,6 +613,10 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
           common::Callback<void(ErrorCode, uint8_t, uint8_t)> set_terminated_callback,
           uint16_t duration, uint8_t max_ext_adv_events, os::Handler* handler) {
     AdvertiserId id = allocate_advertiser();
+    if (id == kInvalidId && can_multiplex(config) && max_ext_adv_events == 0) {
+      create_logical_advertiser(client_id, reg_id, config, duration);
+      return;
+    }
     if (id == kInvalidId) {
       log::warn("Number of max instances reached");
       start_advertising_fail(reg_id, AdvertisingCallback::AdvertisingStatus::TOO_MANY_ADVERTISERS);
@@ -597,13 +660,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     advertising_sets_[id].duration = duration;
     advertising_sets_[id].max_extended_advertising_events = max_ext_adv_events;
     advertising_sets_[id].handler = handler;
-    if (com::android::bluetooth::flags::nrpa_non_connectable_adv() && !config.connectable) {
-      advertising_sets_[id].address_type = GetAdvertiserAddressTypeNonConnectable(
-              config.requested_advertiser_address_type, le_address_manager_->GetAddressPolicy());
-    } else {
-      advertising_sets_[id].address_type = GetAdvertiserAddressTypeFromRequestedTypeAndPolicy(
-              config.requested_advertiser_address_type, le_address_manager_->GetAddressPolicy());
-    }
+    advertising_sets_[id].address_type = get_advertiser_address_type(config);
     advertising_sets_[id].current_address = new_advertiser_address(id);
 
     set_parameters(id, config);
@@ -687,6 +744,15 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
   }
 
+  AdvertiserAddressType get_advertiser_address_type(const AdvertisingConfig& config) {
+    if (com::android::bluetooth::flags::nrpa_non_connectable_adv() && !config.connectable) {
+      return GetAdvertiserAddressTypeNonConnectable(config.requested_advertiser_address_type,
+                                                    le_address_manager_->GetAddressPolicy());
+    }
+    return GetAdvertiserAddressTypeFromRequestedTypeAndPolicy(
+            config.requested_advertiser_address_type, le_address_manager_->GetAddressPolicy());
+  }
+
   void stop_advertising(AdvertiserId advertiser_id) {
     auto advertising_iter = advertising_sets_.find(advertiser_id);
     if (advertising_iter == advertising_sets_.end()) {
@@ -824,6 +890,15 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   }
 
   void get_own_address(AdvertiserId advertiser_id) {
+    if (is_logical_advertiser(advertiser_id)) {
+      const LogicalAdvertiser& advertiser = logical_advertisers_[advertiser_id];
+      auto address = advertiser.handle.has_value()
+                             ? advertising_sets_[*advertiser.handle].current_address
+                             : advertiser.address;
+      advertising_callbacks_->OnOwnAddressRead(
+              advertiser_id, static_cast<uint8_t>(address.GetAddressType()), address.GetAddress());
+      return;
+    }
     if (advertising_sets_.find(advertiser_id) == advertising_sets_.end()) {
       log::info("Unknown advertising id {}", advertiser_id);
       return;
@@ -835,6 +910,10 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   }
 
   void set_parameters(AdvertiserId advertiser_id, AdvertisingConfig config) {
+    if (is_logical_advertiser(advertiser_id)) {
+      set_logical_advertiser_parameters(advertiser_id, std::move(config));
+      return;
+    }
     config.tx_power = get_tx_power_after_calibration(static_cast<int8_t>(config.tx_power));
     advertising_sets_[advertiser_id].is_legacy = config.legacy_pdus;
     advertising_sets_[advertiser_id].connectable = config.connectable;
@@ -991,6 +1070,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   }
 
   void set_data(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data) {
+    if (is_logical_advertiser(advertiser_id)) {
+      set_logical_advertiser_data(advertiser_id, set_scan_rsp, std::move(data));
+      return;
+    }
+
     // The Flags data type shall be included when any of the Flag bits are non-zero and the
     // advertising packet is connectable and discoverable.
     if (!set_scan_rsp && advertising_sets_[advertiser_id].connectable &&
@@ -1096,7 +1180,9 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
           return;
         }
 
-        if (data_len <= kLeMaximumFragmentLength) {
+        if (data_cache_enabled_) {
+          set_data_cached(advertiser_id, set_scan_rsp, data);
+        } else if (data_len <= kLeMaximumFragmentLength) {
           send_data_fragment(advertiser_id, set_scan_rsp, data, Operation::COMPLETE_ADVERTISEMENT);
         } else {
           std::vector<GapData> sub_data;
@@ -1121,6 +1207,108 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
   }
 
+  // Writes the advertising or scan response data of an extended advertising
+  // set, unless the controller already holds the same payload. The
+  // controller only replaces the data as a whole, so a changed payload is
+  // rewritten in full.
+  void set_data_cached(AdvertiserId advertiser_id, bool set_scan_rsp,
+                       const std::vector<GapData>& data) {
+    AdvertisingDataType type =
+            set_scan_rsp ? AdvertisingDataType::SCAN_RESPONSE : AdvertisingDataType::ADVERTISING;
+    std::vector<uint8_t> payload = LeAdvertisingDataCache::Serialize(data);
+    if (!data_cache_.Update(advertiser_id, type, payload)) {
+      // Rewriting the same advertising data only makes the controller
+      // change the Advertising DID, so that scanners report the set again.
+      // The unchanged data operation does that in a single command, while
+      // the set is enabled.
+      if (type == AdvertisingDataType::ADVERTISING && is_advertising_enabled(advertiser_id) &&
+          !advertising_sets_[advertiser_id].is_legacy &&
+          data_cache_.HasData(advertiser_id, type)) {
+        send_data_fragment_with_raw_builder(advertiser_id, set_scan_rsp,
+                                            std::make_unique<packet::RawBuilder>(),
+                                            Operation::UNCHANGED_DATA);
+      } else {
+        log::debug("Skip unchanged data of advertising set {}", advertiser_id);
+        on_data_set(advertiser_id, type);
+      }
+      return;
+    }
+
+    std::vector<std::vector<uint8_t>> fragments =
+            LeAdvertisingDataCache::Fragment(payload, kLeMaximumFragmentLength);
+    for (size_t i = 0; i < fragments.size(); i++) {
+      send_data_fragment_with_raw_builder(
+              advertiser_id, set_scan_rsp,
+              std::make_unique<packet::RawBuilder>(std::move(fragments[i])),
+              get_fragment_operation(i, fragments.size()));
+    }
+  }
+
+  static Operation get_fragment_operation(size_t fragment, size_t fragments) {
+    if (fragments == 1) {
+      return Operation::COMPLETE_ADVERTISEMENT;
+    }
+    if (fragment == 0) {
+      return Operation::FIRST_FRAGMENT;
+    }
+    return fragment == fragments - 1 ? Operation::LAST_FRAGMENT : Operation::INTERMEDIATE_FRAGMENT;
+  }
+
+  bool is_advertising_enabled(AdvertiserId advertiser_id) const {
+    return !paused && advertiser_id < enabled_sets_.size() &&
+           enabled_sets_[advertiser_id].advertising_handle_ != kInvalidHandle;
+  }
+
+  // Reports data that did not need to be written, as check_status_with_id()
+  // reports data written by the controller.
+  void on_data_set(AdvertiserId advertiser_id, AdvertisingDataType type) {
+    if (advertising_callbacks_ == nullptr || !advertising_sets_[advertiser_id].started ||
+        id_map_[advertiser_id] == kIdLocal) {
+      return;
+    }
+    switch (type) {
+      case AdvertisingDataType::ADVERTISING:
+        advertising_callbacks_->OnAdvertisingDataSet(
+                advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        break;
+      case AdvertisingDataType::SCAN_RESPONSE:
+        advertising_callbacks_->OnScanResponseDataSet(
+                advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        break;
+      case AdvertisingDataType::PERIODIC:
+        advertising_callbacks_->OnPeriodicAdvertisingDataSet(
+                advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        break;
+    }
+  }
+
+  // Applies the data updates of several advertising sets. An update
+  // supersedes the previous updates of the same data in the batch, which
+  // are neither written nor reported.
+  void set_data_batch(std::vector<AdvertisingDataUpdate> updates) {
+    std::map<std::pair<AdvertiserId, AdvertisingDataType>, size_t> last_update;
+    for (size_t i = 0; i < updates.size(); i++) {
+      last_update[{updates[i].advertiser_id, updates[i].type}] = i;
+    }
+    for (size_t i = 0; i < updates.size(); i++) {
+      auto& update = updates[i];
+      if (last_update[{update.advertiser_id, update.type}] != i) {
+        continue;
+      }
+      if (advertising_sets_.count(update.advertiser_id) == 0 &&
+          !is_logical_advertiser(update.advertiser_id)) {
+        log::warn("No advertising set with key: {}", update.advertiser_id);
+        continue;
+      }
+      if (update.type == AdvertisingDataType::PERIODIC) {
+        set_periodic_data(update.advertiser_id, std::move(update.data));
+      } else {
+        set_data(update.advertiser_id, update.type == AdvertisingDataType::SCAN_RESPONSE,
+                 std::move(update.data));
+      }
+    }
+  }
+
   void send_data_fragment(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data,
                           Operation operation) {
     // For first and intermediate fragment, do not trigger advertising_callbacks_.
@@ -1148,7 +1336,8 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
                                            Operation operation) {
     // For first and intermediate fragment, do not trigger advertising_callbacks_.
     bool send_callback = (operation == Operation::COMPLETE_ADVERTISEMENT ||
-                          operation == Operation::LAST_FRAGMENT);
+                          operation == Operation::LAST_FRAGMENT ||
+                          operation == Operation::UNCHANGED_DATA);
     if (set_scan_rsp) {
       le_advertising_interface_->EnqueueCommand(
               hci::LeSetExtendedScanResponseDataRawBuilder::Create(
@@ -1168,6 +1357,10 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   void enable_advertiser(AdvertiserId advertiser_id, bool enable, uint16_t duration,
                          uint8_t max_extended_advertising_events) {
+    if (is_logical_advertiser(advertiser_id)) {
+      enable_logical_advertiser(advertiser_id, enable, duration, max_extended_advertising_events);
+      return;
+    }
     EnabledSet curr_set;
     curr_set.advertising_handle_ = advertiser_id;
     curr_set.duration_ = duration;
@@ -1232,6 +1425,12 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   void set_periodic_parameter(AdvertiserId advertiser_id,
                               PeriodicAdvertisingParameters periodic_advertising_parameters) {
+    if (is_logical_advertiser(advertiser_id)) {
+      log::warn("No periodic advertising for multiplexed advertiser {}", advertiser_id);
+      advertising_callbacks_->OnPeriodicAdvertisingParametersUpdated(
+              advertiser_id, AdvertisingCallback::AdvertisingStatus::FEATURE_UNSUPPORTED);
+      return;
+    }
     uint8_t include_tx_power = periodic_advertising_parameters.properties >>
                                PeriodicAdvertisingParameters::AdvertisingProperty::INCLUDE_TX_POWER;
 
@@ -1246,6 +1445,12 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   }
 
   void set_periodic_data(AdvertiserId advertiser_id, std::vector<GapData> data) {
+    if (is_logical_advertiser(advertiser_id)) {
+      log::warn("No periodic advertising for multiplexed advertiser {}", advertiser_id);
+      advertising_callbacks_->OnPeriodicAdvertisingDataSet(
+              advertiser_id, AdvertisingCallback::AdvertisingStatus::FEATURE_UNSUPPORTED);
+      return;
+    }
     uint16_t data_len = 0;
     // check data size
     for (size_t i = 0; i < data.size(); i++) {
@@ -1270,7 +1475,21 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
 
-    if (data_len <= kLeMaximumPeriodicDataFragmentLength) {
+    if (data_cache_enabled_) {
+      std::vector<uint8_t> payload = LeAdvertisingDataCache::Serialize(data);
+      if (!data_cache_.Update(advertiser_id, AdvertisingDataType::PERIODIC, payload)) {
+        log::debug("Skip unchanged periodic data of advertising set {}", advertiser_id);
+        on_data_set(advertiser_id, AdvertisingDataType::PERIODIC);
+        return;
+      }
+      std::vector<std::vector<uint8_t>> fragments =
+              LeAdvertisingDataCache::Fragment(payload, kLeMaximumPeriodicDataFragmentLength);
+      for (size_t i = 0; i < fragments.size(); i++) {
+        send_periodic_data_fragment_with_raw_builder(
+                advertiser_id, std::make_unique<packet::RawBuilder>(std::move(fragments[i])),
+                get_fragment_operation(i, fragments.size()));
+      }
+    } else if (data_len <= kLeMaximumPeriodicDataFragmentLength) {
       send_periodic_data_fragment(advertiser_id, data, Operation::COMPLETE_ADVERTISEMENT);
     } else {
       std::vector<GapData> sub_data;
@@ -1320,6 +1539,12 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   }
 
   void enable_periodic_advertising(AdvertiserId advertiser_id, bool enable, bool include_adi) {
+    if (is_logical_advertiser(advertiser_id)) {
+      log::warn("No periodic advertising for multiplexed advertiser {}", advertiser_id);
+      advertising_callbacks_->OnPeriodicAdvertisingEnabled(
+              advertiser_id, enable, AdvertisingCallback::AdvertisingStatus::FEATURE_UNSUPPORTED);
+      return;
+    }
     if (!controller_->SupportsBlePeriodicAdvertising()) {
       return;
     }
@@ -1335,6 +1560,428 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
                                         enable, advertiser_id));
   }
 
+  bool is_logical_advertiser(AdvertiserId advertiser_id) const {
+    return logical_advertisers_.count(advertiser_id) != 0;
+  }
+
+  // Advertisers that need periodic advertising, a peer or a number of
+  // advertising events keep a set of their own.
+  bool can_multiplex(const AdvertisingConfig& config) const {
+    return multiplexed_sets_ != 0 && !config.directed && config.periodic_data.empty() &&
+           !config.periodic_advertising_parameters.enable;
+  }
+
+  AdvertiserId get_multiplexed_set_handle(size_t set) const {
+    return num_instances_ - multiplexed_sets_ + set;
+  }
+
+  AdvertiserId allocate_logical_advertiser() const {
+    // The ids of the logical advertisers follow the advertising handles
+    for (size_t id = num_instances_; id < kInvalidId; id++) {
+      if (logical_advertisers_.count(id) == 0) {
+        return id;
+      }
+    }
+    return kInvalidId;
+  }
+
+  void create_logical_advertiser(uint8_t client_id, int reg_id, const AdvertisingConfig& config,
+                                 uint16_t duration) {
+    AdvertiserId id = allocate_logical_advertiser();
+    if (id == kInvalidId) {
+      log::warn("Number of max logical advertisers reached");
+      start_advertising_fail(reg_id, AdvertisingCallback::AdvertisingStatus::TOO_MANY_ADVERTISERS);
+      return;
+    }
+    if (!check_extended_advertising_data(config.advertisement,
+                                         config.connectable && config.discoverable) ||
+        !check_extended_advertising_data(config.scan_response, false)) {
+      start_advertising_fail(reg_id, AdvertisingCallback::AdvertisingStatus::DATA_TOO_LARGE);
+      return;
+    }
+    if (multiplexer_ == nullptr) {
+      start_multiplexing();
+    }
+    log::info("Advertiser {} is multiplexed over {} advertising sets", id, multiplexed_sets_);
+
+    auto now = std::chrono::steady_clock::now();
+    id_map_[id] = reg_id;
+    LogicalAdvertiser& advertiser = logical_advertisers_[id];
+    advertiser.config = config;
+    advertiser.address_type = get_advertiser_address_type(config);
+    // Non-resolvable addresses requested by LE audio are not rotated, as in
+    // create_extended_advertiser_with_id()
+    advertiser.rotate_address =
+            advertiser.address_type != AdvertiserAddressType::PUBLIC &&
+            !(client_id == kAdvertiserClientIdLeAudio &&
+              advertiser.address_type == AdvertiserAddressType::NONRESOLVABLE_RANDOM);
+    renew_logical_advertiser_address(advertiser, now);
+    advertiser.parameter_group = get_parameter_group(id, advertiser);
+
+    advertising_callbacks_->OnAdvertisingSetStarted(
+            reg_id, id, get_tx_power_after_calibration(static_cast<int8_t>(config.tx_power)),
+            AdvertisingCallback::AdvertisingStatus::SUCCESS);
+    set_logical_advertiser_enabled(id, true, duration, now);
+    schedule_multiplexed_advertisers(now);
+  }
+
+  void remove_logical_advertiser(AdvertiserId advertiser_id) {
+    auto now = std::chrono::steady_clock::now();
+    multiplexer_->RemoveAdvertiser(advertiser_id, now);
+    logical_advertisers_.erase(advertiser_id);
+    schedule_multiplexed_advertisers(now);
+    if (logical_advertisers_.empty()) {
+      stop_multiplexing();
+    }
+  }
+
+  std::optional<AdvertiserId> get_logical_advertiser_on_set(AdvertiserId handle) const {
+    for (const auto& [id, advertiser] : logical_advertisers_) {
+      if (advertiser.handle == handle) {
+        return id;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // The multiplexed sets are registered as kIdLocal, so the failures of their
+  // commands are reported to the advertiser on the set. An advertiser whose
+  // parameters are rejected is taken off the sets until it is enabled again.
+  void on_multiplexed_parameters_failed(AdvertiserId handle) {
+    std::optional<AdvertiserId> advertiser_id = get_logical_advertiser_on_set(handle);
+    if (!advertiser_id.has_value() || advertising_callbacks_ == nullptr) {
+      return;
+    }
+    log::warn("Parameters of multiplexed advertiser {} rejected on set {}", *advertiser_id,
+              handle);
+    auto now = std::chrono::steady_clock::now();
+    set_logical_advertiser_enabled(*advertiser_id, false, 0, now);
+    schedule_multiplexed_advertisers(now);
+    advertising_callbacks_->OnAdvertisingParametersUpdated(
+            *advertiser_id, advertising_sets_[handle].tx_power,
+            AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR);
+    advertising_callbacks_->OnAdvertisingEnabled(
+            *advertiser_id, false, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR);
+  }
+
+  void on_multiplexed_data_failed(AdvertiserId handle, OpCode opcode) {
+    std::optional<AdvertiserId> advertiser_id = get_logical_advertiser_on_set(handle);
+    if (!advertiser_id.has_value() || advertising_callbacks_ == nullptr) {
+      return;
+    }
+    log::warn("Data of multiplexed advertiser {} rejected on set {}", *advertiser_id, handle);
+    if (opcode == OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA) {
+      advertising_callbacks_->OnScanResponseDataSet(
+              *advertiser_id, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR);
+    } else if (opcode == OpCode::LE_SET_EXTENDED_ADVERTISING_DATA) {
+      advertising_callbacks_->OnAdvertisingDataSet(
+              *advertiser_id, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR);
+    }
+  }
+
+  void start_multiplexing() {
+    if (!address_manager_registered) {
+      le_address_manager_->Register(this);
+      address_manager_registered = true;
+    }
+    multiplexer_ =
+            std::make_unique<LeAdvertisingMultiplexer>(multiplexed_sets_, multiplexing_slice_);
+    for (size_t set = 0; set < multiplexed_sets_; set++) {
+      AdvertiserId handle = get_multiplexed_set_handle(set);
+      advertising_sets_[handle].handler = module_handler_;
+      advertising_sets_[handle].duration = 0;
+      advertising_sets_[handle].max_extended_advertising_events = 0;
+      id_map_[handle] = kIdLocal;
+    }
+    multiplexing_alarm_ = std::make_unique<os::RepeatingAlarm>(module_handler_);
+    multiplexing_alarm_->Schedule(
+            common::Bind(&impl::on_multiplexing_slice, common::Unretained(this)),
+            multiplexing_slice_);
+  }
+
+  // The multiplexed sets are disabled by the last schedule, and are left
+  // configured in the controller.
+  void stop_multiplexing() {
+    multiplexing_alarm_.reset();
+    multiplexer_.reset();
+    for (size_t set = 0; set < multiplexed_sets_; set++) {
+      AdvertiserId handle = get_multiplexed_set_handle(set);
+      advertising_sets_.erase(handle);
+      data_cache_.Remove(handle);
+    }
+    if (advertising_sets_.empty() && address_manager_registered) {
+      le_address_manager_->Unregister(this);
+      address_manager_registered = false;
+      paused = false;
+    }
+    std::unique_lock lock(multiplexing_metrics_mutex_);
+    multiplexing_metrics_ = {};
+  }
+
+  // Advertisers with the same parameters share a parameter group, so that
+  // the parameters are not written again when one replaces the other on a
+  // set.
+  uint32_t get_parameter_group(AdvertiserId advertiser_id, const LogicalAdvertiser& advertiser) {
+    auto parameters = [](const AdvertisingConfig& config) {
+      return std::tie(config.interval_min, config.interval_max, config.advertising_type,
+                      config.peer_address_type, config.peer_address, config.channel_map,
+                      config.filter_policy, config.tx_power, config.connectable,
+                      config.discoverable, config.scannable, config.legacy_pdus, config.anonymous,
+                      config.include_tx_power, config.use_le_coded_phy, config.secondary_max_skip,
+                      config.secondary_advertising_phy, config.enable_scan_request_notifications);
+    };
+    for (const auto& [id, other] : logical_advertisers_) {
+      if (id != advertiser_id && other.address_type == advertiser.address_type &&
+          parameters(other.config) == parameters(advertiser.config)) {
+        return other.parameter_group;
+      }
+    }
+    return next_parameter_group_++;
+  }
+
+  static MultiplexedAdvertiserParameters get_multiplexing_parameters(
+          const LogicalAdvertiser& advertiser) {
+    return MultiplexedAdvertiserParameters{
+            .interval = advertiser.config.interval_max,
+            .parameter_group = advertiser.parameter_group,
+    };
+  }
+
+  void renew_logical_advertiser_address(LogicalAdvertiser& advertiser,
+                                        std::chrono::steady_clock::time_point now) {
+    advertiser.address = new_advertiser_address(advertiser.address_type);
+    advertiser.address_expiry.reset();
+    if (advertiser.rotate_address) {
+      advertiser.address_expiry = now + le_address_manager_->GetNextPrivateAddressIntervalMs();
+    }
+  }
+
+  static bool is_address_expired(const LogicalAdvertiser& advertiser,
+                                 std::chrono::steady_clock::time_point now) {
+    return advertiser.address_expiry.has_value() && now >= *advertiser.address_expiry;
+  }
+
+  void set_logical_advertiser_parameters(AdvertiserId advertiser_id, AdvertisingConfig config) {
+    LogicalAdvertiser& advertiser = logical_advertisers_[advertiser_id];
+    int8_t tx_power = get_tx_power_after_calibration(static_cast<int8_t>(config.tx_power));
+    if (!can_multiplex(config)) {
+      log::warn("Unsupported parameters for multiplexed advertiser {}", advertiser_id);
+      advertising_callbacks_->OnAdvertisingParametersUpdated(
+              advertiser_id, tx_power, AdvertisingCallback::AdvertisingStatus::FEATURE_UNSUPPORTED);
+      return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    // The data is set separately
+    config.advertisement = std::move(advertiser.config.advertisement);
+    config.scan_response = std::move(advertiser.config.scan_response);
+    advertiser.config = std::move(config);
+    AdvertiserAddressType address_type = get_advertiser_address_type(advertiser.config);
+    if (address_type != advertiser.address_type) {
+      advertiser.address_type = address_type;
+      advertiser.rotate_address = address_type != AdvertiserAddressType::PUBLIC;
+      advertiser.address_expiry = now;
+    }
+    advertiser.parameter_group = get_parameter_group(advertiser_id, advertiser);
+    if (advertiser.enabled) {
+      multiplexer_->SetAdvertiser(advertiser_id, get_multiplexing_parameters(advertiser), now);
+      schedule_multiplexed_advertisers(now);
+    }
+    advertising_callbacks_->OnAdvertisingParametersUpdated(
+            advertiser_id, tx_power, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+  }
+
+  void set_logical_advertiser_data(AdvertiserId advertiser_id, bool set_scan_rsp,
+                                   std::vector<GapData> data) {
+    LogicalAdvertiser& advertiser = logical_advertisers_[advertiser_id];
+    bool include_flag =
+            !set_scan_rsp && advertiser.config.connectable && advertiser.config.discoverable;
+    AdvertisingCallback::AdvertisingStatus status = AdvertisingCallback::AdvertisingStatus::SUCCESS;
+    if (!check_extended_advertising_data(data, include_flag)) {
+      status = AdvertisingCallback::AdvertisingStatus::DATA_TOO_LARGE;
+    } else {
+      if (set_scan_rsp) {
+        advertiser.config.scan_response = data;
+      } else {
+        advertiser.config.advertisement = data;
+      }
+      if (advertiser.handle.has_value()) {
+        set_data(*advertiser.handle, set_scan_rsp, std::move(data));
+      }
+    }
+    if (set_scan_rsp) {
+      advertising_callbacks_->OnScanResponseDataSet(advertiser_id, status);
+    } else {
+      advertising_callbacks_->OnAdvertisingDataSet(advertiser_id, status);
+    }
+  }
+
+  void enable_logical_advertiser(AdvertiserId advertiser_id, bool enable, uint16_t duration,
+                                 uint8_t max_extended_advertising_events) {
+    if (enable && max_extended_advertising_events != 0) {
+      log::warn("No maximum number of events for multiplexed advertiser {}", advertiser_id);
+      advertising_callbacks_->OnAdvertisingEnabled(
+              advertiser_id, enable, AdvertisingCallback::AdvertisingStatus::FEATURE_UNSUPPORTED);
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    set_logical_advertiser_enabled(advertiser_id, enable, duration, now);
+    schedule_multiplexed_advertisers(now);
+    advertising_callbacks_->OnAdvertisingEnabled(advertiser_id, enable,
+                                                 AdvertisingCallback::AdvertisingStatus::SUCCESS);
+  }
+
+  void set_logical_advertiser_enabled(AdvertiserId advertiser_id, bool enable, uint16_t duration,
+                                      std::chrono::steady_clock::time_point now) {
+    LogicalAdvertiser& advertiser = logical_advertisers_[advertiser_id];
+    advertiser.enabled = enable;
+    advertiser.enabled_until.reset();
+    if (!enable) {
+      multiplexer_->RemoveAdvertiser(advertiser_id, now);
+      return;
+    }
+    if (duration != 0) {
+      // The duration is in units of 10 ms, and is checked at each time slice
+      advertiser.enabled_until = now + std::chrono::milliseconds(duration * 10);
+    }
+    multiplexer_->SetAdvertiser(advertiser_id, get_multiplexing_parameters(advertiser), now);
+  }
+
+  void on_multiplexing_slice() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto& [id, advertiser] : logical_advertisers_) {
+      if (advertiser.enabled && advertiser.enabled_until.has_value() &&
+          now >= *advertiser.enabled_until) {
+        set_logical_advertiser_enabled(id, false, 0, now);
+        advertising_callbacks_->OnAdvertisingEnabled(id, false, AdvertisingCallback::TIMEOUT);
+      }
+    }
+    schedule_multiplexed_advertisers(now);
+  }
+
+  void schedule_multiplexed_advertisers(std::chrono::steady_clock::time_point now) {
+    apply_multiplexing_changes(multiplexer_->Schedule(now), now);
+    update_multiplexing_metrics(now);
+  }
+
+  // Puts the advertisers picked by the multiplexer on their sets. The sets
+  // that change are disabled together, configured, and enabled together.
+  void apply_multiplexing_changes(std::vector<LeAdvertisingMultiplexer::Change> changes,
+                                  std::chrono::steady_clock::time_point now) {
+    // The advertisers on air whose address expired are put on their set
+    // again, with a new address
+    for (const auto& [id, advertiser] : logical_advertisers_) {
+      std::optional<size_t> set = multiplexer_->GetSet(id);
+      if (set.has_value() && is_address_expired(advertiser, now) &&
+          std::none_of(changes.begin(), changes.end(),
+                       [&](const auto& change) { return change.set == *set; })) {
+        changes.push_back({.set = *set, .advertiser_id = id, .write_parameters = false});
+      }
+    }
+    if (changes.empty()) {
+      return;
+    }
+
+    std::map<AdvertiserId, AdvertiserId> previous_advertisers;
+    std::vector<EnabledSet> disabled_sets;
+    for (const auto& change : changes) {
+      AdvertiserId handle = get_multiplexed_set_handle(change.set);
+      if (enabled_sets_[handle].advertising_handle_ != kInvalidHandle) {
+        disabled_sets.push_back(enabled_sets_[handle]);
+        enabled_sets_[handle].advertising_handle_ = kInvalidHandle;
+      }
+      for (auto& [id, advertiser] : logical_advertisers_) {
+        if (advertiser.handle == handle) {
+          // The address may have been rotated on the set
+          advertiser.address = advertising_sets_[handle].current_address;
+          advertiser.handle.reset();
+          previous_advertisers[handle] = id;
+        }
+      }
+    }
+    if (!disabled_sets.empty() && !paused) {
+      le_advertising_interface_->EnqueueCommand(
+              hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::DISABLED, disabled_sets),
+              module_handler_->BindOnce(
+                      check_complete<LeSetExtendedAdvertisingEnableCompleteView>));
+    }
+
+    std::vector<EnabledSet> enabled_sets;
+    for (const auto& change : changes) {
+      if (!change.advertiser_id.has_value()) {
+        continue;
+      }
+      AdvertiserId handle = get_multiplexed_set_handle(change.set);
+      LogicalAdvertiser& advertiser = logical_advertisers_[*change.advertiser_id];
+      bool swapped = previous_advertisers.count(handle) == 0 ||
+                     previous_advertisers[handle] != *change.advertiser_id;
+      bool new_address = is_address_expired(advertiser, now);
+      if (new_address) {
+        renew_logical_advertiser_address(advertiser, now);
+      }
+      advertising_sets_[handle].address_type = advertiser.address_type;
+      advertising_sets_[handle].current_address = advertiser.address;
+
+      if (change.write_parameters) {
+        set_parameters(handle, advertiser.config);
+      }
+      if (advertiser.address.GetAddressType() != AddressType::PUBLIC_DEVICE_ADDRESS &&
+          (swapped || new_address)) {
+        le_advertising_interface_->EnqueueCommand(
+                hci::LeSetAdvertisingSetRandomAddressBuilder::Create(
+                        handle, advertiser.address.GetAddress()),
+                module_handler_->BindOnceOn(this,
+                                            &impl::on_set_advertising_set_random_address_complete<
+                                                    LeSetAdvertisingSetRandomAddressCompleteView>,
+                                            handle, advertiser.address));
+      }
+      if (swapped || change.write_parameters) {
+        if (advertiser.config.advertising_type == AdvertisingType::ADV_IND ||
+            advertiser.config.advertising_type == AdvertisingType::ADV_NONCONN_IND) {
+          set_data(handle, true, advertiser.config.scan_response);
+        }
+        set_data(handle, false, advertiser.config.advertisement);
+      }
+
+      EnabledSet enabled_set;
+      enabled_set.advertising_handle_ = handle;
+      enabled_set.duration_ = 0;
+      enabled_set.max_extended_advertising_events_ = 0;
+      enabled_sets.push_back(enabled_set);
+      enabled_sets_[handle] = enabled_set;
+      advertiser.handle = handle;
+    }
+    // If we are paused, the sets are enabled in OnResume()
+    if (!enabled_sets.empty() && !paused) {
+      le_advertising_interface_->EnqueueCommand(
+              hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::ENABLED, enabled_sets),
+              module_handler_->BindOnce(
+                      check_complete<LeSetExtendedAdvertisingEnableCompleteView>));
+    }
+  }
+
+  void update_multiplexing_metrics(std::chrono::steady_clock::time_point now) {
+    AdvertisingMultiplexingMetrics metrics;
+    for (size_t set = 0; set < multiplexed_sets_; set++) {
+      metrics.sets.push_back(get_multiplexed_set_handle(set));
+    }
+    metrics.slice = multiplexer_->GetSlice();
+    metrics.advertisers = multiplexer_->GetMetrics(now);
+    for (auto& advertiser : metrics.advertisers) {
+      if (advertiser.set.has_value()) {
+        advertiser.set = get_multiplexed_set_handle(*advertiser.set);
+      }
+    }
+    metrics.statistics = multiplexer_->GetStatistics();
+    std::unique_lock lock(multiplexing_metrics_mutex_);
+    multiplexing_metrics_ = std::move(metrics);
+  }
+
+  AdvertisingMultiplexingMetrics get_multiplexing_metrics() const {
+    std::unique_lock lock(multiplexing_metrics_mutex_);
+    return multiplexing_metrics_;
+  }
+
   void OnPause() override {
     if (!address_manager_registered) {
       log::warn("Unregistered!");
@@ -1448,6 +2095,13 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         rotate_advertiser_address(i);
       }
     }
+    // The multiplexed advertisers off air get a new address on their next turn
+    auto now = std::chrono::steady_clock::now();
+    for (auto& [id, advertiser] : logical_advertisers_) {
+      if (!advertiser.handle.has_value() && advertiser.address_expiry.has_value()) {
+        advertiser.address_expiry = now;
+      }
+    }
   }
 
   common::Callback<void(Address, AddressType)> scan_callback_;
@@ -1476,6 +2130,19 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   std::map<uint8_t, int> id_map_;
 
   AdvertisingApiType advertising_api_type_{0};
+  bool data_cache_enabled_{false};
+  LeAdvertisingDataCache data_cache_;
+
+  // Advertisers created once the other sets are in use share the last
+  // multiplexed_sets_ sets of the controller
+  size_t multiplexed_sets_{0};
+  std::chrono::milliseconds multiplexing_slice_{kDefaultMultiplexingSliceMs};
+  std::unique_ptr<LeAdvertisingMultiplexer> multiplexer_;
+  std::unique_ptr<os::RepeatingAlarm> multiplexing_alarm_;
+  std::map<AdvertiserId, LogicalAdvertiser> logical_advertisers_;
+  uint32_t next_parameter_group_{0};
+  mutable std::mutex multiplexing_metrics_mutex_;
+  AdvertisingMultiplexingMetrics multiplexing_metrics_{};
 
   void on_read_advertising_physical_channel_tx_power(CommandCompleteView view) {
     auto complete_view = LeReadAdvertisingPhysicalChannelTxPowerCompleteView::Create(view);
@@ -1600,6 +2267,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
     advertising_sets_[id].tx_power = complete_view.GetSelectedTxPower();
 
+    if (advertising_status != AdvertisingCallback::AdvertisingStatus::SUCCESS &&
+        id_map_[id] == kIdLocal) {
+      on_multiplexed_parameters_failed(id);
+      return;
+    }
     if (advertising_sets_[id].started && id_map_[id] != kIdLocal) {
       advertising_callbacks_->OnAdvertisingParametersUpdated(id, advertising_sets_[id].tx_power,
                                                              advertising_status);
@@ -1657,6 +2329,10 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (status_view.GetStatus() != ErrorCode::SUCCESS) {
       log::info("Got a command complete with status {}", ErrorCodeText(status_view.GetStatus()));
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
+      invalidate_data_cache(id, view.GetCommandOpCode());
+      if (send_callback && id_map_[id] == kIdLocal) {
+        on_multiplexed_data_failed(id, view.GetCommandOpCode());
+      }
     }
 
     // Do not trigger callback if the advertiser not stated yet, or the advertiser is not register
@@ -1716,6 +2392,23 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
   }
 
+  // The controller may not hold the payload of data that failed to be written.
+  void invalidate_data_cache(AdvertiserId id, OpCode opcode) {
+    switch (opcode) {
+      case OpCode::LE_SET_EXTENDED_ADVERTISING_DATA:
+        data_cache_.Invalidate(id, AdvertisingDataType::ADVERTISING);
+        break;
+      case OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA:
+        data_cache_.Invalidate(id, AdvertisingDataType::SCAN_RESPONSE);
+        break;
+      case OpCode::LE_SET_PERIODIC_ADVERTISING_DATA:
+        data_cache_.Invalidate(id, AdvertisingDataType::PERIODIC);
+        break;
+      default:
+        break;
+    }
+  }
+
   void start_advertising_fail(int reg_id, AdvertisingCallback::AdvertisingStatus status) {
     log::assert_that(status != AdvertisingCallback::AdvertisingStatus::SUCCESS,
                      "assert failed: status != AdvertisingCallback::AdvertisingStatus::SUCCESS");
@@ -1847,6 +2540,10 @@ void LeAdvertisingManager::SetData(AdvertiserId advertiser_id, bool set_scan_rsp
   CallOn(pimpl_.get(), &impl::set_data, advertiser_id, set_scan_rsp, data);
 }
 
+void LeAdvertisingManager::SetDataBatch(std::vector<AdvertisingDataUpdate> updates) {
+  CallOn(pimpl_.get(), &impl::set_data_batch, std::move(updates));
+}
+
 void LeAdvertisingManager::EnableAdvertiser(AdvertiserId advertiser_id, bool enable,
                                             uint16_t duration,
                                             uint8_t max_extended_advertising_events) {
@@ -1877,5 +2574,9 @@ void LeAdvertisingManager::RegisterAdvertisingCallback(AdvertisingCallback* adve
   CallOn(pimpl_.get(), &impl::register_advertising_callback, advertising_callback);
 }
 
+AdvertisingMultiplexingMetrics LeAdvertisingManager::GetMultiplexingMetrics() const {
+  return pimpl_->get_multiplexing_metrics();
+}
+
 }  // namespace hci
 }  // namespace bluetooth
@@ -17,11 +17,14 @@
 
 #include <bluetooth/log.h>
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
 #include "common/callback.h"
 #include "hci/hci_packets.h"
+#include "hci/le_advertising_data_cache.h"
+#include "hci/le_advertising_multiplexer.h"
 #include "module.h"
 
 namespace bluetooth {
@@ -77,6 +80,21 @@ public:
 
 using AdvertiserId = uint8_t;
 
+struct AdvertisingDataUpdate {
+  AdvertiserId advertiser_id;
+  AdvertisingDataType type;
+  std::vector<GapData> data;
+};
+
+struct AdvertisingMultiplexingMetrics {
+  // Advertising sets shared between the multiplexed advertisers
+  std::vector<AdvertiserId> sets;
+  std::chrono::milliseconds slice;
+  // The set of each advertiser is its advertising handle
+  std::vector<MultiplexedAdvertiserMetrics> advertisers;
+  LeAdvertisingMultiplexer::Statistics statistics;
+};
+
 class AdvertisingCallback {
 public:
   enum AdvertisingStatus {
@@ -152,6 +170,10 @@ public:
 
   void SetData(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data);
 
+  // Sets the data of several advertising sets at once. Only the last update
+  // of each data of a set is applied.
+  void SetDataBatch(std::vector<AdvertisingDataUpdate> updates);
+
   void EnableAdvertiser(AdvertiserId advertiser_id, bool enable, uint16_t duration,
                         uint8_t max_extended_advertising_events);
 
@@ -166,6 +188,11 @@ public:
 
   void RegisterAdvertisingCallback(AdvertisingCallback* advertising_callback);
 
+  // Returns the metrics of the advertisers multiplexed over the last
+  // advertising sets, as of the last time slice. Can be called from any
+  // thread.
+  AdvertisingMultiplexingMetrics GetMultiplexingMetrics() const;
+
   static const ModuleFactory Factory;
 
 protected:
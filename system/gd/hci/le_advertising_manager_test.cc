@@ -33,6 +33,7 @@
 #include "hci/address.h"
 #include "hci/controller.h"
 #include "hci/hci_layer_fake.h"
+#include "os/system_properties.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
 
@@ -1898,6 +1899,353 @@ TEST_F(LeExtendedAdvertisingManagerTest,
   EXPECT_EQ(set_parameters_command.GetOwnAddressType(), OwnAddressType::PUBLIC_DEVICE_ADDRESS);
 }
 
+class LeExtendedAdvertisingDataCacheTest : public LeExtendedAdvertisingAPITest {
+protected:
+  void SetUp() override {
+    os::SetSystemProperty("bluetooth.le.adv_data_cache", "true");
+    LeExtendedAdvertisingAPITest::SetUp();
+  }
+
+  void TearDown() override {
+    LeExtendedAdvertisingAPITest::TearDown();
+    os::ClearSystemPropertiesForHost();
+  }
+
+  // Advertising and scan response data of the advertising set started in
+  // LeExtendedAdvertisingAPITest::SetUp().
+  std::vector<GapData> StartedData() {
+    GapData flags{};
+    flags.data_type_ = GapDataType::FLAGS;
+    flags.data_ = {0x34};
+    GapData name{};
+    name.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+    name.data_ = {'r', 'a', 'n', 'd', 'o', 'm', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+    return {flags, name};
+  }
+
+  std::vector<GapData> NameData(std::vector<uint8_t> name) {
+    GapData gap_data{};
+    gap_data.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+    gap_data.data_ = std::move(name);
+    return {gap_data};
+  }
+
+  Operation GetDataOperation() {
+    auto command = LeSetExtendedAdvertisingDataView::Create(LeAdvertisingCommandView::Create(
+            test_hci_layer_->GetCommand(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA)));
+    EXPECT_TRUE(command.IsValid());
+    return command.GetOperation();
+  }
+};
+
+TEST_F(LeExtendedAdvertisingDataCacheTest, same_data_refreshes_advertising_did) {
+  EXPECT_CALL(
+          mock_advertising_callback_,
+          OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->SetData(advertiser_id_, false, StartedData());
+
+  auto command = LeSetExtendedAdvertisingDataView::Create(LeAdvertisingCommandView::Create(
+          test_hci_layer_->GetCommand(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA)));
+  ASSERT_TRUE(command.IsValid());
+  EXPECT_EQ(command.GetOperation(), Operation::UNCHANGED_DATA);
+  EXPECT_TRUE(command.GetAdvertisingData().empty());
+  test_hci_layer_->IncomingEvent(
+          LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+}
+
+TEST_F(LeExtendedAdvertisingDataCacheTest, same_scan_response_is_not_written) {
+  EXPECT_CALL(
+          mock_advertising_callback_,
+          OnScanResponseDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->SetData(advertiser_id_, true, StartedData());
+  sync_client_handler();
+  test_hci_layer_->AssertNoQueuedCommand();
+}
+
+TEST_F(LeExtendedAdvertisingDataCacheTest, same_data_is_not_written_while_disabled) {
+  le_advertising_manager_->EnableAdvertiser(advertiser_id_, false, 0, 0);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  EXPECT_CALL(mock_advertising_callback_, OnAdvertisingEnabled(advertiser_id_, false, _));
+  test_hci_layer_->IncomingEvent(
+          LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+
+  le_advertising_manager_->SetData(advertiser_id_, false, StartedData());
+  sync_client_handler();
+  test_hci_layer_->AssertNoQueuedCommand();
+}
+
+TEST_F(LeExtendedAdvertisingDataCacheTest, changed_data_is_written) {
+  le_advertising_manager_->SetData(advertiser_id_, false, NameData({'a', 'b'}));
+  auto command = LeSetExtendedAdvertisingDataView::Create(LeAdvertisingCommandView::Create(
+          test_hci_layer_->GetCommand(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA)));
+  ASSERT_TRUE(command.IsValid());
+  EXPECT_EQ(command.GetOperation(), Operation::COMPLETE_ADVERTISEMENT);
+  ASSERT_EQ(command.GetAdvertisingData().size(), 1ul);
+  EXPECT_EQ(command.GetAdvertisingData()[0].data_, std::vector<uint8_t>({'a', 'b'}));
+  EXPECT_CALL(
+          mock_advertising_callback_,
+          OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(
+          LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+}
+
+TEST_F(LeExtendedAdvertisingDataCacheTest, failed_data_is_written_again) {
+  le_advertising_manager_->SetData(advertiser_id_, false, NameData({'a', 'b'}));
+  EXPECT_EQ(GetDataOperation(), Operation::COMPLETE_ADVERTISEMENT);
+  EXPECT_CALL(mock_advertising_callback_,
+              OnAdvertisingDataSet(advertiser_id_,
+                                   AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(
+          uint8_t{1}, ErrorCode::MEMORY_CAPACITY_EXCEEDED));
+  sync_client_handler();
+
+  le_advertising_manager_->SetData(advertiser_id_, false, NameData({'a', 'b'}));
+  EXPECT_EQ(GetDataOperation(), Operation::COMPLETE_ADVERTISEMENT);
+  EXPECT_CALL(
+          mock_advertising_callback_,
+          OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(
+          LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+}
+
+TEST_F(LeExtendedAdvertisingDataCacheTest, changed_fragmented_data_is_written) {
+  std::vector<GapData> data = NameData(std::vector<uint8_t>(200, 'a'));
+  data.push_back(NameData(std::vector<uint8_t>(100, 'b'))[0]);
+  le_advertising_manager_->SetData(advertiser_id_, false, data);
+  EXPECT_EQ(GetDataOperation(), Operation::FIRST_FRAGMENT);
+  EXPECT_EQ(GetDataOperation(), Operation::LAST_FRAGMENT);
+  EXPECT_CALL(
+          mock_advertising_callback_,
+          OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(
+          LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  test_hci_layer_->IncomingEvent(
+          LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+}
+
+TEST_F(LeExtendedAdvertisingDataCacheTest, set_data_batch) {
+  // The first update of the advertising data is superseded, and the scan
+  // response data is unchanged.
+  EXPECT_CALL(
+          mock_advertising_callback_,
+          OnScanResponseDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->SetDataBatch({
+          {advertiser_id_, AdvertisingDataType::ADVERTISING, NameData({'a'})},
+          {advertiser_id_, AdvertisingDataType::SCAN_RESPONSE, StartedData()},
+          {advertiser_id_, AdvertisingDataType::ADVERTISING, NameData({'b'})},
+  });
+
+  auto command = LeSetExtendedAdvertisingDataView::Create(LeAdvertisingCommandView::Create(
+          test_hci_layer_->GetCommand(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA)));
+  ASSERT_TRUE(command.IsValid());
+  ASSERT_EQ(command.GetAdvertisingData().size(), 1ul);
+  EXPECT_EQ(command.GetAdvertisingData()[0].data_, std::vector<uint8_t>({'b'}));
+  EXPECT_CALL(
+          mock_advertising_callback_,
+          OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(
+          LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+  test_hci_layer_->AssertNoQueuedCommand();
+}
+
+class LeExtendedAdvertisingMultiplexingTest : public LeExtendedAdvertisingAPITest {
+protected:
+  void SetUp() override {
+    // The advertising set of LeExtendedAdvertisingAPITest::SetUp() takes the
+    // only set that is not multiplexed. The slices are too long to end
+    // during the tests.
+    os::SetSystemProperty("bluetooth.le.adv_multiplexed_sets", "7");
+    os::SetSystemProperty("bluetooth.le.adv_multiplexing_slice_ms", "600000");
+    LeExtendedAdvertisingAPITest::SetUp();
+  }
+
+  void TearDown() override {
+    LeExtendedAdvertisingAPITest::TearDown();
+    os::ClearSystemPropertiesForHost();
+  }
+
+  AdvertiserId CreateMultiplexedAdvertiser() {
+    AdvertisingConfig advertising_config{};
+    advertising_config.advertising_type = AdvertisingType::ADV_IND;
+    advertising_config.requested_advertiser_address_type = AdvertiserAddressType::PUBLIC;
+    GapData data_item{};
+    data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+    data_item.data_ = {'m', 'u', 'x'};
+    advertising_config.advertisement = {data_item};
+    advertising_config.scan_response = {data_item};
+    advertising_config.channel_map = 1;
+
+    AdvertiserId advertiser_id = LeAdvertisingManager::kInvalidId;
+    EXPECT_CALL(
+            mock_advertising_callback_,
+            OnAdvertisingSetStarted(0x01, _, _, AdvertisingCallback::AdvertisingStatus::SUCCESS))
+            .WillOnce(SaveArg<1>(&advertiser_id));
+    le_advertising_manager_->ExtendedCreateAdvertiser(
+            kAdvertiserClientIdJni, 0x01, advertising_config, scan_callback,
+            set_terminated_callback, 0, 0, client_handler_);
+    sync_client_handler();
+    return advertiser_id;
+  }
+
+  void CompleteCommands(std::vector<OpCode> opcodes) {
+    std::vector<uint8_t> success_vector{static_cast<uint8_t>(ErrorCode::SUCCESS)};
+    for (OpCode opcode : opcodes) {
+      ASSERT_EQ(opcode, test_hci_layer_->GetCommand().GetOpCode());
+      if (opcode == OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS) {
+        test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingParametersCompleteBuilder::Create(
+                uint8_t{1}, ErrorCode::SUCCESS, static_cast<uint8_t>(-23)));
+      } else {
+        test_hci_layer_->IncomingEvent(CommandCompleteBuilder::Create(
+                uint8_t{1}, opcode, std::make_unique<RawBuilder>(success_vector)));
+      }
+    }
+    sync_client_handler();
+  }
+};
+
+TEST_F(LeExtendedAdvertisingMultiplexingTest, advertiser_is_put_on_multiplexed_set) {
+  AdvertiserId advertiser_id = CreateMultiplexedAdvertiser();
+  // The id of the advertiser follows the advertising handles
+  EXPECT_EQ(advertiser_id, num_instances_);
+
+  auto set_parameters_command = LeSetExtendedAdvertisingParametersView::Create(
+          LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand(
+                  OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS)));
+  ASSERT_TRUE(set_parameters_command.IsValid());
+  EXPECT_EQ(set_parameters_command.GetAdvertisingHandle(), 1);
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingParametersCompleteBuilder::Create(
+          uint8_t{1}, ErrorCode::SUCCESS, static_cast<uint8_t>(-23)));
+  // The callbacks of the advertising set are not reported
+  CompleteCommands({OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+  test_hci_layer_->AssertNoQueuedCommand();
+
+  EXPECT_EQ(le_advertising_manager_->GetNumberOfAdvertisingInstancesInUse(), 2ul);
+  AdvertisingMultiplexingMetrics metrics = le_advertising_manager_->GetMultiplexingMetrics();
+  EXPECT_EQ(metrics.sets.size(), 7ul);
+  ASSERT_EQ(metrics.advertisers.size(), 1ul);
+  EXPECT_EQ(metrics.advertisers[0].advertiser_id, advertiser_id);
+  EXPECT_EQ(metrics.advertisers[0].set, std::optional<size_t>(1));
+  EXPECT_EQ(metrics.statistics.parameter_writes, 1u);
+}
+
+TEST_F(LeExtendedAdvertisingMultiplexingTest, set_data) {
+  AdvertiserId advertiser_id = CreateMultiplexedAdvertiser();
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS,
+                    OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+  data_item.data_ = {'a', 'b'};
+  EXPECT_CALL(
+          mock_advertising_callback_,
+          OnAdvertisingDataSet(advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->SetData(advertiser_id, false, {data_item});
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_DATA});
+  test_hci_layer_->AssertNoQueuedCommand();
+}
+
+TEST_F(LeExtendedAdvertisingMultiplexingTest, enable_does_not_write_parameters_again) {
+  AdvertiserId advertiser_id = CreateMultiplexedAdvertiser();
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS,
+                    OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+
+  EXPECT_CALL(mock_advertising_callback_,
+              OnAdvertisingEnabled(advertiser_id, false,
+                                   AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->EnableAdvertiser(advertiser_id, false, 0, 0);
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+
+  EXPECT_CALL(mock_advertising_callback_,
+              OnAdvertisingEnabled(advertiser_id, true,
+                                   AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->EnableAdvertiser(advertiser_id, true, 0, 0);
+  CompleteCommands({OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+  test_hci_layer_->AssertNoQueuedCommand();
+}
+
+TEST_F(LeExtendedAdvertisingMultiplexingTest, remove_advertiser) {
+  AdvertiserId advertiser_id = CreateMultiplexedAdvertiser();
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS,
+                    OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+
+  le_advertising_manager_->RemoveAdvertiser(advertiser_id);
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+  test_hci_layer_->AssertNoQueuedCommand();
+  EXPECT_EQ(le_advertising_manager_->GetNumberOfAdvertisingInstancesInUse(), 1ul);
+  EXPECT_TRUE(le_advertising_manager_->GetMultiplexingMetrics().advertisers.empty());
+}
+
+TEST_F(LeExtendedAdvertisingMultiplexingTest, rejected_parameters_are_reported_to_advertiser) {
+  AdvertiserId advertiser_id = CreateMultiplexedAdvertiser();
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS,
+            test_hci_layer_->GetCommand().GetOpCode());
+  EXPECT_CALL(mock_advertising_callback_,
+              OnAdvertisingParametersUpdated(
+                      advertiser_id, _, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  EXPECT_CALL(mock_advertising_callback_,
+              OnAdvertisingEnabled(advertiser_id, false,
+                                   AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingParametersCompleteBuilder::Create(
+          uint8_t{1}, ErrorCode::INVALID_HCI_COMMAND_PARAMETERS, static_cast<uint8_t>(-23)));
+  sync_client_handler();
+
+  // The advertiser is taken off the set
+  CompleteCommands({OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+  test_hci_layer_->AssertNoQueuedCommand();
+  AdvertisingMultiplexingMetrics metrics = le_advertising_manager_->GetMultiplexingMetrics();
+  ASSERT_TRUE(metrics.advertisers.empty());
+}
+
+TEST_F(LeExtendedAdvertisingMultiplexingTest, rejected_data_is_reported_to_advertiser) {
+  AdvertiserId advertiser_id = CreateMultiplexedAdvertiser();
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS,
+                    OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA});
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  EXPECT_CALL(mock_advertising_callback_,
+              OnAdvertisingDataSet(advertiser_id,
+                                   AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(
+          uint8_t{1}, ErrorCode::INVALID_HCI_COMMAND_PARAMETERS));
+  sync_client_handler();
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+  test_hci_layer_->AssertNoQueuedCommand();
+}
+
+TEST_F(LeExtendedAdvertisingMultiplexingTest, no_periodic_advertising) {
+  AdvertiserId advertiser_id = CreateMultiplexedAdvertiser();
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS,
+                    OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+                    OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE});
+
+  EXPECT_CALL(mock_advertising_callback_,
+              OnPeriodicAdvertisingEnabled(
+                      advertiser_id, true,
+                      AdvertisingCallback::AdvertisingStatus::FEATURE_UNSUPPORTED));
+  le_advertising_manager_->EnablePeriodicAdvertising(advertiser_id, true, false);
+  sync_client_handler();
+  test_hci_layer_->AssertNoQueuedCommand();
+}
+
 }  // namespace
 }  // namespace hci
 }  // namespace bluetooth
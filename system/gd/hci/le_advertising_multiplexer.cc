@@ -0,0 +1,250 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_advertising_multiplexer.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace bluetooth::hci {
+
+namespace {
+
+constexpr std::chrono::microseconds kIntervalUnit(625);
+
+// Air time, in slices, an advertiser can lag behind the others to save
+// changes of parameters or of advertiser on a set.
+constexpr double kCreditTolerance = 1.0;
+
+}  // namespace
+
+LeAdvertisingMultiplexer::LeAdvertisingMultiplexer(size_t sets, std::chrono::milliseconds slice)
+    : sets_(sets), slice_(slice) {}
+
+void LeAdvertisingMultiplexer::SetAdvertiser(uint8_t advertiser_id,
+                                             MultiplexedAdvertiserParameters parameters,
+                                             std::chrono::steady_clock::time_point now) {
+  Account(now);
+  auto [it, inserted] = advertisers_.try_emplace(advertiser_id);
+  Advertiser& advertiser = it->second;
+  if (inserted) {
+    advertiser.added_at = now;
+  } else if (advertiser.set.has_value() &&
+             advertiser.parameters.parameter_group != parameters.parameter_group) {
+    advertiser.reconfigure = true;
+  }
+  advertiser.parameters = parameters;
+  UpdateShares();
+}
+
+void LeAdvertisingMultiplexer::RemoveAdvertiser(uint8_t advertiser_id,
+                                                std::chrono::steady_clock::time_point now) {
+  Account(now);
+  // The set keeps the advertiser until the next schedule, which disables it
+  // or puts another advertiser on it.
+  advertisers_.erase(advertiser_id);
+  UpdateShares();
+}
+
+std::optional<size_t> LeAdvertisingMultiplexer::GetSet(uint8_t advertiser_id) const {
+  auto it = advertisers_.find(advertiser_id);
+  if (it == advertisers_.end()) {
+    return std::nullopt;
+  }
+  return it->second.set;
+}
+
+void LeAdvertisingMultiplexer::UpdateShares() {
+  std::vector<Advertiser*> uncapped;
+  for (auto& [advertiser_id, advertiser] : advertisers_) {
+    uncapped.push_back(&advertiser);
+  }
+  double capacity = sets_.size();
+  while (!uncapped.empty()) {
+    double weights = 0;
+    for (Advertiser* advertiser : uncapped) {
+      weights += advertiser->parameters.interval;
+    }
+    bool capped = false;
+    for (auto it = uncapped.begin(); it != uncapped.end();) {
+      Advertiser* advertiser = *it;
+      advertiser->share = capacity * advertiser->parameters.interval / weights;
+      if (advertiser->share >= 1) {
+        advertiser->share = 1;
+        capacity -= 1;
+        capped = true;
+        it = uncapped.erase(it);
+      } else {
+        it++;
+      }
+    }
+    if (!capped) {
+      break;
+    }
+  }
+}
+
+void LeAdvertisingMultiplexer::Account(std::chrono::steady_clock::time_point now) {
+  if (accounted_at_.has_value() && now > *accounted_at_) {
+    auto elapsed = now - *accounted_at_;
+    double slices = std::chrono::duration<double>(elapsed) / slice_;
+    for (auto& [advertiser_id, advertiser] : advertisers_) {
+      advertiser.credit += advertiser.share * slices;
+      if (advertiser.set.has_value()) {
+        advertiser.credit -= slices;
+        advertiser.air_time += elapsed;
+      }
+    }
+  }
+  accounted_at_ = now;
+}
+
+std::chrono::steady_clock::duration LeAdvertisingMultiplexer::GetTurn(
+        const Advertiser& advertiser) const {
+  return std::max<std::chrono::steady_clock::duration>(
+          slice_, advertiser.parameters.interval * kIntervalUnit);
+}
+
+std::vector<LeAdvertisingMultiplexer::Change> LeAdvertisingMultiplexer::Schedule(
+        std::chrono::steady_clock::time_point now) {
+  Account(now);
+
+  // Advertisers in the middle of their turn stay on their set.
+  std::vector<std::optional<uint8_t>> assignment(sets_.size());
+  std::vector<uint8_t> candidates;
+  for (const auto& [advertiser_id, advertiser] : advertisers_) {
+    if (advertiser.set.has_value() && advertiser.turn_end > now) {
+      assignment[*advertiser.set] = advertiser_id;
+    } else {
+      candidates.push_back(advertiser_id);
+    }
+  }
+
+  // The other sets get the advertisers owed the most air time. Within the
+  // tolerance, the advertiser already on the set is kept, then advertisers
+  // with the parameters of the set are preferred, then advertisers with
+  // parameters not on air on other sets, so that the next advertisers are
+  // more likely to find a set with their parameters.
+  for (size_t set = 0; set < sets_.size(); set++) {
+    if (assignment[set].has_value()) {
+      continue;
+    }
+    std::vector<uint8_t> eligible;
+    double best_credit = 0;
+    for (uint8_t advertiser_id : candidates) {
+      const Advertiser& advertiser = advertisers_[advertiser_id];
+      if (advertiser.set.has_value() && *advertiser.set != set) {
+        continue;
+      }
+      if (eligible.empty() || advertiser.credit > best_credit) {
+        best_credit = advertiser.credit;
+      }
+      eligible.push_back(advertiser_id);
+    }
+    if (eligible.empty()) {
+      continue;
+    }
+    auto rank = [&](uint8_t advertiser_id) {
+      const Advertiser& advertiser = advertisers_[advertiser_id];
+      uint32_t group = advertiser.parameters.parameter_group;
+      bool group_on_air = false;
+      for (const auto& assigned : assignment) {
+        if (assigned.has_value() && advertisers_[*assigned].parameters.parameter_group == group) {
+          group_on_air = true;
+        }
+      }
+      return std::make_tuple(advertiser.credit < best_credit - kCreditTolerance,
+                             sets_[set].advertiser_id != advertiser_id,
+                             sets_[set].parameter_group != group, group_on_air, -advertiser.credit,
+                             advertiser_id);
+    };
+    uint8_t chosen = *std::min_element(eligible.begin(), eligible.end(),
+                                       [&](uint8_t a, uint8_t b) { return rank(a) < rank(b); });
+    assignment[set] = chosen;
+    candidates.erase(std::find(candidates.begin(), candidates.end(), chosen));
+  }
+
+  for (auto& [advertiser_id, advertiser] : advertisers_) {
+    if (advertiser.set.has_value() && assignment[*advertiser.set] != advertiser_id) {
+      advertiser.set.reset();
+      advertiser.reconfigure = false;
+    }
+  }
+  for (size_t set = 0; set < sets_.size(); set++) {
+    if (assignment[set].has_value() && advertisers_[*assignment[set]].turn_end <= now) {
+      Advertiser& advertiser = advertisers_[*assignment[set]];
+      advertiser.set = set;
+      advertiser.turn_end = now + GetTurn(advertiser);
+    }
+  }
+
+  std::vector<Change> changes;
+  for (size_t set = 0; set < sets_.size(); set++) {
+    Set& current = sets_[set];
+    std::optional<uint8_t> advertiser_id = assignment[set];
+    Advertiser* advertiser = advertiser_id.has_value() ? &advertisers_[*advertiser_id] : nullptr;
+    bool reconfigure = advertiser != nullptr && advertiser->reconfigure;
+    if (current.advertiser_id == advertiser_id && !reconfigure) {
+      continue;
+    }
+    Change change{.set = set, .advertiser_id = advertiser_id, .write_parameters = false};
+    if (advertiser != nullptr) {
+      advertiser->reconfigure = false;
+      change.write_parameters = current.parameter_group != advertiser->parameters.parameter_group;
+      current.parameter_group = advertiser->parameters.parameter_group;
+      statistics_.changes++;
+      if (change.write_parameters) {
+        statistics_.parameter_writes++;
+      }
+    }
+    current.advertiser_id = advertiser_id;
+    changes.push_back(change);
+  }
+  return changes;
+}
+
+std::vector<MultiplexedAdvertiserMetrics> LeAdvertisingMultiplexer::GetMetrics(
+        std::chrono::steady_clock::time_point now) const {
+  std::vector<MultiplexedAdvertiserMetrics> metrics;
+  for (const auto& [advertiser_id, advertiser] : advertisers_) {
+    auto elapsed = now - advertiser.added_at;
+    auto air_time = advertiser.air_time;
+    if (advertiser.set.has_value() && accounted_at_.has_value() && now > *accounted_at_) {
+      air_time += now - *accounted_at_;
+    }
+    auto requested_interval = advertiser.parameters.interval * kIntervalUnit;
+    auto achieved_interval = std::chrono::steady_clock::duration::zero();
+    double air_time_fraction = advertiser.set.has_value() ? 1 : 0;
+    if (elapsed.count() > 0) {
+      air_time_fraction = std::chrono::duration<double>(air_time) / elapsed;
+    }
+    if (air_time_fraction > 0) {
+      achieved_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              requested_interval / air_time_fraction);
+    }
+    metrics.push_back(MultiplexedAdvertiserMetrics{
+            .advertiser_id = advertiser_id,
+            .requested_interval =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(requested_interval),
+            .achieved_interval =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(achieved_interval),
+            .air_time = air_time_fraction,
+            .set = advertiser.set,
+    });
+  }
+  return metrics;
+}
+
+}  // namespace bluetooth::hci
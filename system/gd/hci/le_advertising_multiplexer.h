@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace bluetooth::hci {
+
+struct MultiplexedAdvertiserParameters {
+  /// Requested advertising interval, in units of 0.625 ms.
+  uint16_t interval;
+  /// Advertisers with the same parameter group share the same advertising
+  /// parameters, which are not written again when one replaces the other
+  /// on an advertising set.
+  uint32_t parameter_group;
+};
+
+struct MultiplexedAdvertiserMetrics {
+  uint8_t advertiser_id;
+  std::chrono::milliseconds requested_interval;
+  /// Estimated interval between the advertising events of the advertiser:
+  /// the requested interval divided by the air time, or zero when it was
+  /// never on air. The advertising events themselves are not observed.
+  std::chrono::milliseconds achieved_interval;
+  /// Fraction of the time spent on an advertising set.
+  double air_time;
+  std::optional<size_t> set;
+};
+
+/// Shares a fixed number of advertising sets of the controller between more
+/// advertisers, by time slices.
+///
+/// The advertisers get the same rate of advertising events, unless they
+/// request fewer events: the air time left is shared between the others. An advertiser is kept on air for at least one slice, and at
+/// least one requested interval, so that each turn sends an event. The
+/// advertisers are moved to the sets whose parameters they share, when
+/// possible.
+class LeAdvertisingMultiplexer {
+public:
+  struct Change {
+    size_t set;
+    /// The advertiser to put on the set, or std::nullopt to leave it
+    /// disabled.
+    std::optional<uint8_t> advertiser_id;
+    bool write_parameters;
+  };
+
+  struct Statistics {
+    uint32_t changes;
+    uint32_t parameter_writes;
+  };
+
+  LeAdvertisingMultiplexer(size_t sets, std::chrono::milliseconds slice);
+
+  size_t GetNumberOfSets() const { return sets_.size(); }
+  std::chrono::milliseconds GetSlice() const { return slice_; }
+
+  /// Adds an advertiser, or updates its parameters. An advertiser on air
+  /// with new parameters is put on its set again.
+  void SetAdvertiser(uint8_t advertiser_id, MultiplexedAdvertiserParameters parameters,
+                     std::chrono::steady_clock::time_point now);
+  void RemoveAdvertiser(uint8_t advertiser_id, std::chrono::steady_clock::time_point now);
+  bool HasAdvertiser(uint8_t advertiser_id) const { return advertisers_.count(advertiser_id); }
+  bool IsEmpty() const { return advertisers_.empty(); }
+
+  /// Picks the advertisers on air until the next slice, and returns the
+  /// sets that need to change.
+  std::vector<Change> Schedule(std::chrono::steady_clock::time_point now);
+
+  std::optional<uint8_t> GetAdvertiser(size_t set) const { return sets_[set].advertiser_id; }
+  std::optional<size_t> GetSet(uint8_t advertiser_id) const;
+
+  std::vector<MultiplexedAdvertiserMetrics> GetMetrics(
+          std::chrono::steady_clock::time_point now) const;
+  Statistics GetStatistics() const { return statistics_; }
+
+private:
+  struct Advertiser {
+    MultiplexedAdvertiserParameters parameters;
+    // Share of a set the advertiser gets, and air time it is owed.
+    double share{0};
+    double credit{0};
+    std::optional<size_t> set;
+    std::chrono::steady_clock::time_point turn_end;
+    std::chrono::steady_clock::time_point added_at;
+    std::chrono::steady_clock::duration air_time{};
+    bool reconfigure{false};
+  };
+
+  struct Set {
+    std::optional<uint8_t> advertiser_id;
+    std::optional<uint32_t> parameter_group;
+  };
+
+  // Shares the sets so that the rates of events of the advertisers follow
+  // their priorities, with at most one set per advertiser.
+  void UpdateShares();
+  void Account(std::chrono::steady_clock::time_point now);
+  std::chrono::steady_clock::duration GetTurn(const Advertiser& advertiser) const;
+
+  std::vector<Set> sets_;
+  std::chrono::milliseconds slice_;
+  std::map<uint8_t, Advertiser> advertisers_;
+  std::optional<std::chrono::steady_clock::time_point> accounted_at_;
+  Statistics statistics_{};
+};
+
+}  // namespace bluetooth::hci
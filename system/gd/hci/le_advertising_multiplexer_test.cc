@@ -0,0 +1,186 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_advertising_multiplexer.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+namespace bluetooth::hci {
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+constexpr milliseconds kSlice(1000);
+
+// 100 ms and 1 s, in units of 0.625 ms.
+constexpr uint16_t kShortInterval = 160;
+constexpr uint16_t kLongInterval = 1600;
+
+class LeAdvertisingMultiplexerTest : public ::testing::Test {
+protected:
+  // Schedules every slice for the given number of slices, and returns the
+  // air time of each advertiser, in slices.
+  std::map<uint8_t, int> Run(LeAdvertisingMultiplexer& multiplexer, int slices) {
+    std::map<uint8_t, int> air_time;
+    for (int i = 0; i < slices; i++) {
+      multiplexer.Schedule(now_);
+      for (size_t set = 0; set < multiplexer.GetNumberOfSets(); set++) {
+        auto advertiser_id = multiplexer.GetAdvertiser(set);
+        if (advertiser_id.has_value()) {
+          air_time[*advertiser_id]++;
+        }
+      }
+      now_ += kSlice;
+    }
+    return air_time;
+  }
+
+  steady_clock::time_point now_{};
+};
+
+TEST_F(LeAdvertisingMultiplexerTest, fewer_advertisers_than_sets) {
+  LeAdvertisingMultiplexer multiplexer(3, kSlice);
+  multiplexer.SetAdvertiser(1, {kShortInterval, 0}, now_);
+  multiplexer.SetAdvertiser(2, {kShortInterval, 1}, now_);
+
+  auto changes = multiplexer.Schedule(now_);
+  ASSERT_EQ(changes.size(), 2ul);
+  EXPECT_EQ(changes[0].advertiser_id, std::optional<uint8_t>(1));
+  EXPECT_TRUE(changes[0].write_parameters);
+  EXPECT_EQ(changes[1].advertiser_id, std::optional<uint8_t>(2));
+  EXPECT_TRUE(changes[1].write_parameters);
+
+  now_ += kSlice;
+  auto air_time = Run(multiplexer, 10);
+  EXPECT_EQ(air_time[1], 10);
+  EXPECT_EQ(air_time[2], 10);
+  EXPECT_EQ(multiplexer.GetStatistics().changes, 2u);
+  EXPECT_FALSE(multiplexer.GetSet(3).has_value());
+}
+
+TEST_F(LeAdvertisingMultiplexerTest, advertisers_share_sets) {
+  LeAdvertisingMultiplexer multiplexer(2, kSlice);
+  for (uint8_t id = 1; id <= 4; id++) {
+    multiplexer.SetAdvertiser(id, {kShortInterval, id}, now_);
+  }
+
+  auto air_time = Run(multiplexer, 100);
+  for (uint8_t id = 1; id <= 4; id++) {
+    EXPECT_NEAR(air_time[id], 50, 2);
+  }
+
+  for (const auto& metrics : multiplexer.GetMetrics(now_)) {
+    EXPECT_EQ(metrics.requested_interval, milliseconds(100));
+    EXPECT_NEAR(metrics.air_time, 0.5, 0.02);
+    EXPECT_NEAR(metrics.achieved_interval.count(), 200, 10);
+  }
+}
+
+TEST_F(LeAdvertisingMultiplexerTest, same_rate_of_events) {
+  LeAdvertisingMultiplexer multiplexer(1, kSlice);
+  multiplexer.SetAdvertiser(1, {kShortInterval, 0}, now_);
+  multiplexer.SetAdvertiser(2, {kLongInterval, 1}, now_);
+
+  // The advertiser with the longer interval needs more air time for the
+  // same number of events.
+  Run(multiplexer, 330);
+  auto metrics = multiplexer.GetMetrics(now_);
+  ASSERT_EQ(metrics.size(), 2ul);
+  EXPECT_NEAR(metrics[0].achieved_interval.count(), 1100, 100);
+  EXPECT_NEAR(metrics[1].achieved_interval.count(), 1100, 100);
+}
+
+TEST_F(LeAdvertisingMultiplexerTest, share_is_capped) {
+  LeAdvertisingMultiplexer multiplexer(2, kSlice);
+  // Would need more air time than one set for the same rate of events.
+  multiplexer.SetAdvertiser(1, {kLongInterval, 0}, now_);
+  multiplexer.SetAdvertiser(2, {kShortInterval, 1}, now_);
+  multiplexer.SetAdvertiser(3, {kShortInterval, 2}, now_);
+
+  auto air_time = Run(multiplexer, 100);
+  EXPECT_EQ(air_time[1], 100);
+  EXPECT_NEAR(air_time[2], 50, 2);
+  EXPECT_NEAR(air_time[3], 50, 2);
+}
+
+TEST_F(LeAdvertisingMultiplexerTest, turn_lasts_one_interval) {
+  LeAdvertisingMultiplexer multiplexer(1, kSlice);
+  // 2 s.
+  multiplexer.SetAdvertiser(1, {3200, 0}, now_);
+  multiplexer.SetAdvertiser(2, {3200, 0}, now_);
+
+  ASSERT_EQ(multiplexer.Schedule(now_).size(), 1ul);
+  EXPECT_EQ(multiplexer.GetAdvertiser(0), std::optional<uint8_t>(1));
+  now_ += kSlice;
+  EXPECT_TRUE(multiplexer.Schedule(now_).empty());
+  now_ += kSlice;
+  ASSERT_EQ(multiplexer.Schedule(now_).size(), 1ul);
+  EXPECT_EQ(multiplexer.GetAdvertiser(0), std::optional<uint8_t>(2));
+}
+
+TEST_F(LeAdvertisingMultiplexerTest, advertisers_stay_on_sets_with_their_parameters) {
+  LeAdvertisingMultiplexer multiplexer(2, kSlice);
+  multiplexer.SetAdvertiser(1, {kShortInterval, 0}, now_);
+  multiplexer.SetAdvertiser(2, {kShortInterval, 0}, now_);
+  multiplexer.SetAdvertiser(3, {kShortInterval, 1}, now_);
+  multiplexer.SetAdvertiser(4, {kShortInterval, 1}, now_);
+
+  auto air_time = Run(multiplexer, 100);
+  for (uint8_t id = 1; id <= 4; id++) {
+    EXPECT_NEAR(air_time[id], 50, 2);
+  }
+  // Only the first advertiser on each set writes the parameters.
+  EXPECT_EQ(multiplexer.GetStatistics().parameter_writes, 2u);
+  EXPECT_GT(multiplexer.GetStatistics().changes, 2u);
+}
+
+TEST_F(LeAdvertisingMultiplexerTest, remove_advertiser) {
+  LeAdvertisingMultiplexer multiplexer(1, kSlice);
+  multiplexer.SetAdvertiser(1, {kShortInterval, 0}, now_);
+  ASSERT_EQ(multiplexer.Schedule(now_).size(), 1ul);
+
+  now_ += kSlice;
+  multiplexer.RemoveAdvertiser(1, now_);
+  EXPECT_TRUE(multiplexer.IsEmpty());
+  auto changes = multiplexer.Schedule(now_);
+  ASSERT_EQ(changes.size(), 1ul);
+  EXPECT_EQ(changes[0].set, 0ul);
+  EXPECT_FALSE(changes[0].advertiser_id.has_value());
+  EXPECT_FALSE(multiplexer.GetAdvertiser(0).has_value());
+  EXPECT_TRUE(multiplexer.Schedule(now_).empty());
+}
+
+TEST_F(LeAdvertisingMultiplexerTest, new_parameters) {
+  LeAdvertisingMultiplexer multiplexer(1, kSlice);
+  multiplexer.SetAdvertiser(1, {kShortInterval, 0}, now_);
+  ASSERT_EQ(multiplexer.Schedule(now_).size(), 1ul);
+
+  // The same parameters don't change anything.
+  multiplexer.SetAdvertiser(1, {kShortInterval, 0}, now_);
+  EXPECT_TRUE(multiplexer.Schedule(now_).empty());
+
+  multiplexer.SetAdvertiser(1, {kShortInterval, 1}, now_);
+  auto changes = multiplexer.Schedule(now_);
+  ASSERT_EQ(changes.size(), 1ul);
+  EXPECT_EQ(changes[0].advertiser_id, std::optional<uint8_t>(1));
+  EXPECT_TRUE(changes[0].write_parameters);
+}
+
+}  // namespace
+}  // namespace bluetooth::hci
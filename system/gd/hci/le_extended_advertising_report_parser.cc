@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_extended_advertising_report_parser.h"
+
+namespace bluetooth::hci {
+
+namespace {
+
+// Event code, parameter total length, subevent code and number of reports.
+constexpr size_t kEventHeaderSize = 4;
+constexpr uint8_t kLeMetaEventCode = 0x3e;
+constexpr uint8_t kExtendedAdvertisingReportSubeventCode = 0x0d;
+
+// Size of a report up to its advertising data, the last byte being the
+// length of the advertising data.
+constexpr size_t kReportHeaderSize = 24;
+constexpr uint16_t kEventTypeMask = 0x7f;
+
+uint16_t Uint16(const uint8_t* bytes) { return bytes[0] | (bytes[1] << 8); }
+
+}  // namespace
+
+LeExtendedAdvertisingReportParser::LeExtendedAdvertisingReportParser(
+        std::span<const uint8_t> event)
+    : event_(event) {
+  if (event.size() < kEventHeaderSize || event[0] != kLeMetaEventCode ||
+      event[2] != kExtendedAdvertisingReportSubeventCode) {
+    return;
+  }
+
+  // Check the size of all the reports beforehand, so that the reports of a
+  // truncated event are all ignored.
+  num_reports_ = event[3];
+  size_t offset = kEventHeaderSize;
+  for (uint8_t i = 0; i < num_reports_; i++) {
+    if (event.size() - offset < kReportHeaderSize) {
+      return;
+    }
+    offset += kReportHeaderSize + event[offset + kReportHeaderSize - 1];
+    if (offset > event.size()) {
+      return;
+    }
+  }
+
+  valid_ = true;
+  offset_ = kEventHeaderSize;
+}
+
+std::optional<LeExtendedAdvertisingReportEntry> LeExtendedAdvertisingReportParser::Next() {
+  if (!valid_ || next_report_ == num_reports_) {
+    return std::nullopt;
+  }
+
+  const uint8_t* report = event_.data() + offset_;
+  LeExtendedAdvertisingReportEntry entry{
+          .event_type = static_cast<uint16_t>(Uint16(report) & kEventTypeMask),
+          .address_type = report[2],
+          .address = Address(),
+          .primary_phy = report[9],
+          .secondary_phy = report[10],
+          .advertising_sid = report[11],
+          .tx_power = static_cast<int8_t>(report[12]),
+          .rssi = static_cast<int8_t>(report[13]),
+          .periodic_advertising_interval = Uint16(report + 14),
+          .direct_address_type = report[16],
+          .direct_address = Address(),
+          .advertising_data = event_.subspan(offset_ + kReportHeaderSize, report[23]),
+  };
+  entry.address.FromOctets(report + 3);
+  entry.direct_address.FromOctets(report + 17);
+
+  offset_ += kReportHeaderSize + report[23];
+  next_report_++;
+  return entry;
+}
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "hci/address.h"
+
+namespace bluetooth::hci {
+
+/// Advertising report of an HCI LE Extended Advertising Report event,
+/// with the same fields as LeExtendedAdvertisingResponseRaw.
+/// The advertising data references the bytes of the event.
+struct LeExtendedAdvertisingReportEntry {
+  /// Event type bits 0 to 6: connectable, scannable, directed, scan
+  /// response, legacy, and data status.
+  uint16_t event_type;
+  uint8_t address_type;
+  Address address;
+  uint8_t primary_phy;
+  uint8_t secondary_phy;
+  uint8_t advertising_sid;
+  int8_t tx_power;
+  int8_t rssi;
+  uint16_t periodic_advertising_interval;
+  uint8_t direct_address_type;
+  Address direct_address;
+  std::span<const uint8_t> advertising_data;
+};
+
+/// Parser of the HCI LE Extended Advertising Report events, iterating
+/// over the reports in place without copying their advertising data,
+/// where LeExtendedAdvertisingReportRawView::GetResponses() allocates a
+/// vector of reports and a vector per advertising data.
+class LeExtendedAdvertisingReportParser {
+public:
+  /// |event| holds the complete HCI event, starting with the event code.
+  /// The bytes must outlive the parser and the parsed reports.
+  explicit LeExtendedAdvertisingReportParser(std::span<const uint8_t> event);
+
+  /// Returns true if the event is a well formed LE Extended Advertising
+  /// Report event. The reports of an invalid event are not parsed.
+  bool IsValid() const { return valid_; }
+
+  uint8_t NumReports() const { return num_reports_; }
+
+  /// Returns the next report of the event, or std::nullopt when all the
+  /// reports were returned.
+  std::optional<LeExtendedAdvertisingReportEntry> Next();
+
+private:
+  std::span<const uint8_t> event_;
+  bool valid_{false};
+  uint8_t num_reports_{0};
+  uint8_t next_report_{0};
+  size_t offset_{0};
+};
+
+}  // namespace bluetooth::hci
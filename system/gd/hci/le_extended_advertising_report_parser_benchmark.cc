@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/hci_packets.h"
+#include "hci/le_extended_advertising_report_parser.h"
+#include "hci/le_scanning_reassembler.h"
+
+using ::benchmark::State;
+
+// Count of the allocations, to report the allocations per advertising
+// report. The benchmarks are single threaded.
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t /* size */) noexcept { std::free(p); }
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+constexpr size_t kReportsPerEvent = 4;
+
+// LE Extended Advertising Report event with complete extended advertising
+// reports of 31 bytes, from different advertisers.
+std::shared_ptr<std::vector<uint8_t>> MakeEvent() {
+  auto event = std::make_shared<std::vector<uint8_t>>();
+  *event = {0x3e, 0x00, 0x0d, kReportsPerEvent};
+  for (uint8_t i = 0; i < kReportsPerEvent; i++) {
+    std::vector<uint8_t> report = {0x00, 0x00, 0x01, i,    0x02, 0x03, 0x04, 0x05, 0xc6,
+                                   0x01, 0x02, 0x01, 0x7f, 0xc4, 0x00, 0x00, 0xff, 0x00,
+                                   0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x02, 0x01, 0x06,
+                                   0x1b, 0xff, 0x4c, 0x00, 0x02, 0x15};
+    report.resize(report.size() + 22, i);
+    event->insert(event->end(), report.begin(), report.end());
+  }
+  (*event)[1] = event->size() - 2;
+  return event;
+}
+
+LeExtendedAdvertisingReportRawView MakeView() {
+  return LeExtendedAdvertisingReportRawView::Create(LeMetaEventView::Create(
+          EventView::Create(packet::PacketView<packet::kLittleEndian>(MakeEvent()))));
+}
+
+// Previous processing of the events: the reports are copied by the
+// generated view, then by the reassembler.
+void BM_ExtendedAdvertisingReport_GetResponses(State& state) {
+  LeExtendedAdvertisingReportRawView view = MakeView();
+  LeScanningReassembler reassembler;
+  size_t first_allocation = allocations;
+  for (auto _ : state) {
+    for (LeExtendedAdvertisingResponseRaw& report : view.GetResponses()) {
+      uint16_t event_type = report.connectable_ | (report.scannable_ << 1) |
+                            (report.directed_ << 2) | (report.scan_response_ << 3) |
+                            (report.legacy_ << 4) | ((uint16_t)report.data_status_ << 5);
+      auto complete = reassembler.ProcessAdvertisingReport(
+              event_type, (uint8_t)report.address_type_, report.address_, report.advertising_sid_,
+              report.advertising_data_);
+      benchmark::DoNotOptimize(complete);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kReportsPerEvent);
+  state.counters["allocations_per_report"] =
+          static_cast<double>(allocations - first_allocation) /
+          (state.iterations() * kReportsPerEvent);
+}
+BENCHMARK(BM_ExtendedAdvertisingReport_GetResponses);
+
+// The reports are parsed in place and the complete advertising data is
+// not copied.
+void BM_ExtendedAdvertisingReport_Parser(State& state) {
+  LeExtendedAdvertisingReportRawView view = MakeView();
+  LeScanningReassembler reassembler;
+  size_t first_allocation = allocations;
+  for (auto _ : state) {
+    LeExtendedAdvertisingReportParser parser(*view.GetContiguousBytes());
+    while (std::optional<LeExtendedAdvertisingReportEntry> report = parser.Next()) {
+      auto complete = reassembler.ProcessAdvertisingReportView(
+              report->event_type, report->address_type, report->address, report->advertising_sid,
+              report->advertising_data);
+      benchmark::DoNotOptimize(complete);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kReportsPerEvent);
+  state.counters["allocations_per_report"] =
+          static_cast<double>(allocations - first_allocation) /
+          (state.iterations() * kReportsPerEvent);
+}
+BENCHMARK(BM_ExtendedAdvertisingReport_Parser);
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
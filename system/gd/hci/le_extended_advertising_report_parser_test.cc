@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_extended_advertising_report_parser.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "hci/hci_packets.h"
+#include "packet/bit_inserter.h"
+
+namespace bluetooth::hci {
+namespace {
+
+// LE Extended Advertising Report event with two reports.
+const std::vector<uint8_t> kEvent = {
+        0x3e, 0x39, 0x0d, 0x02,
+        // Connectable legacy advertising, public address 12:34:56:78:9a:bc
+        0x11, 0x00, 0x00, 0xbc, 0x9a, 0x78, 0x56, 0x34, 0x12, 0x01, 0x00, 0xff, 0x7f, 0xc4, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x06,
+        // Incomplete extended advertising, random address, SID 3, on the 2M PHY
+        0x20, 0x00, 0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0xc6, 0x01, 0x02, 0x03, 0xf6, 0xd0, 0x20,
+        0x00, 0x01, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x04, 0x03, 0x09, 'a', 'b'};
+
+TEST(LeExtendedAdvertisingReportParserTest, parse_reports) {
+  LeExtendedAdvertisingReportParser parser(kEvent);
+  ASSERT_TRUE(parser.IsValid());
+  ASSERT_EQ(parser.NumReports(), 2);
+
+  std::optional<LeExtendedAdvertisingReportEntry> report = parser.Next();
+  ASSERT_TRUE(report.has_value());
+  ASSERT_EQ(report->event_type, 0x11);
+  ASSERT_EQ(report->address_type, 0x00);
+  ASSERT_EQ(report->address, Address({0xbc, 0x9a, 0x78, 0x56, 0x34, 0x12}));
+  ASSERT_EQ(report->primary_phy, 0x01);
+  ASSERT_EQ(report->secondary_phy, 0x00);
+  ASSERT_EQ(report->advertising_sid, 0xff);
+  ASSERT_EQ(report->tx_power, 0x7f);
+  ASSERT_EQ(report->rssi, -60);
+  ASSERT_EQ(report->periodic_advertising_interval, 0);
+  ASSERT_EQ(std::vector<uint8_t>(report->advertising_data.begin(), report->advertising_data.end()),
+            std::vector<uint8_t>({0x02, 0x01, 0x06}));
+  // The advertising data is not copied.
+  ASSERT_EQ(report->advertising_data.data(), kEvent.data() + 28);
+
+  report = parser.Next();
+  ASSERT_TRUE(report.has_value());
+  ASSERT_EQ(report->event_type, 0x20);
+  ASSERT_EQ(report->address_type, 0x01);
+  ASSERT_EQ(report->address, Address({0x01, 0x02, 0x03, 0x04, 0x05, 0xc6}));
+  ASSERT_EQ(report->primary_phy, 0x01);
+  ASSERT_EQ(report->secondary_phy, 0x02);
+  ASSERT_EQ(report->advertising_sid, 0x03);
+  ASSERT_EQ(report->tx_power, -10);
+  ASSERT_EQ(report->rssi, -48);
+  ASSERT_EQ(report->periodic_advertising_interval, 0x20);
+  ASSERT_EQ(report->direct_address_type, 0x01);
+  ASSERT_EQ(report->direct_address, Address({0x06, 0x05, 0x04, 0x03, 0x02, 0x01}));
+  ASSERT_EQ(std::vector<uint8_t>(report->advertising_data.begin(), report->advertising_data.end()),
+            std::vector<uint8_t>({0x03, 0x09, 'a', 'b'}));
+
+  ASSERT_FALSE(parser.Next().has_value());
+}
+
+TEST(LeExtendedAdvertisingReportParserTest, invalid_events) {
+  // Truncated event: none of the reports is parsed.
+  std::vector<uint8_t> truncated(kEvent.begin(), kEvent.end() - 1);
+  LeExtendedAdvertisingReportParser truncated_parser(truncated);
+  ASSERT_FALSE(truncated_parser.IsValid());
+  ASSERT_FALSE(truncated_parser.Next().has_value());
+
+  // Report header truncated.
+  std::vector<uint8_t> header_only(kEvent.begin(), kEvent.begin() + 20);
+  ASSERT_FALSE(LeExtendedAdvertisingReportParser(header_only).IsValid());
+
+  // Other LE meta events.
+  std::vector<uint8_t> advertising_report(kEvent);
+  advertising_report[2] = 0x02;
+  ASSERT_FALSE(LeExtendedAdvertisingReportParser(advertising_report).IsValid());
+
+  // Empty event.
+  std::vector<uint8_t> empty = {0x3e, 0x02, 0x0d, 0x00};
+  LeExtendedAdvertisingReportParser empty_parser(empty);
+  ASSERT_TRUE(empty_parser.IsValid());
+  ASSERT_EQ(empty_parser.NumReports(), 0);
+  ASSERT_FALSE(empty_parser.Next().has_value());
+}
+
+TEST(LeExtendedAdvertisingReportParserTest, same_as_generated_view) {
+  LeExtendedAdvertisingResponse response{};
+  response.connectable_ = 1;
+  response.scan_response_ = 1;
+  response.data_status_ = DataStatus::TRUNCATED;
+  response.address_type_ = DirectAdvertisingAddressType::RANDOM_DEVICE_ADDRESS;
+  Address::FromString("12:34:56:78:9a:bc", response.address_);
+  response.primary_phy_ = PrimaryPhyType::LE_CODED;
+  response.secondary_phy_ = SecondaryPhyType::LE_CODED;
+  response.advertising_sid_ = 0x0e;
+  response.tx_power_ = 0x04;
+  response.rssi_ = 0xb0;
+  response.periodic_advertising_interval_ = 0x1234;
+  LengthAndData data{};
+  data.data_ = {static_cast<uint8_t>(GapDataType::COMPLETE_LOCAL_NAME), 'n', 'a', 'm', 'e'};
+  response.advertising_data_ = {data};
+
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  packet::BitInserter inserter(*bytes);
+  LeExtendedAdvertisingReportBuilder::Create({response})->Serialize(inserter);
+
+  auto view = LeExtendedAdvertisingReportRawView::Create(LeMetaEventView::Create(
+          EventView::Create(packet::PacketView<packet::kLittleEndian>(bytes))));
+  ASSERT_TRUE(view.IsValid());
+  std::vector<LeExtendedAdvertisingResponseRaw> responses = view.GetResponses();
+  ASSERT_EQ(responses.size(), 1u);
+  const LeExtendedAdvertisingResponseRaw& expected = responses[0];
+
+  LeExtendedAdvertisingReportParser parser(*bytes);
+  ASSERT_TRUE(parser.IsValid());
+  std::optional<LeExtendedAdvertisingReportEntry> report = parser.Next();
+  ASSERT_TRUE(report.has_value());
+  ASSERT_EQ(report->event_type, expected.connectable_ | (expected.scannable_ << 1) |
+                                        (expected.directed_ << 2) | (expected.scan_response_ << 3) |
+                                        (expected.legacy_ << 4) |
+                                        ((uint16_t)expected.data_status_ << 5));
+  ASSERT_EQ(report->address_type, (uint8_t)expected.address_type_);
+  ASSERT_EQ(report->address, expected.address_);
+  ASSERT_EQ(report->primary_phy, (uint8_t)expected.primary_phy_);
+  ASSERT_EQ(report->secondary_phy, (uint8_t)expected.secondary_phy_);
+  ASSERT_EQ(report->advertising_sid, expected.advertising_sid_);
+  ASSERT_EQ(report->tx_power, (int8_t)expected.tx_power_);
+  ASSERT_EQ(report->rssi, (int8_t)expected.rssi_);
+  ASSERT_EQ(report->periodic_advertising_interval, expected.periodic_advertising_interval_);
+  ASSERT_EQ(std::vector<uint8_t>(report->advertising_data.begin(), report->advertising_data.end()),
+            expected.advertising_data_);
+  ASSERT_FALSE(parser.Next().has_value());
+}
+
+}  // namespace
+}  // namespace bluetooth::hci
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_filter_list_reconciler.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace bluetooth::hci {
+
+namespace {
+
+// Resolvable private addresses seen in a few seconds of scanning, so that the keys are not tried
+// again for every advertising report.
+constexpr size_t kHostResolutionCacheSize = 256;
+
+FilterAcceptListAddressType ToFilterAcceptListAddressType(PeerAddressType address_type) {
+  return address_type == PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS
+                 ? FilterAcceptListAddressType::PUBLIC
+                 : FilterAcceptListAddressType::RANDOM;
+}
+
+AddressType ToIdentityAddressType(PeerAddressType address_type) {
+  return address_type == PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS
+                 ? AddressType::PUBLIC_IDENTITY_ADDRESS
+                 : AddressType::RANDOM_IDENTITY_ADDRESS;
+}
+
+}  // namespace
+
+LeFilterListReconciler::LeFilterListReconciler(size_t accept_list_size,
+                                               size_t resolving_list_size)
+    : accept_list_size_(accept_list_size), resolving_list_size_(resolving_list_size) {}
+
+void LeFilterListReconciler::AddToAcceptList(FilterAcceptListAddressType address_type,
+                                             Address address, FilterListPriority priority) {
+  auto [it, inserted] = accept_list_.try_emplace({address_type, address},
+                                                 WantedAcceptListEntry{priority, next_sequence_});
+  if (inserted) {
+    next_sequence_++;
+    changed_ = true;
+  } else if (it->second.priority < priority) {
+    it->second.priority = priority;
+    changed_ = true;
+  }
+}
+
+void LeFilterListReconciler::RemoveFromAcceptList(FilterAcceptListAddressType address_type,
+                                                  Address address) {
+  if (accept_list_.erase({address_type, address}) > 0) {
+    changed_ = true;
+  }
+}
+
+void LeFilterListReconciler::SetAcceptListPriority(FilterAcceptListAddressType address_type,
+                                                   Address address, FilterListPriority priority) {
+  auto it = accept_list_.find({address_type, address});
+  if (it == accept_list_.end() || it->second.priority == priority) {
+    return;
+  }
+  it->second.priority = priority;
+  // The priority only picks the devices written to a list that is too small for all of them.
+  if (accept_list_.size() > accept_list_size_ || resolving_list_.size() > resolving_list_size_) {
+    changed_ = true;
+  }
+}
+
+void LeFilterListReconciler::ClearAcceptList() {
+  accept_list_.clear();
+  clear_accept_list_ = true;
+  changed_ = true;
+}
+
+void LeFilterListReconciler::AddToResolvingList(PeerAddressType address_type, Address address,
+                                                const Octet16& peer_irk, const Octet16& local_irk,
+                                                FilterListPriority priority) {
+  auto [it, inserted] = resolving_list_.try_emplace(
+          {address_type, address},
+          WantedResolvingListEntry{peer_irk, local_irk, priority, next_sequence_});
+  if (inserted) {
+    next_sequence_++;
+    changed_ = true;
+    return;
+  }
+  WantedResolvingListEntry& entry = it->second;
+  if (entry.peer_irk != peer_irk || entry.local_irk != local_irk || entry.priority < priority) {
+    entry.peer_irk = peer_irk;
+    entry.local_irk = local_irk;
+    entry.priority = std::max(entry.priority, priority);
+    changed_ = true;
+  }
+}
+
+void LeFilterListReconciler::RemoveFromResolvingList(PeerAddressType address_type,
+                                                     Address address) {
+  if (resolving_list_.erase({address_type, address}) > 0) {
+    changed_ = true;
+  }
+}
+
+void LeFilterListReconciler::ClearResolvingList() {
+  resolving_list_.clear();
+  clear_resolving_list_ = true;
+  changed_ = true;
+}
+
+std::vector<LeFilterListReconciler::AcceptListKey> LeFilterListReconciler::SelectAcceptList()
+        const {
+  std::vector<AcceptListKey> keys;
+  for (const auto& [key, entry] : accept_list_) {
+    keys.push_back(key);
+  }
+  auto rank = [this](const AcceptListKey& key) {
+    const WantedAcceptListEntry& entry = accept_list_.at(key);
+    return std::make_tuple(-static_cast<int>(entry.priority),
+                           controller_accept_list_.count(key) == 0, entry.sequence);
+  };
+  std::sort(keys.begin(), keys.end(),
+            [&](const AcceptListKey& a, const AcceptListKey& b) { return rank(a) < rank(b); });
+  keys.resize(std::min(keys.size(), accept_list_size_));
+  return keys;
+}
+
+std::vector<LeFilterListReconciler::ResolvingListKey> LeFilterListReconciler::SelectResolvingList(
+        const std::vector<AcceptListKey>& accept_list) const {
+  std::map<AcceptListKey, FilterListPriority> in_accept_list;
+  for (const AcceptListKey& key : accept_list) {
+    in_accept_list[key] = accept_list_.at(key).priority;
+  }
+  std::vector<ResolvingListKey> keys;
+  for (const auto& [key, entry] : resolving_list_) {
+    keys.push_back(key);
+  }
+  auto rank = [&](const ResolvingListKey& key) {
+    const WantedResolvingListEntry& entry = resolving_list_.at(key);
+    FilterListPriority priority = entry.priority;
+    auto accept_list_entry =
+            in_accept_list.find({ToFilterAcceptListAddressType(key.first), key.second});
+    if (accept_list_entry != in_accept_list.end()) {
+      priority = std::max(priority, accept_list_entry->second);
+    }
+    auto controller_entry = controller_resolving_list_.find(key);
+    bool in_controller = controller_entry != controller_resolving_list_.end() &&
+                         controller_entry->second.peer_irk == entry.peer_irk &&
+                         controller_entry->second.local_irk == entry.local_irk;
+    return std::make_tuple(accept_list_entry == in_accept_list.end(),
+                           -static_cast<int>(priority), !in_controller, entry.sequence);
+  };
+  std::sort(keys.begin(), keys.end(), [&](const ResolvingListKey& a, const ResolvingListKey& b) {
+    return rank(a) < rank(b);
+  });
+  keys.resize(std::min(keys.size(), resolving_list_size_));
+  return keys;
+}
+
+LeFilterListReconciler::Changes LeFilterListReconciler::Reconcile() {
+  Changes changes;
+
+  // A single clear replaces the removals when nothing is left in the list.
+  auto accept_list = SelectAcceptList();
+  std::set<AcceptListKey> selected_accept_list(accept_list.begin(), accept_list.end());
+  for (const AcceptListKey& key : controller_accept_list_) {
+    if (selected_accept_list.count(key) == 0) {
+      changes.accept_list_removals.push_back({key.first, key.second});
+    }
+  }
+  if (clear_accept_list_ ||
+      (changes.accept_list_removals.size() > 1 &&
+       changes.accept_list_removals.size() == controller_accept_list_.size())) {
+    changes.clear_accept_list = true;
+    changes.accept_list_removals.clear();
+    controller_accept_list_.clear();
+  }
+  for (const auto& entry : changes.accept_list_removals) {
+    controller_accept_list_.erase({entry.address_type, entry.address});
+  }
+  for (const AcceptListKey& key : accept_list) {
+    if (controller_accept_list_.insert(key).second) {
+      changes.accept_list_additions.push_back({key.first, key.second});
+    }
+  }
+  accept_list_overflows_ = accept_list_.size() - accept_list.size();
+
+  auto resolving_list = SelectResolvingList(accept_list);
+  std::set<ResolvingListKey> selected_resolving_list(resolving_list.begin(), resolving_list.end());
+  for (const auto& [key, controller_entry] : controller_resolving_list_) {
+    auto entry = resolving_list_.find(key);
+    if (selected_resolving_list.count(key) == 0 ||
+        entry->second.peer_irk != controller_entry.peer_irk ||
+        entry->second.local_irk != controller_entry.local_irk) {
+      changes.resolving_list_removals.push_back(
+              {key.first, key.second, controller_entry.peer_irk, controller_entry.local_irk});
+    }
+  }
+  if (clear_resolving_list_ ||
+      (changes.resolving_list_removals.size() > 1 &&
+       changes.resolving_list_removals.size() == controller_resolving_list_.size())) {
+    changes.clear_resolving_list = true;
+    changes.resolving_list_removals.clear();
+    controller_resolving_list_.clear();
+  }
+  for (const auto& entry : changes.resolving_list_removals) {
+    controller_resolving_list_.erase({entry.address_type, entry.address});
+  }
+  for (const ResolvingListKey& key : resolving_list) {
+    const WantedResolvingListEntry& entry = resolving_list_.at(key);
+    auto [it, inserted] = controller_resolving_list_.try_emplace(
+            key, ControllerResolvingListEntry{entry.peer_irk, entry.local_irk});
+    if (inserted) {
+      changes.resolving_list_additions.push_back(
+              {key.first, key.second, entry.peer_irk, entry.local_irk});
+    }
+  }
+
+  host_resolved_devices_.clear();
+  host_resolution_cache_.clear();
+  for (const auto& [key, entry] : resolving_list_) {
+    if (selected_resolving_list.count(key) == 0) {
+      host_resolved_devices_.push_back({key.first, key.second, entry.peer_irk, entry.local_irk});
+    }
+  }
+
+  clear_accept_list_ = false;
+  clear_resolving_list_ = false;
+  changed_ = false;
+  return changes;
+}
+
+void LeFilterListReconciler::OnAcceptListAdditionFailed(const AcceptListEntry& entry,
+                                                        ErrorCode status) {
+  AcceptListKey key{entry.address_type, entry.address};
+  controller_accept_list_.erase(key);
+  if (accept_list_.count(key) > 0) {
+    accept_list_overflows_++;
+  }
+  if (status == ErrorCode::MEMORY_CAPACITY_EXCEEDED) {
+    // Let the devices of higher priority take the place of the others.
+    accept_list_size_ = std::min(accept_list_size_, controller_accept_list_.size());
+    changed_ = true;
+  }
+}
+
+void LeFilterListReconciler::OnResolvingListAdditionFailed(const ResolvingListEntry& entry,
+                                                           ErrorCode status) {
+  ResolvingListKey key{entry.address_type, entry.address};
+  controller_resolving_list_.erase(key);
+  auto wanted = resolving_list_.find(key);
+  if (wanted != resolving_list_.end()) {
+    host_resolved_devices_.push_back(
+            {key.first, key.second, wanted->second.peer_irk, wanted->second.local_irk});
+    host_resolution_cache_.clear();
+  }
+  if (status == ErrorCode::MEMORY_CAPACITY_EXCEEDED) {
+    resolving_list_size_ = std::min(resolving_list_size_, controller_resolving_list_.size());
+    changed_ = true;
+  }
+}
+
+std::optional<AddressWithType> LeFilterListReconciler::ResolveOnHost(const Address& address) {
+  if (host_resolved_devices_.empty()) {
+    return std::nullopt;
+  }
+  AddressWithType random_address(address, AddressType::RANDOM_DEVICE_ADDRESS);
+  if (!random_address.IsRpa()) {
+    return std::nullopt;
+  }
+  auto cached = host_resolution_cache_.find(address);
+  if (cached != host_resolution_cache_.end()) {
+    return cached->second;
+  }
+
+  std::optional<AddressWithType> identity_address;
+  for (const ResolvingListEntry& entry : host_resolved_devices_) {
+    if (random_address.IsRpaThatMatchesIrk(entry.peer_irk)) {
+      identity_address = AddressWithType(entry.address, ToIdentityAddressType(entry.address_type));
+      break;
+    }
+  }
+  if (host_resolution_cache_.size() >= kHostResolutionCacheSize) {
+    host_resolution_cache_.clear();
+  }
+  host_resolution_cache_.emplace(address, identity_address);
+  return identity_address;
+}
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "hci/address.h"
+#include "hci/address_with_type.h"
+#include "hci/hci_packets.h"
+#include "hci/octets.h"
+
+namespace bluetooth::hci {
+
+/// When a list of the controller is too small for all the devices, the devices of higher priority
+/// are written to it first.
+enum class FilterListPriority : uint8_t {
+  BACKGROUND = 0,
+  DIRECT = 1,
+};
+
+/// Keeps the filter accept list and the resolving list wanted by the host, along with the lists
+/// written to the controller, and computes the commands that bring the controller up to date.
+///
+/// Changes made between two reconciliations cancel out: a device removed and added back costs no
+/// command. When a list of the controller is too small, it gets the devices of highest priority,
+/// and keeps the devices it already holds over the devices of the same priority. Resolving list
+/// entries of devices in the accept list come first, since the controller only matches the
+/// resolvable private addresses of a device to its accept list entry when it resolves them. The
+/// devices left out of the resolving list are resolved by the host.
+class LeFilterListReconciler {
+public:
+  struct AcceptListEntry {
+    FilterAcceptListAddressType address_type;
+    Address address;
+  };
+
+  struct ResolvingListEntry {
+    PeerAddressType address_type;
+    Address address;
+    Octet16 peer_irk;
+    Octet16 local_irk;
+  };
+
+  /// Commands to send, in this order: clear, removals, then additions.
+  struct Changes {
+    bool clear_accept_list{false};
+    std::vector<AcceptListEntry> accept_list_removals;
+    std::vector<AcceptListEntry> accept_list_additions;
+    bool clear_resolving_list{false};
+    std::vector<ResolvingListEntry> resolving_list_removals;
+    std::vector<ResolvingListEntry> resolving_list_additions;
+
+    bool AcceptListChanged() const {
+      return clear_accept_list || !accept_list_removals.empty() || !accept_list_additions.empty();
+    }
+    bool ResolvingListChanged() const {
+      return clear_resolving_list || !resolving_list_removals.empty() ||
+             !resolving_list_additions.empty();
+    }
+    bool IsEmpty() const { return !AcceptListChanged() && !ResolvingListChanged(); }
+  };
+
+  LeFilterListReconciler(size_t accept_list_size, size_t resolving_list_size);
+
+  void AddToAcceptList(FilterAcceptListAddressType address_type, Address address,
+                       FilterListPriority priority);
+  void RemoveFromAcceptList(FilterAcceptListAddressType address_type, Address address);
+  /// Changes the priority of a device already in the accept list, up or down. Adding a device
+  /// only ever raises its priority.
+  void SetAcceptListPriority(FilterAcceptListAddressType address_type, Address address,
+                             FilterListPriority priority);
+  /// Also clears the list of the controller, in case it holds devices the host doesn't know of.
+  void ClearAcceptList();
+
+  void AddToResolvingList(PeerAddressType address_type, Address address, const Octet16& peer_irk,
+                          const Octet16& local_irk, FilterListPriority priority);
+  void RemoveFromResolvingList(PeerAddressType address_type, Address address);
+  /// Also clears the list of the controller, in case it holds devices the host doesn't know of.
+  void ClearResolvingList();
+
+  /// Whether the lists changed since the last reconciliation.
+  bool HasChanges() const { return changed_; }
+
+  /// Returns the commands that bring the lists of the controller up to date, and assumes they
+  /// succeed.
+  Changes Reconcile();
+
+  /// Takes the entry back out of the list of the controller. A controller out of memory is
+  /// assumed to be full, and the list size is lowered to the number of entries it holds.
+  void OnAcceptListAdditionFailed(const AcceptListEntry& entry, ErrorCode status);
+  void OnResolvingListAdditionFailed(const ResolvingListEntry& entry, ErrorCode status);
+
+  size_t GetAcceptListSize() const { return accept_list_size_; }
+  size_t GetResolvingListSize() const { return resolving_list_size_; }
+  /// Devices of the accept list that are not in the list of the controller.
+  size_t GetNumberOfAcceptListOverflows() const { return accept_list_overflows_; }
+  /// Devices of the resolving list that are not in the list of the controller.
+  size_t GetNumberOfHostResolvedDevices() const { return host_resolved_devices_.size(); }
+
+  /// Resolves a resolvable private address with the keys of the devices left out of the resolving
+  /// list of the controller, and returns the identity address of the device. Only the addresses
+  /// of advertising reports are resolved this way: the controller can't connect to these devices
+  /// through its accept list, which is why the devices of direct connections are given the
+  /// resolving list first.
+  std::optional<AddressWithType> ResolveOnHost(const Address& address);
+
+private:
+  using AcceptListKey = std::pair<FilterAcceptListAddressType, Address>;
+  using ResolvingListKey = std::pair<PeerAddressType, Address>;
+
+  struct WantedAcceptListEntry {
+    FilterListPriority priority;
+    uint64_t sequence;
+  };
+
+  struct WantedResolvingListEntry {
+    Octet16 peer_irk;
+    Octet16 local_irk;
+    FilterListPriority priority;
+    uint64_t sequence;
+  };
+
+  struct ControllerResolvingListEntry {
+    Octet16 peer_irk;
+    Octet16 local_irk;
+  };
+
+  std::vector<AcceptListKey> SelectAcceptList() const;
+  std::vector<ResolvingListKey> SelectResolvingList(
+          const std::vector<AcceptListKey>& accept_list) const;
+
+  size_t accept_list_size_;
+  size_t resolving_list_size_;
+  uint64_t next_sequence_{0};
+  bool changed_{false};
+  bool clear_accept_list_{false};
+  bool clear_resolving_list_{false};
+
+  std::map<AcceptListKey, WantedAcceptListEntry> accept_list_;
+  std::map<ResolvingListKey, WantedResolvingListEntry> resolving_list_;
+  std::set<AcceptListKey> controller_accept_list_;
+  std::map<ResolvingListKey, ControllerResolvingListEntry> controller_resolving_list_;
+
+  size_t accept_list_overflows_{0};
+  std::vector<ResolvingListEntry> host_resolved_devices_;
+  // Resolvable private addresses already looked up, resolved or not.
+  std::map<Address, std::optional<AddressWithType>> host_resolution_cache_;
+};
+
+}  // namespace bluetooth::hci
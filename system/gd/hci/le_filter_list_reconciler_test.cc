@@ -0,0 +1,277 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_filter_list_reconciler.h"
+
+#include <gtest/gtest.h>
+
+#include "crypto_toolbox/crypto_toolbox.h"
+
+namespace bluetooth::hci {
+namespace {
+
+constexpr auto kPublic = FilterAcceptListAddressType::PUBLIC;
+constexpr auto kRandom = FilterAcceptListAddressType::RANDOM;
+constexpr auto kBackground = FilterListPriority::BACKGROUND;
+constexpr auto kDirect = FilterListPriority::DIRECT;
+
+const Octet16 kLocalIrk = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+                           0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10};
+
+Address MakeAddress(uint8_t id) { return Address({id, 0x00, 0x00, 0x00, 0x00, 0xc0}); }
+
+Octet16 MakeIrk(uint8_t id) {
+  Octet16 irk{};
+  irk.fill(id);
+  return irk;
+}
+
+Address MakeRpa(const Octet16& irk) {
+  Octet16 prand{};
+  prand[0] = 0x12;
+  prand[1] = 0x34;
+  prand[2] = 0x56;
+  Octet16 hash = crypto_toolbox::aes_128(irk, prand);
+  return Address({hash[0], hash[1], hash[2], prand[0], prand[1], prand[2]});
+}
+
+std::vector<Address> Addresses(const std::vector<LeFilterListReconciler::AcceptListEntry>& list) {
+  std::vector<Address> addresses;
+  for (const auto& entry : list) {
+    addresses.push_back(entry.address);
+  }
+  return addresses;
+}
+
+std::vector<Address> Addresses(
+        const std::vector<LeFilterListReconciler::ResolvingListEntry>& list) {
+  std::vector<Address> addresses;
+  for (const auto& entry : list) {
+    addresses.push_back(entry.address);
+  }
+  return addresses;
+}
+
+TEST(LeFilterListReconcilerTest, changes_are_applied_in_one_batch) {
+  LeFilterListReconciler reconciler(8, 8);
+  EXPECT_FALSE(reconciler.HasChanges());
+  for (uint8_t id = 1; id <= 3; id++) {
+    reconciler.AddToAcceptList(kRandom, MakeAddress(id), kBackground);
+  }
+  reconciler.AddToResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, MakeAddress(1),
+                                MakeIrk(1), kLocalIrk, kBackground);
+  EXPECT_TRUE(reconciler.HasChanges());
+
+  auto changes = reconciler.Reconcile();
+  EXPECT_FALSE(changes.clear_accept_list);
+  EXPECT_TRUE(changes.accept_list_removals.empty());
+  EXPECT_EQ(Addresses(changes.accept_list_additions),
+            std::vector<Address>({MakeAddress(1), MakeAddress(2), MakeAddress(3)}));
+  EXPECT_EQ(Addresses(changes.resolving_list_additions), std::vector<Address>({MakeAddress(1)}));
+  EXPECT_FALSE(reconciler.HasChanges());
+  EXPECT_TRUE(reconciler.Reconcile().IsEmpty());
+}
+
+TEST(LeFilterListReconcilerTest, changes_cancel_out) {
+  LeFilterListReconciler reconciler(8, 8);
+  reconciler.AddToAcceptList(kPublic, MakeAddress(1), kBackground);
+  reconciler.Reconcile();
+
+  reconciler.RemoveFromAcceptList(kPublic, MakeAddress(1));
+  reconciler.AddToAcceptList(kPublic, MakeAddress(1), kBackground);
+  reconciler.AddToAcceptList(kPublic, MakeAddress(2), kBackground);
+  reconciler.RemoveFromAcceptList(kPublic, MakeAddress(2));
+  EXPECT_TRUE(reconciler.HasChanges());
+  EXPECT_TRUE(reconciler.Reconcile().IsEmpty());
+}
+
+TEST(LeFilterListReconcilerTest, clear_replaces_removals) {
+  LeFilterListReconciler reconciler(8, 8);
+  for (uint8_t id = 1; id <= 3; id++) {
+    reconciler.AddToAcceptList(kRandom, MakeAddress(id), kBackground);
+  }
+  reconciler.Reconcile();
+
+  reconciler.RemoveFromAcceptList(kRandom, MakeAddress(1));
+  auto changes = reconciler.Reconcile();
+  EXPECT_FALSE(changes.clear_accept_list);
+  EXPECT_EQ(Addresses(changes.accept_list_removals), std::vector<Address>({MakeAddress(1)}));
+
+  reconciler.RemoveFromAcceptList(kRandom, MakeAddress(2));
+  reconciler.RemoveFromAcceptList(kRandom, MakeAddress(3));
+  changes = reconciler.Reconcile();
+  EXPECT_TRUE(changes.clear_accept_list);
+  EXPECT_TRUE(changes.accept_list_removals.empty());
+  EXPECT_TRUE(changes.accept_list_additions.empty());
+}
+
+TEST(LeFilterListReconcilerTest, clear_is_always_sent) {
+  LeFilterListReconciler reconciler(8, 8);
+  reconciler.ClearAcceptList();
+  reconciler.ClearResolvingList();
+  auto changes = reconciler.Reconcile();
+  EXPECT_TRUE(changes.clear_accept_list);
+  EXPECT_TRUE(changes.clear_resolving_list);
+}
+
+TEST(LeFilterListReconcilerTest, accept_list_priority) {
+  LeFilterListReconciler reconciler(2, 8);
+  reconciler.AddToAcceptList(kRandom, MakeAddress(1), kBackground);
+  reconciler.AddToAcceptList(kRandom, MakeAddress(2), kBackground);
+  reconciler.AddToAcceptList(kRandom, MakeAddress(3), kBackground);
+  reconciler.AddToAcceptList(kRandom, MakeAddress(4), kDirect);
+
+  auto changes = reconciler.Reconcile();
+  EXPECT_EQ(Addresses(changes.accept_list_additions),
+            std::vector<Address>({MakeAddress(4), MakeAddress(1)}));
+  EXPECT_EQ(reconciler.GetNumberOfAcceptListOverflows(), 2ul);
+
+  // A device of the same priority doesn't take the place of a device already written.
+  reconciler.RemoveFromAcceptList(kRandom, MakeAddress(4));
+  reconciler.RemoveFromAcceptList(kRandom, MakeAddress(1));
+  reconciler.AddToAcceptList(kRandom, MakeAddress(1), kBackground);
+  changes = reconciler.Reconcile();
+  EXPECT_EQ(Addresses(changes.accept_list_removals), std::vector<Address>({MakeAddress(4)}));
+  EXPECT_EQ(Addresses(changes.accept_list_additions), std::vector<Address>({MakeAddress(2)}));
+  EXPECT_EQ(reconciler.GetNumberOfAcceptListOverflows(), 1ul);
+}
+
+TEST(LeFilterListReconcilerTest, accept_list_priority_is_raised_and_lowered) {
+  LeFilterListReconciler reconciler(1, 8);
+  reconciler.AddToAcceptList(kRandom, MakeAddress(1), kBackground);
+  reconciler.AddToAcceptList(kRandom, MakeAddress(2), kBackground);
+  auto changes = reconciler.Reconcile();
+  EXPECT_EQ(Addresses(changes.accept_list_additions), std::vector<Address>({MakeAddress(1)}));
+
+  // A direct connection to a device already in the accept list
+  reconciler.SetAcceptListPriority(kRandom, MakeAddress(2), kDirect);
+  EXPECT_TRUE(reconciler.HasChanges());
+  changes = reconciler.Reconcile();
+  EXPECT_EQ(Addresses(changes.accept_list_removals), std::vector<Address>({MakeAddress(1)}));
+  EXPECT_EQ(Addresses(changes.accept_list_additions), std::vector<Address>({MakeAddress(2)}));
+
+  // Once it is done, the device keeps its place over the devices of the same priority
+  reconciler.SetAcceptListPriority(kRandom, MakeAddress(2), kBackground);
+  EXPECT_TRUE(reconciler.Reconcile().IsEmpty());
+  reconciler.AddToAcceptList(kRandom, MakeAddress(1), kDirect);
+  changes = reconciler.Reconcile();
+  EXPECT_EQ(Addresses(changes.accept_list_additions), std::vector<Address>({MakeAddress(1)}));
+}
+
+TEST(LeFilterListReconcilerTest, accept_list_priority_without_overflow_changes_nothing) {
+  LeFilterListReconciler reconciler(8, 8);
+  reconciler.AddToAcceptList(kRandom, MakeAddress(1), kBackground);
+  reconciler.Reconcile();
+
+  reconciler.SetAcceptListPriority(kRandom, MakeAddress(1), kDirect);
+  reconciler.SetAcceptListPriority(kRandom, MakeAddress(2), kDirect);
+  EXPECT_FALSE(reconciler.HasChanges());
+}
+
+TEST(LeFilterListReconcilerTest, resolving_list_prefers_devices_in_accept_list) {
+  LeFilterListReconciler reconciler(8, 1);
+  reconciler.AddToResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, MakeAddress(1),
+                                MakeIrk(1), kLocalIrk, kBackground);
+  reconciler.AddToResolvingList(PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS, MakeAddress(2),
+                                MakeIrk(2), kLocalIrk, kBackground);
+  reconciler.AddToAcceptList(kPublic, MakeAddress(2), kBackground);
+
+  auto changes = reconciler.Reconcile();
+  EXPECT_EQ(Addresses(changes.resolving_list_additions), std::vector<Address>({MakeAddress(2)}));
+  EXPECT_EQ(reconciler.GetNumberOfHostResolvedDevices(), 1ul);
+}
+
+TEST(LeFilterListReconcilerTest, new_irk_rewrites_entry) {
+  LeFilterListReconciler reconciler(8, 8);
+  reconciler.AddToResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, MakeAddress(1),
+                                MakeIrk(1), kLocalIrk, kBackground);
+  reconciler.Reconcile();
+
+  reconciler.AddToResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, MakeAddress(1),
+                                MakeIrk(1), kLocalIrk, kBackground);
+  EXPECT_FALSE(reconciler.HasChanges());
+
+  reconciler.AddToResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, MakeAddress(1),
+                                MakeIrk(2), kLocalIrk, kBackground);
+  auto changes = reconciler.Reconcile();
+  EXPECT_FALSE(changes.clear_resolving_list);
+  EXPECT_EQ(Addresses(changes.resolving_list_removals), std::vector<Address>({MakeAddress(1)}));
+  ASSERT_EQ(changes.resolving_list_additions.size(), 1ul);
+  EXPECT_EQ(changes.resolving_list_additions[0].peer_irk, MakeIrk(2));
+}
+
+TEST(LeFilterListReconcilerTest, overflow_devices_are_resolved_on_host) {
+  LeFilterListReconciler reconciler(8, 1);
+  reconciler.AddToResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, MakeAddress(1),
+                                MakeIrk(1), kLocalIrk, kBackground);
+  reconciler.AddToResolvingList(PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS, MakeAddress(2),
+                                MakeIrk(2), kLocalIrk, kBackground);
+  reconciler.Reconcile();
+
+  // The controller resolves the addresses of the first device.
+  EXPECT_FALSE(reconciler.ResolveOnHost(MakeRpa(MakeIrk(1))).has_value());
+  auto identity_address = reconciler.ResolveOnHost(MakeRpa(MakeIrk(2)));
+  ASSERT_TRUE(identity_address.has_value());
+  EXPECT_EQ(*identity_address,
+            AddressWithType(MakeAddress(2), AddressType::PUBLIC_IDENTITY_ADDRESS));
+  EXPECT_EQ(reconciler.ResolveOnHost(MakeRpa(MakeIrk(2))), identity_address);
+  EXPECT_FALSE(reconciler.ResolveOnHost(MakeRpa(MakeIrk(3))).has_value());
+  // Not a resolvable private address.
+  EXPECT_FALSE(reconciler.ResolveOnHost(MakeAddress(2)).has_value());
+
+  reconciler.RemoveFromResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS,
+                                     MakeAddress(1));
+  reconciler.Reconcile();
+  EXPECT_EQ(reconciler.GetNumberOfHostResolvedDevices(), 0ul);
+  EXPECT_FALSE(reconciler.ResolveOnHost(MakeRpa(MakeIrk(2))).has_value());
+}
+
+TEST(LeFilterListReconcilerTest, full_controller_lowers_list_size) {
+  LeFilterListReconciler reconciler(3, 8);
+  for (uint8_t id = 1; id <= 3; id++) {
+    reconciler.AddToAcceptList(kRandom, MakeAddress(id), kBackground);
+  }
+  reconciler.Reconcile();
+  reconciler.OnAcceptListAdditionFailed({kRandom, MakeAddress(3)},
+                                        ErrorCode::MEMORY_CAPACITY_EXCEEDED);
+  EXPECT_EQ(reconciler.GetAcceptListSize(), 2ul);
+  EXPECT_EQ(reconciler.GetNumberOfAcceptListOverflows(), 1ul);
+  EXPECT_TRUE(reconciler.HasChanges());
+  EXPECT_TRUE(reconciler.Reconcile().IsEmpty());
+
+  reconciler.AddToAcceptList(kRandom, MakeAddress(4), kDirect);
+  auto changes = reconciler.Reconcile();
+  EXPECT_EQ(Addresses(changes.accept_list_removals), std::vector<Address>({MakeAddress(2)}));
+  EXPECT_EQ(Addresses(changes.accept_list_additions), std::vector<Address>({MakeAddress(4)}));
+}
+
+TEST(LeFilterListReconcilerTest, failed_resolving_list_addition_is_resolved_on_host) {
+  LeFilterListReconciler reconciler(8, 8);
+  reconciler.AddToResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, MakeAddress(1),
+                                MakeIrk(1), kLocalIrk, kBackground);
+  auto changes = reconciler.Reconcile();
+  ASSERT_EQ(changes.resolving_list_additions.size(), 1ul);
+  reconciler.OnResolvingListAdditionFailed(changes.resolving_list_additions[0],
+                                           ErrorCode::UNSPECIFIED_ERROR);
+  EXPECT_EQ(reconciler.GetResolvingListSize(), 8ul);
+  EXPECT_FALSE(reconciler.HasChanges());
+  EXPECT_EQ(reconciler.ResolveOnHost(MakeRpa(MakeIrk(1))),
+            std::optional<AddressWithType>(
+                    AddressWithType(MakeAddress(1), AddressType::RANDOM_IDENTITY_ADDRESS)));
+}
+
+}  // namespace
+}  // namespace bluetooth::hci
@@ -0,0 +1,484 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_host_scan_filter.h"
+
+#include <bluetooth/log.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "hci/uuid.h"
+
+namespace bluetooth::hci {
+
+namespace {
+
+constexpr size_t kMaxPatternLength = 0xff;
+
+constexpr uint8_t AdType(GapDataType type) { return static_cast<uint8_t>(type); }
+
+// The filter types are the bit positions of the features in the feature
+// selection and list logic.
+constexpr uint16_t Bit(ApcfFilterType type) {
+  return static_cast<uint16_t>(1 << static_cast<uint8_t>(type));
+}
+
+constexpr uint16_t kAllFeatures = (1 << 9) - 1;
+
+// Features combined with AND whatever the filter logic
+constexpr uint16_t kAlwaysRequiredFeatures = Bit(ApcfFilterType::BROADCASTER_ADDRESS) |
+                                             Bit(ApcfFilterType::SERVICE_DATA_CHANGE) |
+                                             Bit(ApcfFilterType::SERVICE_UUID);
+
+// The address type of a broadcaster address entry is the type of the
+// identity address: it matches the resolved addresses of that type too.
+bool MatchesAddressType(ApcfApplicationAddressType entry_type, uint8_t address_type) {
+  switch (entry_type) {
+    case ApcfApplicationAddressType::PUBLIC:
+      return address_type == static_cast<uint8_t>(AddressType::PUBLIC_DEVICE_ADDRESS) ||
+             address_type == static_cast<uint8_t>(AddressType::PUBLIC_IDENTITY_ADDRESS);
+    case ApcfApplicationAddressType::RANDOM:
+      return address_type == static_cast<uint8_t>(AddressType::RANDOM_DEVICE_ADDRESS) ||
+             address_type == static_cast<uint8_t>(AddressType::RANDOM_IDENTITY_ADDRESS);
+    default:
+      return true;
+  }
+}
+
+// Returns true if |data| masked with |mask| equals |pattern|, which is
+// masked already.
+bool MaskedEqual(const uint8_t* data, const uint8_t* pattern, const uint8_t* mask,
+                 size_t length) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= length; i += 16) {
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + i));
+    __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(d, m), p)) != 0xffff) {
+      return false;
+    }
+  }
+#elif defined(__aarch64__)
+  for (; i + 16 <= length; i += 16) {
+    uint8x16_t diff = veorq_u8(vandq_u8(vld1q_u8(data + i), vld1q_u8(mask + i)),
+                               vld1q_u8(pattern + i));
+    if (vmaxvq_u8(diff) != 0) {
+      return false;
+    }
+  }
+#endif
+  for (; i + 8 <= length; i += 8) {
+    uint64_t d, p, m;
+    memcpy(&d, data + i, sizeof(d));
+    memcpy(&p, pattern + i, sizeof(p));
+    memcpy(&m, mask + i, sizeof(m));
+    if ((d & m) != p) {
+      return false;
+    }
+  }
+  uint8_t diff = 0;
+  for (; i < length; i++) {
+    diff |= (data[i] & mask[i]) ^ pattern[i];
+  }
+  return diff == 0;
+}
+
+// Appends the UUIDs of |data| in their 128 bit little endian form: the 16 and
+// 32 bit UUIDs replace the value of the base UUID.
+void AppendUuids(const uint8_t* data, size_t length, size_t uuid_length,
+                 std::vector<std::array<uint8_t, Uuid::kNumBytes128>>& uuids) {
+  static const Uuid::UUID128Bit kBaseLe = Uuid::From16Bit(0).To128BitLE();
+  constexpr size_t kValueOffset = Uuid::kNumBytes128 - Uuid::kNumBytes32;
+  for (size_t offset = 0; offset + uuid_length <= length; offset += uuid_length) {
+    Uuid::UUID128Bit uuid = kBaseLe;
+    if (uuid_length == Uuid::kNumBytes128) {
+      memcpy(uuid.data(), data + offset, Uuid::kNumBytes128);
+    } else {
+      memcpy(uuid.data() + kValueOffset, data + offset, uuid_length);
+    }
+    uuids.push_back(uuid);
+  }
+}
+
+}  // namespace
+
+LeHostScanFilter::LeHostScanFilter() { last_field_.fill(kNoField); }
+
+uint8_t LeHostScanFilter::SetParameters(ApcfAction action, uint8_t filter_index,
+                                        const AdvertisingFilterParameter& parameter) {
+  switch (action) {
+    case ApcfAction::ADD: {
+      FilterSpec& spec = filters_[filter_index];
+      spec.has_parameter = true;
+      spec.parameter = parameter;
+      break;
+    }
+    case ApcfAction::DELETE:
+      filters_.erase(filter_index);
+      break;
+    case ApcfAction::CLEAR:
+      filters_.clear();
+      break;
+    default:
+      log::error("Unknown action type: {}", static_cast<uint16_t>(action));
+      break;
+  }
+  Compile();
+  return AvailableSpaces();
+}
+
+bool LeHostScanFilter::Add(uint8_t filter_index,
+                           const AdvertisingPacketContentFilterCommand& command) {
+  if (!IsValid(command)) {
+    log::warn("Invalid filter of type {} for index {}", static_cast<uint16_t>(command.filter_type),
+              filter_index);
+    return false;
+  }
+  filters_[filter_index].contents.push_back(command);
+  Compile();
+  return true;
+}
+
+uint8_t LeHostScanFilter::AvailableSpaces() const {
+  size_t in_use = std::count_if(filters_.begin(), filters_.end(),
+                                [](const auto& filter) { return filter.second.has_parameter; });
+  return in_use < kMaxFilters ? kMaxFilters - in_use : 0;
+}
+
+bool LeHostScanFilter::IsValid(const AdvertisingPacketContentFilterCommand& command) {
+  if (!command.data_mask.empty() && command.data_mask.size() != command.data.size()) {
+    return false;
+  }
+  switch (command.filter_type) {
+    case ApcfFilterType::BROADCASTER_ADDRESS:
+    case ApcfFilterType::SERVICE_UUID:
+    case ApcfFilterType::SERVICE_SOLICITATION_UUID:
+      return true;
+    case ApcfFilterType::LOCAL_NAME:
+      return !command.name.empty() && command.name.size() <= kMaxPatternLength;
+    case ApcfFilterType::MANUFACTURER_DATA:
+      return command.data.size() + 2 <= kMaxPatternLength;
+    case ApcfFilterType::SERVICE_DATA:
+    case ApcfFilterType::AD_TYPE:
+      return command.data.size() <= kMaxPatternLength;
+    case ApcfFilterType::TRANSPORT_DISCOVERY_DATA:
+      return command.data.size() + 2 <= kMaxPatternLength;
+    default:
+      return false;
+  }
+}
+
+uint32_t LeHostScanFilter::AddPattern(const std::vector<uint8_t>& pattern,
+                                      const std::vector<uint8_t>& mask) {
+  uint32_t offset = static_cast<uint32_t>(patterns_.size());
+  for (size_t i = 0; i < pattern.size(); i++) {
+    patterns_.push_back(pattern[i] & mask[i]);
+  }
+  patterns_.insert(patterns_.end(), mask.begin(), mask.end());
+  return offset;
+}
+
+LeHostScanFilter::Clause LeHostScanFilter::CompileEntry(
+        const AdvertisingPacketContentFilterCommand& command) {
+  Clause clause{.type = command.filter_type,
+                .ad_type = command.ad_type,
+                .address_type = command.application_address_type,
+                .length = 0,
+                .pattern = 0};
+  std::vector<uint8_t> pattern;
+  std::vector<uint8_t> mask;
+
+  switch (command.filter_type) {
+    case ApcfFilterType::BROADCASTER_ADDRESS:
+      pattern.assign(command.address.address.begin(), command.address.address.end());
+      mask.assign(pattern.size(), 0xff);
+      break;
+    case ApcfFilterType::SERVICE_UUID:
+    case ApcfFilterType::SERVICE_SOLICITATION_UUID: {
+      // The UUIDs are compared in their 128 bit form, the mask only covering
+      // the value of the 16 and 32 bit UUIDs.
+      auto uuid = command.uuid.To128BitLE();
+      pattern.assign(uuid.begin(), uuid.end());
+      mask.assign(pattern.size(), 0xff);
+      if (!command.uuid_mask.IsEmpty()) {
+        size_t uuid_length = command.uuid.GetShortestRepresentationSize();
+        auto uuid_mask = command.uuid_mask.To128BitLE();
+        size_t offset = uuid_length == Uuid::kNumBytes128 ? 0
+                                                          : Uuid::kNumBytes128 - Uuid::kNumBytes32;
+        std::copy_n(uuid_mask.begin() + offset, uuid_length, mask.begin() + offset);
+      }
+      break;
+    }
+    case ApcfFilterType::LOCAL_NAME:
+      pattern = command.name;
+      mask.assign(pattern.size(), 0xff);
+      break;
+    case ApcfFilterType::MANUFACTURER_DATA: {
+      uint16_t company_mask = command.company_mask != 0 ? command.company_mask : 0xffff;
+      pattern = {static_cast<uint8_t>(command.company), static_cast<uint8_t>(command.company >> 8)};
+      mask = {static_cast<uint8_t>(company_mask), static_cast<uint8_t>(company_mask >> 8)};
+      pattern.insert(pattern.end(), command.data.begin(), command.data.end());
+      break;
+    }
+    case ApcfFilterType::TRANSPORT_DISCOVERY_DATA:
+      pattern = {command.org_id, command.tds_flags};
+      mask = {0xff, command.tds_flags_mask};
+      pattern.insert(pattern.end(), command.data.begin(), command.data.end());
+      break;
+    default:
+      pattern = command.data;
+      break;
+  }
+
+  // The data masks default to comparing all the bytes of the data
+  if (mask.size() < pattern.size()) {
+    if (command.data_mask.empty()) {
+      mask.resize(pattern.size(), 0xff);
+    } else {
+      mask.insert(mask.end(), command.data_mask.begin(), command.data_mask.end());
+    }
+  }
+
+  clause.length = static_cast<uint8_t>(pattern.size());
+  clause.pattern = AddPattern(pattern, mask);
+  return clause;
+}
+
+void LeHostScanFilter::Compile() {
+  programs_.clear();
+  clauses_.clear();
+  patterns_.clear();
+  needs_uuids_ = false;
+
+  for (const auto& [filter_index, spec] : filters_) {
+    if (!spec.has_parameter) {
+      continue;
+    }
+
+    Program program{
+            .rssi_threshold = static_cast<int8_t>(spec.parameter.rssi_high_thresh),
+            .features = static_cast<uint16_t>(spec.parameter.feature_selection & kAllFeatures),
+            .and_lists = spec.parameter.list_logic_type,
+            .and_filter_logic = spec.parameter.filter_logic_type != 0,
+            .first_clause = static_cast<uint16_t>(clauses_.size()),
+            .clause_count = 0,
+    };
+    for (const auto& command : spec.contents) {
+      // The entries of the features not selected are ignored
+      if ((program.features & Bit(command.filter_type)) != 0) {
+        clauses_.push_back(CompileEntry(command));
+      }
+    }
+    std::stable_sort(clauses_.begin() + program.first_clause, clauses_.end(),
+                     [](const Clause& a, const Clause& b) { return a.type < b.type; });
+    program.clause_count = static_cast<uint16_t>(clauses_.size() - program.first_clause);
+    programs_.push_back(program);
+
+    needs_uuids_ |= (program.features & (Bit(ApcfFilterType::SERVICE_UUID) |
+                                         Bit(ApcfFilterType::SERVICE_SOLICITATION_UUID))) != 0;
+  }
+}
+
+void LeHostScanFilter::ParseReport(std::span<const uint8_t> advertising_data) {
+  for (const Field& field : fields_) {
+    last_field_[field.type] = kNoField;
+  }
+  fields_.clear();
+  service_uuids_.clear();
+  solicitation_uuids_.clear();
+
+  size_t offset = 0;
+  while (offset < advertising_data.size()) {
+    uint8_t length = advertising_data[offset];
+    if (length == 0) {
+      offset++;
+      continue;
+    }
+    if (offset + 1 + length > advertising_data.size()) {
+      break;
+    }
+    uint8_t type = advertising_data[offset + 1];
+    fields_.push_back(Field{.type = type,
+                            .length = static_cast<uint8_t>(length - 1),
+                            .offset = static_cast<uint16_t>(offset + 2),
+                            .previous = last_field_[type]});
+    last_field_[type] = static_cast<uint16_t>(fields_.size() - 1);
+    offset += 1 + length;
+  }
+
+  if (!needs_uuids_) {
+    return;
+  }
+  for (const Field& field : fields_) {
+    const uint8_t* data = advertising_data.data() + field.offset;
+    switch (field.type) {
+      case AdType(GapDataType::INCOMPLETE_LIST_16_BIT_UUIDS):
+      case AdType(GapDataType::COMPLETE_LIST_16_BIT_UUIDS):
+        AppendUuids(data, field.length, Uuid::kNumBytes16, service_uuids_);
+        break;
+      case AdType(GapDataType::INCOMPLETE_LIST_32_BIT_UUIDS):
+      case AdType(GapDataType::COMPLETE_LIST_32_BIT_UUIDS):
+        AppendUuids(data, field.length, Uuid::kNumBytes32, service_uuids_);
+        break;
+      case AdType(GapDataType::INCOMPLETE_LIST_128_BIT_UUIDS):
+      case AdType(GapDataType::COMPLETE_LIST_128_BIT_UUIDS):
+        AppendUuids(data, field.length, Uuid::kNumBytes128, service_uuids_);
+        break;
+      case AdType(GapDataType::LIST_16BIT_SERVICE_SOLICITATION_UUIDS):
+        AppendUuids(data, field.length, Uuid::kNumBytes16, solicitation_uuids_);
+        break;
+      case AdType(GapDataType::LIST_32BIT_SERVICE_SOLICITATION_UUIDS):
+        AppendUuids(data, field.length, Uuid::kNumBytes32, solicitation_uuids_);
+        break;
+      case AdType(GapDataType::LIST_128BIT_SERVICE_SOLICITATION_UUIDS):
+        AppendUuids(data, field.length, Uuid::kNumBytes128, solicitation_uuids_);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+bool LeHostScanFilter::MatchesClause(const Clause& clause, const Address& address,
+                                     uint8_t address_type,
+                                     std::span<const uint8_t> advertising_data) {
+  const uint8_t* pattern = patterns_.data() + clause.pattern;
+  const uint8_t* mask = pattern + clause.length;
+
+  // Compares the start of the fields of the given AD type
+  auto match_fields = [&](uint8_t ad_type) {
+    for (uint16_t i = last_field_[ad_type]; i != kNoField; i = fields_[i].previous) {
+      if (fields_[i].length >= clause.length &&
+          MaskedEqual(advertising_data.data() + fields_[i].offset, pattern, mask, clause.length)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto match_uuids = [&](const std::vector<Uuid128>& uuids) {
+    return std::any_of(uuids.begin(), uuids.end(), [&](const Uuid128& uuid) {
+      return MaskedEqual(uuid.data(), pattern, mask, uuid.size());
+    });
+  };
+
+  switch (clause.type) {
+    case ApcfFilterType::BROADCASTER_ADDRESS:
+      return MatchesAddressType(clause.address_type, address_type) &&
+             MaskedEqual(address.data(), pattern, mask, Address::kLength);
+    case ApcfFilterType::SERVICE_UUID:
+      return match_uuids(service_uuids_);
+    case ApcfFilterType::SERVICE_SOLICITATION_UUID:
+      return match_uuids(solicitation_uuids_);
+    case ApcfFilterType::LOCAL_NAME:
+      return match_fields(AdType(GapDataType::COMPLETE_LOCAL_NAME)) ||
+             match_fields(AdType(GapDataType::SHORTENED_LOCAL_NAME));
+    case ApcfFilterType::MANUFACTURER_DATA:
+      return match_fields(AdType(GapDataType::MANUFACTURER_SPECIFIC_DATA));
+    case ApcfFilterType::SERVICE_DATA:
+      return match_fields(AdType(GapDataType::SERVICE_DATA_16_BIT_UUIDS)) ||
+             match_fields(AdType(GapDataType::SERVICE_DATA_32_BIT_UUIDS)) ||
+             match_fields(AdType(GapDataType::SERVICE_DATA_128_BIT_UUIDS));
+    case ApcfFilterType::AD_TYPE:
+      return match_fields(clause.ad_type);
+    case ApcfFilterType::TRANSPORT_DISCOVERY_DATA:
+      // The field holds transport blocks made of the organization id, the
+      // flags, and the length of the transport data that follows.
+      for (uint16_t i = last_field_[AdType(GapDataType::TRANSPORT_DISCOVERY_DATA)]; i != kNoField;
+           i = fields_[i].previous) {
+        const Field& field = fields_[i];
+        const uint8_t* block = advertising_data.data() + field.offset;
+        const uint8_t* end = block + field.length;
+        while (end - block >= 3 && end - block >= 3 + block[2]) {
+          if (block[2] + 2 >= clause.length && MaskedEqual(block, pattern, mask, 2) &&
+              MaskedEqual(block + 3, pattern + 2, mask + 2, clause.length - 2)) {
+            return true;
+          }
+          block += 3 + block[2];
+        }
+      }
+      return false;
+    default:
+      return false;
+  }
+}
+
+bool LeHostScanFilter::MatchesProgram(const Program& program, const Address& address,
+                                      uint8_t address_type,
+                                      std::span<const uint8_t> advertising_data) {
+  // Features with entries, with an entry that matches, and with an entry that
+  // does not match. The outcome of a feature is known as soon as one of its
+  // entries matches (OR list) or does not (AND list).
+  uint16_t present = 0;
+  uint16_t matched = 0;
+  uint16_t failed = 0;
+  for (size_t i = program.first_clause; i < program.first_clause + program.clause_count; i++) {
+    const Clause& clause = clauses_[i];
+    uint16_t bit = Bit(clause.type);
+    present |= bit;
+    if (((program.and_lists & bit) ? failed : matched) & bit) {
+      continue;
+    }
+    if (MatchesClause(clause, address, address_type, advertising_data)) {
+      matched |= bit;
+    } else {
+      failed |= bit;
+    }
+  }
+
+  uint16_t passed = present & ((matched & ~program.and_lists) | (~failed & program.and_lists));
+  passed |= Bit(ApcfFilterType::SERVICE_DATA_CHANGE);
+
+  uint16_t required = program.features & kAlwaysRequiredFeatures;
+  uint16_t others = program.features & ~kAlwaysRequiredFeatures;
+  if ((passed & required) != required) {
+    return false;
+  }
+  if (others == 0) {
+    return true;
+  }
+  return program.and_filter_logic ? (passed & others) == others : (passed & others) != 0;
+}
+
+bool LeHostScanFilter::Matches(const Address& address, uint8_t address_type, int8_t rssi,
+                               std::span<const uint8_t> advertising_data) {
+  if (!enabled_) {
+    return true;
+  }
+
+  bool parsed = false;
+  for (const Program& program : programs_) {
+    if (rssi < program.rssi_threshold) {
+      continue;
+    }
+    if (!parsed) {
+      ParseReport(advertising_data);
+      parsed = true;
+    }
+    if (MatchesProgram(program, address, address_type, advertising_data)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bluetooth::hci
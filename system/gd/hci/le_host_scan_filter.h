@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <vector>
+
+#include "hci/address.h"
+#include "hci/hci_packets.h"
+#include "hci/le_scanning_callback.h"
+
+namespace bluetooth::hci {
+
+/// Host side implementation of the advertising packet content filter
+/// (APCF), used in place of the controller filter when the controller does
+/// not support it or runs out of filter slots.
+///
+/// The filters take the same parameters and contents as the LE_ADV_FILTER
+/// vendor command, and follow its matching rules:
+/// - the entries of a feature are combined according to the list logic of
+///   the feature (bit set: all entries, bit cleared: any entry);
+/// - the address, service data change and service UUID features are always
+///   required, the other features are combined according to the filter
+///   logic;
+/// - a report matches if it matches any filter and its RSSI is not below the
+///   RSSI threshold of the filter.
+/// Service data change cannot be detected on the host and always matches.
+/// On found / on lost tracking is not emulated: the reports matching a
+/// filter are delivered whatever its delivery mode.
+///
+/// The filters are compiled into a table of clauses whenever they change, so
+/// that matching a report only parses its advertising data once and compares
+/// the bytes of the clauses against it.
+class LeHostScanFilter {
+public:
+  /// Number of filter indexes reported as available when none is in use.
+  static constexpr uint8_t kMaxFilters = 128;
+
+  LeHostScanFilter();
+  LeHostScanFilter(const LeHostScanFilter&) = delete;
+  LeHostScanFilter& operator=(const LeHostScanFilter&) = delete;
+
+  /// Enables or disables filtering. When disabled, all reports match.
+  void Enable(bool enable) { enabled_ = enable; }
+  bool IsEnabled() const { return enabled_; }
+
+  /// Adds or replaces the parameters of a filter, deletes a filter with its
+  /// contents, or clears all the filters.
+  /// Returns the number of filter indexes still available.
+  uint8_t SetParameters(ApcfAction action, uint8_t filter_index,
+                        const AdvertisingFilterParameter& parameter);
+
+  /// Adds an entry to the contents of a filter. Returns false if the entry
+  /// is invalid.
+  bool Add(uint8_t filter_index, const AdvertisingPacketContentFilterCommand& command);
+
+  uint8_t AvailableSpaces() const;
+
+  /// Returns true if the report passes the filters. |address_type| is the
+  /// AddressType of the report.
+  bool Matches(const Address& address, uint8_t address_type, int8_t rssi,
+               std::span<const uint8_t> advertising_data);
+
+private:
+  struct FilterSpec {
+    bool has_parameter{false};
+    AdvertisingFilterParameter parameter{};
+    std::vector<AdvertisingPacketContentFilterCommand> contents;
+  };
+
+  /// Compiled entry of a filter: compares |length| bytes of a field with the
+  /// masked pattern stored at |pattern| in patterns_, followed by its mask.
+  /// The broadcaster address entries also compare the address type.
+  struct Clause {
+    ApcfFilterType type;
+    uint8_t ad_type;
+    ApcfApplicationAddressType address_type;
+    uint8_t length;
+    uint32_t pattern;
+  };
+
+  /// Compiled filter. Its clauses are ordered by feature.
+  struct Program {
+    int8_t rssi_threshold;
+    uint16_t features;
+    uint16_t and_lists;
+    bool and_filter_logic;
+    uint16_t first_clause;
+    uint16_t clause_count;
+  };
+
+  /// AD structure of the report being matched, chained to the previous
+  /// structure of the same type.
+  struct Field {
+    uint8_t type;
+    uint8_t length;
+    uint16_t offset;
+    uint16_t previous;
+  };
+  static constexpr uint16_t kNoField = 0xffff;
+
+  using Uuid128 = std::array<uint8_t, 16>;
+
+  static bool IsValid(const AdvertisingPacketContentFilterCommand& command);
+
+  void Compile();
+  Clause CompileEntry(const AdvertisingPacketContentFilterCommand& command);
+  uint32_t AddPattern(const std::vector<uint8_t>& pattern, const std::vector<uint8_t>& mask);
+
+  void ParseReport(std::span<const uint8_t> advertising_data);
+  bool MatchesProgram(const Program& program, const Address& address, uint8_t address_type,
+                      std::span<const uint8_t> advertising_data);
+  bool MatchesClause(const Clause& clause, const Address& address, uint8_t address_type,
+                     std::span<const uint8_t> advertising_data);
+
+  bool enabled_{false};
+  std::map<uint8_t, FilterSpec> filters_;
+
+  std::vector<Program> programs_;
+  std::vector<Clause> clauses_;
+  std::vector<uint8_t> patterns_;
+  bool needs_uuids_{false};
+
+  // Scratch space of Matches, reused between reports
+  std::vector<Field> fields_;
+  std::array<uint16_t, 256> last_field_;
+  std::vector<Uuid128> service_uuids_;
+  std::vector<Uuid128> solicitation_uuids_;
+};
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/le_host_scan_filter.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+constexpr uint16_t kServiceUuidFeature = 1 << 2;
+constexpr uint16_t kLocalNameFeature = 1 << 4;
+constexpr uint16_t kManufacturerDataFeature = 1 << 5;
+constexpr uint16_t kServiceDataFeature = 1 << 6;
+constexpr size_t kReports = 1024;
+constexpr uint8_t kAddressType = static_cast<uint8_t>(AddressType::PUBLIC_DEVICE_ADDRESS);
+
+struct Report {
+  Address address;
+  std::vector<uint8_t> data;
+};
+
+// Filters of the kinds set by the applications: one entry per filter, on
+// manufacturer data, service UUID, service data or local name.
+void AddFilters(LeHostScanFilter& filter, size_t count) {
+  for (uint8_t index = 0; index < count; index++) {
+    AdvertisingPacketContentFilterCommand command{};
+    AdvertisingFilterParameter parameter{};
+    parameter.list_logic_type = 0;
+    parameter.filter_logic_type = 0x01;
+    parameter.rssi_high_thresh = 0x80;
+    parameter.delivery_mode = DeliveryMode::IMMEDIATE;
+    switch (index % 4) {
+      case 0:
+        command.filter_type = ApcfFilterType::MANUFACTURER_DATA;
+        command.company = 0x1000 + index;
+        command.data = {0x02, 0x15, index};
+        command.data_mask = {0xff, 0xff, 0xf0};
+        parameter.feature_selection = kManufacturerDataFeature;
+        break;
+      case 1:
+        command.filter_type = ApcfFilterType::SERVICE_UUID;
+        command.uuid = Uuid::From16Bit(0x2000 + index);
+        parameter.feature_selection = kServiceUuidFeature;
+        break;
+      case 2:
+        command.filter_type = ApcfFilterType::SERVICE_DATA;
+        command.data = {static_cast<uint8_t>(0x2000 + index), 0x20, 0x01};
+        parameter.feature_selection = kServiceDataFeature;
+        break;
+      default:
+        command.filter_type = ApcfFilterType::LOCAL_NAME;
+        command.name = {'d', 'e', 'v', index};
+        parameter.feature_selection = kLocalNameFeature;
+        break;
+    }
+    filter.Add(index, command);
+    filter.SetParameters(ApcfAction::ADD, index, parameter);
+  }
+  filter.Enable(true);
+}
+
+// Legacy advertising reports of devices that mostly do not match the
+// filters: flags, a service UUID, manufacturer data and a local name.
+const std::vector<Report>& Reports() {
+  static const std::vector<Report> reports = [] {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<uint16_t> id(0, 0x7ff);
+    std::vector<Report> reports;
+    for (size_t i = 0; i < kReports; i++) {
+      uint16_t device = id(generator);
+      uint8_t low = static_cast<uint8_t>(device);
+      uint8_t high = static_cast<uint8_t>(device >> 8);
+      reports.push_back(Report{
+              .address = Address({0x0a, 0x0b, 0x0c, 0x0d, high, low}),
+              .data = {0x02, 0x01, 0x06, 0x03, 0x03, low, 0x20, 0x09, 0xff, low, 0x10, 0x02,
+                       0x15, high, 0x00, 0x00, 0x05, 0x09, 'd', 'e', 'v', low},
+      });
+    }
+    return reports;
+  }();
+  return reports;
+}
+
+void BM_LeHostScanFilter(State& state) {
+  LeHostScanFilter filter;
+  AddFilters(filter, state.range(0));
+  const auto& reports = Reports();
+  size_t report = 0;
+  int64_t matches = 0;
+  for (auto _ : state) {
+    const Report& r = reports[report++ % kReports];
+    matches += filter.Matches(r.address, kAddressType, -60, r.data);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["match_ratio"] = static_cast<double>(matches) / state.iterations();
+}
+BENCHMARK(BM_LeHostScanFilter)->ArgName("filters")->Arg(1)->Arg(10)->Arg(100);
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_host_scan_filter.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth::hci {
+
+// Feature selection and list logic bits.
+static constexpr uint16_t kAddressFeature = 1 << 0;
+static constexpr uint16_t kServiceUuidFeature = 1 << 2;
+static constexpr uint16_t kLocalNameFeature = 1 << 4;
+static constexpr uint16_t kManufacturerDataFeature = 1 << 5;
+static constexpr uint16_t kServiceDataFeature = 1 << 6;
+static constexpr uint16_t kTransportDiscoveryDataFeature = 1 << 7;
+static constexpr uint16_t kAdTypeFeature = 1 << 8;
+
+static constexpr uint8_t kFilterLogicOr = 0x00;
+static constexpr uint8_t kFilterLogicAnd = 0x01;
+static constexpr uint8_t kLowestRssi = 0x80;
+
+static const Address kAddress = Address({0, 1, 2, 3, 4, 5});
+static const Address kOtherAddress = Address({6, 7, 8, 9, 10, 11});
+
+static AdvertisingFilterParameter MakeParameter(uint16_t feature_selection,
+                                                uint16_t list_logic_type = 0,
+                                                uint8_t filter_logic_type = kFilterLogicAnd,
+                                                uint8_t rssi_high_thresh = kLowestRssi) {
+  AdvertisingFilterParameter parameter{};
+  parameter.feature_selection = feature_selection;
+  parameter.list_logic_type = list_logic_type;
+  parameter.filter_logic_type = filter_logic_type;
+  parameter.rssi_high_thresh = rssi_high_thresh;
+  parameter.delivery_mode = DeliveryMode::IMMEDIATE;
+  return parameter;
+}
+
+static AdvertisingPacketContentFilterCommand MakeCommand(ApcfFilterType filter_type) {
+  AdvertisingPacketContentFilterCommand command{};
+  command.filter_type = filter_type;
+  return command;
+}
+
+class LeHostScanFilterTest : public ::testing::Test {
+protected:
+  void SetUp() override { filter_.Enable(true); }
+
+  bool Matches(const Address& address, int8_t rssi, const std::vector<uint8_t>& advertising_data,
+               AddressType address_type = AddressType::PUBLIC_DEVICE_ADDRESS) {
+    return filter_.Matches(address, static_cast<uint8_t>(address_type), rssi, advertising_data);
+  }
+
+  LeHostScanFilter filter_;
+};
+
+TEST_F(LeHostScanFilterTest, disabled_filter_matches_all) {
+  filter_.Enable(false);
+  ASSERT_TRUE(Matches(kAddress, -60, {}));
+}
+
+TEST_F(LeHostScanFilterTest, no_filter_matches_none) {
+  ASSERT_FALSE(Matches(kAddress, -60, {}));
+}
+
+TEST_F(LeHostScanFilterTest, allow_all_filter) {
+  ASSERT_EQ(LeHostScanFilter::kMaxFilters - 1,
+            filter_.SetParameters(ApcfAction::ADD, 0, MakeParameter(0)));
+  ASSERT_TRUE(Matches(kAddress, -60, {0x02, 0x01, 0x06}));
+}
+
+TEST_F(LeHostScanFilterTest, rssi_threshold) {
+  filter_.SetParameters(ApcfAction::ADD, 0, MakeParameter(0, 0, kFilterLogicAnd, -70));
+  ASSERT_TRUE(Matches(kAddress, -70, {}));
+  ASSERT_FALSE(Matches(kAddress, -71, {}));
+}
+
+TEST_F(LeHostScanFilterTest, broadcaster_address) {
+  auto command = MakeCommand(ApcfFilterType::BROADCASTER_ADDRESS);
+  command.address = kAddress;
+  ASSERT_TRUE(filter_.Add(1, command));
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kAddressFeature));
+
+  ASSERT_TRUE(Matches(kAddress, -60, {}));
+  ASSERT_FALSE(Matches(kOtherAddress, -60, {}));
+}
+
+TEST_F(LeHostScanFilterTest, broadcaster_address_type) {
+  auto command = MakeCommand(ApcfFilterType::BROADCASTER_ADDRESS);
+  command.address = kAddress;
+  command.application_address_type = ApcfApplicationAddressType::RANDOM;
+  ASSERT_TRUE(filter_.Add(1, command));
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kAddressFeature));
+
+  ASSERT_TRUE(Matches(kAddress, -60, {}, AddressType::RANDOM_DEVICE_ADDRESS));
+  ASSERT_TRUE(Matches(kAddress, -60, {}, AddressType::RANDOM_IDENTITY_ADDRESS));
+  ASSERT_FALSE(Matches(kAddress, -60, {}, AddressType::PUBLIC_DEVICE_ADDRESS));
+  ASSERT_FALSE(Matches(kAddress, -60, {}, AddressType::PUBLIC_IDENTITY_ADDRESS));
+
+  command.application_address_type = ApcfApplicationAddressType::NOT_APPLICABLE;
+  filter_.SetParameters(ApcfAction::CLEAR, 0, MakeParameter(0));
+  ASSERT_TRUE(filter_.Add(1, command));
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kAddressFeature));
+  ASSERT_TRUE(Matches(kAddress, -60, {}, AddressType::PUBLIC_DEVICE_ADDRESS));
+  ASSERT_TRUE(Matches(kAddress, -60, {}, AddressType::RANDOM_DEVICE_ADDRESS));
+}
+
+TEST_F(LeHostScanFilterTest, service_uuid) {
+  auto command = MakeCommand(ApcfFilterType::SERVICE_UUID);
+  command.uuid = Uuid::From16Bit(0x180d);
+  filter_.Add(1, command);
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kServiceUuidFeature));
+
+  ASSERT_TRUE(Matches(kAddress, -60, {0x05, 0x03, 0x0f, 0x18, 0x0d, 0x18}));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x03, 0x03, 0x0f, 0x18}));
+
+  // 128 bit form of the same UUID
+  auto uuid = Uuid::From16Bit(0x180d).To128BitLE();
+  std::vector<uint8_t> data = {0x11, 0x07};
+  data.insert(data.end(), uuid.begin(), uuid.end());
+  ASSERT_TRUE(Matches(kAddress, -60, data));
+
+  // Solicitation UUIDs do not match service UUID filters
+  ASSERT_FALSE(Matches(kAddress, -60, {0x03, 0x14, 0x0d, 0x18}));
+}
+
+TEST_F(LeHostScanFilterTest, service_uuid_with_mask) {
+  auto command = MakeCommand(ApcfFilterType::SERVICE_UUID);
+  command.uuid = Uuid::From16Bit(0x1800);
+  command.uuid_mask = Uuid::From16Bit(0xff00);
+  filter_.Add(1, command);
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kServiceUuidFeature));
+
+  ASSERT_TRUE(Matches(kAddress, -60, {0x03, 0x03, 0x42, 0x18}));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x03, 0x03, 0x42, 0x19}));
+}
+
+TEST_F(LeHostScanFilterTest, local_name) {
+  auto command = MakeCommand(ApcfFilterType::LOCAL_NAME);
+  command.name = {'a', 'b', 'c'};
+  filter_.Add(1, command);
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kLocalNameFeature));
+
+  ASSERT_TRUE(Matches(kAddress, -60, {0x05, 0x09, 'a', 'b', 'c', 'd'}));
+  ASSERT_TRUE(Matches(kAddress, -60, {0x04, 0x08, 'a', 'b', 'c'}));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x03, 0x09, 'a', 'b'}));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x04, 0x09, 'a', 'b', 'd'}));
+}
+
+TEST_F(LeHostScanFilterTest, manufacturer_data_with_mask) {
+  auto command = MakeCommand(ApcfFilterType::MANUFACTURER_DATA);
+  command.company = 0x00e0;
+  command.data = {0x01, 0x20};
+  command.data_mask = {0xff, 0xf0};
+  filter_.Add(1, command);
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kManufacturerDataFeature));
+
+  ASSERT_TRUE(Matches(kAddress, -60, {0x06, 0xff, 0xe0, 0x00, 0x01, 0x2a, 0x55}));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x05, 0xff, 0xe0, 0x00, 0x01, 0x3a}));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x05, 0xff, 0x4c, 0x00, 0x01, 0x2a}));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x04, 0xff, 0xe0, 0x00, 0x01}));
+}
+
+TEST_F(LeHostScanFilterTest, long_masked_data) {
+  auto command = MakeCommand(ApcfFilterType::SERVICE_DATA);
+  for (uint8_t i = 0; i < 40; i++) {
+    command.data.push_back(i);
+    command.data_mask.push_back(i == 37 ? 0x00 : 0xff);
+  }
+  filter_.Add(1, command);
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kServiceDataFeature));
+
+  std::vector<uint8_t> data = {41, 0x21};
+  data.insert(data.end(), command.data.begin(), command.data.end());
+  data[2 + 37] = 0x42;
+  ASSERT_TRUE(Matches(kAddress, -60, data));
+  data[2 + 20] = 0x42;
+  ASSERT_FALSE(Matches(kAddress, -60, data));
+}
+
+TEST_F(LeHostScanFilterTest, transport_discovery_data) {
+  auto command = MakeCommand(ApcfFilterType::TRANSPORT_DISCOVERY_DATA);
+  command.org_id = 0x02;
+  command.tds_flags = 0x01;
+  command.tds_flags_mask = 0x03;
+  command.data = {0xaa};
+  filter_.Add(1, command);
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kTransportDiscoveryDataFeature));
+
+  // Second transport block
+  ASSERT_TRUE(Matches(kAddress, -60,
+                      {0x0a, 0x26, 0x01, 0x00, 0x00, 0x02, 0x05, 0x02, 0xaa, 0xbb, 0x00}));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x05, 0x26, 0x02, 0x02, 0x01, 0xaa}));
+}
+
+TEST_F(LeHostScanFilterTest, ad_type) {
+  auto command = MakeCommand(ApcfFilterType::AD_TYPE);
+  command.ad_type = 0x2e;
+  filter_.Add(1, command);
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kAdTypeFeature));
+
+  ASSERT_TRUE(Matches(kAddress, -60, {0x02, 0x01, 0x06, 0x03, 0x2e, 0x01, 0x02}));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x02, 0x01, 0x06}));
+}
+
+TEST_F(LeHostScanFilterTest, list_logic) {
+  auto cap = MakeCommand(ApcfFilterType::SERVICE_DATA);
+  cap.data = {0x53, 0x18};
+  auto bap = MakeCommand(ApcfFilterType::SERVICE_DATA);
+  bap.data = {0x4e, 0x18};
+  const std::vector<uint8_t> cap_data = {0x03, 0x16, 0x53, 0x18};
+  const std::vector<uint8_t> both_data = {0x03, 0x16, 0x53, 0x18, 0x03, 0x16, 0x4e, 0x18};
+
+  filter_.Add(1, cap);
+  filter_.Add(1, bap);
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kServiceDataFeature, 0));
+  ASSERT_TRUE(Matches(kAddress, -60, cap_data));
+  ASSERT_TRUE(Matches(kAddress, -60, both_data));
+
+  filter_.SetParameters(ApcfAction::ADD, 1,
+                        MakeParameter(kServiceDataFeature, kServiceDataFeature));
+  ASSERT_FALSE(Matches(kAddress, -60, cap_data));
+  ASSERT_TRUE(Matches(kAddress, -60, both_data));
+}
+
+TEST_F(LeHostScanFilterTest, filter_logic) {
+  auto name = MakeCommand(ApcfFilterType::LOCAL_NAME);
+  name.name = {'a'};
+  auto manufacturer_data = MakeCommand(ApcfFilterType::MANUFACTURER_DATA);
+  manufacturer_data.company = 0x00e0;
+  filter_.Add(1, name);
+  filter_.Add(1, manufacturer_data);
+  const std::vector<uint8_t> name_data = {0x02, 0x09, 'a'};
+
+  filter_.SetParameters(ApcfAction::ADD, 1,
+                        MakeParameter(kLocalNameFeature | kManufacturerDataFeature, 0,
+                                      kFilterLogicOr));
+  ASSERT_TRUE(Matches(kAddress, -60, name_data));
+
+  filter_.SetParameters(ApcfAction::ADD, 1,
+                        MakeParameter(kLocalNameFeature | kManufacturerDataFeature, 0,
+                                      kFilterLogicAnd));
+  ASSERT_FALSE(Matches(kAddress, -60, name_data));
+  ASSERT_TRUE(Matches(kAddress, -60, {0x02, 0x09, 'a', 0x03, 0xff, 0xe0, 0x00}));
+}
+
+TEST_F(LeHostScanFilterTest, address_is_always_required) {
+  auto address = MakeCommand(ApcfFilterType::BROADCASTER_ADDRESS);
+  address.address = kAddress;
+  auto name = MakeCommand(ApcfFilterType::LOCAL_NAME);
+  name.name = {'a'};
+  filter_.Add(1, address);
+  filter_.Add(1, name);
+  filter_.SetParameters(ApcfAction::ADD, 1,
+                        MakeParameter(kAddressFeature | kLocalNameFeature, 0, kFilterLogicOr));
+
+  ASSERT_TRUE(Matches(kAddress, -60, {0x02, 0x09, 'a'}));
+  ASSERT_FALSE(Matches(kOtherAddress, -60, {0x02, 0x09, 'a'}));
+}
+
+TEST_F(LeHostScanFilterTest, delete_and_clear) {
+  auto command = MakeCommand(ApcfFilterType::LOCAL_NAME);
+  command.name = {'a'};
+  filter_.Add(1, command);
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kLocalNameFeature));
+  command.name = {'b'};
+  filter_.Add(2, command);
+  filter_.SetParameters(ApcfAction::ADD, 2, MakeParameter(kLocalNameFeature));
+  ASSERT_EQ(LeHostScanFilter::kMaxFilters - 2, filter_.AvailableSpaces());
+
+  // Deleting a filter deletes its contents
+  filter_.SetParameters(ApcfAction::DELETE, 1, {});
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kLocalNameFeature));
+  ASSERT_FALSE(Matches(kAddress, -60, {0x02, 0x09, 'a'}));
+  ASSERT_TRUE(Matches(kAddress, -60, {0x02, 0x09, 'b'}));
+
+  filter_.SetParameters(ApcfAction::CLEAR, 0, {});
+  ASSERT_EQ(LeHostScanFilter::kMaxFilters, filter_.AvailableSpaces());
+  ASSERT_FALSE(Matches(kAddress, -60, {0x02, 0x09, 'b'}));
+}
+
+TEST_F(LeHostScanFilterTest, invalid_entries) {
+  auto command = MakeCommand(ApcfFilterType::MANUFACTURER_DATA);
+  command.data = {0x01, 0x02};
+  command.data_mask = {0xff};
+  ASSERT_FALSE(filter_.Add(1, command));
+  ASSERT_FALSE(filter_.Add(1, MakeCommand(ApcfFilterType::LOCAL_NAME)));
+}
+
+TEST_F(LeHostScanFilterTest, malformed_advertising_data) {
+  filter_.SetParameters(ApcfAction::ADD, 1, MakeParameter(kLocalNameFeature));
+  auto command = MakeCommand(ApcfFilterType::LOCAL_NAME);
+  command.name = {'a'};
+  filter_.Add(1, command);
+
+  ASSERT_FALSE(Matches(kAddress, -60, {0x05, 0x09, 'a'}));
+  ASSERT_TRUE(Matches(kAddress, -60, {0x00, 0x02, 0x09, 'a', 0x00}));
+}
+
+}  // namespace bluetooth::hci
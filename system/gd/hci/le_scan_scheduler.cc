@@ -0,0 +1,181 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_scan_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bluetooth::hci {
+
+namespace {
+
+constexpr uint16_t kMinScanWindow = 0x0004;
+
+// The population changed when more than one advertiser in
+// kTurnoverDivisor was not in range during the previous epoch.
+constexpr size_t kTurnoverDivisor = 8;
+
+}  // namespace
+
+void LeScanScheduler::SetScannerParameters(ScannerId scanner_id, LeScanConfiguration parameters) {
+  scanners_[scanner_id] = parameters;
+}
+
+void LeScanScheduler::RemoveScanner(ScannerId scanner_id) { scanners_.erase(scanner_id); }
+
+std::optional<LeScanConfiguration> LeScanScheduler::GetConfiguration() const {
+  if (scanners_.empty()) {
+    return std::nullopt;
+  }
+
+  LeScanConfiguration merged{
+          .scan_type = LeScanType::PASSIVE, .interval = UINT16_MAX, .window = 0, .phys = 0};
+  double duty_cycle = 0;
+  for (const auto& [scanner_id, parameters] : scanners_) {
+    if (parameters.scan_type == LeScanType::ACTIVE) {
+      merged.scan_type = LeScanType::ACTIVE;
+    }
+    merged.phys |= parameters.phys;
+    merged.interval = std::min(merged.interval, parameters.interval);
+    duty_cycle = std::max(duty_cycle, static_cast<double>(parameters.window) / parameters.interval);
+  }
+
+  duty_cycle = std::min(duty_cycle, 1.0) / (1 << duty_cycle_shift_);
+  if (iso_traffic_active_) {
+    duty_cycle = std::min(duty_cycle, kIsoDutyCycleCap);
+  } else if (acl_connections_ > 0) {
+    duty_cycle = std::min(duty_cycle, kAclDutyCycleCap);
+  }
+
+  merged.interval = std::max(merged.interval, kMinScanWindow);
+  merged.window = static_cast<uint16_t>(std::clamp<long>(std::lround(duty_cycle * merged.interval),
+                                                         kMinScanWindow, merged.interval));
+  if (iso_traffic_active_ && merged.window > kIsoMaxScanWindow) {
+    // Same duty cycle with shorter windows
+    merged.interval = static_cast<uint16_t>(
+            std::lround(static_cast<double>(merged.interval) * kIsoMaxScanWindow / merged.window));
+    merged.window = kIsoMaxScanWindow;
+  }
+  return merged;
+}
+
+void LeScanScheduler::SetAdaptive(bool adaptive) {
+  adaptive_ = adaptive;
+  duty_cycle_shift_ = 0;
+}
+
+void LeScanScheduler::StartDiscovery(std::chrono::steady_clock::time_point now) {
+  discovered_advertisers_.reset();
+  discovery_started_at_ = now;
+  discovery_latency_sum_ = {};
+  discovered_count_ = 0;
+}
+
+void LeScanScheduler::OnAdvertisingReport(uint8_t address_type, const Address& address,
+                                          std::chrono::steady_clock::time_point now) {
+  uint64_t key = static_cast<uint64_t>(address_type) << 48;
+  for (size_t i = 0; i < Address::kLength; i++) {
+    key |= static_cast<uint64_t>(address.address[i]) << (8 * i);
+  }
+  // Finalizer of MurmurHash3, so that the bits are set uniformly at random
+  // for the estimate of the number of advertisers.
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccd;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53;
+  key ^= key >> 33;
+  size_t bit = key % kAdvertiserBits;
+  advertisers_.set(bit);
+  if (!discovered_advertisers_.test(bit)) {
+    discovered_advertisers_.set(bit);
+    discovery_latency_sum_ += now - discovery_started_at_;
+    discovered_count_++;
+  }
+}
+
+bool LeScanScheduler::EndEpoch() {
+  if (adaptive_) {
+    size_t new_advertisers = (advertisers_ & ~previous_advertisers_).count();
+    if (new_advertisers > 0 && new_advertisers * kTurnoverDivisor >= advertisers_.count()) {
+      duty_cycle_shift_ = 0;
+    } else if (duty_cycle_shift_ < kMaxDutyCycleShift) {
+      duty_cycle_shift_++;
+    }
+  }
+  previous_advertisers_ = advertisers_;
+  advertisers_.reset();
+  return NeedsReconfiguration();
+}
+
+bool LeScanScheduler::NeedsReconfiguration() const {
+  if (!scan_started_at_.has_value()) {
+    return false;
+  }
+  std::optional<LeScanConfiguration> configuration = GetConfiguration();
+  return configuration.has_value() && configuration != applied_;
+}
+
+void LeScanScheduler::OnScanStarted(LeScanConfiguration applied,
+                                    std::chrono::steady_clock::time_point now) {
+  OnScanStopped(now);
+  applied_ = applied;
+  scan_started_at_ = now;
+}
+
+void LeScanScheduler::OnScanStopped(std::chrono::steady_clock::time_point now) {
+  if (!scan_started_at_.has_value()) {
+    return;
+  }
+  auto elapsed = now - *scan_started_at_;
+  scan_time_ += elapsed;
+  radio_time_ += elapsed * applied_->window / applied_->interval;
+  scan_started_at_.reset();
+}
+
+LeScanSchedulerMetrics LeScanScheduler::GetMetrics(
+        std::chrono::steady_clock::time_point now) const {
+  auto scan_time = scan_time_;
+  auto radio_time = radio_time_;
+  if (scan_started_at_.has_value()) {
+    auto elapsed = now - *scan_started_at_;
+    scan_time += elapsed;
+    radio_time += elapsed * applied_->window / applied_->interval;
+  }
+  return LeScanSchedulerMetrics{
+          .scan_time = std::chrono::duration_cast<std::chrono::milliseconds>(scan_time),
+          .radio_time = std::chrono::duration_cast<std::chrono::milliseconds>(radio_time),
+          .advertisers = EstimateAdvertisers(previous_advertisers_),
+          .discovered_advertisers = discovered_count_,
+          .discovery_latency =
+                  discovered_count_ == 0
+                          ? std::chrono::milliseconds::zero()
+                          : std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    discovery_latency_sum_ / discovered_count_),
+  };
+}
+
+uint32_t LeScanScheduler::EstimateAdvertisers(const std::bitset<kAdvertiserBits>& bits) {
+  // Linear counting: with n advertisers hashed uniformly, the expected
+  // fraction of unset bits is exp(-n / kAdvertiserBits).
+  size_t unset = kAdvertiserBits - bits.count();
+  if (unset == 0) {
+    unset = 1;
+  }
+  return static_cast<uint32_t>(
+          std::lround(kAdvertiserBits * std::log(static_cast<double>(kAdvertiserBits) / unset)));
+}
+
+}  // namespace bluetooth::hci
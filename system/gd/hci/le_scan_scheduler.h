@@ -0,0 +1,138 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+
+#include "hci/address.h"
+#include "hci/hci_packets.h"
+#include "hci/le_scanning_callback.h"
+
+namespace bluetooth::hci {
+
+/// Scan parameters requested by a scanner, or programmed in the
+/// controller. The interval and window are in units of 0.625 ms.
+struct LeScanConfiguration {
+  LeScanType scan_type;
+  uint16_t interval;
+  uint16_t window;
+  uint8_t phys;
+
+  bool operator==(const LeScanConfiguration&) const = default;
+};
+
+struct LeScanSchedulerMetrics {
+  /// Time spent with scanning enabled.
+  std::chrono::milliseconds scan_time;
+  /// Time spent in scan windows, with the receiver on.
+  std::chrono::milliseconds radio_time;
+  /// Estimated number of advertisers in range during the last epoch.
+  uint32_t advertisers;
+  /// Advertisers reported since the discovery started, and mean delay
+  /// between the start of the discovery and their first report.
+  uint32_t discovered_advertisers;
+  std::chrono::milliseconds discovery_latency;
+};
+
+/// Merges the scan parameters of all the scanners into one controller
+/// configuration: the scan is active if any scanner scans actively, on all
+/// the requested PHYs, with the shortest requested interval and the highest
+/// requested duty cycle.
+///
+/// When adaptive, the duty cycle is halved at the end of each epoch where
+/// the population of advertisers in range did not change, down to a
+/// quarter of the requested duty cycle, and restored as soon as new
+/// advertisers are observed. The duty cycle is also capped while ACL links
+/// or isochronous groups share the radio with the scanner.
+///
+/// Filters are not merged here: the filter policy is set for all the
+/// scanners, and the content filters of the scanners already coexist in the
+/// controller under their own filter indexes.
+class LeScanScheduler {
+public:
+  static constexpr uint8_t kMaxDutyCycleShift = 2;
+  static constexpr double kAclDutyCycleCap = 0.5;
+  static constexpr double kIsoDutyCycleCap = 0.25;
+  /// Longest scan window while isochronous traffic is active (30 ms), so
+  /// that the streams are not preempted for whole windows.
+  static constexpr uint16_t kIsoMaxScanWindow = 48;
+
+  void SetScannerParameters(ScannerId scanner_id, LeScanConfiguration parameters);
+  void RemoveScanner(ScannerId scanner_id);
+
+  /// Returns the merged configuration, or std::nullopt when no scanner set
+  /// its parameters.
+  std::optional<LeScanConfiguration> GetConfiguration() const;
+
+  void SetAdaptive(bool adaptive);
+  void SetAclConnectionCount(uint8_t acl_connections) { acl_connections_ = acl_connections; }
+  void SetIsoTrafficActive(bool active) { iso_traffic_active_ = active; }
+
+  /// Starts measuring the discovery latency, when scanning is enabled by
+  /// the scanners.
+  void StartDiscovery(std::chrono::steady_clock::time_point now);
+
+  /// Records an advertising report received in the current epoch.
+  void OnAdvertisingReport(uint8_t address_type, const Address& address,
+                           std::chrono::steady_clock::time_point now);
+
+  /// Ends the current epoch and adapts the duty cycle to the advertisers
+  /// observed. Returns NeedsReconfiguration().
+  bool EndEpoch();
+
+  /// Returns true if scanning and the merged configuration differs from
+  /// the configuration programmed in the controller.
+  bool NeedsReconfiguration() const;
+
+  /// Accounting of the scan and radio time, with the configuration
+  /// programmed in the controller.
+  void OnScanStarted(LeScanConfiguration applied, std::chrono::steady_clock::time_point now);
+  void OnScanStopped(std::chrono::steady_clock::time_point now);
+
+  LeScanSchedulerMetrics GetMetrics(std::chrono::steady_clock::time_point now) const;
+
+private:
+  static constexpr size_t kAdvertiserBits = 256;
+
+  // Estimates the number of distinct advertisers that set |bits|.
+  static uint32_t EstimateAdvertisers(const std::bitset<kAdvertiserBits>& bits);
+
+  std::map<ScannerId, LeScanConfiguration> scanners_;
+  bool adaptive_{false};
+  uint8_t duty_cycle_shift_{0};
+  uint8_t acl_connections_{0};
+  bool iso_traffic_active_{false};
+
+  // Advertisers observed during the current and the previous epochs, and
+  // since the discovery started, hashed by address.
+  std::bitset<kAdvertiserBits> advertisers_;
+  std::bitset<kAdvertiserBits> previous_advertisers_;
+  std::bitset<kAdvertiserBits> discovered_advertisers_;
+  std::chrono::steady_clock::time_point discovery_started_at_;
+  std::chrono::steady_clock::duration discovery_latency_sum_{};
+  uint32_t discovered_count_{0};
+
+  std::optional<LeScanConfiguration> applied_;
+  std::optional<std::chrono::steady_clock::time_point> scan_started_at_;
+  std::chrono::steady_clock::duration scan_time_{};
+  std::chrono::steady_clock::duration radio_time_{};
+};
+
+}  // namespace bluetooth::hci
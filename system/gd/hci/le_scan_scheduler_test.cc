@@ -0,0 +1,318 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_scan_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace bluetooth::hci {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr uint8_t k1M = 0x01;
+constexpr uint8_t kCoded = 0x04;
+
+const LeScanConfiguration kLowPower{
+        .scan_type = LeScanType::PASSIVE, .interval = 8192, .window = 819, .phys = k1M};
+const LeScanConfiguration kBalanced{
+        .scan_type = LeScanType::ACTIVE, .interval = 4096, .window = 1024, .phys = k1M};
+const LeScanConfiguration kLowLatency{
+        .scan_type = LeScanType::PASSIVE, .interval = 4096, .window = 4096, .phys = kCoded};
+
+Address MakeAddress(uint16_t i) {
+  return Address({static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8), 0x03, 0x04, 0x05, 0x06});
+}
+
+void Report(LeScanScheduler& scheduler, uint16_t first, uint16_t count,
+            std::chrono::steady_clock::time_point now = {}) {
+  for (uint16_t i = first; i < first + count; i++) {
+    scheduler.OnAdvertisingReport(0x00, MakeAddress(i), now);
+  }
+}
+
+TEST(LeScanSchedulerTest, no_scanner) {
+  LeScanScheduler scheduler;
+  ASSERT_FALSE(scheduler.GetConfiguration().has_value());
+  scheduler.SetScannerParameters(1, kBalanced);
+  scheduler.RemoveScanner(1);
+  ASSERT_FALSE(scheduler.GetConfiguration().has_value());
+}
+
+TEST(LeScanSchedulerTest, merge_scanners) {
+  LeScanScheduler scheduler;
+  scheduler.SetScannerParameters(1, kLowPower);
+  ASSERT_EQ(scheduler.GetConfiguration(), kLowPower);
+
+  // Shortest interval, highest duty cycle, active if any scanner is active
+  scheduler.SetScannerParameters(2, kBalanced);
+  ASSERT_EQ(scheduler.GetConfiguration(), kBalanced);
+
+  scheduler.SetScannerParameters(3, kLowLatency);
+  ASSERT_EQ(scheduler.GetConfiguration(),
+            (LeScanConfiguration{.scan_type = LeScanType::ACTIVE,
+                                 .interval = 4096,
+                                 .window = 4096,
+                                 .phys = k1M | kCoded}));
+
+  // A short interval with a low duty cycle keeps the highest duty cycle
+  scheduler.SetScannerParameters(4, LeScanConfiguration{.scan_type = LeScanType::PASSIVE,
+                                                        .interval = 160,
+                                                        .window = 16,
+                                                        .phys = k1M});
+  ASSERT_EQ(scheduler.GetConfiguration(),
+            (LeScanConfiguration{.scan_type = LeScanType::ACTIVE,
+                                 .interval = 160,
+                                 .window = 160,
+                                 .phys = k1M | kCoded}));
+
+  scheduler.RemoveScanner(3);
+  scheduler.RemoveScanner(4);
+  ASSERT_EQ(scheduler.GetConfiguration(), kBalanced);
+
+  // Updated parameters replace the previous parameters of the scanner
+  scheduler.SetScannerParameters(2, kLowPower);
+  ASSERT_EQ(scheduler.GetConfiguration(), kLowPower);
+}
+
+TEST(LeScanSchedulerTest, coexistence) {
+  LeScanScheduler scheduler;
+  scheduler.SetScannerParameters(1, kLowLatency);
+
+  scheduler.SetAclConnectionCount(2);
+  ASSERT_EQ(scheduler.GetConfiguration()->interval, 4096);
+  ASSERT_EQ(scheduler.GetConfiguration()->window, 2048);
+
+  // Short windows during isochronous traffic, with the same duty cycle
+  scheduler.SetIsoTrafficActive(true);
+  ASSERT_EQ(scheduler.GetConfiguration()->interval, 192);
+  ASSERT_EQ(scheduler.GetConfiguration()->window, LeScanScheduler::kIsoMaxScanWindow);
+
+  scheduler.SetIsoTrafficActive(false);
+  scheduler.SetAclConnectionCount(0);
+  ASSERT_EQ(scheduler.GetConfiguration(), kLowLatency);
+
+  // Lower duty cycles are not changed
+  scheduler.SetScannerParameters(1, kLowPower);
+  scheduler.SetAclConnectionCount(1);
+  ASSERT_EQ(scheduler.GetConfiguration(), kLowPower);
+}
+
+TEST(LeScanSchedulerTest, adaptive_duty_cycle) {
+  LeScanScheduler scheduler;
+  scheduler.SetScannerParameters(1, kLowLatency);
+  scheduler.OnScanStarted(*scheduler.GetConfiguration(), {});
+
+  // Not adaptive
+  ASSERT_FALSE(scheduler.EndEpoch());
+  Report(scheduler, 0, 20);
+  ASSERT_FALSE(scheduler.EndEpoch());
+  ASSERT_EQ(scheduler.GetConfiguration(), kLowLatency);
+
+  scheduler.SetAdaptive(true);
+
+  // Same advertisers in range: the duty cycle is halved at each epoch,
+  // down to a quarter of the requested duty cycle.
+  Report(scheduler, 0, 20);
+  ASSERT_TRUE(scheduler.EndEpoch());
+  ASSERT_EQ(scheduler.GetConfiguration()->window, 2048);
+  Report(scheduler, 0, 20);
+  scheduler.EndEpoch();
+  ASSERT_EQ(scheduler.GetConfiguration()->window, 1024);
+  Report(scheduler, 0, 20);
+  scheduler.EndEpoch();
+  ASSERT_EQ(scheduler.GetConfiguration()->window, 1024);
+
+  // A single new advertiser is not enough to change the duty cycle.
+  Report(scheduler, 0, 20);
+  Report(scheduler, 1000, 1);
+  scheduler.EndEpoch();
+  ASSERT_EQ(scheduler.GetConfiguration()->window, 1024);
+
+  // New advertisers in range
+  Report(scheduler, 0, 20);
+  Report(scheduler, 100, 10);
+  scheduler.EndEpoch();
+  ASSERT_EQ(scheduler.GetConfiguration(), kLowLatency);
+
+  // No advertiser in range
+  scheduler.EndEpoch();
+  ASSERT_EQ(scheduler.GetConfiguration()->window, 2048);
+
+  // The configuration programmed is up to date
+  scheduler.OnScanStarted(*scheduler.GetConfiguration(), {});
+  ASSERT_FALSE(scheduler.NeedsReconfiguration());
+}
+
+TEST(LeScanSchedulerTest, reconfiguration_only_when_scanning) {
+  LeScanScheduler scheduler;
+  scheduler.SetScannerParameters(1, kLowPower);
+  ASSERT_FALSE(scheduler.NeedsReconfiguration());
+
+  scheduler.OnScanStarted(kLowPower, {});
+  ASSERT_FALSE(scheduler.NeedsReconfiguration());
+  scheduler.SetScannerParameters(2, kBalanced);
+  ASSERT_TRUE(scheduler.NeedsReconfiguration());
+
+  scheduler.OnScanStopped({});
+  ASSERT_FALSE(scheduler.NeedsReconfiguration());
+}
+
+TEST(LeScanSchedulerTest, radio_time) {
+  LeScanScheduler scheduler;
+  std::chrono::steady_clock::time_point start;
+  scheduler.OnScanStarted(kBalanced, start);
+  scheduler.OnScanStopped(start + 4s);
+  scheduler.OnScanStarted(kLowLatency, start + 10s);
+
+  LeScanSchedulerMetrics metrics = scheduler.GetMetrics(start + 12s);
+  ASSERT_EQ(metrics.scan_time, 6s);
+  ASSERT_EQ(metrics.radio_time, 3s);
+
+  // Not scanning
+  scheduler.OnScanStopped(start + 13s);
+  metrics = scheduler.GetMetrics(start + 20s);
+  ASSERT_EQ(metrics.scan_time, 7s);
+  ASSERT_EQ(metrics.radio_time, 4s);
+}
+
+TEST(LeScanSchedulerTest, discovery_latency) {
+  LeScanScheduler scheduler;
+  std::chrono::steady_clock::time_point start;
+  scheduler.StartDiscovery(start);
+  Report(scheduler, 0, 1, start + 100ms);
+  Report(scheduler, 1, 1, start + 300ms);
+  // Only the first report of an advertiser counts
+  Report(scheduler, 0, 2, start + 1s);
+
+  LeScanSchedulerMetrics metrics = scheduler.GetMetrics(start + 1s);
+  ASSERT_EQ(metrics.discovered_advertisers, 2u);
+  ASSERT_EQ(metrics.discovery_latency, 200ms);
+
+  scheduler.StartDiscovery(start + 2s);
+  metrics = scheduler.GetMetrics(start + 2s);
+  ASSERT_EQ(metrics.discovered_advertisers, 0u);
+  ASSERT_EQ(metrics.discovery_latency, 0ms);
+}
+
+TEST(LeScanSchedulerTest, advertiser_estimate) {
+  for (uint16_t count : {0, 10, 50, 200}) {
+    LeScanScheduler scheduler;
+    Report(scheduler, 0x1234, count);
+    scheduler.EndEpoch();
+    uint32_t estimate = scheduler.GetMetrics({}).advertisers;
+    ASSERT_GE(estimate, count * 0.8) << count;
+    ASSERT_LE(estimate, count * 1.2) << count;
+  }
+}
+
+// Synthetic advertiser population, received by the scan windows of a
+// simulated controller. The time is simulated, in milliseconds.
+class AdvertiserPopulation {
+public:
+  AdvertiserPopulation(uint16_t first_address, size_t count, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> interval_ms(100, 1000);
+    for (size_t i = 0; i < count; i++) {
+      int interval = interval_ms(generator);
+      advertisers_.push_back(Advertiser{.address = MakeAddress(first_address + i),
+                                        .interval = interval,
+                                        .next_event = static_cast<int>(generator() % interval)});
+    }
+  }
+
+  // Reports the advertising events of [from, to) received by |scheduler|
+  // with the configuration |applied|, starting at |start|.
+  void Scan(LeScanScheduler& scheduler, const LeScanConfiguration& applied,
+            std::chrono::steady_clock::time_point start, int from, int to) {
+    // Scan intervals start at multiples of the interval, 0.625 ms slots
+    for (Advertiser& advertiser : advertisers_) {
+      while (advertiser.next_event < to) {
+        int event = advertiser.next_event;
+        // Pseudo random advertising delay, from 0 to 10 ms
+        advertiser.next_event += advertiser.interval + (event * 7) % 11;
+        if (event < from || (event * 8 % (applied.interval * 5)) >= applied.window * 5) {
+          continue;
+        }
+        scheduler.OnAdvertisingReport(0x00, advertiser.address,
+                                      start + std::chrono::milliseconds(event));
+      }
+    }
+  }
+
+private:
+  struct Advertiser {
+    Address address;
+    int interval;
+    int next_event;
+  };
+  std::vector<Advertiser> advertisers_;
+};
+
+// Simulation of a scan with the scheduler, over epochs of 5 s. Returns the
+// radio time and discovery latency measured.
+LeScanSchedulerMetrics Simulate(bool adaptive, std::chrono::milliseconds duration) {
+  constexpr int kEpochMs = 5000;
+  LeScanScheduler scheduler;
+  scheduler.SetAdaptive(adaptive);
+  scheduler.SetScannerParameters(1, kBalanced);
+  scheduler.SetScannerParameters(2, kLowLatency);
+
+  AdvertiserPopulation population(0, 40, 1);
+  // Advertisers coming in range in the middle of the scan
+  AdvertiserPopulation newcomers(1000, 20, 2);
+
+  std::chrono::steady_clock::time_point start;
+  scheduler.StartDiscovery(start);
+  scheduler.OnScanStarted(*scheduler.GetConfiguration(), start);
+  LeScanConfiguration applied = *scheduler.GetConfiguration();
+  for (int epoch = 0; epoch * kEpochMs < duration.count(); epoch++) {
+    int from = epoch * kEpochMs;
+    population.Scan(scheduler, applied, start, from, from + kEpochMs);
+    if (from >= duration.count() / 2) {
+      newcomers.Scan(scheduler, applied, start, from, from + kEpochMs);
+    }
+    if (scheduler.EndEpoch()) {
+      applied = *scheduler.GetConfiguration();
+      scheduler.OnScanStarted(applied, start + std::chrono::milliseconds(from + kEpochMs));
+    }
+  }
+  return scheduler.GetMetrics(start + duration);
+}
+
+TEST(LeScanSchedulerTest, simulation) {
+  LeScanSchedulerMetrics fixed = Simulate(false, 120s);
+  LeScanSchedulerMetrics adaptive = Simulate(true, 120s);
+
+  // Continuous scan
+  ASSERT_EQ(fixed.scan_time, 120s);
+  ASSERT_EQ(fixed.radio_time, 120s);
+  ASSERT_EQ(fixed.discovered_advertisers, adaptive.discovered_advertisers);
+  ASSERT_GT(adaptive.discovered_advertisers, 50u);
+
+  // Most of the time, the adaptive scan runs with a quarter of the duty
+  // cycle, and discovers the newcomers later.
+  ASSERT_LT(adaptive.radio_time, fixed.radio_time / 2);
+  ASSERT_GT(adaptive.discovery_latency, fixed.discovery_latency);
+  ASSERT_LT(adaptive.discovery_latency, fixed.discovery_latency + 1s);
+}
+
+}  // namespace
+}  // namespace bluetooth::hci
@@ -18,20 +18,28 @@
 #include <bluetooth/log.h>
 #include <com_android_bluetooth_flags.h>
 
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <span>
 #include <unordered_map>
 
+#include "common/bind.h"
 #include "hci/acl_manager.h"
 #include "hci/controller.h"
 #include "hci/event_checkers.h"
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
+#include "hci/le_extended_advertising_report_parser.h"
+#include "hci/le_host_scan_filter.h"
 #include "hci/le_periodic_sync_manager.h"
+#include "hci/le_scan_scheduler.h"
 #include "hci/le_scanning_interface.h"
 #include "hci/le_scanning_reassembler.h"
 #include "module.h"
 #include "os/handler.h"
 #include "os/log.h"
+#include "os/repeating_alarm.h"
 #include "os/system_properties.h"
 #include "storage/storage_module.h"
 
@@ -52,16 +60,18 @@ constexpr uint16_t kLeScanIntervalMax = 0x4000;
 constexpr uint16_t kDefaultLeExtendedScanInterval = 4800;
 constexpr uint16_t kLeExtendedScanIntervalMax = 0xFFFF;
 
-constexpr uint8_t kScannableBit = 1;
-constexpr uint8_t kDirectedBit = 2;
-constexpr uint8_t kScanResponseBit = 3;
-constexpr uint8_t kLegacyBit = 4;
-constexpr uint8_t kDataStatusBits = 5;
-
 // system properties
 const std::string kLeRxPathLossCompProperty = "bluetooth.hardware.radio.le_rx_path_loss_comp_db";
 const std::string kPropertyDisableApcfExtendedFeatures = "bluetooth.le.disable_apcf_extended_features";
 bool kDisableApcfExtendedFeatures = false;
+const std::string kPropertyHostScanFilterFallback = "bluetooth.le.host_scan_filter_fallback";
+const std::string kPropertyDuplicateFilterHeartbeat = "bluetooth.le.duplicate_filter_heartbeat_ms";
+const std::string kPropertyDuplicateFilterRssiDelta = "bluetooth.le.duplicate_filter_rssi_delta";
+constexpr uint32_t kDefaultDuplicateFilterRssiDelta = 6;
+const std::string kPropertyScanScheduler = "bluetooth.le.scan_scheduler";
+const std::string kPropertyAdaptiveScan = "bluetooth.le.adaptive_scan";
+const std::string kPropertyAdaptiveScanEpoch = "bluetooth.le.adaptive_scan_epoch_ms";
+constexpr uint32_t kDefaultAdaptiveScanEpochMs = 5000;
 
 const ModuleFactory LeScanningManager::Factory =
         ModuleFactory([]() { return new LeScanningManager(); });
@@ -199,6 +209,26 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
               LeAdvFilterReadExtendedFeaturesBuilder::Create(),
               module_handler_->BindOnceOn(this, &impl::on_apcf_read_extended_features_complete));
     }
+    host_scan_filter_allowed_ = os::GetSystemPropertyBool(kPropertyHostScanFilterFallback, false);
+    host_scan_filter_active_ = host_scan_filter_allowed_ && !is_filter_supported_;
+    // The duplicate filter is disabled unless a heartbeat interval is set
+    uint32_t duplicate_filter_heartbeat_ms =
+            os::GetSystemPropertyUint32(kPropertyDuplicateFilterHeartbeat, 0);
+    if (duplicate_filter_heartbeat_ms != 0) {
+      duplicate_filter_parameters_ = LeScanningReassembler::DuplicateFilterParameters{
+              .rssi_delta = static_cast<uint8_t>(os::GetSystemPropertyUint32(
+                      kPropertyDuplicateFilterRssiDelta, kDefaultDuplicateFilterRssiDelta)),
+              .heartbeat_interval = std::chrono::milliseconds(duplicate_filter_heartbeat_ms)};
+    }
+    // The scan parameters of the scanners are merged, instead of using the
+    // last parameters set
+    scan_scheduler_enabled_ = os::GetSystemPropertyBool(kPropertyScanScheduler, false);
+    if (scan_scheduler_enabled_ && os::GetSystemPropertyBool(kPropertyAdaptiveScan, false)) {
+      scan_scheduler_.SetAdaptive(true);
+      adaptive_scan_epoch_ = std::chrono::milliseconds(
+              os::GetSystemPropertyUint32(kPropertyAdaptiveScanEpoch, kDefaultAdaptiveScanEpochMs));
+      adaptive_scan_alarm_ = std::make_unique<os::RepeatingAlarm>(module_handler_);
+    }
     is_batch_scan_supported_ = controller->IsSupported(OpCode::LE_BATCH_SCAN);
     is_periodic_advertising_sync_transfer_sender_supported_ =
             controller_->SupportsBlePeriodicAdvertisingSyncTransferSender();
@@ -222,6 +252,10 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   }
 
   void stop() {
+    if (adaptive_scan_alarm_ != nullptr) {
+      adaptive_scan_alarm_->Cancel();
+      adaptive_scan_alarm_.reset();
+    }
     for (auto subevent_code : LeScanningEvents) {
       hci_layer_->UnregisterLeEventHandler(subevent_code);
     }
@@ -385,27 +419,31 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   }
 
   void handle_extended_advertising_report(LeExtendedAdvertisingReportRawView event_view) {
-    if (!event_view.IsValid()) {
+    // The reports are parsed in place, without copying the advertising data.
+    // The events received from the HAL are contiguous; other events are
+    // copied to a buffer first.
+    std::optional<std::span<const uint8_t>> event_bytes = event_view.GetContiguousBytes();
+    if (!event_bytes.has_value()) {
+      event_buffer_.assign(event_view.begin(), event_view.end());
+      event_bytes = event_buffer_;
+    }
+
+    LeExtendedAdvertisingReportParser parser(*event_bytes);
+    if (!parser.IsValid()) {
       log::info("Dropping invalid advertising event");
       return;
     }
 
-    std::vector<LeExtendedAdvertisingResponseRaw> reports = event_view.GetResponses();
-    if (reports.empty()) {
+    if (parser.NumReports() == 0) {
       log::info("Zero results in advertising event");
       return;
     }
 
-    for (LeExtendedAdvertisingResponseRaw& report : reports) {
-      uint16_t event_type =
-              report.connectable_ | (report.scannable_ << kScannableBit) |
-              (report.directed_ << kDirectedBit) | (report.scan_response_ << kScanResponseBit) |
-              (report.legacy_ << kLegacyBit) | ((uint16_t)report.data_status_ << kDataStatusBits);
+    while (std::optional<LeExtendedAdvertisingReportEntry> report = parser.Next()) {
       process_advertising_package_content(
-              event_type, (uint8_t)report.address_type_, report.address_,
-              (uint8_t)report.primary_phy_, (uint8_t)report.secondary_phy_, report.advertising_sid_,
-              report.tx_power_, report.rssi_, report.periodic_advertising_interval_,
-              report.advertising_data_);
+              report->event_type, report->address_type, report->address, report->primary_phy,
+              report->secondary_phy, report->advertising_sid, report->tx_power, report->rssi,
+              report->periodic_advertising_interval, report->advertising_data);
     }
   }
 
@@ -414,7 +452,11 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
                                            uint8_t secondary_phy, uint8_t advertising_sid,
                                            int8_t tx_power, int8_t rssi,
                                            uint16_t periodic_advertising_interval,
-                                           const std::vector<uint8_t>& advertising_data) {
+                                           std::span<const uint8_t> advertising_data) {
+    if (scan_scheduler_enabled_) {
+      scan_scheduler_.OnAdvertisingReport(address_type, address, std::chrono::steady_clock::now());
+    }
+
     // When using the vendor command Le Set Extended Params to
     // configure a filter accept list based e.g. on the service UUIDs
     // found in the report, we ignore the scan responses as we cannot be
@@ -426,11 +468,36 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
             le_scan_type_ == LeScanType::PASSIVE ||
             filter_policy_ == LeScanningFilterPolicy::FILTER_ACCEPT_LIST_ONLY);
 
-    std::optional<LeScanningReassembler::CompleteAdvertisingData> processed_report =
-            scanning_reassembler_.ProcessAdvertisingReport(event_type, address_type, address,
-                                                           advertising_sid, advertising_data);
+    std::optional<LeScanningReassembler::CompleteAdvertisingDataView> processed_report =
+            scanning_reassembler_.ProcessAdvertisingReportView(event_type, address_type, address,
+                                                               advertising_sid, advertising_data);
 
     if (processed_report.has_value()) {
+      // The controller doesn't resolve the addresses of the devices left out of its resolving
+      // list. Only the reports are rewritten: the controller still can't connect to these devices
+      // through its accept list, so the devices of direct connections get the resolving list
+      // first.
+      if (address_type == (uint8_t)AddressType::RANDOM_DEVICE_ADDRESS) {
+        std::optional<AddressWithType> identity_address =
+                le_address_manager_->ResolveOnHost(address);
+        if (identity_address.has_value()) {
+          address = identity_address->GetAddress();
+          address_type = (uint8_t)identity_address->GetAddressType();
+        }
+      }
+
+      if (host_scan_filter_active_ &&
+          !host_scan_filter_.Matches(address, address_type, rssi, processed_report->data)) {
+        return;
+      }
+
+      if (scanning_reassembler_.IsDuplicate(address_type, address, advertising_sid, rssi,
+                                            processed_report->extended_event_type,
+                                            processed_report->data,
+                                            std::chrono::steady_clock::now())) {
+        return;
+      }
+
       switch (address_type) {
         case (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS:
         case (uint8_t)AddressType::PUBLIC_IDENTITY_ADDRESS:
@@ -450,7 +517,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       scanning_callbacks_->OnScanResult(
               result_event_type, address_type, address, primary_phy, secondary_phy, advertising_sid,
               tx_power, get_rssi_after_calibration(rssi), periodic_advertising_interval,
-              std::move(processed_report->data));
+              std::vector<uint8_t>(processed_report->data.begin(), processed_report->data.end()));
     }
   }
 
@@ -536,6 +603,10 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       scanners_[scanner_id].in_use = false;
       scanners_[scanner_id].app_uuid = Uuid::kEmpty;
       log::debug("Unregister scanner successful, scannerId={}", scanner_id);
+      if (scan_scheduler_enabled_) {
+        scan_scheduler_.RemoveScanner(scanner_id);
+        reconfigure_scan_if_needed();
+      }
     } else {
       log::warn("Unregister scanner with unused scanner id");
     }
@@ -545,6 +616,13 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     // On-resume flag should always be reset if there is an explicit start/stop call.
     scan_on_resume_ = false;
     if (start) {
+      if (scan_scheduler_enabled_) {
+        scan_scheduler_.StartDiscovery(std::chrono::steady_clock::now());
+        apply_scan_configuration();
+      }
+      // Report again all the advertisements in range to the scanners that
+      // just started.
+      scanning_reassembler_.SetDuplicateFilter(duplicate_filter_parameters_);
       configure_scan();
       start_scan();
     } else {
@@ -564,6 +642,17 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
     is_scanning_ = true;
+    scan_scheduler_.OnScanStarted(
+            LeScanConfiguration{.scan_type = le_scan_type_,
+                                .interval = static_cast<uint16_t>(interval_ms_),
+                                .window = window_ms_,
+                                .phys = phy_},
+            std::chrono::steady_clock::now());
+    if (adaptive_scan_alarm_ != nullptr) {
+      adaptive_scan_alarm_->Schedule(common::Bind(&impl::on_adaptive_scan_epoch,
+                                                  common::Unretained(this)),
+                                     adaptive_scan_epoch_);
+    }
     if (!address_manager_registered_) {
       le_address_manager_->Register(this);
       address_manager_registered_ = true;
@@ -598,6 +687,15 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
     is_scanning_ = false;
+    if (adaptive_scan_alarm_ != nullptr) {
+      adaptive_scan_alarm_->Cancel();
+    }
+    auto now = std::chrono::steady_clock::now();
+    scan_scheduler_.OnScanStopped(now);
+    LeScanSchedulerMetrics metrics = scan_scheduler_.GetMetrics(now);
+    log::debug("Scan time {} ms, radio time {} ms, {} advertisers discovered in {} ms",
+               metrics.scan_time.count(), metrics.radio_time.count(),
+               metrics.discovered_advertisers, metrics.discovery_latency.count());
 
     switch (api_type_) {
       case ScanApiType::EXTENDED:
@@ -649,6 +747,18 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
               scanner_id, ScanningCallback::ScanningStatus::ILLEGAL_PARAMETER);
       return;
     }
+    if (scan_scheduler_enabled_) {
+      scan_scheduler_.SetScannerParameters(
+              scanner_id,
+              LeScanConfiguration{
+                      .scan_type = scan_type,
+                      .interval = scan_interval,
+                      .window = scan_window,
+                      .phys = com::android::bluetooth::flags::phy_to_native() ? scan_phy : phy_});
+      apply_scan_configuration();
+      scanning_callbacks_->OnSetScannerParameterComplete(scanner_id, ScanningCallback::SUCCESS);
+      return;
+    }
     le_scan_type_ = scan_type;
     interval_ms_ = scan_interval;
     window_ms_ = scan_window;
@@ -658,11 +768,64 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     scanning_callbacks_->OnSetScannerParameterComplete(scanner_id, ScanningCallback::SUCCESS);
   }
 
+  // Uses the parameters merged by the scan scheduler for the next scan.
+  void apply_scan_configuration() {
+    std::optional<LeScanConfiguration> configuration = scan_scheduler_.GetConfiguration();
+    if (!configuration.has_value()) {
+      return;
+    }
+    le_scan_type_ = configuration->scan_type;
+    interval_ms_ = configuration->interval;
+    window_ms_ = configuration->window;
+    phy_ = configuration->phys;
+  }
+
+  // Reprograms the scan when the merged parameters changed since the scan
+  // was started.
+  void reconfigure_scan_if_needed() {
+    if (!scan_scheduler_.NeedsReconfiguration() || paused_) {
+      return;
+    }
+    apply_scan_configuration();
+    configure_scan();
+    start_scan();
+  }
+
+  void on_adaptive_scan_epoch() {
+    if (scan_scheduler_.EndEpoch()) {
+      reconfigure_scan_if_needed();
+    }
+  }
+
+  void set_acl_connection_count(uint8_t acl_connections) {
+    scan_scheduler_.SetAclConnectionCount(acl_connections);
+    if (scan_scheduler_enabled_) {
+      reconfigure_scan_if_needed();
+    }
+  }
+
+  void set_iso_traffic_active(bool active) {
+    scan_scheduler_.SetIsoTrafficActive(active);
+    if (scan_scheduler_enabled_) {
+      reconfigure_scan_if_needed();
+    }
+  }
+
   void set_scan_filter_policy(LeScanningFilterPolicy filter_policy) {
     filter_policy_ = filter_policy;
   }
 
   void scan_filter_enable(bool enable) {
+    if (host_scan_filter_allowed_) {
+      host_scan_filter_.Enable(enable);
+      // The controller filter stays disabled, to get all the reports
+      if (host_scan_filter_active_) {
+        scanning_callbacks_->OnFilterEnable(enable ? Enable::ENABLED : Enable::DISABLED,
+                                            (uint8_t)ErrorCode::SUCCESS);
+        return;
+      }
+    }
+
     if (!is_filter_supported_) {
       log::warn("Advertising filter is not supported");
       return;
@@ -687,6 +850,23 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
 
   void scan_filter_parameter_setup(ApcfAction action, uint8_t filter_index,
                                    AdvertisingFilterParameter advertising_filter_parameter) {
+    if (host_scan_filter_allowed_) {
+      uint8_t available_spaces = host_scan_filter_.SetParameters(action, filter_index,
+                                                                 advertising_filter_parameter);
+      if (!host_scan_filter_active_ && action == ApcfAction::ADD &&
+          filter_index >= controller_->GetVendorCapabilities().max_filter_) {
+        log::info("Filter index {} is beyond the controller filters", filter_index);
+        start_host_scan_filter();
+      }
+      if (host_scan_filter_active_) {
+        scanning_callbacks_->OnFilterParamSetup(available_spaces, action,
+                                                (uint8_t)ErrorCode::SUCCESS);
+        if (!is_filter_supported_) {
+          return;
+        }
+      }
+    }
+
     if (!is_filter_supported_) {
       log::warn("Advertising filter is not supported");
       return;
@@ -695,6 +875,9 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     auto entry = remove_me_later_map_.find(filter_index);
     switch (action) {
       case ApcfAction::ADD:
+        if (is_host_only_filter(filter_index)) {
+          break;
+        }
         le_scanning_interface_->EnqueueCommand(
                 LeAdvFilterAddFilteringParametersBuilder::Create(
                         filter_index, advertising_filter_parameter.feature_selection,
@@ -711,9 +894,11 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
         break;
       case ApcfAction::DELETE:
         tracker_id_map_.erase(filter_index);
-        le_scanning_interface_->EnqueueCommand(
-                LeAdvFilterDeleteFilteringParametersBuilder::Create(filter_index),
-                module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
+        if (!is_host_only_filter(filter_index)) {
+          le_scanning_interface_->EnqueueCommand(
+                  LeAdvFilterDeleteFilteringParametersBuilder::Create(filter_index),
+                  module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
+        }
 
         // IRK Scanning
         if (entry != remove_me_later_map_.end()) {
@@ -752,6 +937,22 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
 
   void scan_filter_add(uint8_t filter_index,
                        std::vector<AdvertisingPacketContentFilterCommand> filters) {
+    if (host_scan_filter_allowed_) {
+      for (const auto& filter : filters) {
+        ErrorCode status = host_scan_filter_.Add(filter_index, filter)
+                                   ? ErrorCode::SUCCESS
+                                   : ErrorCode::INVALID_HCI_COMMAND_PARAMETERS;
+        if (host_scan_filter_active_) {
+          scanning_callbacks_->OnFilterConfigCallback(filter.filter_type,
+                                                      host_scan_filter_.AvailableSpaces(),
+                                                      ApcfAction::ADD, (uint8_t)status);
+        }
+      }
+      if (host_scan_filter_active_ && !is_filter_supported_) {
+        return;
+      }
+    }
+
     if (!is_filter_supported_) {
       log::warn("Advertising filter is not supported");
       return;
@@ -766,6 +967,12 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
         continue;
       }
 
+      // The resolving list is still needed for the addresses of the host only filters
+      if (is_host_only_filter(filter_index) &&
+          filter.filter_type != ApcfFilterType::BROADCASTER_ADDRESS) {
+        continue;
+      }
+
       switch (filter.filter_type) {
         case ApcfFilterType::BROADCASTER_ADDRESS: {
           update_address_filter(apcf_action, filter_index, filter.address,
@@ -829,10 +1036,12 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
        * IDENTITY (2). For this, Addresses type not applicable (0x02) must be specified.
        * This should also cover if the RPA is derived from RANDOM STATIC.
        */
-      le_scanning_interface_->EnqueueCommand(
-              LeAdvFilterBroadcasterAddressBuilder::Create(
-                      action, filter_index, address, ApcfApplicationAddressType::NOT_APPLICABLE),
-              module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
+      if (!is_host_only_filter(filter_index)) {
+        le_scanning_interface_->EnqueueCommand(
+                LeAdvFilterBroadcasterAddressBuilder::Create(
+                        action, filter_index, address, ApcfApplicationAddressType::NOT_APPLICABLE),
+                module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
+      }
       if (!is_empty_128bit(irk)) {
         // If an entry exists for this filter index, replace data because the filter has been
         // updated.
@@ -856,9 +1065,11 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
                 filter_index, AddressWithType(address, static_cast<AddressType>(address_type)));
       }
     } else {
-      le_scanning_interface_->EnqueueCommand(
-              LeAdvFilterClearBroadcasterAddressBuilder::Create(filter_index),
-              module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
+      if (!is_host_only_filter(filter_index)) {
+        le_scanning_interface_->EnqueueCommand(
+                LeAdvFilterClearBroadcasterAddressBuilder::Create(filter_index),
+                module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
+      }
       auto entry = remove_me_later_map_.find(filter_index);
       if (entry != remove_me_later_map_.end()) {
         // TODO(optedoblivion): If not bonded
@@ -1309,7 +1520,28 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     periodic_sync_manager_.SetScanningCallback(scanning_callbacks_);
   }
 
-  bool is_ad_type_filter_supported() { return is_ad_type_filter_supported_; }
+  bool is_ad_type_filter_supported() {
+    return is_ad_type_filter_supported_ || host_scan_filter_active_;
+  }
+
+  // The controller has no room for the filters beyond its max_filter: they are
+  // only set on the host.
+  bool is_host_only_filter(uint8_t filter_index) {
+    return host_scan_filter_allowed_ &&
+           filter_index >= controller_->GetVendorCapabilities().max_filter_;
+  }
+
+  // Moves the filtering from the controller to the host, which gets all the
+  // reports from then on.
+  void start_host_scan_filter() {
+    log::info("Filtering advertising reports on the host");
+    host_scan_filter_active_ = true;
+    if (is_filter_supported_ && host_scan_filter_.IsEnabled()) {
+      le_scanning_interface_->EnqueueCommand(
+              LeAdvFilterEnableBuilder::Create(Enable::DISABLED),
+              module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
+    }
+  }
 
   void on_set_scan_parameter_complete(CommandCompleteView view) {
     switch (view.GetCommandOpCode()) {
@@ -1352,6 +1584,23 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     }
 
     ApcfOpcode apcf_opcode = status_view.GetApcfOpcode();
+    if (host_scan_filter_allowed_) {
+      // The controller is out of filters: the filter is set on the host only
+      if (!host_scan_filter_active_ && status_view.GetStatus() != ErrorCode::SUCCESS &&
+          apcf_opcode == ApcfOpcode::SET_FILTERING_PARAMETERS) {
+        auto complete_view = LeAdvFilterSetFilteringParametersCompleteView::Create(status_view);
+        if (complete_view.IsValid() && complete_view.GetApcfAction() == ApcfAction::ADD) {
+          start_host_scan_filter();
+          scanning_callbacks_->OnFilterParamSetup(host_scan_filter_.AvailableSpaces(),
+                                                  ApcfAction::ADD, (uint8_t)ErrorCode::SUCCESS);
+        }
+      }
+      // The host filter already reported the outcome of the command
+      if (host_scan_filter_active_) {
+        return;
+      }
+    }
+
     switch (apcf_opcode) {
       case ApcfOpcode::ENABLE: {
         auto complete_view = LeAdvFilterEnableCompleteView::Create(status_view);
@@ -1603,7 +1852,18 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   bool scan_on_resume_ = false;
   bool paused_ = false;
   LeScanningReassembler scanning_reassembler_;
+  std::vector<uint8_t> event_buffer_;
+  std::optional<LeScanningReassembler::DuplicateFilterParameters> duplicate_filter_parameters_;
+  bool scan_scheduler_enabled_ = false;
+  LeScanScheduler scan_scheduler_;
+  std::chrono::milliseconds adaptive_scan_epoch_{kDefaultAdaptiveScanEpochMs};
+  std::unique_ptr<os::RepeatingAlarm> adaptive_scan_alarm_;
   bool is_filter_supported_ = false;
+  // Filtering of the reports on the host, in place of the controller when it
+  // does not support filtering or is out of filters
+  bool host_scan_filter_allowed_ = false;
+  bool host_scan_filter_active_ = false;
+  LeHostScanFilter host_scan_filter_;
   bool is_ad_type_filter_supported_ = false;
   bool is_batch_scan_supported_ = false;
   bool is_periodic_advertising_sync_transfer_sender_supported_ = false;
@@ -1660,6 +1920,14 @@ void LeScanningManager::SetScanParameters(ScannerId scanner_id, LeScanType scan_
          scan_window, scan_phy);
 }
 
+void LeScanningManager::SetAclConnectionCount(uint8_t acl_connections) {
+  CallOn(pimpl_.get(), &impl::set_acl_connection_count, acl_connections);
+}
+
+void LeScanningManager::SetIsoTrafficActive(bool active) {
+  CallOn(pimpl_.get(), &impl::set_iso_traffic_active, active);
+}
+
 void LeScanningManager::SetScanFilterPolicy(LeScanningFilterPolicy filter_policy) {
   CallOn(pimpl_.get(), &impl::set_scan_filter_policy, filter_policy);
 }
@@ -55,6 +55,11 @@ public:
   virtual void SetScanParameters(ScannerId scanner_id, LeScanType scan_type, uint16_t scan_interval,
                                  uint16_t scan_window, uint8_t scan_phy);
 
+  /* Radio activity shared with the scan, when the scan parameters are merged */
+  virtual void SetAclConnectionCount(uint8_t acl_connections);
+
+  virtual void SetIsoTrafficActive(bool active);
+
   virtual void SetScanFilterPolicy(LeScanningFilterPolicy filter_policy);
 
   /* Scan filter */
@@ -21,6 +21,7 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <list>
@@ -28,6 +29,7 @@
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <thread>
 #include <vector>
 
 #include "common/bind.h"
@@ -37,10 +39,12 @@
 #include "hci/hci_layer.h"
 #include "hci/hci_layer_fake.h"
 #include "hci/uuid.h"
+#include "os/system_properties.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
 
 using ::testing::_;
+using ::testing::AnyNumber;
 using ::testing::Eq;
 
 using namespace bluetooth;
@@ -145,6 +149,10 @@ public:
     support_ble_periodic_advertising_sync_transfer_ = support;
   }
 
+  VendorCapabilities GetVendorCapabilities() const override { return vendor_capabilities_; }
+
+  void SetMaxFilter(uint8_t max_filter) { vendor_capabilities_.max_filter_ = max_filter; }
+
 protected:
   void Start() override {}
   void Stop() override {}
@@ -154,6 +162,7 @@ private:
   std::set<OpCode> supported_opcodes_{};
   bool support_ble_extended_advertising_ = false;
   bool support_ble_periodic_advertising_sync_transfer_ = false;
+  VendorCapabilities vendor_capabilities_{};
 };
 
 class TestLeAddressManager : public LeAddressManager {
@@ -328,6 +337,30 @@ protected:
   void TearDown() override { LeScanningManagerTest::TearDown(); }
 };
 
+class LeScanningManagerHostScanFilterTest : public LeScanningManagerTest {
+protected:
+  void SetUp() override {
+    LeScanningManagerTest::SetUp();
+    os::SetSystemProperty("bluetooth.le.host_scan_filter_fallback", "true");
+    test_controller_->AddSupported(OpCode::LE_EXTENDED_SCAN_PARAMS);
+    test_controller_->AddSupported(OpCode::LE_ADV_FILTER);
+    test_controller_->SetMaxFilter(kMaxFilter);
+    start_le_scanning_manager();
+    ASSERT_TRUE(fake_registry_.IsStarted(&HciLayer::Factory));
+
+    ASSERT_EQ(OpCode::LE_ADV_FILTER, test_hci_layer_->GetCommand().GetOpCode());
+    test_hci_layer_->IncomingEvent(LeAdvFilterReadExtendedFeaturesCompleteBuilder::Create(
+            1, ErrorCode::SUCCESS, 0x01, 0x01));
+  }
+
+  void TearDown() override {
+    LeScanningManagerTest::TearDown();
+    os::ClearSystemPropertiesForHost();
+  }
+
+  static constexpr uint8_t kMaxFilter = 2;
+};
+
 class LeScanningManagerExtendedTest : public LeScanningManagerTest {
 protected:
   void SetUp() override {
@@ -339,6 +372,86 @@ protected:
   }
 };
 
+class LeScanningManagerSchedulerTest : public LeScanningManagerTest {
+protected:
+  void SetUp() override {
+    LeScanningManagerTest::SetUp();
+    os::SetSystemProperty("bluetooth.le.scan_scheduler", "true");
+    os::SetSystemProperty("bluetooth.le.adaptive_scan", "true");
+    os::SetSystemProperty("bluetooth.le.adaptive_scan_epoch_ms", "50");
+    start_le_scanning_manager();
+  }
+
+  void TearDown() override {
+    LeScanningManagerTest::TearDown();
+    os::ClearSystemPropertiesForHost();
+  }
+
+  LeSetScanParametersView GetScanParameters() {
+    auto view = LeSetScanParametersView::Create(LeScanningCommandView::Create(
+            test_hci_layer_->GetCommand(OpCode::LE_SET_SCAN_PARAMETERS)));
+    EXPECT_TRUE(view.IsValid());
+    return view;
+  }
+};
+
+class LeScanningManagerDuplicateFilterTest : public LeScanningManagerTest {
+protected:
+  void SetUp() override {
+    LeScanningManagerTest::SetUp();
+    os::SetSystemProperty("bluetooth.le.scan_scheduler", "true");
+    os::SetSystemProperty("bluetooth.le.duplicate_filter_heartbeat_ms", "60000");
+    start_le_scanning_manager();
+  }
+
+  void TearDown() override {
+    LeScanningManagerTest::TearDown();
+    os::ClearSystemPropertiesForHost();
+  }
+};
+
+// Synthetic population of advertisers in range, each reported by the
+// controller in turn while scanning, from a separate thread.
+class SyntheticAdvertisers {
+public:
+  explicit SyntheticAdvertisers(HciLayerFake* hci_layer) : hci_layer_(hci_layer) {}
+  ~SyntheticAdvertisers() { Stop(); }
+
+  void Start(size_t population) {
+    population_ = population;
+    running_ = true;
+    thread_ = std::thread([this] { Run(); });
+  }
+
+  void SetPopulation(size_t population) { population_ = population; }
+
+  void Stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+private:
+  void Run() {
+    while (running_) {
+      for (size_t i = 0; i < population_ && running_; i++) {
+        LeAdvertisingResponse report = make_advertising_report();
+        report.event_type_ = AdvertisingEventType::ADV_NONCONN_IND;
+        report.address_ = Address({static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8), 0x03,
+                                   0x04, 0x05, 0x06});
+        hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
+      }
+      std::this_thread::sleep_for(2ms);
+    }
+  }
+
+  HciLayerFake* hci_layer_;
+  std::atomic<size_t> population_{0};
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
 TEST_F(LeScanningManagerTest, startup_teardown) {}
 
 TEST_F(LeScanningManagerTest, start_scan_test) {
@@ -629,6 +742,20 @@ TEST_F(LeScanningManagerAndroidHciTest, scan_filter_add_ad_type_test) {
           uint8_t{1}, ErrorCode::SUCCESS, ApcfAction::ADD, 0x0a));
 }
 
+TEST_F(LeScanningManagerHostScanFilterTest, filter_beyond_max_filter_is_not_sent) {
+  AdvertisingFilterParameter advertising_filter_parameter{};
+  advertising_filter_parameter.delivery_mode = DeliveryMode::IMMEDIATE;
+  EXPECT_CALL(mock_callbacks_, OnFilterParamSetup(_, ApcfAction::ADD, 0));
+  le_scanning_manager->ScanFilterParameterSetup(ApcfAction::ADD, kMaxFilter,
+                                                advertising_filter_parameter);
+  EXPECT_CALL(mock_callbacks_, OnFilterConfigCallback(ApcfFilterType::LOCAL_NAME, _,
+                                                      ApcfAction::ADD, 0));
+  le_scanning_manager->ScanFilterAdd(kMaxFilter, {make_filter(ApcfFilterType::LOCAL_NAME)});
+  sync_client_handler();
+
+  test_hci_layer_->AssertNoQueuedCommand();
+}
+
 TEST_F(LeScanningManagerAndroidHciTest, read_batch_scan_result) {
   le_scanning_manager->BatchScanConifgStorage(100, 0, 95, 0x00);
   sync_client_handler();
@@ -926,6 +1053,89 @@ TEST_F(LeScanningManagerExtendedTest, drop_insignificant_bytes_test) {
           LeExtendedAdvertisingReportBuilder::Create({scan_response_report}));
 }
 
+TEST_F(LeScanningManagerSchedulerTest, merge_scan_parameters) {
+  EXPECT_CALL(mock_callbacks_, OnScannerRegistered(_, _, ScanningCallback::SUCCESS)).Times(2);
+  le_scanning_manager->RegisterScanner(Uuid::From16Bit(0x0001));
+  le_scanning_manager->RegisterScanner(Uuid::From16Bit(0x0002));
+  EXPECT_CALL(mock_callbacks_, OnSetScannerParameterComplete(_, ScanningCallback::SUCCESS))
+          .Times(2);
+  le_scanning_manager->SetScanParameters(1, LeScanType::PASSIVE, 0x800, 0x80, 0x01);
+  le_scanning_manager->SetScanParameters(2, LeScanType::ACTIVE, 0x100, 0x20, 0x01);
+  le_scanning_manager->Scan(true);
+
+  // Active scan with the shortest interval and the highest duty cycle
+  auto parameters = GetScanParameters();
+  ASSERT_EQ(parameters.GetLeScanType(), LeScanType::ACTIVE);
+  ASSERT_EQ(parameters.GetLeScanInterval(), 0x100);
+  ASSERT_EQ(parameters.GetLeScanWindow(), 0x20);
+
+  // The parameters of the scanners left are used when scanning again
+  le_scanning_manager->Unregister(2);
+  le_scanning_manager->Scan(false);
+  le_scanning_manager->Scan(true);
+  parameters = GetScanParameters();
+  ASSERT_EQ(parameters.GetLeScanType(), LeScanType::PASSIVE);
+  ASSERT_EQ(parameters.GetLeScanInterval(), 0x800);
+  ASSERT_EQ(parameters.GetLeScanWindow(), 0x80);
+}
+
+TEST_F(LeScanningManagerDuplicateFilterTest, reconfiguration_keeps_duplicates_filtered) {
+  EXPECT_CALL(mock_callbacks_, OnScannerRegistered(_, _, ScanningCallback::SUCCESS)).Times(2);
+  le_scanning_manager->RegisterScanner(Uuid::From16Bit(0x0001));
+  le_scanning_manager->RegisterScanner(Uuid::From16Bit(0x0002));
+  EXPECT_CALL(mock_callbacks_, OnSetScannerParameterComplete(_, ScanningCallback::SUCCESS))
+          .Times(2);
+  le_scanning_manager->SetScanParameters(1, LeScanType::PASSIVE, 0x800, 0x80, 0x01);
+  le_scanning_manager->SetScanParameters(2, LeScanType::ACTIVE, 0x100, 0x20, 0x01);
+  le_scanning_manager->Scan(true);
+
+  LeAdvertisingResponse report = make_advertising_report();
+  EXPECT_CALL(mock_callbacks_, OnScanResult).Times(1);
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
+
+  // The scan is reprogrammed for the scanner left, which already got the
+  // report.
+  le_scanning_manager->Unregister(2);
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
+  sync_client_handler();
+  ::testing::Mock::VerifyAndClearExpectations(&mock_callbacks_);
+
+  // Scanning again reports all the advertisements in range
+  le_scanning_manager->Scan(false);
+  le_scanning_manager->Scan(true);
+  EXPECT_CALL(mock_callbacks_, OnScanResult).Times(1);
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
+  sync_client_handler();
+}
+
+TEST_F(LeScanningManagerSchedulerTest, adaptive_scan_simulation) {
+  EXPECT_CALL(mock_callbacks_, OnSetScannerParameterComplete).Times(1);
+  EXPECT_CALL(mock_callbacks_, OnScanResult).Times(AnyNumber());
+  le_scanning_manager->SetScanParameters(1, LeScanType::PASSIVE, 0x100, 0x80, 0x01);
+  le_scanning_manager->Scan(true);
+  ASSERT_EQ(GetScanParameters().GetLeScanWindow(), 0x80);
+
+  // The duty cycle goes down to a quarter while the same advertisers are
+  // in range.
+  SyntheticAdvertisers advertisers(test_hci_layer_);
+  advertisers.Start(40);
+  uint16_t window = 0x80;
+  for (int i = 0; i < 10 && window != 0x20; i++) {
+    window = GetScanParameters().GetLeScanWindow();
+  }
+  ASSERT_EQ(window, 0x20);
+
+  // And is restored when new advertisers come in range.
+  advertisers.SetPopulation(80);
+  for (int i = 0; i < 10 && window != 0x80; i++) {
+    window = GetScanParameters().GetLeScanWindow();
+  }
+  ASSERT_EQ(window, 0x80);
+
+  advertisers.Stop();
+  le_scanning_manager->Scan(false);
+}
+
 }  // namespace
 }  // namespace hci
 }  // namespace bluetooth
@@ -17,7 +17,9 @@
 
 #include <bluetooth/log.h>
 
+#include <cstdlib>
 #include <memory>
+#include <string_view>
 #include <unordered_map>
 
 #include "hci/acl_manager.h"
@@ -37,6 +39,20 @@ std::optional<LeScanningReassembler::CompleteAdvertisingData>
 LeScanningReassembler::ProcessAdvertisingReport(uint16_t event_type, uint8_t address_type,
                                                 Address address, uint8_t advertising_sid,
                                                 const std::vector<uint8_t>& advertising_data) {
+  std::optional<CompleteAdvertisingDataView> result = ProcessAdvertisingReportView(
+          event_type, address_type, address, advertising_sid, advertising_data);
+  if (!result.has_value()) {
+    return {};
+  }
+  return CompleteAdvertisingData{
+          .extended_event_type = result->extended_event_type,
+          .data = std::vector<uint8_t>(result->data.begin(), result->data.end())};
+}
+
+std::optional<LeScanningReassembler::CompleteAdvertisingDataView>
+LeScanningReassembler::ProcessAdvertisingReportView(uint16_t event_type, uint8_t address_type,
+                                                    Address address, uint8_t advertising_sid,
+                                                    std::span<const uint8_t> advertising_data) {
   bool is_scannable = event_type & (1 << kScannableBit);
   bool is_scan_response = event_type & (1 << kScanResponseBit);
   bool is_legacy = event_type & (1 << kLegacyBit);
@@ -64,25 +80,36 @@ LeScanningReassembler::ProcessAdvertisingReport(uint16_t event_type, uint8_t add
     RemoveFragment(key);
   }
 
+  // TODO(b/272120114) waiting for a scan response here is prone to failure as the
+  // SCAN_REQ PDUs can be rejected by the advertiser according to the
+  // advertising filter parameter.
+  bool expect_scan_response = is_scannable && !is_scan_response && !ignore_scan_responses_;
+  bool is_complete = data_status != DataStatus::CONTINUING && !expect_scan_response;
+
+  // Complete advertising data received in a single report, as is most
+  // advertising: the data is returned without being cached. Scan responses
+  // always have a matching fragment.
+  if (is_complete && !is_scan_response && (is_legacy || !ContainsFragment(key))) {
+    log::verbose("Full advertising report has been received");
+    return CompleteAdvertisingDataView{
+            .extended_event_type = event_type,
+            .data = TrimAdvertisingData(advertising_data, complete_data_)};
+  }
+
   // Concatenate the data with existing fragments.
   std::list<AdvertisingFragment>::iterator advertising_fragment =
           AppendFragment(key, event_type, advertising_data);
 
   // Trim the advertising data when the complete payload is received.
   if (data_status != DataStatus::CONTINUING) {
-    advertising_fragment->data = TrimAdvertisingData(advertising_fragment->data);
+    TrimFragment(*advertising_fragment);
   }
 
-  // TODO(b/272120114) waiting for a scan response here is prone to failure as the
-  // SCAN_REQ PDUs can be rejected by the advertiser according to the
-  // advertising filter parameter.
-  bool expect_scan_response = is_scannable && !is_scan_response && !ignore_scan_responses_;
-
   // Check if we should wait for additional fragments:
   // - For legacy advertising, when a scan response is expected.
   // - For extended advertising, when the current data is marked
   //   incomplete OR when a scan response is expected.
-  if (data_status == DataStatus::CONTINUING || expect_scan_response) {
+  if (!is_complete) {
     log::verbose(
             "Ignoring advertising report when scan response is expected or current data is marked "
             "incomplete");
@@ -91,8 +118,10 @@ LeScanningReassembler::ProcessAdvertisingReport(uint16_t event_type, uint8_t add
 
   // Otherwise the full advertising report has been reassembled,
   // removed the cache entry and return the complete advertising data.
-  CompleteAdvertisingData result{.extended_event_type = advertising_fragment->extended_event_type,
-                                 .data = std::move(advertising_fragment->data)};
+  complete_data_.swap(advertising_fragment->data);
+  CompleteAdvertisingDataView result{
+          .extended_event_type = advertising_fragment->extended_event_type,
+          .data = complete_data_};
   cache_.erase(advertising_fragment);
   log::verbose("Full advertising report has been reassembled");
   return result;
@@ -118,27 +147,120 @@ std::optional<std::vector<uint8_t>> LeScanningReassembler::ProcessPeriodicAdvert
   return result;
 }
 
+void LeScanningReassembler::SetDuplicateFilter(
+        std::optional<DuplicateFilterParameters> parameters) {
+  duplicate_filter_parameters_ = parameters;
+  reported_advertisements_.clear();
+  if (parameters.has_value()) {
+    reported_advertisements_.resize(kDuplicateFilterSize, ReportedAdvertisement{});
+  }
+}
+
+bool LeScanningReassembler::IsDuplicate(uint8_t address_type, Address address,
+                                        uint8_t advertising_sid, int8_t rssi,
+                                        uint16_t extended_event_type,
+                                        std::span<const uint8_t> advertising_data,
+                                        std::chrono::steady_clock::time_point now) {
+  if (!duplicate_filter_parameters_.has_value() ||
+      address_type == (uint8_t)DirectAdvertisingAddressType::NO_ADDRESS_PROVIDED) {
+    return false;
+  }
+
+  // The top bit marks the entry as used, so that no key is zero.
+  uint64_t key = (uint64_t{1} << 63) | (uint64_t{address_type} << 56) |
+                 (uint64_t{advertising_sid} << 48);
+  for (size_t i = 0; i < Address::kLength; i++) {
+    key |= uint64_t{address.address[i]} << (8 * i);
+  }
+
+  // The event type changes e.g. when the scan response is missing from the
+  // report, and is included in the hash of the payload.
+  std::string_view payload(reinterpret_cast<const char*>(advertising_data.data()),
+                           advertising_data.size());
+  uint64_t payload_hash = std::hash<std::string_view>{}(payload) ^ extended_event_type;
+
+  // Fibonacci hashing of the key, spreading the addresses that only differ
+  // in their last bytes.
+  constexpr size_t kMask = kDuplicateFilterSize - 1;
+  size_t first = (key * 0x9e3779b97f4a7c15) >> (64 - kDuplicateFilterBits);
+  ReportedAdvertisement* entry = nullptr;
+  ReportedAdvertisement* oldest = nullptr;
+  for (size_t probe = 0; probe < kDuplicateFilterProbes; probe++) {
+    ReportedAdvertisement& candidate = reported_advertisements_[(first + probe) & kMask];
+    if (candidate.key == key || candidate.key == 0) {
+      entry = &candidate;
+      break;
+    }
+    if (oldest == nullptr || candidate.reported_at < oldest->reported_at) {
+      oldest = &candidate;
+    }
+  }
+
+  if (entry == nullptr) {
+    entry = oldest;
+  } else if (entry->key == key && entry->payload_hash == payload_hash &&
+             std::abs(rssi - entry->rssi) < duplicate_filter_parameters_->rssi_delta &&
+             now - entry->reported_at < duplicate_filter_parameters_->heartbeat_interval) {
+    return true;
+  }
+
+  *entry = ReportedAdvertisement{
+          .key = key, .payload_hash = payload_hash, .reported_at = now, .rssi = rssi};
+  return false;
+}
+
 /// Trim the advertising data by removing empty or overflowing
 /// GAP Data entries.
 std::vector<uint8_t> LeScanningReassembler::TrimAdvertisingData(
         const std::vector<uint8_t>& advertising_data) {
+  std::vector<uint8_t> buffer;
+  std::span<const uint8_t> significant_advertising_data =
+          TrimAdvertisingData(advertising_data, buffer);
+  return std::vector<uint8_t>(significant_advertising_data.begin(),
+                              significant_advertising_data.end());
+}
+
+std::span<const uint8_t> LeScanningReassembler::TrimAdvertisingData(
+        std::span<const uint8_t> advertising_data, std::vector<uint8_t>& buffer) {
   // Remove empty and overflowing entries from the advertising data.
-  std::vector<uint8_t> significant_advertising_data;
+  // The significant entries are not copied as long as they are not preceded
+  // by a removed entry.
+  size_t prefix_size = 0;
+  bool copied = false;
   for (size_t offset = 0; offset < advertising_data.size();) {
     size_t remaining_size = advertising_data.size() - offset;
     uint8_t entry_size = advertising_data[offset];
 
     if (entry_size != 0 && entry_size < remaining_size) {
-      significant_advertising_data.push_back(entry_size);
-      significant_advertising_data.insert(significant_advertising_data.end(),
-                                          advertising_data.begin() + offset + 1,
-                                          advertising_data.begin() + offset + 1 + entry_size);
+      if (!copied && offset == prefix_size) {
+        prefix_size += entry_size + 1;
+      } else {
+        if (!copied) {
+          buffer.assign(advertising_data.begin(), advertising_data.begin() + prefix_size);
+          copied = true;
+        }
+        buffer.insert(buffer.end(), advertising_data.begin() + offset,
+                      advertising_data.begin() + offset + 1 + entry_size);
+      }
     }
 
     offset += entry_size + 1;
   }
 
-  return significant_advertising_data;
+  if (copied) {
+    return buffer;
+  }
+  return advertising_data.first(prefix_size);
+}
+
+void LeScanningReassembler::TrimFragment(AdvertisingFragment& fragment) {
+  std::span<const uint8_t> significant_advertising_data =
+          TrimAdvertisingData(fragment.data, trim_buffer_);
+  if (significant_advertising_data.data() == fragment.data.data()) {
+    fragment.data.resize(significant_advertising_data.size());
+  } else {
+    fragment.data.swap(trim_buffer_);
+  }
 }
 
 LeScanningReassembler::AdvertisingKey::AdvertisingKey(Address address,
@@ -165,7 +287,7 @@ bool LeScanningReassembler::AdvertisingKey::operator==(const AdvertisingKey& oth
 /// dropping the oldest advertiser.
 std::list<LeScanningReassembler::AdvertisingFragment>::iterator
 LeScanningReassembler::AppendFragment(const AdvertisingKey& key, uint16_t extended_event_type,
-                                      const std::vector<uint8_t>& data) {
+                                      std::span<const uint8_t> data) {
   auto it = FindFragment(key);
   if (it != cache_.end()) {
     // Legacy scan responses don't contain a 'connectable' bit, so this adds the
@@ -177,7 +299,7 @@ LeScanningReassembler::AppendFragment(const AdvertisingKey& key, uint16_t extend
     } else {
       it->extended_event_type = extended_event_type;
     }
-    it->data.insert(it->data.end(), data.cbegin(), data.cend());
+    it->data.insert(it->data.end(), data.begin(), data.end());
     return it;
   }
 
@@ -17,9 +17,11 @@
 
 #include <gtest/gtest_prod.h>
 
+#include <chrono>
 #include <cstdint>
 #include <list>
 #include <optional>
+#include <span>
 #include <vector>
 
 #include "hci/address_with_type.h"
@@ -40,6 +42,24 @@ public:
     std::vector<uint8_t> data;
   };
 
+  /// Completed advertising data, referencing either the advertising data
+  /// of the last report or a buffer of the reassembler. The data is valid
+  /// until the next report is processed.
+  struct CompleteAdvertisingDataView {
+    uint16_t extended_event_type;
+    std::span<const uint8_t> data;
+  };
+
+  /// Parameters of the duplicate filter.
+  struct DuplicateFilterParameters {
+    /// Minimum change of RSSI, in dB, for which an otherwise unchanged
+    /// advertisement is reported again.
+    uint8_t rssi_delta;
+    /// Interval at which an unchanged advertisement is reported again,
+    /// so that the presence of the advertiser can still be tracked.
+    std::chrono::milliseconds heartbeat_interval;
+  };
+
   LeScanningReassembler() {}
 
   LeScanningReassembler(const LeScanningReassembler&) = delete;
@@ -55,6 +75,14 @@ public:
           uint16_t event_type, uint8_t address_type, Address address, uint8_t advertising_sid,
           const std::vector<uint8_t>& advertising_data);
 
+  /// Same as ProcessAdvertisingReport, without copying the advertising
+  /// data of the reports that are complete: the advertising data is copied
+  /// only when the report is a fragment or must be joined with a scan
+  /// response.
+  std::optional<CompleteAdvertisingDataView> ProcessAdvertisingReportView(
+          uint16_t event_type, uint8_t address_type, Address address, uint8_t advertising_sid,
+          std::span<const uint8_t> advertising_data);
+
   /// Process an incoming periodic advertising report, extracted from the
   /// HCI LE Periodic Advertising Report events.
   /// Returns the completed advertising data if the event was complete,
@@ -68,6 +96,20 @@ public:
     ignore_scan_responses_ = ignore_scan_responses;
   }
 
+  /// Configure the duplicate filter, and forget the advertisements
+  /// already reported. The filter is disabled if |parameters| is empty.
+  void SetDuplicateFilter(std::optional<DuplicateFilterParameters> parameters);
+
+  /// Process a complete advertising report, returned by
+  /// ProcessAdvertisingReportView. Returns true if the report repeats the
+  /// advertisement last reported for the same advertising set and should be
+  /// dropped, i.e. when the event type and advertising data are unchanged,
+  /// the RSSI did not change significantly and the heartbeat interval has
+  /// not expired. Anonymous advertisements are never considered duplicates.
+  bool IsDuplicate(uint8_t address_type, Address address, uint8_t advertising_sid, int8_t rssi,
+                   uint16_t extended_event_type, std::span<const uint8_t> advertising_data,
+                   std::chrono::steady_clock::time_point now);
+
 private:
   /// Determine if scan responses should be processed or ignored.
   bool ignore_scan_responses_{false};
@@ -105,7 +147,7 @@ private:
     std::vector<uint8_t> data;
 
     AdvertisingFragment(const AdvertisingKey& key, uint16_t extended_event_type,
-                        const std::vector<uint8_t>& data)
+                        std::span<const uint8_t> data)
         : key(key), extended_event_type(extended_event_type), data(data.begin(), data.end()) {}
   };
 
@@ -126,10 +168,16 @@ private:
   static constexpr size_t kMaximumCacheSize = 16;
   std::list<AdvertisingFragment> cache_;
 
+  /// Buffers of the completed advertising data returned by
+  /// ProcessAdvertisingReportView and of the trimmed fragments, reused
+  /// between reports.
+  std::vector<uint8_t> complete_data_;
+  std::vector<uint8_t> trim_buffer_;
+
   /// Advertising cache management methods.
   std::list<AdvertisingFragment>::iterator AppendFragment(const AdvertisingKey& key,
                                                           uint16_t extended_event_type,
-                                                          const std::vector<uint8_t>& data);
+                                                          std::span<const uint8_t> data);
 
   void RemoveFragment(const AdvertisingKey& key);
 
@@ -146,11 +194,42 @@ private:
 
   std::list<PeriodicAdvertisingFragment>::iterator FindPeriodicFragment(uint16_t sync_handle);
 
+  /// Last advertisement reported for an advertising set, identified by
+  /// the address, address type and SID packed in |key|.
+  /// |key| is zero for unused entries.
+  struct ReportedAdvertisement {
+    uint64_t key;
+    uint64_t payload_hash;
+    std::chrono::steady_clock::time_point reported_at;
+    int8_t rssi;
+  };
+
+  /// Open addressing table of the reported advertisements, with linear
+  /// probing over at most kDuplicateFilterProbes entries. When all the
+  /// probed entries are in use, the least recently reported one is
+  /// replaced: the table stays bounded, at the cost of reporting again
+  /// some advertisements when more advertising sets are in range.
+  static constexpr size_t kDuplicateFilterBits = 11;
+  static constexpr size_t kDuplicateFilterSize = size_t{1} << kDuplicateFilterBits;
+  static constexpr size_t kDuplicateFilterProbes = 8;
+  std::optional<DuplicateFilterParameters> duplicate_filter_parameters_;
+  std::vector<ReportedAdvertisement> reported_advertisements_;
+
   /// Trim the advertising data by removing empty or overflowing
   /// GAP Data entries.
   static std::vector<uint8_t> TrimAdvertisingData(const std::vector<uint8_t>& advertising_data);
 
+  /// Same as TrimAdvertisingData, returning a prefix of |advertising_data|
+  /// when the significant entries are all at the start, which is the
+  /// common case, or the trimmed data copied to |buffer| otherwise.
+  static std::span<const uint8_t> TrimAdvertisingData(std::span<const uint8_t> advertising_data,
+                                                      std::vector<uint8_t>& buffer);
+
+  /// Trim the advertising data of a fragment in place.
+  void TrimFragment(AdvertisingFragment& fragment);
+
   FRIEND_TEST(LeScanningReassemblerTest, trim_advertising_data);
+  FRIEND_TEST(LeScanningReassemblerTest, duplicate_filter_is_bounded);
 };
 
 }  // namespace bluetooth::hci
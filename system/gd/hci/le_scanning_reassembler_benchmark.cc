@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/le_scanning_reassembler.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+constexpr uint16_t kLegacy = 0x10;
+constexpr uint8_t kSidNotPresent = 0xff;
+constexpr size_t kBeacons = 500;
+constexpr std::chrono::milliseconds kTraceDuration(10000);
+
+struct Report {
+  std::chrono::milliseconds time;
+  Address address;
+  int8_t rssi;
+  std::vector<uint8_t> data;
+};
+
+// Advertising reports received in a dense beacon deployment, ordered by
+// time: most beacons advertise a constant iBeacon payload, some interleave
+// Eddystone telemetry with a counter, and a few change their payload at
+// each advertising event. The RSSI of each beacon fluctuates around its
+// mean.
+const std::vector<Report>& Trace() {
+  static const std::vector<Report> trace = [] {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> interval_ms(100, 1000);
+    std::uniform_int_distribution<int> mean_rssi(-95, -45);
+    std::normal_distribution<double> fading(0.0, 2.0);
+    std::vector<Report> trace;
+    for (size_t beacon = 0; beacon < kBeacons; beacon++) {
+      uint8_t low = static_cast<uint8_t>(beacon);
+      uint8_t high = static_cast<uint8_t>(beacon >> 8);
+      Address address({0x0a, 0x0b, 0x0c, 0x0d, high, low});
+      int interval = interval_ms(generator);
+      int rssi = mean_rssi(generator);
+      uint32_t counter = 0;
+      for (int time = interval * beacon / kBeacons; time < kTraceDuration.count();
+           time += interval) {
+        std::vector<uint8_t> data;
+        if (beacon % 20 == 0) {
+          // Rotating payload
+          counter++;
+          data = {0x02, 0x01, 0x06, 0x07, 0xff, 0x4c, 0x00, 0x12, 0x02,
+                  static_cast<uint8_t>(counter), static_cast<uint8_t>(counter >> 8)};
+        } else if (beacon % 5 == 0 && (time / interval) % 10 == 0) {
+          // Eddystone TLM, advertising count updated every frame
+          counter++;
+          data = {0x02, 0x01, 0x06, 0x03, 0x03, 0xaa, 0xfe, 0x11, 0x16, 0xaa, 0xfe,
+                  0x20, 0x00, 0x0b, 0xb8, 0x17, 0x00, static_cast<uint8_t>(counter >> 24),
+                  static_cast<uint8_t>(counter >> 16), static_cast<uint8_t>(counter >> 8),
+                  static_cast<uint8_t>(counter), 0x00, 0x00, 0x00, 0x10};
+        } else {
+          // iBeacon
+          data = {0x02, 0x01, 0x06, 0x1a, 0xff, 0x4c, 0x00, 0x02, 0x15, 0xe2,
+                  0xc5, 0x6d, 0xb5, 0xdf, 0xfb, 0x48, 0xd2, 0xb0, 0x60, 0xd0,
+                  0xf5, 0xa7, 0x10, 0x96, 0xe0, high,  low,  0x00, 0x01, 0xc5};
+        }
+        trace.push_back(Report{
+                .time = std::chrono::milliseconds(time),
+                .address = address,
+                .rssi = static_cast<int8_t>(std::clamp(rssi + fading(generator), -127.0, 20.0)),
+                .data = std::move(data),
+        });
+      }
+    }
+    std::stable_sort(trace.begin(), trace.end(),
+                     [](const Report& a, const Report& b) { return a.time < b.time; });
+    return trace;
+  }();
+  return trace;
+}
+
+// Reassembly of the reports of the trace, followed by the duplicate filter
+// when a heartbeat interval is set. The trace is replayed in a loop, with
+// its time shifted by the duration of the trace.
+void BM_LeScanningReassembler(State& state) {
+  LeScanningReassembler reassembler;
+  reassembler.SetIgnoreScanResponses(true);
+  if (state.range(0) != 0) {
+    reassembler.SetDuplicateFilter(LeScanningReassembler::DuplicateFilterParameters{
+            .rssi_delta = 6, .heartbeat_interval = std::chrono::milliseconds(state.range(0))});
+  }
+  const auto& trace = Trace();
+  const std::chrono::steady_clock::time_point start;
+  size_t report = 0;
+  std::chrono::milliseconds offset(0);
+  int64_t delivered = 0;
+  for (auto _ : state) {
+    const Report& r = trace[report];
+    auto complete = reassembler.ProcessAdvertisingReportView(
+            kLegacy, (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS, r.address, kSidNotPresent,
+            r.data);
+    if (complete.has_value() &&
+        !reassembler.IsDuplicate((uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS, r.address,
+                                 kSidNotPresent, r.rssi, complete->extended_event_type,
+                                 complete->data, start + offset + r.time)) {
+      delivered++;
+    }
+    if (++report == trace.size()) {
+      report = 0;
+      offset += kTraceDuration;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["delivered_ratio"] = static_cast<double>(delivered) / state.iterations();
+}
+BENCHMARK(BM_LeScanningReassembler)
+        ->ArgName("heartbeat_ms")
+        ->Arg(0)
+        ->Arg(1000)
+        ->Arg(5000)
+        ->Arg(10000);
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
@@ -48,6 +48,13 @@ static const uint16_t kTestSyncHandle2 = 0x4243;
 
 class LeScanningReassemblerTest : public ::testing::Test {
 public:
+  bool IsDuplicate(uint8_t address_type, Address address, uint8_t advertising_sid, int8_t rssi,
+                   const LeScanningReassembler::CompleteAdvertisingData& report,
+                   std::chrono::steady_clock::time_point now) {
+    return reassembler_.IsDuplicate(address_type, address, advertising_sid, rssi,
+                                    report.extended_event_type, report.data, now);
+  }
+
   LeScanningReassembler reassembler_;
 };
 
@@ -341,4 +348,135 @@ TEST_F(LeScanningReassemblerTest, interleaved_periodic_advertising) {
             std::vector<uint8_t>({0x2, 0x1, 0x1}));
 }
 
+TEST_F(LeScanningReassemblerTest, complete_advertising_data_view) {
+  // Complete advertising data is returned without being copied, including
+  // when trailing entries are trimmed.
+  std::vector<uint8_t> advertising_data = {0x2, 0x1, 0x6, 0x0, 0x0};
+  auto processed_report = reassembler_.ProcessAdvertisingReportView(
+          kComplete, (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS, kTestAddress, kSidNotPresent,
+          advertising_data);
+  ASSERT_TRUE(processed_report.has_value());
+  ASSERT_EQ(processed_report->extended_event_type, kComplete);
+  ASSERT_EQ(processed_report->data.data(), advertising_data.data());
+  ASSERT_EQ(processed_report->data.size(), 3u);
+
+  // Empty entries followed by significant entries are removed.
+  advertising_data = {0x2, 0x1, 0x6, 0x0, 0x2, 0x3, 0x4};
+  processed_report = reassembler_.ProcessAdvertisingReportView(
+          kLegacy | kComplete, (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS, kTestAddress,
+          kSidNotPresent, advertising_data);
+  ASSERT_TRUE(processed_report.has_value());
+  ASSERT_EQ(std::vector<uint8_t>(processed_report->data.begin(), processed_report->data.end()),
+            std::vector<uint8_t>({0x2, 0x1, 0x6, 0x2, 0x3, 0x4}));
+
+  // Fragmented advertising data is reassembled.
+  ASSERT_FALSE(reassembler_
+                       .ProcessAdvertisingReportView(
+                               kContinuation, (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+                               kTestAddress, kSidNotPresent, advertising_data)
+                       .has_value());
+  advertising_data = {0x1, 0x5};
+  processed_report = reassembler_.ProcessAdvertisingReportView(
+          kComplete, (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS, kTestAddress, kSidNotPresent,
+          advertising_data);
+  ASSERT_TRUE(processed_report.has_value());
+  ASSERT_EQ(std::vector<uint8_t>(processed_report->data.begin(), processed_report->data.end()),
+            std::vector<uint8_t>({0x2, 0x1, 0x6, 0x2, 0x3, 0x4, 0x1, 0x5}));
+}
+
+TEST_F(LeScanningReassemblerTest, duplicate_filter_disabled) {
+  LeScanningReassembler::CompleteAdvertisingData report{.extended_event_type = kLegacy,
+                                                        .data = {0x2, 0x1, 0x6}};
+  auto now = std::chrono::steady_clock::time_point();
+  ASSERT_FALSE(IsDuplicate((uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS, kTestAddress,
+                           kSidNotPresent, -60, report, now));
+  ASSERT_FALSE(IsDuplicate((uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS, kTestAddress,
+                           kSidNotPresent, -60, report, now));
+}
+
+TEST_F(LeScanningReassemblerTest, duplicate_filter) {
+  reassembler_.SetDuplicateFilter(LeScanningReassembler::DuplicateFilterParameters{
+          .rssi_delta = 6, .heartbeat_interval = 1s});
+  LeScanningReassembler::CompleteAdvertisingData report{.extended_event_type = kLegacy,
+                                                        .data = {0x2, 0x1, 0x6}};
+  uint8_t address_type = (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS;
+  auto now = std::chrono::steady_clock::time_point();
+
+  // The first report of an advertising set is never a duplicate.
+  ASSERT_FALSE(IsDuplicate(address_type, kTestAddress, kSidNotPresent, -60, report, now));
+  ASSERT_TRUE(IsDuplicate(address_type, kTestAddress, kSidNotPresent, -60, report, now + 100ms));
+
+  // Small RSSI changes are ignored, significant changes are reported.
+  ASSERT_TRUE(IsDuplicate(address_type, kTestAddress, kSidNotPresent, -65, report, now + 200ms));
+  ASSERT_FALSE(IsDuplicate(address_type, kTestAddress, kSidNotPresent, -66, report, now + 300ms));
+
+  // Payload and event type changes are reported.
+  report.data = {0x2, 0x1, 0x4};
+  ASSERT_FALSE(IsDuplicate(address_type, kTestAddress, kSidNotPresent, -66, report, now + 400ms));
+  report.extended_event_type = kLegacy | kConnectable;
+  ASSERT_FALSE(IsDuplicate(address_type, kTestAddress, kSidNotPresent, -66, report, now + 500ms));
+  ASSERT_TRUE(IsDuplicate(address_type, kTestAddress, kSidNotPresent, -66, report, now + 1400ms));
+
+  // Unchanged advertisements are reported again after the heartbeat interval.
+  ASSERT_FALSE(IsDuplicate(address_type, kTestAddress, kSidNotPresent, -66, report, now + 1500ms));
+  ASSERT_TRUE(IsDuplicate(address_type, kTestAddress, kSidNotPresent, -66, report, now + 1600ms));
+}
+
+TEST_F(LeScanningReassemblerTest, duplicate_filter_advertising_sets) {
+  reassembler_.SetDuplicateFilter(LeScanningReassembler::DuplicateFilterParameters{
+          .rssi_delta = 6, .heartbeat_interval = 1s});
+  LeScanningReassembler::CompleteAdvertisingData report{.extended_event_type = 0,
+                                                        .data = {0x2, 0x1, 0x6}};
+  uint8_t address_type = (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS;
+  auto now = std::chrono::steady_clock::time_point();
+
+  // Advertising sets are disambiguated by address, address type, and SID.
+  ASSERT_FALSE(IsDuplicate(address_type, kTestAddress, 1, -60, report, now));
+  ASSERT_FALSE(IsDuplicate(address_type, kTestAddress, 2, -60, report, now));
+  ASSERT_FALSE(IsDuplicate((uint8_t)AddressType::RANDOM_DEVICE_ADDRESS, kTestAddress, 1, -60,
+                           report, now));
+  ASSERT_FALSE(IsDuplicate(address_type, Address({0, 1, 2, 3, 4, 6}), 1, -60, report, now));
+  ASSERT_TRUE(IsDuplicate(address_type, kTestAddress, 1, -60, report, now));
+  ASSERT_TRUE(IsDuplicate(address_type, kTestAddress, 2, -60, report, now));
+
+  // Anonymous advertisements cannot be told apart.
+  uint8_t anonymous = (uint8_t)DirectAdvertisingAddressType::NO_ADDRESS_PROVIDED;
+  ASSERT_FALSE(IsDuplicate(anonymous, Address::kEmpty, 1, -60, report, now));
+  ASSERT_FALSE(IsDuplicate(anonymous, Address::kEmpty, 1, -60, report, now));
+
+  // Configuring the filter forgets the reported advertisements.
+  reassembler_.SetDuplicateFilter(LeScanningReassembler::DuplicateFilterParameters{
+          .rssi_delta = 6, .heartbeat_interval = 1s});
+  ASSERT_FALSE(IsDuplicate(address_type, kTestAddress, 1, -60, report, now));
+}
+
+TEST_F(LeScanningReassemblerTest, duplicate_filter_is_bounded) {
+  reassembler_.SetDuplicateFilter(LeScanningReassembler::DuplicateFilterParameters{
+          .rssi_delta = 6, .heartbeat_interval = 1s});
+  LeScanningReassembler::CompleteAdvertisingData report{.extended_event_type = kLegacy,
+                                                        .data = {0x2, 0x1, 0x6}};
+  uint8_t address_type = (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS;
+  auto now = std::chrono::steady_clock::time_point();
+
+  // More advertisers than the table can hold: the advertisers are still
+  // reported, and the table stays at its initial size.
+  constexpr size_t kAdvertisers = 2 * LeScanningReassembler::kDuplicateFilterSize;
+  for (size_t i = 0; i < kAdvertisers; i++) {
+    Address address({0, 1, 2, 3, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)});
+    ASSERT_FALSE(IsDuplicate(address_type, address, kSidNotPresent, -60, report,
+                             now + std::chrono::milliseconds(i)));
+  }
+  ASSERT_EQ(reassembler_.reported_advertisements_.size(),
+            LeScanningReassembler::kDuplicateFilterSize);
+
+  // The most recently reported advertisers are still known.
+  size_t duplicates = 0;
+  for (size_t i = kAdvertisers - 64; i < kAdvertisers; i++) {
+    Address address({0, 1, 2, 3, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)});
+    duplicates += IsDuplicate(address_type, address, kSidNotPresent, -60, report,
+                              now + std::chrono::milliseconds(kAdvertisers));
+  }
+  ASSERT_EQ(duplicates, 64u);
+}
+
 }  // namespace bluetooth::hci
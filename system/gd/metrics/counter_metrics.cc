@@ -19,6 +19,8 @@
 
 #include <bluetooth/log.h>
 
+#include <string>
+
 #include "common/bind.h"
 #include "os/log.h"
 #include "os/metrics.h"
@@ -58,8 +60,28 @@ bool CounterMetrics::CacheCount(int32_t key, int64_t count) {
     log::warn("count is not larger than 0. count: {}, key: {}", count, key);
     return false;
   }
+  CachedCounter* counter = GetCachedCounter(key);
+  if (counter == nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return CacheCountLocked(key, count);
+  }
+  int64_t total = counter->count.load(std::memory_order_relaxed);
+  int64_t new_total;
+  do {
+    new_total = LLONG_MAX - total < count ? LLONG_MAX : total + count;
+  } while (!counter->count.compare_exchange_weak(total, new_total, std::memory_order_relaxed));
+  if (LLONG_MAX - total < count) {
+    log::warn("Counter metric overflows. count {} current total: {} key: {}", count, total, key);
+    return false;
+  }
+  return true;
+}
+
+bool CounterMetrics::CacheCountLocked(int32_t key, int64_t count) {
+  if (counters_.empty()) {
+    log::warn("Too many counter metric keys, caching key {} and the next ones under lock", key);
+  }
   int64_t total = 0;
-  std::lock_guard<std::mutex> lock(mutex_);
   if (counters_.find(key) != counters_.end()) {
     total = counters_[key];
   }
@@ -72,6 +94,34 @@ bool CounterMetrics::CacheCount(int32_t key, int64_t count) {
   return true;
 }
 
+CounterMetrics::CachedCounter* CounterMetrics::GetCachedCounter(int32_t key) {
+  CachedCounter* counter = find_cached_counter(key, false);
+  if (counter != nullptr) {
+    return counter;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return find_cached_counter(key, true);
+}
+
+CounterMetrics::CachedCounter* CounterMetrics::find_cached_counter(int32_t key, bool insert) {
+  size_t start = static_cast<uint32_t>(key) % kMaxCachedKeys;
+  for (size_t i = 0; i < kMaxCachedKeys; i++) {
+    CachedCounter& counter = cached_counters_[(start + i) % kMaxCachedKeys];
+    int64_t cached_key = counter.key.load(std::memory_order_acquire);
+    if (cached_key == kEmptyKey) {
+      if (!insert) {
+        return nullptr;
+      }
+      counter.key.store(key, std::memory_order_release);
+      return &counter;
+    }
+    if (cached_key == key) {
+      return &counter;
+    }
+  }
+  return nullptr;
+}
+
 bool CounterMetrics::Count(int32_t key, int64_t count) {
   if (!IsInitialized()) {
     log::warn("Counter metrics isn't initialized");
@@ -92,6 +142,16 @@ void CounterMetrics::DrainBufferedCounters() {
   }
   std::lock_guard<std::mutex> lock(mutex_);
   log::info("Draining buffered counters");
+  for (auto& counter : cached_counters_) {
+    int64_t key = counter.key.load(std::memory_order_relaxed);
+    if (key == kEmptyKey) {
+      continue;
+    }
+    int64_t count = counter.count.exchange(0, std::memory_order_relaxed);
+    if (count > 0) {
+      Count(static_cast<int32_t>(key), count);
+    }
+  }
   for (auto const& pair : counters_) {
     Count(pair.first, pair.second);
   }
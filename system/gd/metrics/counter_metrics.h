@@ -15,6 +15,10 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <climits>
+#include <mutex>
 #include <unordered_map>
 
 #include "module.h"
@@ -38,7 +42,24 @@ protected:
   virtual bool IsInitialized() { return initialized_; }
 
 private:
+  static constexpr size_t kMaxCachedKeys = 256;
+  static constexpr int64_t kEmptyKey = LLONG_MIN;
+
+  struct CachedCounter {
+    std::atomic<int64_t> key{kEmptyKey};
+    std::atomic<int64_t> count{0};
+  };
+
+  CachedCounter* GetCachedCounter(int32_t key);
+  CachedCounter* find_cached_counter(int32_t key, bool insert);
+  bool CacheCountLocked(int32_t key, int64_t count);
+
+  // Open addressed table of the first keys counted, updated without locking.
+  // Keys are never removed, only their counts are drained.
+  std::array<CachedCounter, kMaxCachedKeys> cached_counters_{};
+  // Keys that did not fit in |cached_counters_|.
   std::unordered_map<int32_t, int64_t> counters_;
+  // Guards insertions into |cached_counters_|, |counters_| and draining.
   mutable std::mutex mutex_;
   std::unique_ptr<os::RepeatingAlarm> alarm_;
   bool initialized_{false};
@@ -16,7 +16,9 @@
 
 #include "metrics/counter_metrics.h"
 
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -84,6 +86,48 @@ TEST_F(CounterMetricsTest, non_positive) {
   ASSERT_EQ(testable_counter_metrics_.test_counters_[1], 5);
 }
 
+TEST_F(CounterMetricsTest, cache_from_threads) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([this] {
+      for (int j = 0; j < 1000; j++) {
+        ASSERT_TRUE(testable_counter_metrics_.CacheCount(1, 1));
+        ASSERT_TRUE(testable_counter_metrics_.CacheCount(2 + j % 2, 2));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  testable_counter_metrics_.DrainBuffer();
+  ASSERT_EQ(testable_counter_metrics_.test_counters_[1], 4000);
+  ASSERT_EQ(testable_counter_metrics_.test_counters_[2], 4000);
+  ASSERT_EQ(testable_counter_metrics_.test_counters_[3], 4000);
+}
+
+TEST_F(CounterMetricsTest, more_keys_than_the_lock_free_table) {
+  constexpr int32_t kKeys = 1000;
+  for (int32_t key = 0; key < kKeys; key++) {
+    ASSERT_TRUE(testable_counter_metrics_.CacheCount(key, key + 1));
+    ASSERT_TRUE(testable_counter_metrics_.CacheCount(key, 1));
+  }
+  testable_counter_metrics_.DrainBuffer();
+  ASSERT_EQ(testable_counter_metrics_.test_counters_.size(), static_cast<size_t>(kKeys));
+  for (int32_t key = 0; key < kKeys; key++) {
+    ASSERT_EQ(testable_counter_metrics_.test_counters_[key], key + 2);
+  }
+}
+
+TEST_F(CounterMetricsTest, instances_do_not_share_counts) {
+  TestableCounterMetrics other_counter_metrics;
+  ASSERT_TRUE(testable_counter_metrics_.CacheCount(1, 2));
+  ASSERT_TRUE(other_counter_metrics.CacheCount(1, 3));
+  testable_counter_metrics_.DrainBuffer();
+  other_counter_metrics.DrainBuffer();
+  ASSERT_EQ(testable_counter_metrics_.test_counters_[1], 2);
+  ASSERT_EQ(other_counter_metrics.test_counters_[1], 3);
+}
+
 }  // namespace
 }  // namespace metrics
 }  // namespace bluetooth
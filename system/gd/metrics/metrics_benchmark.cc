@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "benchmark/benchmark.h"
+#include "metrics/counter_metrics.h"
+#include "osi/include/metrics_registry.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace metrics {
+namespace {
+
+// What the counters on the packet paths used to do: a map behind a mutex.
+std::mutex locked_counters_mutex;
+std::unordered_map<int32_t, int64_t> locked_counters;
+
+void BM_LockedCounter(State& state) {
+  for (auto _ : state) {
+    std::lock_guard<std::mutex> lock(locked_counters_mutex);
+    locked_counters[1]++;
+  }
+}
+BENCHMARK(BM_LockedCounter)->ThreadRange(1, 8);
+
+const metrics_registry::Counter kBenchmarkCounter("metrics_benchmark.counter");
+
+void BM_RegistryCounter(State& state) {
+  for (auto _ : state) {
+    kBenchmarkCounter.Increment();
+  }
+  if (state.thread_index() == 0) {
+    benchmark::DoNotOptimize(kBenchmarkCounter.Drain());
+  }
+}
+BENCHMARK(BM_RegistryCounter)->ThreadRange(1, 8);
+
+const metrics_registry::Histogram kBenchmarkHistogram("metrics_benchmark.histogram",
+                                                      {16, 64, 256, 1024});
+
+void BM_RegistryHistogram(State& state) {
+  int64_t value = 0;
+  for (auto _ : state) {
+    kBenchmarkHistogram.Record(value);
+    value = (value + 97) % 2048;
+  }
+}
+BENCHMARK(BM_RegistryHistogram)->ThreadRange(1, 8);
+
+class BenchmarkCounterMetrics : public CounterMetrics {
+public:
+  void DrainBuffer() { DrainBufferedCounters(); }
+
+private:
+  bool Count(int32_t /* key */, int64_t /* count */) override { return true; }
+  bool IsInitialized() override { return true; }
+};
+
+BenchmarkCounterMetrics counter_metrics;
+
+void BM_CounterMetricsCacheCount(State& state) {
+  int32_t key = state.thread_index();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(counter_metrics.CacheCount(key, 1));
+  }
+  if (state.thread_index() == 0) {
+    counter_metrics.DrainBuffer();
+  }
+}
+BENCHMARK(BM_CounterMetricsCacheCount)->ThreadRange(1, 8);
+
+}  // namespace
+}  // namespace metrics
+}  // namespace bluetooth
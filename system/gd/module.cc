@@ -91,10 +91,14 @@ Module* ModuleRegistry::Start(const ModuleFactory* module, Thread* thread) {
   log::info("Finished starting dependencies and calling Start() of {}", instance->ToString());
 
   last_instance_ = "starting " + instance->ToString();
+  auto start_time = std::chrono::steady_clock::now();
   instance->Start();
+  auto start_duration = std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start_time);
   start_order_.push_back(module);
   started_modules_[module] = instance;
-  log::info("Started {}", instance->ToString());
+  start_durations_[module] = start_duration;
+  log::info("Started {} in {}us", instance->ToString(), start_duration.count());
   return instance;
 }
 
@@ -125,6 +129,7 @@ void ModuleRegistry::StopAll() {
 
   log::assert_that(started_modules_.empty(), "assert failed: started_modules_.empty()");
   start_order_.clear();
+  start_durations_.clear();
 }
 
 os::Handler* ModuleRegistry::GetModuleHandler(const ModuleFactory* module) const {
@@ -167,6 +167,8 @@ protected:
 
   std::map<const ModuleFactory*, Module*> started_modules_;
   std::vector<const ModuleFactory*> start_order_;
+  // Time spent in each module's Start(), not counting its dependencies
+  std::map<const ModuleFactory*, std::chrono::microseconds> start_durations_;
   std::string last_instance_;
 };
 
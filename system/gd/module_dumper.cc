@@ -18,6 +18,7 @@
 #include "module_dumper.h"
 
 #include <sstream>
+#include <vector>
 
 #include "dumpsys_data_generated.h"
 #include "module.h"
@@ -35,6 +36,23 @@ void ModuleDumper::DumpState(std::string* output, std::ostringstream& /*oss*/) c
 
   auto wakelock_offset = WakelockManager::Get().GetDumpsysData(&builder);
 
+  // Modules injected by tests are started outside of the registry and have no
+  // recorded start time.
+  std::vector<flatbuffers::Offset<ModuleStartData>> module_start_data;
+  for (auto module : module_registry_.start_order_) {
+    auto duration = module_registry_.start_durations_.find(module);
+    if (duration == module_registry_.start_durations_.end()) {
+      continue;
+    }
+    auto instance = module_registry_.started_modules_.find(module);
+    log::assert_that(instance != module_registry_.started_modules_.end(),
+                     "assert failed: instance != module_registry_.started_modules_.end()");
+    module_start_data.push_back(CreateModuleStartData(
+            builder, builder.CreateString(instance->second->ToString()),
+            duration->second.count()));
+  }
+  auto module_start_offset = builder.CreateVector(module_start_data);
+
   std::queue<DumpsysDataFinisher> queue;
   for (auto it = module_registry_.start_order_.rbegin(); it != module_registry_.start_order_.rend();
        it++) {
@@ -49,6 +67,7 @@ void ModuleDumper::DumpState(std::string* output, std::ostringstream& /*oss*/) c
   DumpsysDataBuilder data_builder(builder);
   data_builder.add_title(title);
   data_builder.add_wakelock_manager_data(wakelock_offset);
+  data_builder.add_module_start_data(module_start_offset);
 
   while (!queue.empty()) {
     queue.front()(&data_builder);
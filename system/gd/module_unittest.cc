@@ -303,5 +303,25 @@ TEST_F(ModuleTest, dump_state) {
   registry_->StopAll();
 }
 
+TEST_F(ModuleTest, dump_module_start_times) {
+  ModuleList list;
+  list.add<TestModuleDumpState>();
+  registry_->Start(&list, thread_);
+
+  ModuleDumper dumper(STDOUT_FILENO, *registry_, "Test Dump Title");
+
+  std::string output;
+  std::ostringstream oss;
+  dumper.DumpState(&output, oss);
+
+  auto data = flatbuffers::GetRoot<DumpsysData>(output.data());
+  auto module_start_data = data->module_start_data();
+  ASSERT_NE(nullptr, module_start_data);
+  ASSERT_EQ(1u, module_start_data->size());
+  EXPECT_STREQ("TestModuleDumpState", module_start_data->Get(0)->name()->c_str());
+
+  registry_->StopAll();
+}
+
 }  // namespace
 }  // namespace bluetooth
@@ -23,14 +23,15 @@
 #include "common/callback.h"
 #include "os/handler.h"
 #include "os/thread.h"
+#include "os/timer_service.h"
 #include "os/utils.h"
 
 namespace bluetooth {
 namespace os {
 
-// A single-shot alarm for reactor-based thread, implemented by Linux timerfd.
-// When it's constructed, it will register a reactable on the specified thread; when it's destroyed,
-// it will unregister itself from the thread.
+// A single-shot alarm for reactor-based thread. All the alarms of a thread share the timerfd of the
+// thread's TimerService. When it's constructed, it will add a timer to the thread's service; when
+// it's destroyed, it will remove itself from the service.
 class Alarm {
 public:
   // Create and register a single-shot alarm on a given handler. This creates a wake alarm.
@@ -49,14 +50,19 @@ public:
   // Schedule the alarm with given delay
   void Schedule(common::OnceClosure task, std::chrono::milliseconds delay);
 
+  // Schedule the alarm with given delay, allowing it to fire up to |slack| late so that its wake-up
+  // can be batched with the ones of other alarms on the same thread.
+  void Schedule(common::OnceClosure task, std::chrono::milliseconds delay,
+                std::chrono::milliseconds slack);
+
   // Cancel the alarm. No-op if it's not armed.
   void Cancel();
 
 private:
   common::OnceClosure task_;
   Handler* handler_;
-  int fd_ = 0;
-  Reactor::Reactable* token_;
+  TimerService* service_;
+  TimerService::Timer timer_;
   mutable std::mutex mutex_;
   void on_fire();
 };
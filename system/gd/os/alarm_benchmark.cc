@@ -17,15 +17,18 @@
 #include <chrono>
 #include <future>
 #include <unordered_map>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "common/bind.h"
 #include "os/alarm.h"
 #include "os/repeating_alarm.h"
 #include "os/thread.h"
+#include "os/timer_service.h"
 
 using ::benchmark::State;
 using ::bluetooth::common::Bind;
+using ::bluetooth::common::BindOnce;
 using ::bluetooth::os::Alarm;
 using ::bluetooth::os::Handler;
 using ::bluetooth::os::RepeatingAlarm;
@@ -39,6 +42,7 @@ protected:
     handler_ = std::make_unique<Handler>(thread_.get());
     alarm_ = std::make_unique<Alarm>(handler_.get());
     repeating_alarm_ = std::make_unique<RepeatingAlarm>(handler_.get());
+    alarms_.clear();
     map_.clear();
     scheduled_tasks_ = 0;
     task_length_ = 0;
@@ -50,6 +54,7 @@ protected:
   void TearDown(State& st) override {
     alarm_ = nullptr;
     repeating_alarm_ = nullptr;
+    alarms_.clear();
     handler_ = nullptr;
     thread_->Stop();
     thread_ = nullptr;
@@ -70,6 +75,13 @@ protected:
 
   void TimerFire() { promise_.set_value(); }
 
+  void CountFired() {
+    task_counter_++;
+    if (task_counter_ >= scheduled_tasks_) {
+      promise_.set_value();
+    }
+  }
+
   int64_t scheduled_tasks_;
   int64_t task_length_;
   int64_t task_interval_;
@@ -81,6 +93,7 @@ protected:
   std::unique_ptr<Handler> handler_;
   std::unique_ptr<Alarm> alarm_;
   std::unique_ptr<RepeatingAlarm> repeating_alarm_;
+  std::vector<std::unique_ptr<Alarm>> alarms_;
 };
 
 BENCHMARK_DEFINE_F(BM_ReactableAlarm, timer_performance_ms)(State& state) {
@@ -139,3 +152,47 @@ BENCHMARK_REGISTER_F(BM_ReactableAlarm, periodic_accuracy)
         ->Args({2000, 15, 20})
         ->Iterations(1)
         ->UseRealTime();
+
+// Cost of arming and cancelling alarms while many others are pending on the same thread.
+BENCHMARK_DEFINE_F(BM_ReactableAlarm, schedule_cancel)(State& state) {
+  for (int64_t i = 0; i < state.range(0); i++) {
+    alarms_.push_back(std::make_unique<Alarm>(handler_.get()));
+    alarms_.back()->Schedule(BindOnce([] {}), std::chrono::seconds(100 + i));
+  }
+  for (auto _ : state) {
+    alarm_->Schedule(BindOnce([] {}), std::chrono::seconds(50));
+    alarm_->Cancel();
+  }
+}
+
+BENCHMARK_REGISTER_F(BM_ReactableAlarm, schedule_cancel)->Arg(0)->Arg(16)->Arg(256)->Arg(4096);
+
+// Args: number of alarms, 1 ms apart; slack per alarm in ms. Reports how many times the thread was
+// woken up to fire them all.
+BENCHMARK_DEFINE_F(BM_ReactableAlarm, coalesced_wakeups)(State& state) {
+  scheduled_tasks_ = state.range(0);
+  auto slack = std::chrono::milliseconds(state.range(1));
+  for (int64_t i = 0; i < scheduled_tasks_; i++) {
+    alarms_.push_back(std::make_unique<Alarm>(handler_.get()));
+  }
+  auto* service = thread_->GetTimerService(true);
+  uint64_t wakeups = 0;
+  for (auto _ : state) {
+    task_counter_ = 0;
+    promise_ = std::promise<void>();
+    auto wakeups_before = service->GetWakeupCount();
+    for (int64_t i = 0; i < scheduled_tasks_; i++) {
+      alarms_[i]->Schedule(BindOnce(&BM_ReactableAlarm_coalesced_wakeups_Benchmark::CountFired,
+                                    bluetooth::common::Unretained(this)),
+                           std::chrono::milliseconds(i + 1), slack);
+    }
+    promise_.get_future().get();
+    wakeups += service->GetWakeupCount() - wakeups_before;
+  }
+  state.counters["wakeups"] = ::benchmark::Counter(wakeups, ::benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_REGISTER_F(BM_ReactableAlarm, coalesced_wakeups)
+        ->ArgsProduct({{16, 64}, {0, 4, 16}})
+        ->Iterations(5)
+        ->UseRealTime();
@@ -20,6 +20,7 @@
 
 #include "common/bind.h"
 #include "common/callback.h"
+#include "common/task_profiler.h"
 #include "os/log.h"
 #include "os/reactor.h"
 
@@ -42,7 +43,11 @@ Handler::~Handler() {
   event_->Close();
 }
 
-void Handler::Post(OnceClosure closure) {
+void Handler::PostTask(OnceClosure closure, const std::source_location& from_here) {
+  if (common::TaskProfiler::IsEnabled()) {
+    closure = common::TaskProfiler::Wrap(common::TaskProfiler::OnPosted(from_here),
+                                         std::move(closure));
+  }
   {
     std::lock_guard<std::mutex> lock(mutex_);
     if (was_cleared()) {
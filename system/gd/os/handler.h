@@ -19,6 +19,7 @@
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <source_location>
 
 #include "common/bind.h"
 #include "common/callback.h"
@@ -43,9 +44,6 @@ public:
   // discarded and not executed.
   virtual ~Handler();
 
-  // Enqueue a closure to the queue of this handler
-  virtual void Post(common::OnceClosure closure) override;
-
   // Remove all pending events from the queue of this handler
   void Clear();
 
@@ -70,6 +68,10 @@ public:
 
   friend class RepeatingAlarm;
 
+protected:
+  // Enqueue a closure to the queue of this handler
+  void PostTask(common::OnceClosure closure, const std::source_location& from_here) override;
+
 private:
   inline bool was_cleared() const { return tasks_ == nullptr; }
   std::queue<common::OnceClosure>* tasks_;
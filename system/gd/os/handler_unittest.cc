@@ -17,10 +17,12 @@
 #include "os/handler.h"
 
 #include <future>
+#include <string>
 #include <thread>
 
 #include "common/bind.h"
 #include "common/callback.h"
+#include "common/task_profiler.h"
 #include "gtest/gtest.h"
 #include "os/log.h"
 
@@ -110,6 +112,27 @@ TEST_F(HandlerTest, callback_with_promise) {
   handler_->Clear();
 }
 
+TEST_F(HandlerTest, profiled_task_is_accounted_to_the_caller) {
+  common::TaskProfiler::SetEnabled(true);
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  common::IPostableContext* context = handler_;
+  int line = __LINE__ + 1;
+  context->Post(common::BindOnce(&std::promise<void>::set_value, common::Unretained(&promise)));
+  future.wait();
+  common::TaskProfiler::SetEnabled(false);
+  handler_->Clear();
+
+  std::string site_suffix = std::string(__FILE__) + ":" + std::to_string(line);
+  bool found = false;
+  for (const auto& summary : common::TaskProfiler::GetSummaries()) {
+    if (summary.site_name.ends_with(site_suffix)) {
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
 // For Death tests, all the threading needs to be done in the ASSERT_DEATH call
 class HandlerDeathTest : public ::testing::Test {
 protected:
@@ -17,69 +17,45 @@
 #include "os/repeating_alarm.h"
 
 #include <bluetooth/log.h>
-#include <sys/timerfd.h>
-#include <unistd.h>
-
-#include <cstring>
 
 #include "common/bind.h"
-#include "os/linux_generic/linux.h"
 #include "os/log.h"
-#include "os/utils.h"
-
-#ifdef __ANDROID__
-#define ALARM_CLOCK CLOCK_BOOTTIME_ALARM
-#else
-#define ALARM_CLOCK CLOCK_BOOTTIME
-#endif
 
 namespace bluetooth {
 namespace os {
 using common::Closure;
 
 RepeatingAlarm::RepeatingAlarm(Handler* handler)
-    : handler_(handler), fd_(TIMERFD_CREATE(ALARM_CLOCK, 0)) {
-  log::assert_that(fd_ != -1, "assert failed: fd_ != -1");
-
-  token_ = handler_->thread_->GetReactor()->Register(
-          fd_, common::Bind(&RepeatingAlarm::on_fire, common::Unretained(this)), common::Closure());
-}
+    : handler_(handler),
+      service_(handler_->thread_->GetTimerService(true)),
+      timer_(common::Bind(&RepeatingAlarm::on_fire, common::Unretained(this))) {}
 
-RepeatingAlarm::~RepeatingAlarm() {
-  handler_->thread_->GetReactor()->Unregister(token_);
+RepeatingAlarm::~RepeatingAlarm() { service_->Remove(&timer_); }
 
-  int close_status;
-  RUN_NO_INTR(close_status = TIMERFD_CLOSE(fd_));
-  log::assert_that(close_status != -1, "assert failed: close_status != -1");
+void RepeatingAlarm::Schedule(Closure task, std::chrono::milliseconds period) {
+  Schedule(std::move(task), period, std::chrono::milliseconds(0));
 }
 
-void RepeatingAlarm::Schedule(Closure task, std::chrono::milliseconds period) {
+void RepeatingAlarm::Schedule(Closure task, std::chrono::milliseconds period,
+                              std::chrono::milliseconds slack) {
   std::lock_guard<std::mutex> lock(mutex_);
-  long period_ms = period.count();
-  itimerspec timer_itimerspec{{period_ms / 1000, period_ms % 1000 * 1000000},
-                              {period_ms / 1000, period_ms % 1000 * 1000000}};
-  int result = TIMERFD_SETTIME(fd_, 0, &timer_itimerspec, nullptr);
-  log::assert_that(result == 0, "assert failed: result == 0");
-
+  service_->Arm(&timer_, period, slack, period);
   task_ = std::move(task);
 }
 
 void RepeatingAlarm::Cancel() {
   std::lock_guard<std::mutex> lock(mutex_);
-  itimerspec disarm_itimerspec{/* disarm timer */};
-  int result = TIMERFD_SETTIME(fd_, 0, &disarm_itimerspec, nullptr);
-  log::assert_that(result == 0, "assert failed: result == 0");
+  service_->Disarm(&timer_);
 }
 
 void RepeatingAlarm::on_fire() {
   std::unique_lock<std::mutex> lock(mutex_);
+  if (!service_->ClaimExpiry(&timer_)) {
+    return;
+  }
   auto task = task_;
-  uint64_t times_invoked;
-  auto bytes_read = read(fd_, &times_invoked, sizeof(uint64_t));
   lock.unlock();
   task.Run();
-  log::assert_that(bytes_read == static_cast<ssize_t>(sizeof(uint64_t)),
-                   "assert failed: bytes_read == static_cast<ssize_t>(sizeof(uint64_t))");
 }
 
 }  // namespace os
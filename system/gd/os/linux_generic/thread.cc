@@ -25,6 +25,7 @@
 #include <cstring>
 
 #include "os/log.h"
+#include "os/timer_service.h"
 
 namespace bluetooth {
 namespace os {
@@ -68,6 +69,15 @@ bool Thread::IsSameThread() const { return std::this_thread::get_id() == running
 
 Reactor* Thread::GetReactor() const { return &reactor_; }
 
+TimerService* Thread::GetTimerService(bool is_wake) const {
+  std::lock_guard<std::mutex> lock(timer_service_mutex_);
+  auto& service = is_wake ? wake_timer_service_ : non_wake_timer_service_;
+  if (service == nullptr) {
+    service = std::make_unique<TimerService>(&reactor_, is_wake);
+  }
+  return service.get();
+}
+
 std::string Thread::GetThreadName() const { return name_; }
 
 std::string Thread::ToString() const { return "Thread " + name_; }
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/timer_service.h"
+
+#include <bluetooth/log.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/bind.h"
+#include "os/linux_generic/linux.h"
+#include "os/log.h"
+#include "os/utils.h"
+
+#ifdef __ANDROID__
+#define ALARM_CLOCK CLOCK_BOOTTIME_ALARM
+#else
+#define ALARM_CLOCK CLOCK_BOOTTIME
+#endif
+
+namespace bluetooth {
+namespace os {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TimerService::TimerService(Reactor* reactor, bool is_wake) : reactor_(reactor) {
+  // Non blocking, since the timerfd may be re-armed by another thread after it became readable but
+  // before on_fire() reads it.
+  fd_ = TIMERFD_CREATE(is_wake ? ALARM_CLOCK : CLOCK_BOOTTIME, TFD_NONBLOCK);
+  log::assert_that(fd_ != -1, "cannot create timerfd: {}", strerror(errno));
+
+  token_ = reactor_->Register(fd_, common::Bind(&TimerService::on_fire, common::Unretained(this)),
+                              common::Closure());
+}
+
+TimerService::~TimerService() {
+  reactor_->Unregister(token_);
+
+  int close_status;
+  RUN_NO_INTR(close_status = TIMERFD_CLOSE(fd_));
+  log::assert_that(close_status != -1, "assert failed: close_status != -1");
+}
+
+void TimerService::Arm(Timer* timer, microseconds delay, microseconds slack, microseconds period) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (timer->armed_) {
+    erase(timer);
+  }
+  timer->armed_ = false;
+  timer->expiry_pending_ = false;
+  if (delay.count() <= 0) {
+    return;
+  }
+
+  timer->period_ = period;
+  timer->slack_ = slack;
+  timer->armed_ = true;
+  insert(timer, Now() + delay);
+  rearm();
+}
+
+void TimerService::Disarm(Timer* timer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (timer->armed_) {
+    erase(timer);
+  }
+  timer->armed_ = false;
+  timer->expiry_pending_ = false;
+  // The timerfd is left armed; if |timer| was the earliest one the spurious wake-up re-arms it.
+}
+
+void TimerService::Remove(Timer* timer) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (timer->armed_) {
+    erase(timer);
+  }
+  timer->armed_ = false;
+  timer->expiry_pending_ = false;
+  // Removing a timer from its own expiry callback is fine, the service doesn't touch it afterwards.
+  if (running_on_ != std::this_thread::get_id()) {
+    expiry_done_.wait(lock, [this, timer] { return running_ != timer; });
+  }
+}
+
+bool TimerService::ClaimExpiry(Timer* timer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool pending = timer->expiry_pending_;
+  timer->expiry_pending_ = false;
+  return pending;
+}
+
+TimerService::TimePoint TimerService::Now() const {
+#ifdef USE_FAKE_TIMERS
+  return milliseconds(fake_timer::fake_timerfd_get_clock());
+#else
+  timespec now;
+  clock_gettime(CLOCK_BOOTTIME, &now);
+  return duration_cast<microseconds>(std::chrono::seconds(now.tv_sec) +
+                                     std::chrono::nanoseconds(now.tv_nsec));
+#endif
+}
+
+uint64_t TimerService::GetWakeupCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return wakeup_count_;
+}
+
+void TimerService::insert(Timer* timer, TimePoint deadline) {
+  timer->deadline_ = deadlines_.emplace(deadline, timer);
+  timer->latest_ = latest_.insert(deadline + timer->slack_);
+}
+
+void TimerService::erase(Timer* timer) {
+  deadlines_.erase(timer->deadline_);
+  latest_.erase(timer->latest_);
+}
+
+void TimerService::rearm() {
+  if (latest_.empty() || *latest_.begin() >= armed_at_) {
+    return;
+  }
+  armed_at_ = *latest_.begin();
+
+  // A zero it_value would disarm the timerfd, so an overdue timer gets the shortest delay instead.
+#ifdef USE_FAKE_TIMERS
+  long delay_us = std::max<long>((armed_at_ - Now()).count(), 1000);
+  delay_us = (delay_us + 999) / 1000 * 1000;
+#else
+  long delay_us = std::max<long>((armed_at_ - Now()).count(), 1);
+#endif
+  itimerspec timer_itimerspec{{/* interval for periodic timer */},
+                              {delay_us / 1000000, delay_us % 1000000 * 1000}};
+  int result = TIMERFD_SETTIME(fd_, 0, &timer_itimerspec, nullptr);
+  log::assert_that(result == 0, "assert failed: result == 0");
+}
+
+void TimerService::on_fire() {
+  uint64_t times_invoked;
+  auto bytes_read = read(fd_, &times_invoked, sizeof(uint64_t));
+  if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+    log::verbose("Timer service was re-armed before it fired");
+    return;
+  }
+  log::assert_that(bytes_read == static_cast<ssize_t>(sizeof(uint64_t)),
+                   "assert failed: bytes_read == static_cast<ssize_t>(sizeof(uint64_t))");
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  wakeup_count_++;
+  armed_at_ = TimePoint::max();
+  running_on_ = std::this_thread::get_id();
+  auto now = Now();
+  while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+    auto [deadline, timer] = *deadlines_.begin();
+    erase(timer);
+    if (timer->period_.count() > 0) {
+#ifdef USE_FAKE_TIMERS
+      // The fake timerfd reports every elapsed period as an expiry of its own.
+      insert(timer, deadline + timer->period_);
+#else
+      // Like a periodic timerfd, periods that were missed entirely only produce one expiry.
+      auto missed = (now - deadline) / timer->period_;
+      insert(timer, deadline + (missed + 1) * timer->period_);
+#endif
+    } else {
+      timer->armed_ = false;
+    }
+    timer->expiry_pending_ = true;
+    running_ = timer;
+    // The timer may be destroyed by its own callback, so run a copy.
+    auto on_expired = timer->on_expired_;
+    lock.unlock();
+    on_expired.Run();
+    lock.lock();
+    running_ = nullptr;
+    expiry_done_.notify_all();
+  }
+  running_on_ = std::thread::id();
+  rearm();
+}
+
+}  // namespace os
+}  // namespace bluetooth
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/timer_service.h"
+
+#include <memory>
+#include <vector>
+
+#include "common/bind.h"
+#include "gtest/gtest.h"
+#include "os/alarm.h"
+#include "os/fake_timer/fake_timerfd.h"
+#include "os/repeating_alarm.h"
+
+namespace bluetooth {
+namespace os {
+namespace {
+
+using common::BindOnce;
+using fake_timer::fake_timerfd_advance;
+using fake_timer::fake_timerfd_reset;
+using std::chrono::milliseconds;
+
+class TimerServiceTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    thread_ = new Thread("test_thread", Thread::Priority::NORMAL);
+    handler_ = new Handler(thread_);
+    service_ = thread_->GetTimerService(true);
+  }
+
+  void TearDown() override {
+    alarms_.clear();
+    handler_->Clear();
+    delete handler_;
+    delete thread_;
+    fake_timerfd_reset();
+  }
+
+  Alarm* new_alarm() {
+    alarms_.push_back(std::make_unique<Alarm>(handler_));
+    return alarms_.back().get();
+  }
+
+  common::OnceClosure record(int id) {
+    return BindOnce([](std::vector<int>* fired, int id) { fired->push_back(id); },
+                    common::Unretained(&fired_), id);
+  }
+
+  // Advance the fake clock on the thread, then wait for the expired alarms to run.
+  void advance(uint64_t ms) {
+    handler_->Post(BindOnce(fake_timerfd_advance, ms));
+    ASSERT_TRUE(thread_->GetReactor()->WaitForIdle(std::chrono::seconds(1)));
+  }
+
+  Thread* thread_;
+  Handler* handler_;
+  TimerService* service_;
+  std::vector<std::unique_ptr<Alarm>> alarms_;
+  std::vector<int> fired_;
+};
+
+TEST_F(TimerServiceTest, one_service_per_clock) {
+  ASSERT_EQ(service_, thread_->GetTimerService(true));
+  ASSERT_NE(service_, thread_->GetTimerService(false));
+}
+
+TEST_F(TimerServiceTest, alarms_fire_in_deadline_order) {
+  new_alarm()->Schedule(record(3), milliseconds(30));
+  new_alarm()->Schedule(record(1), milliseconds(10));
+  new_alarm()->Schedule(record(2), milliseconds(20));
+  advance(30);
+  ASSERT_EQ(fired_, (std::vector<int>{1, 2, 3}));
+}
+
+TEST_F(TimerServiceTest, alarms_with_same_deadline_share_wakeup) {
+  for (int i = 0; i < 10; i++) {
+    new_alarm()->Schedule(record(i), milliseconds(10));
+  }
+  advance(10);
+  ASSERT_EQ(fired_.size(), 10u);
+  ASSERT_EQ(service_->GetWakeupCount(), 1u);
+}
+
+TEST_F(TimerServiceTest, slack_batches_wakeups) {
+  new_alarm()->Schedule(record(1), milliseconds(10), milliseconds(10));
+  new_alarm()->Schedule(record(2), milliseconds(15));
+  advance(10);
+  ASSERT_TRUE(fired_.empty());
+  advance(5);
+  ASSERT_EQ(fired_, (std::vector<int>{1, 2}));
+  ASSERT_EQ(service_->GetWakeupCount(), 1u);
+}
+
+TEST_F(TimerServiceTest, slack_bounds_delay) {
+  new_alarm()->Schedule(record(1), milliseconds(10), milliseconds(5));
+  advance(14);
+  ASSERT_TRUE(fired_.empty());
+  advance(1);
+  ASSERT_EQ(fired_, (std::vector<int>{1}));
+}
+
+TEST_F(TimerServiceTest, cancel_earliest_alarm) {
+  auto alarm = new_alarm();
+  alarm->Schedule(BindOnce([]() { FAIL() << "Should not happen"; }), milliseconds(5));
+  new_alarm()->Schedule(record(1), milliseconds(10));
+  alarm->Cancel();
+  advance(10);
+  ASSERT_EQ(fired_, (std::vector<int>{1}));
+}
+
+TEST_F(TimerServiceTest, zero_delay_disarms) {
+  auto alarm = new_alarm();
+  alarm->Schedule(record(1), milliseconds(10));
+  alarm->Schedule(record(2), milliseconds(0));
+  advance(10);
+  ASSERT_TRUE(fired_.empty());
+}
+
+TEST_F(TimerServiceTest, delete_alarm_from_callback) {
+  auto alarm = new_alarm();
+  alarm->Schedule(BindOnce([](std::vector<std::unique_ptr<Alarm>>* alarms) { alarms->clear(); },
+                           common::Unretained(&alarms_)),
+                  milliseconds(10));
+  advance(10);
+  ASSERT_TRUE(alarms_.empty());
+}
+
+TEST_F(TimerServiceTest, repeating_alarm_shares_service) {
+  RepeatingAlarm repeating_alarm(handler_);
+  int count = 0;
+  repeating_alarm.Schedule(common::Bind([](int* count) { (*count)++; }, common::Unretained(&count)),
+                           milliseconds(10));
+  new_alarm()->Schedule(record(1), milliseconds(20));
+  advance(20);
+  repeating_alarm.Cancel();
+  ASSERT_EQ(count, 2);
+  ASSERT_EQ(fired_, (std::vector<int>{1}));
+}
+
+}  // namespace
+}  // namespace os
+}  // namespace bluetooth
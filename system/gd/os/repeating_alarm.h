@@ -23,14 +23,15 @@
 #include "common/callback.h"
 #include "os/handler.h"
 #include "os/thread.h"
+#include "os/timer_service.h"
 #include "os/utils.h"
 
 namespace bluetooth {
 namespace os {
 
-// A repeating alarm for reactor-based thread, implemented by Linux timerfd.
-// When it's constructed, it will register a reactable on the specified thread; when it's destroyed,
-// it will unregister itself from the thread.
+// A repeating alarm for reactor-based thread, sharing the timerfd of the thread's TimerService.
+// When it's constructed, it will add a timer to the thread's service; when it's destroyed, it will
+// remove itself from the service.
 class RepeatingAlarm {
 public:
   // Create and register a repeating alarm on a given handler
@@ -45,14 +46,19 @@ public:
   // Schedule a repeating alarm with given period
   void Schedule(common::Closure task, std::chrono::milliseconds period);
 
+  // Schedule a repeating alarm with given period, allowing each expiry to fire up to |slack| late
+  // so that its wake-ups can be batched with the ones of other alarms on the same thread.
+  void Schedule(common::Closure task, std::chrono::milliseconds period,
+                std::chrono::milliseconds slack);
+
   // Cancel the alarm. No-op if it's not armed.
   void Cancel();
 
 private:
   common::Closure task_;
   Handler* handler_;
-  int fd_ = 0;
-  Reactor::Reactable* token_;
+  TimerService* service_;
+  TimerService::Timer timer_;
   mutable std::mutex mutex_;
   void on_fire();
 };
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "common/callback.h"
+#include "os/reactor.h"
+
+namespace bluetooth {
+namespace os {
+
+// Multiplexes all the timers of one reactor thread onto a single timerfd, armed to the earliest
+// point at which some timer must fire. Alarm and RepeatingAlarm own a Timer each; a thread owns one
+// TimerService per clock (wake / non-wake), see Thread::GetTimerService().
+//
+// A timer scheduled with slack may fire anywhere in [deadline, deadline + slack]. Every time the
+// timerfd wakes the thread, all timers whose deadline has passed are fired, so timers with slack
+// ride along on the wake-ups of other timers instead of causing their own.
+class TimerService {
+public:
+  // Time since boot, or since the fake clock was reset in tests.
+  using TimePoint = std::chrono::microseconds;
+
+  class Timer {
+  public:
+    // |on_expired| is run on the reactor thread when the timer expires. It must call
+    // TimerService::ClaimExpiry() and do nothing if that returns false.
+    explicit Timer(common::Closure on_expired) : on_expired_(std::move(on_expired)) {}
+
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+  private:
+    friend class TimerService;
+    common::Closure on_expired_;
+    bool armed_ = false;
+    bool expiry_pending_ = false;
+    std::chrono::microseconds period_{0};
+    std::chrono::microseconds slack_{0};
+    std::multimap<TimePoint, Timer*>::iterator deadline_;
+    std::multiset<TimePoint>::iterator latest_;
+  };
+
+  TimerService(Reactor* reactor, bool is_wake);
+
+  TimerService(const TimerService&) = delete;
+  TimerService& operator=(const TimerService&) = delete;
+
+  ~TimerService();
+
+  // Arm |timer| to expire after |delay|, and then every |period| if it's non-zero. Re-arming an
+  // armed timer replaces its previous schedule. A zero |delay| disarms the timer, like a zero
+  // timerfd_settime() would.
+  void Arm(Timer* timer, std::chrono::microseconds delay, std::chrono::microseconds slack,
+           std::chrono::microseconds period = std::chrono::microseconds(0));
+
+  // Disarm |timer|. An expiry that was already picked up but not claimed yet is dropped.
+  void Disarm(Timer* timer);
+
+  // Disarm |timer| and wait for its expiry callback if it's currently running on another thread.
+  // |timer| is never touched by the service after this returns.
+  void Remove(Timer* timer);
+
+  // Called from the expiry callback. Returns false if the timer was re-armed or disarmed since it
+  // expired, in which case the expiry must be ignored.
+  bool ClaimExpiry(Timer* timer);
+
+  // Current time of the clock the timers are scheduled on.
+  TimePoint Now() const;
+
+  // Number of times the timerfd woke the reactor thread up.
+  uint64_t GetWakeupCount() const;
+
+private:
+  void on_fire();
+  void insert(Timer* timer, TimePoint deadline);
+  void erase(Timer* timer);
+  void rearm();
+
+  Reactor* reactor_;
+  int fd_;
+  Reactor::Reactable* token_;
+  mutable std::mutex mutex_;
+  std::condition_variable expiry_done_;
+  std::multimap<TimePoint, Timer*> deadlines_;
+  std::multiset<TimePoint> latest_;
+  TimePoint armed_at_ = TimePoint::max();
+  Timer* running_ = nullptr;
+  std::thread::id running_on_;
+  uint64_t wakeup_count_ = 0;
+};
+
+}  // namespace os
+}  // namespace bluetooth
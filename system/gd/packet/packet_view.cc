@@ -69,6 +69,21 @@ size_t PacketView<little_endian>::size() const {
   return length_;
 }
 
+template <bool little_endian>
+std::optional<std::span<const uint8_t>> PacketView<little_endian>::GetContiguousBytes() const {
+  std::span<const uint8_t> bytes;
+  for (const auto& fragment : fragments_) {
+    if (fragment.size() == 0) {
+      continue;
+    }
+    if (!bytes.empty()) {
+      return std::nullopt;
+    }
+    bytes = fragment.GetSpan();
+  }
+  return bytes;
+}
+
 template <bool little_endian>
 std::forward_list<View> PacketView<little_endian>::GetSubviewList(size_t begin, size_t end) const {
   assert(begin <= end);
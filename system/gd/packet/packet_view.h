@@ -18,6 +18,8 @@
 
 #include <cstdint>
 #include <forward_list>
+#include <optional>
+#include <span>
 #include <vector>
 
 #include "packet/iterator.h"
@@ -51,6 +53,11 @@ public:
   PacketView<true> GetLittleEndianSubview(size_t begin, size_t end) const;
   PacketView<false> GetBigEndianSubview(size_t begin, size_t end) const;
 
+  // Returns the bytes of the packet if they are contiguous, i.e. stored in a
+  // single fragment, as are the packets received from the HAL.
+  // The bytes are valid as long as the packet is alive.
+  std::optional<std::span<const uint8_t>> GetContiguousBytes() const;
+
 protected:
   void Append(PacketView to_add);
 
@@ -556,6 +556,28 @@ TEST(SubviewTest, subSubviewTest) {
   }
 }
 
+TEST(SubviewTest, contiguousBytesTest) {
+  PacketView<true> single_view(
+          {View(std::make_shared<const vector<uint8_t>>(count_all), 0, count_all.size())});
+  PacketView<true> multi_view({
+          View(std::make_shared<const vector<uint8_t>>(count_1), 0, count_1.size()),
+          View(std::make_shared<const vector<uint8_t>>(count_2), 0, count_2.size()),
+          View(std::make_shared<const vector<uint8_t>>(count_3), 0, count_3.size()),
+  });
+
+  auto bytes = single_view.GetLittleEndianSubview(1, count_all.size() - 1).GetContiguousBytes();
+  ASSERT_TRUE(bytes.has_value());
+  ASSERT_EQ(vector<uint8_t>(bytes->begin(), bytes->end()),
+            vector<uint8_t>(count_all.begin() + 1, count_all.end() - 1));
+
+  // The bytes of a multi fragment view are contiguous only within a fragment.
+  ASSERT_FALSE(multi_view.GetContiguousBytes().has_value());
+  bytes = multi_view.GetLittleEndianSubview(count_1.size(), count_1.size() + count_2.size())
+                  .GetContiguousBytes();
+  ASSERT_TRUE(bytes.has_value());
+  ASSERT_EQ(vector<uint8_t>(bytes->begin(), bytes->end()), count_2);
+}
+
 TEST_F(PacketViewMultiViewTest, sizeTest) { ASSERT_EQ(single_view.size(), multi_view.size()); }
 
 TEST_F(PacketViewMultiViewTest, dereferenceTestLittleEndian) {
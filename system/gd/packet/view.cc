@@ -40,5 +40,9 @@ uint8_t View::operator[](size_t i) const {
 }
 
 size_t View::size() const { return end_ - begin_; }
+
+std::span<const uint8_t> View::GetSpan() const {
+  return std::span<const uint8_t>(data_->data() + begin_, end_ - begin_);
+}
 }  // namespace packet
 }  // namespace bluetooth
@@ -18,6 +18,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace bluetooth {
@@ -35,6 +36,9 @@ public:
 
   size_t size() const;
 
+  // Returns the bytes of the view, valid as long as the view is alive.
+  std::span<const uint8_t> GetSpan() const;
+
 private:
   std::shared_ptr<const std::vector<uint8_t>> data_;
   size_t begin_;
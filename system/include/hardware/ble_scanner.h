@@ -71,6 +71,57 @@ public:
   std::vector<uint8_t> scan_response;
 };
 
+/**
+ * Advertising reports delivered together, with their advertising data laid
+ * out one after the other in a single buffer
+ */
+class ScanResultBatch {
+public:
+  struct Result {
+    uint16_t event_type = 0;
+    uint8_t addr_type = 0;
+    RawAddress bda;
+    uint8_t primary_phy = 0;
+    uint8_t secondary_phy = 0;
+    uint8_t advertising_sid = 0;
+    int8_t tx_power = 0;
+    int8_t rssi = 0;
+    uint16_t periodic_adv_int = 0;
+    size_t adv_data_offset = 0;
+    size_t adv_data_len = 0;
+  };
+
+  /** Appends a result, whose data offset and length are set from |adv_data| */
+  void Add(Result result, const uint8_t* adv_data, size_t adv_data_len) {
+    result.adv_data_offset = adv_data_.size();
+    result.adv_data_len = adv_data_len;
+    adv_data_.insert(adv_data_.end(), adv_data, adv_data + adv_data_len);
+    results_.push_back(result);
+  }
+
+  /** Removes all results, keeping the allocated storage for the next ones */
+  void Clear() {
+    results_.clear();
+    adv_data_.clear();
+  }
+
+  bool empty() const { return results_.empty(); }
+  size_t size() const { return results_.size(); }
+  const std::vector<Result>& results() const { return results_; }
+
+  const uint8_t* AdvData(const Result& result) const {
+    return adv_data_.data() + result.adv_data_offset;
+  }
+
+  std::vector<uint8_t> CopyAdvData(const Result& result) const {
+    return std::vector<uint8_t>(AdvData(result), AdvData(result) + result.adv_data_len);
+  }
+
+private:
+  std::vector<Result> results_;
+  std::vector<uint8_t> adv_data_;
+};
+
 /**
  * LE Scanning related callbacks invoked from from the Bluetooth native stack
  * All callbacks are invoked on the JNI thread
@@ -85,6 +136,19 @@ public:
                             uint8_t primary_phy, uint8_t secondary_phy, uint8_t advertising_sid,
                             int8_t tx_power, int8_t rssi, uint16_t periodic_adv_int,
                             std::vector<uint8_t> adv_data) = 0;
+
+  /**
+   * Delivers the advertising reports received since the previous batch, in
+   * order. Clients which do not override it get one OnScanResult() per report.
+   */
+  virtual void OnScanResults(const ScanResultBatch& batch) {
+    for (const auto& result : batch.results()) {
+      OnScanResult(result.event_type, result.addr_type, result.bda, result.primary_phy,
+                   result.secondary_phy, result.advertising_sid, result.tx_power, result.rssi,
+                   result.periodic_adv_int, batch.CopyAdvData(result));
+    }
+  }
+
   virtual void OnTrackAdvFoundLost(AdvertisingTrackInfo advertising_track_info) = 0;
   virtual void OnBatchScanReports(int client_if, int status, int report_format, int num_records,
                                   std::vector<uint8_t> data) = 0;
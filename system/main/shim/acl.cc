@@ -22,6 +22,7 @@
 #include <com_android_bluetooth_flags.h>
 #include <time.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <deque>
@@ -50,6 +51,7 @@
 #include "hci/address_with_type.h"
 #include "hci/class_of_device.h"
 #include "hci/controller_interface.h"
+#include "hci/le_scanning_manager.h"
 #include "internal_include/bt_target.h"
 #include "main/shim/dumpsys.h"
 #include "main/shim/entry.h"
@@ -831,6 +833,13 @@ struct shim::Acl::impl {
   ShadowAcceptlist shadow_acceptlist_;
   ShadowAddressResolutionList shadow_address_resolution_list_;
 
+  // The scan is scheduled around the connections
+  void UpdateScanningAclConnectionCount() {
+    size_t count =
+            handle_to_classic_connection_map_.size() + handle_to_le_connection_map_.size();
+    GetScanning()->SetAclConnectionCount(static_cast<uint8_t>(std::min<size_t>(count, UINT8_MAX)));
+  }
+
   bool IsClassicAcl(HciHandle handle) {
     return handle_to_classic_connection_map_.find(handle) !=
            handle_to_classic_connection_map_.end();
@@ -1355,6 +1364,7 @@ void shim::Acl::OnClassicLinkDisconnected(HciHandle handle, hci::ErrorCode reaso
   bluetooth::metrics::LogAclDisconnectionEvent(remote_address, reason, is_locally_initiated);
 
   pimpl_->handle_to_classic_connection_map_.erase(handle);
+  pimpl_->UpdateScanningAclConnectionCount();
   TRY_POSTING_ON_MAIN(acl_interface_.connection.classic.on_disconnected,
                       ToLegacyHciErrorCode(hci::ErrorCode::SUCCESS), handle,
                       ToLegacyHciErrorCode(reason));
@@ -1421,6 +1431,7 @@ void shim::Acl::OnLeLinkDisconnected(HciHandle handle, hci::ErrorCode reason) {
   TeardownTime teardown_time = std::chrono::system_clock::now();
 
   pimpl_->handle_to_le_connection_map_.erase(handle);
+  pimpl_->UpdateScanningAclConnectionCount();
   TRY_POSTING_ON_MAIN(acl_interface_.connection.le.on_disconnected,
                       ToLegacyHciErrorCode(hci::ErrorCode::SUCCESS), handle,
                       ToLegacyHciErrorCode(reason));
@@ -1450,6 +1461,7 @@ void shim::Acl::OnConnectSuccess(
                           std::chrono::system_clock::now()));
   pimpl_->handle_to_classic_connection_map_[handle]->RegisterCallbacks();
   pimpl_->handle_to_classic_connection_map_[handle]->ReadRemoteControllerInformation();
+  pimpl_->UpdateScanningAclConnectionCount();
 
   TRY_POSTING_ON_MAIN(acl_interface_.connection.classic.on_connected, bd_addr, handle, false,
                       locally_initiated);
@@ -1523,6 +1535,7 @@ void shim::Acl::OnLeConnectSuccess(hci::AddressWithType address_with_type,
                           acl_interface_.link.le, handler_, std::move(connection),
                           std::chrono::system_clock::now()));
   pimpl_->handle_to_le_connection_map_[handle]->RegisterCallbacks();
+  pimpl_->UpdateScanningAclConnectionCount();
 
   // Once an le connection has successfully been established
   // the device address is removed from the controller accept list.
@@ -19,12 +19,19 @@
  */
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <queue>
 #include <set>
 #include <vector>
 
 #include "hci/le_scanning_callback.h"
 #include "include/hardware/ble_scanner.h"
+#include "osi/include/alarm.h"
+#include "stack/include/bt_dev_class.h"
+#include "stack/include/bt_device_type.h"
 #include "types/ble_address_with_type.h"
 #include "types/bluetooth/uuid.h"
 #include "types/raw_address.h"
@@ -51,10 +58,14 @@ public:
 class BleScannerInterfaceImpl : public ::BleScannerInterface,
                                 public bluetooth::hci::ScanningCallback {
 public:
-  ~BleScannerInterfaceImpl() override {}
+  BleScannerInterfaceImpl();
+  ~BleScannerInterfaceImpl() override;
 
   void Init();
 
+  // Called when the properties of `bd_addr` are removed from storage
+  void ForgetRemoteProperties(const RawAddress& bd_addr);
+
   // ::BleScannerInterface
   void RegisterScanner(const bluetooth::Uuid& uuid, RegisterCallback) override;
   void Unregister(int scanner_id) override;
@@ -131,12 +142,87 @@ public:
   MsftCallbacks msft_callbacks_;
 #endif
 
+  // Remote properties learnt from advertising reports. Updates which do not
+  // change what was last written are dropped. The storage properties of a
+  // device are written as soon as they are learnt or change, then at most
+  // once per window: the later changes are coalesced until the flush timer.
+  class PropertyCache {
+  public:
+    struct StorageProperties {
+      tBT_DEVICE_TYPE device_type;
+      tBLE_ADDR_TYPE address_type;
+
+      bool operator==(const StorageProperties& other) const = default;
+    };
+
+    // Read by dumpsys outside of the jni thread.
+    struct Stats {
+      std::atomic<uint64_t> btif_updates_delivered{0};
+      std::atomic<uint64_t> btif_updates_suppressed{0};
+      std::atomic<uint64_t> storage_updates_suppressed{0};
+      std::atomic<uint64_t> storage_updates_coalesced{0};
+      std::atomic<uint64_t> storage_devices_committed{0};
+      std::atomic<uint64_t> storage_commits{0};
+    };
+
+    enum class StorageUpdate {
+      kSuppressed,
+      kWriteNow,
+      kPending,
+    };
+
+    static constexpr uint64_t kFlushWindowMs = 1000;
+
+    void init(void);
+
+    // Returns whether the class of device and type of `p_bda` differ from
+    // the ones last delivered to btif, and records them if so.
+    bool update_class(const RawAddress& p_bda, const DEV_CLASS& dev_class,
+                      tBT_DEVICE_TYPE device_type);
+
+    // Returns whether `properties` must be written to storage now, are held
+    // until the next flush, or are already there.
+    StorageUpdate update_storage(const RawAddress& p_bda, StorageProperties properties,
+                                 uint64_t now_ms);
+
+    // Drops what is known of `p_bda`, whose properties were removed from
+    // storage: the next report of the device writes them again.
+    void forget(const RawAddress& p_bda);
+
+    // Returns the pending storage updates, which are from then on considered
+    // committed.
+    std::map<RawAddress, StorageProperties> take_pending(uint64_t now_ms);
+
+    Stats& stats() { return stats_; }
+
+  private:
+    struct CommittedProperties {
+      StorageProperties properties;
+      uint64_t written_ms;
+    };
+
+    void commit(const RawAddress& p_bda, StorageProperties properties, uint64_t now_ms);
+
+    // all access to these variables should be done on the jni thread
+    std::map<RawAddress, std::pair<DEV_CLASS, tBT_DEVICE_TYPE>> delivered_classes_;
+    std::map<RawAddress, CommittedProperties> committed_;
+    std::map<RawAddress, StorageProperties> pending_;
+    const size_t max_size_ = 1024;
+
+    Stats stats_;
+  };
+
 private:
   bool parse_filter_command(bluetooth::hci::AdvertisingPacketContentFilterCommand&
                                     advertising_packet_content_filter_command,
                             ApcfCommand apcf_command);
   void handle_remote_properties(RawAddress bd_addr, tBLE_ADDR_TYPE addr_type,
-                                std::vector<uint8_t> advertising_data);
+                                const std::vector<uint8_t>& advertising_data);
+  void deliver_scan_results();
+  void flush_remote_properties();
+  void reset_remote_properties();
+  void forget_remote_properties(RawAddress bd_addr);
+  void Dump(int fd);
 
   class AddressCache {
   public:
@@ -150,6 +236,33 @@ private:
     std::queue<RawAddress> remote_bdaddr_cache_ordered_;
     const size_t remote_bdaddr_cache_max_size_ = 1024;
   } address_cache_;
+
+  PropertyCache property_cache_;
+
+  void write_remote_properties(
+          const std::map<RawAddress, PropertyCache::StorageProperties>& properties);
+  static void on_property_flush_timeout(void* data);
+
+  // Flushes the pending storage updates, one window after the first of them
+  alarm_t* property_flush_alarm_ = nullptr;
+
+  // Advertising reports waiting for the jni thread, when they are delivered
+  // in batch: the first report of a batch posts its delivery, and the
+  // following ones join it until the jni thread takes it.
+  struct PendingScanResults {
+    ScanResultBatch batch;
+    // Address types after resolution, for the remote properties
+    std::vector<tBLE_ADDR_TYPE> ble_addr_types;
+  };
+
+  bool batched_delivery_ = false;
+  std::mutex scan_results_mutex_;
+  PendingScanResults pending_scan_results_;
+  // Storage of the last batch delivered, reused for the next one
+  PendingScanResults spare_scan_results_;
+  bool scan_results_posted_ = false;
+  // Advertising data of the report being delivered, on the jni thread
+  std::vector<uint8_t> advertising_data_;
 };
 
 }  // namespace shim
@@ -23,12 +23,15 @@
 #include <hardware/bluetooth.h>
 #include <hardware/bt_gatt.h>
 
+#include <cinttypes>
 #include <vector>
 
 #include "btif/include/btif_common.h"
 #include "hci/le_advertising_manager.h"
+#include "main/shim/dumpsys.h"
 #include "main/shim/entry.h"
 #include "main/shim/helpers.h"
+#include "main/shim/shim.h"
 #include "stack/include/btm_log_history.h"
 #include "stack/include/main_thread.h"
 #include "types/raw_address.h"
@@ -50,13 +53,21 @@ constexpr char kBtmLogTag[] = "ADV";
 class BleAdvertiserInterfaceImpl : public ::BleAdvertiserInterface,
                                    public bluetooth::hci::AdvertisingCallback {
 public:
-  ~BleAdvertiserInterfaceImpl() override {}
+  BleAdvertiserInterfaceImpl() {
+    bluetooth::shim::RegisterDumpsysFunction(static_cast<void*>(this),
+                                             [this](int fd) { Dump(fd); });
+  }
+  ~BleAdvertiserInterfaceImpl() override {
+    bluetooth::shim::UnregisterDumpsysFunction(static_cast<void*>(this));
+  }
 
   void Init() {
     // Register callback
     bluetooth::shim::GetAdvertising()->RegisterAdvertisingCallback(this);
   }
 
+  void Dump(int fd);
+
   // ::BleAdvertiserInterface
   void RegisterAdvertiser(IdStatusCallback cb) override {
     log::info("in shim layer");
@@ -415,6 +426,35 @@ private:
   std::map<uint8_t, std::set<int>> native_reg_id_map;
 };
 
+#define DUMPSYS_TAG "shim::advertising"
+void BleAdvertiserInterfaceImpl::Dump(int fd) {
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+  if (!bluetooth::shim::is_gd_stack_started_up()) {
+    return;
+  }
+  auto metrics = bluetooth::shim::GetAdvertising()->GetMultiplexingMetrics();
+  if (metrics.sets.empty()) {
+    LOG_DUMPSYS(fd, "No multiplexed advertisers");
+    return;
+  }
+  LOG_DUMPSYS(fd, "Multiplexed advertising sets:%zu first handle:%u slice:%lldms",
+              metrics.sets.size(), metrics.sets.front(),
+              static_cast<long long>(metrics.slice.count()));
+  LOG_DUMPSYS(fd, "  set changes:%" PRIu32 " parameter writes:%" PRIu32,
+              metrics.statistics.changes, metrics.statistics.parameter_writes);
+  for (const auto& advertiser : metrics.advertisers) {
+    LOG_DUMPSYS(fd,
+                "  advertiser:%-3u interval requested:%-6lldms estimated:%-7lldms air time:%5.1f%%"
+                " set:%s",
+                advertiser.advertiser_id,
+                static_cast<long long>(advertiser.requested_interval.count()),
+                static_cast<long long>(advertiser.achieved_interval.count()),
+                advertiser.air_time * 100,
+                advertiser.set.has_value() ? std::to_string(*advertiser.set).c_str() : "-");
+  }
+}
+#undef DUMPSYS_TAG
+
 BleAdvertiserInterfaceImpl* bt_le_advertiser_instance = nullptr;
 
 ::BleAdvertiserInterface* bluetooth::shim::get_ble_advertiser_instance() {
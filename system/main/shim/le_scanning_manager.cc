@@ -23,6 +23,9 @@
 #include <bluetooth/log.h>
 #include <hardware/bluetooth.h>
 
+#include <cinttypes>
+#include <utility>
+
 #include "btif/include/btif_common.h"
 #include "hci/address.h"
 #include "hci/le_scanning_manager.h"
@@ -31,10 +34,13 @@
 #endif
 #include "include/hardware/ble_scanner.h"
 #include "main/shim/ble_scanner_interface_impl.h"
+#include "main/shim/dumpsys.h"
 #include "main/shim/entry.h"
 #include "main/shim/helpers.h"
 #include "main/shim/le_scanning_manager.h"
 #include "main/shim/shim.h"
+#include "osi/include/alarm.h"
+#include "osi/include/properties.h"
 #include "stack/btm/btm_int_types.h"
 #include "stack/include/advertise_data_parser.h"
 #include "stack/include/bt_dev_class.h"
@@ -61,6 +67,7 @@ constexpr uint8_t kFilterLogicAnd = 0x01;
 constexpr uint8_t kLowestRssiValue = 129;
 constexpr uint16_t kAllowAllFilter = 0x00;
 constexpr uint16_t kListLogicOr = 0x01;
+constexpr char kBatchedDeliveryProperty[] = "persist.bluetooth.le_scan.batched_delivery.enabled";
 
 class DefaultScanningCallback : public ::ScanningCallbacks {
   void OnScannerRegistered(const bluetooth::Uuid /* app_uuid */, uint8_t /* scanner_id */,
@@ -129,8 +136,17 @@ extern DEV_CLASS btm_ble_get_appearance_as_cod(std::vector<uint8_t> const& data)
 
 using bluetooth::shim::BleScannerInterfaceImpl;
 
+BleScannerInterfaceImpl::BleScannerInterfaceImpl() {
+  bluetooth::shim::RegisterDumpsysFunction(static_cast<void*>(this), [this](int fd) { Dump(fd); });
+}
+
+BleScannerInterfaceImpl::~BleScannerInterfaceImpl() {
+  bluetooth::shim::UnregisterDumpsysFunction(static_cast<void*>(this));
+}
+
 void BleScannerInterfaceImpl::Init() {
   log::info("init BleScannerInterfaceImpl");
+  batched_delivery_ = osi_property_get_bool(kBatchedDeliveryProperty, true);
   bluetooth::shim::GetScanning()->RegisterScanningCallback(this);
 
 #if TARGET_FLOSS
@@ -138,6 +154,11 @@ void BleScannerInterfaceImpl::Init() {
     bluetooth::shim::GetMsftExtensionManager()->SetScanningCallback(this);
   }
 #endif
+
+  // Kept across stack restarts, which initialize the scanner again
+  if (property_flush_alarm_ == nullptr) {
+    property_flush_alarm_ = alarm_new("shim.scanning.property_flush");
+  }
 }
 
 /** Registers a scanner with the stack */
@@ -180,8 +201,8 @@ void BleScannerInterfaceImpl::Scan(bool start) {
     return;
   }
 
-  do_in_jni_thread(base::BindOnce(&BleScannerInterfaceImpl::AddressCache::init,
-                                  base::Unretained(&address_cache_)));
+  do_in_jni_thread(base::BindOnce(&BleScannerInterfaceImpl::reset_remote_properties,
+                                  base::Unretained(this)));
 }
 
 /** Setup scan filter params */
@@ -473,14 +494,35 @@ void BleScannerInterfaceImpl::OnScanResult(uint16_t event_type, uint8_t address_
     btm_ble_process_adv_addr(raw_address, &ble_addr_type);
   }
 
-  do_in_jni_thread(base::BindOnce(&BleScannerInterfaceImpl::handle_remote_properties,
-                                  base::Unretained(this), raw_address, ble_addr_type,
-                                  advertising_data));
-
-  do_in_jni_thread(base::BindOnce(
-          &ScanningCallbacks::OnScanResult, base::Unretained(scanning_callbacks_), event_type,
-          static_cast<uint8_t>(address_type), raw_address, primary_phy, secondary_phy,
-          advertising_sid, tx_power, rssi, periodic_advertising_interval, advertising_data));
+  if (batched_delivery_) {
+    std::lock_guard<std::mutex> lock(scan_results_mutex_);
+    pending_scan_results_.batch.Add(
+            {.event_type = event_type,
+             .addr_type = static_cast<uint8_t>(address_type),
+             .bda = raw_address,
+             .primary_phy = primary_phy,
+             .secondary_phy = secondary_phy,
+             .advertising_sid = advertising_sid,
+             .tx_power = tx_power,
+             .rssi = rssi,
+             .periodic_adv_int = periodic_advertising_interval},
+            advertising_data.data(), advertising_data.size());
+    pending_scan_results_.ble_addr_types.push_back(ble_addr_type);
+    if (!scan_results_posted_) {
+      scan_results_posted_ = true;
+      do_in_jni_thread(base::BindOnce(&BleScannerInterfaceImpl::deliver_scan_results,
+                                      base::Unretained(this)));
+    }
+  } else {
+    do_in_jni_thread(base::BindOnce(&BleScannerInterfaceImpl::handle_remote_properties,
+                                    base::Unretained(this), raw_address, ble_addr_type,
+                                    advertising_data));
+
+    do_in_jni_thread(base::BindOnce(
+            &ScanningCallbacks::OnScanResult, base::Unretained(scanning_callbacks_), event_type,
+            static_cast<uint8_t>(address_type), raw_address, primary_phy, secondary_phy,
+            advertising_sid, tx_power, rssi, periodic_advertising_interval, advertising_data));
+  }
 
   // TODO: Remove when StartInquiry in GD part implemented
   btm_ble_process_adv_pkt_cont_for_inquiry(event_type, ble_addr_type, raw_address, primary_phy,
@@ -488,6 +530,28 @@ void BleScannerInterfaceImpl::OnScanResult(uint16_t event_type, uint8_t address_
                                            periodic_advertising_interval, advertising_data);
 }
 
+void BleScannerInterfaceImpl::deliver_scan_results() {
+  PendingScanResults results;
+  {
+    std::lock_guard<std::mutex> lock(scan_results_mutex_);
+    results = std::exchange(pending_scan_results_, std::move(spare_scan_results_));
+    scan_results_posted_ = false;
+  }
+
+  const auto& batch_results = results.batch.results();
+  for (size_t i = 0; i < batch_results.size(); i++) {
+    const uint8_t* data = results.batch.AdvData(batch_results[i]);
+    advertising_data_.assign(data, data + batch_results[i].adv_data_len);
+    handle_remote_properties(batch_results[i].bda, results.ble_addr_types[i], advertising_data_);
+  }
+  scanning_callbacks_->OnScanResults(results.batch);
+
+  results.batch.Clear();
+  results.ble_addr_types.clear();
+  std::lock_guard<std::mutex> lock(scan_results_mutex_);
+  spare_scan_results_ = std::move(results);
+}
+
 void BleScannerInterfaceImpl::OnTrackAdvFoundLost(
         bluetooth::hci::AdvertisingFilterOnFoundOnLostInfo on_found_on_lost_info) {
   AdvertisingTrackInfo track_info = {};
@@ -659,8 +723,9 @@ bool BleScannerInterfaceImpl::parse_filter_command(
   return true;
 }
 
-void BleScannerInterfaceImpl::handle_remote_properties(RawAddress bd_addr, tBLE_ADDR_TYPE addr_type,
-                                                       std::vector<uint8_t> advertising_data) {
+void BleScannerInterfaceImpl::handle_remote_properties(
+        RawAddress bd_addr, tBLE_ADDR_TYPE addr_type,
+        const std::vector<uint8_t>& advertising_data) {
   if (!bluetooth::shim::is_gd_stack_started_up()) {
     log::warn("Gd stack is stopped, return");
     return;
@@ -713,26 +778,117 @@ void BleScannerInterfaceImpl::handle_remote_properties(RawAddress bd_addr, tBLE_
   }
 
   DEV_CLASS dev_class = btm_ble_get_appearance_as_cod(advertising_data);
-  if (dev_class != kDevClassUnclassified) {
+  if (dev_class != kDevClassUnclassified &&
+      property_cache_.update_class(bd_addr, dev_class, device_type)) {
     btif_update_remote_properties(bd_addr, bdname.name, dev_class, device_type);
   }
 
+  // btif_gattc_open_impl() reads the device and address type from storage as
+  // soon as the device is reported: they are only held when they change again
+  // within the window.
+  PropertyCache::StorageProperties properties{static_cast<tBT_DEVICE_TYPE>(device_type),
+                                              addr_type};
+  switch (property_cache_.update_storage(bd_addr, properties,
+                                         timestamper_in_milliseconds.GetTimestamp())) {
+    case PropertyCache::StorageUpdate::kWriteNow:
+      write_remote_properties({{bd_addr, properties}});
+      break;
+    case PropertyCache::StorageUpdate::kPending:
+      if (!alarm_is_scheduled(property_flush_alarm_)) {
+        alarm_set(property_flush_alarm_, PropertyCache::kFlushWindowMs,
+                  &BleScannerInterfaceImpl::on_property_flush_timeout, this);
+      }
+      break;
+    case PropertyCache::StorageUpdate::kSuppressed:
+      break;
+  }
+}
+
+void BleScannerInterfaceImpl::on_property_flush_timeout(void* data) {
+  do_in_jni_thread(base::BindOnce(&BleScannerInterfaceImpl::flush_remote_properties,
+                                  base::Unretained(static_cast<BleScannerInterfaceImpl*>(data))));
+}
+
+void BleScannerInterfaceImpl::flush_remote_properties() {
+  alarm_cancel(property_flush_alarm_);
+  write_remote_properties(property_cache_.take_pending(timestamper_in_milliseconds.GetTimestamp()));
+}
+
+void BleScannerInterfaceImpl::write_remote_properties(
+        const std::map<RawAddress, PropertyCache::StorageProperties>& pending) {
+  if (pending.empty()) {
+    return;
+  }
+
+  if (!bluetooth::shim::is_gd_stack_started_up()) {
+    log::warn("Gd stack is stopped, dropping properties of {} devices", pending.size());
+    return;
+  }
+
   auto* storage_module = bluetooth::shim::GetStorage();
-  bluetooth::hci::Address address = ToGdAddress(bd_addr);
+  auto& stats = property_cache_.stats();
+
+  // Le() requires the device to be known as LE or DUAL: the type of the
+  // devices which are not yet is committed first.
+  auto type_mutation = storage_module->Modify();
+  bool new_devices = false;
+  for (const auto& [bd_addr, properties] : pending) {
+    bluetooth::storage::Device device = storage_module->GetDeviceByLegacyKey(ToGdAddress(bd_addr));
+    auto stored_type = device.GetDeviceType();
+    if (stored_type != bluetooth::hci::DeviceType::LE &&
+        stored_type != bluetooth::hci::DeviceType::DUAL) {
+      auto device_type = static_cast<bluetooth::hci::DeviceType>(properties.device_type);
+      type_mutation.Add(device.SetDeviceType(device_type));
+      new_devices = true;
+    }
+  }
+  if (new_devices) {
+    type_mutation.Commit();
+    stats.storage_commits++;
+  }
 
-  // update device type
   auto mutation = storage_module->Modify();
-  bluetooth::storage::Device device = storage_module->GetDeviceByLegacyKey(address);
-  mutation.Add(device.SetDeviceType(device_type));
+  for (const auto& [bd_addr, properties] : pending) {
+    bluetooth::storage::Device device = storage_module->GetDeviceByLegacyKey(ToGdAddress(bd_addr));
+    auto device_type = static_cast<bluetooth::hci::DeviceType>(properties.device_type);
+    mutation.Add(device.SetDeviceType(device_type));
+    mutation.Add(device.Le().SetAddressType(
+            static_cast<bluetooth::hci::AddressType>(properties.address_type)));
+  }
   mutation.Commit();
+  stats.storage_commits++;
+  stats.storage_devices_committed += pending.size();
+}
 
-  // update address type
-  auto mutation2 = storage_module->Modify();
-  bluetooth::storage::LeDevice le_device = device.Le();
-  mutation2.Add(le_device.SetAddressType((bluetooth::hci::AddressType)addr_type));
-  mutation2.Commit();
+void BleScannerInterfaceImpl::reset_remote_properties() {
+  flush_remote_properties();
+  address_cache_.init();
+  property_cache_.init();
 }
 
+void BleScannerInterfaceImpl::ForgetRemoteProperties(const RawAddress& bd_addr) {
+  do_in_jni_thread(base::BindOnce(&BleScannerInterfaceImpl::forget_remote_properties,
+                                  base::Unretained(this), bd_addr));
+}
+
+void BleScannerInterfaceImpl::forget_remote_properties(RawAddress bd_addr) {
+  property_cache_.forget(bd_addr);
+}
+
+#define DUMPSYS_TAG "shim::scanning"
+void BleScannerInterfaceImpl::Dump(int fd) {
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+  const auto& stats = property_cache_.stats();
+  LOG_DUMPSYS(fd, "Remote properties from advertising reports");
+  LOG_DUMPSYS(fd, "  btif updates     delivered:%-8" PRIu64 " suppressed:%" PRIu64,
+              stats.btif_updates_delivered.load(), stats.btif_updates_suppressed.load());
+  LOG_DUMPSYS(fd, "  storage updates  suppressed:%-7" PRIu64 " coalesced:%" PRIu64,
+              stats.storage_updates_suppressed.load(), stats.storage_updates_coalesced.load());
+  LOG_DUMPSYS(fd, "  storage writes   devices:%-10" PRIu64 " commits:%" PRIu64,
+              stats.storage_devices_committed.load(), stats.storage_commits.load());
+}
+#undef DUMPSYS_TAG
+
 void BleScannerInterfaceImpl::AddressCache::add(const RawAddress& p_bda) {
   // Remove the oldest entries
   while (remote_bdaddr_cache_.size() >= remote_bdaddr_cache_max_size_) {
@@ -753,6 +909,83 @@ void BleScannerInterfaceImpl::AddressCache::init(void) {
   remote_bdaddr_cache_ordered_ = {};
 }
 
+void BleScannerInterfaceImpl::PropertyCache::init(void) {
+  delivered_classes_.clear();
+  committed_.clear();
+  pending_.clear();
+}
+
+bool BleScannerInterfaceImpl::PropertyCache::update_class(const RawAddress& p_bda,
+                                                          const DEV_CLASS& dev_class,
+                                                          tBT_DEVICE_TYPE device_type) {
+  auto entry = std::make_pair(dev_class, device_type);
+  auto it = delivered_classes_.find(p_bda);
+  if (it != delivered_classes_.end() && it->second == entry) {
+    stats_.btif_updates_suppressed++;
+    return false;
+  }
+
+  // Forgetting what was delivered only costs a redundant update
+  if (it == delivered_classes_.end() && delivered_classes_.size() >= max_size_) {
+    delivered_classes_.clear();
+  }
+  delivered_classes_[p_bda] = entry;
+  stats_.btif_updates_delivered++;
+  return true;
+}
+
+BleScannerInterfaceImpl::PropertyCache::StorageUpdate
+BleScannerInterfaceImpl::PropertyCache::update_storage(const RawAddress& p_bda,
+                                                       StorageProperties properties,
+                                                       uint64_t now_ms) {
+  auto pending = pending_.find(p_bda);
+  if (pending != pending_.end()) {
+    if (pending->second == properties) {
+      stats_.storage_updates_suppressed++;
+    } else {
+      pending->second = properties;
+      stats_.storage_updates_coalesced++;
+    }
+    return StorageUpdate::kPending;
+  }
+
+  auto committed = committed_.find(p_bda);
+  if (committed != committed_.end() && committed->second.properties == properties) {
+    stats_.storage_updates_suppressed++;
+    return StorageUpdate::kSuppressed;
+  }
+  if (committed == committed_.end() || now_ms - committed->second.written_ms >= kFlushWindowMs) {
+    commit(p_bda, properties, now_ms);
+    return StorageUpdate::kWriteNow;
+  }
+  pending_[p_bda] = properties;
+  return StorageUpdate::kPending;
+}
+
+void BleScannerInterfaceImpl::PropertyCache::forget(const RawAddress& p_bda) {
+  delivered_classes_.erase(p_bda);
+  committed_.erase(p_bda);
+  pending_.erase(p_bda);
+}
+
+std::map<RawAddress, BleScannerInterfaceImpl::PropertyCache::StorageProperties>
+BleScannerInterfaceImpl::PropertyCache::take_pending(uint64_t now_ms) {
+  for (const auto& [bd_addr, properties] : pending_) {
+    commit(bd_addr, properties, now_ms);
+  }
+  return std::exchange(pending_, {});
+}
+
+void BleScannerInterfaceImpl::PropertyCache::commit(const RawAddress& p_bda,
+                                                    StorageProperties properties,
+                                                    uint64_t now_ms) {
+  // Forgetting what was committed only costs a redundant write
+  if (committed_.size() >= max_size_ && committed_.count(p_bda) == 0) {
+    committed_.clear();
+  }
+  committed_[p_bda] = {properties, now_ms};
+}
+
 BleScannerInterfaceImpl* bt_le_scanner_instance = nullptr;
 
 BleScannerInterface* bluetooth::shim::get_ble_scanner_instance() {
@@ -766,6 +999,12 @@ void bluetooth::shim::init_scanning_manager() {
   static_cast<BleScannerInterfaceImpl*>(bluetooth::shim::get_ble_scanner_instance())->Init();
 }
 
+void bluetooth::shim::forget_remote_properties(const RawAddress& bd_addr) {
+  if (bt_le_scanner_instance != nullptr) {
+    bt_le_scanner_instance->ForgetRemoteProperties(bd_addr);
+  }
+}
+
 bool bluetooth::shim::is_ad_type_filter_supported() {
   return bluetooth::shim::GetScanning()->IsAdTypeFilterSupported();
 }
@@ -20,12 +20,16 @@
 #pragma once
 
 #include "include/hardware/ble_scanner.h"
+#include "types/raw_address.h"
 
 namespace bluetooth {
 namespace shim {
 
 ::BleScannerInterface* get_ble_scanner_instance();
 void init_scanning_manager();
+// Drops the remote properties cached from advertising reports for a device
+// removed from storage, so that they are written again when next reported.
+void forget_remote_properties(const RawAddress& bd_addr);
 bool is_ad_type_filter_supported();
 void set_ad_type_rsi_filter(bool enable);
 void set_empty_filter(bool enable);
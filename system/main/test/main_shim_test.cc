@@ -598,6 +598,161 @@ TEST_F(MainShimTest, DISABLED_BleScannerInterfaceImpl_OnScanResult) {
   run_all_jni_thread_task();
 }
 
+TEST_F(MainShimTest, ScanningCallbacks_OnScanResults_unrolls_batch) {
+  class RecordingScanningCallbacks : public TestScanningCallbacks {
+  public:
+    void OnScanResult(uint16_t event_type, uint8_t addr_type, RawAddress bda,
+                      uint8_t /* primary_phy */, uint8_t /* secondary_phy */,
+                      uint8_t /* advertising_sid */, int8_t /* tx_power */, int8_t rssi,
+                      uint16_t /* periodic_adv_int */, std::vector<uint8_t> adv_data) override {
+      event_types.push_back(event_type);
+      addr_types.push_back(addr_type);
+      addresses.push_back(bda);
+      rssis.push_back(rssi);
+      adv_datas.push_back(adv_data);
+    }
+
+    std::vector<uint16_t> event_types;
+    std::vector<uint8_t> addr_types;
+    std::vector<RawAddress> addresses;
+    std::vector<int8_t> rssis;
+    std::vector<std::vector<uint8_t>> adv_datas;
+  } cb;
+
+  const RawAddress address1({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+  const RawAddress address2({0x66, 0x55, 0x44, 0x33, 0x22, 0x11});
+  const std::vector<uint8_t> adv_data1 = {0x02, 0x01, 0x06};
+  const std::vector<uint8_t> adv_data2 = {0x03, 0x09, 'a', 'b'};
+
+  ScanResultBatch batch;
+  batch.Add({.event_type = 0x13, .addr_type = BLE_ADDR_PUBLIC, .bda = address1, .rssi = -40},
+            adv_data1.data(), adv_data1.size());
+  batch.Add({.event_type = 0x10, .addr_type = BLE_ADDR_RANDOM, .bda = address2, .rssi = -70},
+            nullptr, 0);
+  batch.Add({.event_type = 0x1b, .addr_type = BLE_ADDR_RANDOM, .bda = address2, .rssi = -71},
+            adv_data2.data(), adv_data2.size());
+  ASSERT_EQ(3UL, batch.size());
+
+  cb.OnScanResults(batch);
+  ASSERT_EQ(std::vector<uint16_t>({0x13, 0x10, 0x1b}), cb.event_types);
+  ASSERT_EQ(std::vector<uint8_t>({BLE_ADDR_PUBLIC, BLE_ADDR_RANDOM, BLE_ADDR_RANDOM}),
+            cb.addr_types);
+  ASSERT_EQ(std::vector<RawAddress>({address1, address2, address2}), cb.addresses);
+  ASSERT_EQ(std::vector<int8_t>({-40, -70, -71}), cb.rssis);
+  ASSERT_EQ(std::vector<std::vector<uint8_t>>({adv_data1, {}, adv_data2}), cb.adv_datas);
+
+  batch.Clear();
+  ASSERT_TRUE(batch.empty());
+}
+
+TEST_F(MainShimTest, BleScannerInterfaceImpl_OnScanResult_delivers_batches) {
+  auto* ble = static_cast<bluetooth::shim::BleScannerInterfaceImpl*>(
+          bluetooth::shim::get_ble_scanner_instance());
+
+  EXPECT_CALL(*hci::testing::mock_le_scanning_manager_, RegisterScanningCallback(_)).Times(1);
+  bluetooth::shim::init_scanning_manager();
+
+  class BatchScanningCallbacks : public TestScanningCallbacks {
+  public:
+    void OnScanResults(const ScanResultBatch& batch) override {
+      std::vector<std::pair<RawAddress, std::vector<uint8_t>>> results;
+      for (const auto& result : batch.results()) {
+        results.push_back({result.bda, batch.CopyAdvData(result)});
+      }
+      batches.push_back(results);
+    }
+
+    std::vector<std::vector<std::pair<RawAddress, std::vector<uint8_t>>>> batches;
+  } cb;
+  auto* scanning_callbacks = ble->scanning_callbacks_;
+  ble->RegisterCallbacks(&cb);
+
+  const hci::Address address1({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+  const hci::Address address2({0x66, 0x55, 0x44, 0x33, 0x22, 0x11});
+  const std::vector<uint8_t> adv_data1 = {0x02, 0x01, 0x06};
+  const std::vector<uint8_t> adv_data2 = {0x03, 0x09, 'a', 'b'};
+  auto on_scan_result = [ble](const hci::Address& address, std::vector<uint8_t> adv_data) {
+    ble->OnScanResult(0, BLE_ADDR_ANONYMOUS, address, 0, 0, 0, 0, 0, 0, adv_data);
+  };
+
+  // The reports received before the jni thread runs join the first batch
+  on_scan_result(address1, adv_data1);
+  on_scan_result(address2, adv_data2);
+  on_scan_result(address1, {});
+  ASSERT_EQ(1UL, do_in_jni_thread_task_queue.size());
+  run_all_jni_thread_task();
+
+  ASSERT_EQ(1UL, cb.batches.size());
+  ASSERT_EQ(3UL, cb.batches[0].size());
+  ASSERT_EQ(ToRawAddress(address1), cb.batches[0][0].first);
+  ASSERT_EQ(adv_data1, cb.batches[0][0].second);
+  ASSERT_EQ(ToRawAddress(address2), cb.batches[0][1].first);
+  ASSERT_EQ(adv_data2, cb.batches[0][1].second);
+  ASSERT_EQ(ToRawAddress(address1), cb.batches[0][2].first);
+  ASSERT_TRUE(cb.batches[0][2].second.empty());
+
+  // The next batch reuses the storage of the one delivered, without its
+  // results
+  on_scan_result(address2, adv_data2);
+  ASSERT_EQ(1UL, do_in_jni_thread_task_queue.size());
+  run_all_jni_thread_task();
+
+  ASSERT_EQ(2UL, cb.batches.size());
+  ASSERT_EQ(1UL, cb.batches[1].size());
+  ASSERT_EQ(ToRawAddress(address2), cb.batches[1][0].first);
+  ASSERT_EQ(adv_data2, cb.batches[1][0].second);
+
+  ble->RegisterCallbacks(scanning_callbacks);
+}
+
+TEST_F(MainShimTest, ScanResultBatch_Clear_keeps_offsets_of_next_results) {
+  const RawAddress address({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+  const std::vector<uint8_t> adv_data1 = {0x02, 0x01, 0x06};
+  const std::vector<uint8_t> adv_data2 = {0x03, 0x09, 'a', 'b'};
+
+  ScanResultBatch batch;
+  batch.Add({.bda = address}, adv_data1.data(), adv_data1.size());
+  batch.Add({.bda = address}, adv_data2.data(), adv_data2.size());
+  ASSERT_EQ(adv_data1.size(), batch.results()[1].adv_data_offset);
+
+  // A batch is cleared to be filled again by the scanning thread
+  batch.Clear();
+  ASSERT_TRUE(batch.empty());
+  batch.Add({.bda = address}, adv_data2.data(), adv_data2.size());
+  ASSERT_EQ(1UL, batch.size());
+  ASSERT_EQ(0UL, batch.results()[0].adv_data_offset);
+  ASSERT_EQ(adv_data2, batch.CopyAdvData(batch.results()[0]));
+}
+
+TEST_F(MainShimTest, PropertyCache_writes_again_after_device_removed) {
+  using PropertyCache = bluetooth::shim::BleScannerInterfaceImpl::PropertyCache;
+  const RawAddress address({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+  const PropertyCache::StorageProperties properties{BT_DEVICE_TYPE_BLE, BLE_ADDR_PUBLIC};
+
+  PropertyCache cache;
+  cache.init();
+  ASSERT_EQ(PropertyCache::StorageUpdate::kWriteNow,
+            cache.update_storage(address, properties, 0));
+  ASSERT_EQ(PropertyCache::StorageUpdate::kSuppressed,
+            cache.update_storage(address, properties, 10));
+  ASSERT_TRUE(cache.update_class(address, kDevClassEmpty, BT_DEVICE_TYPE_BLE));
+  ASSERT_FALSE(cache.update_class(address, kDevClassEmpty, BT_DEVICE_TYPE_BLE));
+
+  // The device is unbonded: its section is removed from storage
+  cache.forget(address);
+  ASSERT_EQ(PropertyCache::StorageUpdate::kWriteNow,
+            cache.update_storage(address, properties, 20));
+  ASSERT_TRUE(cache.update_class(address, kDevClassEmpty, BT_DEVICE_TYPE_BLE));
+}
+
+TEST_F(MainShimTest, forget_remote_properties_runs_on_jni_thread) {
+  bluetooth::shim::get_ble_scanner_instance();
+  const size_t queued = do_in_jni_thread_task_queue.size();
+  bluetooth::shim::forget_remote_properties(RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x66}));
+  ASSERT_EQ(queued + 1, do_in_jni_thread_task_queue.size());
+  run_all_jni_thread_task();
+}
+
 TEST_F(MainShimTest, DISABLED_LeShimAclConnection_local_disconnect) {
   auto acl = MakeAcl();
   EXPECT_CALL(*test::mock_acl_manager_, CreateLeConnection(_, _)).Times(1);
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Process wide registry of counters and histograms that are cheap enough to be
+// updated from the packet paths.
+//
+// Every metric gets a fixed slot id when it is registered. Each thread that
+// updates a metric owns a cache line aligned block with one relaxed atomic per
+// slot, so updates never take a lock and never contend with other threads.
+// Readers sum the blocks of all threads; they are expected to do so
+// periodically (e.g. from an alarm), not per update.
+namespace metrics_registry {
+
+using MetricId = uint16_t;
+
+// Total number of slots. A counter takes one slot, a histogram one per bucket.
+constexpr size_t kMaxSlots = 512;
+
+namespace internal {
+
+struct alignas(64) ThreadSlots {
+  std::atomic<int64_t> values[kMaxSlots];
+};
+
+extern thread_local ThreadSlots* thread_slots;
+
+// Allocates the slots of the calling thread, on its first update.
+ThreadSlots* AttachThread();
+
+inline std::atomic<int64_t>& Slot(MetricId id) {
+  ThreadSlots* slots = thread_slots;
+  if (slots == nullptr) {
+    slots = AttachThread();
+  }
+  return slots->values[id];
+}
+
+}  // namespace internal
+
+// Registers the counter |name| and returns its slot. Registering a name that
+// already exists returns the existing slot. Aborts if the registry is full.
+MetricId RegisterCounter(const std::string& name);
+
+// Registers the histogram |name| with the given ascending bucket upper bounds
+// and returns its first slot. Values above the last bound go to an extra
+// overflow bucket, so the histogram takes |upper_bounds.size() + 1| slots.
+MetricId RegisterHistogram(const std::string& name, const std::vector<int64_t>& upper_bounds);
+
+// Adds |value| to the calling thread's share of the counter |id|.
+inline void Add(MetricId id, int64_t value) {
+  internal::Slot(id).fetch_add(value, std::memory_order_relaxed);
+}
+
+// Same as Add(), but saturates at INT64_MAX instead of overflowing. Returns
+// false if the calling thread's share of the counter saturated.
+bool AddSaturating(MetricId id, int64_t value);
+
+// Returns the sum of all the threads' shares of the counter |id|.
+int64_t Read(MetricId id);
+
+// Returns the sum of all the threads' shares of the counter |id| and resets
+// them, without losing concurrent updates. Sums saturate at INT64_MAX.
+int64_t Drain(MetricId id);
+
+// Returns the name of a registered counter or histogram.
+std::string GetName(MetricId id);
+
+// A counter registered once, typically as a static.
+class Counter {
+public:
+  explicit Counter(const std::string& name) : id_(RegisterCounter(name)) {}
+
+  void Add(int64_t value) const { metrics_registry::Add(id_, value); }
+  void Increment() const { Add(1); }
+  int64_t Read() const { return metrics_registry::Read(id_); }
+  int64_t Drain() const { return metrics_registry::Drain(id_); }
+  MetricId id() const { return id_; }
+
+private:
+  MetricId id_;
+};
+
+// A histogram registered once, typically as a static.
+class Histogram {
+public:
+  Histogram(const std::string& name, std::vector<int64_t> upper_bounds)
+      : id_(RegisterHistogram(name, upper_bounds)), upper_bounds_(std::move(upper_bounds)) {}
+
+  // Counts |value| in the first bucket whose upper bound is >= |value|.
+  void Record(int64_t value) const {
+    auto bucket = std::lower_bound(upper_bounds_.begin(), upper_bounds_.end(), value) -
+                  upper_bounds_.begin();
+    metrics_registry::Add(id_ + bucket, 1);
+  }
+
+  // Returns the count of each bucket, the overflow bucket last.
+  std::vector<int64_t> Read() const;
+  std::vector<int64_t> Drain() const;
+
+  const std::vector<int64_t>& upper_bounds() const { return upper_bounds_; }
+  // Slot of the first bucket.
+  MetricId id() const { return id_; }
+
+private:
+  MetricId id_;
+  std::vector<int64_t> upper_bounds_;
+};
+
+}  // namespace metrics_registry
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "metrics_registry"
+
+#include "osi/include/metrics_registry.h"
+
+#include <bluetooth/log.h>
+
+#include <limits>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+using namespace bluetooth;
+
+namespace metrics_registry {
+namespace internal {
+
+thread_local ThreadSlots* thread_slots = nullptr;
+
+}  // namespace internal
+
+namespace {
+
+using internal::ThreadSlots;
+
+int64_t SaturatingAdd(int64_t a, int64_t b) {
+  int64_t sum;
+  if (__builtin_add_overflow(a, b, &sum)) {
+    return b > 0 ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min();
+  }
+  return sum;
+}
+
+struct Registry {
+  std::mutex mutex;
+  // Name of each allocated slot; histogram buckets are named after their bound.
+  std::vector<std::string> slot_names;
+  std::unordered_map<std::string, MetricId> ids;
+  std::set<ThreadSlots*> threads;
+  // Shares of the threads that exited since the last drain.
+  int64_t retired[kMaxSlots] = {};
+};
+
+// Never destroyed, threads may still exit after static destructors ran.
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+MetricId AllocateSlots(Registry& registry, const std::string& name, size_t num_slots) {
+  log::assert_that(registry.slot_names.size() + num_slots <= kMaxSlots,
+                   "No slot left to register {}", name);
+  MetricId id = registry.slot_names.size();
+  registry.ids[name] = id;
+  return id;
+}
+
+// Folds the slots of the thread into the retired shares when it exits.
+struct ThreadSlotsOwner {
+  ThreadSlots* slots = nullptr;
+
+  ~ThreadSlotsOwner() {
+    if (slots == nullptr) {
+      return;
+    }
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t id = 0; id < kMaxSlots; id++) {
+      registry.retired[id] = SaturatingAdd(registry.retired[id],
+                                           slots->values[id].load(std::memory_order_relaxed));
+    }
+    registry.threads.erase(slots);
+    internal::thread_slots = nullptr;
+    delete slots;
+  }
+};
+
+thread_local ThreadSlotsOwner thread_slots_owner;
+
+}  // namespace
+
+namespace internal {
+
+ThreadSlots* AttachThread() {
+  auto slots = new ThreadSlots();
+  Registry& registry = GetRegistry();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.threads.insert(slots);
+  }
+  thread_slots_owner.slots = slots;
+  thread_slots = slots;
+  return slots;
+}
+
+}  // namespace internal
+
+MetricId RegisterCounter(const std::string& name) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto it = registry.ids.find(name);
+  if (it != registry.ids.end()) {
+    return it->second;
+  }
+  MetricId id = AllocateSlots(registry, name, 1);
+  registry.slot_names.push_back(name);
+  return id;
+}
+
+MetricId RegisterHistogram(const std::string& name, const std::vector<int64_t>& upper_bounds) {
+  log::assert_that(std::is_sorted(upper_bounds.begin(), upper_bounds.end()),
+                   "Bounds of histogram {} are not sorted", name);
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto it = registry.ids.find(name);
+  if (it != registry.ids.end()) {
+    return it->second;
+  }
+  MetricId id = AllocateSlots(registry, name, upper_bounds.size() + 1);
+  for (int64_t upper_bound : upper_bounds) {
+    registry.slot_names.push_back(name + "[<=" + std::to_string(upper_bound) + "]");
+  }
+  registry.slot_names.push_back(name + "[overflow]");
+  return id;
+}
+
+bool AddSaturating(MetricId id, int64_t value) {
+  auto& slot = internal::Slot(id);
+  int64_t current = slot.load(std::memory_order_relaxed);
+  while (true) {
+    if (std::numeric_limits<int64_t>::max() - current < value) {
+      if (slot.compare_exchange_weak(current, std::numeric_limits<int64_t>::max(),
+                                     std::memory_order_relaxed)) {
+        return false;
+      }
+    } else if (slot.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+int64_t Read(MetricId id) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  int64_t sum = registry.retired[id];
+  for (ThreadSlots* slots : registry.threads) {
+    sum = SaturatingAdd(sum, slots->values[id].load(std::memory_order_relaxed));
+  }
+  return sum;
+}
+
+int64_t Drain(MetricId id) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  int64_t sum = registry.retired[id];
+  registry.retired[id] = 0;
+  for (ThreadSlots* slots : registry.threads) {
+    sum = SaturatingAdd(sum, slots->values[id].exchange(0, std::memory_order_relaxed));
+  }
+  return sum;
+}
+
+std::string GetName(MetricId id) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return id < registry.slot_names.size() ? registry.slot_names[id] : std::string();
+}
+
+std::vector<int64_t> Histogram::Read() const {
+  std::vector<int64_t> counts;
+  for (size_t bucket = 0; bucket <= upper_bounds_.size(); bucket++) {
+    counts.push_back(metrics_registry::Read(id_ + bucket));
+  }
+  return counts;
+}
+
+std::vector<int64_t> Histogram::Drain() const {
+  std::vector<int64_t> counts;
+  for (size_t bucket = 0; bucket <= upper_bounds_.size(); bucket++) {
+    counts.push_back(metrics_registry::Drain(id_ + bucket));
+  }
+  return counts;
+}
+
+}  // namespace metrics_registry
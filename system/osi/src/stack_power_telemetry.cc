@@ -29,6 +29,7 @@
 #include <mutex>
 
 #include "os/log.h"
+#include "osi/include/metrics_registry.h"
 #include "osi/include/properties.h"
 #include "stack/include/acl_api_types.h"
 #include "stack/include/bt_psm_types.h"
@@ -48,6 +49,15 @@ constexpr std::string_view kLogPerChannelProperty =
 constexpr std::string_view kPowerTelemetryEnabledProperty = "bluetooth.powertelemetry.enabled";
 bool power_telemerty_enabled_ = false;
 
+// Updated for every ACL packet and HCI command / event, so they are kept in per-thread counters
+// and only folded into the current LogDataContainer when the traffic data is logged.
+const metrics_registry::Counter kAclRxPackets("power_telemetry.acl_rx_packets");
+const metrics_registry::Counter kAclRxBytes("power_telemetry.acl_rx_bytes");
+const metrics_registry::Counter kAclTxPackets("power_telemetry.acl_tx_packets");
+const metrics_registry::Counter kAclTxBytes("power_telemetry.acl_tx_bytes");
+const metrics_registry::Counter kHciCommands("power_telemetry.hci_commands");
+const metrics_registry::Counter kHciEvents("power_telemetry.hci_events");
+
 std::string GetTimeString(time_t tstamp) {
   char buffer[15];
   tm* nTm = localtime(&tstamp);
@@ -110,7 +120,7 @@ struct ChannelDetails {
 
 struct AclPacketDetails {
   struct {
-    uint32_t pkt_count = 0;
+    int64_t pkt_count = 0;
     int64_t byte_count = 0;
   } rx, tx;
 };
@@ -168,30 +178,34 @@ struct power_telemetry::PowerTelemetryImpl {
     }
   }
 
+  // Called from the packet paths, which only update the registry counters: the lock is only
+  // taken when the traffic log is due, and LogDataTransfer() drains the counters into it.
+  void maybe_log_traffic_data() {
+    if ((get_current_time() - traffic_logged_ts_.load(std::memory_order_relaxed)) <
+        kTrafficLogTime) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+    maybe_log_data();
+  }
+
   void LogDataTransfer();
   void RecordLogDataContainer();
 
   mutable std::mutex dumpsys_mutex_;
   LogDataContainer log_data_containers_[kLogEntriesSize];
   std::atomic_int idx_containers;
-  time_t traffic_logged_ts_ = 0;
+  std::atomic<time_t> traffic_logged_ts_ = 0;
   struct {
     struct {
       int64_t bytes_ = 0;
     } rx, tx;
   } l2c, rfc;
-  struct {
-    uint32_t pkt_ = 0;
-    int64_t len_ = 0;
-  } rx, tx;
 
   struct {
     uint16_t count_ = 0;
   } scan, inq_scan, ble_adv, ble_scan;
 
-  struct {
-    uint32_t count_ = 0;
-  } cmd, event;
   bool scan_timer_started_ = false;
   bool log_per_channel_ = false;
   bool power_telemetry_enabled_property_ = false;
@@ -246,34 +260,38 @@ void power_telemetry::PowerTelemetryImpl::LogDataTransfer() {
     inq_scan.count_ = 0;
   }
 
-  if ((rx.pkt_ != 0) || (tx.pkt_ != 0)) {
+  const int64_t rx_pkt_count = kAclRxPackets.Drain();
+  const int64_t tx_pkt_count = kAclTxPackets.Drain();
+  const int64_t rx_byte_count = kAclRxBytes.Drain();
+  const int64_t tx_byte_count = kAclTxBytes.Drain();
+  if ((rx_pkt_count != 0) || (tx_pkt_count != 0)) {
     ldc.acl_pkt_ds = {
             .rx =
                     {
-                            .pkt_count = rx.pkt_,
-                            .byte_count = rx.len_,
+                            .pkt_count = rx_pkt_count,
+                            .byte_count = rx_byte_count,
                     },
             .tx =
                     {
-                            .pkt_count = tx.pkt_,
-                            .byte_count = tx.len_,
+                            .pkt_count = tx_pkt_count,
+                            .byte_count = tx_byte_count,
                     },
     };
-    rx.pkt_ = tx.pkt_ = rx.len_ = tx.len_ = 0;
   }
 
-  if ((cmd.count_ != 0) || (event.count_ != 0)) {
+  const int64_t cmd_count = kHciCommands.Drain();
+  const int64_t event_count = kHciEvents.Drain();
+  if ((cmd_count != 0) || (event_count != 0)) {
     ldc.hci_cmd_evt_ds = {
             .rx =
                     {
-                            .pkt_count = event.count_,
+                            .pkt_count = event_count,
                     },
             .tx =
                     {
-                            .pkt_count = cmd.count_,
+                            .pkt_count = cmd_count,
                     },
     };
-    cmd.count_ = event.count_ = 0;
   }
 
   if (ble_scan.count_ != 0) {
@@ -448,9 +466,8 @@ void power_telemetry::PowerTelemetry::LogHciCmdDetail() {
     return;
   }
 
-  std::lock_guard<std::mutex> lock(pimpl_->dumpsys_mutex_);
-  pimpl_->cmd.count_++;
-  pimpl_->maybe_log_data();
+  kHciCommands.Increment();
+  pimpl_->maybe_log_traffic_data();
 }
 
 void power_telemetry::PowerTelemetry::LogHciEvtDetail() {
@@ -458,9 +475,8 @@ void power_telemetry::PowerTelemetry::LogHciEvtDetail() {
     return;
   }
 
-  std::lock_guard<std::mutex> lock(pimpl_->dumpsys_mutex_);
-  pimpl_->event.count_++;
-  pimpl_->maybe_log_data();
+  kHciEvents.Increment();
+  pimpl_->maybe_log_traffic_data();
 }
 
 void power_telemetry::PowerTelemetry::LogSniffStarted(uint16_t handle, const RawAddress& bd_addr) {
@@ -522,10 +538,9 @@ void power_telemetry::PowerTelemetry::LogTxAclPktData(uint16_t len) {
     return;
   }
 
-  std::lock_guard<std::mutex> lock(pimpl_->dumpsys_mutex_);
-  pimpl_->tx.pkt_++;
-  pimpl_->tx.len_ += len;
-  pimpl_->maybe_log_data();
+  kAclTxPackets.Increment();
+  kAclTxBytes.Add(len);
+  pimpl_->maybe_log_traffic_data();
 }
 
 void power_telemetry::PowerTelemetry::LogRxAclPktData(uint16_t len) {
@@ -533,10 +548,9 @@ void power_telemetry::PowerTelemetry::LogRxAclPktData(uint16_t len) {
     return;
   }
 
-  std::lock_guard<std::mutex> lock(pimpl_->dumpsys_mutex_);
-  pimpl_->rx.pkt_++;
-  pimpl_->rx.len_ += len;
-  pimpl_->maybe_log_data();
+  kAclRxPackets.Increment();
+  kAclRxBytes.Add(len);
+  pimpl_->maybe_log_traffic_data();
 }
 
 void power_telemetry::PowerTelemetry::LogChannelConnected(uint16_t psm, int32_t src_id,
@@ -672,6 +686,15 @@ void power_telemetry::PowerTelemetry::LogRxBytes(uint16_t psm, int32_t src_id, i
   pimpl_->maybe_log_data();
 }
 
+void power_telemetry::PowerTelemetry::LogTrafficData() {
+  if (!power_telemerty_enabled_) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(pimpl_->dumpsys_mutex_);
+  pimpl_->maybe_log_data();
+}
+
 void power_telemetry::PowerTelemetry::Dumpsys(int32_t fd) {
   if (!power_telemerty_enabled_) {
     return;
@@ -707,10 +730,10 @@ void power_telemetry::PowerTelemetry::Dumpsys(int32_t fd) {
     if ((ldc.acl_pkt_ds.tx.byte_count == 0) && (ldc.acl_pkt_ds.rx.byte_count == 0)) {
       continue;
     }
-    dprintf(fd, "%-22s %-22s %-12d %-12ld %-12d %-12ld\n",
+    dprintf(fd, "%-22s %-22s %-12ld %-12ld %-12ld %-12ld\n",
             GetTimeString(ldc.lifetime.begin).c_str(), GetTimeString(ldc.lifetime.end).c_str(),
-            ldc.acl_pkt_ds.tx.pkt_count, (long)ldc.acl_pkt_ds.tx.byte_count,
-            ldc.acl_pkt_ds.rx.pkt_count, (long)ldc.acl_pkt_ds.rx.byte_count);
+            (long)ldc.acl_pkt_ds.tx.pkt_count, (long)ldc.acl_pkt_ds.tx.byte_count,
+            (long)ldc.acl_pkt_ds.rx.pkt_count, (long)ldc.acl_pkt_ds.rx.byte_count);
   }
 
   dprintf(fd, "\nHCI CMD/EVT Details:\n");
@@ -720,9 +743,9 @@ void power_telemetry::PowerTelemetry::Dumpsys(int32_t fd) {
     if ((ldc.hci_cmd_evt_ds.tx.pkt_count == 0) && (ldc.hci_cmd_evt_ds.rx.pkt_count == 0)) {
       continue;
     }
-    dprintf(fd, "%-22s %-22s %-14d %-14d\n", GetTimeString(ldc.lifetime.begin).c_str(),
-            GetTimeString(ldc.lifetime.end).c_str(), ldc.hci_cmd_evt_ds.tx.pkt_count,
-            ldc.hci_cmd_evt_ds.rx.pkt_count);
+    dprintf(fd, "%-22s %-22s %-14ld %-14ld\n", GetTimeString(ldc.lifetime.begin).c_str(),
+            GetTimeString(ldc.lifetime.end).c_str(), (long)ldc.hci_cmd_evt_ds.tx.pkt_count,
+            (long)ldc.hci_cmd_evt_ds.rx.pkt_count);
   }
   dprintf(fd, "\nBLE Scan Details:\n");
   dprintf(fd, "%-22s %-22s %-14s\n", "StartTimeStamp", "EndTimeStamp", "Number of scans");
@@ -0,0 +1,79 @@
+#include "osi/include/metrics_registry.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using metrics_registry::Counter;
+using metrics_registry::Histogram;
+
+TEST(MetricsRegistryTest, test_register_twice) {
+  Counter counter("test_register_twice");
+  Counter same_counter("test_register_twice");
+  Counter other_counter("test_register_twice_other");
+  EXPECT_EQ(counter.id(), same_counter.id());
+  EXPECT_NE(counter.id(), other_counter.id());
+  EXPECT_EQ("test_register_twice", metrics_registry::GetName(counter.id()));
+}
+
+TEST(MetricsRegistryTest, test_add_and_drain) {
+  Counter counter("test_add_and_drain");
+  counter.Increment();
+  counter.Add(41);
+  EXPECT_EQ(42, counter.Read());
+  EXPECT_EQ(42, counter.Drain());
+  EXPECT_EQ(0, counter.Read());
+  counter.Add(3);
+  EXPECT_EQ(3, counter.Drain());
+}
+
+TEST(MetricsRegistryTest, test_add_from_threads) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumIncrements = 10000;
+  Counter counter("test_add_from_threads");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&counter] {
+      for (int j = 0; j < kNumIncrements; j++) {
+        counter.Increment();
+      }
+    });
+  }
+  // Drain concurrently with the updates, nothing may be lost.
+  int64_t total = 0;
+  for (int i = 0; i < 100; i++) {
+    total += counter.Drain();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // The shares of the exited threads are retired, not dropped.
+  total += counter.Drain();
+  EXPECT_EQ(kNumThreads * kNumIncrements, total);
+}
+
+TEST(MetricsRegistryTest, test_add_saturating) {
+  Counter counter("test_add_saturating");
+  EXPECT_TRUE(metrics_registry::AddSaturating(counter.id(), INT64_MAX - 1));
+  EXPECT_TRUE(metrics_registry::AddSaturating(counter.id(), 1));
+  EXPECT_FALSE(metrics_registry::AddSaturating(counter.id(), 1));
+  EXPECT_EQ(INT64_MAX, counter.Drain());
+  EXPECT_TRUE(metrics_registry::AddSaturating(counter.id(), 1));
+  EXPECT_EQ(1, counter.Drain());
+}
+
+TEST(MetricsRegistryTest, test_histogram) {
+  Histogram histogram("test_histogram", {10, 100});
+  histogram.Record(-1);
+  histogram.Record(10);
+  histogram.Record(11);
+  histogram.Record(100);
+  histogram.Record(101);
+  histogram.Record(1000);
+  EXPECT_EQ((std::vector<int64_t>{2, 2, 2}), histogram.Read());
+  EXPECT_EQ((std::vector<int64_t>{2, 2, 2}), histogram.Drain());
+  EXPECT_EQ((std::vector<int64_t>{0, 0, 0}), histogram.Read());
+  EXPECT_EQ("test_histogram[<=10]", metrics_registry::GetName(histogram.id()));
+}
@@ -165,13 +165,13 @@ TEST_F(PowerTelemetryTest, test_LogHciCmdEvtDetails) {
 
   // After log hci_cmd, the number of it should be 1
   power_telemetry::GetInstance().LogHciCmdDetail();
-  ASSERT_EQ(1, (int)power_telemetry::GetInstance().pimpl_->cmd.count_);
-  ASSERT_EQ(0, (int)power_telemetry::GetInstance().pimpl_->event.count_);
+  ASSERT_EQ(1, (int)kHciCommands.Read());
+  ASSERT_EQ(0, (int)kHciEvents.Read());
 
   // After log hci_evt, the number of it should be 1
   power_telemetry::GetInstance().LogHciEvtDetail();
-  ASSERT_EQ(1, (int)power_telemetry::GetInstance().pimpl_->cmd.count_);
-  ASSERT_EQ(1, (int)power_telemetry::GetInstance().pimpl_->event.count_);
+  ASSERT_EQ(1, (int)kHciCommands.Read());
+  ASSERT_EQ(1, (int)kHciEvents.Read());
 }
 
 TEST_F(PowerTelemetryTest, test_LogSniffActivity) {
@@ -207,12 +207,47 @@ TEST_F(PowerTelemetryTest, test_LogAclPktDetails) {
 
   // scanCount should be 1
   power_telemetry::GetInstance().LogTxAclPktData(10);
-  ASSERT_EQ(1, (int)power_telemetry::GetInstance().pimpl_->tx.pkt_);
-  ASSERT_EQ(10, (int)power_telemetry::GetInstance().pimpl_->tx.len_);
+  ASSERT_EQ(1, (int)kAclTxPackets.Read());
+  ASSERT_EQ(10, (int)kAclTxBytes.Read());
 
   power_telemetry::GetInstance().LogRxAclPktData(11);
-  ASSERT_EQ(1, (int)power_telemetry::GetInstance().pimpl_->rx.pkt_);
-  ASSERT_EQ(11, (int)power_telemetry::GetInstance().pimpl_->rx.len_);
+  ASSERT_EQ(1, (int)kAclRxPackets.Read());
+  ASSERT_EQ(11, (int)kAclRxBytes.Read());
+}
+
+TEST_F(PowerTelemetryTest, test_LogTrafficData) {
+  reset();
+
+  power_telemetry::GetInstance().LogTxAclPktData(10);
+  power_telemetry::GetInstance().LogHciCmdDetail();
+
+  // Nothing is logged before kTrafficLogTime elapsed
+  power_telemetry::GetInstance().LogTrafficData();
+  ASSERT_EQ(0, (int)power_telemetry::GetInstance().pimpl_->idx_containers);
+
+  power_telemetry::GetInstance().pimpl_->traffic_logged_ts_ -= kTrafficLogTime;
+  power_telemetry::GetInstance().LogTrafficData();
+  ASSERT_EQ(1, (int)power_telemetry::GetInstance().pimpl_->idx_containers);
+  LogDataContainer& ldc = power_telemetry::GetInstance().pimpl_->log_data_containers_[0];
+  ASSERT_EQ(1, (int)ldc.acl_pkt_ds.tx.pkt_count);
+  ASSERT_EQ(10, (int)ldc.acl_pkt_ds.tx.byte_count);
+  ASSERT_EQ(1, (int)ldc.hci_cmd_evt_ds.tx.pkt_count);
+  ASSERT_EQ(0, (int)kAclTxPackets.Read());
+  ASSERT_EQ(0, (int)kHciCommands.Read());
+}
+
+TEST_F(PowerTelemetryTest, test_packet_logs_traffic_data_when_due) {
+  reset();
+
+  power_telemetry::GetInstance().LogRxAclPktData(10);
+  ASSERT_EQ(0, (int)power_telemetry::GetInstance().pimpl_->idx_containers);
+
+  power_telemetry::GetInstance().pimpl_->traffic_logged_ts_ -= kTrafficLogTime;
+  power_telemetry::GetInstance().LogHciEvtDetail();
+  ASSERT_EQ(1, (int)power_telemetry::GetInstance().pimpl_->idx_containers);
+  LogDataContainer& ldc = power_telemetry::GetInstance().pimpl_->log_data_containers_[0];
+  ASSERT_EQ(1, (int)ldc.acl_pkt_ds.rx.pkt_count);
+  ASSERT_EQ(1, (int)ldc.hci_cmd_evt_ds.rx.pkt_count);
 }
 
 TEST_F(PowerTelemetryTest, test_LogChannelConnected) {
@@ -294,10 +329,10 @@ TEST_F(PowerTelemetryTest, test_feature_flag) {
   ASSERT_EQ(0, (int)ldc.channel_map.count(bdaddr));
 
   power_telemetry::GetInstance().LogTxAclPktData(10);
-  ASSERT_EQ(0, (int)power_telemetry::GetInstance().pimpl_->tx.pkt_);
+  ASSERT_EQ(0, (int)kAclTxPackets.Read());
 
   power_telemetry::GetInstance().LogRxAclPktData(11);
-  ASSERT_EQ(0, (int)power_telemetry::GetInstance().pimpl_->rx.pkt_);
+  ASSERT_EQ(0, (int)kAclRxPackets.Read());
 
   power_telemetry::GetInstance().LogScanStarted();
   ASSERT_EQ(0, (int)power_telemetry::GetInstance().pimpl_->scan.count_);
@@ -309,10 +344,10 @@ TEST_F(PowerTelemetryTest, test_feature_flag) {
   ASSERT_EQ(0, (int)ldc.sniff_activity_map[handle].sniff_count);
 
   power_telemetry::GetInstance().LogHciCmdDetail();
-  ASSERT_EQ(0, (int)power_telemetry::GetInstance().pimpl_->cmd.count_);
+  ASSERT_EQ(0, (int)kHciCommands.Read());
 
   power_telemetry::GetInstance().LogHciEvtDetail();
-  ASSERT_EQ(0, (int)power_telemetry::GetInstance().pimpl_->event.count_);
+  ASSERT_EQ(0, (int)kHciEvents.Read());
 
   power_telemetry::GetInstance().LogLinkDetails(handle, bdaddr, isConnected, false);
   ASSERT_EQ(0, (int)ldc.sco.link_details_map.count(handle));
@@ -54,6 +54,9 @@ typedef struct {
   uint32_t frame_length;         // Samples per channel in a frame
   uint8_t input_channels_n;      // Number of channels
   int max_encoded_buffer_bytes;  // Max encoded bytes per frame
+  bool is_constant_bit_rate;
+  int configured_bit_rate;  // Bit rate at the full rate
+  int bit_rate;             // Current bit rate
 } tA2DP_AAC_ENCODER_PARAMS;
 
 typedef struct {
@@ -72,6 +75,8 @@ typedef struct {
   size_t media_read_total_dropped_packets;
   size_t media_read_total_actual_reads_count;
   size_t media_read_total_actual_read_bytes;
+
+  size_t bit_rate_adjustments;
 } a2dp_aac_encoder_stats_t;
 
 typedef struct {
@@ -273,6 +278,8 @@ static void a2dp_aac_encoder_update(A2dpCodecConfig* a2dp_codec_config, bool* p_
                aac_error);
     return;  // TODO: Return an error?
   }
+  p_encoder_params->configured_bit_rate = aac_param_value;
+  p_encoder_params->bit_rate = aac_param_value;
 
   // Set the encoder's parameters: PEAK Bit Rate
   aac_error = aacEncoder_SetParam(a2dp_aac_encoder_cb.aac_handle, AACENC_PEAK_BITRATE,
@@ -344,6 +351,7 @@ static void a2dp_aac_encoder_update(A2dpCodecConfig* a2dp_codec_config, bool* p_
     aac_param_value = static_cast<uint8_t>(bitrate_mode) & ~A2DP_AAC_VARIABLE_BIT_RATE_MASK;
   }
   log::info("AACENC_BITRATEMODE: {}", aac_param_value);
+  p_encoder_params->is_constant_bit_rate = aac_param_value == A2DP_AAC_VARIABLE_BIT_RATE_DISABLED;
   aac_error =
           aacEncoder_SetParam(a2dp_aac_encoder_cb.aac_handle, AACENC_BITRATEMODE, aac_param_value);
   if (aac_error != AACENC_OK) {
@@ -440,6 +448,29 @@ void a2dp_aac_send_frames(uint64_t timestamp_us) {
   }
 }
 
+void a2dp_aac_set_target_rate(uint16_t rate_per_mille) {
+  tA2DP_AAC_ENCODER_PARAMS* p_encoder_params = &a2dp_aac_encoder_cb.aac_encoder_params;
+  // The encoder ignores the bitrate in VBR mode.
+  if (!a2dp_aac_encoder_cb.has_aac_handle || !p_encoder_params->is_constant_bit_rate) {
+    return;
+  }
+  int bit_rate = p_encoder_params->configured_bit_rate * rate_per_mille / 1000;
+  if (bit_rate == p_encoder_params->bit_rate) {
+    return;
+  }
+
+  AACENC_ERROR aac_error =
+          aacEncoder_SetParam(a2dp_aac_encoder_cb.aac_handle, AACENC_BITRATE, bit_rate);
+  if (aac_error != AACENC_OK) {
+    log::warn("Cannot set AAC parameter AACENC_BITRATE to {}: AAC error 0x{:x}", bit_rate,
+              aac_error);
+    return;
+  }
+  log::verbose("bit rate {} -> {}", p_encoder_params->bit_rate, bit_rate);
+  p_encoder_params->bit_rate = bit_rate;
+  a2dp_aac_encoder_cb.stats.bit_rate_adjustments++;
+}
+
 // Obtains the number of frames to send and number of iterations
 // to be used. |num_of_iterations| and |num_of_frames| parameters
 // are used as output param for returning the respective values.
@@ -660,6 +691,12 @@ void A2dpCodecConfigAacSource::debug_codec_dump(int fd) {
           "(0x%" PRIx64 ")\n",
           ((codec_specific_1 & ~A2DP_AAC_VARIABLE_BIT_RATE_MASK) == 0 ? "Constant" : "Variable"),
           codec_specific_1);
+  if (a2dp_aac_encoder_cb.aac_encoder_params.is_constant_bit_rate) {
+    dprintf(fd, "  AAC bitrate (current/configured/adjustments)            : %d / %d / %zu\n",
+            a2dp_aac_encoder_cb.aac_encoder_params.bit_rate,
+            a2dp_aac_encoder_cb.aac_encoder_params.configured_bit_rate,
+            stats->bit_rate_adjustments);
+  }
   dprintf(fd, "  Encoder interval (ms): %" PRIu64 "\n", a2dp_aac_get_encoder_interval_ms());
   dprintf(fd, "  Effective MTU: %d\n", a2dp_aac_get_effective_frame_size());
   dprintf(fd,
@@ -253,6 +253,10 @@ void a2dp_aac_send_frames(uint64_t timestamp_us) {
   }
 }
 
+// The MMC encoder is configured once per session and cannot change its bitrate
+// while streaming.
+void a2dp_aac_set_target_rate(uint16_t /* rate_per_mille */) {}
+
 // Obtains the number of frames to send and number of iterations
 // to be used. |num_of_iterations| and |num_of_frames| parameters
 // are used as output param for returning the respective values.
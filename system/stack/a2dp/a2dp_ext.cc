@@ -90,6 +90,7 @@ tA2DP_ENCODER_INTERFACE const a2dp_encoder_interface_ext = {
         .get_effective_frame_size = []() { return 0; },
         .send_frames = [](uint64_t) {},
         .set_transmit_queue_length = [](size_t) {},
+        .set_target_rate = nullptr,
 };
 
 const tA2DP_ENCODER_INTERFACE* A2DP_GetEncoderInterfaceExt(const uint8_t*) {
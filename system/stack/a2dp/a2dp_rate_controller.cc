@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "bluetooth-a2dp"
+
+#include "a2dp_rate_controller.h"
+
+#include <bluetooth/log.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+using namespace bluetooth;
+
+namespace {
+
+// The rate steps down multiplicatively as soon as the link falls behind, at
+// most once per hold period so the lower rate has time to drain the queue.
+constexpr uint64_t kDecreaseHoldUs = 200 * 1000;
+constexpr uint16_t kDecreaseNumerator = 3;
+constexpr uint16_t kDecreaseDenominator = 4;
+
+// It steps back up additively once the link has kept up for the whole hold
+// period, twice as long when the signal faded since the full rate.
+constexpr uint64_t kIncreaseHoldUs = 2 * 1000 * 1000;
+constexpr uint16_t kIncreaseStep = 100;
+
+// The link is congested when the queue fills past a quarter of its limit, or
+// when it has not taken a packet for that many encoder ticks.
+constexpr size_t kCongestedQueueFraction = 4;
+constexpr uint64_t kCongestedStallTicks = 3;
+
+constexpr int kFadeDb = 6;
+
+}  // namespace
+
+void A2dpRateController::Reset(uint64_t encoder_interval_ms, SetTargetRate set_target_rate) {
+  *this = A2dpRateController();
+  set_target_rate_ = set_target_rate;
+  interval_us_ = encoder_interval_ms * 1000;
+  stats_.min_rate = kA2dpRateFull;
+  if (active()) {
+    set_target_rate_(rate_);
+  }
+}
+
+uint16_t A2dpRateController::OnTick(const LinkSample& sample) {
+  // Encoders without a rate, or adapting it on their own, are left alone.
+  if (!active()) {
+    return rate_;
+  }
+
+  stats_.ticks++;
+  if (stats_.ticks > 1 && rate_ < kA2dpRateFull) {
+    stats_.reduced_rate_us += sample.timestamp_us - last_tick_us_;
+  }
+  last_tick_us_ = sample.timestamp_us;
+  stats_.max_stall_us = std::max(stats_.max_stall_us, sample.stall_us);
+
+  if (sample.rssi != kRssiUnknown) {
+    last_rssi_ = sample.rssi;
+    if (rate_ == kA2dpRateFull) {
+      reference_rssi_ = sample.rssi;
+    }
+  }
+
+  bool can_change = !changed_ || sample.timestamp_us - last_change_us_ >= kDecreaseHoldUs;
+  if (IsCongested(sample)) {
+    stats_.congested_ticks++;
+    clear_ = false;
+    if (rate_ > kMinRate && can_change) {
+      rate_ = std::max<uint16_t>(kMinRate, rate_ * kDecreaseNumerator / kDecreaseDenominator);
+      changed_ = true;
+      last_change_us_ = sample.timestamp_us;
+      stats_.decreases++;
+      stats_.min_rate = std::min(stats_.min_rate, rate_);
+      set_target_rate_(rate_);
+      log::verbose("queue_length={} stall_us={}, rate down to {}", sample.queue_length,
+                   sample.stall_us, rate_);
+    }
+    return rate_;
+  }
+
+  if (!IsClear(sample)) {
+    clear_ = false;
+    return rate_;
+  }
+  if (!clear_) {
+    clear_ = true;
+    clear_since_us_ = sample.timestamp_us;
+  }
+
+  uint64_t hold_us = IsFading() ? 2 * kIncreaseHoldUs : kIncreaseHoldUs;
+  if (rate_ < kA2dpRateFull && sample.timestamp_us - clear_since_us_ >= hold_us &&
+      sample.timestamp_us - last_change_us_ >= hold_us) {
+    rate_ = std::min<uint16_t>(kA2dpRateFull, rate_ + kIncreaseStep);
+    last_change_us_ = sample.timestamp_us;
+    stats_.increases++;
+    set_target_rate_(rate_);
+    log::verbose("link kept up for {} ms, rate up to {}", hold_us / 1000, rate_);
+  }
+  return rate_;
+}
+
+bool A2dpRateController::IsCongested(const LinkSample& sample) const {
+  return sample.queue_length * kCongestedQueueFraction > sample.queue_limit ||
+         sample.stall_us > kCongestedStallTicks * interval_us_;
+}
+
+bool A2dpRateController::IsClear(const LinkSample& sample) const {
+  return sample.queue_length <= 1 && sample.stall_us <= interval_us_;
+}
+
+bool A2dpRateController::IsFading() const {
+  return reference_rssi_ != kRssiUnknown && last_rssi_ != kRssiUnknown &&
+         reference_rssi_ - last_rssi_ >= kFadeDb;
+}
+
+void A2dpRateController::Dump(int fd) const {
+  dprintf(fd, "  Rate controller (current/min rate, per mille)           : %u / %u\n", rate_,
+          stats_.min_rate);
+  dprintf(fd, "  Rate controller ticks (total/congested)                 : %zu / %zu\n",
+          stats_.ticks, stats_.congested_ticks);
+  dprintf(fd, "  Rate controller changes (decreases/increases)           : %zu / %zu\n",
+          stats_.decreases, stats_.increases);
+  dprintf(fd, "  Rate controller time below full rate in ms              : %llu\n",
+          (unsigned long long)stats_.reduced_rate_us / 1000);
+  dprintf(fd, "  Rate controller max link stall in ms                    : %llu\n",
+          (unsigned long long)stats_.max_stall_us / 1000);
+  if (last_rssi_ != kRssiUnknown) {
+    dprintf(fd, "  Rate controller RSSI (last/reference)                   : %d / %d\n",
+            last_rssi_, reference_rssi_);
+  }
+}
@@ -25,6 +25,8 @@
 #include <limits.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "a2dp_sbc.h"
 #include "a2dp_sbc_up_sample.h"
 #include "common/time_util.h"
@@ -84,6 +86,8 @@ typedef struct {
 
   size_t media_read_total_expected_frames;
   size_t media_read_total_dropped_frames;
+
+  size_t bitpool_adjustments;
 } a2dp_sbc_encoder_stats_t;
 
 typedef struct {
@@ -91,6 +95,8 @@ typedef struct {
   a2dp_source_enqueue_callback_t enqueue_callback;
   uint16_t TxAaMtuSize;
   uint8_t tx_sbc_frames;
+  int16_t configured_bitpool; /* Bitpool at the full rate */
+  int16_t min_bitpool;        /* Lowest bitpool of the configuration */
   tA2DP_ENCODER_INIT_PEER_PARAMS peer_params;
   uint32_t timestamp; /* Timestamp for the A2DP frames */
   SBC_ENC_PARAMS sbc_encoder_params;
@@ -296,6 +302,8 @@ static void a2dp_sbc_encoder_update(A2dpCodecConfig* a2dp_codec_config, bool* p_
 
   /* Finally update the bitpool in the encoder structure */
   p_encoder_params->s16BitPool = s16BitPool;
+  a2dp_sbc_encoder_cb.configured_bitpool = s16BitPool;
+  a2dp_sbc_encoder_cb.min_bitpool = min_bitpool;
 
   log::info("final bit rate {}, final bit pool {}", p_encoder_params->u16BitRate,
             p_encoder_params->s16BitPool);
@@ -347,6 +355,24 @@ void a2dp_sbc_send_frames(uint64_t timestamp_us) {
   }
 }
 
+void a2dp_sbc_set_target_rate(uint16_t rate_per_mille) {
+  SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
+  int16_t bitpool =
+          static_cast<int16_t>(a2dp_sbc_encoder_cb.configured_bitpool * rate_per_mille / 1000);
+  bitpool = std::max(bitpool, a2dp_sbc_encoder_cb.min_bitpool);
+  bitpool = std::min(bitpool, a2dp_sbc_encoder_cb.configured_bitpool);
+  if (bitpool == p_encoder_params->s16BitPool) {
+    return;
+  }
+
+  // The bitpool is carried in the header of every SBC frame, so it can change
+  // between two frames without resetting the encoder.
+  log::verbose("bitpool {} -> {}", p_encoder_params->s16BitPool, bitpool);
+  p_encoder_params->s16BitPool = bitpool;
+  a2dp_sbc_encoder_cb.tx_sbc_frames = calculate_max_frames_per_packet();
+  a2dp_sbc_encoder_cb.stats.bitpool_adjustments++;
+}
+
 // Obtains the number of frames to send and number of iterations
 // to be used. |num_of_iterations| and |num_of_frames| parameters
 // are used as output param for returning the respective values.
@@ -823,6 +849,9 @@ void A2dpCodecConfigSbcSource::debug_codec_dump(int fd) {
     dprintf(fd, "  SBC Bitpool (min/max)                                   : %d / %d\n",
             A2DP_GetMinBitpoolSbc(codec_info), A2DP_GetMaxBitpoolSbc(codec_info));
   }
+  dprintf(fd, "  SBC Bitpool (current/configured/adjustments)            : %d / %d / %zu\n",
+          a2dp_sbc_encoder_cb.sbc_encoder_params.s16BitPool, a2dp_sbc_encoder_cb.configured_bitpool,
+          stats->bitpool_adjustments);
 
   dprintf(fd, "  Encoder interval (ms): %" PRIu64 "\n", a2dp_sbc_get_encoder_interval_ms());
   dprintf(fd, "  Effective MTU: %d\n", a2dp_sbc_get_effective_frame_size());
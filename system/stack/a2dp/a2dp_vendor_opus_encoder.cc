@@ -42,6 +42,8 @@ typedef struct {
   uint8_t quality_mode_index;
   int pcm_wlength;
   uint8_t pcm_fmt;
+  int configured_bitrate;  // Bitrate at the full rate
+  int target_bitrate;      // Bitrate last set on the encoder
 } tA2DP_OPUS_ENCODER_PARAMS;
 
 typedef struct {
@@ -60,6 +62,8 @@ typedef struct {
   size_t media_read_total_dropped_packets;
   size_t media_read_total_actual_reads_count;
   size_t media_read_total_actual_read_bytes;
+
+  size_t bitrate_adjustments;
 } a2dp_opus_encoder_stats_t;
 
 typedef struct {
@@ -209,6 +213,8 @@ static bool a2dp_vendor_opus_encoder_update(uint16_t peer_mtu, A2dpCodecConfig*
   p_encoder_params->channel_mode = A2DP_VendorGetChannelModeCodeOpus(p_codec_info);
   p_encoder_params->framesize = A2DP_VendorGetFrameSizeOpus(p_codec_info);
   p_encoder_params->bitrate = A2DP_VendorGetBitRateOpus(p_codec_info);
+  p_encoder_params->configured_bitrate = A2DP_VendorGetBitRateOpus(p_codec_info);
+  p_encoder_params->target_bitrate = p_encoder_params->configured_bitrate;
 
   a2dp_vendor_opus_feeding_reset();
 
@@ -301,6 +307,26 @@ void a2dp_vendor_opus_send_frames(uint64_t timestamp_us) {
   return;
 }
 
+void a2dp_vendor_opus_set_target_rate(uint16_t rate_per_mille) {
+  tA2DP_OPUS_ENCODER_PARAMS* p_encoder_params = &a2dp_opus_encoder_cb.opus_encoder_params;
+  if (!a2dp_opus_encoder_cb.has_opus_handle || a2dp_opus_encoder_cb.opus_handle == NULL) {
+    return;
+  }
+  int bitrate = p_encoder_params->configured_bitrate * rate_per_mille / 1000;
+  if (bitrate == p_encoder_params->target_bitrate) {
+    return;
+  }
+
+  int error = opus_encoder_ctl(a2dp_opus_encoder_cb.opus_handle, OPUS_SET_BITRATE(bitrate));
+  if (error != OPUS_OK) {
+    log::warn("failed to set encoder bitrate to {}", bitrate);
+    return;
+  }
+  log::verbose("bitrate {} -> {}", p_encoder_params->target_bitrate, bitrate);
+  p_encoder_params->target_bitrate = bitrate;
+  a2dp_opus_encoder_cb.stats.bitrate_adjustments++;
+}
+
 // Obtains the number of frames to send and number of iterations
 // to be used. |num_of_iterations| and |num_of_frames| parameters
 // are used as output param for returning the respective values.
@@ -483,6 +509,10 @@ void A2dpCodecConfigOpusSource::debug_codec_dump(int fd) {
   dprintf(fd, "  OPUS transmission bitrate (Kbps)                        : %d\n",
           p_encoder_params->bitrate);
 
+  dprintf(fd, "  OPUS target bitrate (current/configured/adjustments)    : %d / %d / %zu\n",
+          p_encoder_params->target_bitrate, p_encoder_params->configured_bitrate,
+          stats->bitrate_adjustments);
+
   dprintf(fd, "  OPUS saved transmit queue length                        : %zu\n",
           a2dp_opus_encoder_cb.TxQueueLength);
 
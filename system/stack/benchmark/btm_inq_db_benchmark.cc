@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "stack/btm/btm_inq_db.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// Distinct advertisers in range of a gateway in a dense environment
+constexpr size_t kAdvertisers = 5000;
+constexpr size_t kReports = 1 << 16;
+
+// Advertising reports, from advertisers picked at random: a few of them
+// advertise much more often than the others.
+const std::vector<RawAddress>& Reports() {
+  static const std::vector<RawAddress> reports = [] {
+    std::mt19937 generator(42);
+    std::geometric_distribution<size_t> popularity(4.0 / kAdvertisers);
+    std::vector<RawAddress> reports;
+    for (size_t i = 0; i < kReports; i++) {
+      size_t id = popularity(generator) % kAdvertisers;
+      reports.push_back(RawAddress({0x0a, 0x0b, 0x0c, static_cast<uint8_t>(id >> 16),
+                                    static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id)}));
+    }
+    return reports;
+  }();
+  return reports;
+}
+
+// Lookups of btm_ble_process_adv_pkt_cont(), with an entry allocated for the
+// devices not in the database.
+void BM_InquiryDb(State& state) {
+  InquiryDb db(state.range(0));
+  const auto& reports = Reports();
+  size_t report = 0;
+  int64_t misses = 0;
+  for (auto _ : state) {
+    const RawAddress& bda = reports[report++ % kReports];
+    tINQ_DB_ENT* p_ent = db.Find(bda);
+    if (p_ent == nullptr) {
+      p_ent = db.New(bda, true, false);
+      misses++;
+    }
+    benchmark::DoNotOptimize(p_ent);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["miss_ratio"] = static_cast<double>(misses) / state.iterations();
+}
+BENCHMARK(BM_InquiryDb)->ArgName("capacity")->Arg(80)->Arg(1024)->Arg(2 * kAdvertisers);
+
+// The "already reported in this inquiry" check of each advertising report.
+void BM_InquiryResultFilter(State& state) {
+  InquiryResultFilter filter;
+  filter.Start(state.range(0));
+  const auto& reports = Reports();
+  size_t report = 0;
+  uint32_t inq_counter = 1;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(filter.FindOrAdd(reports[report++ % kReports], inq_counter));
+    if (report % kReports == 0) {
+      inq_counter++;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InquiryResultFilter)->ArgName("max_entries")->Arg(341)->Arg(kAdvertisers);
+
+}  // namespace
+
+BENCHMARK_MAIN();
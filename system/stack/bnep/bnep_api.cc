@@ -337,7 +337,8 @@ tBNEP_RESULT BNEP_Disconnect(uint16_t handle) {
  *                  BNEP_MTU_EXCEEDED       - If the data length is greater than
  *                                            the MTU
  *                  BNEP_IGNORE_CMD         - If the packet is filtered out
- *                  BNEP_Q_SIZE_EXCEEDED    - If the Tx Q is full
+ *                  BNEP_Q_SIZE_EXCEEDED    - If the Tx Q is full, the buffer
+ *                                            is not released
  *                  BNEP_SUCCESS            - If written successfully
  *
  ******************************************************************************/
@@ -359,6 +360,12 @@ tBNEP_RESULT BNEP_WriteBuf(uint16_t handle, const RawAddress& dest_addr, BT_HDR*
     return BNEP_MTU_EXCEEDED;
   }
 
+  /* Check transmit queue. The buffer is left untouched with the caller, which
+   * can send it again once the flow is turned back on. */
+  if (fixed_queue_length(p_bcb->xmit_q) >= BNEP_MAX_XMITQ_DEPTH) {
+    return BNEP_Q_SIZE_EXCEEDED;
+  }
+
   /* Check if the packet should be filtered out */
   p_data = (uint8_t*)(p_buf + 1) + p_buf->offset;
   if (bnep_is_packet_allowed(p_bcb, dest_addr, protocol, fw_ext_present, p_data, p_buf->len) !=
@@ -410,12 +417,6 @@ tBNEP_RESULT BNEP_WriteBuf(uint16_t handle, const RawAddress& dest_addr, BT_HDR*
     }
   }
 
-  /* Check transmit queue */
-  if (fixed_queue_length(p_bcb->xmit_q) >= BNEP_MAX_XMITQ_DEPTH) {
-    osi_free(p_buf);
-    return BNEP_Q_SIZE_EXCEEDED;
-  }
-
   /* Build the BNEP header */
   bnepu_build_bnep_hdr(p_bcb, p_buf, protocol, src_addr, dest_addr, fw_ext_present);
 
@@ -33,7 +33,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <mutex>
+#include <algorithm>
 
 #include "btif/include/btif_acl.h"
 #include "common/time_util.h"
@@ -49,6 +49,7 @@
 #include "osi/include/stack_power_telemetry.h"
 #include "packet/bit_inserter.h"
 #include "stack/btm/btm_eir.h"
+#include "stack/btm/btm_inq_db.h"
 #include "stack/btm/btm_int_types.h"
 #include "stack/btm/neighbor_inquiry.h"
 #include "stack/btm/security_device_record.h"
@@ -101,16 +102,8 @@ void btm_log_history_scan_mode(uint8_t scan_mode) {
   scan_mode_cached_ = scan_mode;
 }
 
-// Inquiry database lock
-std::mutex inq_db_lock_;
-// Inquiry database
-tINQ_DB_ENT inq_db_[BTM_INQ_DB_SIZE];
-
-// Inquiry bluetooth device database lock
-std::mutex bd_db_lock_;
-tINQ_BDADDR* p_bd_db_;    /* Pointer to memory that holds bdaddrs */
-uint16_t num_bd_entries_; /* Number of entries in database */
-uint16_t max_bd_entries_; /* Maximum number of entries that can be stored */
+// Addresses of the devices which responded to the current inquiry
+InquiryResultFilter inq_result_filter_;
 
 }  // namespace
 
@@ -175,6 +168,10 @@ using bluetooth::hci::Lap;
 #define PROPERTY_INQ_BY_RSSI "persist.bluetooth.inq_by_rssi"
 #endif
 
+#ifndef PROPERTY_INQ_DB_SIZE
+#define PROPERTY_INQ_DB_SIZE "persist.bluetooth.inq_db_size"
+#endif
+
 #define BTIF_DM_DEFAULT_INQ_MAX_DURATION 10
 
 #ifndef PROPERTY_INQ_LENGTH
@@ -248,6 +245,16 @@ static const uint8_t* btm_eir_get_uuid_list(const uint8_t* p_eir, size_t eir_len
 static void btm_process_cancel_complete(tHCI_STATUS status, uint8_t mode);
 static void on_incoming_hci_event(EventView event);
 static bool is_inquery_by_rssi() { return osi_property_get_bool(PROPERTY_INQ_BY_RSSI, false); }
+
+// Inquiry database, sized once from the system properties
+static InquiryDb& inq_db() {
+  static InquiryDb db([] {
+    int32_t size = osi_property_get_int32(PROPERTY_INQ_DB_SIZE, BTM_INQ_DB_SIZE);
+    return size > 0 ? size : BTM_INQ_DB_SIZE;
+  }());
+  return db;
+}
+
 /*******************************************************************************
  *
  * Function         BTM_SetDiscoverability
@@ -805,18 +812,8 @@ tBTM_INQ_INFO* BTM_InqDbRead(const RawAddress& p_bda) {
  *
  ******************************************************************************/
 tBTM_INQ_INFO* BTM_InqDbFirst(void) {
-  uint16_t xx;
-
-  std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use) {
-      return &p_ent->inq_info;
-    }
-  }
-
-  /* If here, no used entry found */
-  return nullptr;
+  tINQ_DB_ENT* p_ent = inq_db().First();
+  return (p_ent == nullptr) ? nullptr : &p_ent->inq_info;
 }
 
 /*******************************************************************************
@@ -831,25 +828,13 @@ tBTM_INQ_INFO* BTM_InqDbFirst(void) {
  *
  ******************************************************************************/
 tBTM_INQ_INFO* BTM_InqDbNext(tBTM_INQ_INFO* p_cur) {
-  uint16_t inx;
-
-  std::lock_guard<std::mutex> lock(inq_db_lock_);
-
-  if (p_cur) {
-    tINQ_DB_ENT* p_ent = (tINQ_DB_ENT*)((uint8_t*)p_cur - offsetof(tINQ_DB_ENT, inq_info));
-    inx = (uint16_t)((p_ent - inq_db_) + 1);
-
-    for (p_ent = &inq_db_[inx]; inx < BTM_INQ_DB_SIZE; inx++, p_ent++) {
-      if (p_ent->in_use) {
-        return &p_ent->inq_info;
-      }
-    }
-
-    /* If here, more entries found */
-    return nullptr;
-  } else {
+  if (p_cur == nullptr) {
     return BTM_InqDbFirst();
   }
+
+  tINQ_DB_ENT* p_ent = (tINQ_DB_ENT*)((uint8_t*)p_cur - offsetof(tINQ_DB_ENT, inq_info));
+  p_ent = inq_db().Next(p_ent);
+  return (p_ent == nullptr) ? nullptr : &p_ent->inq_info;
 }
 
 /*******************************************************************************
@@ -888,18 +873,9 @@ tBTM_STATUS BTM_ClearInqDb(const RawAddress* p_bda) {
  *
  ******************************************************************************/
 void btm_clear_all_pending_le_entry(void) {
-  uint16_t xx;
-  std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    /* mark all pending LE entry as unused if an LE only device has scan
-     * response outstanding */
-    if ((p_ent->in_use) && (p_ent->inq_info.results.device_type == BT_DEVICE_TYPE_BLE) &&
-        !p_ent->scan_rsp) {
-      p_ent->in_use = false;
-    }
-  }
+  /* mark all pending LE entry as unused if an LE only device has scan
+   * response outstanding */
+  inq_db().ClearPendingLe();
 }
 
 /*******************************************************************************
@@ -988,22 +964,11 @@ void btm_inq_db_reset(void) {
  *
  ******************************************************************************/
 void btm_clr_inq_db(const RawAddress* p_bda) {
-  uint16_t xx;
-
 #if (BTM_INQ_DEBUG == TRUE)
   log::verbose("btm_clr_inq_db: inq_active:0x{:x} state:{}", btm_cb.btm_inq_vars.inq_active,
                btm_cb.btm_inq_vars.state);
 #endif
-  std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use) {
-      /* If this is the specified BD_ADDR or clearing all devices */
-      if (p_bda == NULL || (p_ent->inq_info.results.remote_bd_addr == *p_bda)) {
-        p_ent->in_use = false;
-      }
-    }
-  }
+  inq_db().Clear(p_bda);
 #if (BTM_INQ_DEBUG == TRUE)
   log::verbose("inq_active:0x{:x} state:{}", btm_cb.btm_inq_vars.inq_active,
                btm_cb.btm_inq_vars.state);
@@ -1021,27 +986,13 @@ void btm_clr_inq_db(const RawAddress* p_bda) {
  *
  ******************************************************************************/
 static void btm_init_inq_result_flt(void) {
-  std::lock_guard<std::mutex> lock(bd_db_lock_);
-
-  if (p_bd_db_ != nullptr) {
-    log::error("Memory leak with bluetooth device database");
-  }
-
-  /* Allocate memory to hold bd_addrs responding */
-  p_bd_db_ = (tINQ_BDADDR*)osi_calloc(BT_DEFAULT_BUFFER_SIZE);
-  max_bd_entries_ = (uint16_t)(BT_DEFAULT_BUFFER_SIZE / sizeof(tINQ_BDADDR));
+  /* Bound the addresses recorded as the legacy bdaddr buffer did, or to a
+   * few times the inquiry database when it is larger */
+  inq_result_filter_.Start(std::max(BT_DEFAULT_BUFFER_SIZE / sizeof(tINQ_BDADDR),
+                                    4 * inq_db().capacity()));
 }
 
-void btm_clr_inq_result_flt(void) {
-  std::lock_guard<std::mutex> lock(bd_db_lock_);
-  if (p_bd_db_ == nullptr) {
-    log::warn("Memory being reset multiple times");
-  }
-
-  osi_free_and_reset((void**)&p_bd_db_);
-  num_bd_entries_ = 0;
-  max_bd_entries_ = 0;
-}
+void btm_clr_inq_result_flt(void) { inq_result_filter_.Stop(); }
 
 /*******************************************************************************
  *
@@ -1054,29 +1005,7 @@ void btm_clr_inq_result_flt(void) {
  *
  ******************************************************************************/
 bool btm_inq_find_bdaddr(const RawAddress& p_bda) {
-  std::lock_guard<std::mutex> lock(bd_db_lock_);
-  tINQ_BDADDR* p_db = p_bd_db_;
-  uint16_t xx;
-
-  /* Don't bother searching, database doesn't exist or periodic mode */
-  if (!p_db) {
-    return false;
-  }
-
-  for (xx = 0; xx < num_bd_entries_; xx++, p_db++) {
-    if (p_db->bd_addr == p_bda && p_db->inq_count == btm_cb.btm_inq_vars.inq_counter) {
-      return true;
-    }
-  }
-
-  if (xx < max_bd_entries_) {
-    p_db->inq_count = btm_cb.btm_inq_vars.inq_counter;
-    p_db->bd_addr = p_bda;
-    num_bd_entries_++;
-  }
-
-  /* If here, New Entry */
-  return false;
+  return inq_result_filter_.FindOrAdd(p_bda, btm_cb.btm_inq_vars.inq_counter);
 }
 
 /*******************************************************************************
@@ -1089,76 +1018,21 @@ bool btm_inq_find_bdaddr(const RawAddress& p_bda) {
  * Returns          pointer to entry, or NULL if not found
  *
  ******************************************************************************/
-tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
-  uint16_t xx;
-  std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use && p_ent->inq_info.results.remote_bd_addr == p_bda) {
-      return p_ent;
-    }
-  }
-
-  /* If here, not found */
-  return nullptr;
-}
+tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) { return inq_db().Find(p_bda); }
 
 /*******************************************************************************
  *
  * Function         btm_inq_db_new
  *
- * Description      This function looks through the inquiry database for an
- *                  unused entry. If no entry is free, it allocates the oldest
- *                  entry.
+ * Description      This function allocates an entry of the inquiry database.
+ *                  If no entry is free, it reuses the least recently found
+ *                  entry, or the weakest one when inquiring by RSSI.
  *
  * Returns          pointer to entry
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda, bool is_ble) {
-  uint16_t xx = 0, yy = 0;
-  uint32_t ot = 0xFFFFFFFF;
-  int8_t i_rssi = 0;
-
-  if (is_ble) {
-    yy = BTM_INQ_DB_SIZE / 2;
-  } else {
-    yy = 0;
-  }
-
-  std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = &inq_db_[yy];
-  tINQ_DB_ENT* p_old = &inq_db_[yy];
-
-  for (xx = 0; xx < BTM_INQ_DB_SIZE / 2; xx++, p_ent++) {
-    if (!p_ent->in_use) {
-      memset(p_ent, 0, sizeof(tINQ_DB_ENT));
-      p_ent->inq_info.results.remote_bd_addr = p_bda;
-      p_ent->in_use = true;
-
-      return p_ent;
-    }
-
-    if (is_inquery_by_rssi()) {
-      if (p_ent->inq_info.results.rssi < i_rssi) {
-        p_old = p_ent;
-        i_rssi = p_ent->inq_info.results.rssi;
-      }
-    } else {
-      if (p_ent->time_of_resp < ot) {
-        p_old = p_ent;
-        ot = p_ent->time_of_resp;
-      }
-    }
-  }
-
-  /* If here, no free entry found. Return the oldest. */
-
-  memset(p_old, 0, sizeof(tINQ_DB_ENT));
-  p_old->inq_info.results.remote_bd_addr = p_bda;
-  p_old->in_use = true;
-
-  return p_old;
+  return inq_db().New(p_bda, is_ble, is_inquery_by_rssi());
 }
 
 /*******************************************************************************
@@ -1598,31 +1472,7 @@ static void btm_process_inq_results_extended(EventView event) {
  * Returns          void
  *
  ******************************************************************************/
-void btm_sort_inq_result(void) {
-  uint8_t xx, yy, num_resp;
-  std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-  tINQ_DB_ENT* p_next = inq_db_ + 1;
-  int size;
-  tINQ_DB_ENT* p_tmp = (tINQ_DB_ENT*)osi_malloc(sizeof(tINQ_DB_ENT));
-
-  num_resp = (btm_cb.btm_inq_vars.inq_cmpl_info.num_resp < BTM_INQ_DB_SIZE)
-                     ? btm_cb.btm_inq_vars.inq_cmpl_info.num_resp
-                     : BTM_INQ_DB_SIZE;
-
-  size = sizeof(tINQ_DB_ENT);
-  for (xx = 0; xx < num_resp - 1; xx++, p_ent++) {
-    for (yy = xx + 1, p_next = p_ent + 1; yy < num_resp; yy++, p_next++) {
-      if (p_ent->inq_info.results.rssi < p_next->inq_info.results.rssi) {
-        memcpy(p_tmp, p_next, size);
-        memcpy(p_next, p_ent, size);
-        memcpy(p_ent, p_tmp, size);
-      }
-    }
-  }
-
-  osi_free(p_tmp);
-}
+void btm_sort_inq_result(void) { inq_db().SortByRssi(); }
 
 /*******************************************************************************
  *
@@ -2195,7 +2045,7 @@ namespace bluetooth {
 namespace legacy {
 namespace testing {
 void btm_clr_inq_db(const RawAddress* p_bda) { ::btm_clr_inq_db(p_bda); }
-uint16_t btm_get_num_bd_entries() { return num_bd_entries_; }
+uint16_t btm_get_num_bd_entries() { return inq_result_filter_.size(); }
 }  // namespace testing
 }  // namespace legacy
 }  // namespace bluetooth
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack/btm/btm_inq_db.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "stack/include/bt_device_type.h"
+
+InquiryDb::InquiryDb(size_t capacity) {
+  capacity = std::clamp<size_t>(capacity, 2, kNone - 1);
+
+  entries_.resize(capacity);
+  prev_.resize(capacity, kNone);
+  next_.resize(capacity, kNone);
+  order_.resize(capacity);
+  std::iota(order_.begin(), order_.end(), 0);
+  position_ = order_;
+  index_.reserve(capacity);
+
+  classic_.begin = 0;
+  classic_.end = le_.begin = static_cast<uint16_t>(capacity / 2);
+  le_.end = static_cast<uint16_t>(capacity);
+
+  // Free entries are taken from the lowest index
+  for (Half* half : {&classic_, &le_}) {
+    for (uint16_t index = half->end; index > half->begin; index--) {
+      half->free.push_back(index - 1);
+    }
+  }
+}
+
+size_t InquiryDb::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.size();
+}
+
+void InquiryDb::Link(Half& half, uint16_t index) {
+  prev_[index] = half.mru;
+  next_[index] = kNone;
+  if (half.mru != kNone) {
+    next_[half.mru] = index;
+  } else {
+    half.lru = index;
+  }
+  half.mru = index;
+}
+
+void InquiryDb::Unlink(Half& half, uint16_t index) {
+  if (prev_[index] != kNone) {
+    next_[prev_[index]] = next_[index];
+  } else {
+    half.lru = next_[index];
+  }
+  if (next_[index] != kNone) {
+    prev_[next_[index]] = prev_[index];
+  } else {
+    half.mru = prev_[index];
+  }
+  prev_[index] = next_[index] = kNone;
+}
+
+void InquiryDb::Release(uint16_t index) {
+  Half& half = HalfOf(index);
+  index_.erase(entries_[index].inq_info.results.remote_bd_addr);
+  Unlink(half, index);
+  entries_[index].in_use = false;
+  half.free.push_back(index);
+}
+
+tINQ_DB_ENT* InquiryDb::Find(const RawAddress& bda) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(bda);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+
+  uint16_t index = it->second;
+  Half& half = HalfOf(index);
+  if (half.mru != index) {
+    Unlink(half, index);
+    Link(half, index);
+  }
+  return &entries_[index];
+}
+
+tINQ_DB_ENT* InquiryDb::New(const RawAddress& bda, bool is_ble, bool evict_by_rssi) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(bda);
+  if (it != index_.end()) {
+    Release(it->second);
+  }
+
+  Half& half = is_ble ? le_ : classic_;
+  if (half.free.empty()) {
+    uint16_t victim = half.lru;
+    if (evict_by_rssi) {
+      victim = half.begin;
+      int8_t weakest_rssi = 0;
+      for (uint16_t index = half.begin; index < half.end; index++) {
+        if (entries_[index].inq_info.results.rssi < weakest_rssi) {
+          victim = index;
+          weakest_rssi = entries_[index].inq_info.results.rssi;
+        }
+      }
+    }
+    Release(victim);
+  }
+
+  uint16_t index = half.free.back();
+  half.free.pop_back();
+
+  tINQ_DB_ENT* entry = &entries_[index];
+  *entry = {};
+  entry->inq_info.results.remote_bd_addr = bda;
+  entry->in_use = true;
+  index_[bda] = index;
+  Link(half, index);
+  return entry;
+}
+
+void InquiryDb::Clear(const RawAddress* bda) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (bda == nullptr) {
+    for (uint16_t index = 0; index < entries_.size(); index++) {
+      if (entries_[index].in_use) {
+        Release(index);
+      }
+    }
+    return;
+  }
+
+  auto it = index_.find(*bda);
+  if (it != index_.end()) {
+    Release(it->second);
+  }
+}
+
+void InquiryDb::ClearPendingLe() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (uint16_t index = 0; index < entries_.size(); index++) {
+    const tINQ_DB_ENT& entry = entries_[index];
+    if (entry.in_use && entry.inq_info.results.device_type == BT_DEVICE_TYPE_BLE &&
+        !entry.scan_rsp) {
+      Release(index);
+    }
+  }
+}
+
+tINQ_DB_ENT* InquiryDb::FirstFrom(size_t position) {
+  for (; position < order_.size(); position++) {
+    if (entries_[order_[position]].in_use) {
+      return &entries_[order_[position]];
+    }
+  }
+  return nullptr;
+}
+
+tINQ_DB_ENT* InquiryDb::First() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return FirstFrom(0);
+}
+
+tINQ_DB_ENT* InquiryDb::Next(const tINQ_DB_ENT* entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return FirstFrom(position_[IndexOf(entry)] + 1);
+}
+
+void InquiryDb::SortByRssi() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::stable_sort(order_.begin(), order_.end(), [this](uint16_t a, uint16_t b) {
+    const tINQ_DB_ENT& entry_a = entries_[a];
+    const tINQ_DB_ENT& entry_b = entries_[b];
+    if (entry_a.in_use != entry_b.in_use) {
+      return entry_a.in_use;
+    }
+    return entry_a.in_use && entry_a.inq_info.results.rssi > entry_b.inq_info.results.rssi;
+  });
+  for (uint16_t position = 0; position < order_.size(); position++) {
+    position_[order_[position]] = position;
+  }
+}
+
+void InquiryResultFilter::Start(size_t max_entries) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  active_ = true;
+  max_entries_ = max_entries;
+}
+
+void InquiryResultFilter::Stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  active_ = false;
+  std::unordered_map<RawAddress, uint32_t>().swap(inq_counters_);
+}
+
+bool InquiryResultFilter::FindOrAdd(const RawAddress& bda, uint32_t inq_counter) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!active_) {
+    return false;
+  }
+
+  auto it = inq_counters_.find(bda);
+  if (it != inq_counters_.end()) {
+    if (it->second == inq_counter) {
+      return true;
+    }
+    it->second = inq_counter;
+  } else if (inq_counters_.size() < max_entries_) {
+    inq_counters_.emplace(bda, inq_counter);
+  }
+  return false;
+}
+
+size_t InquiryResultFilter::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return inq_counters_.size();
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "stack/btm/neighbor_inquiry.h"
+#include "types/raw_address.h"
+
+/*
+ * Inquiry database, holding the inquiry results of the classic and LE
+ * devices, indexed by address.
+ *
+ * The classic and LE devices each use half of the entries, so that a busy
+ * LE environment does not evict the classic inquiry results. When a half is
+ * full, its least recently found entry is reused, or its weakest one when
+ * the inquiry results are kept by RSSI.
+ *
+ * Entries do not move: pointers to them remain valid until they are cleared
+ * or reused.
+ */
+class InquiryDb {
+public:
+  explicit InquiryDb(size_t capacity);
+
+  size_t capacity() const { return entries_.size(); }
+  size_t size() const;
+
+  // Returns the entry of |bda|, or nullptr, and marks it as recently found
+  tINQ_DB_ENT* Find(const RawAddress& bda);
+
+  // Returns a cleared entry for |bda|, reusing an entry if its half is full
+  tINQ_DB_ENT* New(const RawAddress& bda, bool is_ble, bool evict_by_rssi);
+
+  // Clears the entry of |bda|, or all the entries when nullptr
+  void Clear(const RawAddress* bda);
+
+  // Clears the entries of LE only devices whose scan response is outstanding
+  void ClearPendingLe();
+
+  // Walks through the entries in use, in iteration order
+  tINQ_DB_ENT* First();
+  tINQ_DB_ENT* Next(const tINQ_DB_ENT* entry);
+
+  // Orders the iteration by decreasing RSSI. The entries do not move.
+  void SortByRssi();
+
+private:
+  static constexpr uint16_t kNone = 0xffff;
+
+  struct Half {
+    uint16_t begin;
+    uint16_t end;
+    // Least recently found entry of the half in use, and most recent one
+    uint16_t lru = kNone;
+    uint16_t mru = kNone;
+    std::vector<uint16_t> free;
+  };
+
+  Half& HalfOf(uint16_t index) { return index < classic_.end ? classic_ : le_; }
+  uint16_t IndexOf(const tINQ_DB_ENT* entry) const {
+    return static_cast<uint16_t>(entry - entries_.data());
+  }
+
+  void Link(Half& half, uint16_t index);
+  void Unlink(Half& half, uint16_t index);
+  void Release(uint16_t index);
+  tINQ_DB_ENT* FirstFrom(size_t position);
+
+  mutable std::mutex mutex_;
+  std::vector<tINQ_DB_ENT> entries_;
+  // Neighbours of the entries in use in the recency list of their half
+  std::vector<uint16_t> prev_;
+  std::vector<uint16_t> next_;
+  // Entries in iteration order, and position of each entry in it
+  std::vector<uint16_t> order_;
+  std::vector<uint16_t> position_;
+  std::unordered_map<RawAddress, uint16_t> index_;
+  Half classic_;
+  Half le_;
+};
+
+/*
+ * Addresses already reported during the current inquiry. Each address is
+ * stamped with the counter of the last inquiry it was reported in, so that
+ * the addresses of previous inquiries do not match.
+ */
+class InquiryResultFilter {
+public:
+  // Starts recording up to |max_entries| addresses
+  void Start(size_t max_entries);
+  void Stop();
+
+  // Returns true if |bda| was already reported during inquiry
+  // |inq_counter|, and records it otherwise
+  bool FindOrAdd(const RawAddress& bda, uint32_t inq_counter);
+
+  size_t size() const;
+
+private:
+  mutable std::mutex mutex_;
+  bool active_ = false;
+  size_t max_entries_ = 0;
+  std::unordered_map<RawAddress, uint32_t> inq_counters_;
+};
@@ -18,7 +18,9 @@
 #include <memory>
 
 #include "btm/btm_iso_impl.h"
+#include "hci/le_scanning_manager.h"
 #include "include/btm_iso_api.h"
+#include "main/shim/entry.h"
 #include "stack/include/bt_hdr.h"
 
 using bluetooth::hci::iso_manager::BigCallbacks;
@@ -34,6 +36,12 @@ struct IsoManager::impl {
   void Start() {
     log::assert_that(iso_impl_ == nullptr, "assert failed: iso_impl_ == nullptr");
     iso_impl_ = std::make_unique<iso_impl>();
+    // The scan is scheduled around the isochronous traffic
+    iso_impl_->handle_register_on_iso_traffic_active_callback([](bool is_active) {
+      if (auto scanning = bluetooth::shim::GetScanning()) {
+        scanning->SetIsoTrafficActive(is_active);
+      }
+    });
   }
 
   void Stop() {
@@ -26,10 +26,13 @@
 #include <bluetooth/log.h>
 
 #include "common/message_loop_thread.h"
+#include "common/task_profiler.h"
 #include "include/hardware/bluetooth.h"
 #include "os/log.h"
+#include "osi/include/properties.h"
 
 using bluetooth::common::MessageLoopThread;
+using bluetooth::common::TaskProfiler;
 using namespace bluetooth;
 
 static MessageLoopThread main_thread("bt_main_thread");
@@ -63,7 +66,11 @@ void post_on_bt_main(BtMainClosure closure) {
                    "BT_STATUS_SUCCESS");
 }
 
+// Accounts the time spent queued and running to every posted task, see `dumpsys bluetooth_manager`.
+static constexpr char kTaskProfilerProperty[] = "bluetooth.task_profiler.enabled";
+
 void main_thread_start_up() {
+  TaskProfiler::SetEnabled(osi_property_get_bool(kTaskProfilerProperty, false));
   main_thread.StartUp();
   if (!main_thread.IsRunning()) {
     log::fatal("unable to start btu message loop thread.");
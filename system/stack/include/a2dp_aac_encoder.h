@@ -80,4 +80,8 @@ int a2dp_aac_get_effective_frame_size();
 // |timestamp_us| is the current timestamp (in microseconds).
 void a2dp_aac_send_frames(uint64_t timestamp_us);
 
+// Set the rate of the A2DP AAC encoder, in per mille of the configured
+// bitrate. Only applies to constant bitrate encoding.
+void a2dp_aac_set_target_rate(uint16_t rate_per_mille);
+
 #endif  // A2DP_AAC_ENCODER_H
@@ -526,6 +526,11 @@ typedef struct {
 
   // Set transmit queue length for the A2DP encoder.
   void (*set_transmit_queue_length)(size_t transmit_queue_length);
+
+  // Set the rate the A2DP encoder should produce, in per mille of the bitrate
+  // of its configuration. Optional: encoders that don't implement it either
+  // run at a fixed rate, or adapt to the transmit queue length by themselves.
+  void (*set_target_rate)(uint16_t rate_per_mille);
 } tA2DP_ENCODER_INTERFACE;
 
 // Prototype for a callback to receive decoded audio data from a
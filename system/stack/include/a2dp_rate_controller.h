@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Congestion-adaptive rate control of the A2DP source encoders.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Rate of the encoders, in per mille of the bitrate of their configuration.
+constexpr uint16_t kA2dpRateFull = 1000;
+
+class A2dpRateController {
+public:
+  static constexpr int8_t kRssiUnknown = INT8_MIN;
+
+  // Never encode below this fraction of the configured bitrate.
+  static constexpr uint16_t kMinRate = 400;
+
+  // What the source observes of the link at each encoder tick.
+  struct LinkSample {
+    uint64_t timestamp_us;
+    // Encoded packets waiting for the link.
+    size_t queue_length;
+    // Encoded packets the source queue holds before dropping them.
+    size_t queue_limit;
+    // How long the link has not taken a packet from a non-empty queue, which
+    // grows with the time the controller takes to return ACL credits.
+    uint64_t stall_us;
+    // Last RSSI read on the link, or kRssiUnknown.
+    int8_t rssi;
+  };
+
+  struct Stats {
+    size_t ticks;
+    size_t congested_ticks;
+    size_t decreases;
+    size_t increases;
+    uint16_t min_rate;
+    uint64_t reduced_rate_us;  // Time spent below the full rate
+    uint64_t max_stall_us;
+  };
+
+  // Sets the rate of the encoder, see tA2DP_ENCODER_INTERFACE.
+  using SetTargetRate = void (*)(uint16_t rate_per_mille);
+
+  // Starts a new streaming session at the full rate. |encoder_interval_ms|
+  // is the period of the encoder ticks, and |set_target_rate| applies the
+  // rate to the encoder, or is nullptr when the encoder cannot change it.
+  void Reset(uint64_t encoder_interval_ms, SetTargetRate set_target_rate);
+
+  // Feeds the state of the link at an encoder tick, applies the rate the
+  // encoder should produce until the next one and returns it.
+  uint16_t OnTick(const LinkSample& sample);
+
+  // Whether the encoder of the session follows the rate of the controller.
+  bool active() const { return set_target_rate_ != nullptr; }
+  uint16_t rate() const { return rate_; }
+  const Stats& stats() const { return stats_; }
+
+  void Dump(int fd) const;
+
+private:
+  bool IsCongested(const LinkSample& sample) const;
+  bool IsClear(const LinkSample& sample) const;
+  bool IsFading() const;
+
+  SetTargetRate set_target_rate_ = nullptr;
+  uint64_t interval_us_ = 0;
+  uint16_t rate_ = kA2dpRateFull;
+  uint64_t last_tick_us_ = 0;
+  bool changed_ = false;
+  uint64_t last_change_us_ = 0;
+  // Whether the link kept up since |clear_since_us_|.
+  bool clear_ = false;
+  uint64_t clear_since_us_ = 0;
+  // RSSI last read while streaming at the full rate.
+  int8_t reference_rssi_ = kRssiUnknown;
+  int8_t last_rssi_ = kRssiUnknown;
+  Stats stats_ = {};
+};
@@ -58,6 +58,10 @@ int a2dp_sbc_get_effective_frame_size();
 // |timestamp_us| is the current timestamp (in microseconds).
 void a2dp_sbc_send_frames(uint64_t timestamp_us);
 
+// Set the rate of the A2DP SBC encoder, in per mille of the configured rate.
+// The bitpool is scaled down to it, within the range of the configuration.
+void a2dp_sbc_set_target_rate(uint16_t rate_per_mille);
+
 // Get SBC bitrate
 // Returns |uint32_t| bitrate in bits per second
 uint32_t a2dp_sbc_get_bitrate();
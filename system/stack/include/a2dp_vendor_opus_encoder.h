@@ -52,6 +52,10 @@ void a2dp_vendor_opus_send_frames(uint64_t timestamp_us);
 // Set transmit queue length for the A2DP Opus (Dynamic Bit Rate) mechanism.
 void a2dp_vendor_opus_set_transmit_queue_length(size_t transmit_queue_length);
 
+// Set the rate of the A2DP Opus encoder, in per mille of the configured
+// bitrate.
+void a2dp_vendor_opus_set_target_rate(uint16_t rate_per_mille);
+
 // Get the A2DP Opus encoded maximum frame size
 int a2dp_vendor_opus_get_effective_frame_size();
 
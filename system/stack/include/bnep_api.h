@@ -276,7 +276,8 @@ tBNEP_RESULT BNEP_Disconnect(uint16_t handle);
  *                  BNEP_MTU_EXCEEDED       - If the data length is greater
  *                                            than MTU
  *                  BNEP_IGNORE_CMD         - If the packet is filtered out
- *                  BNEP_Q_SIZE_EXCEEDED    - If the Tx Q is full
+ *                  BNEP_Q_SIZE_EXCEEDED    - If the Tx Q is full, the buffer
+ *                                            is not released
  *                  BNEP_SUCCESS            - If written successfully
  *
  ******************************************************************************/
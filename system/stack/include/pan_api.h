@@ -335,6 +335,8 @@ tPAN_RESULT PAN_Disconnect(uint16_t handle);
  *                  ext      - to indicate that extension headers present
  *
  * Returns          PAN_SUCCESS       - if the data is sent successfully
+ *                  PAN_Q_SIZE_EXCEEDED - if the link is congested, the data
+ *                                           is dropped
  *                  PAN_FAILURE       - if the connection is not found or
  *                                           there is an error in sending data
  *
@@ -360,6 +362,8 @@ tPAN_RESULT PAN_Write(uint16_t handle, const RawAddress& dst, const RawAddress&
  *                  ext      - to indicate that extension headers present
  *
  * Returns          PAN_SUCCESS       - if the data is sent successfully
+ *                  PAN_Q_SIZE_EXCEEDED - if the link is congested, the buffer
+ *                                           is not released
  *                  PAN_FAILURE       - if the connection is not found or
  *                                           there is an error in sending data
  *
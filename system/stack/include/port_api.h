@@ -24,10 +24,14 @@
 #ifndef PORT_API_H
 #define PORT_API_H
 
+#include <sys/types.h>
+#include <sys/uio.h>
+
 #include <cstdint>
 
 #include "include/macros.h"
 #include "internal_include/bt_target.h"
+#include "stack/include/bt_hdr.h"
 #include "types/raw_address.h"
 
 /*****************************************************************************
@@ -86,6 +90,12 @@ typedef int(tPORT_DATA_CO_CALLBACK)(uint16_t port_handle, uint8_t* p_buf, uint16
 
 typedef void(tPORT_CALLBACK)(uint32_t code, uint16_t port_handle);
 
+/*
+ * Called by PORT_ReadDataV with the received data, one iovec per queued
+ * buffer. Returns the byte count consumed, or -1 on error.
+ */
+typedef ssize_t(tPORT_READV_CALLBACK)(const struct iovec* p_iov, int iov_cnt, void* context);
+
 /*
  * Define events that registered application can receive in the callback
  */
@@ -423,6 +433,40 @@ typedef void(tPORT_MGMT_CALLBACK)(const tPORT_RESULT code, uint16_t port_handle)
  ******************************************************************************/
 [[nodiscard]] int PORT_ReadData(uint16_t handle, char* p_data, uint16_t max_len, uint16_t* p_len);
 
+/*******************************************************************************
+ *
+ * Function         PORT_ReadDataV
+ *
+ * Description      Passes the received data to p_callback without copying it
+ *                  and releases the bytes the callback consumed. The iovecs
+ *                  are only valid for the duration of the callback.
+ *
+ * Parameters:      handle     - Handle returned in the RFCOMM_CreateConnection
+ *                                callback.
+ *                  p_callback  - Consumer of the data, e.g. calling sendmsg()
+ *                  context     - Passed to p_callback
+ *                  p_len       - Byte count consumed
+ *
+ ******************************************************************************/
+[[nodiscard]] int PORT_ReadDataV(uint16_t handle, tPORT_READV_CALLBACK* p_callback, void* context,
+                                 uint32_t* p_len);
+
+/*******************************************************************************
+ *
+ * Function         PORT_EnqueueRxBuf
+ *
+ * Description      Puts a received buffer the application could not deliver
+ *                  back on the port's receive queue, to be read later with
+ *                  PORT_ReadDataV. The port takes ownership of p_buf whatever
+ *                  the result.
+ *
+ * Parameters:      handle     - Handle returned in the RFCOMM_CreateConnection
+ *                                callback.
+ *                  p_buf       - Received buffer
+ *
+ ******************************************************************************/
+[[nodiscard]] int PORT_EnqueueRxBuf(uint16_t handle, BT_HDR* p_buf);
+
 /*******************************************************************************
  *
  * Function         PORT_WriteData
@@ -426,6 +426,8 @@ tPAN_RESULT PAN_Disconnect(uint16_t handle) {
  *                  ext      - to indicate that extension headers present
  *
  * Returns          PAN_SUCCESS       - if the data is sent successfully
+ *                  PAN_Q_SIZE_EXCEEDED - if the link is congested, the data
+ *                                           is dropped
  *                  PAN_FAILURE       - if the connection is not found or
  *                                           there is an error in sending data
  *
@@ -456,7 +458,12 @@ tPAN_RESULT PAN_Write(uint16_t handle, const RawAddress& dst, const RawAddress&
   buffer->offset = PAN_MINIMUM_OFFSET;
   memcpy(reinterpret_cast<uint8_t*>(buffer) + sizeof(BT_HDR) + buffer->offset, p_data, buffer->len);
 
-  return PAN_WriteBuf(handle, dst, src, protocol, buffer, ext);
+  // The caller passed raw bytes, so the buffer BNEP could not take is released here.
+  tPAN_RESULT result = PAN_WriteBuf(handle, dst, src, protocol, buffer, ext);
+  if (result == PAN_Q_SIZE_EXCEEDED) {
+    osi_free(buffer);
+  }
+  return result;
 }
 
 /*******************************************************************************
@@ -478,6 +485,8 @@ tPAN_RESULT PAN_Write(uint16_t handle, const RawAddress& dst, const RawAddress&
  *                  ext      - to indicate that extension headers present
  *
  * Returns          PAN_SUCCESS       - if the data is sent successfully
+ *                  PAN_Q_SIZE_EXCEEDED - if the link is congested, the buffer
+ *                                           is not released
  *                  PAN_FAILURE       - if the connection is not found or
  *                                           there is an error in sending data
  *
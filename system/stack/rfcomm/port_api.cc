@@ -34,6 +34,8 @@
 #include "internal_include/bt_trace.h"
 #include "os/logging/log_adapter.h"
 #include "osi/include/allocator.h"
+#include "osi/include/fixed_queue.h"
+#include "osi/include/list.h"
 #include "osi/include/mutex.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/bt_types.h"
@@ -45,6 +47,9 @@
 
 using namespace bluetooth;
 
+/* Maximum number of queued buffers passed to a PORT_ReadDataV callback at once */
+#define PORT_READV_MAX_IOV 32
+
 /* Mapping from PORT_* result codes to human readable strings. */
 static const char* result_code_strings[] = {"Success",
                                             "Unknown error",
@@ -716,15 +721,7 @@ int PORT_FlowControl_MaxCredit(uint16_t handle, bool enable) {
  *                  p_len       - Byte count received
  *
  ******************************************************************************/
-int PORT_ReadData(uint16_t handle, char* p_data, uint16_t max_len, uint16_t* p_len) {
-  BT_HDR* p_buf;
-  uint16_t count;
-
-  log::verbose("PORT_ReadData() handle:{} max_len:{}", handle, max_len);
-
-  /* Initialize this in case of an error */
-  *p_len = 0;
-
+static int port_get_readable(uint16_t handle, tPORT** pp_port) {
   tPORT* p_port = get_port_from_handle(handle);
   if (p_port == nullptr) {
     log::error("Unable to get RFCOMM port control block bad handle:{}", handle);
@@ -743,6 +740,25 @@ int PORT_ReadData(uint16_t handle, char* p_data, uint16_t max_len, uint16_t* p_l
     return PORT_LINE_ERR;
   }
 
+  *pp_port = p_port;
+  return PORT_SUCCESS;
+}
+
+int PORT_ReadData(uint16_t handle, char* p_data, uint16_t max_len, uint16_t* p_len) {
+  BT_HDR* p_buf;
+  uint16_t count;
+
+  log::verbose("PORT_ReadData() handle:{} max_len:{}", handle, max_len);
+
+  /* Initialize this in case of an error */
+  *p_len = 0;
+
+  tPORT* p_port = nullptr;
+  int status = port_get_readable(handle, &p_port);
+  if (status != PORT_SUCCESS) {
+    return status;
+  }
+
   if (fixed_queue_is_empty(p_port->rx.queue)) {
     log::warn("Read on empty input queue");
     return PORT_SUCCESS;
@@ -806,6 +822,139 @@ int PORT_ReadData(uint16_t handle, char* p_data, uint16_t max_len, uint16_t* p_l
   return PORT_SUCCESS;
 }
 
+/*******************************************************************************
+ *
+ * Function         PORT_ReadDataV
+ *
+ * Description      Passes the received data to p_callback as iovecs pointing
+ *                  into the queued buffers, then releases the bytes the
+ *                  callback consumed. The queue is locked for the duration of
+ *                  the callback so the buffers cannot be released under it.
+ *
+ * Parameters:      handle     - Handle returned in the RFCOMM_CreateConnection
+ *                  p_callback  - Consumer of the data
+ *                  context     - Passed to p_callback
+ *                  p_len       - Byte count consumed
+ *
+ ******************************************************************************/
+int PORT_ReadDataV(uint16_t handle, tPORT_READV_CALLBACK* p_callback, void* context,
+                   uint32_t* p_len) {
+  struct iovec iov[PORT_READV_MAX_IOV];
+  int iov_cnt = 0;
+  uint16_t count = 0;
+
+  log::verbose("PORT_ReadDataV() handle:{}", handle);
+
+  /* Initialize this in case of an error */
+  *p_len = 0;
+
+  tPORT* p_port = nullptr;
+  int status = port_get_readable(handle, &p_port);
+  if (status != PORT_SUCCESS) {
+    return status;
+  }
+
+  mutex_global_lock();
+
+  if (p_port->rx.queue == nullptr) {
+    mutex_global_unlock();
+    return PORT_NOT_OPENED;
+  }
+
+  list_t* list = fixed_queue_get_list(p_port->rx.queue);
+  for (const list_node_t* node = list_begin(list);
+       node != list_end(list) && iov_cnt < PORT_READV_MAX_IOV; node = list_next(node)) {
+    BT_HDR* p_buf = (BT_HDR*)list_node(node);
+    iov[iov_cnt].iov_base = (uint8_t*)(p_buf + 1) + p_buf->offset;
+    iov[iov_cnt].iov_len = p_buf->len;
+    iov_cnt++;
+  }
+
+  ssize_t consumed = p_callback(iov, iov_cnt, context);
+  if (consumed < 0) {
+    mutex_global_unlock();
+    return PORT_UNKNOWN_ERROR;
+  }
+
+  size_t len = consumed;
+  while (len) {
+    BT_HDR* p_buf = (BT_HDR*)fixed_queue_try_peek_first(p_port->rx.queue);
+    if (p_buf == nullptr) {
+      break;
+    }
+
+    if (p_buf->len > len) {
+      p_buf->offset += len;
+      p_buf->len -= len;
+      p_port->rx.queue_size -= len;
+      *p_len += len;
+      break;
+    }
+
+    len -= p_buf->len;
+    *p_len += p_buf->len;
+    p_port->rx.queue_size -= p_buf->len;
+    osi_free(fixed_queue_try_dequeue(p_port->rx.queue));
+    count++;
+  }
+
+  mutex_global_unlock();
+
+  if (*p_len != (uint32_t)consumed) {
+    log::warn("Callback consumed {} bytes, only {} were queued", consumed, *p_len);
+  }
+
+  log::verbose("PORT_ReadDataV queue:{} returned:{}", p_port->rx.queue_size, *p_len);
+
+  /* Return credits to the peer for the buffers fully consumed */
+  port_flow_control_peer(p_port, true, count);
+
+  return PORT_SUCCESS;
+}
+
+/*******************************************************************************
+ *
+ * Function         PORT_EnqueueRxBuf
+ *
+ * Description      Puts a received buffer the application could not deliver
+ *                  back on the port's receive queue. The port takes ownership
+ *                  of p_buf whatever the result.
+ *
+ * Parameters:      handle     - Handle returned in the RFCOMM_CreateConnection
+ *                  p_buf       - Received buffer
+ *
+ ******************************************************************************/
+int PORT_EnqueueRxBuf(uint16_t handle, BT_HDR* p_buf) {
+  log::verbose("PORT_EnqueueRxBuf() handle:{} len:{}", handle, p_buf->len);
+
+  tPORT* p_port = get_port_from_handle(handle);
+  if (p_port == nullptr) {
+    log::error("Unable to get RFCOMM port control block bad handle:{}", handle);
+    osi_free(p_buf);
+    return PORT_BAD_HANDLE;
+  }
+
+  if (!p_port->in_use || (p_port->state == PORT_CONNECTION_STATE_CLOSED)) {
+    osi_free(p_buf);
+    return PORT_NOT_OPENED;
+  }
+
+  mutex_global_lock();
+
+  if (p_port->rx.queue == nullptr) {
+    mutex_global_unlock();
+    osi_free(p_buf);
+    return PORT_NOT_OPENED;
+  }
+
+  fixed_queue_enqueue(p_port->rx.queue, p_buf);
+  p_port->rx.queue_size += p_buf->len;
+
+  mutex_global_unlock();
+
+  return PORT_SUCCESS;
+}
+
 /*******************************************************************************
  *
  * Function         port_write
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack/include/a2dp_rate_controller.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+namespace {
+
+constexpr uint64_t kEncoderIntervalMs = 20;
+constexpr uint64_t kTickUs = kEncoderIntervalMs * 1000;
+constexpr size_t kQueueLimit = 28;
+
+// One packet of 20 ms of SBC at 328 kbps per encoder tick.
+constexpr uint32_t kFullRatePacketBytes = 820;
+
+// Rate last applied to the encoder.
+uint16_t target_rate = 0;
+
+void SetTargetRate(uint16_t rate_per_mille) { target_rate = rate_per_mille; }
+
+A2dpRateController::LinkSample Sample(uint64_t timestamp_us, size_t queue_length,
+                                      uint64_t stall_us = 0,
+                                      int8_t rssi = A2dpRateController::kRssiUnknown) {
+  return {
+          .timestamp_us = timestamp_us,
+          .queue_length = queue_length,
+          .queue_limit = kQueueLimit,
+          .stall_us = stall_us,
+          .rssi = rssi,
+  };
+}
+
+// Link capacity and signal strength seen at each encoder tick.
+struct LinkTick {
+  uint32_t capacity_bytes;
+  int8_t rssi;
+};
+
+std::vector<LinkTick> ReadLinkTrace(const std::string& relative_path) {
+  std::vector<LinkTick> trace;
+  std::string path = bluetooth::testing::GetWavFilePath(relative_path);
+  FILE* file = fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    return trace;
+  }
+  char line[128];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    unsigned timestamp_ms;
+    unsigned capacity_bytes;
+    int rssi;
+    if (line[0] == '#' || sscanf(line, "%u,%u,%d", &timestamp_ms, &capacity_bytes, &rssi) != 3) {
+      continue;
+    }
+    trace.push_back({capacity_bytes, static_cast<int8_t>(rssi)});
+  }
+  fclose(file);
+  return trace;
+}
+
+struct SimulationResult {
+  size_t dropped_packets;
+  uint64_t mean_latency_us;
+  uint16_t final_rate;
+  A2dpRateController::Stats stats;
+};
+
+// Replays a link trace through a model of the source queue: every tick the
+// encoder enqueues one packet sized by the current rate, and the link takes
+// the packets its capacity for the tick allows. The queue is flushed when it
+// overflows, as btif_a2dp_source_enqueue_callback() does.
+SimulationResult Simulate(const std::vector<LinkTick>& trace, bool rate_control) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+  std::deque<uint32_t> queue;
+  SimulationResult result = {};
+  uint64_t link_wait_start_us = 0;
+  uint64_t last_dequeue_us = 0;
+  uint64_t total_latency_us = 0;
+  uint32_t budget_bytes = 0;
+  uint16_t rate = kA2dpRateFull;
+
+  for (size_t i = 0; i < trace.size(); i++) {
+    uint64_t now_us = (i + 1) * kTickUs;
+    if (rate_control) {
+      if (queue.empty()) {
+        link_wait_start_us = now_us;
+      }
+      uint64_t wait_start_us = std::max(link_wait_start_us, last_dequeue_us);
+      rate = controller.OnTick(
+              Sample(now_us, queue.size(), queue.empty() ? 0 : now_us - wait_start_us,
+                     trace[i].rssi));
+    }
+
+    if (queue.size() + 1 > kQueueLimit) {
+      result.dropped_packets += queue.size();
+      queue.clear();
+    }
+    queue.push_back(kFullRatePacketBytes * rate / kA2dpRateFull);
+
+    // Capacity left over at the end of a tick is lost, except for what the
+    // controller can buffer of a packet.
+    budget_bytes = std::min(budget_bytes, kFullRatePacketBytes) + trace[i].capacity_bytes;
+    while (!queue.empty() && queue.front() <= budget_bytes) {
+      budget_bytes -= queue.front();
+      queue.pop_front();
+      last_dequeue_us = now_us;
+    }
+    total_latency_us += queue.size() * kTickUs;
+  }
+
+  result.mean_latency_us = trace.empty() ? 0 : total_latency_us / trace.size();
+  result.final_rate = rate;
+  result.stats = controller.stats();
+  return result;
+}
+
+}  // namespace
+
+TEST(A2dpRateControllerTest, starts_at_full_rate) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+  EXPECT_EQ(kA2dpRateFull, controller.OnTick(Sample(kTickUs, 0)));
+  EXPECT_EQ(0u, controller.stats().decreases);
+}
+
+TEST(A2dpRateControllerTest, steps_down_once_per_hold_period) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+
+  EXPECT_EQ(750, controller.OnTick(Sample(kTickUs, kQueueLimit / 2)));
+  // The queue needs time to drain at the lower rate.
+  EXPECT_EQ(750, controller.OnTick(Sample(2 * kTickUs, kQueueLimit / 2)));
+  EXPECT_EQ(750, controller.OnTick(Sample(10 * kTickUs, kQueueLimit / 2)));
+  EXPECT_EQ(562, controller.OnTick(Sample(11 * kTickUs, kQueueLimit / 2)));
+  EXPECT_EQ(2u, controller.stats().decreases);
+  EXPECT_EQ(562, controller.stats().min_rate);
+}
+
+TEST(A2dpRateControllerTest, link_stall_is_congestion) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+
+  EXPECT_EQ(kA2dpRateFull, controller.OnTick(Sample(kTickUs, 2, 3 * kTickUs)));
+  EXPECT_EQ(750, controller.OnTick(Sample(2 * kTickUs, 2, 4 * kTickUs)));
+  EXPECT_EQ(4 * kTickUs, controller.stats().max_stall_us);
+}
+
+TEST(A2dpRateControllerTest, never_below_min_rate) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+
+  for (uint64_t i = 1; i <= 100; i++) {
+    controller.OnTick(Sample(i * kTickUs, kQueueLimit));
+  }
+  EXPECT_EQ(A2dpRateController::kMinRate, controller.rate());
+  EXPECT_EQ(100u, controller.stats().congested_ticks);
+}
+
+TEST(A2dpRateControllerTest, steps_up_after_the_link_kept_up) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+  ASSERT_EQ(750, controller.OnTick(Sample(kTickUs, kQueueLimit)));
+
+  // 2 s of ticks after the first clear one.
+  uint64_t i = 2;
+  for (; i < 102; i++) {
+    EXPECT_EQ(750, controller.OnTick(Sample(i * kTickUs, 0)));
+  }
+  EXPECT_EQ(850, controller.OnTick(Sample(i * kTickUs, 0)));
+  EXPECT_EQ(1u, controller.stats().increases);
+}
+
+TEST(A2dpRateControllerTest, a_busy_tick_restarts_the_hold) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+  ASSERT_EQ(750, controller.OnTick(Sample(kTickUs, kQueueLimit)));
+
+  uint64_t i = 2;
+  for (; i < 60; i++) {
+    controller.OnTick(Sample(i * kTickUs, 0));
+  }
+  // Neither clear nor congested.
+  controller.OnTick(Sample(i++ * kTickUs, 3));
+  for (; i < 150; i++) {
+    EXPECT_EQ(750, controller.OnTick(Sample(i * kTickUs, 0)));
+  }
+  EXPECT_EQ(850, controller.OnTick(Sample(162 * kTickUs, 0)));
+}
+
+TEST(A2dpRateControllerTest, fading_link_steps_up_slower) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+  ASSERT_EQ(kA2dpRateFull, controller.OnTick(Sample(kTickUs, 0, 0, -50)));
+  ASSERT_EQ(750, controller.OnTick(Sample(2 * kTickUs, kQueueLimit, 0, -50)));
+
+  uint64_t i = 3;
+  for (; i < 203; i++) {
+    EXPECT_EQ(750, controller.OnTick(Sample(i * kTickUs, 0, 0, -60)));
+  }
+  EXPECT_EQ(850, controller.OnTick(Sample(i * kTickUs, 0, 0, -60)));
+}
+
+TEST(A2dpRateControllerTest, reset_restores_full_rate) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+  controller.OnTick(Sample(kTickUs, kQueueLimit));
+  ASSERT_LT(controller.rate(), kA2dpRateFull);
+
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+  EXPECT_EQ(kA2dpRateFull, controller.rate());
+  EXPECT_EQ(0u, controller.stats().ticks);
+}
+
+TEST(A2dpRateControllerTest, applies_rate_to_encoder) {
+  A2dpRateController controller;
+  target_rate = 0;
+  controller.Reset(kEncoderIntervalMs, SetTargetRate);
+  EXPECT_TRUE(controller.active());
+  EXPECT_EQ(kA2dpRateFull, target_rate);
+
+  controller.OnTick(Sample(kTickUs, kQueueLimit));
+  EXPECT_EQ(750, target_rate);
+}
+
+TEST(A2dpRateControllerTest, encoder_without_rate_hook_is_left_alone) {
+  A2dpRateController controller;
+  controller.Reset(kEncoderIntervalMs, nullptr);
+  EXPECT_FALSE(controller.active());
+
+  for (uint64_t i = 1; i <= 100; i++) {
+    EXPECT_EQ(kA2dpRateFull, controller.OnTick(Sample(i * kTickUs, kQueueLimit, 4 * kTickUs)));
+  }
+  EXPECT_EQ(0u, controller.stats().ticks);
+  EXPECT_EQ(0u, controller.stats().decreases);
+  EXPECT_EQ(kA2dpRateFull, controller.stats().min_rate);
+}
+
+TEST(A2dpRateControllerTest, stable_link_keeps_full_rate) {
+  std::vector<LinkTick> trace = ReadLinkTrace("test/a2dp/raw_data/link_stable.csv");
+  ASSERT_FALSE(trace.empty());
+
+  SimulationResult controlled = Simulate(trace, true);
+  EXPECT_EQ(0u, controlled.dropped_packets);
+  EXPECT_EQ(0u, controlled.stats.decreases);
+  EXPECT_EQ(kA2dpRateFull, controlled.final_rate);
+}
+
+TEST(A2dpRateControllerTest, interference_drops_less_audio) {
+  std::vector<LinkTick> trace = ReadLinkTrace("test/a2dp/raw_data/link_interference.csv");
+  ASSERT_FALSE(trace.empty());
+
+  SimulationResult fixed = Simulate(trace, false);
+  SimulationResult controlled = Simulate(trace, true);
+  ASSERT_GT(fixed.dropped_packets, 0u);
+  EXPECT_EQ(0u, controlled.dropped_packets);
+  EXPECT_LT(controlled.mean_latency_us, fixed.mean_latency_us / 2);
+  EXPECT_GT(controlled.stats.increases, 0u);
+}
+
+TEST(A2dpRateControllerTest, fading_link_drops_less_audio) {
+  std::vector<LinkTick> trace = ReadLinkTrace("test/a2dp/raw_data/link_fading.csv");
+  ASSERT_FALSE(trace.empty());
+
+  SimulationResult fixed = Simulate(trace, false);
+  SimulationResult controlled = Simulate(trace, true);
+  ASSERT_GT(fixed.dropped_packets, 0u);
+  EXPECT_EQ(0u, controlled.dropped_packets);
+  EXPECT_LT(controlled.mean_latency_us, fixed.mean_latency_us / 2);
+  EXPECT_LT(controlled.final_rate, kA2dpRateFull);
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "stack/btm/btm_inq_db.h"
+#include "stack/include/bt_device_type.h"
+#include "types/raw_address.h"
+
+namespace {
+
+constexpr size_t kCapacity = 8;
+constexpr bool kClassic = false;
+constexpr bool kLe = true;
+constexpr bool kByRecency = false;
+constexpr bool kByRssi = true;
+
+RawAddress MakeAddress(uint16_t id) {
+  return RawAddress({0x0a, 0x0b, 0x0c, 0x0d, static_cast<uint8_t>(id >> 8),
+                     static_cast<uint8_t>(id)});
+}
+
+std::vector<RawAddress> Walk(InquiryDb& db) {
+  std::vector<RawAddress> addresses;
+  for (tINQ_DB_ENT* p_ent = db.First(); p_ent != nullptr; p_ent = db.Next(p_ent)) {
+    addresses.push_back(p_ent->inq_info.results.remote_bd_addr);
+  }
+  return addresses;
+}
+
+}  // namespace
+
+class InquiryDbTest : public ::testing::Test {
+protected:
+  InquiryDb db_{kCapacity};
+};
+
+TEST_F(InquiryDbTest, new_and_find) {
+  ASSERT_EQ(nullptr, db_.Find(MakeAddress(1)));
+
+  tINQ_DB_ENT* p_ent = db_.New(MakeAddress(1), kLe, kByRecency);
+  ASSERT_NE(nullptr, p_ent);
+  ASSERT_TRUE(p_ent->in_use);
+  ASSERT_EQ(MakeAddress(1), p_ent->inq_info.results.remote_bd_addr);
+  ASSERT_EQ(p_ent, db_.Find(MakeAddress(1)));
+  ASSERT_EQ(1UL, db_.size());
+}
+
+TEST_F(InquiryDbTest, new_replaces_existing_entry) {
+  tINQ_DB_ENT* p_ent = db_.New(MakeAddress(1), kClassic, kByRecency);
+  p_ent->inq_info.results.rssi = -40;
+
+  p_ent = db_.New(MakeAddress(1), kLe, kByRecency);
+  ASSERT_EQ(0, p_ent->inq_info.results.rssi);
+  ASSERT_EQ(p_ent, db_.Find(MakeAddress(1)));
+  ASSERT_EQ(1UL, db_.size());
+}
+
+TEST_F(InquiryDbTest, reuses_least_recently_found_entry) {
+  for (uint16_t id = 0; id < kCapacity / 2; id++) {
+    db_.New(MakeAddress(id), kLe, kByRecency);
+  }
+  db_.Find(MakeAddress(0));
+
+  db_.New(MakeAddress(100), kLe, kByRecency);
+  ASSERT_EQ(kCapacity / 2, db_.size());
+  ASSERT_NE(nullptr, db_.Find(MakeAddress(0)));
+  ASSERT_EQ(nullptr, db_.Find(MakeAddress(1)));
+  ASSERT_NE(nullptr, db_.Find(MakeAddress(100)));
+}
+
+TEST_F(InquiryDbTest, reuses_weakest_entry_by_rssi) {
+  const int8_t rssis[] = {-50, -90, -30, -60};
+  for (uint16_t id = 0; id < kCapacity / 2; id++) {
+    db_.New(MakeAddress(id), kClassic, kByRssi)->inq_info.results.rssi = rssis[id];
+  }
+
+  db_.New(MakeAddress(100), kClassic, kByRssi);
+  ASSERT_EQ(nullptr, db_.Find(MakeAddress(1)));
+  ASSERT_NE(nullptr, db_.Find(MakeAddress(100)));
+}
+
+TEST_F(InquiryDbTest, le_devices_do_not_evict_classic_devices) {
+  tINQ_DB_ENT* p_classic = db_.New(MakeAddress(1), kClassic, kByRecency);
+  for (uint16_t id = 100; id < 100 + 10 * kCapacity; id++) {
+    db_.New(MakeAddress(id), kLe, kByRecency);
+  }
+
+  ASSERT_EQ(p_classic, db_.Find(MakeAddress(1)));
+  ASSERT_EQ(MakeAddress(1), p_classic->inq_info.results.remote_bd_addr);
+  ASSERT_EQ(1 + kCapacity / 2, db_.size());
+}
+
+TEST_F(InquiryDbTest, clear) {
+  db_.New(MakeAddress(1), kClassic, kByRecency);
+  tINQ_DB_ENT* p_ent = db_.New(MakeAddress(2), kLe, kByRecency);
+  db_.New(MakeAddress(3), kLe, kByRecency);
+
+  const RawAddress address = MakeAddress(2);
+  db_.Clear(&address);
+  ASSERT_FALSE(p_ent->in_use);
+  ASSERT_EQ(nullptr, db_.Find(MakeAddress(2)));
+  ASSERT_EQ(2UL, db_.size());
+
+  db_.Clear(nullptr);
+  ASSERT_EQ(0UL, db_.size());
+  ASSERT_EQ(nullptr, db_.First());
+
+  // All the entries are free again
+  for (uint16_t id = 0; id < kCapacity / 2; id++) {
+    db_.New(MakeAddress(id), kLe, kByRecency);
+  }
+  ASSERT_EQ(kCapacity / 2, db_.size());
+}
+
+TEST_F(InquiryDbTest, clear_pending_le) {
+  tINQ_DB_ENT* p_pending = db_.New(MakeAddress(1), kLe, kByRecency);
+  p_pending->inq_info.results.device_type = BT_DEVICE_TYPE_BLE;
+  tINQ_DB_ENT* p_scanned = db_.New(MakeAddress(2), kLe, kByRecency);
+  p_scanned->inq_info.results.device_type = BT_DEVICE_TYPE_BLE;
+  p_scanned->scan_rsp = true;
+  tINQ_DB_ENT* p_dual = db_.New(MakeAddress(3), kLe, kByRecency);
+  p_dual->inq_info.results.device_type = BT_DEVICE_TYPE_DUMO;
+
+  db_.ClearPendingLe();
+  ASSERT_EQ(nullptr, db_.Find(MakeAddress(1)));
+  ASSERT_EQ(p_scanned, db_.Find(MakeAddress(2)));
+  ASSERT_EQ(p_dual, db_.Find(MakeAddress(3)));
+}
+
+TEST_F(InquiryDbTest, walk_in_rssi_order) {
+  db_.New(MakeAddress(1), kClassic, kByRecency)->inq_info.results.rssi = -70;
+  db_.New(MakeAddress(2), kLe, kByRecency)->inq_info.results.rssi = -30;
+  db_.New(MakeAddress(3), kClassic, kByRecency)->inq_info.results.rssi = -50;
+  ASSERT_EQ(std::vector<RawAddress>({MakeAddress(1), MakeAddress(3), MakeAddress(2)}),
+            Walk(db_));
+
+  db_.SortByRssi();
+  ASSERT_EQ(std::vector<RawAddress>({MakeAddress(2), MakeAddress(3), MakeAddress(1)}),
+            Walk(db_));
+}
+
+TEST(InquiryResultFilterTest, find_or_add) {
+  InquiryResultFilter filter;
+  ASSERT_FALSE(filter.FindOrAdd(MakeAddress(1), 1));
+  ASSERT_EQ(0UL, filter.size());
+
+  filter.Start(2);
+  ASSERT_FALSE(filter.FindOrAdd(MakeAddress(1), 1));
+  ASSERT_TRUE(filter.FindOrAdd(MakeAddress(1), 1));
+
+  // Addresses reported during a previous inquiry do not match
+  ASSERT_FALSE(filter.FindOrAdd(MakeAddress(1), 2));
+  ASSERT_TRUE(filter.FindOrAdd(MakeAddress(1), 2));
+
+  // Addresses beyond the maximum are not recorded
+  ASSERT_FALSE(filter.FindOrAdd(MakeAddress(2), 2));
+  ASSERT_FALSE(filter.FindOrAdd(MakeAddress(3), 2));
+  ASSERT_FALSE(filter.FindOrAdd(MakeAddress(3), 2));
+  ASSERT_EQ(2UL, filter.size());
+
+  filter.Stop();
+  ASSERT_EQ(0UL, filter.size());
+  ASSERT_FALSE(filter.FindOrAdd(MakeAddress(1), 2));
+}
@@ -15,7 +15,15 @@
  */
 
 #include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
+#include <cstring>
+#include <string>
+
+#include "osi/include/allocator.h"
+#include "osi/include/fixed_queue.h"
 #include "stack/include/port_api.h"
 #include "stack/rfcomm/rfc_int.h"
 #include "types/raw_address.h"
@@ -97,3 +105,127 @@ TEST_F(StackRfcommPortTest, PORT_IsCollisionDetected__basic) {
   rfc_cb.port.rfc_mcb[0].state = RFC_MX_STATE_DISC_WAIT_UA;
   ASSERT_FALSE(PORT_IsCollisionDetected(test_bd_addr));
 }
+
+namespace {
+BT_HDR* make_rx_buf(const char* data) {
+  uint16_t len = strlen(data);
+  BT_HDR* p_buf = (BT_HDR*)osi_calloc(sizeof(BT_HDR) + RFCOMM_MIN_OFFSET + len);
+  p_buf->offset = RFCOMM_MIN_OFFSET;
+  p_buf->len = len;
+  memcpy((uint8_t*)(p_buf + 1) + p_buf->offset, data, len);
+  return p_buf;
+}
+
+struct ReadvRecorder {
+  size_t consume;
+  std::string data;
+};
+
+ssize_t record_iov(const struct iovec* p_iov, int iov_cnt, void* context) {
+  ReadvRecorder* recorder = (ReadvRecorder*)context;
+  for (int i = 0; i < iov_cnt; i++) {
+    recorder->data.append((const char*)p_iov[i].iov_base, p_iov[i].iov_len);
+  }
+  return recorder->consume;
+}
+
+ssize_t fail_iov(const struct iovec* /* p_iov */, int /* iov_cnt */, void* /* context */) {
+  return -1;
+}
+
+ssize_t sendmsg_iov(const struct iovec* p_iov, int iov_cnt, void* context) {
+  struct msghdr msg = {};
+  msg.msg_iov = const_cast<struct iovec*>(p_iov);
+  msg.msg_iovlen = iov_cnt;
+  return sendmsg(*(int*)context, &msg, MSG_DONTWAIT);
+}
+}  // namespace
+
+class StackRfcommPortRxQueueTest : public StackRfcommPortTest {
+protected:
+  void SetUp() override {
+    StackRfcommPortTest::SetUp();
+    p_port_ = &rfc_cb.port.port[0];
+    p_port_->in_use = true;
+    p_port_->state = PORT_CONNECTION_STATE_OPENED;
+    p_port_->line_status = 0;
+    p_port_->rfc.p_mcb = nullptr;
+    p_port_->rx.queue = fixed_queue_new(SIZE_MAX);
+    p_port_->rx.queue_size = 0;
+    for (const char* data : {"hello", " ", "world"}) {
+      ASSERT_EQ(PORT_SUCCESS, PORT_EnqueueRxBuf(handle_, make_rx_buf(data)));
+    }
+  }
+  void TearDown() override {
+    fixed_queue_free(p_port_->rx.queue, osi_free);
+    p_port_->rx.queue = nullptr;
+    p_port_->in_use = false;
+    p_port_->state = PORT_CONNECTION_STATE_CLOSED;
+    StackRfcommPortTest::TearDown();
+  }
+
+  const uint16_t handle_ = 1;
+  tPORT* p_port_;
+};
+
+TEST_F(StackRfcommPortRxQueueTest, PORT_EnqueueRxBuf__queues_bytes) {
+  ASSERT_EQ(3u, fixed_queue_length(p_port_->rx.queue));
+  ASSERT_EQ(11u, p_port_->rx.queue_size);
+}
+
+TEST_F(StackRfcommPortRxQueueTest, PORT_EnqueueRxBuf__closed_port) {
+  p_port_->state = PORT_CONNECTION_STATE_CLOSED;
+  ASSERT_EQ(PORT_NOT_OPENED, PORT_EnqueueRxBuf(handle_, make_rx_buf("lost")));
+  ASSERT_EQ(3u, fixed_queue_length(p_port_->rx.queue));
+  ASSERT_EQ(11u, p_port_->rx.queue_size);
+}
+
+TEST_F(StackRfcommPortRxQueueTest, PORT_ReadDataV__consume_partial) {
+  ReadvRecorder recorder = {.consume = 8, .data = {}};
+  uint32_t len = 0;
+  ASSERT_EQ(PORT_SUCCESS, PORT_ReadDataV(handle_, record_iov, &recorder, &len));
+  ASSERT_EQ("hello world", recorder.data);
+  ASSERT_EQ(8u, len);
+  ASSERT_EQ(1u, fixed_queue_length(p_port_->rx.queue));
+  ASSERT_EQ(3u, p_port_->rx.queue_size);
+
+  recorder = {.consume = 3, .data = {}};
+  ASSERT_EQ(PORT_SUCCESS, PORT_ReadDataV(handle_, record_iov, &recorder, &len));
+  ASSERT_EQ("rld", recorder.data);
+  ASSERT_EQ(3u, len);
+  ASSERT_TRUE(fixed_queue_is_empty(p_port_->rx.queue));
+  ASSERT_EQ(0u, p_port_->rx.queue_size);
+}
+
+TEST_F(StackRfcommPortRxQueueTest, PORT_ReadDataV__sendmsg) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+  uint32_t len = 0;
+  ASSERT_EQ(PORT_SUCCESS, PORT_ReadDataV(handle_, sendmsg_iov, &fds[0], &len));
+  ASSERT_EQ(11u, len);
+  ASSERT_TRUE(fixed_queue_is_empty(p_port_->rx.queue));
+
+  char received[16] = {};
+  ASSERT_EQ(11, recv(fds[1], received, sizeof(received), MSG_DONTWAIT));
+  ASSERT_STREQ("hello world", received);
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST_F(StackRfcommPortRxQueueTest, PORT_ReadDataV__callback_error) {
+  uint32_t len = 0;
+  ASSERT_EQ(PORT_UNKNOWN_ERROR, PORT_ReadDataV(handle_, fail_iov, nullptr, &len));
+  ASSERT_EQ(0u, len);
+  ASSERT_EQ(11u, p_port_->rx.queue_size);
+}
+
+TEST_F(StackRfcommPortRxQueueTest, PORT_ReadDataV__closed_port) {
+  p_port_->state = PORT_CONNECTION_STATE_CLOSED;
+  ReadvRecorder recorder = {.consume = 11, .data = {}};
+  uint32_t len = 0;
+  ASSERT_EQ(PORT_NOT_OPENED, PORT_ReadDataV(handle_, record_iov, &recorder, &len));
+  ASSERT_TRUE(recorder.data.empty());
+  ASSERT_EQ(11u, p_port_->rx.queue_size);
+}
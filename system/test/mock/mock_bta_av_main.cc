@@ -63,7 +63,7 @@ void bta_av_conn_cback(uint8_t /* handle */, const RawAddress& /* bd_addr */, ui
                        tAVDT_CTRL* /* p_data */, uint8_t /* scb_index */) {
   inc_func_call_count(__func__);
 }
-void bta_av_dup_audio_buf(tBTA_AV_SCB* /* p_scb */, BT_HDR* /* p_buf */) {
+void bta_av_dup_audio_buf(tBTA_AV_SCB* /* p_scb */, BtaAvMediaPacket* /* p_packet */) {
   inc_func_call_count(__func__);
 }
 void bta_av_free_scb(tBTA_AV_SCB* /* p_scb */) { inc_func_call_count(__func__); }
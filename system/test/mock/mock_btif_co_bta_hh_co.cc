@@ -37,6 +37,7 @@ tBTA_HH_RPT_CACHE_ENTRY* bta_hh_le_co_cache_load(const tAclLinkSpec& /* link_spe
   return nullptr;
 }
 void bta_hh_co_close(btif_hh_device_t* /* p_dev */) { inc_func_call_count(__func__); }
+void bta_hh_co_dump(int /* fd */) { inc_func_call_count(__func__); }
 void bta_hh_co_data(uint8_t /* dev_handle */, uint8_t* /* p_rpt */, uint16_t /* len */) {
   inc_func_call_count(__func__);
 }
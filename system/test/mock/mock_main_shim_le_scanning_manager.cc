@@ -29,6 +29,10 @@
 }
 void bluetooth::shim::init_scanning_manager() { inc_func_call_count(__func__); }
 
+void bluetooth::shim::forget_remote_properties(const RawAddress& /* bd_addr */) {
+  inc_func_call_count(__func__);
+}
+
 bool bluetooth::shim::is_ad_type_filter_supported() {
   inc_func_call_count(__func__);
   return false;
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Generated mock file from original source file
+ *   Functions generated:3
+ */
+
+#include "stack/include/a2dp_rate_controller.h"
+#include "test/common/mock_functions.h"
+
+void A2dpRateController::Reset(uint64_t /* encoder_interval_ms */,
+                               SetTargetRate /* set_target_rate */) {
+  inc_func_call_count(__func__);
+}
+uint16_t A2dpRateController::OnTick(const LinkSample& /* sample */) {
+  inc_func_call_count(__func__);
+  return rate_;
+}
+void A2dpRateController::Dump(int /* fd */) const { inc_func_call_count(__func__); }
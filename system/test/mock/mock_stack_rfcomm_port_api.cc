@@ -39,6 +39,10 @@ int PORT_ClearKeepHandleFlag(uint16_t /* port_handle */) {
   inc_func_call_count(__func__);
   return 0;
 }
+int PORT_EnqueueRxBuf(uint16_t /* handle */, BT_HDR* /* p_buf */) {
+  inc_func_call_count(__func__);
+  return 0;
+}
 int PORT_FlowControl_MaxCredit(uint16_t /* handle */, bool /* enable */) {
   inc_func_call_count(__func__);
   return 0;
@@ -52,6 +56,11 @@ int PORT_ReadData(uint16_t /* handle */, char* /* p_data */, uint16_t /* max_len
   inc_func_call_count(__func__);
   return 0;
 }
+int PORT_ReadDataV(uint16_t /* handle */, tPORT_READV_CALLBACK* /* p_callback */,
+                   void* /* context */, uint32_t* /* p_len */) {
+  inc_func_call_count(__func__);
+  return 0;
+}
 int PORT_SetDataCOCallback(uint16_t /* port_handle */, tPORT_DATA_CO_CALLBACK* /* p_port_cb */) {
   inc_func_call_count(__func__);
   return 0;